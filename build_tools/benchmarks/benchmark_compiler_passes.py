@@ -0,0 +1,212 @@
+#!/usr/bin/env python3
+# Copyright 2023 The IREE Authors
+#
+# Licensed under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+"""Measures the compile time of individual compiler passes on synthetic modules.
+
+Large models are expensive to obtain and slow to import so this generates
+modules that stress a single pass at a configurable scale and times that pass
+in isolation with iree-opt. It is intended for catching super-linear scaling in
+passes that operate on the whole program.
+
+Example usage:
+  python3 benchmark_compiler_passes.py \
+    --iree_opt=/path/to/iree-opt \
+    deduplicate-executables --executable_count=20000 --unique_count=500
+  python3 benchmark_compiler_passes.py \
+    --iree_opt=/path/to/iree-opt \
+    schedule-execution --dispatch_count=100000 --barrier_interval=50
+"""
+
+import argparse
+import pathlib
+import statistics
+import subprocess
+import tempfile
+import time
+
+from typing import Dict, List
+
+
+def generate_deduplicate_executables_module(args: argparse.Namespace) -> str:
+  """Generates a module with many executables of which few are unique.
+
+  Executables are stamped out from |unique_count| templates that differ in an
+  attribute so that they all share the same ops. Every copy uses its own symbol
+  names for the exported and helper functions.
+  """
+  lines = []
+  for i in range(args.executable_count):
+    unique_id = i % args.unique_count
+    lines.append(f"""
+flow.executable private @ex_{i} {{
+  flow.executable.export public @entry_{i}
+  builtin.module {{
+    func.func private @helper_{i}(%arg0: tensor<4xf32>) -> tensor<4xf32> {{
+      %cst = arith.constant dense<{unique_id}.0> : tensor<4xf32>
+      %0 = arith.addf %arg0, %cst : tensor<4xf32>
+      return %0 : tensor<4xf32>
+    }}
+    func.func @entry_{i}(%arg0: tensor<4xf32>) -> tensor<4xf32> {{
+      %0 = func.call @helper_{i}(%arg0) : (tensor<4xf32>) -> tensor<4xf32>
+      %1 = arith.mulf %0, %arg0 : tensor<4xf32>
+      return %1 : tensor<4xf32>
+    }}
+  }}
+}}""")
+  lines.append(
+      "func.func @main(%arg0: tensor<4xf32>) -> tensor<4xf32> {\n"
+      "  %c4 = arith.constant 4 : index")
+  value = "%arg0"
+  for i in range(args.executable_count):
+    lines.append(f"  %{i} = flow.dispatch @ex_{i}::@entry_{i}[%c4]({value}) : "
+                 "(tensor<4xf32>) -> tensor<4xf32>")
+    value = f"%{i}"
+  lines.append(f"  return {value} : tensor<4xf32>\n}}")
+  return "\n".join(lines)
+
+
+def add_deduplicate_executables_args(parser: argparse.ArgumentParser):
+  parser.add_argument("--executable_count",
+                      type=int,
+                      default=10000,
+                      help="Total number of executables in the module.")
+  parser.add_argument("--unique_count",
+                      type=int,
+                      default=100,
+                      help="Number of structurally unique executables.")
+
+
+def generate_schedule_execution_module(args: argparse.Namespace) -> str:
+  """Generates a function with a large graph of stream dispatches.
+
+  Each dispatch consumes the result of the previous one and of a dispatch
+  |fan_in| steps back so that partitions have long use-def chains to check for
+  hazards. Every |barrier_interval| dispatches a call to an external function
+  consumes the latest result and forces a new partition to be started.
+  """
+  lines = [
+      "func.func private @barrier(!stream.resource<external>) -> "
+      "!stream.resource<external>",
+      "func.func @main(%arg0: !stream.resource<external>) -> "
+      "!stream.resource<external> {",
+      "  %c0 = arith.constant 0 : index",
+      "  %c1 = arith.constant 1 : index",
+      "  %c1280 = arith.constant 1280 : index",
+  ]
+  resource_type = "!stream.resource<external>{%c1280}"
+  values = ["%arg0"]
+  for i in range(args.dispatch_count):
+    lhs = values[-1]
+    rhs = values[max(len(values) - args.fan_in, 0)]
+    operands = [lhs] if lhs == rhs else [lhs, rhs]
+    operand_list = ", ".join(
+        f"{operand}[%c0 to %c1280 for %c1280]" for operand in operands)
+    operand_types = ", ".join(resource_type for _ in operands)
+    lines.append(f"  %d{i} = stream.async.dispatch @ex::@dispatch_{i}"
+                 f"[%c1, %c1, %c1]({operand_list}) : ({operand_types}) -> "
+                 f"{resource_type}")
+    values.append(f"%d{i}")
+    if args.barrier_interval and (i + 1) % args.barrier_interval == 0:
+      lines.append(f"  %b{i} = func.call @barrier(%d{i}) : "
+                   "(!stream.resource<external>) -> "
+                   "!stream.resource<external>")
+      values.append(f"%b{i}")
+  lines.append(f"  return {values[-1]} : !stream.resource<external>\n}}")
+  return "\n".join(lines)
+
+
+def add_schedule_execution_args(parser: argparse.ArgumentParser):
+  parser.add_argument("--dispatch_count",
+                      type=int,
+                      default=50000,
+                      help="Total number of dispatches in the function.")
+  parser.add_argument("--fan_in",
+                      type=int,
+                      default=8,
+                      help="Distance to the second operand of each dispatch.")
+  parser.add_argument("--barrier_interval",
+                      type=int,
+                      default=100,
+                      help="Number of dispatches between partition barriers "
+                      "(0 to disable).")
+
+
+# Benchmark name -> (iree-opt pass flag, argument setup, module generator).
+BENCHMARKS: Dict[str, tuple] = {
+    "deduplicate-executables": (
+        "--iree-flow-deduplicate-executables",
+        add_deduplicate_executables_args,
+        generate_deduplicate_executables_module,
+    ),
+    "schedule-execution": (
+        "--pass-pipeline=builtin.module(func.func("
+        "iree-stream-schedule-execution))",
+        add_schedule_execution_args,
+        generate_schedule_execution_module,
+    ),
+}
+
+
+def run_benchmark(iree_opt: pathlib.Path, pass_flags: List[str],
+                  input_path: pathlib.Path, repetitions: int) -> List[float]:
+  """Runs iree-opt |repetitions| times and returns wall times in seconds."""
+  times = []
+  for _ in range(repetitions):
+    start = time.perf_counter()
+    subprocess.run([str(iree_opt), *pass_flags, str(input_path)],
+                   check=True,
+                   stdout=subprocess.DEVNULL)
+    times.append(time.perf_counter() - start)
+  return times
+
+
+def parse_arguments() -> argparse.Namespace:
+  parser = argparse.ArgumentParser(
+      description="Benchmarks compiler passes on synthetic modules.")
+  parser.add_argument("--iree_opt",
+                      type=pathlib.Path,
+                      required=True,
+                      help="Path to the iree-opt tool.")
+  parser.add_argument("--repetitions",
+                      type=int,
+                      default=3,
+                      help="Number of times to run each benchmark.")
+  parser.add_argument("--keep_input",
+                      type=pathlib.Path,
+                      default=None,
+                      help="Writes the generated module to this path.")
+  parser.add_argument("--extra_flags",
+                      nargs="*",
+                      default=[],
+                      help="Additional iree-opt flags (e.g. --mlir-timing).")
+  subparsers = parser.add_subparsers(dest="benchmark", required=True)
+  for name, (_, add_args, _) in BENCHMARKS.items():
+    add_args(subparsers.add_parser(name))
+  return parser.parse_args()
+
+
+def main(args: argparse.Namespace):
+  pass_flag, _, generate_module = BENCHMARKS[args.benchmark]
+  module = generate_module(args)
+  with tempfile.TemporaryDirectory() as temp_dir:
+    input_path = args.keep_input or pathlib.Path(temp_dir) / "input.mlir"
+    input_path.write_text(module)
+    # Parsing and printing are included in the wall time so a parse-only run
+    # is measured as the baseline to subtract.
+    baseline = run_benchmark(args.iree_opt, args.extra_flags, input_path,
+                             args.repetitions)
+    times = run_benchmark(args.iree_opt, [pass_flag, *args.extra_flags],
+                          input_path, args.repetitions)
+  baseline_median = statistics.median(baseline)
+  median = statistics.median(times)
+  print(f"{args.benchmark}: {len(module)} bytes of input")
+  print(f"  parse/print median: {baseline_median:.3f}s")
+  print(f"  with pass median:   {median:.3f}s")
+  print(f"  pass median:        {max(median - baseline_median, 0.0):.3f}s")
+
+
+if __name__ == "__main__":
+  main(parse_arguments())
@@ -28,6 +28,11 @@ IREE::LinalgExt::MaterializeEncodingInfo chooseEncodingInfoForMatmul(
     MatmulType type, MatmulOperandRole operandRole,
     MatmulTileParams tileParams);
 
+// Adjusts the `encodingInfo` of a matmul operand to the corresponding batch
+// matmul operand: the leading batch dimension stays outermost and untiled.
+void adjustEncodingInfoForBatchMatmul(
+    IREE::LinalgExt::MaterializeEncodingInfo &encodingInfo);
+
 IREE::LinalgExt::MaterializeEncodingValueFn getMaterializeEncodingValueFn(
     IREE::HAL::ExecutableTargetAttr targetAttr);
 
@@ -271,9 +271,19 @@ IREE::LinalgExt::MaterializeEncodingInfo chooseEncodingInfoForMatmul(
   return encodingInfo;
 }
 
+void adjustEncodingInfoForBatchMatmul(MaterializeEncodingInfo &encodingInfo) {
+  for (int64_t &pos : encodingInfo.innerDimsPos) ++pos;
+  if (encodingInfo.outerDimsPerm.empty()) return;
+  SmallVector<int64_t> outerDimsPerm = {0};
+  for (int64_t dim : encodingInfo.outerDimsPerm) {
+    outerDimsPerm.push_back(dim + 1);
+  }
+  encodingInfo.outerDimsPerm = std::move(outerDimsPerm);
+}
+
 void adjustTileSizesToNarrowStaticShape(MaterializeEncodingInfo &encodingInfo,
                                         ArrayRef<int64_t> shape) {
-  for (size_t i = 0; i < shape.size(); i++) {
+  for (size_t i = 0; i < encodingInfo.innerDimsPos.size(); i++) {
     int64_t size = shape[encodingInfo.innerDimsPos[i]];
     // Dynamic sizes are assumed to be large enough, not to be candidates for
     // narrow kernels.
@@ -73,6 +73,13 @@ static llvm::cl::opt<int> defaultWorkgroupTileSize(
         "linalg.generic and linalg.indexed_generic workgroup tile size"),
     llvm::cl::init(64));
 
+static llvm::cl::opt<int> clAttentionWorkingSetBytes(
+    "iree-codegen-llvm-attention-working-set-bytes",
+    llvm::cl::desc("upper bound on the bytes touched per key/value block step "
+                   "of iree_linalg_ext.attention; used to pick the query and "
+                   "key/value block sizes so they stay cache resident"),
+    llvm::cl::init(128 * 1024));
+
 // TODO(hanchung): Remove the flag. This is the flag for fastly falling back to
 // the previous snapshot.
 
@@ -373,10 +380,21 @@ static unsigned getReferenceTypeLengthInBytes(func::FuncOp entryPointFn) {
   return referenceTypeLengthInBytes;
 }
 
+/// Looks for the `dispatch_concurrency` attribute in the hal.executable.target
+/// looked up from this op. It is present on variants specialized for devices
+/// running at least that many workers.
+static std::optional<int64_t> getDispatchConcurrency(Operation *op) {
+  auto targetAttr = IREE::HAL::ExecutableTargetAttr::lookup(op);
+  auto concurrencyAttr =
+      getConfigIntegerAttr(targetAttr, "dispatch_concurrency");
+  if (!concurrencyAttr || concurrencyAttr->getInt() <= 0) return std::nullopt;
+  return concurrencyAttr->getInt();
+}
+
 /// Returns the default tile sizes to use for the loops that are distributed at
 /// Flow level.
 static SmallVector<int64_t> getDefaultDistributedLoopTileSizes(
-    ArrayRef<int64_t> lbs, ArrayRef<int64_t> ubs,
+    Operation *op, ArrayRef<int64_t> lbs, ArrayRef<int64_t> ubs,
     ArrayRef<int64_t> minTileSizes, ArrayRef<int64_t> maxTileSizes,
     ArrayRef<int64_t> vectorSizeHints) {
   assert(lbs.size() == ubs.size() && lbs.size() == minTileSizes.size() &&
@@ -432,7 +450,9 @@ static SmallVector<int64_t> getDefaultDistributedLoopTileSizes(
   // Reduce the number of workgroups in cases where we are dividing the work too
   // much. Over-provision the number of workgroups to twice the number of
   // threads.
-  int64_t numWorkgroupsLimit = 2 * clNumberOfRuntimeThreads;
+  std::optional<int64_t> dispatchConcurrency = getDispatchConcurrency(op);
+  int64_t numWorkgroupsLimit =
+      2 * dispatchConcurrency.value_or(clNumberOfRuntimeThreads);
   int64_t numWorkgroups =
       std::accumulate(numWorkgroupsPerDim.begin(), numWorkgroupsPerDim.end(),
                       1LL, std::multiplies<int64_t>{});
@@ -468,6 +488,35 @@ static SmallVector<int64_t> getDefaultDistributedLoopTileSizes(
       currDim--;
     }
   }
+
+  // When the target is specialized for a known number of workers, also split
+  // the work further if there are not enough workgroups to keep all of them
+  // busy. The default thread count is only a guess so this is not done
+  // otherwise. Outer dimensions are split first to keep the inner dimensions
+  // vectorizable.
+  if (!dispatchConcurrency) return distributedTileSizes;
+  numWorkgroups = 1;
+  for (auto i : llvm::seq<size_t>(0, numDims)) {
+    if (!distributedTileSizes[i] || ShapedType::isDynamic(workload[i])) {
+      continue;
+    }
+    numWorkgroups *= llvm::divideCeil(workload[i], distributedTileSizes[i]);
+  }
+  for (unsigned index = 0;
+       numWorkgroups < *dispatchConcurrency && index < numDims;) {
+    int64_t currSize = distributedTileSizes[index];
+    int64_t newSize = currSize / 2;
+    int64_t vectorSize = std::max<int64_t>(vectorSizeHints[index], 1);
+    if (!currSize || ShapedType::isDynamic(workload[index]) ||
+        newSize < std::max<int64_t>(minTileSizes[index], 1) ||
+        newSize % vectorSize != 0) {
+      index++;
+      continue;
+    }
+    numWorkgroups /= llvm::divideCeil(workload[index], currSize);
+    numWorkgroups *= llvm::divideCeil(workload[index], newSize);
+    distributedTileSizes[index] = newSize;
+  }
   return distributedTileSizes;
 }
 
@@ -590,7 +639,7 @@ static int64_t getMaxVectorTileSize(int64_t lb, int64_t ub, int64_t maxSize,
 /// padding/peeling for all the kernels. Allowing incomplete tile is critical
 /// for odd shapes (e.g., some dim sizes could be prime number).
 static SmallVector<int64_t> getDefaultDistributedLevelTileSizes(
-    ArrayRef<unsigned> partitionableLoops, ArrayRef<int64_t> lbs,
+    Operation *op, ArrayRef<unsigned> partitionableLoops, ArrayRef<int64_t> lbs,
     ArrayRef<int64_t> ubs, ArrayRef<int64_t> minTileSizes,
     ArrayRef<int64_t> maxTileSizes, bool allowIncompleteTile = false,
     ArrayRef<int64_t> vectorSizeHints = {}) {
@@ -615,7 +664,7 @@ static SmallVector<int64_t> getDefaultDistributedLevelTileSizes(
   }
 
   SmallVector<int64_t> distributedTileSizes =
-      getDefaultDistributedLoopTileSizes(lbs, ubs, adjustedMinTileSizes,
+      getDefaultDistributedLoopTileSizes(op, lbs, ubs, adjustedMinTileSizes,
                                          adjustedMaxTileSizes,
                                          adjustedVectorSizeHints);
   // Final fix up of the tile sizes to make sure that they divide the problem
@@ -639,8 +688,9 @@ static SmallVector<int64_t> getDefaultDistributedLevelTileSizes(
   SmallVector<int64_t> ubs = linalgOp.getStaticLoopRanges();
   auto loops = cast<PartitionableLoopsInterface>(linalgOp.getOperation())
                    .getPartitionableLoops(kNumMaxParallelDims);
-  return getDefaultDistributedLevelTileSizes(loops, lbs, ubs, minTileSizes,
-                                             maxTileSizes, allowIncompleteTile,
+  return getDefaultDistributedLevelTileSizes(linalgOp, loops, lbs, ubs,
+                                             minTileSizes, maxTileSizes,
+                                             allowIncompleteTile,
                                              vectorSizeHints);
 }
 
@@ -767,7 +817,7 @@ static LogicalResult setDefaultRootConfig(
   }
 
   SmallVector<int64_t> flowTileSizes = getDefaultDistributedLevelTileSizes(
-      partitionableLoops, lbs, ubs, minTileSizes, maxTileSizes);
+      entryPointFn, partitionableLoops, lbs, ubs, minTileSizes, maxTileSizes);
   TileSizesListType tileSizes;
   tileSizes.emplace_back(std::move(flowTileSizes));
   auto loweringConfig = IREE::Codegen::LoweringConfigAttr::get(
@@ -1755,8 +1805,8 @@ static LogicalResult setRootConfig(func::FuncOp entryPointFn,
       cast<PartitionableLoopsInterface>(padOp.getOperation())
           .getPartitionableLoops(kNumMaxParallelDims);
   SmallVector<int64_t> distributedTileSizes =
-      getDefaultDistributedLevelTileSizes(partitionableLoops, lbs, ubs,
-                                          minTileSizes, maxTileSizes);
+      getDefaultDistributedLevelTileSizes(entryPointFn, partitionableLoops, lbs,
+                                          ubs, minTileSizes, maxTileSizes);
   TileSizesListType tileSizes;
   // Distribution tiling
   tileSizes.emplace_back(std::move(distributedTileSizes));
@@ -1821,6 +1871,91 @@ static LogicalResult setRootConfig(
   return setDefaultRootConfig(entryPointFn, partitionableLoopOp, lbs, ubs);
 }
 
+/// Sets the lowering configuration for dispatch region with root op
+/// iree_linalg_ext.attention. Each workgroup owns a block of query rows and
+/// walks the key/value sequence in blocks, updating the softmax statistics
+/// online, so the full score matrix is never materialized. The block sizes are
+/// chosen so that the query, key and value blocks, the score tile and the
+/// accumulator fit in `clAttentionWorkingSetBytes`. The configuration is
+///   [[batch, query-block], [0, 0], [0, key/value-block],
+///    [rows, cols, 0], [0, 0, reduction]]
+/// where the cache reduction level is consumed by the attention decomposition
+/// and the vector levels tile the decomposed ops (which carry the
+/// configuration over). Those are all 2-D (query-block x key/value-block or
+/// query-block x head dimension) or matmuls over such shapes.
+static LogicalResult setRootConfig(func::FuncOp entryPointFn,
+                                   IREE::LinalgExt::AttentionOp attnOp) {
+  ShapedType queryType = attnOp.getQueryType();
+  ShapedType keyType = attnOp.getKeyType();
+  // The decomposition needs static block shapes to vectorize, so leave dynamic
+  // cases to the default configuration.
+  if (!queryType.hasStaticShape() || !keyType.hasStaticShape()) {
+    return setRootConfig(entryPointFn,
+                         cast<TilingInterface>(attnOp.getOperation()));
+  }
+
+  int64_t sequenceLength = queryType.getDimSize(1);
+  int64_t keyValueLength = keyType.getDimSize(1);
+  int64_t headDimension = queryType.getDimSize(2);
+  int64_t elementBytes =
+      IREE::Util::getRoundedElementByteWidth(queryType.getElementType());
+
+  // Returns the largest power of two that evenly divides `size` and is not
+  // larger than `maxTileSize`. Halving such a tile keeps it a divisor.
+  auto getLargestDividingTileSize = [](int64_t size, int64_t maxTileSize) {
+    int64_t tileSize = 1;
+    while (tileSize * 2 <= maxTileSize && size % (tileSize * 2) == 0) {
+      tileSize *= 2;
+    }
+    return tileSize;
+  };
+  int64_t queryTileSize =
+      getLargestDividingTileSize(sequenceLength, defaultWorkgroupTileSize);
+  int64_t keyValueTileSize =
+      getLargestDividingTileSize(keyValueLength, defaultWorkgroupTileSize);
+
+  // Q and the accumulator are query-block x d, K and V are key/value-block x
+  // d, the scores are query-block x key/value-block and the running max and
+  // sum have one element per query row.
+  auto getWorkingSetBytes = [&]() {
+    return elementBytes * (2 * queryTileSize * headDimension +
+                           2 * keyValueTileSize * headDimension +
+                           queryTileSize * keyValueTileSize +
+                           2 * queryTileSize);
+  };
+  while (getWorkingSetBytes() > clAttentionWorkingSetBytes) {
+    if (keyValueTileSize >= queryTileSize && keyValueTileSize > 1) {
+      keyValueTileSize /= 2;
+    } else if (queryTileSize > 1) {
+      queryTileSize /= 2;
+    } else {
+      break;
+    }
+  }
+  LLVM_DEBUG(KD_DBGS() << "Attention query tile size: " << queryTileSize
+                       << ", key/value tile size: " << keyValueTileSize
+                       << "\n");
+
+  // The column and reduction dimensions of the decomposed ops are either the
+  // key/value block or the head dimension so the vector tile has to divide
+  // both to keep all vector shapes static.
+  int64_t vectorSize = getVectorSize(entryPointFn, queryType);
+  int64_t vectorRowTileSize = getLargestDividingTileSize(queryTileSize, 8);
+  int64_t vectorColTileSize = getLargestDividingTileSize(
+      std::gcd(keyValueTileSize, headDimension), vectorSize);
+  LLVM_DEBUG(KD_DBGS() << "Attention vector tile sizes: " << vectorRowTileSize
+                       << "x" << vectorColTileSize << "\n");
+
+  TileSizesListType tileSizes = {{1, queryTileSize},
+                                 {0, 0},
+                                 {0, keyValueTileSize},
+                                 {vectorRowTileSize, vectorColTileSize, 0},
+                                 {0, 0, vectorColTileSize}};
+  return setOpConfigAndEntryPointFnTranslation(
+      entryPointFn, attnOp, tileSizes,
+      DispatchLoweringPassPipeline::CPULinalgExtTileAndVectorize);
+}
+
 /// Redirects to methods that set the configuration based on operation type.
 static LogicalResult setRootConfigImpl(
     func::FuncOp entryPointFn, Operation *op,
@@ -1844,6 +1979,8 @@ static LogicalResult setRootConfigImpl(
             })
         .Case<tensor::UnPackOp>(
             [&](auto op) { return setUnPackOpRootConfig(entryPointFn, op); })
+        .Case<IREE::LinalgExt::AttentionOp>(
+            [&](auto op) { return setRootConfig(entryPointFn, op); })
         .Case<linalg::ContractionOpInterface>(
             [&](auto op) { return setRootConfig(entryPointFn, op); })
         .Case<linalg::LinalgOp>(
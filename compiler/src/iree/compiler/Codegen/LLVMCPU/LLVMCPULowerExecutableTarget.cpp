@@ -297,6 +297,13 @@ void LLVMCPULowerExecutableTargetPass::runOnOperation() {
             addCPUDataTilingPipeline(executableLoweringPipeline, tilingConfig);
             break;
           }
+          case IREE::Codegen::DispatchLoweringPassPipeline::
+              CPULinalgExtTileAndVectorize: {
+            TilingConfig tilingConfig = getTilingConfigForPipeline(variantOp);
+            addCPULinalgExtTileAndVectorizePipeline(executableLoweringPipeline,
+                                                    tilingConfig);
+            break;
+          }
           case IREE::Codegen::DispatchLoweringPassPipeline::VMVXDefault:
             addVMVXDefaultPassPipeline(executableLoweringPipeline,
                                        enableMicrokernels);
@@ -131,6 +131,9 @@ void LLVMCPUMaterializeEncodingPass::runOnOperation() {
             chooseMatmulTileParams(*matmulType, targetAttr);
         auto encodingInfo = chooseEncodingInfoForMatmul(
             *matmulType, *matmulOperandRole, tileParams);
+        if (isBatchMatmulEncoding(*encoding)) {
+          adjustEncodingInfoForBatchMatmul(encodingInfo);
+        }
         adjustTileSizesToNarrowStaticShape(encodingInfo, tensorType.getShape());
         return encodingInfo;
       });
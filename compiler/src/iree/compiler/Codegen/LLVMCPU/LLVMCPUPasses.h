@@ -131,6 +131,11 @@ void addCPUBufferOpsTileAndVectorizePipeline(OpPassManager &passManager,
 void addCPUDataTilingPipeline(OpPassManager &passManager,
                               TilingConfig &tilingConfig);
 
+/// Populates the passes to tile, decompose and vectorize LinalgExt ops that
+/// have a dedicated decomposition, e.g. iree_linalg_ext.attention.
+void addCPULinalgExtTileAndVectorizePipeline(OpPassManager &passManager,
+                                             TilingConfig &tilingConfig);
+
 /// Populates the passes to lower to scalars operations for linalg based
 /// code-generation. This pipeline does not vectorize, but instead just
 /// converts to memrefs
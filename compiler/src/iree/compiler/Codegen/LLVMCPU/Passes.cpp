@@ -129,7 +129,8 @@ static void addBufferizePasses(OpPassManager &passManager) {
       createEraseHALDescriptorTypeFromMemRefPass());
 }
 
-static void addTileAndDistributePasses(OpPassManager &pm) {
+static void addTileAndDistributePasses(OpPassManager &pm,
+                                       uint64_t attentionTileSize = 0) {
   pm.addPass(createTileAndDistributeToWorkgroupsPass());
   auto &nestedModulePM = pm.nest<ModuleOp>();
   nestedModulePM.addNestedPass<func::FuncOp>(
@@ -143,7 +144,7 @@ static void addTileAndDistributePasses(OpPassManager &pm) {
   nestedModulePM.addNestedPass<func::FuncOp>(
       createConcretizePadResultShapePass());
   nestedModulePM.addNestedPass<func::FuncOp>(
-      IREE::LinalgExt::createTileAndDecomposeAttentionPass());
+      IREE::LinalgExt::createTileAndDecomposeAttentionPass(attentionTileSize));
   nestedModulePM.addNestedPass<func::FuncOp>(
       IREE::LinalgExt::createTileAndDecomposeWinogradTransformPass());
 }
@@ -632,6 +633,47 @@ void addCPUDataTilingPipeline(OpPassManager &passManager,
   }
 }
 
+void addCPULinalgExtTileAndVectorizePipeline(OpPassManager &passManager,
+                                             TilingConfig &tilingConfig) {
+  // The cache reduction level of an attention op holds the key/value block
+  // size of the online softmax loop.
+  uint64_t attentionTileSize = 0;
+  if (tilingConfig.getNumTilingLevels() == 5) {
+    SmallVector<int64_t> cacheReductionSizes =
+        tilingConfig.getCacheReductionSizes();
+    if (cacheReductionSizes.size() > 1) {
+      attentionTileSize = cacheReductionSizes[1];
+    }
+  }
+  addTileAndDistributePasses(passManager, attentionTileSize);
+
+  // The decomposed ops inherit the lowering config of the attention op; tile
+  // them to vector sizes so that realistic head dimensions and block sizes do
+  // not turn into huge vectors.
+  OpPassManager &nestedModulePM = passManager.nest<ModuleOp>();
+  if (tilingConfig.getNumTilingLevels() == 5) {
+    nestedModulePM.addNestedPass<func::FuncOp>(
+        createLLVMCPUTilePass(tilingConfig.getVectorParallelLevel()));
+    nestedModulePM.addNestedPass<func::FuncOp>(
+        createLLVMCPUTilePass(tilingConfig.getVectorReductionLevel()));
+  }
+  nestedModulePM.addNestedPass<func::FuncOp>(createLLVMCPUVectorizationPass());
+  nestedModulePM.addNestedPass<func::FuncOp>(createCanonicalizerPass());
+  nestedModulePM.addNestedPass<func::FuncOp>(createCSEPass());
+
+  addBufferizePasses(nestedModulePM);
+
+  nestedModulePM.addNestedPass<func::FuncOp>(
+      createRemoveSingleIterationLoopPass());
+
+  {
+    LLVMCPUVectorLoweringPassOptions options;
+    options.splitVectorTransfersTo = "linalg-copy";
+    nestedModulePM.addNestedPass<func::FuncOp>(
+        createLLVMCPUVectorLoweringPass(options));
+  }
+}
+
 void addCPUDefaultPassPipeline(OpPassManager &passManager) {
   addTileAndDistributePasses(passManager);
   OpPassManager &nestedModulePM = passManager.nest<ModuleOp>();
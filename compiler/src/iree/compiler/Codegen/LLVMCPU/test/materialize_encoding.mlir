@@ -759,3 +759,96 @@ func.func @matmul_lowering_i8i8i32_x86_64_avx512vnni() attributes {
 // CHECK-SAME:       outs(%[[OUTS]] :
 //      CHECK:   flow.dispatch.tensor.store %[[MMT4D]], %[[OUTS_BINDING]]
 // CHECK-SAME:       offsets = [0, 0, 0, 0], sizes = [%[[TILED_M]], %[[TILED_N]], 16, 16], strides = [1, 1, 1, 1]
+
+// -----
+
+func.func @batch_matmul_lowering_f32f32f32_x86_64_avx512f() attributes {
+  hal.executable.target = #hal.executable.target<"xyz", "xyz", {target_triple="x86_64-xyz-xyz", cpu_features="+avx512f"}>
+} {
+  %c0 = arith.constant 0 : index
+  %0 = hal.interface.binding.subspan set(0) binding(0) type(storage_buffer) alignment(64) offset(%c0)
+      : !flow.dispatch.tensor<readonly:tensor<2x128x256xf32, #iree_linalg_ext.encoding<BATCH_MATMUL_F32F32F32_LHS>>>
+  %1 = hal.interface.binding.subspan set(0) binding(1) type(storage_buffer) alignment(64) offset(%c0)
+      : !flow.dispatch.tensor<readonly:tensor<2x256x512xf32, #iree_linalg_ext.encoding<BATCH_MATMUL_F32F32F32_RHS>>>
+  %2 = hal.interface.binding.subspan set(0) binding(2) type(storage_buffer) alignment(64) offset(%c0)
+      : !flow.dispatch.tensor<readwrite:tensor<2x128x512xf32, #iree_linalg_ext.encoding<BATCH_MATMUL_F32F32F32_RESULT>>>
+  %3 = flow.dispatch.tensor.load %0, offsets = [0, 0, 0], sizes = [2, 128, 256], strides = [1, 1, 1]
+      : !flow.dispatch.tensor<readonly:tensor<2x128x256xf32, #iree_linalg_ext.encoding<BATCH_MATMUL_F32F32F32_LHS>>>
+      -> tensor<2x128x256xf32, #iree_linalg_ext.encoding<BATCH_MATMUL_F32F32F32_LHS>>
+  %4 = flow.dispatch.tensor.load %1, offsets = [0, 0, 0], sizes = [2, 256, 512], strides = [1, 1, 1]
+      : !flow.dispatch.tensor<readonly:tensor<2x256x512xf32, #iree_linalg_ext.encoding<BATCH_MATMUL_F32F32F32_RHS>>>
+      -> tensor<2x256x512xf32, #iree_linalg_ext.encoding<BATCH_MATMUL_F32F32F32_RHS>>
+  %5 = flow.dispatch.tensor.load %2, offsets = [0, 0, 0], sizes = [2, 128, 512], strides = [1, 1, 1]
+      : !flow.dispatch.tensor<readwrite:tensor<2x128x512xf32, #iree_linalg_ext.encoding<BATCH_MATMUL_F32F32F32_RESULT>>>
+      -> tensor<2x128x512xf32, #iree_linalg_ext.encoding<BATCH_MATMUL_F32F32F32_RESULT>>
+  %6 = linalg.batch_matmul
+      ins(%3, %4 : tensor<2x128x256xf32, #iree_linalg_ext.encoding<BATCH_MATMUL_F32F32F32_LHS>>,
+                   tensor<2x256x512xf32, #iree_linalg_ext.encoding<BATCH_MATMUL_F32F32F32_RHS>>)
+      outs(%5 : tensor<2x128x512xf32, #iree_linalg_ext.encoding<BATCH_MATMUL_F32F32F32_RESULT>>)
+      -> tensor<2x128x512xf32, #iree_linalg_ext.encoding<BATCH_MATMUL_F32F32F32_RESULT>>
+  flow.dispatch.tensor.store %6, %2, offsets = [0, 0, 0], sizes = [2, 128, 512], strides = [1, 1, 1]
+      : tensor<2x128x512xf32, #iree_linalg_ext.encoding<BATCH_MATMUL_F32F32F32_RESULT>>
+      -> !flow.dispatch.tensor<readwrite:tensor<2x128x512xf32, #iree_linalg_ext.encoding<BATCH_MATMUL_F32F32F32_RESULT>>>
+  return
+}
+//  CHECK-DAG: #[[MAP_LHS:.+]] = affine_map<(d0, d1, d2, d3, d4, d5, d6) -> (d0, d1, d3, d4, d6)>
+//  CHECK-DAG: #[[MAP_RHS:.+]] = affine_map<(d0, d1, d2, d3, d4, d5, d6) -> (d0, d2, d3, d5, d6)>
+//  CHECK-DAG: #[[MAP_RESULT:.+]] = affine_map<(d0, d1, d2, d3, d4, d5, d6) -> (d0, d1, d2, d4, d5)>
+//      CHECK: func @batch_matmul_lowering_f32f32f32_x86_64_avx512f()
+//      CHECK:   %[[LHS_BINDING:.+]] = hal.interface.binding.subspan set(0) binding(0)
+// CHECK-SAME:       !flow.dispatch.tensor<readonly:tensor<2x8x256x16x1xf32>>
+//      CHECK:   %[[RHS_BINDING:.+]] = hal.interface.binding.subspan set(0) binding(1)
+// CHECK-SAME:       !flow.dispatch.tensor<readonly:tensor<2x32x256x16x1xf32>>
+//      CHECK:   %[[OUTS_BINDING:.+]] = hal.interface.binding.subspan set(0) binding(2)
+// CHECK-SAME:       !flow.dispatch.tensor<readwrite:tensor<2x8x32x16x16xf32>>
+//      CHECK:   %[[LHS:.+]] = flow.dispatch.tensor.load %[[LHS_BINDING]]
+//      CHECK:   %[[RHS:.+]] = flow.dispatch.tensor.load %[[RHS_BINDING]]
+//      CHECK:   %[[OUTS:.+]] = flow.dispatch.tensor.load %[[OUTS_BINDING]]
+//      CHECK:   %[[BATCH_MMT4D:.+]] = linalg.generic
+// CHECK-SAME:       indexing_maps = [#[[MAP_LHS]], #[[MAP_RHS]], #[[MAP_RESULT]]]
+// CHECK-SAME:       ins(%[[LHS]], %[[RHS]] :
+// CHECK-SAME:       outs(%[[OUTS]] :
+//      CHECK:   flow.dispatch.tensor.store %[[BATCH_MMT4D]], %[[OUTS_BINDING]]
+// CHECK-SAME:       offsets = [0, 0, 0, 0, 0], sizes = [2, 8, 32, 16, 16], strides = [1, 1, 1, 1, 1]
+
+// -----
+
+func.func @vecmat_lowering_f32f32f32_x86_64_avx512f() attributes {
+  hal.executable.target = #hal.executable.target<"xyz", "xyz", {target_triple="x86_64-xyz-xyz", cpu_features="+avx512f"}>
+} {
+  %c0 = arith.constant 0 : index
+  %0 = hal.interface.binding.subspan set(0) binding(0) type(storage_buffer) alignment(64) offset(%c0)
+      : !flow.dispatch.tensor<readonly:tensor<1x256xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_LHS>>>
+  %1 = hal.interface.binding.subspan set(0) binding(1) type(storage_buffer) alignment(64) offset(%c0)
+      : !flow.dispatch.tensor<readonly:tensor<256x512xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RHS>>>
+  %2 = hal.interface.binding.subspan set(0) binding(2) type(storage_buffer) alignment(64) offset(%c0)
+      : !flow.dispatch.tensor<readwrite:tensor<1x512xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RESULT>>>
+  %3 = flow.dispatch.tensor.load %0, offsets = [0, 0], sizes = [1, 256], strides = [1, 1]
+      : !flow.dispatch.tensor<readonly:tensor<1x256xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_LHS>>>
+      -> tensor<1x256xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_LHS>>
+  %4 = flow.dispatch.tensor.load %1, offsets = [0, 0], sizes = [256, 512], strides = [1, 1]
+      : !flow.dispatch.tensor<readonly:tensor<256x512xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RHS>>>
+      -> tensor<256x512xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RHS>>
+  %5 = flow.dispatch.tensor.load %2, offsets = [0, 0], sizes = [1, 512], strides = [1, 1]
+      : !flow.dispatch.tensor<readwrite:tensor<1x512xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RESULT>>>
+      -> tensor<1x512xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RESULT>>
+  %6 = linalg.matmul
+      ins(%3, %4 : tensor<1x256xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_LHS>>,
+                   tensor<256x512xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RHS>>)
+      outs(%5 : tensor<1x512xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RESULT>>)
+      -> tensor<1x512xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RESULT>>
+  flow.dispatch.tensor.store %6, %2, offsets = [0, 0], sizes = [1, 512], strides = [1, 1]
+      : tensor<1x512xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RESULT>>
+      -> !flow.dispatch.tensor<readwrite:tensor<1x512xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RESULT>>>
+  return
+}
+//      CHECK: func @vecmat_lowering_f32f32f32_x86_64_avx512f()
+//      CHECK:   %[[LHS_BINDING:.+]] = hal.interface.binding.subspan set(0) binding(0)
+// CHECK-SAME:       !flow.dispatch.tensor<readonly:tensor<1x256x1x1xf32>>
+//      CHECK:   %[[RHS_BINDING:.+]] = hal.interface.binding.subspan set(0) binding(1)
+// CHECK-SAME:       !flow.dispatch.tensor<readonly:tensor<32x256x16x1xf32>>
+//      CHECK:   %[[OUTS_BINDING:.+]] = hal.interface.binding.subspan set(0) binding(2)
+// CHECK-SAME:       !flow.dispatch.tensor<readwrite:tensor<1x32x1x16xf32>>
+//      CHECK:   %[[MMT4D:.+]] = linalg.mmt4d
+//      CHECK:   flow.dispatch.tensor.store %[[MMT4D]], %[[OUTS_BINDING]]
+// CHECK-SAME:       offsets = [0, 0, 0, 0], sizes = [1, 32, 1, 16], strides = [1, 1, 1, 1]
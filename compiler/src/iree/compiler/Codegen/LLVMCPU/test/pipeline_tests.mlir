@@ -761,3 +761,49 @@ hal.executable private @aarch64_ssve_sve_disabled {
 
 // CHECK-LABEL: @aarch64_ssve_sve_disabled
 // CHECK-NOT: func.func @dispatch() attributes {arm_locally_streaming}
+
+// -----
+
+// Check that the decomposed attention ops are tiled to vector sizes instead of
+// being vectorized at the size of the query and key/value blocks.
+#executable_target_embedded_elf_x86_64_ = #hal.executable.target<"llvm-cpu", "embedded-elf-x86_64", {
+  cpu_features = "",
+  data_layout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-f80:128-n8:16:32:64-S128",
+  native_vector_size = 64 : index,
+  target_triple = "x86_64-unknown-unknown-eabi-elf"}>
+#pipeline_layout = #hal.pipeline.layout<push_constants = 0, sets = [
+  #hal.descriptor_set.layout<0, bindings = [
+    #hal.descriptor_set.binding<0, storage_buffer>,
+    #hal.descriptor_set.binding<1, storage_buffer>,
+    #hal.descriptor_set.binding<2, storage_buffer>,
+    #hal.descriptor_set.binding<3, storage_buffer>]
+  >]>
+hal.executable private @attention {
+  hal.executable.variant public @embedded_elf_x86_64, target = #executable_target_embedded_elf_x86_64_ {
+    hal.executable.export public @attention ordinal(0) layout(#pipeline_layout) {
+    ^bb0(%arg0: !hal.device):
+      %x, %y, %z = flow.dispatch.workgroup_count_from_slice
+      hal.return %x, %y, %z : index, index, index
+    }
+    builtin.module {
+      func.func @attention() {
+        %c0 = arith.constant 0 : index
+        %0 = hal.interface.binding.subspan set(0) binding(0) type(storage_buffer) alignment(64) offset(%c0) : !flow.dispatch.tensor<readonly:tensor<20x1024x128xf32>>
+        %1 = hal.interface.binding.subspan set(0) binding(1) type(storage_buffer) alignment(64) offset(%c0) : !flow.dispatch.tensor<readonly:tensor<20x512x128xf32>>
+        %2 = hal.interface.binding.subspan set(0) binding(2) type(storage_buffer) alignment(64) offset(%c0) : !flow.dispatch.tensor<readonly:tensor<20x512x128xf32>>
+        %3 = hal.interface.binding.subspan set(0) binding(3) type(storage_buffer) alignment(64) offset(%c0) : !flow.dispatch.tensor<writeonly:tensor<20x1024x128xf32>>
+        %4 = flow.dispatch.tensor.load %0, offsets = [0, 0, 0], sizes = [20, 1024, 128], strides = [1, 1, 1] : !flow.dispatch.tensor<readonly:tensor<20x1024x128xf32>> -> tensor<20x1024x128xf32>
+        %5 = flow.dispatch.tensor.load %1, offsets = [0, 0, 0], sizes = [20, 512, 128], strides = [1, 1, 1] : !flow.dispatch.tensor<readonly:tensor<20x512x128xf32>> -> tensor<20x512x128xf32>
+        %6 = flow.dispatch.tensor.load %2, offsets = [0, 0, 0], sizes = [20, 512, 128], strides = [1, 1, 1] : !flow.dispatch.tensor<readonly:tensor<20x512x128xf32>> -> tensor<20x512x128xf32>
+        %7 = tensor.empty() : tensor<20x1024x128xf32>
+        %8 = iree_linalg_ext.attention ins(%4, %5, %6 : tensor<20x1024x128xf32>, tensor<20x512x128xf32>, tensor<20x512x128xf32>) outs(%7 : tensor<20x1024x128xf32>) -> tensor<20x1024x128xf32>
+        flow.dispatch.tensor.store %8, %3, offsets = [0, 0, 0], sizes = [20, 1024, 128], strides = [1, 1, 1] : tensor<20x1024x128xf32> -> !flow.dispatch.tensor<writeonly:tensor<20x1024x128xf32>>
+        return
+      }
+    }
+  }
+}
+// CHECK-LABEL: func.func @attention()
+//   CHECK-NOT:   vector<64x
+//   CHECK-NOT:   vector<32x128
+//       CHECK:   vector.fma
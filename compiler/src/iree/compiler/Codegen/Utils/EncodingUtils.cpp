@@ -44,10 +44,16 @@ std::optional<MatmulType> getMatmulType(TensorEncoding encoding) {
     case TensorEncoding::MATMUL_F32F32F32_LHS:
     case TensorEncoding::MATMUL_F32F32F32_RHS:
     case TensorEncoding::MATMUL_F32F32F32_RESULT:
+    case TensorEncoding::BATCH_MATMUL_F32F32F32_LHS:
+    case TensorEncoding::BATCH_MATMUL_F32F32F32_RHS:
+    case TensorEncoding::BATCH_MATMUL_F32F32F32_RESULT:
       return MatmulType::F32F32F32;
     case TensorEncoding::MATMUL_I8I8I32_LHS:
     case TensorEncoding::MATMUL_I8I8I32_RHS:
     case TensorEncoding::MATMUL_I8I8I32_RESULT:
+    case TensorEncoding::BATCH_MATMUL_I8I8I32_LHS:
+    case TensorEncoding::BATCH_MATMUL_I8I8I32_RHS:
+    case TensorEncoding::BATCH_MATMUL_I8I8I32_RESULT:
       return MatmulType::I8I8I32;
     default:
       return std::nullopt;
@@ -58,17 +64,37 @@ std::optional<MatmulOperandRole> getMatmulOperandRole(TensorEncoding encoding) {
   switch (encoding) {
     case TensorEncoding::MATMUL_F32F32F32_LHS:
     case TensorEncoding::MATMUL_I8I8I32_LHS:
+    case TensorEncoding::BATCH_MATMUL_F32F32F32_LHS:
+    case TensorEncoding::BATCH_MATMUL_I8I8I32_LHS:
       return MatmulOperandRole::LHS;
     case TensorEncoding::MATMUL_F32F32F32_RHS:
     case TensorEncoding::MATMUL_I8I8I32_RHS:
+    case TensorEncoding::BATCH_MATMUL_F32F32F32_RHS:
+    case TensorEncoding::BATCH_MATMUL_I8I8I32_RHS:
       return MatmulOperandRole::RHS;
     case TensorEncoding::MATMUL_F32F32F32_RESULT:
     case TensorEncoding::MATMUL_I8I8I32_RESULT:
+    case TensorEncoding::BATCH_MATMUL_F32F32F32_RESULT:
+    case TensorEncoding::BATCH_MATMUL_I8I8I32_RESULT:
       return MatmulOperandRole::RESULT;
     default:
       return std::nullopt;
   }
 }
 
+bool isBatchMatmulEncoding(TensorEncoding encoding) {
+  switch (encoding) {
+    case TensorEncoding::BATCH_MATMUL_F32F32F32_LHS:
+    case TensorEncoding::BATCH_MATMUL_F32F32F32_RHS:
+    case TensorEncoding::BATCH_MATMUL_F32F32F32_RESULT:
+    case TensorEncoding::BATCH_MATMUL_I8I8I32_LHS:
+    case TensorEncoding::BATCH_MATMUL_I8I8I32_RHS:
+    case TensorEncoding::BATCH_MATMUL_I8I8I32_RESULT:
+      return true;
+    default:
+      return false;
+  }
+}
+
 }  // namespace iree_compiler
 }  // namespace mlir
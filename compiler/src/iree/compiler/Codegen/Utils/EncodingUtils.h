@@ -48,6 +48,10 @@ std::optional<MatmulType> getMatmulType(
 std::optional<MatmulOperandRole> getMatmulOperandRole(
     IREE::LinalgExt::TensorEncoding encoding);
 
+// Returns true if the TensorEncoding is that of an operand of a batch matmul.
+// Such operands have a leading batch dimension that is not tiled.
+bool isBatchMatmulEncoding(IREE::LinalgExt::TensorEncoding encoding);
+
 }  // namespace iree_compiler
 }  // namespace mlir
 
@@ -82,10 +82,17 @@ void VMVXMaterializeEncodingPass::runOnOperation() {
         if (!matmulType || !matmulOperandRole) {
           return failure();
         }
+        // The tile size query microkernel only handles 2-D operands so batch
+        // matmul operands always use static tile sizes.
+        bool isBatchMatmul = isBatchMatmulEncoding(*encoding);
         MatmulTileParams tileParams =
-            chooseMatmulTileParams(*matmulType, targetAttr);
+            isBatchMatmul ? chooseMatmulTileParamsGeneric()
+                          : chooseMatmulTileParams(*matmulType, targetAttr);
         auto encodingInfo = chooseEncodingInfoForMatmul(
             *matmulType, *matmulOperandRole, tileParams);
+        if (isBatchMatmul) {
+          adjustEncodingInfoForBatchMatmul(encodingInfo);
+        }
         adjustTileSizesToNarrowStaticShape(encodingInfo, tensorType.getShape());
         return encodingInfo;
       });
@@ -7,6 +7,8 @@
 #include "iree/compiler/Dialect/Flow/IR/FlowOps.h"
 #include "iree/compiler/Dialect/Flow/Transforms/PassDetail.h"
 #include "iree/compiler/Dialect/Flow/Transforms/Passes.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/PostOrderIterator.h"
 #include "llvm/ADT/SetVector.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"
@@ -37,14 +39,144 @@ bool compare_ranges(Range &&lhs, Range &&rhs, Pred pred) {
   return true;
 }
 
+// Symbols defined within an executable mapped to their lexical ordinal.
+// Executables are compared by where their symbols are defined instead of by
+// name so that copies that only differ in their function names still match.
+using LocalSymbolMap = DenseMap<StringAttr, unsigned>;
+
+static LocalSymbolMap buildLocalSymbolMap(ExecutableOp executableOp) {
+  LocalSymbolMap symbols;
+  executableOp.getBody().walk<WalkOrder::PreOrder>([&](Operation *op) {
+    if (auto symName = op->getAttrOfType<StringAttr>(
+            SymbolTable::getSymbolAttrName())) {
+      symbols.try_emplace(symName, symbols.size());
+    }
+  });
+  return symbols;
+}
+
+// Local symbol tables of the executables being compared.
+struct SymbolMapping {
+  const LocalSymbolMap &lhs;
+  const LocalSymbolMap &rhs;
+};
+
+// Returns true if |lhs| and |rhs| reference the same symbol: either the same
+// local symbol ordinal in their respective executables or the same external
+// symbol.
+static bool isEquivalentSymbolRef(SymbolRefAttr lhs, SymbolRefAttr rhs,
+                                  const SymbolMapping &symbols) {
+  if (lhs.getNestedReferences() != rhs.getNestedReferences()) return false;
+  auto lhsIt = symbols.lhs.find(lhs.getRootReference());
+  auto rhsIt = symbols.rhs.find(rhs.getRootReference());
+  bool lhsIsLocal = lhsIt != symbols.lhs.end();
+  bool rhsIsLocal = rhsIt != symbols.rhs.end();
+  if (lhsIsLocal != rhsIsLocal) return false;
+  if (!lhsIsLocal) return lhs.getRootReference() == rhs.getRootReference();
+  return lhsIt->second == rhsIt->second;
+}
+
+static bool isEquivalentAttr(Attribute lhs, Attribute rhs,
+                             const SymbolMapping &symbols) {
+  auto lhsSymbolRef = llvm::dyn_cast<SymbolRefAttr>(lhs);
+  auto rhsSymbolRef = llvm::dyn_cast<SymbolRefAttr>(rhs);
+  if (lhsSymbolRef && rhsSymbolRef) {
+    return isEquivalentSymbolRef(lhsSymbolRef, rhsSymbolRef, symbols);
+  }
+  // Symbol refs nested within other attributes are compared by name. This is
+  // conservative: it may miss a duplicate but never merges distinct ones.
+  return lhs == rhs;
+}
+
+// Hashes the structure of |executableOp| such that any two executables that
+// are isStructurallyEquivalentTo each other produce the same hash. Values and
+// blocks are numbered in lexical order and local symbol references are hashed
+// by their ordinal in |symbols| so that the hash is independent of SSA and
+// symbol naming.
+static llvm::hash_code computeStructuralHash(ExecutableOp executableOp,
+                                             const LocalSymbolMap &symbols) {
+  // Number all values and blocks up-front as operands and successors may
+  // reference ones defined lexically after their users.
+  DenseMap<Value, unsigned> valueIds;
+  DenseMap<Block *, unsigned> blockIds;
+  auto numberRegion = [&](Region &region) {
+    for (Block &block : region) {
+      blockIds.try_emplace(&block, blockIds.size());
+      for (auto arg : block.getArguments()) {
+        valueIds.try_emplace(arg, valueIds.size());
+      }
+    }
+  };
+  numberRegion(executableOp.getBody());
+  executableOp.getBody().walk<WalkOrder::PreOrder>([&](Operation *op) {
+    for (auto result : op->getResults()) {
+      valueIds.try_emplace(result, valueIds.size());
+    }
+    for (auto &region : op->getRegions()) numberRegion(region);
+  });
+
+  auto hashAttr = [&](Attribute attr) -> llvm::hash_code {
+    auto symbolRef = llvm::dyn_cast<SymbolRefAttr>(attr);
+    if (!symbolRef) return hash_value(attr);
+    auto nestedHash =
+        llvm::hash_combine_range(symbolRef.getNestedReferences().begin(),
+                                 symbolRef.getNestedReferences().end());
+    auto it = symbols.find(symbolRef.getRootReference());
+    if (it == symbols.end()) {
+      return llvm::hash_combine(symbolRef.getRootReference(), nestedHash);
+    }
+    return llvm::hash_combine(it->second, nestedHash);
+  };
+  auto hashRegions = [&](Operation *op, llvm::hash_code hash) {
+    for (auto &region : op->getRegions()) {
+      for (Block &block : region) {
+        hash = llvm::hash_combine(hash, block.getOperations().size(),
+                                  block.getNumArguments());
+        for (auto argType : block.getArgumentTypes()) {
+          hash = llvm::hash_combine(hash, argType);
+        }
+      }
+    }
+    return hash;
+  };
+
+  llvm::hash_code hash = hashRegions(executableOp, llvm::hash_code(1));
+  executableOp.getBody().walk<WalkOrder::PreOrder>([&](Operation *op) {
+    hash = llvm::hash_combine(hash, op->getName(), op->getNumOperands(),
+                              op->getNumResults(), op->getNumRegions(),
+                              op->getNumSuccessors());
+    for (auto namedAttr : op->getAttrs()) {
+      if (namedAttr.getName() == SymbolTable::getSymbolAttrName()) continue;
+      hash = llvm::hash_combine(hash, namedAttr.getName(),
+                                hashAttr(namedAttr.getValue()));
+    }
+    for (auto result : op->getResults()) {
+      hash = llvm::hash_combine(hash, result.getType());
+    }
+    for (auto operand : op->getOperands()) {
+      hash = llvm::hash_combine(hash, operand.getType(),
+                                valueIds.lookup(operand));
+    }
+    for (auto *successor : op->getSuccessors()) {
+      hash = llvm::hash_combine(hash, blockIds.lookup(successor));
+    }
+    hash = hashRegions(op, hash);
+  });
+  return hash;
+}
+
 static bool isStructurallyEquivalentTo(Region &lhs, Region &rhs,
-                                       IRMapping &parentMapping);
+                                       IRMapping &parentMapping,
+                                       const SymbolMapping &symbols);
 static bool isStructurallyEquivalentTo(Operation &lhs, Operation &rhs,
-                                       IRMapping &parentMapping);
+                                       IRMapping &parentMapping,
+                                       const SymbolMapping &symbols);
 
 // Recursively compares two regions for structural equivalence.
 // Structural equivalence ensures that operations on both the |lhs| and |rhs|
-// have the same attributes and same use-def structure.
+// have the same attributes and same use-def structure. Symbol references to
+// symbols defined within the regions are compared by their local ordinal in
+// |symbols| such that the symbol names themselves may differ.
 //
 // Example:
 //   func.func @lhs(%arg0 : index) -> index {
@@ -61,14 +193,15 @@ static bool isStructurallyEquivalentTo(Operation &lhs, Operation &rhs,
 //   assert(isStructurallyEquivalentTo(lhs.getBody(), rhs.getBody()));
 //
 // TODO(#3996): upstream into mlir::OperationEquivalence if this works.
-// TODO(#3996): add symbol ref comparison (add to IRMapping).
-static bool isStructurallyEquivalentTo(Region &lhs, Region &rhs) {
+static bool isStructurallyEquivalentTo(Region &lhs, Region &rhs,
+                                       const SymbolMapping &symbols) {
   IRMapping mapping;
-  return isStructurallyEquivalentTo(lhs, rhs, mapping);
+  return isStructurallyEquivalentTo(lhs, rhs, mapping, symbols);
 }
 
 static bool isStructurallyEquivalentTo(Region &lhs, Region &rhs,
-                                       IRMapping &mapping) {
+                                       IRMapping &mapping,
+                                       const SymbolMapping &symbols) {
   // Use compare_ranges to walk the block list in parallel and get a boolean in
   // the case of size mismatch without an O(N) linked-list size query.
   if (!compare_ranges(
@@ -107,7 +240,7 @@ static bool isStructurallyEquivalentTo(Region &lhs, Region &rhs,
     auto &rhsOperations = rhsBlock->getOperations();
     if (lhsOperations.size() != rhsOperations.size()) return false;
     for (auto [lhsOp, rhsOp] : llvm::zip_equal(lhsOperations, rhsOperations)) {
-      if (!isStructurallyEquivalentTo(lhsOp, rhsOp, mapping)) {
+      if (!isStructurallyEquivalentTo(lhsOp, rhsOp, mapping, symbols)) {
         return false;
       }
     }
@@ -118,7 +251,8 @@ static bool isStructurallyEquivalentTo(Region &lhs, Region &rhs,
 }
 
 static bool isStructurallyEquivalentTo(Operation &lhs, Operation &rhs,
-                                       IRMapping &parentMapping) {
+                                       IRMapping &parentMapping,
+                                       const SymbolMapping &symbols) {
   // Check operation metadata for early-exit opportunities.
   if (lhs.getName() != rhs.getName()) return false;
   if (lhs.getNumOperands() != rhs.getNumOperands()) return false;
@@ -126,15 +260,13 @@ static bool isStructurallyEquivalentTo(Operation &lhs, Operation &rhs,
   if (lhs.getNumRegions() != rhs.getNumRegions()) return false;
   if (lhs.getNumSuccessors() != rhs.getNumSuccessors()) return false;
 
-  // TODO(#3996): symbol mapping; for now allow them to differ unconditionally.
+  // Symbol names may differ as references to them are compared by ordinal.
   if (!compare_ranges(
           lhs.getAttrs(), rhs.getAttrs(),
           [&](const NamedAttribute &lhs, const NamedAttribute &rhs) {
-            if (lhs.getName() == "function_ref" ||
-                lhs.getName() == SymbolTable::getSymbolAttrName()) {
-              return true;
-            }
-            return lhs == rhs;
+            if (lhs.getName() != rhs.getName()) return false;
+            if (lhs.getName() == SymbolTable::getSymbolAttrName()) return true;
+            return isEquivalentAttr(lhs.getValue(), rhs.getValue(), symbols);
           })) {
     return false;
   }
@@ -173,7 +305,8 @@ static bool isStructurallyEquivalentTo(Operation &lhs, Operation &rhs,
     IRMapping regionMapping = lhs.hasTrait<OpTrait::IsIsolatedFromAbove>()
                                   ? scopedRegionMapping
                                   : parentMapping;
-    if (!isStructurallyEquivalentTo(lhsRegion, rhsRegion, regionMapping)) {
+    if (!isStructurallyEquivalentTo(lhsRegion, rhsRegion, regionMapping,
+                                    symbols)) {
       return false;
     }
   }
@@ -208,63 +341,64 @@ class DeduplicateExecutablesPass
   void runOnOperation() override {
     auto moduleOp = getOperation();
 
-    // Bucket based on the hash of the names of at most the first 5 ops.
-    // 5 was randomly chosen to be small enough to not increase overhead much,
-    // but giving at least enough of a sample that there is some bucketing. This
-    // was not empiraclly deetermined.
-    llvm::MapVector<uint32_t, SmallVector<ExecutableOp, 3>> executableOpsMap;
-    totalExecutables = 0;
-    for (auto op : moduleOp.getOps<ExecutableOp>()) {
-      int count = 0;
-      llvm::hash_code hash(1);
-      op.walk([&](Operation *it) {
-        hash = llvm::hash_combine(hash, it->getName());
-        return (++count >= 5) ? WalkResult::interrupt() : WalkResult::advance();
-      });
-      executableOpsMap[hash_value(hash)].push_back(op);
-      ++totalExecutables;
+    // Bucket executables by their structural hash. Each bucket holds the
+    // unique executables seen so far with that hash and any executable that
+    // lands in a bucket only needs to be compared against those. As all
+    // executables in a bucket are almost always equivalent this keeps the pass
+    // linear in the number of executables instead of quadratic.
+    SmallVector<ExecutableOp> executableOps;
+    SmallVector<LocalSymbolMap> executableSymbols;
+    for (auto executableOp : moduleOp.getOps<ExecutableOp>()) {
+      executableOps.push_back(executableOp);
+      executableSymbols.push_back(buildLocalSymbolMap(executableOp));
     }
+    totalExecutables = executableOps.size();
 
     auto builder = OpBuilder::atBlockBegin(moduleOp.getBody());
     SmallVector<ExecutableOp, 3> duplicateExecutableOps;
     DenseMap<Attribute, SymbolRefAttr> entryPointRefReplacements;
 
     // For each executable, find the first executable which it is equivalent to.
-    for (auto &[key, executableOps] : executableOpsMap) {
-      (void)key;
-      for (int i = executableOps.size() - 1; i >= 0; --i) {
-        auto duplicateExecutableOp = executableOps[i];
-
-        for (int j = 0; j < i; ++j) {
-          auto referenceExecutableOp = executableOps[j];
-          if (!isStructurallyEquivalentTo(duplicateExecutableOp.getBody(),
-                                          referenceExecutableOp.getBody())) {
-            continue;
-          }
-
-          // Found an equivalent executable! Record it and move on to the next.
-          duplicateExecutableOps.push_back(duplicateExecutableOp);
-
-          // Record entry point reference replacements.
-          for (auto [oldExportOp, newExportOp] :
-               llvm::zip_equal(duplicateExecutableOp.getBlock()
-                                   .getOps<ExecutableExportOp>(),
-                               referenceExecutableOp.getBlock()
-                                   .getOps<ExecutableExportOp>())) {
-            auto oldSymbolRefAttr = SymbolRefAttr::get(
-                builder.getContext(), duplicateExecutableOp.getName(),
-                {SymbolRefAttr::get(builder.getContext(),
-                                    oldExportOp.getSymName())});
-            auto newSymbolRefAttr = SymbolRefAttr::get(
-                builder.getContext(), referenceExecutableOp.getName(),
-                {SymbolRefAttr::get(builder.getContext(),
-                                    newExportOp.getSymName())});
-            entryPointRefReplacements[oldSymbolRefAttr] = newSymbolRefAttr;
-          }
-
-          break;
+    DenseMap<size_t, SmallVector<unsigned, 1>> uniqueExecutableBuckets;
+    for (unsigned i = 0; i < executableOps.size(); ++i) {
+      auto duplicateExecutableOp = executableOps[i];
+      auto hash = hash_value(
+          computeStructuralHash(duplicateExecutableOp, executableSymbols[i]));
+      auto &uniqueExecutables = uniqueExecutableBuckets[hash];
+
+      bool isDuplicate = false;
+      for (unsigned j : uniqueExecutables) {
+        auto referenceExecutableOp = executableOps[j];
+        SymbolMapping symbols{executableSymbols[i], executableSymbols[j]};
+        if (!isStructurallyEquivalentTo(duplicateExecutableOp.getBody(),
+                                        referenceExecutableOp.getBody(),
+                                        symbols)) {
+          continue;
         }
+
+        // Found an equivalent executable! Record it and move on to the next.
+        duplicateExecutableOps.push_back(duplicateExecutableOp);
+        isDuplicate = true;
+
+        // Record entry point reference replacements.
+        for (auto [oldExportOp, newExportOp] : llvm::zip_equal(
+                 duplicateExecutableOp.getBlock().getOps<ExecutableExportOp>(),
+                 referenceExecutableOp.getBlock()
+                     .getOps<ExecutableExportOp>())) {
+          auto oldSymbolRefAttr = SymbolRefAttr::get(
+              builder.getContext(), duplicateExecutableOp.getName(),
+              {SymbolRefAttr::get(builder.getContext(),
+                                  oldExportOp.getSymName())});
+          auto newSymbolRefAttr = SymbolRefAttr::get(
+              builder.getContext(), referenceExecutableOp.getName(),
+              {SymbolRefAttr::get(builder.getContext(),
+                                  newExportOp.getSymName())});
+          entryPointRefReplacements[oldSymbolRefAttr] = newSymbolRefAttr;
+        }
+
+        break;
       }
+      if (!isDuplicate) uniqueExecutables.push_back(i);
     }
 
     executablesDeduplicated = duplicateExecutableOps.size();
@@ -14,6 +14,7 @@
 #include "iree/compiler/Dialect/Flow/Transforms/PassDetail.h"
 #include "iree/compiler/Dialect/Flow/Transforms/Passes.h"
 #include "iree/compiler/Dialect/Flow/Transforms/RegionOpUtils.h"
+#include "iree/compiler/Dialect/Util/IR/UtilOps.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/TypeSwitch.h"
 #include "llvm/Support/Debug.h"
@@ -221,6 +222,22 @@ static bool isUnPackLikeOp(Operation *op) {
   return isa<IREE::LinalgExt::UnsetEncodingOp, tensor::UnPackOp>(op);
 }
 
+/// Returns true if the operation is a `tensor.extract_slice` of an unpack-like
+/// operation that drops the padding added before packing. These slices get
+/// folded into the `unpack` on materialization and act as part of it.
+static bool isUnPackLikeSliceOp(Operation *op) {
+  auto sliceOp = dyn_cast<tensor::ExtractSliceOp>(op);
+  if (!sliceOp) return false;
+  Operation *source = sliceOp.getSource().getDefiningOp();
+  if (!source || !isUnPackLikeOp(source)) return false;
+  return llvm::all_of(
+             sliceOp.getMixedOffsets(),
+             [](OpFoldResult ofr) { return isConstantIntValue(ofr, 0); }) &&
+         llvm::all_of(sliceOp.getMixedStrides(), [](OpFoldResult ofr) {
+           return isConstantIntValue(ofr, 1);
+         });
+}
+
 /// Since `iree_linalg_ext.set_encoding` doesnt have padding semantics a
 /// `tensor.pad` is introduced to get the shapes of the input and output to
 /// match. The `tensor.pad` -> `set_encoding` can be folded later on into a
@@ -446,20 +463,15 @@ static bool isFusableWithConsumer(
 
   // Fuse unset_encoding operations with `tensor.extract_slice` and elementwise
   // generic ops.
-  if (isUnPackLikeOp(producer)) {
+  if (isUnPackLikeOp(producer) || isUnPackLikeSliceOp(producer)) {
     // Fuse `unset_encoding` -> `extract_slice` op since they get folded into
     // `unpack` on materialization.
     if (isa<tensor::ExtractSliceOp>(consumer)) {
-      auto sliceOp = cast<tensor::ExtractSliceOp>(consumer);
-      return llvm::all_of(
-                 sliceOp.getMixedOffsets(),
-                 [](OpFoldResult ofr) { return isConstantIntValue(ofr, 0); }) &&
-             llvm::all_of(sliceOp.getMixedStrides(), [](OpFoldResult ofr) {
-               return isConstantIntValue(ofr, 1);
-             });
+      return isUnPackLikeSliceOp(consumer);
     }
-    // Fuse `unset_encoding/unpack` -> elementwise operations for now. This
-    // could be generalized, but unpack fusion code-generation is harder.
+    // Fuse `unset_encoding/unpack` (and the slice that drops its padding) ->
+    // elementwise operations for now. This could be generalized, but unpack
+    // fusion code-generation is harder.
     if (auto consumerLinalgOp = dyn_cast<linalg::LinalgOp>(consumer)) {
       return linalg::isElementwise(consumerLinalgOp) &&
              consumerLinalgOp.getNumLoops() ==
@@ -703,6 +715,14 @@ static unsigned decideFusableLinalgOps(
           isa<linalg::FillOp>(op)) {
         continue;
       }
+      // Widening ops are cloned into the dispatches of their consumers and
+      // only need their own dispatch if used elsewhere.
+      if (hasWideningOpAttr(&op) &&
+          llvm::all_of(op.getUsers(), [](Operation *user) {
+            return hasFusionGroupsAttribute(user) || hasRootOpAttribute(user);
+          })) {
+        continue;
+      }
 
       unsigned newGroup = numRootOps++;
       setRootAttribute(context, &op, newGroup);
@@ -0,0 +1,265 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+//===--- FuseHorizontalContractions.cpp - Fuse sibling contractions -------===//
+//
+// Models with many parallel branches (multi-head projections, ensemble heads)
+// apply several small independent matmuls to the same input. Each of them
+// becomes its own dispatch and pays the command buffer and scheduling overhead
+// of one. This pass fuses such sibling matmuls into a single matmul over the
+// concatenation of their constant right-hand sides so that they form a single
+// dispatch whose workgroup grid is the concatenation of the original ones.
+// The original results are extracted from the fused result with slices that
+// are cloned into the dispatches of their consumers.
+//
+//===----------------------------------------------------------------------===//
+
+#include "iree/compiler/Dialect/Flow/Transforms/PassDetail.h"
+#include "iree/compiler/Dialect/Flow/Transforms/Passes.h"
+#include "iree/compiler/Dialect/Util/IR/UtilOps.h"
+#include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/Debug.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/IR/Dominance.h"
+#include "mlir/IR/Matchers.h"
+#include "mlir/IR/SymbolTable.h"
+
+#define DEBUG_TYPE "iree-flow-fuse-horizontal-contractions"
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace Flow {
+
+namespace {
+
+// A matmul that may be fused with its siblings sharing the same LHS.
+struct Candidate {
+  linalg::MatmulOp matmulOp;
+  // Value the init of the matmul is filled with.
+  Value fillValue;
+  Attribute fillAttr;
+};
+
+// Returns true if |value| is known at compile time, that is a constant or a
+// load of an immutable global. Concatenations of such values are hoisted out
+// of the program instead of being copied on every invocation.
+static bool isConstantLike(Value value) {
+  if (matchPattern(value, m_Constant())) return true;
+  auto loadOp = value.getDefiningOp<IREE::Util::GlobalLoadOp>();
+  if (!loadOp) return false;
+  auto globalOp =
+      SymbolTable::lookupNearestSymbolFrom<IREE::Util::GlobalOpInterface>(
+          loadOp, loadOp.getGlobalAttr());
+  return globalOp && !globalOp.isGlobalMutable();
+}
+
+// Returns |matmulOp| as a candidate for horizontal fusion if it has static
+// shapes, a constant-like RHS and an init that is a constant fill of an empty
+// tensor. Matmuls with results larger than |maxFusedElements| already amortize
+// the dispatch overhead and are never fused.
+static std::optional<Candidate> getCandidate(linalg::MatmulOp matmulOp,
+                                             int64_t maxFusedElements) {
+  if (!matmulOp.hasTensorSemantics()) return std::nullopt;
+  for (Value operand : matmulOp->getOperands()) {
+    auto type = llvm::dyn_cast<RankedTensorType>(operand.getType());
+    if (!type || !type.hasStaticShape()) return std::nullopt;
+  }
+  auto resultType =
+      llvm::cast<RankedTensorType>(matmulOp.getResult(0).getType());
+  if (resultType.getNumElements() > maxFusedElements) return std::nullopt;
+  if (!isConstantLike(matmulOp.getInputs()[1])) return std::nullopt;
+
+  auto fillOp = matmulOp.getOutputs()[0].getDefiningOp<linalg::FillOp>();
+  if (!fillOp || !fillOp.output().getDefiningOp<tensor::EmptyOp>()) {
+    return std::nullopt;
+  }
+  Candidate candidate;
+  candidate.matmulOp = matmulOp;
+  candidate.fillValue = fillOp.value();
+  if (!matchPattern(candidate.fillValue, m_Constant(&candidate.fillAttr))) {
+    return std::nullopt;
+  }
+  return candidate;
+}
+
+// Returns true if |candidate| can be fused into a group led by |leader|.
+static bool isCompatible(const Candidate &leader, const Candidate &candidate) {
+  linalg::MatmulOp leaderOp = leader.matmulOp;
+  linalg::MatmulOp matmulOp = candidate.matmulOp;
+  auto getElementType = [](Value value) {
+    return llvm::cast<RankedTensorType>(value.getType()).getElementType();
+  };
+  return leader.fillAttr == candidate.fillAttr &&
+         getElementType(leaderOp.getInputs()[1]) ==
+             getElementType(matmulOp.getInputs()[1]) &&
+         getElementType(leaderOp.getResult(0)) ==
+             getElementType(matmulOp.getResult(0)) &&
+         leaderOp->getAttrDictionary() == matmulOp->getAttrDictionary();
+}
+
+// Replaces the matmuls of |group| with a single matmul over the concatenation
+// of their RHS along N and slices of its result. The fused matmul is inserted
+// before the first matmul of the group.
+static void fuseGroup(ArrayRef<Candidate> group) {
+  linalg::MatmulOp leaderOp = group.front().matmulOp;
+  OpBuilder builder(leaderOp);
+  Location loc = builder.getFusedLoc(llvm::map_to_vector(
+      group, [](const Candidate &c) { return c.matmulOp.getLoc(); }));
+
+  Value lhs = leaderOp.getInputs()[0];
+  auto lhsType = llvm::cast<RankedTensorType>(lhs.getType());
+  int64_t m = lhsType.getDimSize(0);
+  int64_t k = lhsType.getDimSize(1);
+  int64_t fusedN = 0;
+  for (const Candidate &candidate : group) {
+    fusedN += llvm::cast<RankedTensorType>(
+                  candidate.matmulOp.getResult(0).getType())
+                  .getDimSize(1);
+  }
+
+  // Concatenate the RHS of all matmuls along N.
+  auto rhsElementType =
+      llvm::cast<RankedTensorType>(leaderOp.getInputs()[1].getType())
+          .getElementType();
+  Value rhs = builder.create<tensor::EmptyOp>(
+      loc, ArrayRef<int64_t>{k, fusedN}, rhsElementType);
+  SmallVector<OpFoldResult> strides(2, builder.getIndexAttr(1));
+  int64_t offset = 0;
+  for (const Candidate &candidate : group) {
+    Value candidateRhs = candidate.matmulOp.getInputs()[1];
+    int64_t n =
+        llvm::cast<RankedTensorType>(candidateRhs.getType()).getDimSize(1);
+    SmallVector<OpFoldResult> offsets = {builder.getIndexAttr(0),
+                                         builder.getIndexAttr(offset)};
+    SmallVector<OpFoldResult> sizes = {builder.getIndexAttr(k),
+                                       builder.getIndexAttr(n)};
+    rhs = builder.create<tensor::InsertSliceOp>(loc, candidateRhs, rhs,
+                                                offsets, sizes, strides);
+    offset += n;
+  }
+
+  auto resultType =
+      llvm::cast<RankedTensorType>(leaderOp.getResult(0).getType());
+  auto fusedType =
+      RankedTensorType::get({m, fusedN}, resultType.getElementType());
+  Value init = builder.create<tensor::EmptyOp>(loc, fusedType.getShape(),
+                                               fusedType.getElementType());
+  init = builder
+             .create<linalg::FillOp>(loc, group.front().fillValue, init)
+             .getResult(0);
+  // Carry over attributes such as the cast kind, which all matmuls of the
+  // group share. The operand segment sizes are set by the builder.
+  SmallVector<NamedAttribute> attrs;
+  for (NamedAttribute attr : leaderOp->getAttrs()) {
+    if (attr.getName() == linalg::MatmulOp::getOperandSegmentSizeAttr()) {
+      continue;
+    }
+    attrs.push_back(attr);
+  }
+  auto fusedOp = builder.create<linalg::MatmulOp>(
+      loc, TypeRange{fusedType}, ValueRange{lhs, rhs}, ValueRange{init},
+      attrs);
+
+  // Slice the result of each matmul out of the fused result. All slices are
+  // created before any matmul is erased as the builder inserts before the
+  // first one.
+  SmallVector<Value> slices;
+  offset = 0;
+  for (const Candidate &candidate : group) {
+    linalg::MatmulOp matmulOp = candidate.matmulOp;
+    auto type = llvm::cast<RankedTensorType>(matmulOp.getResult(0).getType());
+    int64_t n = type.getDimSize(1);
+    SmallVector<OpFoldResult> offsets = {builder.getIndexAttr(0),
+                                         builder.getIndexAttr(offset)};
+    SmallVector<OpFoldResult> sizes = {builder.getIndexAttr(m),
+                                       builder.getIndexAttr(n)};
+    slices.push_back(builder.create<tensor::ExtractSliceOp>(
+        matmulOp.getLoc(), type, fusedOp.getResult(0), offsets, sizes,
+        strides));
+    offset += n;
+  }
+  for (auto [candidate, slice] : llvm::zip_equal(group, slices)) {
+    candidate.matmulOp.getResult(0).replaceAllUsesWith(slice);
+    candidate.matmulOp.erase();
+  }
+}
+
+struct FuseHorizontalContractionsPass
+    : public FuseHorizontalContractionsBase<FuseHorizontalContractionsPass> {
+  void getDependentDialects(DialectRegistry &registry) const override {
+    registry.insert<linalg::LinalgDialect, tensor::TensorDialect>();
+  }
+  FuseHorizontalContractionsPass(int64_t maxFusedElements) {
+    this->maxFusedElements = maxFusedElements;
+  }
+  FuseHorizontalContractionsPass(const FuseHorizontalContractionsPass &pass)
+      : FuseHorizontalContractionsPass(pass.maxFusedElements) {}
+
+  void runOnOperation() override {
+    Operation *funcOp = getOperation();
+    DominanceInfo dominanceInfo(funcOp);
+
+    // Collect candidates in program order, grouped by their block and LHS.
+    llvm::MapVector<std::pair<Block *, Value>, SmallVector<Candidate>>
+        siblings;
+    funcOp->walk([&](linalg::MatmulOp matmulOp) {
+      auto candidate = getCandidate(matmulOp, maxFusedElements);
+      if (!candidate) return;
+      siblings[{matmulOp->getBlock(), matmulOp.getInputs()[0]}].push_back(
+          *candidate);
+    });
+
+    for (auto &it : siblings) {
+      SmallVector<Candidate> &candidates = it.second;
+      // Greedily form groups of compatible candidates in program order. The
+      // fused result of a group is bounded by |maxFusedElements| to avoid
+      // trading the dispatch overhead for an oversized workgroup grid.
+      while (candidates.size() > 1) {
+        const Candidate &leader = candidates.front();
+        Operation *leaderOp = leader.matmulOp;
+        int64_t fusedElements = 0;
+        SmallVector<Candidate> group, remaining;
+        for (const Candidate &candidate : candidates) {
+          int64_t elements = llvm::cast<RankedTensorType>(
+                                 candidate.matmulOp.getResult(0).getType())
+                                 .getNumElements();
+          // The fused matmul is inserted before the leader so the RHS of all
+          // fused matmuls has to be available there.
+          bool isAvailable = dominanceInfo.properlyDominates(
+              candidate.matmulOp.getInputs()[1], leaderOp);
+          if (isAvailable && isCompatible(leader, candidate) &&
+              fusedElements + elements <= maxFusedElements) {
+            group.push_back(candidate);
+            fusedElements += elements;
+          } else {
+            remaining.push_back(candidate);
+          }
+        }
+        if (group.size() > 1) {
+          LLVM_DEBUG(llvm::dbgs() << "fusing " << group.size()
+                                  << " matmuls sharing an LHS\n");
+          fuseGroup(group);
+        }
+        candidates = std::move(remaining);
+      }
+    }
+  }
+};
+
+}  // namespace
+
+std::unique_ptr<InterfacePass<mlir::FunctionOpInterface>>
+createFuseHorizontalContractionsPass(int64_t maxFusedElements) {
+  return std::make_unique<FuseHorizontalContractionsPass>(maxFusedElements);
+}
+
+}  // namespace Flow
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
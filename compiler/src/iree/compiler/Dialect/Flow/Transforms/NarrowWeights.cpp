@@ -0,0 +1,395 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <cmath>
+
+#include "iree/compiler/Dialect/Flow/Transforms/PassDetail.h"
+#include "iree/compiler/Dialect/Flow/Transforms/Passes.h"
+#include "iree/compiler/Dialect/Util/IR/UtilDialect.h"
+#include "iree/compiler/Dialect/Util/IR/UtilOps.h"
+#include "llvm/ADT/SetOperations.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/Debug.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/SymbolTable.h"
+
+#define DEBUG_TYPE "iree-flow-narrow-weights"
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace Flow {
+
+namespace {
+
+// Narrowed storage of a weight along with the information required to widen
+// it back to its original type.
+struct NarrowedWeight {
+  // Weight values in the narrow storage type.
+  DenseElementsAttr storage;
+  // Per-channel scales applied when widening integer storage. Unset for
+  // floating-point storage.
+  DenseElementsAttr scales;
+  // Dimension of the weight that |scales| is indexed by or -1 if a single
+  // scale applies to the whole weight.
+  int64_t channelDim = -1;
+};
+
+// Returns the relative root-mean-square error of |widened| compared to
+// |original|. This is the accuracy metric the narrowing budget applies to.
+static double computeRelativeError(ArrayRef<float> original,
+                                   ArrayRef<float> widened) {
+  double errorSquared = 0.0;
+  double referenceSquared = 0.0;
+  for (size_t i = 0; i < original.size(); ++i) {
+    double error = static_cast<double>(original[i]) - widened[i];
+    errorSquared += error * error;
+    referenceSquared += static_cast<double>(original[i]) * original[i];
+  }
+  if (referenceSquared == 0.0) return errorSquared == 0.0 ? 0.0 : INFINITY;
+  return std::sqrt(errorSquared / referenceSquared);
+}
+
+// Narrows |values| to the floating-point |storageType| with round-to-nearest.
+static std::optional<NarrowedWeight> narrowToFloat(DenseElementsAttr values,
+                                                   FloatType storageType,
+                                                   double maxError) {
+  auto originalValues = llvm::to_vector(values.getValues<float>());
+  SmallVector<APFloat> storageValues;
+  SmallVector<float> widenedValues;
+  storageValues.reserve(originalValues.size());
+  widenedValues.reserve(originalValues.size());
+  for (float value : originalValues) {
+    APFloat storageValue(value);
+    bool losesInfo = false;
+    storageValue.convert(storageType.getFloatSemantics(),
+                         APFloat::rmNearestTiesToEven, &losesInfo);
+    storageValues.push_back(storageValue);
+    widenedValues.push_back(
+        static_cast<float>(storageValue.convertToDouble()));
+    if (!std::isfinite(widenedValues.back())) return std::nullopt;
+  }
+  double error = computeRelativeError(originalValues, widenedValues);
+  LLVM_DEBUG(llvm::dbgs() << "narrowing to " << storageType
+                          << " has relative error " << error << "\n");
+  if (error > maxError) return std::nullopt;
+
+  NarrowedWeight weight;
+  weight.storage = DenseElementsAttr::get(values.getType().clone(storageType),
+                                          storageValues);
+  return weight;
+}
+
+// Narrows |values| to symmetric i8 with one scale per slice along
+// |channelDim| (or a single scale if -1). Scales are derived from the range
+// of the values in each channel.
+static std::optional<NarrowedWeight> narrowToInt8(DenseElementsAttr values,
+                                                  int64_t channelDim,
+                                                  double maxError) {
+  ShapedType shapedType = values.getType();
+  ArrayRef<int64_t> shape = shapedType.getShape();
+  int64_t channelCount = channelDim >= 0 ? shape[channelDim] : 1;
+  int64_t channelStride = 1;
+  if (channelDim >= 0) {
+    for (int64_t i = channelDim + 1; i < shapedType.getRank(); ++i) {
+      channelStride *= shape[i];
+    }
+  }
+  auto getChannel = [&](size_t index) -> int64_t {
+    return (static_cast<int64_t>(index) / channelStride) % channelCount;
+  };
+
+  auto originalValues = llvm::to_vector(values.getValues<float>());
+  SmallVector<float> scales(channelCount, 0.0f);
+  for (size_t i = 0; i < originalValues.size(); ++i) {
+    float &scale = scales[getChannel(i)];
+    scale = std::max(scale, std::fabs(originalValues[i]));
+  }
+  for (float &scale : scales) {
+    if (!std::isfinite(scale)) return std::nullopt;
+    scale = scale == 0.0f ? 1.0f : scale / 127.0f;
+  }
+
+  SmallVector<int8_t> storageValues;
+  SmallVector<float> widenedValues;
+  storageValues.reserve(originalValues.size());
+  widenedValues.reserve(originalValues.size());
+  for (size_t i = 0; i < originalValues.size(); ++i) {
+    float scale = scales[getChannel(i)];
+    float quantized = std::round(originalValues[i] / scale);
+    quantized = std::min(127.0f, std::max(-127.0f, quantized));
+    storageValues.push_back(static_cast<int8_t>(quantized));
+    widenedValues.push_back(quantized * scale);
+  }
+  double error = computeRelativeError(originalValues, widenedValues);
+  LLVM_DEBUG(llvm::dbgs() << "narrowing to i8 has relative error " << error
+                          << "\n");
+  if (error > maxError) return std::nullopt;
+
+  auto *context = values.getContext();
+  auto f32Type = Float32Type::get(context);
+  NarrowedWeight weight;
+  weight.storage = DenseElementsAttr::get(
+      shapedType.clone(IntegerType::get(context, 8)),
+      ArrayRef<int8_t>(storageValues));
+  weight.scales = DenseElementsAttr::get(
+      channelDim >= 0 ? RankedTensorType::get({channelCount}, f32Type)
+                      : RankedTensorType::get({}, f32Type),
+      ArrayRef<float>(scales));
+  weight.channelDim = channelDim;
+  return weight;
+}
+
+// Returns true if |use| reads a weight in a way that can be served from a
+// widened narrow value.
+static bool isNarrowableUse(OpOperand &use) {
+  auto linalgOp = dyn_cast<linalg::LinalgOp>(use.getOwner());
+  return linalgOp && linalgOp.isDpsInput(&use) &&
+         !hasWideningOpAttr(use.getOwner());
+}
+
+// Returns the dimension of the weight used by |uses| that indexes output
+// channels: a dimension every consumer iterates in parallel. Prefers the
+// innermost such dimension and returns -1 if there is none.
+static int64_t findChannelDim(ArrayRef<OpOperand *> uses, int64_t rank) {
+  llvm::SmallDenseSet<int64_t> channelDims;
+  for (int64_t i = 0; i < rank; ++i) channelDims.insert(i);
+  for (OpOperand *use : uses) {
+    auto linalgOp = cast<linalg::LinalgOp>(use->getOwner());
+    AffineMap indexingMap = linalgOp.getMatchingIndexingMap(use);
+    auto iteratorTypes = linalgOp.getIteratorTypesArray();
+    llvm::SmallDenseSet<int64_t> parallelDims;
+    for (auto [i, expr] : llvm::enumerate(indexingMap.getResults())) {
+      auto dimExpr = expr.dyn_cast<AffineDimExpr>();
+      if (dimExpr && linalg::isParallelIterator(
+                         iteratorTypes[dimExpr.getPosition()])) {
+        parallelDims.insert(i);
+      }
+    }
+    llvm::set_intersect(channelDims, parallelDims);
+  }
+  int64_t channelDim = -1;
+  for (int64_t dim : channelDims) channelDim = std::max(channelDim, dim);
+  return channelDim;
+}
+
+// Builds the op widening |storage| back to |resultType|. The op is marked as
+// widening so that it is cloned into each consuming dispatch and only the
+// narrow storage is read from memory.
+static Value buildWidening(OpBuilder &builder, Location loc, Value storage,
+                           Value scales, int64_t channelDim,
+                           RankedTensorType resultType) {
+  int64_t rank = resultType.getRank();
+  Type elementType = resultType.getElementType();
+  Value empty = builder.create<tensor::EmptyOp>(loc, resultType.getShape(),
+                                                elementType);
+  AffineMap identityMap = builder.getMultiDimIdentityMap(rank);
+  SmallVector<Value> inputs = {storage};
+  SmallVector<AffineMap> indexingMaps = {identityMap};
+  if (scales) {
+    inputs.push_back(scales);
+    indexingMaps.push_back(
+        channelDim >= 0
+            ? AffineMap::get(rank, 0, builder.getAffineDimExpr(channelDim))
+            : AffineMap::get(rank, 0, {}, builder.getContext()));
+  }
+  indexingMaps.push_back(identityMap);
+  SmallVector<utils::IteratorType> iteratorTypes(
+      rank, utils::IteratorType::parallel);
+  auto genericOp = builder.create<linalg::GenericOp>(
+      loc, resultType, inputs, ValueRange{empty}, indexingMaps, iteratorTypes,
+      [&](OpBuilder &nestedBuilder, Location nestedLoc, ValueRange args) {
+        Value value;
+        if (scales) {
+          value = nestedBuilder.create<arith::SIToFPOp>(nestedLoc,
+                                                        elementType, args[0]);
+          value = nestedBuilder.create<arith::MulFOp>(nestedLoc, value,
+                                                      args[1]);
+        } else {
+          value = nestedBuilder.create<arith::ExtFOp>(nestedLoc, elementType,
+                                                      args[0]);
+        }
+        nestedBuilder.create<linalg::YieldOp>(nestedLoc, value);
+      });
+  setWideningOpAttr(genericOp);
+  return genericOp.getResult(0);
+}
+
+class NarrowWeightsPass : public NarrowWeightsBase<NarrowWeightsPass> {
+ public:
+  NarrowWeightsPass() = default;
+  NarrowWeightsPass(std::string storageType, double maxError) {
+    this->storageType = storageType;
+    this->maxError = maxError;
+  }
+  NarrowWeightsPass(const NarrowWeightsPass &pass)
+      : NarrowWeightsPass(pass.storageType, pass.maxError) {
+    this->minElements = pass.minElements;
+  }
+
+  void getDependentDialects(DialectRegistry &registry) const override {
+    registry.insert<arith::ArithDialect, linalg::LinalgDialect,
+                    tensor::TensorDialect, IREE::Util::UtilDialect>();
+  }
+
+  void runOnOperation() override {
+    auto moduleOp = getOperation();
+    auto *context = &getContext();
+    if (storageType == "f16") {
+      narrowStorageType = Float16Type::get(context);
+    } else if (storageType == "bf16") {
+      narrowStorageType = BFloat16Type::get(context);
+    } else if (storageType == "i8") {
+      narrowStorageType = IntegerType::get(context, 8);
+    } else {
+      moduleOp.emitError() << "unsupported weight storage type '"
+                           << storageType << "'; expected f16, bf16, or i8";
+      return signalPassFailure();
+    }
+
+    SymbolTable symbolTable(moduleOp);
+    for (auto globalOp :
+         llvm::to_vector(moduleOp.getOps<IREE::Util::GlobalOp>())) {
+      narrowGlobal(globalOp, symbolTable);
+    }
+    SmallVector<arith::ConstantOp> constantOps;
+    moduleOp.walk([&](arith::ConstantOp constantOp) {
+      constantOps.push_back(constantOp);
+    });
+    for (auto constantOp : constantOps) narrowConstant(constantOp);
+  }
+
+ private:
+  // Returns the f32 weight values if |type| and |value| describe a weight
+  // eligible for narrowing.
+  DenseElementsAttr getEligibleValues(Type type, Attribute value) {
+    auto tensorType = llvm::dyn_cast<RankedTensorType>(type);
+    if (!tensorType || !tensorType.hasStaticShape() ||
+        tensorType.getRank() == 0 || !tensorType.getElementType().isF32() ||
+        tensorType.getNumElements() < minElements) {
+      return {};
+    }
+    auto values = llvm::dyn_cast_if_present<DenseElementsAttr>(value);
+    if (!values || values.isSplat()) return {};
+    return values;
+  }
+
+  std::optional<NarrowedWeight> narrow(DenseElementsAttr values,
+                                       ArrayRef<OpOperand *> uses) {
+    if (auto floatType = llvm::dyn_cast<FloatType>(narrowStorageType)) {
+      return narrowToFloat(values, floatType, maxError);
+    }
+    int64_t rank = values.getType().getRank();
+    return narrowToInt8(values, findChannelDim(uses, rank), maxError);
+  }
+
+  // Narrows an immutable global that is only ever loaded by narrowable uses.
+  // The global is replaced with one holding the narrow storage (and another
+  // holding the scales, if any) and each load is followed by a widening op.
+  void narrowGlobal(IREE::Util::GlobalOp globalOp, SymbolTable &symbolTable) {
+    if (globalOp.getIsMutable() || globalOp.isPublic()) return;
+    auto values =
+        getEligibleValues(globalOp.getType(), globalOp.getInitialValueAttr());
+    if (!values) return;
+
+    auto symbolUses = SymbolTable::getSymbolUses(globalOp, getOperation());
+    if (!symbolUses) return;
+    SmallVector<IREE::Util::GlobalLoadOp> loadOps;
+    SmallVector<OpOperand *> uses;
+    for (auto symbolUse : *symbolUses) {
+      auto loadOp = dyn_cast<IREE::Util::GlobalLoadOp>(symbolUse.getUser());
+      if (!loadOp) return;
+      loadOps.push_back(loadOp);
+      for (OpOperand &use : loadOp.getResult().getUses()) {
+        if (!isNarrowableUse(use)) return;
+        uses.push_back(&use);
+      }
+    }
+    if (uses.empty()) return;
+
+    auto weight = narrow(values, uses);
+    if (!weight) return;
+
+    OpBuilder moduleBuilder(globalOp);
+    auto storageOp = moduleBuilder.create<IREE::Util::GlobalOp>(
+        globalOp.getLoc(), (globalOp.getSymName() + "_narrow").str(),
+        /*isMutable=*/false, weight->storage.getType(),
+        llvm::cast<TypedAttr>(weight->storage));
+    storageOp.setPrivate();
+    symbolTable.insert(storageOp);
+    IREE::Util::GlobalOp scalesOp;
+    if (weight->scales) {
+      scalesOp = moduleBuilder.create<IREE::Util::GlobalOp>(
+          globalOp.getLoc(), (globalOp.getSymName() + "_scales").str(),
+          /*isMutable=*/false, weight->scales.getType(),
+          llvm::cast<TypedAttr>(weight->scales));
+      scalesOp.setPrivate();
+      symbolTable.insert(scalesOp);
+    }
+
+    auto resultType = llvm::cast<RankedTensorType>(globalOp.getType());
+    for (auto loadOp : loadOps) {
+      OpBuilder builder(loadOp);
+      Value storage = builder.create<IREE::Util::GlobalLoadOp>(
+          loadOp.getLoc(), storageOp);
+      Value scales;
+      if (scalesOp) {
+        scales = builder.create<IREE::Util::GlobalLoadOp>(loadOp.getLoc(),
+                                                          scalesOp);
+      }
+      loadOp.replaceAllUsesWith(buildWidening(builder, loadOp.getLoc(),
+                                              storage, scales,
+                                              weight->channelDim, resultType));
+      loadOp.erase();
+    }
+    symbolTable.erase(globalOp);
+  }
+
+  // Narrows an inline constant that is only used by narrowable uses.
+  void narrowConstant(arith::ConstantOp constantOp) {
+    auto values =
+        getEligibleValues(constantOp.getType(), constantOp.getValue());
+    if (!values) return;
+    SmallVector<OpOperand *> uses;
+    for (OpOperand &use : constantOp.getResult().getUses()) {
+      if (!isNarrowableUse(use)) return;
+      uses.push_back(&use);
+    }
+    if (uses.empty()) return;
+
+    auto weight = narrow(values, uses);
+    if (!weight) return;
+
+    OpBuilder builder(constantOp);
+    Location loc = constantOp.getLoc();
+    Value storage = builder.create<arith::ConstantOp>(loc, weight->storage);
+    Value scales;
+    if (weight->scales) {
+      scales = builder.create<arith::ConstantOp>(loc, weight->scales);
+    }
+    constantOp.replaceAllUsesWith(buildWidening(
+        builder, loc, storage, scales, weight->channelDim,
+        llvm::cast<RankedTensorType>(constantOp.getType())));
+    constantOp.erase();
+  }
+
+  Type narrowStorageType;
+};
+
+}  // namespace
+
+std::unique_ptr<OperationPass<mlir::ModuleOp>> createNarrowWeightsPass(
+    std::string storageType, double maxError) {
+  return std::make_unique<NarrowWeightsPass>(storageType, maxError);
+}
+
+}  // namespace Flow
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
@@ -75,6 +75,19 @@ static llvm::cl::opt<bool> clDemoteF64ToF32(
                    "unconditionally before main flow conversions."),
     llvm::cl::init(true));
 
+static llvm::cl::opt<std::string> clNarrowWeightStorage(
+    "iree-flow-narrow-weight-storage",
+    llvm::cl::desc("Stores constant weights as f16, bf16, or per-channel i8 "
+                   "and widens them within the dispatches consuming them. "
+                   "Weights are left unchanged when empty."),
+    llvm::cl::init(""));
+static llvm::cl::opt<double> clNarrowWeightMaxError(
+    "iree-flow-narrow-weight-max-error",
+    llvm::cl::desc("Accuracy budget for weight narrowing as the maximum "
+                   "relative RMS error of any individual weight. Weights that "
+                   "would exceed it are left unchanged."),
+    llvm::cl::init(0.01));
+
 static llvm::cl::opt<bool> clDetensoring(
     "iree-flow-enable-detensoring",
     llvm::cl::desc(
@@ -108,6 +121,18 @@ static llvm::cl::opt<bool> clEnableDataTiling(
     "iree-flow-enable-data-tiling", llvm::cl::desc("Enable data tiling path."),
     llvm::cl::init(false));
 
+static llvm::cl::opt<bool> clEnableHorizontalContractionFusion(
+    "iree-flow-enable-horizontal-contraction-fusion",
+    llvm::cl::desc("Fuse small matmuls sharing an LHS into a single matmul "
+                   "over their concatenated constant RHS."),
+    llvm::cl::init(false));
+
+static llvm::cl::opt<int64_t> clHorizontalContractionFusionMaxElements(
+    "iree-flow-horizontal-contraction-fusion-max-elements",
+    llvm::cl::desc("Maximum number of elements of the result of a "
+                   "horizontally fused matmul."),
+    llvm::cl::init(1048576));
+
 static llvm::cl::opt<bool> clNormalizeInputIndexingMap(
     "iree-flow-normalize-input-indexing-map",
     llvm::cl::desc("Enable normalizing input indexing map to identity."),
@@ -161,6 +186,15 @@ void buildGlobalOptimizationPassPipeline(
   pipeline.addPass(IREE::Util::createFoldGlobalsPass());
   pipeline.addPass(IREE::Util::createIPOPass());
 
+  // Fuse sibling matmuls before hoisting so that the concatenation of their
+  // constant RHS is hoisted into a global.
+  if (clEnableHorizontalContractionFusion) {
+    FunctionLikeNest(pipeline).addPass([]() {
+      return createFuseHorizontalContractionsPass(
+          clHorizontalContractionFusionMaxElements);
+    });
+  }
+
   if (transformOptions.constExprHoisting) {
     pipeline.addPass(IREE::Util::createHoistIntoGlobalsPass());
   }
@@ -175,6 +209,13 @@ void buildGlobalOptimizationPassPipeline(
     pipeline.addPass(createCleanupNumericNarrowingPass());
   }
 
+  // Narrow weights after constant evaluation so that we narrow the final
+  // values. The widening ops are never hoisted back into globals.
+  if (!clNarrowWeightStorage.empty()) {
+    pipeline.addPass(createNarrowWeightsPass(clNarrowWeightStorage,
+                                             clNarrowWeightMaxError));
+  }
+
   FunctionLikeNest(pipeline)
       .addPass(mlir::createCanonicalizerPass)
       .addPass(mlir::createCSEPass);
@@ -262,7 +303,17 @@ void buildFlowTransformPassPipeline(OpPassManager &passManager,
       .addPredicatedPass(clNormalizeInputIndexingMap,
                          createInterchangeTransposeGenericOpsPass)
       // Enable data tiling after all linalg level transformations.
-      .addPredicatedPass(clEnableDataTiling, createSetEncodingPass)
+      .addPredicatedPass(clEnableDataTiling, createSetEncodingPass);
+
+  // Hoist the encoding (packing) of weights and other constant operands of the
+  // data-tiled ops into globals so that they are packed once at initialization
+  // instead of on every invocation. This runs after const-eval as the packed
+  // layout is only known to the target backend.
+  if (clEnableDataTiling && transformOptions.constExprHoisting) {
+    passManager.addPass(IREE::Util::createHoistIntoGlobalsPass());
+  }
+
+  FunctionLikeNest(passManager)
       ////////////////////////////////////////////////////////////////////////
       // Dispatch region formation.
       .addPredicatedPass(!clDispatchTransformFileName.empty(),
@@ -95,6 +95,12 @@ std::unique_ptr<InterfacePass<mlir::FunctionOpInterface>>
 createFusionOfTensorOpsPass(bool fuseMultiUse = false,
                             unsigned multiUseFusionIteration = 2);
 
+// Creates a pass that fuses small independent matmuls sharing an LHS into a
+// single matmul over their concatenated constant RHS. Fused results are bounded
+// by |maxFusedElements|.
+std::unique_ptr<InterfacePass<mlir::FunctionOpInterface>>
+createFuseHorizontalContractionsPass(int64_t maxFusedElements = 1048576);
+
 // Infers and inserts util.numeric.optional_narrow ops at points that may be
 // beneficial.
 std::unique_ptr<Pass> createInferNumericNarrowingPass();
@@ -116,6 +122,12 @@ std::unique_ptr<Pass> createInterchangeTransposeGenericOpsPass();
 // dispatch region formation.
 std::unique_ptr<Pass> createConvertToFlowPass();
 
+// Stores eligible constant weights as |storageType| (f16, bf16, or i8 with
+// per-channel scales) and widens them back in their consumers when doing so
+// keeps the relative error under |maxError|.
+std::unique_ptr<OperationPass<mlir::ModuleOp>> createNarrowWeightsPass(
+    std::string storageType = "f16", double maxError = 0.01);
+
 // Optimizes numerics given annotations added via
 // iree-flow-infer-numeric-narrowing.
 std::unique_ptr<Pass> createOptimizeNumericsPass();
@@ -62,10 +62,11 @@ static FailureOr<Value> getZero(OpBuilder &builder, Location loc,
 }
 
 /// Pads `value` to `padding` if needed. If no padding is specified,
-/// return `value` itself.
+/// return `value` itself. The leading `numBatchDims` dimensions are never
+/// padded.
 static FailureOr<Value> padIfNeeded(
     OpBuilder &builder, Location loc, Value value,
-    std::optional<int64_t> padding = std::nullopt) {
+    std::optional<int64_t> padding = std::nullopt, int64_t numBatchDims = 0) {
   if (!padding) return value;
 
   OpFoldResult paddingOfr = builder.getIndexAttr(padding.value());
@@ -80,12 +81,18 @@ static FailureOr<Value> padIfNeeded(
   SmallVector<OpFoldResult> highPad(shape->size(), zero);
 
   // The low padding is always zero. The high padding is
-  // shape.ceildDiv(padding) - shape.
+  // shape.ceildDiv(padding) - shape. Static unit dimensions (such as the
+  // vector operand of a vecmat/matvec expanded to a matrix) are not padded so
+  // that they can be materialized with narrow tiles.
   AffineExpr paddingExpr, shapeExpr;
   bindSymbols(builder.getContext(), paddingExpr, shapeExpr);
   AffineExpr highPadExpr =
       shapeExpr.ceilDiv(paddingExpr) * paddingExpr - shapeExpr;
   for (auto shape : llvm::enumerate(shape.value())) {
+    if (static_cast<int64_t>(shape.index()) < numBatchDims ||
+        isConstantIntValue(shape.value(), 1)) {
+      continue;
+    }
     highPad[shape.index()] = affine::makeComposedFoldedAffineApply(
         builder, loc, highPadExpr, {paddingOfr, shape.value()});
   }
@@ -107,17 +114,81 @@ static FailureOr<Value> padIfNeeded(
   return padOp.getResult();
 }
 
+/// Encodings of the (lhs, rhs, result) operands of a contraction.
+struct ContractionEncodings {
+  TensorEncoding lhs;
+  TensorEncoding rhs;
+  TensorEncoding result;
+};
+
+/// Returns the encodings to use for a matmul (or batch matmul if `isBatch`)
+/// with the given operand element types, or std::nullopt if the combination of
+/// element types is not handled by the data-tiling path.
+static std::optional<ContractionEncodings> getContractionEncodings(
+    Type lhsElemType, Type rhsElemType, Type outElemType, bool isBatch) {
+  if (!lhsElemType || !rhsElemType || !outElemType) return std::nullopt;
+  if (lhsElemType.isF32() && rhsElemType.isF32() && outElemType.isF32()) {
+    if (isBatch) {
+      return ContractionEncodings{
+          TensorEncoding::BATCH_MATMUL_F32F32F32_LHS,
+          TensorEncoding::BATCH_MATMUL_F32F32F32_RHS,
+          TensorEncoding::BATCH_MATMUL_F32F32F32_RESULT};
+    }
+    return ContractionEncodings{TensorEncoding::MATMUL_F32F32F32_LHS,
+                                TensorEncoding::MATMUL_F32F32F32_RHS,
+                                TensorEncoding::MATMUL_F32F32F32_RESULT};
+  }
+  if (lhsElemType.isSignlessInteger(8) && rhsElemType.isSignlessInteger(8) &&
+      outElemType.isSignlessInteger(32)) {
+    if (isBatch) {
+      return ContractionEncodings{TensorEncoding::BATCH_MATMUL_I8I8I32_LHS,
+                                  TensorEncoding::BATCH_MATMUL_I8I8I32_RHS,
+                                  TensorEncoding::BATCH_MATMUL_I8I8I32_RESULT};
+    }
+    return ContractionEncodings{TensorEncoding::MATMUL_I8I8I32_LHS,
+                                TensorEncoding::MATMUL_I8I8I32_RHS,
+                                TensorEncoding::MATMUL_I8I8I32_RESULT};
+  }
+  return std::nullopt;
+}
+
+static bool hasAllOneValues(DenseIntElementsAttr attr) {
+  return llvm::all_of(
+      attr, [](APInt element) { return element.getSExtValue() == 1; });
+}
+
+/// Expands the 1-D `vector` into a matrix with a unit dimension at `unitDim`.
+static Value expandVectorToMatrix(OpBuilder &builder, Location loc,
+                                  Value vector, int64_t unitDim) {
+  auto vectorType = llvm::cast<RankedTensorType>(vector.getType());
+  SmallVector<int64_t> shape = {vectorType.getDimSize(0)};
+  shape.insert(shape.begin() + unitDim, 1);
+  auto matrixType = RankedTensorType::get(shape, vectorType.getElementType());
+  return builder.create<tensor::ExpandShapeOp>(
+      loc, matrixType, vector, SmallVector<ReassociationIndices>{{0, 1}});
+}
+
+/// Returns true if a matmul on operands `lhs`, `rhs` and `out` would be
+/// handled by the data-tiling path.
+static bool hasMatmulEncodings(Value lhs, Value rhs, Value out) {
+  return getContractionEncodings(getElementTypeOrSelf(lhs.getType()),
+                                 getElementTypeOrSelf(rhs.getType()),
+                                 getElementTypeOrSelf(out.getType()),
+                                 /*isBatch=*/false)
+      .has_value();
+}
+
 namespace {
 
-/// Rewrites the matmul op to work on tensors with encoding. Optionally
-/// also pads the operands.
-struct SetMatmulEncoding : public OpRewritePattern<linalg::MatmulOp> {
-  SetMatmulEncoding(MLIRContext *context, int64_t padding,
-                    PatternBenefit benefit = 1)
-      : OpRewritePattern<linalg::MatmulOp>(context, benefit),
-        padding(padding) {}
+/// Rewrites the matmul or batch_matmul op to work on tensors with encoding.
+/// Optionally also pads the operands.
+template <typename OpTy>
+struct SetContractionEncoding : public OpRewritePattern<OpTy> {
+  SetContractionEncoding(MLIRContext *context, int64_t padding,
+                         PatternBenefit benefit = 1)
+      : OpRewritePattern<OpTy>(context, benefit), padding(padding) {}
 
-  LogicalResult matchAndRewrite(linalg::MatmulOp matmulOp,
+  LogicalResult matchAndRewrite(OpTy matmulOp,
                                 PatternRewriter &rewriter) const override {
     if (!matmulOp.hasTensorSemantics()) return failure();
     auto inputs = matmulOp.getDpsInputOperands();
@@ -141,62 +212,48 @@ struct SetMatmulEncoding : public OpRewritePattern<linalg::MatmulOp> {
       }
       return {};
     };
-    Type lhsElemType = getElemType(origLhs);
-    Type rhsElemType = getElemType(origRhs);
-    Type outElemType = getElemType(origOut);
-
-    if (!lhsElemType || !rhsElemType || !outElemType) {
-      return failure();
-    }
-
-    TensorEncoding lhsEncoding;
-    TensorEncoding rhsEncoding;
-    TensorEncoding outEncoding;
-
-    if (lhsElemType.isF32() && rhsElemType.isF32() && outElemType.isF32()) {
-      lhsEncoding = TensorEncoding::MATMUL_F32F32F32_LHS;
-      rhsEncoding = TensorEncoding::MATMUL_F32F32F32_RHS;
-      outEncoding = TensorEncoding::MATMUL_F32F32F32_RESULT;
-    } else if (lhsElemType.isSignlessInteger(8) &&
-               rhsElemType.isSignlessInteger(8) &&
-               outElemType.isSignlessInteger(32)) {
-      lhsEncoding = TensorEncoding::MATMUL_I8I8I32_LHS;
-      rhsEncoding = TensorEncoding::MATMUL_I8I8I32_RHS;
-      outEncoding = TensorEncoding::MATMUL_I8I8I32_RESULT;
-    } else {
+    constexpr bool isBatch = std::is_same<OpTy, linalg::BatchMatmulOp>::value;
+    std::optional<ContractionEncodings> encodings = getContractionEncodings(
+        getElemType(origLhs), getElemType(origRhs), getElemType(origOut),
+        isBatch);
+    if (!encodings) {
       return rewriter.notifyMatchFailure(
           matmulOp,
           "unhandled combination of (lhs, rhs, result) element types");
     }
 
     Location loc = matmulOp.getLoc();
+    int64_t numBatchDims = isBatch ? 1 : 0;
 
     // Set encoding for LHS (pad if necessary)
-    FailureOr<Value> paddedLhs = padIfNeeded(rewriter, loc, origLhs, padding);
+    FailureOr<Value> paddedLhs =
+        padIfNeeded(rewriter, loc, origLhs, padding, numBatchDims);
     if (failed(paddedLhs)) {
       return rewriter.notifyMatchFailure(matmulOp, "failed to pad lhs");
     }
 
     // Set encoding for RHS (pad if necessary)
-    FailureOr<Value> paddedRhs = padIfNeeded(rewriter, loc, origRhs, padding);
+    FailureOr<Value> paddedRhs =
+        padIfNeeded(rewriter, loc, origRhs, padding, numBatchDims);
     if (failed(paddedRhs)) {
       return rewriter.notifyMatchFailure(matmulOp, "failed to pad rhs");
     }
 
     // Set encoding for OUTS (pad if necessary)
-    FailureOr<Value> paddedOut = padIfNeeded(rewriter, loc, origOut, padding);
+    FailureOr<Value> paddedOut =
+        padIfNeeded(rewriter, loc, origOut, padding, numBatchDims);
     if (failed(paddedOut)) {
       return rewriter.notifyMatchFailure(matmulOp, "failed to pad output");
     }
 
     Value encodedLhs = rewriter.create<IREE::LinalgExt::SetEncodingOp>(
-        loc, paddedLhs.value(), lhsEncoding);
+        loc, paddedLhs.value(), encodings->lhs);
     Value encodedRhs = rewriter.create<IREE::LinalgExt::SetEncodingOp>(
-        loc, paddedRhs.value(), rhsEncoding);
+        loc, paddedRhs.value(), encodings->rhs);
     Value encodedOut = rewriter.create<IREE::LinalgExt::SetEncodingOp>(
-        loc, paddedOut.value(), outEncoding);
+        loc, paddedOut.value(), encodings->result);
 
-    auto matmulTiled = rewriter.create<linalg::MatmulOp>(
+    auto matmulTiled = rewriter.create<OpTy>(
         loc, encodedOut.getType(), ValueRange{encodedLhs, encodedRhs},
         encodedOut);
     auto unsetEncoding = rewriter.create<IREE::LinalgExt::UnsetEncodingOp>(
@@ -233,6 +290,137 @@ struct SetMatmulEncoding : public OpRewritePattern<linalg::MatmulOp> {
   int64_t padding;
 };
 
+/// Rewrites a `linalg.vecmat` or `linalg.matvec` into a `linalg.matmul` with a
+/// static unit M or N dimension so that it takes the data-tiling path. The
+/// unit dimension is not padded and gets materialized with narrow tiles.
+template <typename OpTy>
+struct ConvertVectorContractionToMatmul : public OpRewritePattern<OpTy> {
+  using OpRewritePattern<OpTy>::OpRewritePattern;
+
+  LogicalResult matchAndRewrite(OpTy op,
+                                PatternRewriter &rewriter) const override {
+    if (!op.hasTensorSemantics()) return failure();
+    Value lhs = op.getDpsInputOperand(0)->get();
+    Value rhs = op.getDpsInputOperand(1)->get();
+    Value out = op.getDpsInitOperand(0)->get();
+    if (!hasMatmulEncodings(lhs, rhs, out)) {
+      return rewriter.notifyMatchFailure(
+          op, "unhandled combination of (lhs, rhs, result) element types");
+    }
+
+    // vecmat: (K) x (K, N) -> (N) computed as (1, K) x (K, N) -> (1, N).
+    // matvec: (M, K) x (K) -> (M) computed as (M, K) x (K, 1) -> (M, 1).
+    constexpr bool isVecmat = std::is_same<OpTy, linalg::VecmatOp>::value;
+    int64_t unitDim = isVecmat ? 0 : 1;
+    Location loc = op.getLoc();
+    if (isVecmat) {
+      lhs = expandVectorToMatrix(rewriter, loc, lhs, unitDim);
+    } else {
+      rhs = expandVectorToMatrix(rewriter, loc, rhs, unitDim);
+    }
+    Value expandedOut = expandVectorToMatrix(rewriter, loc, out, unitDim);
+    auto matmulOp = rewriter.create<linalg::MatmulOp>(
+        loc, expandedOut.getType(), ValueRange{lhs, rhs}, expandedOut);
+    rewriter.replaceOpWithNewOp<tensor::CollapseShapeOp>(
+        op, out.getType(), matmulOp.getResult(0),
+        SmallVector<ReassociationIndices>{{0, 1}});
+    return success();
+  }
+};
+
+/// Rewrites a `linalg.conv_2d_nhwc_hwcf` into an im2col `linalg.generic` and a
+/// `linalg.matmul` so that it takes the data-tiling path. The batch dimension
+/// is folded into the M dimension of the matmul so that the reshaped filter is
+/// the RHS for any batch size. Convolutions with 1x1 filters and unit strides
+/// are left to Convert1X1FilterConv2DToMatmul as they do not need the im2col
+/// copy.
+struct ConvertConv2DNhwcHwcfToMatmul
+    : public OpRewritePattern<linalg::Conv2DNhwcHwcfOp> {
+  using OpRewritePattern<linalg::Conv2DNhwcHwcfOp>::OpRewritePattern;
+
+  LogicalResult matchAndRewrite(linalg::Conv2DNhwcHwcfOp convOp,
+                                PatternRewriter &rewriter) const override {
+    if (!convOp.hasTensorSemantics()) return failure();
+    Value input = convOp.getDpsInputOperand(0)->get();
+    Value filter = convOp.getDpsInputOperand(1)->get();
+    Value output = convOp.getDpsInitOperand(0)->get();
+    auto inputType = llvm::cast<RankedTensorType>(input.getType());
+    auto filterType = llvm::cast<RankedTensorType>(filter.getType());
+    auto outputType = llvm::cast<RankedTensorType>(output.getType());
+    if (!inputType.hasStaticShape() || !filterType.hasStaticShape() ||
+        !outputType.hasStaticShape()) {
+      return rewriter.notifyMatchFailure(convOp, "expected static shapes");
+    }
+    if (!hasMatmulEncodings(input, filter, output)) {
+      return rewriter.notifyMatchFailure(
+          convOp,
+          "unhandled combination of (input, filter, result) element types");
+    }
+    if (!hasAllOneValues(convOp.getDilations())) {
+      return rewriter.notifyMatchFailure(convOp, "unhandled dilations");
+    }
+
+    ArrayRef<int64_t> filterShape = filterType.getShape();
+    ArrayRef<int64_t> outputShape = outputType.getShape();
+    int64_t n = outputShape[0];
+    int64_t oh = outputShape[1];
+    int64_t ow = outputShape[2];
+    int64_t oc = outputShape[3];
+    int64_t fh = filterShape[0];
+    int64_t fw = filterShape[1];
+    int64_t ic = filterShape[2];
+    if (fh == 1 && fw == 1 && hasAllOneValues(convOp.getStrides())) {
+      return rewriter.notifyMatchFailure(
+          convOp, "1x1 filters with unit strides do not need im2col");
+    }
+
+    // im2col: col(n, oh, ow, fh, fw, ic) = input(n, oh * sh + fh,
+    // ow * sw + fw, ic).
+    Location loc = convOp.getLoc();
+    MLIRContext *context = rewriter.getContext();
+    AffineExpr nDim, ohDim, owDim, fhDim, fwDim, icDim;
+    bindDims(context, nDim, ohDim, owDim, fhDim, fwDim, icDim);
+    auto strides = convOp.getStrides().getValues<int64_t>();
+    SmallVector<AffineExpr> inputExprs = {nDim, ohDim * strides[0] + fhDim,
+                                          owDim * strides[1] + fwDim, icDim};
+    SmallVector<int64_t> colShape = {n, oh, ow, fh, fw, ic};
+    Value colEmpty = rewriter.create<tensor::EmptyOp>(
+        loc, colShape, inputType.getElementType());
+    SmallVector<AffineMap> colMaps = {
+        AffineMap::get(colShape.size(), 0, inputExprs, context),
+        rewriter.getMultiDimIdentityMap(colShape.size())};
+    SmallVector<utils::IteratorType> colIterators(
+        colShape.size(), utils::IteratorType::parallel);
+    auto colOp = rewriter.create<linalg::GenericOp>(
+        loc, colEmpty.getType(), input, colEmpty, colMaps, colIterators,
+        [](OpBuilder &b, Location nestedLoc, ValueRange args) {
+          b.create<linalg::YieldOp>(nestedLoc, args[0]);
+        });
+
+    // (n * oh * ow, fh * fw * ic) x (fh * fw * ic, oc) -> (n * oh * ow, oc)
+    SmallVector<ReassociationIndices> colReassociation = {{0, 1, 2},
+                                                          {3, 4, 5}};
+    SmallVector<ReassociationIndices> reassociation = {{0, 1, 2}, {3}};
+    auto lhsType = RankedTensorType::get({n * oh * ow, fh * fw * ic},
+                                         inputType.getElementType());
+    auto rhsType = RankedTensorType::get({fh * fw * ic, oc},
+                                         filterType.getElementType());
+    auto outType = RankedTensorType::get({n * oh * ow, oc},
+                                         outputType.getElementType());
+    Value lhs = rewriter.create<tensor::CollapseShapeOp>(
+        loc, lhsType, colOp.getResult(0), colReassociation);
+    Value rhs = rewriter.create<tensor::CollapseShapeOp>(loc, rhsType, filter,
+                                                         reassociation);
+    Value out = rewriter.create<tensor::CollapseShapeOp>(loc, outType, output,
+                                                         reassociation);
+    auto matmulOp = rewriter.create<linalg::MatmulOp>(
+        loc, outType, ValueRange{lhs, rhs}, out);
+    rewriter.replaceOpWithNewOp<tensor::ExpandShapeOp>(
+        convOp, outputType, matmulOp.getResult(0), reassociation);
+    return success();
+  }
+};
+
 /// Pattern to fold a `linalg.fill` -> `iree_linalg_ext.set_encoding`
 /// operation into a `linalg.fill` of the encoded type.
 struct FoldFillWithSetEncoding
@@ -271,7 +459,12 @@ void SetEncodingPass::runOnOperation() {
   MLIRContext *context = &getContext();
   {
     RewritePatternSet patterns(context);
-    patterns.insert<SetMatmulEncoding>(context, defaultPadding);
+    patterns.insert<SetContractionEncoding<linalg::MatmulOp>,
+                    SetContractionEncoding<linalg::BatchMatmulOp>>(
+        context, defaultPadding);
+    patterns.insert<ConvertVectorContractionToMatmul<linalg::VecmatOp>,
+                    ConvertVectorContractionToMatmul<linalg::MatvecOp>,
+                    ConvertConv2DNhwcHwcfToMatmul>(context);
     linalg::FillOp::getCanonicalizationPatterns(patterns, context);
     patterns.insert<FoldFillWithSetEncoding>(context);
     memref::populateResolveRankedShapedTypeResultDimsPatterns(patterns);
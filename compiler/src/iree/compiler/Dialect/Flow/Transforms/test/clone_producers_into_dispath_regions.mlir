@@ -93,3 +93,64 @@ func.func @complex_create(%real : f32, %imag : f32, %input: tensor<4x2xcomplex<f
 // CHECK: complex.mul
 // CHECK: linalg.yield
 // CHECK: flow.return
+
+// -----
+
+func.func @dequantization_clone(%lhs: tensor<4x8xf32>, %weight: tensor<8x16xi8>, %scales: tensor<16xf32>, %init: tensor<4x16xf32>) -> tensor<4x16xf32> {
+  %empty = tensor.empty() : tensor<8x16xf32>
+  %dequant = linalg.generic {
+    indexing_maps = [affine_map<(d0, d1) -> (d0, d1)>, affine_map<(d0, d1) -> (d1)>, affine_map<(d0, d1) -> (d0, d1)>],
+    iterator_types = ["parallel", "parallel"],
+    util.widening
+  } ins(%weight, %scales : tensor<8x16xi8>, tensor<16xf32>) outs(%empty : tensor<8x16xf32>) {
+  ^bb0(%in: i8, %scale: f32, %out: f32):
+    %0 = arith.sitofp %in : i8 to f32
+    %1 = arith.mulf %0, %scale : f32
+    linalg.yield %1 : f32
+  } -> tensor<8x16xf32>
+  %result = flow.dispatch.region -> (tensor<4x16xf32>) {
+    %matmul = linalg.matmul ins(%lhs, %dequant : tensor<4x8xf32>, tensor<8x16xf32>) outs(%init : tensor<4x16xf32>) -> tensor<4x16xf32>
+    flow.return %matmul : tensor<4x16xf32>
+  }
+  return %result : tensor<4x16xf32>
+}
+
+// CHECK-LABEL: func.func @dequantization_clone
+//  CHECK-SAME:     %[[LHS:[a-zA-Z0-9]+]]: tensor<4x8xf32>
+//  CHECK-SAME:     %[[WEIGHT:[a-zA-Z0-9]+]]: tensor<8x16xi8>
+//  CHECK-SAME:     %[[SCALES:[a-zA-Z0-9]+]]: tensor<16xf32>
+//       CHECK:   flow.dispatch.region
+//       CHECK:     %[[EMPTY:.+]] = tensor.empty() : tensor<8x16xf32>
+//       CHECK:     %[[DEQUANT:.+]] = linalg.generic
+//  CHECK-SAME:         ins(%[[WEIGHT]], %[[SCALES]] : tensor<8x16xi8>, tensor<16xf32>)
+//       CHECK:     linalg.matmul ins(%[[LHS]], %[[DEQUANT]] :
+//       CHECK:   flow.return
+
+// -----
+
+// Generics that convert narrow values but are not marked as widening are not
+// cloned.
+func.func @unmarked_dequantization_no_clone(%lhs: tensor<4x8xf32>, %weight: tensor<8x16xi8>, %scales: tensor<16xf32>, %init: tensor<4x16xf32>) -> tensor<4x16xf32> {
+  %empty = tensor.empty() : tensor<8x16xf32>
+  %dequant = linalg.generic {
+    indexing_maps = [affine_map<(d0, d1) -> (d0, d1)>, affine_map<(d0, d1) -> (d1)>, affine_map<(d0, d1) -> (d0, d1)>],
+    iterator_types = ["parallel", "parallel"]
+  } ins(%weight, %scales : tensor<8x16xi8>, tensor<16xf32>) outs(%empty : tensor<8x16xf32>) {
+  ^bb0(%in: i8, %scale: f32, %out: f32):
+    %0 = arith.sitofp %in : i8 to f32
+    %1 = arith.mulf %0, %scale : f32
+    linalg.yield %1 : f32
+  } -> tensor<8x16xf32>
+  %result = flow.dispatch.region -> (tensor<4x16xf32>) {
+    %matmul = linalg.matmul ins(%lhs, %dequant : tensor<4x8xf32>, tensor<8x16xf32>) outs(%init : tensor<4x16xf32>) -> tensor<4x16xf32>
+    flow.return %matmul : tensor<4x16xf32>
+  }
+  return %result : tensor<4x16xf32>
+}
+
+// CHECK-LABEL: func.func @unmarked_dequantization_no_clone
+//       CHECK:   %[[DEQUANT:.+]] = linalg.generic
+//       CHECK:   flow.dispatch.region
+//   CHECK-NOT:     linalg.generic
+//       CHECK:     linalg.matmul ins(%{{.+}}, %[[DEQUANT]] :
+//       CHECK:   flow.return
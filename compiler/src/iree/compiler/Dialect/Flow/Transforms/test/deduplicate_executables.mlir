@@ -376,3 +376,100 @@ flow.executable @block_successors_ex_with_swapped_cond_br {
     }
   }
 }
+
+// -----
+
+// CHECK-LABEL: flow.executable public @local_symbols_ex_0
+flow.executable @local_symbols_ex_0 {
+  flow.executable.export @local_symbols_entry_0
+  builtin.module {
+    func.func private @local_symbols_helper_0(%arg0: tensor<4xf32>) -> tensor<4xf32> {
+      %0 = arith.addf %arg0, %arg0 : tensor<4xf32>
+      return %0 : tensor<4xf32>
+    }
+    func.func @local_symbols_entry_0(%arg0: tensor<4xf32>) -> tensor<4xf32> {
+      %0 = func.call @local_symbols_helper_0(%arg0) : (tensor<4xf32>) -> tensor<4xf32>
+      return %0 : tensor<4xf32>
+    }
+  }
+}
+// CHECK-NOT: flow.executable public @local_symbols_ex_1
+flow.executable @local_symbols_ex_1 {
+  flow.executable.export @local_symbols_entry_1
+  builtin.module {
+    func.func private @local_symbols_helper_1(%arg0: tensor<4xf32>) -> tensor<4xf32> {
+      %0 = arith.addf %arg0, %arg0 : tensor<4xf32>
+      return %0 : tensor<4xf32>
+    }
+    func.func @local_symbols_entry_1(%arg0: tensor<4xf32>) -> tensor<4xf32> {
+      %0 = func.call @local_symbols_helper_1(%arg0) : (tensor<4xf32>) -> tensor<4xf32>
+      return %0 : tensor<4xf32>
+    }
+  }
+}
+// CHECK-LABEL: flow.executable public @local_symbols_ex_2
+flow.executable @local_symbols_ex_2 {
+  flow.executable.export @local_symbols_entry_2
+  builtin.module {
+    func.func private @local_symbols_helper_2(%arg0: tensor<4xf32>) -> tensor<4xf32> {
+      %0 = arith.addf %arg0, %arg0 : tensor<4xf32>
+      return %0 : tensor<4xf32>
+    }
+    func.func @local_symbols_entry_2(%arg0: tensor<4xf32>) -> tensor<4xf32> {
+      %0 = func.call @local_symbols_helper_2(%arg0) : (tensor<4xf32>) -> tensor<4xf32>
+      %1 = func.call @local_symbols_entry_2(%0) : (tensor<4xf32>) -> tensor<4xf32>
+      return %1 : tensor<4xf32>
+    }
+  }
+}
+// CHECK-LABEL: func.func @local_symbols
+func.func @local_symbols(%arg0: tensor<4xf32>) -> tensor<4xf32> {
+  %c4 = arith.constant 4 : index
+  // CHECK: %0 = flow.dispatch @local_symbols_ex_0::@local_symbols_entry_0[%c4](%arg0) : (tensor<4xf32>) -> tensor<4xf32>
+  %0 = flow.dispatch @local_symbols_ex_0::@local_symbols_entry_0[%c4] (%arg0) : (tensor<4xf32>) -> tensor<4xf32>
+  // CHECK: %1 = flow.dispatch @local_symbols_ex_0::@local_symbols_entry_0[%c4](%arg0) : (tensor<4xf32>) -> tensor<4xf32>
+  %1 = flow.dispatch @local_symbols_ex_1::@local_symbols_entry_1[%c4] (%arg0) : (tensor<4xf32>) -> tensor<4xf32>
+  // CHECK: %2 = flow.dispatch @local_symbols_ex_2::@local_symbols_entry_2[%c4](%arg0) : (tensor<4xf32>) -> tensor<4xf32>
+  %2 = flow.dispatch @local_symbols_ex_2::@local_symbols_entry_2[%c4] (%arg0) : (tensor<4xf32>) -> tensor<4xf32>
+  return %0 : tensor<4xf32>
+}
+
+// -----
+
+// CHECK-LABEL: flow.executable public @function_ref_ex_0
+flow.executable @function_ref_ex_0 {
+  flow.executable.export @function_ref_add as("function_ref_entry")
+  builtin.module {
+    func.func @function_ref_add(%arg0: tensor<4xf32>) -> tensor<4xf32> {
+      %0 = arith.addf %arg0, %arg0 : tensor<4xf32>
+      return %0 : tensor<4xf32>
+    }
+    func.func @function_ref_sub(%arg0: tensor<4xf32>) -> tensor<4xf32> {
+      %0 = arith.subf %arg0, %arg0 : tensor<4xf32>
+      return %0 : tensor<4xf32>
+    }
+  }
+}
+// CHECK-LABEL: flow.executable public @function_ref_ex_1
+flow.executable @function_ref_ex_1 {
+  flow.executable.export @function_ref_sub as("function_ref_entry")
+  builtin.module {
+    func.func @function_ref_add(%arg0: tensor<4xf32>) -> tensor<4xf32> {
+      %0 = arith.addf %arg0, %arg0 : tensor<4xf32>
+      return %0 : tensor<4xf32>
+    }
+    func.func @function_ref_sub(%arg0: tensor<4xf32>) -> tensor<4xf32> {
+      %0 = arith.subf %arg0, %arg0 : tensor<4xf32>
+      return %0 : tensor<4xf32>
+    }
+  }
+}
+// CHECK-LABEL: func.func @function_ref
+func.func @function_ref(%arg0: tensor<4xf32>) -> (tensor<4xf32>, tensor<4xf32>) {
+  %c4 = arith.constant 4 : index
+  // CHECK: %0 = flow.dispatch @function_ref_ex_0::@function_ref_entry[%c4](%arg0) : (tensor<4xf32>) -> tensor<4xf32>
+  %0 = flow.dispatch @function_ref_ex_0::@function_ref_entry[%c4] (%arg0) : (tensor<4xf32>) -> tensor<4xf32>
+  // CHECK: %1 = flow.dispatch @function_ref_ex_1::@function_ref_entry[%c4](%arg0) : (tensor<4xf32>) -> tensor<4xf32>
+  %1 = flow.dispatch @function_ref_ex_1::@function_ref_entry[%c4] (%arg0) : (tensor<4xf32>) -> tensor<4xf32>
+  return %0, %1 : tensor<4xf32>, tensor<4xf32>
+}
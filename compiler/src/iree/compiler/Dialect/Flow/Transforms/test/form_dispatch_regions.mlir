@@ -286,15 +286,14 @@ func.func @unset_encoding_slice_elementwise_fusion(
 // CHECK-LABEL: func @unset_encoding_slice_elementwise_fusion(
 //  CHECK-SAME:     %[[ARG0:.+]]: tensor<?x?xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_LHS>>
 //  CHECK-SAME:     %[[ARG1:.+]]: tensor<?xf32>
-//       CHECK:   %[[RESULT0:.+]] = flow.dispatch.region
+//       CHECK:   %[[RESULT:.+]] = flow.dispatch.region
 //       CHECK:     %[[UNSET_ENCODING:.+]] = iree_linalg_ext.unset_encoding %[[ARG0]]
-//       CHECK:     %[[SLICE:.+]] = tensor.extract_slice
-//       CHECK:     flow.return %[[SLICE]]
-//       CHECK:   %[[RESULT1:.+]] = flow.dispatch.region
+//       CHECK:     %[[SLICE:.+]] = tensor.extract_slice %[[UNSET_ENCODING]]
 //       CHECK:     %[[GENERIC:.+]] = linalg.generic
-//  CHECK-SAME:         ins(%[[RESULT0]], %[[ARG1]]
+//  CHECK-SAME:         ins(%[[SLICE]], %[[ARG1]]
 //       CHECK:     flow.return %[[GENERIC]]
-//       CHECK:   return %[[RESULT1]]
+//   CHECK-NOT:   flow.dispatch.region
+//       CHECK:   return %[[RESULT]]
 
 // -----
 
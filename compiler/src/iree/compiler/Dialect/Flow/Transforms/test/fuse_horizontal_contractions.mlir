@@ -0,0 +1,77 @@
+// RUN: iree-opt --split-input-file --pass-pipeline="builtin.module(func.func(iree-flow-fuse-horizontal-contractions))" %s | FileCheck %s
+// RUN: iree-opt --split-input-file --pass-pipeline="builtin.module(func.func(iree-flow-fuse-horizontal-contractions{max-fused-elements=64}))" %s | FileCheck %s --check-prefix=CAPPED
+
+util.global private @weight_q = dense<1.0> : tensor<16x8xf32>
+util.global private @weight_k = dense<2.0> : tensor<16x8xf32>
+util.global private @weight_v = dense<3.0> : tensor<16x4xf32>
+
+func.func @shared_lhs(%lhs: tensor<4x16xf32>) -> (tensor<4x8xf32>, tensor<4x8xf32>, tensor<4x4xf32>) {
+  %cst = arith.constant 0.0 : f32
+  %wq = util.global.load @weight_q : tensor<16x8xf32>
+  %wk = util.global.load @weight_k : tensor<16x8xf32>
+  %wv = util.global.load @weight_v : tensor<16x4xf32>
+  %empty0 = tensor.empty() : tensor<4x8xf32>
+  %fill0 = linalg.fill ins(%cst : f32) outs(%empty0 : tensor<4x8xf32>) -> tensor<4x8xf32>
+  %q = linalg.matmul ins(%lhs, %wq : tensor<4x16xf32>, tensor<16x8xf32>) outs(%fill0 : tensor<4x8xf32>) -> tensor<4x8xf32>
+  %empty1 = tensor.empty() : tensor<4x8xf32>
+  %fill1 = linalg.fill ins(%cst : f32) outs(%empty1 : tensor<4x8xf32>) -> tensor<4x8xf32>
+  %k = linalg.matmul ins(%lhs, %wk : tensor<4x16xf32>, tensor<16x8xf32>) outs(%fill1 : tensor<4x8xf32>) -> tensor<4x8xf32>
+  %empty2 = tensor.empty() : tensor<4x4xf32>
+  %fill2 = linalg.fill ins(%cst : f32) outs(%empty2 : tensor<4x4xf32>) -> tensor<4x4xf32>
+  %v = linalg.matmul ins(%lhs, %wv : tensor<4x16xf32>, tensor<16x4xf32>) outs(%fill2 : tensor<4x4xf32>) -> tensor<4x4xf32>
+  return %q, %k, %v : tensor<4x8xf32>, tensor<4x8xf32>, tensor<4x4xf32>
+}
+// CHECK-LABEL: func.func @shared_lhs
+//  CHECK-SAME:     (%[[LHS:.+]]: tensor<4x16xf32>)
+//   CHECK-DAG:   %[[WQ:.+]] = util.global.load @weight_q
+//   CHECK-DAG:   %[[WK:.+]] = util.global.load @weight_k
+//   CHECK-DAG:   %[[WV:.+]] = util.global.load @weight_v
+//       CHECK:   %[[RHS_EMPTY:.+]] = tensor.empty() : tensor<16x20xf32>
+//       CHECK:   %[[RHS0:.+]] = tensor.insert_slice %[[WQ]] into %[[RHS_EMPTY]][0, 0] [16, 8] [1, 1]
+//       CHECK:   %[[RHS1:.+]] = tensor.insert_slice %[[WK]] into %[[RHS0]][0, 8] [16, 8] [1, 1]
+//       CHECK:   %[[RHS:.+]] = tensor.insert_slice %[[WV]] into %[[RHS1]][0, 16] [16, 4] [1, 1]
+//       CHECK:   %[[EMPTY:.+]] = tensor.empty() : tensor<4x20xf32>
+//       CHECK:   %[[FILL:.+]] = linalg.fill ins(%{{.+}} : f32) outs(%[[EMPTY]] : tensor<4x20xf32>)
+//       CHECK:   %[[FUSED:.+]] = linalg.matmul ins(%[[LHS]], %[[RHS]] : tensor<4x16xf32>, tensor<16x20xf32>) outs(%[[FILL]] : tensor<4x20xf32>)
+//       CHECK:   %[[Q:.+]] = tensor.extract_slice %[[FUSED]][0, 0] [4, 8] [1, 1]
+//       CHECK:   %[[K:.+]] = tensor.extract_slice %[[FUSED]][0, 8] [4, 8] [1, 1]
+//       CHECK:   %[[V:.+]] = tensor.extract_slice %[[FUSED]][0, 16] [4, 4] [1, 1]
+//   CHECK-NOT:   linalg.matmul
+//       CHECK:   return %[[Q]], %[[K]], %[[V]]
+
+// The fused result of all three matmuls exceeds the cap so only the first two
+// are fused and the last one is left alone.
+// CAPPED-LABEL: func.func @shared_lhs
+//       CAPPED:   linalg.matmul {{.+}} -> tensor<4x16xf32>
+//       CAPPED:   linalg.matmul {{.+}} -> tensor<4x4xf32>
+//   CAPPED-NOT:   linalg.matmul
+
+// -----
+
+// Matmuls with mutable (or otherwise non-constant) RHS would need a copy on
+// every invocation to be concatenated and matmuls with different init values
+// cannot share a fill; neither is fused.
+
+util.global private mutable @mutable_weight = dense<1.0> : tensor<16x8xf32>
+
+func.func @not_fusable(%lhs: tensor<4x16xf32>, %rhs: tensor<16x8xf32>) -> (tensor<4x8xf32>, tensor<4x8xf32>, tensor<4x8xf32>, tensor<4x8xf32>) {
+  %zero = arith.constant 0.0 : f32
+  %one = arith.constant 1.0 : f32
+  %weight = arith.constant dense<2.0> : tensor<16x8xf32>
+  %mutable = util.global.load @mutable_weight : tensor<16x8xf32>
+  %empty = tensor.empty() : tensor<4x8xf32>
+  %fill0 = linalg.fill ins(%zero : f32) outs(%empty : tensor<4x8xf32>) -> tensor<4x8xf32>
+  %fill1 = linalg.fill ins(%one : f32) outs(%empty : tensor<4x8xf32>) -> tensor<4x8xf32>
+  %0 = linalg.matmul ins(%lhs, %rhs : tensor<4x16xf32>, tensor<16x8xf32>) outs(%fill0 : tensor<4x8xf32>) -> tensor<4x8xf32>
+  %1 = linalg.matmul ins(%lhs, %mutable : tensor<4x16xf32>, tensor<16x8xf32>) outs(%fill0 : tensor<4x8xf32>) -> tensor<4x8xf32>
+  %2 = linalg.matmul ins(%lhs, %weight : tensor<4x16xf32>, tensor<16x8xf32>) outs(%fill0 : tensor<4x8xf32>) -> tensor<4x8xf32>
+  %3 = linalg.matmul ins(%lhs, %weight : tensor<4x16xf32>, tensor<16x8xf32>) outs(%fill1 : tensor<4x8xf32>) -> tensor<4x8xf32>
+  return %0, %1, %2, %3 : tensor<4x8xf32>, tensor<4x8xf32>, tensor<4x8xf32>, tensor<4x8xf32>
+}
+// CHECK-LABEL: func.func @not_fusable
+//   CHECK-NOT:   tensor.insert_slice
+//   CHECK-NOT:   tensor.extract_slice
+//       CHECK:   linalg.matmul {{.+}} -> tensor<4x8xf32>
+//       CHECK:   linalg.matmul {{.+}} -> tensor<4x8xf32>
+//       CHECK:   linalg.matmul {{.+}} -> tensor<4x8xf32>
+//       CHECK:   linalg.matmul {{.+}} -> tensor<4x8xf32>
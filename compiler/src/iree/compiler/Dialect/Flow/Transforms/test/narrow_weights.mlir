@@ -0,0 +1,78 @@
+// RUN: iree-opt --split-input-file --iree-flow-narrow-weights="storage-type=f16 min-elements=4" %s | FileCheck %s --check-prefix=F16
+// RUN: iree-opt --split-input-file --iree-flow-narrow-weights="storage-type=i8 min-elements=4" %s | FileCheck %s --check-prefix=I8
+
+//  I8-DAG: #[[MAP:.+]] = affine_map<(d0, d1) -> (d0, d1)>
+//  I8-DAG: #[[CHANNEL_MAP:.+]] = affine_map<(d0, d1) -> (d1)>
+// F16: util.global private @weight_narrow = dense<{{.+}}> : tensor<2x2xf16>
+// F16-NOT: util.global private @weight_scales
+// F16-NOT: util.global private @weight =
+// I8: util.global private @weight_narrow = dense<{{\[\[}}127, -127], [-127, 64]]> : tensor<2x2xi8>
+// I8: util.global private @weight_scales = dense<[1.000000e+00, 2.000000e+00]> : tensor<2xf32>
+// I8-NOT: util.global private @weight =
+util.global private @weight = dense<[[127.0, -254.0], [-127.0, 128.0]]> : tensor<2x2xf32>
+
+// F16-LABEL: func.func @global_weight
+// F16-SAME:    (%[[LHS:.+]]: tensor<4x2xf32>, %[[INIT:.+]]: tensor<4x2xf32>)
+//      F16:   %[[STORAGE:.+]] = util.global.load @weight_narrow : tensor<2x2xf16>
+//      F16:   %[[EMPTY:.+]] = tensor.empty() : tensor<2x2xf32>
+//      F16:   %[[WIDE:.+]] = linalg.generic
+// F16-SAME:       ins(%[[STORAGE]] : tensor<2x2xf16>) outs(%[[EMPTY]] : tensor<2x2xf32>)
+// F16-SAME:       attrs =  {util.widening}
+//      F16:     arith.extf
+//      F16:   linalg.matmul ins(%[[LHS]], %[[WIDE]] : tensor<4x2xf32>, tensor<2x2xf32>)
+
+// I8-LABEL: func.func @global_weight
+// I8-SAME:    (%[[LHS:.+]]: tensor<4x2xf32>, %[[INIT:.+]]: tensor<4x2xf32>)
+//      I8:   %[[STORAGE:.+]] = util.global.load @weight_narrow : tensor<2x2xi8>
+//      I8:   %[[SCALES:.+]] = util.global.load @weight_scales : tensor<2xf32>
+//      I8:   %[[WIDE:.+]] = linalg.generic
+// I8-SAME:       indexing_maps = [#[[MAP]], #[[CHANNEL_MAP]], #[[MAP]]]
+// I8-SAME:       ins(%[[STORAGE]], %[[SCALES]] : tensor<2x2xi8>, tensor<2xf32>)
+// I8-SAME:       attrs =  {util.widening}
+//      I8:     arith.sitofp
+//      I8:     arith.mulf
+//      I8:   linalg.matmul ins(%[[LHS]], %[[WIDE]] : tensor<4x2xf32>, tensor<2x2xf32>)
+func.func @global_weight(%lhs: tensor<4x2xf32>, %init: tensor<4x2xf32>) -> tensor<4x2xf32> {
+  %weight = util.global.load @weight : tensor<2x2xf32>
+  %0 = linalg.matmul ins(%lhs, %weight : tensor<4x2xf32>, tensor<2x2xf32>) outs(%init : tensor<4x2xf32>) -> tensor<4x2xf32>
+  return %0 : tensor<4x2xf32>
+}
+
+// -----
+
+// Values outside of the f16 range exceed the accuracy budget and are kept as
+// f32 while per-channel i8 scales can represent them.
+
+// F16-LABEL: func.func @constant_weight_over_budget
+//       F16:   arith.constant dense<{{.+}}> : tensor<2x2xf32>
+//   F16-NOT:   linalg.generic
+// I8-LABEL: func.func @constant_weight_over_budget
+//       I8:   %[[STORAGE:.+]] = arith.constant dense<{{\[\[}}127, 127], [-127, 127]]> : tensor<2x2xi8>
+//       I8:   %[[SCALES:.+]] = arith.constant dense<[1.000000e+00, 1.000000e+04]> : tensor<2xf32>
+//       I8:   linalg.generic
+//  I8-SAME:       ins(%[[STORAGE]], %[[SCALES]] : tensor<2x2xi8>, tensor<2xf32>)
+//  I8-SAME:       attrs =  {util.widening}
+func.func @constant_weight_over_budget(%lhs: tensor<4x2xf32>, %init: tensor<4x2xf32>) -> tensor<4x2xf32> {
+  %weight = arith.constant dense<[[127.0, 1.27e+06], [-127.0, 1.27e+06]]> : tensor<2x2xf32>
+  %0 = linalg.matmul ins(%lhs, %weight : tensor<4x2xf32>, tensor<2x2xf32>) outs(%init : tensor<4x2xf32>) -> tensor<4x2xf32>
+  return %0 : tensor<4x2xf32>
+}
+
+// -----
+
+// Weights used as anything other than an input of a structured op are left
+// unchanged.
+
+// F16: util.global private @accumulator = dense<{{.+}}> : tensor<2x2xf32>
+// I8: util.global private @accumulator = dense<{{.+}}> : tensor<2x2xf32>
+util.global private @accumulator = dense<[[1.0, 2.0], [3.0, 4.0]]> : tensor<2x2xf32>
+
+// F16-LABEL: func.func @init_operand
+//   F16-NOT:   linalg.generic
+// I8-LABEL: func.func @init_operand
+//   I8-NOT:   linalg.generic
+func.func @init_operand(%lhs: tensor<2x2xf32>, %rhs: tensor<2x2xf32>) -> tensor<2x2xf32> {
+  %init = util.global.load @accumulator : tensor<2x2xf32>
+  %0 = linalg.matmul ins(%lhs, %rhs : tensor<2x2xf32>, tensor<2x2xf32>) outs(%init : tensor<2x2xf32>) -> tensor<2x2xf32>
+  return %0 : tensor<2x2xf32>
+}
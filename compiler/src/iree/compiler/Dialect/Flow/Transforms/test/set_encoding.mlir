@@ -156,3 +156,143 @@ func.func @fold_fill_with_tensor_pad(%arg0 : index, %arg1 : index, %arg2 : index
 //      CHECK:   %[[FILL:.+]] = linalg.fill
 // CHECK-SAME:       outs(%[[EMPTY]] :
 //      CHECK:   return %[[FILL]]
+
+// -----
+
+func.func @batch_matmul_padding(%arg0 : tensor<2x100x250xf32>, %arg1 : tensor<2x250x500xf32>,
+    %arg2 : tensor<2x100x500xf32>) -> tensor<2x100x500xf32> {
+  %0 = linalg.batch_matmul ins(%arg0, %arg1 : tensor<2x100x250xf32>, tensor<2x250x500xf32>)
+      outs(%arg2 : tensor<2x100x500xf32>) -> tensor<2x100x500xf32>
+  return %0 : tensor<2x100x500xf32>
+}
+//      CHECK: func @batch_matmul_padding(
+// CHECK-SAME:     %[[ARG0:.+]]: tensor<2x100x250xf32>
+// CHECK-SAME:     %[[ARG1:.+]]: tensor<2x250x500xf32>
+// CHECK-SAME:     %[[ARG2:.+]]: tensor<2x100x500xf32>
+//      CHECK:   %[[LHS_PAD:.+]] = tensor.pad %[[ARG0]] low[0, 0, 0] high[0, 12, 6]
+//      CHECK:       tensor<2x100x250xf32> to tensor<2x112x256xf32>
+//      CHECK:   %[[RHS_PAD:.+]] = tensor.pad %[[ARG1]] low[0, 0, 0] high[0, 6, 12]
+//      CHECK:       tensor<2x250x500xf32> to tensor<2x256x512xf32>
+//      CHECK:   %[[OUTS_PAD:.+]] = tensor.pad %[[ARG2]] low[0, 0, 0] high[0, 12, 12]
+//      CHECK:       tensor<2x100x500xf32> to tensor<2x112x512xf32>
+//      CHECK:   %[[LHS:.+]] = iree_linalg_ext.set_encoding %[[LHS_PAD]]
+// CHECK-SAME:       tensor<2x112x256xf32, #iree_linalg_ext.encoding<BATCH_MATMUL_F32F32F32_LHS>>
+//      CHECK:   %[[RHS:.+]] = iree_linalg_ext.set_encoding %[[RHS_PAD]]
+// CHECK-SAME:       tensor<2x256x512xf32, #iree_linalg_ext.encoding<BATCH_MATMUL_F32F32F32_RHS>>
+//      CHECK:   %[[OUTS:.+]] = iree_linalg_ext.set_encoding %[[OUTS_PAD]]
+// CHECK-SAME:       tensor<2x112x512xf32, #iree_linalg_ext.encoding<BATCH_MATMUL_F32F32F32_RESULT>>
+//      CHECK:   %[[BATCH_MATMUL:.+]] = linalg.batch_matmul
+// CHECK-SAME:       ins(%[[LHS]], %[[RHS]] :
+// CHECK-SAME:       outs(%[[OUTS]] :
+//      CHECK:   %[[RESULT_PADDED:.+]] = iree_linalg_ext.unset_encoding %[[BATCH_MATMUL]]
+//      CHECK:   %[[RESULT:.+]] = tensor.extract_slice %[[RESULT_PADDED]][0, 0, 0] [2, 100, 500] [1, 1, 1]
+//      CHECK:   return %[[RESULT]]
+
+// -----
+
+func.func @vecmat(%arg0 : tensor<250xf32>, %arg1 : tensor<250x500xf32>,
+    %arg2 : tensor<500xf32>) -> tensor<500xf32> {
+  %0 = linalg.vecmat ins(%arg0, %arg1 : tensor<250xf32>, tensor<250x500xf32>)
+      outs(%arg2 : tensor<500xf32>) -> tensor<500xf32>
+  return %0 : tensor<500xf32>
+}
+//      CHECK: func @vecmat(
+// CHECK-SAME:     %[[ARG0:.+]]: tensor<250xf32>
+// CHECK-SAME:     %[[ARG1:.+]]: tensor<250x500xf32>
+// CHECK-SAME:     %[[ARG2:.+]]: tensor<500xf32>
+//  CHECK-DAG:   %[[EXPANDED_LHS:.+]] = tensor.expand_shape %[[ARG0]] {{\[}}[0, 1]] : tensor<250xf32> into tensor<1x250xf32>
+//  CHECK-DAG:   %[[EXPANDED_OUTS:.+]] = tensor.expand_shape %[[ARG2]] {{\[}}[0, 1]] : tensor<500xf32> into tensor<1x500xf32>
+//      CHECK:   %[[LHS_PAD:.+]] = tensor.pad %[[EXPANDED_LHS]] low[0, 0] high[0, 6]
+//      CHECK:       tensor<1x250xf32> to tensor<1x256xf32>
+//      CHECK:   %[[RHS_PAD:.+]] = tensor.pad %[[ARG1]] low[0, 0] high[6, 12]
+//      CHECK:   %[[OUTS_PAD:.+]] = tensor.pad %[[EXPANDED_OUTS]] low[0, 0] high[0, 12]
+//      CHECK:       tensor<1x500xf32> to tensor<1x512xf32>
+//      CHECK:   %[[LHS:.+]] = iree_linalg_ext.set_encoding %[[LHS_PAD]]
+// CHECK-SAME:       tensor<1x256xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_LHS>>
+//      CHECK:   %[[RHS:.+]] = iree_linalg_ext.set_encoding %[[RHS_PAD]]
+// CHECK-SAME:       tensor<256x512xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RHS>>
+//      CHECK:   %[[OUTS:.+]] = iree_linalg_ext.set_encoding %[[OUTS_PAD]]
+// CHECK-SAME:       tensor<1x512xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RESULT>>
+//      CHECK:   %[[MATMUL:.+]] = linalg.matmul
+// CHECK-SAME:       ins(%[[LHS]], %[[RHS]] :
+// CHECK-SAME:       outs(%[[OUTS]] :
+//      CHECK:   %[[RESULT_PADDED:.+]] = iree_linalg_ext.unset_encoding %[[MATMUL]]
+//      CHECK:   %[[RESULT_SLICE:.+]] = tensor.extract_slice %[[RESULT_PADDED]][0, 0] [1, 500] [1, 1]
+//      CHECK:   %[[RESULT:.+]] = tensor.collapse_shape %[[RESULT_SLICE]] {{\[}}[0, 1]] : tensor<1x500xf32> into tensor<500xf32>
+//      CHECK:   return %[[RESULT]]
+
+// -----
+
+func.func @matvec(%arg0 : tensor<500x250xf32>, %arg1 : tensor<250xf32>,
+    %arg2 : tensor<500xf32>) -> tensor<500xf32> {
+  %0 = linalg.matvec ins(%arg0, %arg1 : tensor<500x250xf32>, tensor<250xf32>)
+      outs(%arg2 : tensor<500xf32>) -> tensor<500xf32>
+  return %0 : tensor<500xf32>
+}
+//      CHECK: func @matvec(
+// CHECK-SAME:     %[[ARG0:.+]]: tensor<500x250xf32>
+// CHECK-SAME:     %[[ARG1:.+]]: tensor<250xf32>
+// CHECK-SAME:     %[[ARG2:.+]]: tensor<500xf32>
+//  CHECK-DAG:   %[[EXPANDED_RHS:.+]] = tensor.expand_shape %[[ARG1]] {{\[}}[0, 1]] : tensor<250xf32> into tensor<250x1xf32>
+//  CHECK-DAG:   %[[EXPANDED_OUTS:.+]] = tensor.expand_shape %[[ARG2]] {{\[}}[0, 1]] : tensor<500xf32> into tensor<500x1xf32>
+//      CHECK:   %[[LHS_PAD:.+]] = tensor.pad %[[ARG0]] low[0, 0] high[12, 6]
+//      CHECK:   %[[RHS_PAD:.+]] = tensor.pad %[[EXPANDED_RHS]] low[0, 0] high[6, 0]
+//      CHECK:       tensor<250x1xf32> to tensor<256x1xf32>
+//      CHECK:   %[[OUTS_PAD:.+]] = tensor.pad %[[EXPANDED_OUTS]] low[0, 0] high[12, 0]
+//      CHECK:       tensor<500x1xf32> to tensor<512x1xf32>
+//      CHECK:   %[[LHS:.+]] = iree_linalg_ext.set_encoding %[[LHS_PAD]]
+// CHECK-SAME:       tensor<512x256xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_LHS>>
+//      CHECK:   %[[RHS:.+]] = iree_linalg_ext.set_encoding %[[RHS_PAD]]
+// CHECK-SAME:       tensor<256x1xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RHS>>
+//      CHECK:   %[[OUTS:.+]] = iree_linalg_ext.set_encoding %[[OUTS_PAD]]
+// CHECK-SAME:       tensor<512x1xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RESULT>>
+//      CHECK:   %[[MATMUL:.+]] = linalg.matmul
+// CHECK-SAME:       ins(%[[LHS]], %[[RHS]] :
+// CHECK-SAME:       outs(%[[OUTS]] :
+//      CHECK:   %[[RESULT_PADDED:.+]] = iree_linalg_ext.unset_encoding %[[MATMUL]]
+//      CHECK:   %[[RESULT_SLICE:.+]] = tensor.extract_slice %[[RESULT_PADDED]][0, 0] [500, 1] [1, 1]
+//      CHECK:   %[[RESULT:.+]] = tensor.collapse_shape %[[RESULT_SLICE]] {{\[}}[0, 1]] : tensor<500x1xf32> into tensor<500xf32>
+//      CHECK:   return %[[RESULT]]
+
+// -----
+
+func.func @conv_2d_nhwc_hwcf(%arg0 : tensor<2x16x16x4xf32>, %arg1 : tensor<3x3x4x16xf32>,
+    %arg2 : tensor<2x14x14x16xf32>) -> tensor<2x14x14x16xf32> {
+  %0 = linalg.conv_2d_nhwc_hwcf
+      {dilations = dense<1> : tensor<2xi64>, strides = dense<1> : tensor<2xi64>}
+      ins(%arg0, %arg1 : tensor<2x16x16x4xf32>, tensor<3x3x4x16xf32>)
+      outs(%arg2 : tensor<2x14x14x16xf32>) -> tensor<2x14x14x16xf32>
+  return %0 : tensor<2x14x14x16xf32>
+}
+//  CHECK-DAG: #[[IM2COL_MAP:.+]] = affine_map<(d0, d1, d2, d3, d4, d5) -> (d0, d1 + d3, d2 + d4, d5)>
+//      CHECK: func @conv_2d_nhwc_hwcf(
+// CHECK-SAME:     %[[ARG0:.+]]: tensor<2x16x16x4xf32>
+// CHECK-SAME:     %[[ARG1:.+]]: tensor<3x3x4x16xf32>
+// CHECK-SAME:     %[[ARG2:.+]]: tensor<2x14x14x16xf32>
+//      CHECK:   %[[IM2COL:.+]] = linalg.generic
+// CHECK-SAME:       indexing_maps = [#[[IM2COL_MAP]],
+// CHECK-SAME:       ins(%[[ARG0]] : tensor<2x16x16x4xf32>)
+// CHECK-SAME:       -> tensor<2x14x14x3x3x4xf32>
+//      CHECK:   %[[COL:.+]] = tensor.collapse_shape %[[IM2COL]] {{\[}}[0, 1, 2], [3, 4, 5]]
+// CHECK-SAME:       tensor<2x14x14x3x3x4xf32> into tensor<392x36xf32>
+//      CHECK:   %[[FILTER:.+]] = tensor.collapse_shape %[[ARG1]] {{\[}}[0, 1, 2], [3]]
+// CHECK-SAME:       tensor<3x3x4x16xf32> into tensor<36x16xf32>
+//      CHECK:   %[[OUTPUT:.+]] = tensor.collapse_shape %[[ARG2]] {{\[}}[0, 1, 2], [3]]
+// CHECK-SAME:       tensor<2x14x14x16xf32> into tensor<392x16xf32>
+//      CHECK:   %[[LHS_PAD:.+]] = tensor.pad %[[COL]] low[0, 0] high[8, 12]
+//      CHECK:   %[[RHS_PAD:.+]] = tensor.pad %[[FILTER]] low[0, 0] high[12, 0]
+//      CHECK:   %[[OUTS_PAD:.+]] = tensor.pad %[[OUTPUT]] low[0, 0] high[8, 0]
+//      CHECK:   %[[LHS:.+]] = iree_linalg_ext.set_encoding %[[LHS_PAD]]
+// CHECK-SAME:       tensor<400x48xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_LHS>>
+//      CHECK:   %[[RHS:.+]] = iree_linalg_ext.set_encoding %[[RHS_PAD]]
+// CHECK-SAME:       tensor<48x16xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RHS>>
+//      CHECK:   %[[OUTS:.+]] = iree_linalg_ext.set_encoding %[[OUTS_PAD]]
+// CHECK-SAME:       tensor<400x16xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RESULT>>
+//      CHECK:   %[[MATMUL:.+]] = linalg.matmul
+// CHECK-SAME:       ins(%[[LHS]], %[[RHS]] :
+// CHECK-SAME:       outs(%[[OUTS]] :
+//      CHECK:   %[[RESULT_PADDED:.+]] = iree_linalg_ext.unset_encoding %[[MATMUL]]
+//      CHECK:   %[[RESULT_SLICE:.+]] = tensor.extract_slice %[[RESULT_PADDED]][0, 0] [392, 16] [1, 1]
+//      CHECK:   %[[RESULT:.+]] = tensor.expand_shape %[[RESULT_SLICE]] {{\[}}[0, 1, 2], [3]]
+// CHECK-SAME:       tensor<392x16xf32> into tensor<2x14x14x16xf32>
+//      CHECK:   return %[[RESULT]]
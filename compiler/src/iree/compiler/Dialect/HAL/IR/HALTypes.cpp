@@ -490,11 +490,34 @@ void ExecutableTargetAttr::print(AsmPrinter &p) const {
 }
 
 std::string ExecutableTargetAttr::getSymbolNameFragment() {
-  return sanitizeSymbolName(getFormat().getValue().lower());
+  std::string name = sanitizeSymbolName(getFormat().getValue().lower());
+  // Variants of the same format specialized for a dispatch concurrency need
+  // distinct names.
+  if (auto configAttr = getConfiguration()) {
+    if (auto concurrencyAttr = llvm::dyn_cast_if_present<IntegerAttr>(
+            configAttr.get("dispatch_concurrency"))) {
+      name += "_concurrency_" + std::to_string(concurrencyAttr.getInt());
+    }
+  }
+  return name;
 }
 
 Attribute ExecutableTargetAttr::getMatchExpression() {
-  return DeviceMatchExecutableFormatAttr::get(getContext(), getFormat());
+  auto formatAttr =
+      DeviceMatchExecutableFormatAttr::get(getContext(), getFormat());
+  // Targets specialized for a minimum dispatch concurrency (such as CPU
+  // variants whose workgroup distribution is tuned for a worker count) are
+  // only selected on devices that can run that many workgroups concurrently.
+  auto configAttr = getConfiguration();
+  if (!configAttr) return formatAttr;
+  auto concurrencyAttr = llvm::dyn_cast_if_present<IntegerAttr>(
+      configAttr.get("dispatch_concurrency"));
+  if (!concurrencyAttr) return formatAttr;
+  return MatchAllAttr::get(
+      getContext(),
+      ArrayRef<Attribute>{formatAttr,
+                          DeviceMatchDispatchConcurrencyAttr::get(
+                              getContext(), concurrencyAttr.getInt())});
 }
 
 // For now this is very simple: if there are any specified fields that are
@@ -1015,6 +1038,41 @@ Value DeviceMatchArchitectureAttr::buildConditionExpression(
       .getValue();
 }
 
+// static
+Attribute DeviceMatchDispatchConcurrencyAttr::parse(AsmParser &p, Type type) {
+  int64_t minimum = 0;
+  if (failed(p.parseLess()) || failed(p.parseInteger(minimum)) ||
+      failed(p.parseGreater())) {
+    return {};
+  }
+  return get(p.getContext(), minimum);
+}
+
+void DeviceMatchDispatchConcurrencyAttr::print(AsmPrinter &p) const {
+  auto &os = p.getStream();
+  os << "<" << getMinimum() << ">";
+}
+
+Value DeviceMatchDispatchConcurrencyAttr::buildConditionExpression(
+    Location loc, Value device, OpBuilder builder) const {
+  // Devices that don't support the query get the default of 1 and only match
+  // if no concurrency is required.
+  auto i1Type = builder.getI1Type();
+  auto i64Type = builder.getI64Type();
+  Value concurrency =
+      builder
+          .create<IREE::HAL::DeviceQueryOp>(
+              loc, i1Type, i64Type, device,
+              builder.getStringAttr("hal.dispatch"),
+              builder.getStringAttr("concurrency"),
+              builder.getIntegerAttr(i64Type, 1))
+          .getValue();
+  Value minimum = builder.create<arith::ConstantIntOp>(loc, getMinimum(),
+                                                       /*width=*/64);
+  return builder.create<arith::CmpIOp>(loc, arith::CmpIPredicate::sge,
+                                       concurrency, minimum);
+}
+
 // static
 Attribute DeviceMatchExecutableFormatAttr::parse(AsmParser &p, Type type) {
   StringAttr patternAttr;
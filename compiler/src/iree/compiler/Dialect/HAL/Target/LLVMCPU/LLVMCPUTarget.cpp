@@ -55,6 +55,15 @@ static llvm::cl::opt<unsigned> clNativeVectorWidthInBytes(
                    "overrides any inferred vector register width"),
     llvm::cl::init(0));
 
+static llvm::cl::list<int64_t> clDispatchConcurrencyVariants(
+    "iree-llvmcpu-dispatch-concurrency-variants",
+    llvm::cl::desc(
+        "comma separated list of worker counts to produce additional "
+        "executable variants for; each variant distributes workgroups for the "
+        "given worker count and is selected at load time on devices that "
+        "report at least that much dispatch concurrency"),
+    llvm::cl::CommaSeparated);
+
 // Default native vector width when target or specific native vector width are
 // not provided.
 constexpr unsigned defaultNativeVectorWidth = 16;
@@ -745,8 +754,31 @@ class LLVMCPUTargetBackend final : public TargetBackend {
  private:
   ArrayAttr getExecutableTargets(MLIRContext *context) const {
     SmallVector<Attribute> targetAttrs;
-    // This is where we would multiversion.
-    targetAttrs.push_back(getExecutableTarget(context));
+    auto baseTargetAttr = getExecutableTarget(context);
+
+    // Variants specialized for a worker count are ordered from the largest
+    // count to the smallest so that the first one matching at load time is the
+    // one tuned for the most concurrency the device can provide. The base
+    // target always comes last and acts as the fallback.
+    SmallVector<int64_t> concurrencies;
+    for (int64_t concurrency : clDispatchConcurrencyVariants) {
+      if (concurrency > 1) concurrencies.push_back(concurrency);
+    }
+    llvm::sort(concurrencies, std::greater<int64_t>());
+    concurrencies.erase(std::unique(concurrencies.begin(), concurrencies.end()),
+                        concurrencies.end());
+    for (int64_t concurrency : concurrencies) {
+      SmallVector<NamedAttribute> config(
+          baseTargetAttr.getConfiguration().getValue());
+      config.emplace_back(
+          StringAttr::get(context, "dispatch_concurrency"),
+          IntegerAttr::get(IntegerType::get(context, 64), concurrency));
+      targetAttrs.push_back(IREE::HAL::ExecutableTargetAttr::get(
+          context, baseTargetAttr.getBackend(), baseTargetAttr.getFormat(),
+          DictionaryAttr::get(context, config)));
+    }
+
+    targetAttrs.push_back(baseTargetAttr);
     return ArrayAttr::get(context, targetAttrs);
   }
 
@@ -82,3 +82,28 @@ func.func @no_results(%device : !hal.device) {
   // CHECK-NEXT:  return
   return
 }
+
+// -----
+
+// CHECK-LABEL: @dispatch_concurrency
+// CHECK-SAME: %[[DEVICE:.+]]: !hal.device
+func.func @dispatch_concurrency(%device : !hal.device) -> i32 {
+  // CHECK-DAG: %[[C0:.+]] = arith.constant 0 : i32
+  %c0 = arith.constant 0 : i32
+  // CHECK-DAG: %[[C1:.+]] = arith.constant 1 : i32
+  %c1 = arith.constant 1 : i32
+  // CHECK-DAG: %[[C16:.+]] = arith.constant 16 : i64
+  %0 = hal.device.switch<%device : !hal.device> -> i32
+    // CHECK: %{{.+}}, %[[CONCURRENCY:.+]] = hal.device.query<%[[DEVICE]] : !hal.device> key("hal.dispatch" :: "concurrency") : i1, i64 = 1 : i64
+    // CHECK-NEXT: %[[IS0:.+]] = arith.cmpi sge, %[[CONCURRENCY]], %[[C16]] : i64
+    // CHECK-NEXT: cf.cond_br %[[IS0]], ^bb1(%[[C1]] : i32), ^bb1(%[[C0]] : i32)
+    #hal.device.match.dispatch.concurrency<16> {
+      hal.return %c1 : i32
+    },
+    #hal.match.always {
+      hal.return %c0 : i32
+    }
+  // CHECK-NEXT: ^bb1(%[[RES:.+]]: i32):
+  // CHECK-NEXT: return %[[RES]] : i32
+  return %0 : i32
+}
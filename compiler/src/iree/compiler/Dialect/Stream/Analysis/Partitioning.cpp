@@ -7,6 +7,7 @@
 #include "iree/compiler/Dialect/Stream/Analysis/Partitioning.h"
 
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "mlir/IR/AsmState.h"
 #include "mlir/IR/PatternMatch.h"
@@ -18,6 +19,14 @@ namespace iree_compiler {
 namespace IREE {
 namespace Stream {
 
+// The cost model is opt-in until it has been evaluated on end-to-end models.
+static llvm::cl::opt<bool> clCostModelConcurrency(
+    "iree-stream-partitioning-cost-model",
+    llvm::cl::desc("Use the experimental cost model to schedule concurrency "
+                   "within execution regions instead of the reference "
+                   "algorithm."),
+    llvm::cl::init(false));
+
 #ifndef NDEBUG
 
 void dumpPartition(Partition &partition, AsmState &asmState) {
@@ -174,7 +183,9 @@ PartitionSet partitionStreamableOps(IREE::Stream::PartitioningConfigAttr config,
 
 PartitionSet partitionRegionConcurrency(
     IREE::Stream::PartitioningConfigAttr config, Block *block) {
-  // Only one algorithm today.
+  if (clCostModelConcurrency) {
+    return partitionRegionConcurrencyCostModel(config, block);
+  }
   return partitionRegionConcurrencyReference(config, block);
 }
 
@@ -125,6 +125,29 @@ PartitionSet partitionStreamableOpsReference(
 PartitionSet partitionRegionConcurrencyReference(
     IREE::Stream::PartitioningConfigAttr config, Block *block);
 
+//===----------------------------------------------------------------------===//
+// Cost-model partitioning
+//===----------------------------------------------------------------------===//
+
+// Schedules streamable ops into waves of concurrently executable work using
+// estimates of dispatch work and live resource memory to honor the configured
+// favor:
+// - Favor::MinPeakMemory assumes the block order minimizes live ranges and
+//   only forms waves from consecutive ops when doing so does not raise the
+//   peak live memory of executing the ops serially.
+// - Favor::MaxConcurrency places ops as early as possible while using any
+//   slack off of the critical path to overlap short ops with longer ones.
+//
+// Unlike partitionStreamableOpsReference ops preferring to be cloned to their
+// consumers (such as splats) are not cloned: all waves are within the same
+// execution region and later waves can use their results directly. They are
+// scheduled as cheap ops like any other.
+//
+// Experimental: only used by partitionRegionConcurrency when
+// --iree-stream-partitioning-cost-model is specified.
+PartitionSet partitionRegionConcurrencyCostModel(
+    IREE::Stream::PartitioningConfigAttr config, Block *block);
+
 }  // namespace Stream
 }  // namespace IREE
 }  // namespace iree_compiler
@@ -0,0 +1,422 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <algorithm>
+#include <limits>
+
+#include "iree/compiler/Dialect/Stream/Analysis/Partitioning.h"
+#include "iree/compiler/Dialect/Stream/Analysis/ResourceHazards.h"
+#include "iree/compiler/Dialect/Stream/IR/StreamOps.h"
+#include "iree/compiler/Dialect/Util/IR/UtilTypes.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/Debug.h"
+#include "mlir/IR/Matchers.h"
+
+#define DEBUG_TYPE "iree-stream-partitioning"
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace Stream {
+
+//===----------------------------------------------------------------------===//
+// Cost model
+//===----------------------------------------------------------------------===//
+
+// Byte size assumed for resources with dynamic sizes. Only relative sizes
+// matter to the scheduler and this biases dynamically sized resources to be
+// treated as large.
+static constexpr int64_t kDynamicResourceSizeEstimate = 64 * 1024 * 1024;
+
+// Workload assumed for each dynamic dispatch workload dimension.
+static constexpr int64_t kDynamicWorkloadEstimate = 1024;
+
+// Returns the estimated size in bytes of the resource |result| of |op|.
+static int64_t estimateResultSize(Operation *op, Value result) {
+  auto sizeAwareOp = dyn_cast<IREE::Util::SizeAwareOpInterface>(op);
+  if (!sizeAwareOp) return kDynamicResourceSizeEstimate;
+  APInt staticSize;
+  auto resultSize = sizeAwareOp.getResultSizeFromValue(result);
+  if (resultSize && matchPattern(resultSize, m_ConstantInt(&staticSize))) {
+    return staticSize.getSExtValue();
+  }
+  return kDynamicResourceSizeEstimate;
+}
+
+// Returns the estimated amount of work performed by |op| in arbitrary units.
+// Dispatches are modeled by their workload and all other ops (transfers,
+// fills, etc) are assumed to be bandwidth bound and cheap relative to them.
+static int64_t estimateWork(Operation *op) {
+  auto dispatchOp = dyn_cast<IREE::Stream::AsyncDispatchOp>(op);
+  if (!dispatchOp) return 1;
+  int64_t work = 1;
+  for (auto workload : dispatchOp.getWorkload()) {
+    APInt staticWorkload;
+    if (matchPattern(workload, m_ConstantInt(&staticWorkload))) {
+      work *= std::max<int64_t>(staticWorkload.getSExtValue(), 1);
+    } else {
+      work *= kDynamicWorkloadEstimate;
+    }
+  }
+  return work;
+}
+
+//===----------------------------------------------------------------------===//
+// Concurrency graph
+//===----------------------------------------------------------------------===//
+
+namespace {
+
+// Dependency graph of the schedulable ops in a block.
+// Nodes are streamable non-metadata ops in block order. Values flowing through
+// other ops (subviews, arithmetic, etc) conservatively serialize the producing
+// and consuming nodes.
+struct ConcurrencyGraph {
+  struct Edge {
+    // Node index of the other end of the edge.
+    unsigned node;
+    // Minimum number of waves between the two nodes: 0 if they may execute in
+    // the same wave and 1 if there is a hazard between them.
+    unsigned distance;
+  };
+  struct Node {
+    Operation *op;
+    SmallVector<Edge> preds;
+    SmallVector<Edge> succs;
+    // Estimated work of the op.
+    int64_t work = 0;
+    // Earliest and latest waves the node may be placed in without increasing
+    // the critical path.
+    unsigned asap = 0;
+    unsigned alap = 0;
+  };
+  SmallVector<Node> nodes;
+  DenseMap<Operation *, unsigned> nodeIndices;
+  // Number of waves along the critical path.
+  unsigned depth = 0;
+
+  // Returns the node index of |op| or -1 if it is not a node.
+  int lookupNode(Operation *op) const {
+    auto it = nodeIndices.find(op);
+    return it == nodeIndices.end() ? -1 : (int)it->second;
+  }
+};
+
+}  // namespace
+
+// Returns true if |op| is scheduled into a wave. Ops that prefer to be cloned
+// into their consumers (splats, etc) are scheduled like any other op: cloning
+// only avoids transfers across execution regions and within a region each
+// wave can directly use the results of any earlier wave.
+static bool isScheduledOp(Operation &op) {
+  auto streamableOp = dyn_cast<IREE::Stream::StreamableOpInterface>(op);
+  return streamableOp && !streamableOp.isMetadata();
+}
+
+// Builds the dependency graph for all schedulable ops in |block|.
+// Edges through non-node ops are found by tracking the set of nodes each
+// non-node op transitively depends on; these sets stay small in practice as
+// non-node ops are mostly subviews and arithmetic feeding directly into nodes.
+static ConcurrencyGraph buildConcurrencyGraph(
+    Block *block, IREE::Stream::ResourceHazardAnalysis &hazardAnalysis) {
+  ConcurrencyGraph graph;
+  for (auto &op : *block) {
+    if (!isScheduledOp(op)) continue;
+    graph.nodeIndices[&op] = graph.nodes.size();
+    ConcurrencyGraph::Node node;
+    node.op = &op;
+    node.work = estimateWork(&op);
+    graph.nodes.push_back(std::move(node));
+  }
+
+  // Nodes each non-node op depends on.
+  DenseMap<Operation *, SmallVector<unsigned>> passthroughDeps;
+  for (auto &op : *block) {
+    int nodeIndex = graph.lookupNode(&op);
+    // Minimum distance to each predecessor node.
+    llvm::SmallDenseMap<unsigned, unsigned> predDistances;
+    auto addPred = [&](unsigned predIndex, unsigned distance) {
+      auto it = predDistances.try_emplace(predIndex, distance);
+      if (!it.second) it.first->second = std::max(it.first->second, distance);
+    };
+    for (auto operand : op.getOperands()) {
+      auto *definingOp = operand.getDefiningOp();
+      if (!definingOp || definingOp->getBlock() != block) continue;
+      int predIndex = graph.lookupNode(definingOp);
+      if (predIndex != -1) {
+        unsigned distance =
+            nodeIndex == -1 || hazardAnalysis.hasHazard(definingOp, &op) ? 1
+                                                                         : 0;
+        addPred(predIndex, distance);
+      } else {
+        auto it = passthroughDeps.find(definingOp);
+        if (it == passthroughDeps.end()) continue;
+        for (auto predIndex : it->second) addPred(predIndex, 1);
+      }
+    }
+    if (nodeIndex == -1) {
+      if (predDistances.empty()) continue;
+      auto &deps = passthroughDeps[&op];
+      for (auto &predDistance : predDistances) {
+        deps.push_back(predDistance.first);
+      }
+      continue;
+    }
+    auto &node = graph.nodes[nodeIndex];
+    for (auto [predIndex, distance] : predDistances) {
+      node.preds.push_back({predIndex, distance});
+      graph.nodes[predIndex].succs.push_back({(unsigned)nodeIndex, distance});
+    }
+  }
+
+  // Nodes are in topological order so a forward and backward sweep computes
+  // the scheduling window of each node.
+  for (auto &node : graph.nodes) {
+    for (auto &pred : node.preds) {
+      node.asap =
+          std::max(node.asap, graph.nodes[pred.node].asap + pred.distance);
+    }
+    graph.depth = std::max(graph.depth, node.asap + 1);
+  }
+  for (auto &node : llvm::reverse(graph.nodes)) {
+    node.alap = graph.depth - 1;
+    for (auto &succ : node.succs) {
+      node.alap =
+          std::min(node.alap, graph.nodes[succ.node].alap - succ.distance);
+    }
+  }
+  return graph;
+}
+
+// Returns the earliest wave |node| may be placed in given the waves its
+// predecessors have been placed in.
+static unsigned getEarliestWave(const ConcurrencyGraph::Node &node,
+                                ArrayRef<unsigned> nodeWaves) {
+  unsigned wave = 0;
+  for (auto &pred : node.preds) {
+    wave = std::max(wave, nodeWaves[pred.node] + pred.distance);
+  }
+  return wave;
+}
+
+//===----------------------------------------------------------------------===//
+// Favor::MaxConcurrency
+//===----------------------------------------------------------------------===//
+
+// Places each node within its [asap, alap] window such that the critical path
+// is never lengthened. Nodes with slack are placed in the wave where they add
+// the least latency (the wave whose longest op is at least as much work),
+// preferring the earliest wave so that as much work as possible is in flight.
+static SmallVector<unsigned> scheduleMaxConcurrency(
+    const ConcurrencyGraph &graph) {
+  SmallVector<unsigned> nodeWaves(graph.nodes.size(), 0);
+  SmallVector<int64_t> waveWork(graph.depth, 0);
+  for (auto [nodeIndex, node] : llvm::enumerate(graph.nodes)) {
+    unsigned earliestWave = getEarliestWave(node, nodeWaves);
+    unsigned bestWave = earliestWave;
+    int64_t bestCost = std::numeric_limits<int64_t>::max();
+    for (unsigned wave = earliestWave; wave <= node.alap; ++wave) {
+      int64_t cost = std::max<int64_t>(node.work - waveWork[wave], 0);
+      if (cost < bestCost) {
+        bestWave = wave;
+        bestCost = cost;
+        if (cost == 0) break;
+      }
+    }
+    nodeWaves[nodeIndex] = bestWave;
+    waveWork[bestWave] = std::max(waveWork[bestWave], node.work);
+  }
+  return nodeWaves;
+}
+
+//===----------------------------------------------------------------------===//
+// Favor::MinPeakMemory
+//===----------------------------------------------------------------------===//
+
+// Computes the bytes that are live while each node executes if all nodes were
+// executed serially in block order (|outLiveBytes|) and the bytes newly
+// allocated by each node (|outAllocBytes|). Results tied to operands share the
+// allocation of the operand and allocations made by non-node ops (allocas)
+// are charged to the first node using them.
+static void computeSerialLiveness(Block *block, const ConcurrencyGraph &graph,
+                                  SmallVectorImpl<int64_t> &outLiveBytes,
+                                  SmallVectorImpl<int64_t> &outAllocBytes) {
+  const unsigned nodeCount = graph.nodes.size();
+  struct Allocation {
+    int64_t size = 0;
+    unsigned firstNode = std::numeric_limits<unsigned>::max();
+    unsigned lastNode = 0;
+  };
+  SmallVector<Allocation> allocations;
+  DenseMap<Value, unsigned> valueAllocations;
+  for (auto &op : *block) {
+    int nodeIndex = graph.lookupNode(&op);
+    for (auto operand : op.getOperands()) {
+      auto it = valueAllocations.find(operand);
+      if (it == valueAllocations.end()) continue;
+      auto &allocation = allocations[it->second];
+      if (nodeIndex != -1) {
+        allocation.firstNode =
+            std::min(allocation.firstNode, (unsigned)nodeIndex);
+        allocation.lastNode =
+            std::max(allocation.lastNode, (unsigned)nodeIndex);
+      } else if (op.hasTrait<OpTrait::IsTerminator>()) {
+        // Escapes the block and remains live until the end.
+        allocation.lastNode = nodeCount - 1;
+      }
+    }
+    auto tiedOp = dyn_cast<IREE::Util::TiedOpInterface>(op);
+    for (auto result : op.getResults()) {
+      if (!llvm::isa<IREE::Stream::ResourceType>(result.getType())) continue;
+      if (tiedOp) {
+        if (auto tiedOperand = tiedOp.getTiedResultOperand(result)) {
+          auto it = valueAllocations.find(tiedOperand);
+          if (it != valueAllocations.end()) {
+            valueAllocations[result] = it->second;
+          }
+          continue;
+        }
+      }
+      Allocation allocation;
+      allocation.size = estimateResultSize(&op, result);
+      if (nodeIndex != -1) {
+        allocation.firstNode = nodeIndex;
+        allocation.lastNode = nodeIndex;
+      }
+      valueAllocations[result] = allocations.size();
+      allocations.push_back(allocation);
+    }
+  }
+
+  SmallVector<int64_t> liveDeltas(nodeCount + 1, 0);
+  outAllocBytes.assign(nodeCount, 0);
+  for (auto &allocation : allocations) {
+    if (allocation.firstNode >= nodeCount) continue;  // never used by a node
+    unsigned lastNode = std::max(allocation.firstNode, allocation.lastNode);
+    liveDeltas[allocation.firstNode] += allocation.size;
+    liveDeltas[lastNode + 1] -= allocation.size;
+    outAllocBytes[allocation.firstNode] += allocation.size;
+  }
+  outLiveBytes.resize(nodeCount);
+  int64_t liveBytes = 0;
+  for (unsigned i = 0; i < nodeCount; ++i) {
+    liveBytes += liveDeltas[i];
+    outLiveBytes[i] = liveBytes;
+  }
+}
+
+// Assumes the block order was chosen to minimize live ranges and only merges
+// consecutive nodes into a wave when doing so keeps the bytes live during the
+// wave at or below the peak of the serial schedule.
+static SmallVector<unsigned> scheduleMinPeakMemory(
+    Block *block, const ConcurrencyGraph &graph) {
+  SmallVector<unsigned> nodeWaves(graph.nodes.size(), 0);
+  if (graph.nodes.empty()) return nodeWaves;
+
+  SmallVector<int64_t> liveBytes;
+  SmallVector<int64_t> allocBytes;
+  computeSerialLiveness(block, graph, liveBytes, allocBytes);
+  const int64_t serialPeakBytes =
+      *std::max_element(liveBytes.begin(), liveBytes.end());
+
+  unsigned currentWave = 0;
+  int64_t waveLiveBytes = liveBytes[0];
+  for (auto [nodeIndex, node] : llvm::enumerate(graph.nodes)) {
+    if (nodeIndex == 0) continue;
+    bool canMerge =
+        getEarliestWave(node, nodeWaves) <= currentWave &&
+        waveLiveBytes + allocBytes[nodeIndex] <= serialPeakBytes;
+    if (canMerge) {
+      waveLiveBytes += allocBytes[nodeIndex];
+    } else {
+      ++currentWave;
+      waveLiveBytes = liveBytes[nodeIndex];
+    }
+    nodeWaves[nodeIndex] = currentWave;
+  }
+  return nodeWaves;
+}
+
+//===----------------------------------------------------------------------===//
+// Cost-model partitioning
+//===----------------------------------------------------------------------===//
+
+PartitionSet partitionRegionConcurrencyCostModel(
+    IREE::Stream::PartitioningConfigAttr config, Block *block) {
+  PartitionSet waveSet;
+
+  auto favor = config.getFavor().getValue();
+  if (favor == IREE::Stream::Favor::Debug) {
+    // Disable partitioning when favoring debuggability.
+    return waveSet;
+  }
+
+  // Run analysis - if it fails then we'll just be conservative.
+  IREE::Stream::ResourceHazardAnalysis hazardAnalysis(block->getParentOp());
+  if (failed(hazardAnalysis.run())) {
+    LLVM_DEBUG(llvm::dbgs() << "WARNING: resource hazard analysis failed; "
+                               "conservatively scheduling\n");
+  }
+
+  auto graph = buildConcurrencyGraph(block, hazardAnalysis);
+  if (graph.nodes.empty()) return waveSet;
+  auto nodeWaves = favor == IREE::Stream::Favor::MaxConcurrency
+                       ? scheduleMaxConcurrency(graph)
+                       : scheduleMinPeakMemory(block, graph);
+
+  unsigned waveCount = 0;
+  for (auto wave : nodeWaves) waveCount = std::max(waveCount, wave + 1);
+  LLVM_DEBUG(llvm::dbgs() << "Scheduled " << graph.nodes.size()
+                          << " ops into " << waveCount
+                          << " waves (critical path " << graph.depth << ")\n");
+
+  // Ops in each wave are stored in reverse block order to match the reference
+  // partitioning.
+  SmallVector<SmallVector<Operation *>> waveOps(waveCount);
+  for (auto [nodeIndex, node] : llvm::enumerate(graph.nodes)) {
+    waveOps[nodeWaves[nodeIndex]].push_back(node.op);
+  }
+  auto getOpWave = [&](Operation *op) -> int {
+    auto *ancestorOp = block->findAncestorOpInBlock(*op);
+    if (!ancestorOp) return -1;
+    int nodeIndex = graph.lookupNode(ancestorOp);
+    return nodeIndex == -1 ? -1 : (int)nodeWaves[nodeIndex];
+  };
+
+  // Emit waves in forward order; empty waves are possible when nodes were
+  // moved out of them to balance work.
+  for (auto [waveIndex, ops] : llvm::enumerate(waveOps)) {
+    if (ops.empty()) continue;
+    Partition wave;
+    SetVector<Value> consumedValues;
+    SetVector<Value> producedValues;
+    for (auto *op : ops) {
+      for (auto operand : op->getOperands()) {
+        consumedValues.insert(operand);
+      }
+      for (auto result : op->getResults()) {
+        producedValues.insert(result);
+        for (auto *user : result.getUsers()) {
+          if (getOpWave(user) != (int)waveIndex) {
+            wave.outs.insert(result);
+            break;
+          }
+        }
+      }
+    }
+    consumedValues.set_subtract(producedValues);
+    wave.ins = std::move(consumedValues);
+    for (auto *op : llvm::reverse(ops)) wave.ops.insert(op);
+    waveSet.partitions.push_back(std::move(wave));
+  }
+
+  return waveSet;
+}
+
+}  // namespace Stream
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
@@ -7,6 +7,7 @@
 #include "iree/compiler/Dialect/Stream/Analysis/Partitioning.h"
 #include "iree/compiler/Dialect/Stream/Analysis/ResourceHazards.h"
 #include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/Support/Debug.h"
@@ -65,6 +66,25 @@ PartitionSet partitionStreamableOpsReference(
   SmallVector<std::unique_ptr<PartitionBuilder>> builders;
   llvm::BitVector usableBuilders;
 
+  // Partitions grouped by their current affinity. Programs use a handful of
+  // affinities so pruning candidates by affinity is done with a few word-wise
+  // bit operations per op instead of testing every partition.
+  llvm::MapVector<Attribute, llvm::BitVector> affinityBuilders;
+  auto addAffinityBuilder = [&](PartitionBuilder &builder) {
+    auto &ordinals = affinityBuilders[builder.affinity];
+    if (ordinals.size() <= builder.ordinal) {
+      ordinals.resize(builder.ordinal + 1);
+    }
+    ordinals.set(builder.ordinal);
+  };
+  auto insertIntoBuilder = [&](PartitionBuilder &builder, Operation *op) {
+    auto oldAffinity = builder.affinity;
+    builder.insert(op);
+    if (builder.affinity == oldAffinity) return;
+    affinityBuilders[oldAffinity].reset(builder.ordinal);
+    addAffinityBuilder(builder);
+  };
+
   struct OpInfo {
     // Which partitions the op is contained within.
     llvm::BitVector membership;
@@ -149,13 +169,21 @@ PartitionSet partitionStreamableOpsReference(
     candidates &= usableBuilders;
 
     // Prune candidates that do not have a compatible affinity.
-    for (auto ordinal : candidates.set_bits()) {
-      if (!IREE::Stream::AffinityAttr::canExecuteTogether(
-              affinityAttr, builders[ordinal]->affinity)) {
-        LLVM_DEBUG(llvm::dbgs()
-                   << "Candidate partition " << ordinal << " incompatible\n");
-        candidates.reset(ordinal);
+    for (auto &[builderAffinity, ordinals] : affinityBuilders) {
+      if (IREE::Stream::AffinityAttr::canExecuteTogether(
+              affinityAttr, llvm::cast_if_present<IREE::Stream::AffinityAttr>(
+                                builderAffinity))) {
+        continue;
       }
+      LLVM_DEBUG({
+        llvm::BitVector incompatible = candidates;
+        incompatible &= ordinals;
+        for (auto ordinal : incompatible.set_bits()) {
+          llvm::dbgs() << "Candidate partition " << ordinal
+                       << " incompatible\n";
+        }
+      });
+      candidates.reset(ordinals);
     }
 
     // If this op is not streamable then bail here; we've still setup the hazard
@@ -182,7 +210,7 @@ PartitionSet partitionStreamableOpsReference(
           LLVM_DEBUG(llvm::dbgs() << "Cloning into consumer partition "
                                   << consumerOrdinal << "\n");
           auto &consumerBuilder = builders[consumerOrdinal];
-          consumerBuilder->insert(&op);
+          insertIntoBuilder(*consumerBuilder, &op);
           consumerBuilder->clonedOps.insert(&op);
           opInfo.membership.set(consumerOrdinal);
           opInfo.hazards.reset(consumerOrdinal);
@@ -192,7 +220,7 @@ PartitionSet partitionStreamableOpsReference(
         LLVM_DEBUG(llvm::dbgs() << "Moving into consumer partition "
                                 << consumerOrdinal << "\n");
         auto &consumerBuilder = builders[consumerOrdinal];
-        consumerBuilder->insert(&op);
+        insertIntoBuilder(*consumerBuilder, &op);
         opInfo.membership.set(consumerOrdinal);
         opInfo.hazards.reset(consumerOrdinal);
       }
@@ -205,7 +233,7 @@ PartitionSet partitionStreamableOpsReference(
     if (firstCandidateOrdinal != -1) {
       LLVM_DEBUG(llvm::dbgs() << "Moving to first candidate partition "
                               << firstCandidateOrdinal << " (continue)\n");
-      builders[firstCandidateOrdinal]->insert(&op);
+      insertIntoBuilder(*builders[firstCandidateOrdinal], &op);
       opInfo.membership.set(firstCandidateOrdinal);
       opInfo.hazards.reset(firstCandidateOrdinal);
       continue;
@@ -222,6 +250,7 @@ PartitionSet partitionStreamableOpsReference(
     builder->ordinal = builders.size();
     builder->affinity = affinityAttr;
     builder->insert(&op);
+    addAffinityBuilder(*builder);
     LLVM_DEBUG(llvm::dbgs()
                << "Created partition " << builder->ordinal << "\n");
     builders.push_back(std::move(builder));
@@ -264,10 +293,12 @@ PartitionSet partitionStreamableOpsReference(
             }
           }
         } else {
-          // TODO(benvanik): optimize this - creates n^2/nlogn behavior.
+          // Membership tests are hash lookups so this is linear in the number
+          // of uses; we stop at the first user outside of the partition.
           for (auto user : result.getUsers()) {
             if (!builder->ops.contains(user)) {
               escapingValues.insert(result);
+              break;
             }
           }
         }
@@ -310,10 +341,13 @@ PartitionSet partitionRegionConcurrencyReference(
   SmallVector<std::unique_ptr<PartitionBuilder>> builders;
 
   struct OpInfo {
-    // Which waves the op is contained within.
-    llvm::BitVector membership;
-    // Which waves transitively depend on this operation.
-    llvm::BitVector hazards;
+    // Which wave the op is contained within or -1 if not in any.
+    int membership = -1;
+    // Waves [0, hazardLimit) transitively depend on this operation. An op
+    // joining a wave always has hazards with all waves before it and hazards
+    // are only inherited from users so the set is always a prefix of the waves
+    // and tracking its bound is enough.
+    int hazardLimit = 0;
   };
   DenseMap<Operation *, OpInfo> opInfos;
 
@@ -341,11 +375,8 @@ PartitionSet partitionRegionConcurrencyReference(
     // Initialize op info for this op - whether streamable or not. We track
     // transitive hazards on each op. Note that thanks to the ordering of ops
     // in SSA form (_reversed here!_) we know that once we visit this op no
-    // wave created after it can ever depend on it if it doesn't here. This
-    // lets us keep the bitvectors small.
+    // wave created after it can ever depend on it if it doesn't here.
     auto &opInfo = opInfos[&op];
-    opInfo.hazards.reserve(builders.size() + 1);
-    opInfo.hazards.resize(builders.size(), /*t=*/false);
 
     LLVM_DEBUG({
       llvm::dbgs() << "====\nPartitioning op:\n";
@@ -353,7 +384,7 @@ PartitionSet partitionRegionConcurrencyReference(
       llvm::dbgs() << "\n";
     });
 
-    // Set bits for each wave this op may be able to be placed into.
+    // Compute the waves this op may be able to be placed into.
     // We prune the set based on whether the users are part of a transitive
     // dependency chain down the use-def chain to a wave.
     for (auto user : op.getUsers()) {
@@ -364,26 +395,29 @@ PartitionSet partitionRegionConcurrencyReference(
         llvm::dbgs() << "Testing user:\n";
         user->print(llvm::dbgs(), *asmState);
         llvm::dbgs() << "\n";
-        for (auto membershipOrdinal : userInfo.membership.set_bits()) {
-          llvm::dbgs() << "  member of wave " << membershipOrdinal << "\n";
+        if (userInfo.membership != -1) {
+          llvm::dbgs() << "  member of wave " << userInfo.membership << "\n";
         }
-        int lastHazardOrdinal = userInfo.hazards.find_last();
-        if (lastHazardOrdinal != -1) {
-          llvm::dbgs() << "  hazard w/ waves 0-" << lastHazardOrdinal << "\n";
+        if (userInfo.hazardLimit > 0) {
+          llvm::dbgs() << "  hazard w/ waves 0-" << userInfo.hazardLimit - 1
+                       << "\n";
         }
       });
       bool hazardPresent = hazardAnalysis.hasHazard(streamableOp, user);
       if (hazardPresent) {
         // Hazard with existing op usage - prevent concurrent scheduling.
-        opInfo.hazards |= userInfo.membership;
+        // The user has hazards with all waves before its own so this extends
+        // the prefix through the user wave.
+        opInfo.hazardLimit =
+            std::max(opInfo.hazardLimit, userInfo.membership + 1);
       } else {
         LLVM_DEBUG(llvm::dbgs() << "  $ hazard analysis says ok to schedule\n");
       }
       // Always inherit hazards whether merging or not.
-      opInfo.hazards |= userInfo.hazards;
+      opInfo.hazardLimit = std::max(opInfo.hazardLimit, userInfo.hazardLimit);
     }
-    llvm::BitVector candidates(builders.size(), /*t=*/true);
-    candidates ^= opInfo.hazards;
+    // Candidates are all waves at or after the hazard limit.
+    int waveCount = static_cast<int>(builders.size());
 
     // If this op is not streamable then bail here; we've still setup the hazard
     // map for following iteration.
@@ -392,28 +426,23 @@ PartitionSet partitionRegionConcurrencyReference(
       continue;
     }
 
-    opInfo.membership.reserve(builders.size() + 1);
-    opInfo.membership.resize(builders.size(), /*t=*/false);
-
     // No consumers - if there's any candidate then we'll go into that.
-    int firstCandidateOrdinal = favor == IREE::Stream::Favor::MaxConcurrency
-                                    ? candidates.find_first()
-                                    : candidates.find_last();
-    if (firstCandidateOrdinal != -1) {
+    if (opInfo.hazardLimit < waveCount) {
+      int firstCandidateOrdinal = favor == IREE::Stream::Favor::MaxConcurrency
+                                      ? opInfo.hazardLimit
+                                      : waveCount - 1;
       LLVM_DEBUG(llvm::dbgs() << "Moving to last candidate wave "
                               << firstCandidateOrdinal << " (continue)\n");
       builders[firstCandidateOrdinal]->ops.insert(&op);
-      opInfo.membership.set(firstCandidateOrdinal);
-      opInfo.hazards.set(0, firstCandidateOrdinal);
-      opInfo.hazards.reset(firstCandidateOrdinal);
+      opInfo.membership = firstCandidateOrdinal;
+      opInfo.hazardLimit = firstCandidateOrdinal;
       continue;
     }
 
-    // Mark the op as having hazards against all other waves.
-    opInfo.hazards.set(0, builders.size());
-
-    // Create a new wave just for this op.
-    opInfo.membership.resize(opInfo.membership.size() + 1, /*t=*/true);
+    // Mark the op as having hazards against all other waves and create a new
+    // wave just for this op.
+    opInfo.hazardLimit = waveCount;
+    opInfo.membership = waveCount;
     auto builder = std::make_unique<PartitionBuilder>();
     builder->ordinal = builders.size();
     builder->ops.insert(&op);
@@ -435,10 +464,10 @@ PartitionSet partitionRegionConcurrencyReference(
       }
       for (auto result : op->getResults()) {
         producedValues.insert(result);
-        // TODO(benvanik): optimize this - creates n^2/nlogn behavior.
         for (auto user : result.getUsers()) {
           if (!builder->ops.contains(user)) {
             escapingValues.insert(result);
+            break;
           }
         }
       }
@@ -14,6 +14,7 @@
 #include "iree/compiler/Dialect/Util/IR/UtilOps.h"
 #include "iree/compiler/Dialect/Util/IR/UtilTypes.h"
 #include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/Support/Debug.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/IR/Attributes.h"
@@ -124,10 +125,6 @@ struct WavePartitionBuilder {
 
   // Visits a block operation and clones it into the partition, if desired.
   //
-  // Slightly suboptimal to be calling this on each op for each partition,
-  // however we only walk the block once and constructing a multimap would be
-  // way worse.
-  //
   // Returns true if the operation was cloned into the partition.
   bool visit(Operation *op) {
     if (!partition->ops.contains(op)) return false;
@@ -215,6 +212,15 @@ class ScheduleConcurrencyPass
                                                        mapping, &getContext()));
     }
 
+    // Map each op to the builders of the waves containing it (in wave order)
+    // so that we don't have to probe every wave for every op.
+    DenseMap<Operation *, SmallVector<WavePartitionBuilder *, 1>> opBuilders;
+    for (auto &partitionBuilder : partitionBuilders) {
+      for (auto *op : partitionBuilder.partition->ops) {
+        opBuilders[op].push_back(&partitionBuilder);
+      }
+    }
+
     // Walk over each op in the original block and find those that need to be
     // partitioned. Each partition builder may clone the op into itself. The
     // op will always be left in the original block and we'll rely on DCE to
@@ -223,9 +229,11 @@ class ScheduleConcurrencyPass
     SetVector<Operation *> deadOps;
     for (auto &op : *block) {
       if (op.hasTrait<OpTrait::IsTerminator>()) continue;
+      auto it = opBuilders.find(&op);
+      if (it == opBuilders.end()) continue;
       bool handled = false;
-      for (auto &partitionBuilder : partitionBuilders) {
-        handled = partitionBuilder.visit(&op) || handled;
+      for (auto *partitionBuilder : it->second) {
+        handled = partitionBuilder->visit(&op) || handled;
       }
       if (handled) {
         deadOps.insert(&op);
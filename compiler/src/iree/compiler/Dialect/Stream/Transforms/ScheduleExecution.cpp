@@ -13,6 +13,7 @@
 #include "iree/compiler/Dialect/Util/IR/UtilDialect.h"
 #include "iree/compiler/Dialect/Util/IR/UtilOps.h"
 #include "iree/compiler/Dialect/Util/IR/UtilTypes.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/EquivalenceClasses.h"
 #include "llvm/Support/Debug.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"
@@ -126,10 +127,6 @@ struct ExecutePartitionBuilder {
 
   // Visits a block operation and clones it into the partition, if desired.
   //
-  // Slightly suboptimal to be calling this on each op for each partition,
-  // however we only walk the block once and constructing a multimap would be
-  // way worse.
-  //
   // Returns true if the operation was cloned into the partition.
   bool visit(Operation *op) {
     if (!partition->ops.contains(op)) return false;
@@ -255,6 +252,17 @@ class ScheduleExecutionPass
             block, partition.index(), &partition.value(), mapping, context));
       }
 
+      // Map each op to the builders of the partitions containing it (in
+      // partition order). Probing every partition for every op is
+      // O(ops*partitions) and dominates compile time on large programs.
+      DenseMap<Operation *, SmallVector<ExecutePartitionBuilder *, 1>>
+          opBuilders;
+      for (auto &partitionBuilder : partitionBuilders) {
+        for (auto *op : partitionBuilder.partition->ops) {
+          opBuilders[op].push_back(&partitionBuilder);
+        }
+      }
+
       // Walk over each op in the original block and find those that need to be
       // partitioned. Each partition builder may clone the op into itself. The
       // op will always be left in the original block and we'll rely on DCE to
@@ -263,8 +271,11 @@ class ScheduleExecutionPass
       SetVector<Operation *> deadOps;
       for (auto &op : *block) {
         if (op.hasTrait<OpTrait::IsTerminator>()) continue;
-        for (auto &partitionBuilder : partitionBuilders) {
-          partitionBuilder.visit(&op);
+        auto it = opBuilders.find(&op);
+        if (it != opBuilders.end()) {
+          for (auto *partitionBuilder : it->second) {
+            partitionBuilder->visit(&op);
+          }
         }
         if (isa<IREE::Stream::StreamableOpInterface>(op)) {
           deadOps.insert(&op);
@@ -296,11 +307,12 @@ class ScheduleExecutionPass
           oldResult.replaceAllUsesWith(awaitOp.getResults().front());
           deadOps.insert(oldResult.getDefiningOp());
         }
-
-        // Sort the ops in the execution region. This is safe because we are
-        // still unaliased and SSA values imply ordering.
-        mlir::sortTopologically(block);
       }
+
+      // Sort the ops in the execution region once all partitions have been
+      // formed. This is safe because we are still unaliased and SSA values
+      // imply ordering.
+      mlir::sortTopologically(block);
       for (auto *deadOp : llvm::reverse(deadOps)) {
         deadOp->erase();
       }
@@ -0,0 +1,102 @@
+// RUN: iree-opt --split-input-file --iree-stream-partitioning-cost-model --pass-pipeline="builtin.module(func.func(iree-stream-schedule-concurrency))" %s | FileCheck %s
+
+// Tests that when favor=min-peak-memory independent work is not hoisted into
+// a concurrency region if the allocations it would keep live together exceed
+// the peak memory of executing the ops in their original order.
+
+// CHECK-LABEL: @partitioningForMinPeakMemoryNoOverlap
+func.func @partitioningForMinPeakMemoryNoOverlap(%arg0: !stream.resource<external>) -> !stream.resource<external>
+    attributes {stream.partitioning = #stream.partitioning_config<"min-peak-memory">} {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c20 = arith.constant 20 : index
+  %c1280 = arith.constant 1280 : index
+  %c255_i32 = arith.constant 255 : i32
+  // CHECK: stream.async.execute
+  %results, %result_timepoint = stream.async.execute
+      with(%arg0 as %arg1: !stream.resource<external>{%c20})
+      -> !stream.resource<external>{%c20} {
+    // CHECK-NOT: stream.async.concurrent
+    %0 = stream.async.splat %c255_i32 : i32 -> !stream.resource<transient>{%c1280}
+    %1 = stream.async.dispatch @ex::@dispatch_0[%c1, %c1, %c1](%0[%c0 to %c1280 for %c1280]) : (!stream.resource<transient>{%c1280}) -> !stream.resource<transient>{%c20}
+    %2 = stream.async.splat %c255_i32 : i32 -> !stream.resource<transient>{%c1280}
+    %3 = stream.async.dispatch @ex::@dispatch_1[%c1, %c1, %c1](%2[%c0 to %c1280 for %c1280]) : (!stream.resource<transient>{%c1280}) -> !stream.resource<transient>{%c20}
+    %4 = stream.async.dispatch @ex::@dispatch_2[%c1, %c1, %c1](%1[%c0 to %c20 for %c20], %3[%c0 to %c20 for %c20]) : (!stream.resource<transient>{%c20}, !stream.resource<transient>{%c20}) -> !stream.resource<external>{%c20}
+    // CHECK: stream.yield
+    stream.yield %4 : !stream.resource<external>{%c20}
+  } => !stream.timepoint
+  %5 = stream.timepoint.await %result_timepoint => %results : !stream.resource<external>{%c20}
+  return %5 : !stream.resource<external>
+}
+
+// -----
+
+// Tests that when favor=max-concurrency the same program as above runs both
+// independent chains concurrently at the cost of keeping both splats live.
+
+// CHECK-LABEL: @partitioningForMaxConcurrencyOverlap
+func.func @partitioningForMaxConcurrencyOverlap(%arg0: !stream.resource<external>) -> !stream.resource<external>
+    attributes {stream.partitioning = #stream.partitioning_config<"max-concurrency">} {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c20 = arith.constant 20 : index
+  %c1280 = arith.constant 1280 : index
+  %c255_i32 = arith.constant 255 : i32
+  // CHECK: stream.async.execute
+  %results, %result_timepoint = stream.async.execute
+      with(%arg0 as %arg1: !stream.resource<external>{%c20})
+      -> !stream.resource<external>{%c20} {
+    // CHECK: stream.async.concurrent
+    // CHECK-NEXT: stream.async.splat
+    // CHECK-NEXT: stream.async.splat
+    // CHECK-NEXT: stream.yield
+    // CHECK: stream.async.concurrent
+    // CHECK-NEXT: stream.async.dispatch @ex::@dispatch_0
+    // CHECK-NEXT: stream.async.dispatch @ex::@dispatch_1
+    // CHECK-NEXT: stream.yield
+    // CHECK: stream.async.dispatch @ex::@dispatch_2
+    %0 = stream.async.splat %c255_i32 : i32 -> !stream.resource<transient>{%c1280}
+    %1 = stream.async.dispatch @ex::@dispatch_0[%c1, %c1, %c1](%0[%c0 to %c1280 for %c1280]) : (!stream.resource<transient>{%c1280}) -> !stream.resource<transient>{%c20}
+    %2 = stream.async.splat %c255_i32 : i32 -> !stream.resource<transient>{%c1280}
+    %3 = stream.async.dispatch @ex::@dispatch_1[%c1, %c1, %c1](%2[%c0 to %c1280 for %c1280]) : (!stream.resource<transient>{%c1280}) -> !stream.resource<transient>{%c20}
+    %4 = stream.async.dispatch @ex::@dispatch_2[%c1, %c1, %c1](%1[%c0 to %c20 for %c20], %3[%c0 to %c20 for %c20]) : (!stream.resource<transient>{%c20}, !stream.resource<transient>{%c20}) -> !stream.resource<external>{%c20}
+    stream.yield %4 : !stream.resource<external>{%c20}
+  } => !stream.timepoint
+  %5 = stream.timepoint.await %result_timepoint => %results : !stream.resource<external>{%c20}
+  return %5 : !stream.resource<external>
+}
+
+// -----
+
+// Tests that when favor=max-concurrency work off of the critical path is
+// overlapped with the largest dispatch it can run alongside instead of the
+// earliest wave it is ready in.
+
+// CHECK-LABEL: @partitioningForMaxConcurrencyBalance
+func.func @partitioningForMaxConcurrencyBalance(%arg0: !stream.resource<external>) -> !stream.resource<external>
+    attributes {stream.partitioning = #stream.partitioning_config<"max-concurrency">} {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c8 = arith.constant 8 : index
+  %c20 = arith.constant 20 : index
+  %c64 = arith.constant 64 : index
+  // CHECK: stream.async.execute
+  %results, %result_timepoint = stream.async.execute
+      with(%arg0 as %arg1: !stream.resource<external>{%c20})
+      -> !stream.resource<external>{%c20} {
+    // CHECK: stream.async.dispatch @ex::@dispatch_0
+    // CHECK: stream.async.concurrent
+    // CHECK-NEXT: stream.async.dispatch @ex::@dispatch_1
+    // CHECK-NEXT: stream.async.dispatch @ex::@dispatch_2
+    // CHECK-NEXT: stream.yield
+    // CHECK: stream.async.dispatch @ex::@dispatch_3
+    %0 = stream.async.dispatch @ex::@dispatch_0[%c1, %c1, %c1](%arg1[%c0 to %c20 for %c20]) : (!stream.resource<external>{%c20}) -> !stream.resource<transient>{%c20}
+    %1 = stream.async.dispatch @ex::@dispatch_1[%c64, %c64, %c1](%0[%c0 to %c20 for %c20]) : (!stream.resource<transient>{%c20}) -> !stream.resource<transient>{%c20}
+    %2 = stream.async.dispatch @ex::@dispatch_2[%c8, %c8, %c1](%arg1[%c0 to %c20 for %c20]) : (!stream.resource<external>{%c20}) -> !stream.resource<transient>{%c20}
+    %3 = stream.async.dispatch @ex::@dispatch_3[%c1, %c1, %c1](%1[%c0 to %c20 for %c20], %2[%c0 to %c20 for %c20]) : (!stream.resource<transient>{%c20}, !stream.resource<transient>{%c20}) -> !stream.resource<external>{%c20}
+    stream.yield %3 : !stream.resource<external>{%c20}
+  } => !stream.timepoint
+  %4 = stream.timepoint.await %result_timepoint => %results : !stream.resource<external>{%c20}
+  return %4 : !stream.resource<external>
+}
+
@@ -7,6 +7,7 @@
 #include "iree/compiler/Dialect/Util/Analysis/Constant/OpOracle.h"
 
 #include "iree/compiler/Dialect/Util/IR/UtilDialect.h"
+#include "iree/compiler/Dialect/Util/IR/UtilOps.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "mlir/Dialect/Linalg/IR/Linalg.h"
 #include "mlir/Dialect/Tensor/IR/Tensor.h"
@@ -138,6 +139,13 @@ bool isHoistableConstExprLeaf(const ConstExprAnalysis::ConstValueInfo *info) {
     }
   }
 
+  // Never hoist ops that only widen narrowed values (such as dequantizing
+  // weights stored as i8 or f16): hoisting them would materialize the wide
+  // values in memory and undo the narrowing.
+  if (hasWideningOpAttr(op)) {
+    return false;
+  }
+
   // Never hoist empty. These are sometimes used for pure shape metadata
   // and must not be separated from their consumers.
   if (isa<tensor::EmptyOp>(op)) {
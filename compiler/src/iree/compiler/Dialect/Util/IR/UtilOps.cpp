@@ -41,6 +41,16 @@ Value findValueSizeInList(unsigned index, ValueRange values, ValueRange sizes) {
   return sizes[sizeIndex];
 }
 
+static constexpr StringLiteral kWideningOpAttrName = "util.widening";
+
+void setWideningOpAttr(Operation *op) {
+  op->setAttr(kWideningOpAttrName, UnitAttr::get(op->getContext()));
+}
+
+bool hasWideningOpAttr(Operation *op) {
+  return op->hasAttrOfType<UnitAttr>(kWideningOpAttrName);
+}
+
 //===----------------------------------------------------------------------===//
 // custom<SymbolVisibility>($sym_visibility)
 //===----------------------------------------------------------------------===//
@@ -37,6 +37,15 @@ namespace iree_compiler {
 // Returns the dynamic size of the value at |index|.
 Value findValueSizeInList(unsigned index, ValueRange values, ValueRange sizes);
 
+// Marks |op| as only widening narrowed values back to their original type,
+// such as the dequantization of weights stored as i8 or f16. Marked ops are
+// cheap to recompute and are cloned into their consumers instead of being
+// hoisted or dispatched on their own.
+void setWideningOpAttr(Operation *op);
+
+// Returns true if |op| was marked with setWideningOpAttr.
+bool hasWideningOpAttr(Operation *op);
+
 //===----------------------------------------------------------------------===//
 // custom<SymbolVisibility>($sym_visibility)
 //===----------------------------------------------------------------------===//
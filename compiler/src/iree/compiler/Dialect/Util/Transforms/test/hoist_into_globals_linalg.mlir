@@ -57,3 +57,49 @@ module @broadcast_treated_as_leaf {
   }
   // CHECK-NOT: util.initializer
 }
+
+// -----
+// Verifies that ops marked as widening narrowed values (such as dequantizing
+// weights) are never materialized as a leaf so that the narrow values are what
+// is stored.
+// CHECK-LABEL: @widening_not_hoisted
+#map0 = affine_map<(d0, d1) -> (d0, d1)>
+#map1 = affine_map<(d0, d1) -> (d1)>
+module @widening_not_hoisted {
+  // CHECK-NOT: util.global
+  // CHECK: func.func @main
+  func.func @main() -> (tensor<5x6xf32>) {
+    %cst_0 = arith.constant dense<[[1, 2, 3, 4, 5, 6], [1, 2, 3, 4, 5, 6], [1, 2, 3, 4, 5, 6], [1, 2, 3, 4, 5, 6], [1, 2, 3, 4, 5, 6]]> : tensor<5x6xi8>
+    %cst_1 = arith.constant dense<[1.0, 2.0, 3.0, 4.0, 5.0, 6.0]> : tensor<6xf32>
+    %0 = tensor.empty() : tensor<5x6xf32>
+    // CHECK: linalg.generic
+    %1 = linalg.generic {indexing_maps = [#map0, #map1, #map0], iterator_types = ["parallel", "parallel"], util.widening} ins(%cst_0, %cst_1 : tensor<5x6xi8>, tensor<6xf32>) outs(%0 : tensor<5x6xf32>) {
+    ^bb0(%arg1: i8, %arg2: f32, %arg3: f32):  // no predecessors
+      %2 = arith.sitofp %arg1 : i8 to f32
+      %3 = arith.mulf %2, %arg2 : f32
+      linalg.yield %3 : f32
+    } -> tensor<5x6xf32>
+    // CHECK: return
+    return %1 : tensor<5x6xf32>
+  }
+  // CHECK-NOT: util.initializer
+}
+
+// -----
+// Verifies that setting the encoding of a constant operand of a data-tiled op
+// is hoisted so that the weights are packed once at initialization.
+// CHECK-LABEL: @set_encoding_hoisted
+module @set_encoding_hoisted {
+  // CHECK: util.global private @[[HOISTED:.*]] : tensor<4x4xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RHS>>
+  // CHECK: func.func @main
+  func.func @main(%arg0: tensor<4x4xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_LHS>>, %arg1: tensor<4x4xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RESULT>>) -> tensor<4x4xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RESULT>> {
+    %cst = arith.constant dense<[[1.0, 2.0, 3.0, 4.0], [1.0, 2.0, 3.0, 4.0], [1.0, 2.0, 3.0, 4.0], [1.0, 2.0, 3.0, 4.0]]> : tensor<4x4xf32>
+    // CHECK: %[[RHS:.*]] = util.global.load @[[HOISTED]]
+    %0 = iree_linalg_ext.set_encoding %cst : tensor<4x4xf32> -> tensor<4x4xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RHS>>
+    // CHECK: linalg.matmul ins(%{{.*}}, %[[RHS]] :
+    %1 = linalg.matmul ins(%arg0, %0 : tensor<4x4xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_LHS>>, tensor<4x4xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RHS>>) outs(%arg1 : tensor<4x4xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RESULT>>) -> tensor<4x4xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RESULT>>
+    return %1 : tensor<4x4xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RESULT>>
+  }
+  // CHECK: util.initializer
+  // CHECK:   iree_linalg_ext.set_encoding
+}
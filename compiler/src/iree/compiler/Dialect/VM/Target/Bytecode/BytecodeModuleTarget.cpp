@@ -18,16 +18,22 @@
 #include "iree/compiler/Dialect/VM/IR/VMOps.h"
 #include "iree/compiler/Dialect/VM/Target/Bytecode/ArchiveWriter.h"
 #include "iree/compiler/Dialect/VM/Target/Bytecode/BytecodeEncoder.h"
+#include "iree/compiler/Dialect/VM/Target/Bytecode/LZ4Compression.h"
 #include "iree/compiler/Dialect/VM/Transforms/Passes.h"
 #include "iree/compiler/Dialect/VM/Utils/CallingConvention.h"
 #include "iree/compiler/Dialect/VM/Utils/TypeTable.h"
 #include "iree/compiler/Utils/FlatbufferUtils.h"
 #include "iree/compiler/Utils/TracingUtils.h"
 #include "iree/schemas/bytecode_module_def_builder.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/Support/CRC.h"
 #include "llvm/Support/Endian.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/SHA256.h"
 #include "mlir/IR/Attributes.h"
 #include "mlir/IR/BuiltinOps.h"
 #include "mlir/IR/Diagnostics.h"
@@ -62,6 +68,11 @@ static constexpr int kDefaultRodataAlignment = 16;
 // data at the risk of tripping the 31-bit FlatBuffer offset values.
 static constexpr int kMaxEmbeddedDataSize = 4 * 1024;
 
+// Length of each independently decompressible chunk of compressed rodata.
+// Smaller chunks expose more parallelism when loading at a slight cost to the
+// compression ratio.
+static constexpr uint64_t kCompressionChunkLength = 1 * 1024 * 1024;
+
 // A rodata reference.
 // The archive file is empty if the data is to be embedded in the FlatBuffer.
 struct RodataRef {
@@ -73,10 +84,120 @@ struct RodataRef {
   uint64_t totalSize = 0;
   // Optional reference to the rodata in the file.
   std::optional<ArchiveWriter::File> archiveFile;
+  // Key of the parameter the rodata was written to, if externalized.
+  std::string parameterKey;
+  // Compressed contents of the rodata stored in |archiveFile|, if compressed.
+  std::shared_ptr<LZ4ChunkedData> compressedData;
+};
+
+// A stream that hashes all data written to it with SHA-256.
+class SHA256Stream : public llvm::raw_ostream {
+ public:
+  SHA256Stream() = default;
+  ~SHA256Stream() override { flush(); }
+
+  // Returns the lowercase hex digest of all data written.
+  std::string hexDigest() {
+    flush();
+    return llvm::toHex(hasher.final(), /*LowerCase=*/true);
+  }
+
+ private:
+  void write_impl(const char *ptr, size_t size) override {
+    hasher.update(
+        ArrayRef<uint8_t>(reinterpret_cast<const uint8_t *>(ptr), size));
+    position += size;
+  }
+  uint64_t current_pos() const override { return position; }
+
+  llvm::SHA256 hasher;
+  uint64_t position = 0;
 };
 
 }  // namespace
 
+// Writes the contents of |rodataOp| into a content-addressed file in
+// |parameterDir| and returns the key it can be resolved with at runtime.
+// Files that already exist are assumed to have the same contents and are not
+// rewritten. Files are written to a temporary path and renamed into place so
+// that concurrent compilations sharing a directory never observe partial data.
+static FailureOr<std::string> writeParameter(
+    IREE::VM::RodataOp rodataOp,
+    IREE::Util::SerializableAttrInterface rodataValue,
+    StringRef parameterDir) {
+  SHA256Stream hashStream;
+  if (failed(rodataValue.serializeToStream(llvm::support::endianness::little,
+                                           hashStream))) {
+    rodataOp.emitError() << "failed to serialize parameter";
+    return failure();
+  }
+  std::string key = hashStream.hexDigest();
+
+  SmallString<256> filePath(parameterDir);
+  llvm::sys::path::append(filePath, key + ".bin");
+  if (llvm::sys::fs::exists(filePath)) return key;
+
+  if (auto ec = llvm::sys::fs::create_directories(parameterDir)) {
+    rodataOp.emitError() << "failed to create parameter directory '"
+                         << parameterDir << "': " << ec.message();
+    return failure();
+  }
+  int fd = -1;
+  SmallString<256> tempPath;
+  if (auto ec = llvm::sys::fs::createUniqueFile(
+          llvm::Twine(filePath) + ".%%%%%%%%.tmp", fd, tempPath)) {
+    rodataOp.emitError() << "failed to create parameter file in '"
+                         << parameterDir << "': " << ec.message();
+    return failure();
+  }
+  llvm::raw_fd_ostream os(fd, /*shouldClose=*/true);
+  bool serialized = succeeded(
+      rodataValue.serializeToStream(llvm::support::endianness::little, os));
+  os.close();
+  std::error_code ec = os.error();
+  os.clear_error();
+  if (!serialized || ec) {
+    llvm::sys::fs::remove(tempPath);
+    rodataOp.emitError() << "failed to write parameter file '" << tempPath
+                         << "': "
+                         << (ec ? ec.message() : "serialization failed");
+    return failure();
+  }
+  if (auto ec = llvm::sys::fs::rename(tempPath, filePath)) {
+    llvm::sys::fs::remove(tempPath);
+    rodataOp.emitError() << "failed to write parameter file '" << filePath
+                         << "': " << ec.message();
+    return failure();
+  }
+  return key;
+}
+
+// Compresses the contents of |rodataOp| in independently decompressible chunks.
+// Returns nullptr if compression does not reduce the size of the data in which
+// case it should be stored uncompressed.
+static FailureOr<std::shared_ptr<LZ4ChunkedData>> compressRodata(
+    IREE::VM::RodataOp rodataOp,
+    IREE::Util::SerializableAttrInterface rodataValue) {
+  std::string decompressedData;
+  llvm::raw_string_ostream os(decompressedData);
+  if (failed(rodataValue.serializeToStream(llvm::support::endianness::little,
+                                           os))) {
+    rodataOp.emitError() << "failed to serialize rodata for compression";
+    return failure();
+  }
+  os.flush();
+  auto compressedData =
+      std::make_shared<LZ4ChunkedData>(compressLZ4Chunked(
+          ArrayRef<uint8_t>(
+              reinterpret_cast<const uint8_t *>(decompressedData.data()),
+              decompressedData.size()),
+          kCompressionChunkLength));
+  if (compressedData->data.size() >= decompressedData.size()) {
+    return std::shared_ptr<LZ4ChunkedData>();
+  }
+  return compressedData;
+}
+
 // Gets a file extension based on the given |mimeType| that can be used to help
 // applications guess the file type of embedded data.
 static StringRef mimeTypeToFileExtension(StringRef mimeType) {
@@ -397,9 +518,35 @@ static LogicalResult buildFlatBufferModule(
   // layout planning by preserving the order in the IR is useful.
   SmallVector<iree_vm_RodataSegmentDef_ref_t, 8> rodataSegmentRefs;
   for (auto &rodataRef : llvm::reverse(rodataRefs)) {
-    if (rodataRef.archiveFile.has_value()) {
+    if (!rodataRef.parameterKey.empty()) {
+      // Data is stored outside of the module and resolved by key at runtime.
+      auto keyRef = fbb.createString(rodataRef.parameterKey);
+      iree_vm_RodataSegmentDef_start(fbb);
+      iree_vm_RodataSegmentDef_external_key_add(fbb, keyRef);
+      iree_vm_RodataSegmentDef_external_data_length_add(fbb,
+                                                        rodataRef.totalSize);
+      rodataSegmentRefs.push_back(iree_vm_RodataSegmentDef_end(fbb));
+    } else if (rodataRef.archiveFile.has_value()) {
       // Data is already in the file at a calculated offset.
+      iree_vm_CompressionTypeDef_union_ref_t compressionRef = {0};
+      if (auto &compressedData = rodataRef.compressedData) {
+        auto chunkOffsetsRef = flatbuffers_uint64_vec_create(
+            fbb, compressedData->chunkOffsets.data(),
+            compressedData->chunkOffsets.size());
+        iree_vm_LZ4ChunkedDataDef_start(fbb);
+        iree_vm_LZ4ChunkedDataDef_decompressed_length_add(
+            fbb, compressedData->decompressedLength);
+        iree_vm_LZ4ChunkedDataDef_chunk_length_add(
+            fbb, compressedData->chunkLength);
+        iree_vm_LZ4ChunkedDataDef_chunk_offsets_add(fbb, chunkOffsetsRef);
+        iree_vm_LZ4ChunkedDataDef_alignment_add(fbb, rodataRef.alignment);
+        compressionRef = iree_vm_CompressionTypeDef_as_LZ4ChunkedDataDef(
+            iree_vm_LZ4ChunkedDataDef_end(fbb));
+      }
       iree_vm_RodataSegmentDef_start(fbb);
+      if (rodataRef.compressedData) {
+        iree_vm_RodataSegmentDef_compression_type_add(fbb, compressionRef);
+      }
       iree_vm_RodataSegmentDef_external_data_offset_add(
           fbb, rodataRef.archiveFile->relativeOffset +
                    rodataRef.archiveFile->prefixLength);
@@ -498,14 +645,54 @@ static LogicalResult buildFlatBufferModule(
   int32_t globalRefs = ordinalCounts.getGlobalRefs();
   int32_t globalBytes = ordinalCounts.getGlobalBytes();
 
+  // Ref globals stored to after initialization. The list is always emitted
+  // when there are ref globals so that the runtime can tell an empty list from
+  // a module compiled without mutability information.
+  // NOTE: createInt32Vec returns a null ref for empty lists.
+  flatbuffers_int32_vec_ref_t mutableGlobalRefsRef = 0;
+  if (globalRefs) {
+    SmallVector<int32_t> mutableGlobalRefs;
+    for (auto globalOp : moduleOp.getOps<IREE::VM::GlobalRefOp>()) {
+      if (!globalOp.getIsMutable() ||
+          globalOp->hasAttr("vm.initializer_only")) {
+        continue;
+      }
+      mutableGlobalRefs.push_back(
+          static_cast<int32_t>(globalOp.getOrdinal()->getLimitedValue()));
+    }
+    llvm::sort(mutableGlobalRefs);
+    mutableGlobalRefsRef = flatbuffers_int32_vec_create(
+        fbb, mutableGlobalRefs.data(), mutableGlobalRefs.size());
+  }
+
   iree_vm_ModuleStateDef_ref_t moduleStateDef = 0;
   if (globalBytes || globalRefs) {
     iree_vm_ModuleStateDef_start(fbb);
     iree_vm_ModuleStateDef_global_bytes_capacity_add(fbb, globalBytes);
     iree_vm_ModuleStateDef_global_ref_count_add(fbb, globalRefs);
+    if (mutableGlobalRefsRef) {
+      iree_vm_ModuleStateDef_mutable_global_refs_add(fbb,
+                                                     mutableGlobalRefsRef);
+    }
     moduleStateDef = iree_vm_ModuleStateDef_end(fbb);
   }
 
+  iree_vm_NativeFunctionsDef_ref_t nativeFunctionsDef = 0;
+  if (auto nativeFunctionsAttr =
+          moduleOp->getAttrOfType<FlatSymbolRefAttr>("vm.native_functions")) {
+    auto rodataOp = symbolTable.lookup<IREE::VM::RodataOp>(
+        nativeFunctionsAttr.getValue());
+    if (!rodataOp) {
+      return moduleOp.emitError()
+             << "native functions rodata " << nativeFunctionsAttr
+             << " not found";
+    }
+    iree_vm_NativeFunctionsDef_start(fbb);
+    iree_vm_NativeFunctionsDef_rodata_segment_add(
+        fbb, static_cast<int32_t>(rodataOp.getOrdinal()->getLimitedValue()));
+    nativeFunctionsDef = iree_vm_NativeFunctionsDef_end(fbb);
+  }
+
   iree_vm_DebugDatabaseDef_ref_t debugDatabaseRef = 0;
   if (!bytecodeOptions.stripSourceMap) {
     debugDatabaseRef = debugDatabase.build(fbb);
@@ -545,17 +732,56 @@ static LogicalResult buildFlatBufferModule(
                                                  BytecodeEncoder::kVersion);
   iree_vm_BytecodeModuleDef_bytecode_data_add(fbb, bytecodeDataRef);
   iree_vm_BytecodeModuleDef_debug_database_add(fbb, debugDatabaseRef);
+  iree_vm_BytecodeModuleDef_native_functions_add(fbb, nativeFunctionsDef);
   iree_vm_BytecodeModuleDef_end_as_root(fbb);
 
   return success();
 }
 
+// Embeds the native object at |path| in |moduleOp| as a rodata segment and
+// references it from the module so that it is serialized as the module's
+// native functions.
+static LogicalResult embedNativeFunctions(IREE::VM::ModuleOp moduleOp,
+                                          StringRef path) {
+  auto fileOr = llvm::MemoryBuffer::getFile(
+      path, /*IsText=*/false, /*RequiresNullTerminator=*/false);
+  if (!fileOr) {
+    return moduleOp.emitError() << "failed to read native functions from '"
+                                << path << "': " << fileOr.getError().message();
+  }
+  auto buffer = (*fileOr)->getBuffer();
+  SmallVector<int8_t> data(buffer.begin(), buffer.end());
+
+  auto *context = moduleOp.getContext();
+  auto dataAttr = DenseIntElementsAttr::get(
+      VectorType::get({static_cast<int64_t>(data.size())},
+                      IntegerType::get(context, 8)),
+      data);
+  SymbolTable symbolTable(moduleOp);
+  auto builder = OpBuilder::atBlockTerminator(&moduleOp.getBlock());
+  auto rodataOp = builder.create<IREE::VM::RodataOp>(
+      moduleOp.getLoc(), "__native_functions", dataAttr);
+  rodataOp.setPrivate();
+  rodataOp.setAlignmentAttr(builder.getI64IntegerAttr(kDefaultRodataAlignment));
+  rodataOp.setMimeTypeAttr(builder.getStringAttr("application/x-elf"));
+  symbolTable.insert(rodataOp);
+
+  moduleOp->setAttr("vm.native_functions",
+                    FlatSymbolRefAttr::get(rodataOp.getSymNameAttr()));
+  return success();
+}
+
 LogicalResult translateModuleToBytecode(
     IREE::VM::ModuleOp moduleOp, IREE::VM::TargetOptions vmOptions,
     IREE::VM::BytecodeTargetOptions bytecodeOptions,
     llvm::raw_ostream &output) {
   moduleOp.getContext()->getOrLoadDialect<IREE::Util::UtilDialect>();
 
+  if (!bytecodeOptions.nativeFunctions.empty() &&
+      failed(embedNativeFunctions(moduleOp, bytecodeOptions.nativeFunctions))) {
+    return failure();
+  }
+
   if (failed(canonicalizeModule(bytecodeOptions, moduleOp))) {
     return moduleOp.emitError()
            << "failed to canonicalize vm.module to a serializable form";
@@ -644,17 +870,51 @@ LogicalResult translateModuleToBytecode(
     rodataRef.alignment =
         rodataOp.getAlignment().value_or(kDefaultRodataAlignment);
     rodataRef.totalSize = static_cast<uint64_t>(actualSize);
-    if (storeExternal) {
+
+    // Large constants without a mime type (weights and other program data,
+    // not executables) can be moved out of the module entirely so that they
+    // can be shared across modules and mapped at runtime.
+    bool storeParameter = !bytecodeOptions.parameterDir.empty() &&
+                          !rodataOp.getMimeType().has_value() &&
+                          actualSize > 0 &&
+                          static_cast<int64_t>(actualSize) >=
+                              bytecodeOptions.parameterThreshold;
+    if (storeParameter) {
+      auto parameterKey = writeParameter(rodataOp, rodataValue,
+                                         bytecodeOptions.parameterDir);
+      if (failed(parameterKey)) return failure();
+      rodataRef.parameterKey = std::move(*parameterKey);
+    } else if (storeExternal) {
       std::string fileName =
           (rodataOp.getName() +
            mimeTypeToFileExtension(rodataOp.getMimeType().value_or("")))
               .str();
-      rodataRef.archiveFile = archiveWriter->declareFile(
-          fileName, rodataRef.alignment, rodataRef.totalSize,
-          [=](llvm::raw_ostream &os) {
-            return rodataValue.serializeToStream(
-                llvm::support::endianness::little, os);
-          });
+      // Only program data is compressed; files with a mime type (such as
+      // executables) are kept as-is so they can be used in-place.
+      if (bytecodeOptions.rodataCompression ==
+              BytecodeRodataCompression::kLZ4 &&
+          !rodataOp.getMimeType().has_value()) {
+        auto compressedData = compressRodata(rodataOp, rodataValue);
+        if (failed(compressedData)) return failure();
+        rodataRef.compressedData = std::move(*compressedData);
+      }
+      if (auto compressedData = rodataRef.compressedData) {
+        rodataRef.archiveFile = archiveWriter->declareFile(
+            fileName + ".lz4", rodataRef.alignment, compressedData->data.size(),
+            [=](llvm::raw_ostream &os) {
+              os.write(reinterpret_cast<const char *>(
+                           compressedData->data.data()),
+                       compressedData->data.size());
+              return success();
+            });
+      } else {
+        rodataRef.archiveFile = archiveWriter->declareFile(
+            fileName, rodataRef.alignment, rodataRef.totalSize,
+            [=](llvm::raw_ostream &os) {
+              return rodataValue.serializeToStream(
+                  llvm::support::endianness::little, os);
+            });
+      }
     }
     rodataRefs[rodataOp.getOrdinal()->getLimitedValue()] = rodataRef;
   }
@@ -729,6 +989,34 @@ void BytecodeTargetOptions::bindOptions(OptionsBinder &binder) {
       llvm::cl::desc(
           "Enables output files to be viewed as zip files for debugging "
           "(only applies to binary targets)"));
+  binder.opt<BytecodeRodataCompression>(
+      "iree-vm-bytecode-module-rodata-compression", rodataCompression,
+      llvm::cl::cat(vmBytecodeOptionsCategory),
+      llvm::cl::desc("Compression applied to large rodata segments"),
+      llvm::cl::values(
+          clEnumValN(BytecodeRodataCompression::kNone, "none",
+                     "Rodata is stored uncompressed"),
+          clEnumValN(BytecodeRodataCompression::kLZ4, "lz4",
+                     "Rodata is compressed in LZ4 block chunks and "
+                     "decompressed in parallel at load time")));
+  binder.opt<std::string>(
+      "iree-vm-bytecode-module-parameter-dir", parameterDir,
+      llvm::cl::cat(vmBytecodeOptionsCategory),
+      llvm::cl::desc("Writes large constants as content-addressed parameter "
+                     "files into the given directory instead of embedding "
+                     "them in the module; the directory must be provided to "
+                     "the runtime when loading the module"));
+  binder.opt<int64_t>(
+      "iree-vm-bytecode-module-parameter-threshold", parameterThreshold,
+      llvm::cl::cat(vmBytecodeOptionsCategory),
+      llvm::cl::desc("Minimum size in bytes of constants written as "
+                     "parameters when a parameter directory is specified"));
+  binder.opt<std::string>(
+      "iree-vm-bytecode-module-native-functions", nativeFunctions,
+      llvm::cl::cat(vmBytecodeOptionsCategory),
+      llvm::cl::desc("Embeds an ELF or FatELF containing native versions of "
+                     "exported functions; runtimes able to load it call them "
+                     "instead of interpreting the bytecode"));
 }
 
 }  // namespace VM
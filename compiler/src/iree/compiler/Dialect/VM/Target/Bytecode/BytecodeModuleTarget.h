@@ -33,6 +33,15 @@ enum class BytecodeOutputFormat {
   kAnnotatedMlirText,
 };
 
+// Defines the compression applied to rodata stored outside of the FlatBuffer.
+enum class BytecodeRodataCompression {
+  // Rodata is stored uncompressed and can be used in-place when mapped.
+  kNone,
+  // Rodata is compressed in independently decompressible LZ4 block chunks and
+  // decompressed when the module is loaded.
+  kLZ4,
+};
+
 // Options that can be provided to bytecode translation.
 struct BytecodeTargetOptions {
   // Format of the module written to the output stream.
@@ -57,6 +66,27 @@ struct BytecodeTargetOptions {
   // should be disabled in release builds.
   bool emitPolyglotZip = true;
 
+  // Compression applied to large rodata. Compressed rodata reduces module size
+  // at the cost of decompressing into memory at load time instead of mapping
+  // the module contents directly.
+  BytecodeRodataCompression rodataCompression =
+      BytecodeRodataCompression::kNone;
+
+  // Directory into which large constants are written as parameters instead of
+  // being stored in the module. Each parameter is stored in its own file named
+  // by the SHA-256 digest of its contents so that modules sharing weights share
+  // the files and the files can be mapped directly at runtime.
+  std::string parameterDir;
+  // Minimum size in bytes of constants that are written as parameters when a
+  // parameter directory is specified.
+  int64_t parameterThreshold = 1 * 1024 * 1024;
+
+  // Path of an ELF shared object or FatELF containing native versions of
+  // exported functions to embed in the module. Each native function is
+  // exported from the object under the name of the function it replaces and
+  // is called instead of the bytecode when the runtime can load the object.
+  std::string nativeFunctions;
+
   void bindOptions(OptionsBinder &binder);
   using FromFlags = OptionsFromFlags<BytecodeTargetOptions>;
 };
@@ -0,0 +1,119 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/compiler/Dialect/VM/Target/Bytecode/LZ4Compression.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace VM {
+
+// Constants defined by the LZ4 block format:
+// https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md
+// Minimum length of a match.
+static constexpr size_t kMinMatch = 4;
+// The last 5 bytes of a block are always literals.
+static constexpr size_t kLastLiterals = 5;
+// The last match must start at least 12 bytes before the end of the block.
+static constexpr size_t kMatchFindLimit = 12;
+// Maximum distance a match may reference backward.
+static constexpr size_t kMaxOffset = 65535;
+// Number of bits in the hash table indexing 4-byte sequences.
+static constexpr unsigned kHashBits = 16;
+
+static uint32_t readUint32(const uint8_t *ptr) {
+  uint32_t value;
+  std::memcpy(&value, ptr, sizeof(value));
+  return value;
+}
+
+static uint32_t hashSequence(uint32_t sequence) {
+  return (sequence * 2654435761u) >> (32 - kHashBits);
+}
+
+// Appends a length that overflowed the 4-bit token field.
+static void appendExtendedLength(size_t length, std::vector<uint8_t> &out) {
+  for (; length >= 255; length -= 255) out.push_back(255);
+  out.push_back(static_cast<uint8_t>(length));
+}
+
+// Appends a sequence of |literals| followed by a match of |matchLength| bytes
+// at |offset|. A zero |matchLength| ends the block with only literals.
+static void appendSequence(llvm::ArrayRef<uint8_t> literals, size_t offset,
+                           size_t matchLength, std::vector<uint8_t> &out) {
+  size_t literalLength = literals.size();
+  size_t matchCode = matchLength ? matchLength - kMinMatch : 0;
+  size_t token = (std::min<size_t>(literalLength, 15) << 4) |
+                 std::min<size_t>(matchCode, 15);
+  out.push_back(static_cast<uint8_t>(token));
+  if (literalLength >= 15) appendExtendedLength(literalLength - 15, out);
+  out.insert(out.end(), literals.begin(), literals.end());
+  if (!matchLength) return;
+  out.push_back(static_cast<uint8_t>(offset & 0xFF));
+  out.push_back(static_cast<uint8_t>(offset >> 8));
+  if (matchCode >= 15) appendExtendedLength(matchCode - 15, out);
+}
+
+// Compresses |data| as a single LZ4 block using greedy matching against the
+// most recent occurrence of each 4-byte sequence. This favors simplicity and
+// compression speed over ratio.
+static void compressBlock(llvm::ArrayRef<uint8_t> data,
+                          std::vector<uint8_t> &out) {
+  const uint8_t *base = data.data();
+  const size_t length = data.size();
+  size_t anchor = 0;
+  if (length > kMatchFindLimit) {
+    std::vector<int64_t> table(size_t(1) << kHashBits, -1);
+    const size_t matchLimit = length - kLastLiterals;
+    size_t position = 0;
+    while (position < length - kMatchFindLimit) {
+      uint32_t sequence = readUint32(base + position);
+      int64_t &entry = table[hashSequence(sequence)];
+      int64_t candidate = entry;
+      entry = static_cast<int64_t>(position);
+      if (candidate < 0 || position - candidate > kMaxOffset ||
+          readUint32(base + candidate) != sequence) {
+        ++position;
+        continue;
+      }
+      size_t matchLength = kMinMatch;
+      while (position + matchLength < matchLimit &&
+             base[candidate + matchLength] == base[position + matchLength]) {
+        ++matchLength;
+      }
+      appendSequence(data.slice(anchor, position - anchor),
+                     position - candidate, matchLength, out);
+      position += matchLength;
+      anchor = position;
+    }
+  }
+  appendSequence(data.drop_front(anchor), /*offset=*/0, /*matchLength=*/0,
+                 out);
+}
+
+LZ4ChunkedData compressLZ4Chunked(llvm::ArrayRef<uint8_t> data,
+                                  uint64_t chunkLength) {
+  LZ4ChunkedData result;
+  result.decompressedLength = data.size();
+  result.chunkLength = chunkLength;
+  result.data.reserve(data.size());
+  result.chunkOffsets.push_back(0);
+  for (uint64_t offset = 0; offset < data.size(); offset += chunkLength) {
+    compressBlock(data.slice(offset, std::min<uint64_t>(chunkLength,
+                                                        data.size() - offset)),
+                  result.data);
+    result.chunkOffsets.push_back(result.data.size());
+  }
+  return result;
+}
+
+}  // namespace VM
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
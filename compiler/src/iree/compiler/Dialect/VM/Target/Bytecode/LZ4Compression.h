@@ -0,0 +1,45 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_COMPILER_DIALECT_VM_TARGET_BYTECODE_LZ4COMPRESSION_H_
+#define IREE_COMPILER_DIALECT_VM_TARGET_BYTECODE_LZ4COMPRESSION_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallVector.h"
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace VM {
+
+// Data compressed as a sequence of independently compressed chunks in the LZ4
+// block format. Matches the LZ4ChunkedDataDef in bytecode_module_def.fbs.
+struct LZ4ChunkedData {
+  // Total length of the data once decompressed.
+  uint64_t decompressedLength = 0;
+  // Length of each chunk once decompressed; the last chunk may be shorter.
+  uint64_t chunkLength = 0;
+  // Offset of each chunk in |data| with a trailing offset of the end of the
+  // last chunk.
+  llvm::SmallVector<uint64_t> chunkOffsets;
+  // Compressed chunks stored back to back.
+  std::vector<uint8_t> data;
+};
+
+// Compresses |data| in chunks of |chunkLength| bytes. Chunks do not reference
+// each other and can be decompressed concurrently by the runtime.
+LZ4ChunkedData compressLZ4Chunked(llvm::ArrayRef<uint8_t> data,
+                                  uint64_t chunkLength);
+
+}  // namespace VM
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
+
+#endif  // IREE_COMPILER_DIALECT_VM_TARGET_BYTECODE_LZ4COMPRESSION_H_
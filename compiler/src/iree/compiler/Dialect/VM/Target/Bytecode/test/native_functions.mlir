@@ -0,0 +1,35 @@
+// RUN: printf '\177ELF' > %t.so && \
+// RUN: iree-compile --compile-mode=vm \
+// RUN:   --iree-vm-bytecode-module-output-format=flatbuffer-text \
+// RUN:   --iree-vm-bytecode-module-native-functions=%t.so %s | FileCheck %s
+
+// The native object is embedded as a rodata segment after those already in
+// the module and referenced by ordinal from the module.
+
+// CHECK: "name": "native_functions"
+vm.module @native_functions {
+  vm.export @add
+  vm.func @add(%arg0: i32, %arg1: i32) -> i32 {
+    %0 = vm.add.i32 %arg0, %arg1 : i32
+    vm.return %0 : i32
+  }
+
+  // CHECK: "rodata_segments": [{
+  //      CHECK: "embedded_data": [
+  // CHECK-NEXT:   1,
+  // CHECK-NEXT:   2,
+  // CHECK-NEXT:   3
+  // CHECK-NEXT: ]
+  vm.rodata private @small dense<[1, 2, 3]> : tensor<3xi8>
+
+  //      CHECK: "embedded_data": [
+  // CHECK-NEXT:   127,
+  // CHECK-NEXT:   69,
+  // CHECK-NEXT:   76,
+  // CHECK-NEXT:   70
+  // CHECK-NEXT: ]
+}
+
+//      CHECK: "native_functions": {
+// CHECK-NEXT:   "rodata_segment": 1
+// CHECK-NEXT: }
@@ -0,0 +1,39 @@
+// RUN: rm -rf %t && \
+// RUN: iree-compile --compile-mode=vm \
+// RUN:   --iree-vm-bytecode-module-output-format=flatbuffer-text \
+// RUN:   --iree-vm-bytecode-module-parameter-dir=%t \
+// RUN:   --iree-vm-bytecode-module-parameter-threshold=32 %s | FileCheck %s
+// RUN: ls %t | FileCheck %s --check-prefix=FILES
+
+// Constants at or above the threshold are written to the parameter directory
+// keyed by the SHA-256 of their contents and identical constants share a file.
+
+// FILES: 1645dafaadd8b1075dbb65a6a961a05d28e40d93da92293ce602dca244e85d6b.bin
+// FILES-NOT: .bin
+
+// CHECK: "name": "parameters"
+vm.module @parameters {
+  vm.export @func
+  vm.func @func() {
+    vm.return
+  }
+
+  // CHECK: "rodata_segments": [{
+
+  //      CHECK: "embedded_data": [
+  // CHECK-NEXT:   1,
+  // CHECK-NEXT:   2,
+  // CHECK-NEXT:   3
+  // CHECK-NEXT: ]
+  vm.rodata private @small dense<[1, 2, 3]> : tensor<3xi8>
+
+  //  CHECK-NOT: "embedded_data"
+  //      CHECK: "external_data_length": 32,
+  // CHECK-NEXT: "external_key": "1645dafaadd8b1075dbb65a6a961a05d28e40d93da92293ce602dca244e85d6b"
+  vm.rodata private @weight0 dense<1> : tensor<8xi32>
+
+  //  CHECK-NOT: "embedded_data"
+  //      CHECK: "external_data_length": 32,
+  // CHECK-NEXT: "external_key": "1645dafaadd8b1075dbb65a6a961a05d28e40d93da92293ce602dca244e85d6b"
+  vm.rodata private @weight1 dense<1> : tensor<8xi32>
+}
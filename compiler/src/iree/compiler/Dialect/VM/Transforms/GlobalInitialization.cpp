@@ -87,12 +87,19 @@ static void exportFuncIfNeeded(IREE::VM::ModuleOp moduleOp,
 // Updates the mutability of globals based on whether they are stored outside of
 // initializers. A more sophisticated analysis is required as initializers can
 // call functions and this will miss that (but that's ok).
-static void fixupGlobalMutability(Operation *moduleOp,
+//
+// All initializers have been merged into |initFuncOp| so any global stored to
+// is now mutable. Ref globals that are only stored to by |initFuncOp| are
+// marked with `vm.initializer_only` so that the runtime knows the objects they
+// reference never change after initialization (such as when forking contexts).
+// Stores from functions called by |initFuncOp| are treated as mutations.
+static void fixupGlobalMutability(Operation *moduleOp, Operation *initFuncOp,
                                   SymbolTable &symbolTable) {
   SmallVector<Operation *> deadOps;
   for (auto &op : moduleOp->getRegion(0).front()) {
     auto globalOp = dyn_cast<IREE::Util::GlobalOpInterface>(op);
     if (!globalOp) continue;
+    op.removeAttr("vm.initializer_only");
     if (!cast<SymbolOpInterface>(op).isPrivate()) {
       // May be used outside the module; treat as used and mutable.
       globalOp.setGlobalMutable(true);
@@ -105,20 +112,27 @@ static void fixupGlobalMutability(Operation *moduleOp,
       continue;
     }
     bool maybeStored = false;
+    bool maybeStoredAfterInit = false;
     for (auto use : uses.value()) {
       auto *user = use.getUser();
       if (isa<IREE::Util::GlobalAddressOpInterface>(user)) {
         // Can't analyze indirect variables; assume mutated.
         maybeStored = true;
+        maybeStoredAfterInit = true;
         break;
       } else if (isa<IREE::Util::GlobalStoreOpInterface>(user)) {
         maybeStored = true;
+        if (!initFuncOp->isAncestor(user)) maybeStoredAfterInit = true;
       }
     }
     // NOTE: we could erase globals never loaded if we know that computing
     // their value has no side effects.
     if (maybeStored) {
       globalOp.setGlobalMutable(true);
+      if (!maybeStoredAfterInit &&
+          llvm::isa<IREE::VM::RefType>(globalOp.getGlobalType())) {
+        op.setAttr("vm.initializer_only", UnitAttr::get(op.getContext()));
+      }
     }
   }
   for (auto *deadOp : deadOps) {
@@ -214,7 +228,7 @@ class GlobalInitializationPass
     deinitBuilder.create<IREE::VM::ReturnOp>(deinitBuilder.getUnknownLoc());
 
     // Correct mutability of all globals.
-    fixupGlobalMutability(moduleOp, symbolTable);
+    fixupGlobalMutability(moduleOp, initFuncOp, symbolTable);
 
     // If we didn't need to initialize anything then we can elide the functions
     // and otherwise we need to ensure they are exported.
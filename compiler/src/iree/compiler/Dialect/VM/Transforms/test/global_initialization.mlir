@@ -63,7 +63,7 @@ vm.module @initializers {
     vm.return
   }
 
-  // CHECK: vm.global.ref private mutable @g1 : !vm.ref<?>
+  // CHECK: vm.global.ref private mutable @g1 {vm.initializer_only} : !vm.ref<?>
   vm.global.ref private mutable @g1 : !vm.ref<?>
   // CHECK-NOT: vm.initializer
   vm.initializer {
@@ -72,7 +72,7 @@ vm.module @initializers {
     vm.return
   }
 
-  // CHECK: vm.global.ref private mutable @g2 : !vm.ref<?>
+  // CHECK: vm.global.ref private mutable @g2 {vm.initializer_only} : !vm.ref<?>
   vm.global.ref private mutable @g2 : !vm.ref<?>
   // CHECK-NOT: vm.initializer
   vm.initializer {
@@ -95,6 +95,32 @@ vm.module @initializers {
 
 // -----
 
+// Tests that ref globals stored to outside of initializers are not marked as
+// initializer-only.
+
+// CHECK-LABEL: @mutable_refs
+vm.module @mutable_refs {
+  // CHECK: vm.global.ref private mutable @g0 {vm.initializer_only} : !vm.ref<?>
+  vm.global.ref private @g0 : !vm.ref<?>
+  // CHECK: vm.global.ref private mutable @g1 : !vm.ref<?>
+  vm.global.ref private mutable @g1 : !vm.ref<?>
+  // CHECK: vm.global.ref public mutable @g2 : !vm.ref<?>
+  vm.global.ref @g2 : !vm.ref<?>
+  vm.initializer {
+    %null = vm.const.ref.zero : !vm.ref<?>
+    vm.global.store.ref %null, @g0 : !vm.ref<?>
+    vm.global.store.ref %null, @g1 : !vm.ref<?>
+    vm.global.store.ref %null, @g2 : !vm.ref<?>
+    vm.return
+  }
+  vm.func @set(%arg0: !vm.ref<?>) {
+    vm.global.store.ref %arg0, @g1 : !vm.ref<?>
+    vm.return
+  }
+}
+
+// -----
+
 // CHECK-LABEL: @unused_globals
 vm.module @unused_globals {
   // CHECK: vm.global.i32 private mutable @used
@@ -153,7 +179,7 @@ vm.module @existing_init {
   }
 
   // Handled in __init already. No new code should be added.
-  // CHECK: vm.global.ref private mutable @g2 : !vm.ref<?>
+  // CHECK: vm.global.ref private mutable @g2 {vm.initializer_only} : !vm.ref<?>
   vm.global.ref private mutable @g2 : !vm.ref<?>
 
   // CHECK: vm.export @__init
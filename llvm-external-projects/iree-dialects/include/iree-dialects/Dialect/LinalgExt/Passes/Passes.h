@@ -170,11 +170,14 @@ std::unique_ptr<Pass> createDecomposeSoftmaxPass();
 // Transform dialect version of tile and decompose attention
 SmallVector<Operation *>
 tileAndDecomposeAttention(IREE::LinalgExt::AttentionOp attnOp,
-                          IRRewriter &rewriter);
+                          IRRewriter &rewriter,
+                          std::optional<uint64_t> tileSize = std::nullopt);
 
 // Creates a pass to convert the attention op into a sequence of
-// linalg ops.
-std::unique_ptr<Pass> createTileAndDecomposeAttentionPass();
+// linalg ops. `tileSize` is the number of key/value rows consumed per
+// iteration of the online softmax loop; 0 uses the query tile length.
+std::unique_ptr<Pass>
+createTileAndDecomposeAttentionPass(uint64_t tileSize = 0);
 
 // Marker used as attribute the depth of the split reduction transformations.
 const StringLiteral kSplitReductionDepthMarker = "__split_reduction_depth__";
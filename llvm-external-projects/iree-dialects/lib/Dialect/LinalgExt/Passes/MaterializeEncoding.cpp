@@ -9,6 +9,7 @@
 #include "iree-dialects/Dialect/LinalgExt/Passes/Passes.h"
 #include "iree-dialects/Dialect/LinalgExt/Utils/Utils.h"
 #include "mlir/Dialect/Affine/IR/AffineOps.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
 #include "mlir/Dialect/Linalg/IR/Linalg.h"
 #include "mlir/Dialect/MemRef/Transforms/Transforms.h"
 #include "mlir/Dialect/Tensor/IR/Tensor.h"
@@ -88,6 +89,18 @@ chooseEncodingInfo(RankedTensorType tensorType) {
   case TensorEncoding::MATMUL_I8I8I32_RESULT:
     return MaterializeEncodingInfo{{0, 1}, {8, 8}, {}};
     break;
+  case TensorEncoding::BATCH_MATMUL_F32F32F32_LHS:
+  case TensorEncoding::BATCH_MATMUL_I8I8I32_LHS:
+    return MaterializeEncodingInfo{{1, 2}, {8, 4}, {}};
+    break;
+  case TensorEncoding::BATCH_MATMUL_F32F32F32_RHS:
+  case TensorEncoding::BATCH_MATMUL_I8I8I32_RHS:
+    return MaterializeEncodingInfo{{2, 1}, {8, 4}, {0, 2, 1}};
+    break;
+  case TensorEncoding::BATCH_MATMUL_F32F32F32_RESULT:
+  case TensorEncoding::BATCH_MATMUL_I8I8I32_RESULT:
+    return MaterializeEncodingInfo{{1, 2}, {8, 8}, {}};
+    break;
   default:
     return failure();
   }
@@ -220,6 +233,73 @@ lowerOpWithEncoding(RewriterBase &rewriter, linalg::MatmulOp matmulOp,
   return mmt4DOp;
 }
 
+/// Utility method to convert from `linalg.batch_matmul` with
+/// - lhs encoding of BATCH_MATMUL_*_LHS
+/// - rhs encoding of BATCH_MATMUL_*_RHS
+/// - result encoding of BATCH_MATMUL_*_RESULT
+/// to a batched mmt4d. There is no named op for it so it is expressed as a
+/// `linalg.generic` with the iteration space (b, m1, n1, k1, m0, n0, k0).
+static FailureOr<Operation *>
+lowerOpWithEncoding(RewriterBase &rewriter, linalg::BatchMatmulOp batchMatmulOp,
+                    ValueRange convertedInputOperands,
+                    ValueRange convertedOutputOperands, MaterializeEncodingFn,
+                    MaterializeEncodingValueFn) {
+  if (!batchMatmulOp.hasTensorSemantics())
+    return failure();
+  auto inputs = batchMatmulOp.getDpsInputOperands();
+  auto outputs = batchMatmulOp.getDpsInitOperands();
+  std::optional<TensorEncoding> lhsEncoding =
+      getEncoding(inputs[0]->get().getType().cast<RankedTensorType>());
+  std::optional<TensorEncoding> rhsEncoding =
+      getEncoding(inputs[1]->get().getType().cast<RankedTensorType>());
+  std::optional<TensorEncoding> resultEncoding =
+      getEncoding(outputs[0]->get().getType().cast<RankedTensorType>());
+  if (!lhsEncoding ||
+      (lhsEncoding.value() != TensorEncoding::BATCH_MATMUL_F32F32F32_LHS &&
+       lhsEncoding.value() != TensorEncoding::BATCH_MATMUL_I8I8I32_LHS) ||
+      !rhsEncoding ||
+      (rhsEncoding.value() != TensorEncoding::BATCH_MATMUL_F32F32F32_RHS &&
+       rhsEncoding.value() != TensorEncoding::BATCH_MATMUL_I8I8I32_RHS) ||
+      !resultEncoding ||
+      (resultEncoding.value() !=
+           TensorEncoding::BATCH_MATMUL_F32F32F32_RESULT &&
+       resultEncoding.value() != TensorEncoding::BATCH_MATMUL_I8I8I32_RESULT)) {
+    return failure();
+  }
+
+  MLIRContext *context = rewriter.getContext();
+  AffineExpr b, m1, n1, k1, m0, n0, k0;
+  bindDims(context, b, m1, n1, k1, m0, n0, k0);
+  auto lhsMap = AffineMap::get(7, 0, {b, m1, k1, m0, k0}, context);
+  auto rhsMap = AffineMap::get(7, 0, {b, n1, k1, n0, k0}, context);
+  auto resultMap = AffineMap::get(7, 0, {b, m1, n1, m0, n0}, context);
+  auto parallel = utils::IteratorType::parallel;
+  auto reduction = utils::IteratorType::reduction;
+  SmallVector<utils::IteratorType> iteratorTypes = {
+      parallel, parallel, parallel, reduction, parallel, parallel, reduction};
+  Type outElemType = getElementTypeOrSelf(convertedOutputOperands[0].getType());
+  bool isInt = outElemType.isa<IntegerType>();
+  auto genericOp = rewriter.create<linalg::GenericOp>(
+      batchMatmulOp.getLoc(), convertedOutputOperands[0].getType(),
+      convertedInputOperands, convertedOutputOperands,
+      ArrayRef<AffineMap>{lhsMap, rhsMap, resultMap}, iteratorTypes,
+      [&](OpBuilder &builder, Location loc, ValueRange args) {
+        Value result;
+        if (isInt) {
+          // Integer inputs are sign-extended as in `linalg.mmt4d`.
+          Value lhs = builder.create<arith::ExtSIOp>(loc, outElemType, args[0]);
+          Value rhs = builder.create<arith::ExtSIOp>(loc, outElemType, args[1]);
+          Value mul = builder.create<arith::MulIOp>(loc, lhs, rhs);
+          result = builder.create<arith::AddIOp>(loc, args[2], mul);
+        } else {
+          Value mul = builder.create<arith::MulFOp>(loc, args[0], args[1]);
+          result = builder.create<arith::AddFOp>(loc, args[2], mul);
+        }
+        builder.create<linalg::YieldOp>(loc, result);
+      });
+  return genericOp.getOperation();
+}
+
 /// Utility method to convert from `linalg.fill` on `tensor` type with encoding
 /// to fill of the materialized type
 static FailureOr<Operation *>
@@ -373,7 +453,8 @@ struct MaterializeOperation : public OpMaterializeEncodingPattern<OpTy> {
 struct MaterializeEncodingPass
     : public MaterializeEncodingBase<MaterializeEncodingPass> {
   void getDependentDialects(DialectRegistry &registry) const override {
-    registry.insert<tensor::TensorDialect>();
+    registry.insert<arith::ArithDialect, linalg::LinalgDialect,
+                    tensor::TensorDialect>();
   }
 
   void runOnOperation() override;
@@ -450,6 +531,7 @@ void populateMaterializeEncodingPatterns(
   // Add all patterns for converting from encoded type to the materialized type
   patterns.insert<MaterializeDPSOperation<linalg::FillOp>,
                   MaterializeDPSOperation<linalg::MatmulOp>,
+                  MaterializeDPSOperation<linalg::BatchMatmulOp>,
                   MaterializeOperation<tensor::EmptyOp>,
                   SetEncodingOpToPackOpConversion,
                   UnsetEncodingOpToPackOpConversion>(
@@ -157,26 +157,32 @@ static Value computeQKTranspose(Value query, Value key, Value output,
 static std::tuple<Value, Value, Value, Value>
 extractSlices(Value key, Value value, Value query, Value output,
               ArrayRef<int64_t> queryShape, ArrayRef<Value> ivs,
-              OpFoldResult sequenceTileLength, OpFoldResult headDimension,
-              Type elementType, Location loc, OpBuilder &builder) {
+              OpFoldResult sequenceTileLength, OpFoldResult keyValueTileLength,
+              OpFoldResult headDimension, Type elementType, Location loc,
+              OpBuilder &builder) {
   auto one = builder.getIndexAttr(1);
   auto zero = builder.getIndexAttr(0);
   SmallVector<OpFoldResult> strides(queryShape.size(), one);
   SmallVector<OpFoldResult> sizes(queryShape.size(), one);
   SmallVector<OpFoldResult> offsets(queryShape.size(), zero);
-  sizes[1] = sequenceTileLength;
+  sizes[1] = keyValueTileLength;
   sizes[2] = headDimension;
   offsets[0] = ivs[0];
   offsets[1] = ivs[1];
-  SmallVector<int64_t> tensorShape{queryShape[1], queryShape[2]};
-  auto tensorType = RankedTensorType::get(tensorShape, elementType);
+  SmallVector<int64_t> keyValueShape{
+      getConstantIntValue(keyValueTileLength).value_or(ShapedType::kDynamic),
+      queryShape[2]};
+  auto keyValueType = RankedTensorType::get(keyValueShape, elementType);
   Value keySlice = builder.create<tensor::ExtractSliceOp>(
-      loc, tensorType, key, offsets, sizes, strides);
+      loc, keyValueType, key, offsets, sizes, strides);
   Value valueSlice = builder.create<tensor::ExtractSliceOp>(
-      loc, tensorType, value, offsets, sizes, strides);
+      loc, keyValueType, value, offsets, sizes, strides);
 
+  sizes[1] = sequenceTileLength;
   offsets = SmallVector<OpFoldResult>(queryShape.size(), zero);
   offsets[0] = ivs[0];
+  SmallVector<int64_t> tensorShape{queryShape[1], queryShape[2]};
+  auto tensorType = RankedTensorType::get(tensorShape, elementType);
   Value querySlice = builder.create<tensor::ExtractSliceOp>(
       loc, tensorType, query, offsets, sizes, strides);
   Value outputSlice = builder.create<tensor::ExtractSliceOp>(
@@ -223,14 +229,15 @@ static scf::LoopNest createLoopNest(SmallVectorImpl<Value> &ivs, Value lb,
 static std::tuple<Value, Value, Value>
 createAttentionBody(Value keySlice, Value valueSlice, Value querySlice,
                     Value outputSlice, Value maxSlice, Value sumSlice,
-                    OpFoldResult sequenceTileLength, OpFoldResult headDimension,
+                    OpFoldResult sequenceTileLength,
+                    OpFoldResult keyValueTileLength, OpFoldResult headDimension,
                     Type elementType, SmallVectorImpl<Operation *> &ops,
                     Location loc, OpBuilder &builder) {
 
   // Compute matmul(q, transpose(k))
   Value zero =
       builder.create<arith::ConstantOp>(loc, builder.getZeroAttr(elementType));
-  SmallVector<OpFoldResult> resultShape{sequenceTileLength, sequenceTileLength};
+  SmallVector<OpFoldResult> resultShape{sequenceTileLength, keyValueTileLength};
   Value emptySquare =
       builder.create<tensor::EmptyOp>(loc, resultShape, elementType);
   Value qkTranspose = computeQKTranspose(querySlice, keySlice, emptySquare,
@@ -267,7 +274,8 @@ createAttentionBody(Value keySlice, Value valueSlice, Value querySlice,
 
 SmallVector<Operation *>
 tileAndDecomposeAttention(IREE::LinalgExt::AttentionOp attnOp,
-                          IRRewriter &rewriter) {
+                          IRRewriter &rewriter,
+                          std::optional<uint64_t> tileSize) {
   SmallVector<Operation *> ops;
   Location loc = attnOp.getLoc();
   OpBuilder::InsertionGuard guard(rewriter);
@@ -289,6 +297,19 @@ tileAndDecomposeAttention(IREE::LinalgExt::AttentionOp attnOp,
       tensor::createDimValues(rewriter, loc, key);
   OpFoldResult sequenceLength = keyDimValues[1];
 
+  // The key/value sequence is walked in blocks of `tileSize` rows. Without an
+  // explicit tile size (or when it does not evenly divide a static sequence
+  // length) the block matches the query tile, which keeps the score tile
+  // square.
+  OpFoldResult keyValueTileLength = sequenceTileLength;
+  if (tileSize) {
+    std::optional<int64_t> staticSequenceLength =
+        getConstantIntValue(sequenceLength);
+    if (staticSequenceLength && *staticSequenceLength % *tileSize == 0) {
+      keyValueTileLength = rewriter.getIndexAttr(*tileSize);
+    }
+  }
+
   // Construct first loop
   Value zeroValue = rewriter.create<arith::ConstantIndexOp>(loc, 0);
   Value oneValue = rewriter.create<arith::ConstantIndexOp>(loc, 1);
@@ -323,7 +344,7 @@ tileAndDecomposeAttention(IREE::LinalgExt::AttentionOp attnOp,
   // Construct second loop
   scf::LoopNest secondLoopNest = createLoopNest(
       ivs, zeroValue,
-      getValueOrCreateConstantIndexOp(rewriter, loc, sequenceTileLength),
+      getValueOrCreateConstantIndexOp(rewriter, loc, keyValueTileLength),
       getValueOrCreateConstantIndexOp(rewriter, loc, sequenceLength),
       ValueRange({iterArg, negativeMax, zeroSum}), loc, rewriter);
   ops.push_back(secondLoopNest.loops.back());
@@ -338,12 +359,13 @@ tileAndDecomposeAttention(IREE::LinalgExt::AttentionOp attnOp,
   // Extract slices
   auto [keySlice, valueSlice, querySlice, outputSlice] = extractSlices(
       key, value, query, iterArgResult, queryShape, ivs, sequenceTileLength,
-      headDimension, elementType, loc, rewriter);
+      keyValueTileLength, headDimension, elementType, loc, rewriter);
 
   // Create body of innermost loop
   auto [result, newMax, newSum] = createAttentionBody(
       keySlice, valueSlice, querySlice, outputSlice, iterArgMax, iterArgSum,
-      sequenceTileLength, headDimension, elementType, ops, loc, rewriter);
+      sequenceTileLength, keyValueTileLength, headDimension, elementType, ops,
+      loc, rewriter);
 
   // Insert slices
   auto [updatedAcc, updatedMax, updatedSum] = insertSlices(
@@ -382,9 +404,9 @@ namespace {
 /// For each element in B,
 /// 1. Load a tile from the Q matrix of size T x d -> q
 /// 2. Initialize statistics: running_sum, running_max
-/// 3. for i = 0 to N with step T
-///    a. Load a tile from the K matrix of size T x d -> k
-///    a. Load a tile from the V matrix of size T x d -> v
+/// 3. for i = 0 to N with step S (S defaults to T)
+///    a. Load a tile from the K matrix of size S x d -> k
+///    a. Load a tile from the V matrix of size S x d -> v
 ///    b. Transpose(k) -> kT
 ///    c. Compute matmul(q, kT) -> qkT
 ///    d. Compute sum(qkT) along rows -> current_sum
@@ -397,10 +419,28 @@ namespace {
 ///    j. Compute matmul(s, v) and add to accumulator
 ///
 ///
-LogicalResult reifyAttentionTransform(func::FuncOp funcOp) {
+LogicalResult reifyAttentionTransform(func::FuncOp funcOp,
+                                      std::optional<uint64_t> tileSize) {
   IRRewriter rewriter(funcOp.getContext());
   funcOp.walk([&](IREE::LinalgExt::AttentionOp attnOp) {
-    tileAndDecomposeAttention(attnOp, rewriter);
+    SmallVector<Operation *> ops =
+        tileAndDecomposeAttention(attnOp, rewriter, tileSize);
+    // Carry over discardable attributes (such as lowering configurations) to
+    // the decomposed ops so that they can be tiled further by later passes.
+    SmallVector<NamedAttribute> discardableAttrs;
+    for (NamedAttribute attr : attnOp->getAttrs()) {
+      if (attr.getName() ==
+          IREE::LinalgExt::AttentionOp::getOperandSegmentSizeAttr())
+        continue;
+      discardableAttrs.push_back(attr);
+    }
+    for (Operation *op : ops) {
+      if (!isa<linalg::LinalgOp>(op))
+        continue;
+      for (NamedAttribute attr : discardableAttrs)
+        op->setAttr(attr.getName(), attr.getValue());
+    }
+    rewriter.eraseOp(attnOp);
     return WalkResult::advance();
   });
   return success();
@@ -411,6 +451,11 @@ LogicalResult reifyAttentionTransform(func::FuncOp funcOp) {
 namespace {
 struct TileAndDecomposeAttentionPass
     : public TileAndDecomposeAttentionBase<TileAndDecomposeAttentionPass> {
+  TileAndDecomposeAttentionPass() = default;
+  TileAndDecomposeAttentionPass(uint64_t tileSize) {
+    this->tileSize = tileSize;
+  }
+
   void getDependentDialects(DialectRegistry &registry) const override {
     registry.insert<
         affine::AffineDialect, IREE::LinalgExt::IREELinalgExtDialect,
@@ -424,12 +469,15 @@ struct TileAndDecomposeAttentionPass
 void TileAndDecomposeAttentionPass::runOnOperation() {
   MLIRContext *context = &getContext();
   IRRewriter rewriter(context);
-  if (failed(reifyAttentionTransform(getOperation())))
+  std::optional<uint64_t> optionalTileSize;
+  if (tileSize > 0)
+    optionalTileSize = tileSize;
+  if (failed(reifyAttentionTransform(getOperation(), optionalTileSize)))
     return signalPassFailure();
 }
 
-std::unique_ptr<Pass> createTileAndDecomposeAttentionPass() {
-  return std::make_unique<TileAndDecomposeAttentionPass>();
+std::unique_ptr<Pass> createTileAndDecomposeAttentionPass(uint64_t tileSize) {
+  return std::make_unique<TileAndDecomposeAttentionPass>(tileSize);
 }
 
 } // namespace LinalgExt
@@ -163,3 +163,42 @@ func.func @pack_gemm_fill_dynamic(%arg0 : tensor<?x?xf32>, %arg1 : tensor<?x?xf3
 // CHECK-SAME:       outs(%[[FILL]] :
 //      CHECK:   %[[UNPACK:.+]] = tensor.unpack %[[MMT4D]]
 //      CHECK:   return %[[UNPACK]]
+
+// -----
+
+func.func @pack_batch_gemm(%arg0 : tensor<2x128x256xf32>, %arg1 : tensor<2x256x512xf32>, %arg2 : tensor<2x128x512xf32>) -> tensor<2x128x512xf32> {
+  %0 = iree_linalg_ext.set_encoding %arg0 : tensor<2x128x256xf32> -> tensor<2x128x256xf32, #iree_linalg_ext.encoding<BATCH_MATMUL_F32F32F32_LHS>>
+  %1 = iree_linalg_ext.set_encoding %arg1 : tensor<2x256x512xf32> -> tensor<2x256x512xf32, #iree_linalg_ext.encoding<BATCH_MATMUL_F32F32F32_RHS>>
+  %2 = iree_linalg_ext.set_encoding %arg2 : tensor<2x128x512xf32> -> tensor<2x128x512xf32, #iree_linalg_ext.encoding<BATCH_MATMUL_F32F32F32_RESULT>>
+  %3 = linalg.batch_matmul ins(%0, %1 : tensor<2x128x256xf32, #iree_linalg_ext.encoding<BATCH_MATMUL_F32F32F32_LHS>>, tensor<2x256x512xf32, #iree_linalg_ext.encoding<BATCH_MATMUL_F32F32F32_RHS>>)
+      outs(%2 : tensor<2x128x512xf32, #iree_linalg_ext.encoding<BATCH_MATMUL_F32F32F32_RESULT>>) -> tensor<2x128x512xf32, #iree_linalg_ext.encoding<BATCH_MATMUL_F32F32F32_RESULT>>
+  %4 = iree_linalg_ext.unset_encoding %3 : tensor<2x128x512xf32, #iree_linalg_ext.encoding<BATCH_MATMUL_F32F32F32_RESULT>> -> tensor<2x128x512xf32>
+  return %4 : tensor<2x128x512xf32>
+}
+//  CHECK-DAG: #[[MAP_LHS:.+]] = affine_map<(d0, d1, d2, d3, d4, d5, d6) -> (d0, d1, d3, d4, d6)>
+//  CHECK-DAG: #[[MAP_RHS:.+]] = affine_map<(d0, d1, d2, d3, d4, d5, d6) -> (d0, d2, d3, d5, d6)>
+//  CHECK-DAG: #[[MAP_RESULT:.+]] = affine_map<(d0, d1, d2, d3, d4, d5, d6) -> (d0, d1, d2, d4, d5)>
+//      CHECK: func @pack_batch_gemm(
+// CHECK-SAME:     %[[ARG0:[a-zA-Z0-9]+]]: tensor<2x128x256xf32>
+// CHECK-SAME:     %[[ARG1:[a-zA-Z0-9]+]]: tensor<2x256x512xf32>
+// CHECK-SAME:     %[[ARG2:[a-zA-Z0-9]+]]: tensor<2x128x512xf32>
+//      CHECK:   %[[PACK_LHS:.+]] = tensor.pack
+// CHECK-SAME:     %[[ARG0]] inner_dims_pos = [1, 2] inner_tiles = [8, 4]
+// CHECK-SAME:     tensor<2x128x256xf32> -> tensor<2x16x64x8x4xf32>
+//      CHECK:   %[[PACK_RHS:.+]] = tensor.pack
+// CHECK-SAME:     %[[ARG1]] outer_dims_perm = [0, 2, 1] inner_dims_pos = [2, 1] inner_tiles = [8, 4]
+// CHECK-SAME:     tensor<2x256x512xf32> -> tensor<2x64x64x8x4xf32>
+//      CHECK:   %[[PACK_RESULT:.+]] = tensor.pack
+// CHECK-SAME:     %[[ARG2]] inner_dims_pos = [1, 2] inner_tiles = [8, 8]
+// CHECK-SAME:     tensor<2x128x512xf32> -> tensor<2x16x64x8x8xf32>
+//      CHECK:   %[[BATCH_MMT4D:.+]] = linalg.generic
+// CHECK-SAME:       indexing_maps = [#[[MAP_LHS]], #[[MAP_RHS]], #[[MAP_RESULT]]]
+// CHECK-SAME:       iterator_types = ["parallel", "parallel", "parallel", "reduction", "parallel", "parallel", "reduction"]
+// CHECK-SAME:       ins(%[[PACK_LHS]], %[[PACK_RHS]] :
+// CHECK-SAME:       outs(%[[PACK_RESULT]] :
+//      CHECK:     arith.mulf
+//      CHECK:     arith.addf
+//      CHECK:   %[[UNPACK:.+]] = tensor.unpack %[[BATCH_MMT4D]]
+// CHECK-SAME:     inner_dims_pos = [1, 2] inner_tiles = [8, 8]
+// CHECK-SAME:     tensor<2x16x64x8x8xf32> -> tensor<2x128x512xf32>
+//      CHECK:   return %[[UNPACK]]
@@ -1,4 +1,5 @@
 // RUN: iree-dialects-opt --split-input-file -iree-linalg-ext-tile-and-decompose-attention -cse %s | FileCheck %s
+// RUN: iree-dialects-opt --split-input-file -iree-linalg-ext-tile-and-decompose-attention="tileSize=32" -cse %s | FileCheck %s --check-prefix=TILESIZE
 
 func.func @attention(%query: tensor<192x1024x64xf32>, %key: tensor<192x1024x64xf32>, %value: tensor<192x1024x64xf32>) -> tensor<192x1024x64xf32> {
   %0 = tensor.empty() : tensor<192x1024x64xf32>
@@ -194,3 +195,50 @@ func.func @attention(%query: tensor<?x?x?xf32>, %key: tensor<?x?x?xf32>, %value:
 // CHECK:        }
 // CHECK:        return %[[D1]] : tensor<?x?x?xf32>
 // CHECK:      }
+
+// -----
+
+func.func @attention_kv_tile(%query: tensor<4x64x16xf32>, %key: tensor<4x128x16xf32>, %value: tensor<4x128x16xf32>) -> tensor<4x64x16xf32> {
+  %0 = tensor.empty() : tensor<4x64x16xf32>
+  %1 = iree_linalg_ext.attention ins(%query, %key, %value : tensor<4x64x16xf32>, tensor<4x128x16xf32>, tensor<4x128x16xf32>) outs(%0 : tensor<4x64x16xf32>) -> tensor<4x64x16xf32>
+  return %1 : tensor<4x64x16xf32>
+}
+
+// TILESIZE-LABEL: func.func @attention_kv_tile
+// TILESIZE-SAME:    %[[QUERY:[a-zA-Z0-9_]+]]: tensor<4x64x16xf32>
+// TILESIZE-SAME:    %[[KEY:[a-zA-Z0-9_]+]]: tensor<4x128x16xf32>
+// TILESIZE-SAME:    %[[VALUE:[a-zA-Z0-9_]+]]: tensor<4x128x16xf32>
+// TILESIZE:         scf.for %[[B:[a-zA-Z0-9_]+]] =
+// TILESIZE-DAG:       %[[C32:.+]] = arith.constant 32 : index
+// TILESIZE-DAG:       %[[C128:.+]] = arith.constant 128 : index
+// TILESIZE:           scf.for %[[KV:[a-zA-Z0-9_]+]] = %{{.+}} to %[[C128]] step %[[C32]]
+// TILESIZE-SAME:        -> (tensor<4x64x16xf32>, tensor<64xf32>, tensor<64xf32>)
+// TILESIZE:             tensor.extract_slice %[[KEY]][%[[B]], %[[KV]], 0] [1, 32, 16] [1, 1, 1]
+// TILESIZE-SAME:          : tensor<4x128x16xf32> to tensor<32x16xf32>
+// TILESIZE:             tensor.extract_slice %[[VALUE]][%[[B]], %[[KV]], 0] [1, 32, 16] [1, 1, 1]
+// TILESIZE-SAME:          : tensor<4x128x16xf32> to tensor<32x16xf32>
+// TILESIZE:             tensor.extract_slice %[[QUERY]][%[[B]], 0, 0] [1, 64, 16] [1, 1, 1]
+// TILESIZE-SAME:          : tensor<4x64x16xf32> to tensor<64x16xf32>
+// TILESIZE:             tensor.empty() : tensor<64x32xf32>
+// TILESIZE:             linalg.matmul_transpose_b
+// TILESIZE-SAME:          tensor<64x16xf32>, tensor<32x16xf32>) outs(%{{.+}} : tensor<64x32xf32>)
+// TILESIZE:             linalg.matmul
+// TILESIZE-SAME:          tensor<64x32xf32>, tensor<32x16xf32>) outs(%{{.+}} : tensor<64x16xf32>)
+
+// -----
+
+// Discardable attributes such as lowering configurations are carried over to
+// the decomposed ops.
+
+func.func @attention_attrs(%query: tensor<1x16x8xf32>, %key: tensor<1x16x8xf32>, %value: tensor<1x16x8xf32>) -> tensor<1x16x8xf32> {
+  %0 = tensor.empty() : tensor<1x16x8xf32>
+  %1 = iree_linalg_ext.attention {__test_config = "propagated"} ins(%query, %key, %value : tensor<1x16x8xf32>, tensor<1x16x8xf32>, tensor<1x16x8xf32>) outs(%0 : tensor<1x16x8xf32>) -> tensor<1x16x8xf32>
+  return %1 : tensor<1x16x8xf32>
+}
+
+// CHECK-LABEL: func.func @attention_attrs
+// CHECK-NOT:     iree_linalg_ext.attention
+// CHECK:         linalg.matmul_transpose_b
+// CHECK-SAME:      __test_config = "propagated"
+// CHECK:         linalg.matmul
+// CHECK-SAME:      __test_config = "propagated"
@@ -10,6 +10,12 @@
 #include "iree/base/api.h"
 #include "iree/base/tracing.h"
 
+#if defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_LINUX)
+#include <errno.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif  // IREE_PLATFORM_ANDROID || IREE_PLATFORM_LINUX
+
 //===----------------------------------------------------------------------===//
 // iree_allocator_t (std::allocator-like interface)
 //===----------------------------------------------------------------------===//
@@ -63,6 +69,23 @@ IREE_API_EXPORT void iree_allocator_free(iree_allocator_t allocator,
   }
 }
 
+IREE_API_EXPORT iree_status_t iree_allocator_bind(iree_allocator_t allocator,
+                                                  void* ptr,
+                                                  iree_host_size_t byte_length,
+                                                  uint32_t node_id) {
+  if (IREE_UNLIKELY(!allocator.ctl)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "allocator has no control routine");
+  }
+  if (!ptr || !byte_length) return iree_ok_status();
+  iree_allocator_bind_params_t params = {
+      .byte_length = byte_length,
+      .node_id = node_id,
+  };
+  return allocator.ctl(allocator.self, IREE_ALLOCATOR_COMMAND_BIND, &params,
+                       &ptr);
+}
+
 static iree_status_t iree_allocator_system_alloc(
     iree_allocator_command_t command,
     const iree_allocator_alloc_params_t* params, void** inout_ptr) {
@@ -116,6 +139,70 @@ static iree_status_t iree_allocator_system_free(void** inout_ptr) {
   return iree_ok_status();
 }
 
+#if (defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_LINUX)) && \
+    defined(SYS_mbind)
+
+// Values from linux/mempolicy.h; defined here to avoid a libnuma dependency.
+#define IREE_MPOL_PREFERRED 1
+#define IREE_MPOL_MF_MOVE (1 << 1)
+
+static iree_status_t iree_allocator_system_bind(
+    const iree_allocator_bind_params_t* params, void** inout_ptr) {
+  IREE_ASSERT_ARGUMENT(params);
+  IREE_ASSERT_ARGUMENT(inout_ptr);
+
+  // Only whole pages within the range can be bound; allocations smaller than a
+  // page are left wherever they were first touched.
+  const uintptr_t page_size = (uintptr_t)sysconf(_SC_PAGESIZE);
+  const uintptr_t range_begin = (uintptr_t)*inout_ptr;
+  const uintptr_t range_end = range_begin + params->byte_length;
+  const uintptr_t page_begin = (range_begin + page_size - 1) & ~(page_size - 1);
+  const uintptr_t page_end = range_end & ~(page_size - 1);
+  if (page_end <= page_begin) return iree_ok_status();
+
+  unsigned long node_mask[1024 / (sizeof(unsigned long) * 8)] = {0};
+  const uint32_t node_bit_count = sizeof(node_mask) * 8;
+  if (params->node_id >= node_bit_count) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "NUMA node ID %u out of range", params->node_id);
+  }
+  const uint32_t bits_per_word = sizeof(node_mask[0]) * 8;
+  node_mask[params->node_id / bits_per_word] |=
+      1ul << (params->node_id % bits_per_word);
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, params->node_id);
+
+  // MPOL_PREFERRED is used instead of MPOL_BIND so that allocations fall back
+  // to other nodes instead of failing when the requested node is exhausted.
+  // NOTE: the kernel ignores the last bit of the mask (maxnode is exclusive).
+  iree_status_t status = iree_ok_status();
+  if (syscall(SYS_mbind, (void*)page_begin, page_end - page_begin,
+              IREE_MPOL_PREFERRED, node_mask, node_bit_count + 1,
+              IREE_MPOL_MF_MOVE) != 0) {
+    const int error = errno;
+    status = error == ENOSYS
+                 ? iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                                    "NUMA binding not supported by the kernel")
+                 : iree_make_status(iree_status_code_from_errno(error),
+                                    "mbind failed to bind to NUMA node %u",
+                                    params->node_id);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+#else
+
+static iree_status_t iree_allocator_system_bind(
+    const iree_allocator_bind_params_t* params, void** inout_ptr) {
+  return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                          "NUMA binding not supported on this platform");
+}
+
+#endif  // IREE_PLATFORM_ANDROID || IREE_PLATFORM_LINUX
+
 IREE_API_EXPORT iree_status_t
 iree_allocator_system_ctl(void* self, iree_allocator_command_t command,
                           const void* params, void** inout_ptr) {
@@ -127,6 +214,9 @@ iree_allocator_system_ctl(void* self, iree_allocator_command_t command,
           command, (const iree_allocator_alloc_params_t*)params, inout_ptr);
     case IREE_ALLOCATOR_COMMAND_FREE:
       return iree_allocator_system_free(inout_ptr);
+    case IREE_ALLOCATOR_COMMAND_BIND:
+      return iree_allocator_system_bind(
+          (const iree_allocator_bind_params_t*)params, inout_ptr);
     default:
       return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
                               "unsupported system allocator command");
@@ -155,11 +155,16 @@ typedef enum iree_allocator_command_e {
   //   inout_ptr: pointer to free
   IREE_ALLOCATOR_COMMAND_FREE = 3,
 
-  // TODO(benvanik): add optional IREE_ALLOCATOR_COMMAND_BIND like mbind:
-  // https://man7.org/linux/man-pages/man2/mbind.2.html
-  // This would take a pointer/length and a NUMA node ID to bind the memory to.
-  // We may want flags for controlling whether this is a new allocation getting
-  // bound or an existing one that is migrating to use MPOL_MF_MOVE.
+  // Binds the pages backing a previously-allocated range of memory to a NUMA
+  // node, like mbind: https://man7.org/linux/man-pages/man2/mbind.2.html
+  // Pages that have already been touched are migrated to the node. Binding is
+  // a placement hint: allocators that do not support it return
+  // IREE_STATUS_UNIMPLEMENTED and callers are expected to continue without it.
+  //
+  // iree_allocator_ctl_fn_t:
+  //   params: iree_allocator_bind_params_t
+  //   inout_ptr: pointer to the base of the range to bind
+  IREE_ALLOCATOR_COMMAND_BIND = 4,
 } iree_allocator_command_t;
 
 // Parameters for various allocation commands.
@@ -169,6 +174,15 @@ typedef struct iree_allocator_alloc_params_t {
   iree_host_size_t byte_length;
 } iree_allocator_alloc_params_t;
 
+// Parameters for IREE_ALLOCATOR_COMMAND_BIND.
+typedef struct iree_allocator_bind_params_t {
+  // Length, in bytes, of the range to bind starting at the provided pointer.
+  // Only whole pages contained within the range are bound.
+  iree_host_size_t byte_length;
+  // NUMA node ID the pages should be placed on.
+  uint32_t node_id;
+} iree_allocator_bind_params_t;
+
 // Function pointer for an iree_allocator_t control function.
 // |command| provides the operation to perform. Optionally some commands may use
 // |params| to pass additional operation-specific parameters. |inout_ptr| usage
@@ -217,6 +231,15 @@ iree_allocator_clone(iree_allocator_t allocator,
 // Frees a previously-allocated block of memory to the given allocator.
 IREE_API_EXPORT void iree_allocator_free(iree_allocator_t allocator, void* ptr);
 
+// Binds the pages contained within the |byte_length| bytes starting at |ptr| to
+// the NUMA node |node_id|. |ptr| must have been allocated from |allocator|.
+// Returns IREE_STATUS_UNIMPLEMENTED if the allocator or platform does not
+// support binding; callers should treat binding as a hint and continue.
+IREE_API_EXPORT iree_status_t iree_allocator_bind(iree_allocator_t allocator,
+                                                  void* ptr,
+                                                  iree_host_size_t byte_length,
+                                                  uint32_t node_id);
+
 // Default C allocator controller using malloc/free.
 IREE_API_EXPORT iree_status_t
 iree_allocator_system_ctl(void* self, iree_allocator_command_t command,
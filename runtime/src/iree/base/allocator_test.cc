@@ -0,0 +1,145 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <cstdint>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+#if defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_LINUX)
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif  // IREE_PLATFORM_ANDROID || IREE_PLATFORM_LINUX
+
+namespace iree {
+namespace {
+
+using iree::testing::status::StatusIs;
+
+//===----------------------------------------------------------------------===//
+// iree_allocator_bind
+//===----------------------------------------------------------------------===//
+
+// Allocator that forwards to the system allocator and records bind requests.
+struct RecordingAllocator {
+  struct Bind {
+    void* ptr;
+    iree_host_size_t byte_length;
+    uint32_t node_id;
+  };
+  std::vector<Bind> binds;
+
+  iree_allocator_t allocator() { return {this, Ctl}; }
+
+  static iree_status_t Ctl(void* self, iree_allocator_command_t command,
+                           const void* params, void** inout_ptr) {
+    if (command != IREE_ALLOCATOR_COMMAND_BIND) {
+      return iree_allocator_system_ctl(NULL, command, params, inout_ptr);
+    }
+    const auto* bind_params =
+        reinterpret_cast<const iree_allocator_bind_params_t*>(params);
+    reinterpret_cast<RecordingAllocator*>(self)->binds.push_back(
+        {*inout_ptr, bind_params->byte_length, bind_params->node_id});
+    return iree_ok_status();
+  }
+};
+
+TEST(AllocatorTest, BindRequiresControlRoutine) {
+  char storage[16];
+  EXPECT_THAT(Status(iree_allocator_bind(iree_allocator_null(), storage,
+                                         sizeof(storage), 0)),
+              StatusIs(StatusCode::kInvalidArgument));
+}
+
+TEST(AllocatorTest, BindEmptyRangeIsNoOp) {
+  RecordingAllocator recorder;
+  char storage[16];
+  IREE_EXPECT_OK(iree_allocator_bind(recorder.allocator(), NULL, 16, 1));
+  IREE_EXPECT_OK(iree_allocator_bind(recorder.allocator(), storage, 0, 1));
+  EXPECT_TRUE(recorder.binds.empty());
+}
+
+TEST(AllocatorTest, BindForwardsToControlRoutine) {
+  RecordingAllocator recorder;
+  char storage[16];
+  IREE_ASSERT_OK(
+      iree_allocator_bind(recorder.allocator(), storage, sizeof(storage), 3));
+  ASSERT_EQ(recorder.binds.size(), 1u);
+  EXPECT_EQ(recorder.binds[0].ptr, storage);
+  EXPECT_EQ(recorder.binds[0].byte_length, sizeof(storage));
+  EXPECT_EQ(recorder.binds[0].node_id, 3u);
+}
+
+#if (defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_LINUX)) && \
+    defined(SYS_mbind) && defined(SYS_get_mempolicy)
+
+// Values from linux/mempolicy.h.
+#define TEST_MPOL_PREFERRED 1
+#define TEST_MPOL_F_ADDR (1 << 1)
+
+class SystemAllocatorBindTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    page_size_ = (iree_host_size_t)sysconf(_SC_PAGESIZE);
+    IREE_ASSERT_OK(iree_allocator_malloc_aligned(
+        iree_allocator_system(), 4 * page_size_, page_size_, 0, &ptr_));
+  }
+  void TearDown() override {
+    iree_allocator_free_aligned(iree_allocator_system(), ptr_);
+  }
+  iree_host_size_t page_size_ = 0;
+  void* ptr_ = NULL;
+};
+
+TEST_F(SystemAllocatorBindTest, BindsWholePages) {
+  iree_status_t status =
+      iree_allocator_bind(iree_allocator_system(), ptr_, 4 * page_size_, 0);
+  if (iree_status_is_unimplemented(status)) {
+    iree_status_ignore(status);
+    GTEST_SKIP() << "NUMA binding not supported by the kernel";
+  }
+  IREE_ASSERT_OK(status);
+
+  // The policy of each page in the range must now prefer node 0.
+  for (iree_host_size_t i = 0; i < 4; ++i) {
+    int mode = -1;
+    unsigned long node_mask[1024 / (sizeof(unsigned long) * 8)] = {0};
+    ASSERT_EQ(0, syscall(SYS_get_mempolicy, &mode, node_mask,
+                         sizeof(node_mask) * 8, (uint8_t*)ptr_ + i * page_size_,
+                         TEST_MPOL_F_ADDR));
+    EXPECT_EQ(mode, TEST_MPOL_PREFERRED);
+    EXPECT_EQ(node_mask[0] & 1ul, 1ul);
+  }
+}
+
+TEST_F(SystemAllocatorBindTest, PartialPagesAreSkipped) {
+  // Less than a page starting mid-page contains no whole page to bind.
+  IREE_EXPECT_OK(iree_allocator_bind(iree_allocator_system(),
+                                     (uint8_t*)ptr_ + 16, page_size_ - 32,
+                                     /*node_id=*/100000));
+}
+
+TEST_F(SystemAllocatorBindTest, NodeOutOfRange) {
+  EXPECT_THAT(Status(iree_allocator_bind(iree_allocator_system(), ptr_,
+                                         4 * page_size_, /*node_id=*/100000)),
+              StatusIs(StatusCode::kOutOfRange));
+}
+
+#else
+
+TEST(SystemAllocatorBindTest, Unimplemented) {
+  char storage[16];
+  EXPECT_THAT(Status(iree_allocator_bind(iree_allocator_system(), storage,
+                                         sizeof(storage), 0)),
+              StatusIs(StatusCode::kUnimplemented));
+}
+
+#endif  // IREE_PLATFORM_ANDROID || IREE_PLATFORM_LINUX
+
+}  // namespace
+}  // namespace iree
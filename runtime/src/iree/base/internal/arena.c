@@ -10,6 +10,7 @@
 #include <string.h>
 
 #include "iree/base/internal/debugging.h"
+#include "iree/base/internal/threading.h"
 
 //===----------------------------------------------------------------------===//
 // iree_arena_block_pool_t
@@ -48,6 +49,18 @@ void iree_arena_block_pool_trim(iree_arena_block_pool_t* block_pool) {
   iree_atomic_arena_block_slist_flush(
       &block_pool->available_slist,
       IREE_ATOMIC_SLIST_FLUSH_ORDER_APPROXIMATE_LIFO, &head, NULL);
+
+  // A concurrent acquire may have loaded one of the flushed blocks as the list
+  // head before the flush and still be reading its next pointer. Acquires that
+  // start after the flush can no longer observe the flushed blocks so we only
+  // need to wait for the ones in flight to drain before freeing.
+  if (head) {
+    while (iree_atomic_load_int32(&block_pool->pending_pop_count,
+                                  iree_memory_order_seq_cst) != 0) {
+      iree_thread_yield();
+    }
+  }
+
   while (head) {
     void* ptr = (uint8_t*)head - block_pool->usable_block_size;
     head = head->next;
@@ -62,8 +75,13 @@ iree_status_t iree_arena_block_pool_acquire(iree_arena_block_pool_t* block_pool,
                                             void** out_ptr) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  // Trim waits for pending pops before freeing blocks they may be reading.
+  iree_atomic_fetch_add_int32(&block_pool->pending_pop_count, 1,
+                              iree_memory_order_seq_cst);
   iree_arena_block_t* block =
       iree_atomic_arena_block_slist_pop(&block_pool->available_slist);
+  iree_atomic_fetch_sub_int32(&block_pool->pending_pop_count, 1,
+                              iree_memory_order_release);
 
   if (!block) {
     // No blocks available; allocate one now.
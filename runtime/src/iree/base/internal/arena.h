@@ -62,6 +62,10 @@ typedef struct iree_arena_block_pool_t {
   iree_allocator_t block_allocator;
   // Linked list of free blocks (LIFO).
   iree_atomic_arena_block_slist_t available_slist;
+  // Number of acquires currently popping from available_slist. The lock-free
+  // pop may read the next pointer of a block that another thread has removed
+  // so trims wait for this to reach zero before freeing flushed blocks.
+  iree_atomic_int32_t pending_pop_count;
 } iree_arena_block_pool_t;
 
 // Initializes a new block pool in |out_block_pool|.
@@ -78,7 +82,9 @@ void iree_arena_block_pool_initialize(iree_host_size_t total_block_size,
 void iree_arena_block_pool_deinitialize(iree_arena_block_pool_t* block_pool);
 
 // Trims the pool by freeing unused blocks back to the allocator.
-// Acquired blocks are not freed and remain valid.
+// Acquired blocks are not freed and remain valid. May be called concurrently
+// with acquire and release; the trim waits for any in-flight acquires that may
+// be reading the blocks it removed before freeing them.
 void iree_arena_block_pool_trim(iree_arena_block_pool_t* block_pool);
 
 // Acquires a single block from the pool and returns it in |out_block|.
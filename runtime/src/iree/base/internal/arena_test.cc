@@ -0,0 +1,71 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/base/internal/arena.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace {
+
+TEST(ArenaBlockPool, AcquireRelease) {
+  iree_arena_block_pool_t block_pool;
+  iree_arena_block_pool_initialize(256, iree_allocator_system(), &block_pool);
+
+  iree_arena_block_t* block = NULL;
+  void* ptr = NULL;
+  IREE_ASSERT_OK(iree_arena_block_pool_acquire(&block_pool, &block, &ptr));
+  EXPECT_EQ(ptr, iree_arena_block_ptr(&block_pool, block));
+  iree_arena_block_pool_release(&block_pool, block, block);
+
+  // The released block is reused.
+  iree_arena_block_t* reused_block = NULL;
+  IREE_ASSERT_OK(
+      iree_arena_block_pool_acquire(&block_pool, &reused_block, &ptr));
+  EXPECT_EQ(block, reused_block);
+  iree_arena_block_pool_release(&block_pool, reused_block, reused_block);
+
+  iree_arena_block_pool_deinitialize(&block_pool);
+}
+
+// Trims race with acquires that may be reading the next pointer of a block
+// being freed. Run under ASAN to catch use-after-free.
+TEST(ArenaBlockPool, ConcurrentTrimAcquire) {
+  iree_arena_block_pool_t block_pool;
+  iree_arena_block_pool_initialize(256, iree_allocator_system(), &block_pool);
+
+  std::atomic<bool> done{false};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&]() {
+      while (!done.load(std::memory_order_relaxed)) {
+        iree_arena_block_t* blocks[4] = {NULL};
+        void* ptr = NULL;
+        for (auto& block : blocks) {
+          IREE_ASSERT_OK(
+              iree_arena_block_pool_acquire(&block_pool, &block, &ptr));
+        }
+        for (auto* block : blocks) {
+          iree_arena_block_pool_release(&block_pool, block, block);
+        }
+      }
+    });
+  }
+  for (int i = 0; i < 20000; ++i) {
+    iree_arena_block_pool_trim(&block_pool);
+    if ((i % 64) == 0) std::this_thread::yield();
+  }
+  done = true;
+  for (auto& thread : threads) thread.join();
+
+  iree_arena_block_pool_deinitialize(&block_pool);
+}
+
+}  // namespace
@@ -10,10 +10,172 @@
 
 #include "iree/base/attributes.h"
 
-// TODO(benvanik): add TSAN annotations when switched to atomics:
+#if IREE_ATOMIC_SLIST_LOCK_FREE && defined(IREE_COMPILER_MSVC)
+#include <intrin.h>
+#endif  // IREE_ATOMIC_SLIST_LOCK_FREE && IREE_COMPILER_MSVC
+
+// TODO(benvanik): add TSAN annotations so that the lock-free implementation
+// can be used when TSAN is enabled:
 // https://github.com/gcc-mirror/gcc/blob/master/libsanitizer/include/sanitizer/tsan_interface_atomic.h
 // https://reviews.llvm.org/D18500
 
+#if IREE_ATOMIC_SLIST_LOCK_FREE
+
+//===----------------------------------------------------------------------===//
+// Lock-free implementation
+//===----------------------------------------------------------------------===//
+
+// A snapshot of iree_atomic_slist_head_t.
+typedef struct iree_atomic_slist_head_value_t {
+  uintptr_t entry;  // iree_atomic_slist_entry_t*
+  uintptr_t tag;
+} iree_atomic_slist_head_value_t;
+
+// Loads the list head.
+// The two halves are loaded independently and may be torn if another thread
+// modifies the list concurrently. That's fine as all modifications are done
+// with a CAS that compares both halves and fails on any torn value.
+static inline iree_atomic_slist_head_value_t iree_atomic_slist_load_head(
+    iree_atomic_slist_t* list) {
+  iree_atomic_slist_head_value_t value;
+  value.tag = (uintptr_t)iree_atomic_load_intptr(&list->head.tag,
+                                                 iree_memory_order_acquire);
+  value.entry = (uintptr_t)iree_atomic_load_intptr(&list->head.entry,
+                                                   iree_memory_order_acquire);
+  return value;
+}
+
+// Replaces the list head with |desired| if it is equal to |expected|.
+// Returns true if the head was replaced. On failure |expected| is updated to
+// the head value observed by the CAS. All variants are full barriers.
+static inline bool iree_atomic_slist_compare_exchange_head(
+    iree_atomic_slist_t* list, iree_atomic_slist_head_value_t* expected,
+    iree_atomic_slist_head_value_t desired) {
+#if defined(IREE_COMPILER_MSVC) && IREE_PTR_SIZE == 8
+  __int64 comparand[2] = {(__int64)expected->entry, (__int64)expected->tag};
+  const bool did_exchange =
+      _InterlockedCompareExchange128((volatile __int64*)&list->head,
+                                     (__int64)desired.tag,
+                                     (__int64)desired.entry, comparand) != 0;
+  expected->entry = (uintptr_t)comparand[0];
+  expected->tag = (uintptr_t)comparand[1];
+  return did_exchange;
+#elif defined(IREE_COMPILER_MSVC)
+  const __int64 comparand =
+      (__int64)(((uint64_t)expected->tag << 32) | expected->entry);
+  const __int64 exchange =
+      (__int64)(((uint64_t)desired.tag << 32) | desired.entry);
+  const __int64 previous = _InterlockedCompareExchange64(
+      (volatile __int64*)&list->head, exchange, comparand);
+  expected->entry = (uintptr_t)(uint32_t)previous;
+  expected->tag = (uintptr_t)(uint32_t)((uint64_t)previous >> 32);
+  return previous == comparand;
+#elif defined(IREE_ARCH_X86_64)
+  // Every x86-64 CPU that can run IREE has cmpxchg16b but compilers only emit
+  // it inline when targeting -mcx16 and otherwise call into libatomic.
+  bool did_exchange;
+  __asm__ __volatile__("lock cmpxchg16b (%[head])\n\tsete %[did_exchange]"
+                       : [did_exchange] "=q"(did_exchange),
+                         "+a"(expected->entry), "+d"(expected->tag)
+                       : [head] "r"(&list->head), "b"(desired.entry),
+                         "c"(desired.tag)
+                       : "cc", "memory");
+  return did_exchange;
+#elif IREE_PTR_SIZE == 8
+  const unsigned __int128 comparand =
+      ((unsigned __int128)expected->tag << 64) | expected->entry;
+  const unsigned __int128 exchange =
+      ((unsigned __int128)desired.tag << 64) | desired.entry;
+  const unsigned __int128 previous = __sync_val_compare_and_swap(
+      (unsigned __int128*)&list->head, comparand, exchange);
+  expected->entry = (uintptr_t)previous;
+  expected->tag = (uintptr_t)(previous >> 64);
+  return previous == comparand;
+#else
+  const uint64_t comparand = ((uint64_t)expected->tag << 32) | expected->entry;
+  const uint64_t exchange = ((uint64_t)desired.tag << 32) | desired.entry;
+  const uint64_t previous = __sync_val_compare_and_swap(
+      (uint64_t*)&list->head, comparand, exchange);
+  expected->entry = (uintptr_t)(uint32_t)previous;
+  expected->tag = (uintptr_t)(uint32_t)(previous >> 32);
+  return previous == comparand;
+#endif  // IREE_COMPILER_* / IREE_ARCH_*
+}
+
+void iree_atomic_slist_initialize(iree_atomic_slist_t* out_list) {
+  memset(out_list, 0, sizeof(*out_list));
+}
+
+void iree_atomic_slist_deinitialize(iree_atomic_slist_t* list) {
+  // TODO(benvanik): assert empty.
+  memset(list, 0, sizeof(*list));
+}
+
+void iree_atomic_slist_concat(iree_atomic_slist_t* list,
+                              iree_atomic_slist_entry_t* head,
+                              iree_atomic_slist_entry_t* tail) {
+  if (IREE_UNLIKELY(!head)) return;
+  iree_atomic_slist_head_value_t expected = iree_atomic_slist_load_head(list);
+  iree_atomic_slist_head_value_t desired;
+  do {
+    tail->next = (iree_atomic_slist_entry_t*)expected.entry;
+    desired.entry = (uintptr_t)head;
+    desired.tag = expected.tag + 1;
+  } while (!iree_atomic_slist_compare_exchange_head(list, &expected, desired));
+}
+
+void iree_atomic_slist_push(iree_atomic_slist_t* list,
+                            iree_atomic_slist_entry_t* entry) {
+  iree_atomic_slist_concat(list, entry, entry);
+}
+
+void iree_atomic_slist_push_unsafe(iree_atomic_slist_t* list,
+                                   iree_atomic_slist_entry_t* entry) {
+  // NOTE: no other thread may be accessing the list so the head is updated
+  // without a CAS and the tag is left as-is.
+  entry->next = (iree_atomic_slist_entry_t*)iree_atomic_load_intptr(
+      &list->head.entry, iree_memory_order_relaxed);
+  iree_atomic_store_intptr(&list->head.entry, (intptr_t)entry,
+                           iree_memory_order_relaxed);
+}
+
+iree_atomic_slist_entry_t* iree_atomic_slist_pop(iree_atomic_slist_t* list) {
+  iree_atomic_slist_head_value_t expected = iree_atomic_slist_load_head(list);
+  iree_atomic_slist_head_value_t desired;
+  do {
+    if (!expected.entry) return NULL;
+    // NOTE: the entry may have been popped by another thread since the head
+    // was loaded, in which case its next pointer may be garbage. The tag will
+    // have changed and the CAS will fail so the value is never used.
+    iree_atomic_slist_entry_t* entry =
+        (iree_atomic_slist_entry_t*)expected.entry;
+    desired.entry = (uintptr_t)entry->next;
+    desired.tag = expected.tag + 1;
+  } while (!iree_atomic_slist_compare_exchange_head(list, &expected, desired));
+  iree_atomic_slist_entry_t* entry = (iree_atomic_slist_entry_t*)expected.entry;
+  entry->next = NULL;
+  return entry;
+}
+
+// Exchanges the list head with NULL to steal the entire list.
+static iree_atomic_slist_entry_t* iree_atomic_slist_take_all(
+    iree_atomic_slist_t* list) {
+  iree_atomic_slist_head_value_t expected = iree_atomic_slist_load_head(list);
+  iree_atomic_slist_head_value_t desired;
+  do {
+    if (!expected.entry) return NULL;
+    desired.entry = 0;
+    desired.tag = expected.tag + 1;
+  } while (!iree_atomic_slist_compare_exchange_head(list, &expected, desired));
+  return (iree_atomic_slist_entry_t*)expected.entry;
+}
+
+#else
+
+//===----------------------------------------------------------------------===//
+// Mutex-based fallback
+//===----------------------------------------------------------------------===//
+
 void iree_atomic_slist_initialize(iree_atomic_slist_t* out_list) {
   memset(out_list, 0, sizeof(*out_list));
   iree_slim_mutex_initialize(&out_list->mutex);
@@ -44,8 +206,7 @@ void iree_atomic_slist_push(iree_atomic_slist_t* list,
 
 void iree_atomic_slist_push_unsafe(iree_atomic_slist_t* list,
                                    iree_atomic_slist_entry_t* entry) {
-  // NOTE: no lock is held here and no atomic operation will be used when this
-  // is actually made atomic.
+  // NOTE: no lock is held here and no atomic operation is used.
   entry->next = list->head;
   list->head = entry;
 }
@@ -61,16 +222,25 @@ iree_atomic_slist_entry_t* iree_atomic_slist_pop(iree_atomic_slist_t* list) {
   return entry;
 }
 
-bool iree_atomic_slist_flush(iree_atomic_slist_t* list,
-                             iree_atomic_slist_flush_order_t flush_order,
-                             iree_atomic_slist_entry_t** out_head,
-                             iree_atomic_slist_entry_t** out_tail) {
-  // Exchange list head with NULL to steal the entire list. The list will be in
-  // the native LIFO order of the slist.
+// Exchanges the list head with NULL to steal the entire list.
+static iree_atomic_slist_entry_t* iree_atomic_slist_take_all(
+    iree_atomic_slist_t* list) {
   iree_slim_mutex_lock(&list->mutex);
   iree_atomic_slist_entry_t* head = list->head;
   list->head = NULL;
   iree_slim_mutex_unlock(&list->mutex);
+  return head;
+}
+
+#endif  // IREE_ATOMIC_SLIST_LOCK_FREE
+
+bool iree_atomic_slist_flush(iree_atomic_slist_t* list,
+                             iree_atomic_slist_flush_order_t flush_order,
+                             iree_atomic_slist_entry_t** out_head,
+                             iree_atomic_slist_entry_t** out_tail) {
+  // Steal the entire list. The list will be in the native LIFO order of the
+  // slist.
+  iree_atomic_slist_entry_t* head = iree_atomic_slist_take_all(list);
   if (!head) return false;
 
   switch (flush_order) {
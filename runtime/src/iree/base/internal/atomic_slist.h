@@ -32,6 +32,51 @@ typedef struct iree_atomic_slist_entry_t {
   struct iree_atomic_slist_entry_t* next;
 } iree_atomic_slist_entry_t;
 
+// Whether the list is implemented with a lock-free double-pointer-width
+// compare-and-swap. This requires either a 128-bit CAS on 64-bit targets
+// (cmpxchg16b on x86-64, LDXP/STXP or CASP on arm64) or a 64-bit CAS on 32-bit
+// targets. Builds can force the mutex-based fallback by defining this to 0.
+//
+// ThreadSanitizer does not see through the inline assembly used on some targets
+// and would report the (benign) racy reads of entry next pointers so the
+// fallback is used when it is enabled. GCC does not support __has_feature
+// before GCC 14 and so only defines __SANITIZE_THREAD__.
+#if !defined(IREE_ATOMIC_SLIST_LOCK_FREE)
+#if IREE_SYNCHRONIZATION_DISABLE_UNSAFE || defined(IREE_SANITIZER_THREAD) || \
+    defined(__SANITIZE_THREAD__)
+#define IREE_ATOMIC_SLIST_LOCK_FREE 0
+#elif defined(IREE_COMPILER_MSVC) && \
+    (defined(IREE_ARCH_X86_64) || defined(IREE_ARCH_ARM_64) || \
+     defined(IREE_ARCH_X86_32))
+#define IREE_ATOMIC_SLIST_LOCK_FREE 1
+#elif defined(IREE_COMPILER_GCC_COMPAT) && defined(IREE_ARCH_X86_64)
+#define IREE_ATOMIC_SLIST_LOCK_FREE 1
+#elif defined(IREE_COMPILER_GCC_COMPAT) && IREE_PTR_SIZE == 8 && \
+    defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_16)
+#define IREE_ATOMIC_SLIST_LOCK_FREE 1
+#elif defined(IREE_COMPILER_GCC_COMPAT) && IREE_PTR_SIZE == 4 && \
+    defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_8)
+#define IREE_ATOMIC_SLIST_LOCK_FREE 1
+#else
+#define IREE_ATOMIC_SLIST_LOCK_FREE 0
+#endif  // IREE_COMPILER_* / IREE_ARCH_*
+#endif  // !IREE_ATOMIC_SLIST_LOCK_FREE
+
+#if IREE_ATOMIC_SLIST_LOCK_FREE
+
+// DO NOT USE: implementation detail.
+// The head entry of the list and a tag that is incremented on every change to
+// the head. Both are updated together with a single CAS.
+typedef struct iree_atomic_slist_head_t {
+  iree_atomic_intptr_t entry;  // iree_atomic_slist_entry_t*
+  iree_atomic_intptr_t tag;
+} iree_atomic_slist_head_t;
+
+// The double-pointer-width CAS requires natural alignment of the head.
+#define IREE_ATOMIC_SLIST_HEAD_ALIGNMENT (2 * IREE_PTR_SIZE)
+
+#endif  // IREE_ATOMIC_SLIST_LOCK_FREE
+
 // Lightweight contention-avoiding singly linked list.
 // This models optimistically-ordered LIFO behavior (stack push/pop) using
 // atomic primitives.
@@ -72,15 +117,30 @@ typedef struct iree_atomic_slist_entry_t {
 //
 // WARNING: this is an extremely sharp pufferfish-esque API. Don't use it. 🐡
 //
+// When IREE_ATOMIC_SLIST_LOCK_FREE is 1 the list head is a pointer and a
+// modification tag that are updated together with a double-pointer-width
+// compare-and-swap. The tag protects against ABA: a pop that raced with another
+// thread popping and re-pushing the same entry fails its CAS and retries
+// instead of installing a stale next pointer. Like the Windows SList a pop may
+// read the next pointer of an entry that another thread has just popped: the
+// memory of entries must remain readable for as long as any thread may be
+// popping from the list (entries may be reused but not freed back to the
+// system).
+//
+// Platforms without a suitable CAS fall back to a mutex-guarded list.
+//
 // TODO(benvanik): verify behavior (and worthwhileness) of supporting platform
 // primitives. The benefit of something like OSAtomicEnqueue/Dequeue is that it
 // may have better tooling (TSAN), special intrinsic handling in the compiler,
 // etc. That said, the Windows Interlocked* variants don't seem to. Having a
 // single heavily tested implementation seems more worthwhile than several.
 typedef iree_alignas(iree_max_align_t) struct {
-  // TODO(benvanik): spend some time golfing this. Unblocking myself for now :)
+#if IREE_ATOMIC_SLIST_LOCK_FREE
+  iree_alignas(IREE_ATOMIC_SLIST_HEAD_ALIGNMENT) iree_atomic_slist_head_t head;
+#else
   iree_slim_mutex_t mutex;
   iree_atomic_slist_entry_t* head;
+#endif  // IREE_ATOMIC_SLIST_LOCK_FREE
 } iree_atomic_slist_t;
 
 // Initializes an slist handle to an empty list.
@@ -0,0 +1,116 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <cstddef>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "iree/base/internal/atomic_slist.h"
+
+namespace {
+
+//==============================================================================
+// Inlined timing utils
+//==============================================================================
+
+void SpinDelay(int count, int* data) {
+  // This emulates work done between list operations (like executing a task
+  // that was popped from a queue).
+  for (int i = 0; i < count * 10; ++i) {
+    ++(*data);
+    benchmark::DoNotOptimize(*data);
+  }
+}
+
+//==============================================================================
+// iree_atomic_slist_t
+//==============================================================================
+
+struct Entry {
+  iree_atomic_slist_intrusive_ptr_t slist_next = NULL;
+  int value = 0;
+};
+IREE_TYPED_ATOMIC_SLIST_WRAPPER(entry, Entry, offsetof(Entry, slist_next));
+
+// A list shared across all benchmark threads that starts with enough entries
+// that no thread ever finds it empty.
+struct SharedList {
+  entry_slist_t list;
+  std::vector<Entry> storage;
+  SharedList() : storage(4096) {
+    entry_slist_initialize(&list);
+    for (auto& entry : storage) entry_slist_push(&list, &entry);
+  }
+};
+
+// Models a free list: every thread acquires an entry, uses it, and releases it
+// back to the list. This is the usage pattern of the task and block pools.
+void BM_PopPush(benchmark::State& state) {
+  static auto* shared = new SharedList();
+  int local = 0;
+  for (auto _ : state) {
+    Entry* entry = entry_slist_pop(&shared->list);
+    SpinDelay(static_cast<int>(state.range(0)), &local);
+    if (entry) entry_slist_push(&shared->list, entry);
+  }
+}
+
+BENCHMARK(BM_PopPush)
+    ->UseRealTime()
+    // ThreadPerCpu poorly handles non-power-of-two CPU counts.
+    ->Threads(1)
+    ->Threads(2)
+    ->Threads(4)
+    ->Threads(8)
+    ->Threads(16)
+    ->Threads(32)
+    ->Threads(64)
+    // 0 is all list operations, 10 adds a small amount of work per entry.
+    ->Arg(0)
+    ->Arg(10);
+
+// Models a multi-producer/multi-consumer mailbox: half of the threads push
+// entries they own and the other half flush them in batches and push them back.
+// This is the usage pattern of worker mailboxes and the executor incoming
+// queue.
+void BM_ProducerConsumer(benchmark::State& state) {
+  static auto* shared = new SharedList();
+  static auto* mailbox = ([]() -> entry_slist_t* {
+    auto list = new entry_slist_t();
+    entry_slist_initialize(list);
+    return list;
+  })();
+  const bool is_producer = (state.thread_index() % 2) == 0;
+  int local = 0;
+  for (auto _ : state) {
+    if (is_producer) {
+      Entry* entry = entry_slist_pop(&shared->list);
+      if (entry) entry_slist_push(mailbox, entry);
+    } else {
+      Entry* head = NULL;
+      Entry* tail = NULL;
+      if (entry_slist_flush(mailbox,
+                            IREE_ATOMIC_SLIST_FLUSH_ORDER_APPROXIMATE_FIFO,
+                            &head, &tail)) {
+        entry_slist_concat(&shared->list, head, tail);
+      }
+    }
+    SpinDelay(static_cast<int>(state.range(0)), &local);
+  }
+}
+
+BENCHMARK(BM_ProducerConsumer)
+    ->UseRealTime()
+    ->Threads(2)
+    ->Threads(4)
+    ->Threads(8)
+    ->Threads(16)
+    ->Threads(32)
+    ->Threads(64)
+    ->Arg(0)
+    ->Arg(10);
+
+}  // namespace
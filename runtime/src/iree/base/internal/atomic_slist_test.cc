@@ -6,6 +6,7 @@
 
 #include "iree/base/internal/atomic_slist.h"
 
+#include <thread>
 #include <vector>
 
 #include "iree/testing/gtest.h"
@@ -182,4 +183,50 @@ TEST(AtomicSList, FlushFIFO) {
   dummy_slist_deinitialize(&list);
 }
 
+// Hammers the list from multiple threads that pop, push, concat and flush the
+// same small set of entries. Every entry must end up in the list exactly once.
+TEST(AtomicSList, ConcurrentPushPop) {
+  dummy_slist_t list;
+  dummy_slist_initialize(&list);
+
+  // Few entries relative to the number of threads to provoke ABA.
+  auto item_storage = MakeDummySListItems(0, 8);
+  for (size_t i = 0; i < item_storage.size(); ++i) {
+    dummy_slist_push(&list, &item_storage[i]);
+  }
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; ++t) {
+    threads.emplace_back([&]() {
+      for (int i = 0; i < 20000; ++i) {
+        if ((i % 64) == 0) {
+          dummy_entry_t* head = NULL;
+          dummy_entry_t* tail = NULL;
+          if (dummy_slist_flush(&list,
+                                IREE_ATOMIC_SLIST_FLUSH_ORDER_APPROXIMATE_FIFO,
+                                &head, &tail)) {
+            dummy_slist_concat(&list, head, tail);
+          }
+        }
+        dummy_entry_t* a = dummy_slist_pop(&list);
+        dummy_entry_t* b = dummy_slist_pop(&list);
+        if (b) dummy_slist_push(&list, b);
+        if (a) dummy_slist_push(&list, a);
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+
+  std::vector<int> seen(item_storage.size());
+  while (dummy_entry_t* p = dummy_slist_pop(&list)) {
+    ASSERT_LT(p->value, item_storage.size());
+    ++seen[p->value];
+  }
+  for (size_t i = 0; i < seen.size(); ++i) {
+    EXPECT_EQ(1, seen[i]);
+  }
+
+  dummy_slist_deinitialize(&list);
+}
+
 }  // namespace
@@ -8,6 +8,7 @@
 
 #if IREE_FILE_IO_ENABLE
 
+#include <errno.h>
 #include <stdlib.h>
 #include <sys/stat.h>
 #include <sys/types.h>
@@ -20,6 +21,16 @@
 #define IREE_SET_BINARY_MODE(handle) ((void)0)
 #endif  // IREE_PLATFORM_WINDOWS
 
+#if defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_APPLE) || \
+    defined(IREE_PLATFORM_LINUX)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#define IREE_FILE_MAP_ENABLE 1
+#else
+#define IREE_FILE_MAP_ENABLE 0
+#endif  // IREE_PLATFORM_*
+
 // We could take alignment as an arg, but roughly page aligned should be
 // acceptable for all uses - if someone cares about memory usage they won't
 // be using this method.
@@ -79,6 +90,16 @@ bool iree_file_is_at(FILE* file, uint64_t position) {
   return iree_ftell64(file) == position;
 }
 
+// Releases the |contents| bookkeeping and unmaps the file if it was mapped.
+static void iree_file_contents_release(iree_file_contents_t* contents) {
+#if IREE_FILE_MAP_ENABLE
+  if (contents->mapped && contents->buffer.data_length > 0) {
+    munmap(contents->buffer.data, contents->buffer.data_length);
+  }
+#endif  // IREE_FILE_MAP_ENABLE
+  iree_allocator_free(contents->allocator, contents);
+}
+
 iree_status_t iree_file_contents_allocator_ctl(void* self,
                                                iree_allocator_command_t command,
                                                const void* params,
@@ -93,8 +114,7 @@ iree_status_t iree_file_contents_allocator_ctl(void* self,
     return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
                             "only the file contents buffer is valid");
   }
-  iree_allocator_t allocator = contents->allocator;
-  iree_allocator_free(allocator, contents);
+  iree_file_contents_release(contents);
   return iree_ok_status();
 }
 
@@ -110,7 +130,7 @@ iree_allocator_t iree_file_contents_deallocator(
 void iree_file_contents_free(iree_file_contents_t* contents) {
   if (!contents) return;
   IREE_TRACE_ZONE_BEGIN(z0);
-  iree_allocator_free(contents->allocator, contents);
+  iree_file_contents_release(contents);
   IREE_TRACE_ZONE_END(z0);
 }
 
@@ -184,6 +204,83 @@ iree_status_t iree_file_read_contents(const char* path,
   return status;
 }
 
+#if IREE_FILE_MAP_ENABLE
+
+static iree_status_t iree_file_map_contents_impl(
+    int fd, iree_allocator_t allocator, iree_file_contents_t** out_contents) {
+  struct stat stat_buf;
+  if (fstat(fd, &stat_buf) != 0) {
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "unable to query file length");
+  }
+  if ((uint64_t)stat_buf.st_size > IREE_HOST_SIZE_MAX) {
+    return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                            "file length exceeds host address range");
+  }
+  iree_host_size_t file_size = (iree_host_size_t)stat_buf.st_size;
+
+  iree_file_contents_t* contents = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_allocator_malloc(allocator, sizeof(*contents), (void**)&contents));
+  contents->allocator = allocator;
+  contents->mapped = true;
+
+  // Zero-length mappings are invalid; an empty file has an empty buffer.
+  if (file_size > 0) {
+    void* data = mmap(NULL, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+      iree_allocator_free(allocator, contents);
+      return iree_make_status(iree_status_code_from_errno(errno),
+                              "unable to map %" PRIhsz " file bytes",
+                              file_size);
+    }
+    contents->buffer = iree_make_byte_span(data, file_size);
+  }
+
+  *out_contents = contents;
+  return iree_ok_status();
+}
+
+iree_status_t iree_file_map_contents(const char* path,
+                                     iree_allocator_t allocator,
+                                     iree_file_contents_t** out_contents) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_ASSERT_ARGUMENT(path);
+  IREE_ASSERT_ARGUMENT(out_contents);
+  *out_contents = NULL;
+
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd == -1) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(IREE_STATUS_NOT_FOUND, "failed to open file '%s'",
+                            path);
+  }
+
+  // The mapping holds its own reference to the file and the descriptor can be
+  // closed immediately.
+  iree_status_t status =
+      iree_file_map_contents_impl(fd, allocator, out_contents);
+  if (!iree_status_is_ok(status)) {
+    status = iree_status_annotate_f(status, "mapping file '%s'", path);
+  }
+
+  close(fd);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+#else
+
+iree_status_t iree_file_map_contents(const char* path,
+                                     iree_allocator_t allocator,
+                                     iree_file_contents_t** out_contents) {
+  // No mapping support; fall back to reading the file into memory.
+  return iree_file_read_contents(path, allocator, out_contents);
+}
+
+#endif  // IREE_FILE_MAP_ENABLE
+
 iree_status_t iree_file_write_contents(const char* path,
                                        iree_const_byte_span_t content) {
   IREE_TRACE_ZONE_BEGIN(z0);
@@ -295,6 +392,12 @@ iree_status_t iree_file_read_contents(const char* path,
   return iree_make_status(IREE_STATUS_UNAVAILABLE, "File I/O is disabled");
 }
 
+iree_status_t iree_file_map_contents(const char* path,
+                                     iree_allocator_t allocator,
+                                     iree_file_contents_t** out_contents) {
+  return iree_make_status(IREE_STATUS_UNAVAILABLE, "File I/O is disabled");
+}
+
 iree_status_t iree_file_write_contents(const char* path,
                                        iree_const_byte_span_t content) {
   return iree_make_status(IREE_STATUS_UNAVAILABLE, "File I/O is disabled");
@@ -32,6 +32,8 @@ bool iree_file_is_at(FILE* file, uint64_t position);
 // Loaded file contents.
 typedef struct iree_file_contents_t {
   iree_allocator_t allocator;
+  // True if |buffer| is a read-only mapping of the file instead of a copy.
+  bool mapped;
   union {
     iree_byte_span_t buffer;
     iree_const_byte_span_t const_buffer;
@@ -54,6 +56,19 @@ iree_status_t iree_file_read_contents(const char* path,
                                       iree_allocator_t allocator,
                                       iree_file_contents_t** out_contents);
 
+// Maps a file's contents into memory as read-only.
+//
+// Returns the contents of the file in |out_contents|. The mapping is page
+// aligned and pages are faulted in on first access so that only the portions
+// of the file that are used become resident. On platforms without file mapping
+// support the contents are read into memory as with iree_file_read_contents.
+// |allocator| is used to allocate the bookkeeping and the caller must use
+// iree_file_contents_free to unmap the file. The mapped buffer must not be
+// written.
+iree_status_t iree_file_map_contents(const char* path,
+                                     iree_allocator_t allocator,
+                                     iree_file_contents_t** out_contents);
+
 // Synchronously writes a byte buffer into a file.
 // Existing contents are overwritten.
 iree_status_t iree_file_write_contents(const char* path,
@@ -94,6 +94,28 @@ TEST(FileIO, ReadWriteContents) {
   iree_file_contents_free(read_contents);
 }
 
+TEST(FileIO, MapContents) {
+  constexpr const char* kUniqueName = "MapContents";
+  auto path = GetUniquePath(kUniqueName);
+  auto write_contents = GetUniqueContents(kUniqueName);
+  IREE_ASSERT_OK(iree_file_write_contents(
+      path.c_str(),
+      iree_make_const_byte_span(write_contents.data(), write_contents.size())));
+
+  iree_file_contents_t* mapped_contents = NULL;
+  IREE_ASSERT_OK(iree_file_map_contents(path.c_str(), iree_allocator_system(),
+                                        &mapped_contents));
+  EXPECT_EQ(write_contents.size(), mapped_contents->const_buffer.data_length);
+  EXPECT_EQ(memcmp(write_contents.data(), mapped_contents->const_buffer.data,
+                   mapped_contents->const_buffer.data_length),
+            0);
+
+  // The mapping is released through the deallocator as modules do.
+  iree_allocator_t deallocator =
+      iree_file_contents_deallocator(mapped_contents);
+  iree_allocator_free(deallocator, mapped_contents->buffer.data);
+}
+
 }  // namespace
 }  // namespace file_io
 }  // namespace iree
@@ -0,0 +1,363 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/base/internal/huge_page_allocator.h"
+
+#include <string.h>
+
+#include "iree/base/internal/synchronization.h"
+
+#if defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_LINUX)
+#include <sys/mman.h>
+#define IREE_HUGE_PAGE_ALLOCATOR_HAVE_MMAP 1
+#endif  // IREE_PLATFORM_ANDROID || IREE_PLATFORM_LINUX
+
+//===----------------------------------------------------------------------===//
+// Platform mapping
+//===----------------------------------------------------------------------===//
+
+#if defined(IREE_HUGE_PAGE_ALLOCATOR_HAVE_MMAP)
+
+// Maps |length| bytes (a multiple of IREE_HUGE_PAGE_SIZE) of zeroed memory
+// aligned to IREE_HUGE_PAGE_SIZE. Returns NULL if the system denied the
+// request.
+static void* iree_huge_page_map(iree_huge_page_mode_t mode,
+                                iree_host_size_t length) {
+#if defined(MAP_HUGETLB)
+  if (mode == IREE_HUGE_PAGE_MODE_EXPLICIT) {
+    // Huge page mappings are always aligned to the huge page size. This fails
+    // if no pages are reserved or the default huge page size is not a divisor
+    // of the length and we fall back to transparent huge pages.
+    void* ptr = mmap(NULL, length, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (ptr != MAP_FAILED) return ptr;
+  }
+#endif  // MAP_HUGETLB
+
+  // Over-reserve so that we can trim the mapping to a huge page aligned range.
+  // The kernel can only use huge pages for aligned ranges.
+  const iree_host_size_t reserve_length = length + IREE_HUGE_PAGE_SIZE;
+  uint8_t* base_ptr = (uint8_t*)mmap(NULL, reserve_length,
+                                     PROT_READ | PROT_WRITE,
+                                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if ((void*)base_ptr == MAP_FAILED) return NULL;
+  uint8_t* ptr = (uint8_t*)iree_host_align((uintptr_t)base_ptr,
+                                           IREE_HUGE_PAGE_SIZE);
+  const iree_host_size_t leading_length = ptr - base_ptr;
+  const iree_host_size_t trailing_length =
+      reserve_length - leading_length - length;
+  if (leading_length > 0) munmap(base_ptr, leading_length);
+  if (trailing_length > 0) munmap(ptr + length, trailing_length);
+
+#if defined(MADV_HUGEPAGE)
+  // Advisory only: if THP is disabled the mapping uses regular pages.
+  madvise(ptr, length, MADV_HUGEPAGE);
+#endif  // MADV_HUGEPAGE
+
+  return ptr;
+}
+
+static void iree_huge_page_unmap(void* ptr, iree_host_size_t length) {
+  munmap(ptr, length);
+}
+
+#else
+
+static void* iree_huge_page_map(iree_huge_page_mode_t mode,
+                                iree_host_size_t length) {
+  return NULL;
+}
+
+static void iree_huge_page_unmap(void* ptr, iree_host_size_t length) {}
+
+#endif  // IREE_HUGE_PAGE_ALLOCATOR_HAVE_MMAP
+
+//===----------------------------------------------------------------------===//
+// iree_huge_page_allocator_t
+//===----------------------------------------------------------------------===//
+
+iree_status_t iree_huge_page_mode_parse(iree_string_view_t value,
+                                        iree_huge_page_mode_t* out_mode) {
+  IREE_ASSERT_ARGUMENT(out_mode);
+  if (iree_string_view_is_empty(value) ||
+      iree_string_view_equal(value, IREE_SV("none"))) {
+    *out_mode = IREE_HUGE_PAGE_MODE_NONE;
+  } else if (iree_string_view_equal(value, IREE_SV("transparent"))) {
+    *out_mode = IREE_HUGE_PAGE_MODE_TRANSPARENT;
+  } else if (iree_string_view_equal(value, IREE_SV("explicit"))) {
+    *out_mode = IREE_HUGE_PAGE_MODE_EXPLICIT;
+  } else {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "unknown huge page mode '%.*s'; expected one of "
+                            "none, transparent, or explicit",
+                            (int)value.size, value.data);
+  }
+  return iree_ok_status();
+}
+
+void iree_huge_page_allocator_options_initialize(
+    iree_huge_page_allocator_options_t* out_options) {
+  memset(out_options, 0, sizeof(*out_options));
+  out_options->mode = IREE_HUGE_PAGE_MODE_TRANSPARENT;
+  out_options->min_allocation_size = IREE_HUGE_PAGE_SIZE;
+}
+
+// A live huge page mapping.
+typedef struct iree_huge_page_mapping_t {
+  void* ptr;
+  iree_host_size_t length;
+} iree_huge_page_mapping_t;
+
+struct iree_huge_page_allocator_t {
+  iree_huge_page_allocator_options_t options;
+  iree_allocator_t fallback_allocator;
+
+  // Guards the mapping list.
+  iree_slim_mutex_t mutex;
+  // Unordered list of all live mappings. Huge page allocations are large and
+  // there are few of them so a linear scan on free is cheap compared to the
+  // munmap that follows it.
+  iree_host_size_t mapping_count;
+  iree_host_size_t mapping_capacity;
+  iree_huge_page_mapping_t* mappings;
+};
+
+iree_status_t iree_huge_page_allocator_create(
+    iree_huge_page_allocator_options_t options,
+    iree_allocator_t fallback_allocator,
+    iree_huge_page_allocator_t** out_allocator) {
+  IREE_ASSERT_ARGUMENT(out_allocator);
+  *out_allocator = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_huge_page_allocator_t* allocator = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(fallback_allocator, sizeof(*allocator),
+                                (void**)&allocator));
+  allocator->options = options;
+#if !defined(IREE_HUGE_PAGE_ALLOCATOR_HAVE_MMAP)
+  allocator->options.mode = IREE_HUGE_PAGE_MODE_NONE;
+#endif  // !IREE_HUGE_PAGE_ALLOCATOR_HAVE_MMAP
+  // Never bother with allocations smaller than a single huge page.
+  allocator->options.min_allocation_size =
+      iree_max(allocator->options.min_allocation_size, IREE_HUGE_PAGE_SIZE);
+  allocator->fallback_allocator = fallback_allocator;
+  iree_slim_mutex_initialize(&allocator->mutex);
+
+  *out_allocator = allocator;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+void iree_huge_page_allocator_destroy(iree_huge_page_allocator_t* allocator) {
+  if (!allocator) return;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_ASSERT_EQ(allocator->mapping_count, 0,
+                 "all huge page allocations must be freed");
+  iree_allocator_free(allocator->fallback_allocator, allocator->mappings);
+  iree_slim_mutex_deinitialize(&allocator->mutex);
+  iree_allocator_free(allocator->fallback_allocator, allocator);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+iree_allocator_t iree_huge_page_allocator(
+    iree_huge_page_allocator_t* allocator) {
+  iree_allocator_t v = {
+      .self = allocator,
+      .ctl = iree_huge_page_allocator_ctl,
+  };
+  return v;
+}
+
+// Returns the length of the mapping starting at |ptr| or 0 if |ptr| was not
+// allocated as a huge page mapping.
+static iree_host_size_t iree_huge_page_allocator_lookup(
+    iree_huge_page_allocator_t* allocator, void* ptr) {
+  // Fallback allocations are (almost) never huge page aligned and we can avoid
+  // taking the lock for them.
+  if (!iree_host_size_has_alignment((uintptr_t)ptr, IREE_HUGE_PAGE_SIZE)) {
+    return 0;
+  }
+  iree_host_size_t length = 0;
+  iree_slim_mutex_lock(&allocator->mutex);
+  for (iree_host_size_t i = 0; i < allocator->mapping_count; ++i) {
+    if (allocator->mappings[i].ptr == ptr) {
+      length = allocator->mappings[i].length;
+      break;
+    }
+  }
+  iree_slim_mutex_unlock(&allocator->mutex);
+  return length;
+}
+
+// Removes the mapping of |ptr| from the list and returns its length or 0 if
+// |ptr| was not allocated as a huge page mapping.
+static iree_host_size_t iree_huge_page_allocator_remove(
+    iree_huge_page_allocator_t* allocator, void* ptr) {
+  if (!iree_host_size_has_alignment((uintptr_t)ptr, IREE_HUGE_PAGE_SIZE)) {
+    return 0;
+  }
+  iree_host_size_t length = 0;
+  iree_slim_mutex_lock(&allocator->mutex);
+  for (iree_host_size_t i = 0; i < allocator->mapping_count; ++i) {
+    if (allocator->mappings[i].ptr == ptr) {
+      length = allocator->mappings[i].length;
+      allocator->mappings[i] =
+          allocator->mappings[--allocator->mapping_count];
+      break;
+    }
+  }
+  iree_slim_mutex_unlock(&allocator->mutex);
+  return length;
+}
+
+// Adds a new mapping to the list.
+static iree_status_t iree_huge_page_allocator_insert(
+    iree_huge_page_allocator_t* allocator, void* ptr,
+    iree_host_size_t length) {
+  iree_status_t status = iree_ok_status();
+  iree_slim_mutex_lock(&allocator->mutex);
+  if (allocator->mapping_count == allocator->mapping_capacity) {
+    iree_host_size_t new_capacity =
+        iree_max(16, allocator->mapping_capacity * 2);
+    status = iree_allocator_realloc(allocator->fallback_allocator,
+                                    new_capacity * sizeof(*allocator->mappings),
+                                    (void**)&allocator->mappings);
+    if (iree_status_is_ok(status)) {
+      allocator->mapping_capacity = new_capacity;
+    }
+  }
+  if (iree_status_is_ok(status)) {
+    allocator->mappings[allocator->mapping_count++] =
+        (iree_huge_page_mapping_t){
+            .ptr = ptr,
+            .length = length,
+        };
+  }
+  iree_slim_mutex_unlock(&allocator->mutex);
+  return status;
+}
+
+// Allocates |byte_length| bytes from huge pages, if possible, or the fallback
+// allocator. Huge page memory is always zeroed.
+static iree_status_t iree_huge_page_allocator_alloc(
+    iree_huge_page_allocator_t* allocator, iree_allocator_command_t command,
+    iree_host_size_t byte_length, void** out_ptr) {
+  if (allocator->options.mode == IREE_HUGE_PAGE_MODE_NONE ||
+      byte_length < allocator->options.min_allocation_size) {
+    iree_allocator_alloc_params_t params = {.byte_length = byte_length};
+    *out_ptr = NULL;
+    return allocator->fallback_allocator.ctl(allocator->fallback_allocator.self,
+                                             command, &params, out_ptr);
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, byte_length);
+
+  const iree_host_size_t length =
+      iree_host_align(byte_length, IREE_HUGE_PAGE_SIZE);
+  void* ptr = iree_huge_page_map(allocator->options.mode, length);
+  if (!ptr) {
+    // System denied huge pages (or has none); use the fallback instead.
+    iree_allocator_alloc_params_t params = {.byte_length = byte_length};
+    *out_ptr = NULL;
+    iree_status_t status = allocator->fallback_allocator.ctl(
+        allocator->fallback_allocator.self, command, &params, out_ptr);
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+
+  iree_status_t status =
+      iree_huge_page_allocator_insert(allocator, ptr, length);
+  if (iree_status_is_ok(status)) {
+    IREE_TRACE_ALLOC(ptr, length);
+    *out_ptr = ptr;
+  } else {
+    iree_huge_page_unmap(ptr, length);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static void iree_huge_page_allocator_free(iree_huge_page_allocator_t* allocator,
+                                          void* ptr) {
+  iree_host_size_t length = iree_huge_page_allocator_remove(allocator, ptr);
+  if (length) {
+    IREE_TRACE_FREE(ptr);
+    iree_huge_page_unmap(ptr, length);
+  } else {
+    iree_allocator_free(allocator->fallback_allocator, ptr);
+  }
+}
+
+static iree_status_t iree_huge_page_allocator_realloc(
+    iree_huge_page_allocator_t* allocator, iree_host_size_t byte_length,
+    void** inout_ptr) {
+  void* existing_ptr = *inout_ptr;
+  if (!existing_ptr) {
+    return iree_huge_page_allocator_alloc(
+        allocator, IREE_ALLOCATOR_COMMAND_MALLOC, byte_length, inout_ptr);
+  }
+
+  // Allocations from the fallback allocator stay there: we don't know their
+  // size and can't move them ourselves.
+  const iree_host_size_t existing_length =
+      iree_huge_page_allocator_lookup(allocator, existing_ptr);
+  if (!existing_length) {
+    iree_allocator_alloc_params_t params = {.byte_length = byte_length};
+    return allocator->fallback_allocator.ctl(allocator->fallback_allocator.self,
+                                             IREE_ALLOCATOR_COMMAND_REALLOC,
+                                             &params, inout_ptr);
+  }
+
+  // Mappings are rounded up to whole huge pages and may already be large
+  // enough. We don't bother shrinking.
+  if (byte_length <= existing_length) return iree_ok_status();
+
+  void* new_ptr = NULL;
+  IREE_RETURN_IF_ERROR(iree_huge_page_allocator_alloc(
+      allocator, IREE_ALLOCATOR_COMMAND_MALLOC, byte_length, &new_ptr));
+  memcpy(new_ptr, existing_ptr, existing_length);
+  iree_huge_page_allocator_free(allocator, existing_ptr);
+  *inout_ptr = new_ptr;
+  return iree_ok_status();
+}
+
+iree_status_t iree_huge_page_allocator_ctl(void* self,
+                                           iree_allocator_command_t command,
+                                           const void* params,
+                                           void** inout_ptr) {
+  iree_huge_page_allocator_t* allocator = (iree_huge_page_allocator_t*)self;
+  switch (command) {
+    case IREE_ALLOCATOR_COMMAND_MALLOC:
+    case IREE_ALLOCATOR_COMMAND_CALLOC:
+      return iree_huge_page_allocator_alloc(
+          allocator, command,
+          ((const iree_allocator_alloc_params_t*)params)->byte_length,
+          inout_ptr);
+    case IREE_ALLOCATOR_COMMAND_REALLOC:
+      return iree_huge_page_allocator_realloc(
+          allocator,
+          ((const iree_allocator_alloc_params_t*)params)->byte_length,
+          inout_ptr);
+    case IREE_ALLOCATOR_COMMAND_FREE:
+      iree_huge_page_allocator_free(allocator, *inout_ptr);
+      *inout_ptr = NULL;
+      return iree_ok_status();
+    case IREE_ALLOCATOR_COMMAND_BIND:
+      // Our mappings are plain anonymous memory that the system allocator
+      // knows how to bind.
+      if (iree_huge_page_allocator_lookup(allocator, *inout_ptr)) {
+        return iree_allocator_system_ctl(NULL, command, params, inout_ptr);
+      }
+      return allocator->fallback_allocator.ctl(
+          allocator->fallback_allocator.self, command, params, inout_ptr);
+    default:
+      return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                              "unsupported huge page allocator command");
+  }
+}
@@ -0,0 +1,94 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_BASE_INTERNAL_HUGE_PAGE_ALLOCATOR_H_
+#define IREE_BASE_INTERNAL_HUGE_PAGE_ALLOCATOR_H_
+
+#include "iree/base/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// iree_huge_page_allocator_t
+//===----------------------------------------------------------------------===//
+
+// Size of the huge pages requested from the system, in bytes.
+// This is the PMD size on x86-64 and arm64 with 4KB base pages. Systems
+// configured with other sizes still work but may not get huge pages.
+#define IREE_HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+// Controls how huge pages are acquired from the system.
+typedef enum iree_huge_page_mode_e {
+  // Huge pages are not used and all allocations are made from the fallback
+  // allocator.
+  IREE_HUGE_PAGE_MODE_NONE = 0,
+  // Allocations are mapped aligned to IREE_HUGE_PAGE_SIZE and the system is
+  // advised to back them with transparent huge pages (THP). Whether huge pages
+  // are used is up to the system configuration (e.g.
+  // /sys/kernel/mm/transparent_hugepage/enabled must be `madvise` or `always`).
+  IREE_HUGE_PAGE_MODE_TRANSPARENT = 1,
+  // Allocations are mapped from the reserved huge page pool (hugetlbfs, see
+  // /proc/sys/vm/nr_hugepages). If the pool is exhausted or unavailable the
+  // allocation is made as with IREE_HUGE_PAGE_MODE_TRANSPARENT.
+  IREE_HUGE_PAGE_MODE_EXPLICIT = 2,
+} iree_huge_page_mode_t;
+
+// Parses a huge page mode from its flag value: `none`, `transparent`, or
+// `explicit`.
+iree_status_t iree_huge_page_mode_parse(iree_string_view_t value,
+                                        iree_huge_page_mode_t* out_mode);
+
+typedef struct iree_huge_page_allocator_options_t {
+  // Mode used to acquire huge pages from the system.
+  iree_huge_page_mode_t mode;
+  // Minimum size, in bytes, of an allocation to back with huge pages.
+  // Smaller allocations are made from the fallback allocator as each huge page
+  // allocation consumes at least IREE_HUGE_PAGE_SIZE of memory.
+  iree_host_size_t min_allocation_size;
+} iree_huge_page_allocator_options_t;
+
+// Initializes |out_options| to default values: transparent huge pages for
+// allocations of at least one huge page.
+void iree_huge_page_allocator_options_initialize(
+    iree_huge_page_allocator_options_t* out_options);
+
+// An allocator that backs large allocations with huge pages to reduce TLB
+// pressure when streaming through large buffers (weights, transients, worker
+// local memory, etc). Allocations below the size threshold, allocations made
+// when the system denies huge pages, and all allocations on platforms without
+// huge page support are routed to a fallback allocator.
+//
+// Thread-safe: the allocator may be used concurrently from multiple threads.
+typedef struct iree_huge_page_allocator_t iree_huge_page_allocator_t;
+
+// Creates a new huge page allocator that routes small allocations to
+// |fallback_allocator|. The fallback allocator is also used for the allocator
+// bookkeeping and must remain valid for the lifetime of the allocator.
+iree_status_t iree_huge_page_allocator_create(
+    iree_huge_page_allocator_options_t options,
+    iree_allocator_t fallback_allocator,
+    iree_huge_page_allocator_t** out_allocator);
+
+// Destroys |allocator|. All allocations made from it must have been freed.
+void iree_huge_page_allocator_destroy(iree_huge_page_allocator_t* allocator);
+
+// Returns an iree_allocator_t that allocates from |allocator|.
+// The returned allocator is only valid for the lifetime of |allocator|.
+iree_allocator_t iree_huge_page_allocator(iree_huge_page_allocator_t* allocator);
+
+// Allocator control function for iree_huge_page_allocator_t as |self|.
+iree_status_t iree_huge_page_allocator_ctl(void* self,
+                                           iree_allocator_command_t command,
+                                           const void* params,
+                                           void** inout_ptr);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_BASE_INTERNAL_HUGE_PAGE_ALLOCATOR_H_
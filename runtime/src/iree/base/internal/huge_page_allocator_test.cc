@@ -0,0 +1,103 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/base/internal/huge_page_allocator.h"
+
+#include <cstring>
+
+#include "iree/base/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace {
+
+class HugePageAllocatorTest
+    : public ::testing::TestWithParam<iree_huge_page_mode_t> {
+ protected:
+  void SetUp() override {
+    iree_huge_page_allocator_options_t options;
+    iree_huge_page_allocator_options_initialize(&options);
+    options.mode = GetParam();
+    IREE_ASSERT_OK(iree_huge_page_allocator_create(
+        options, iree_allocator_system(), &huge_page_allocator_));
+    allocator_ = iree_huge_page_allocator(huge_page_allocator_);
+  }
+
+  void TearDown() override {
+    iree_huge_page_allocator_destroy(huge_page_allocator_);
+  }
+
+  iree_huge_page_allocator_t* huge_page_allocator_ = NULL;
+  iree_allocator_t allocator_;
+};
+
+TEST_P(HugePageAllocatorTest, SmallAllocationsUseFallback) {
+  void* ptr = NULL;
+  IREE_ASSERT_OK(iree_allocator_malloc(allocator_, 128, &ptr));
+  ASSERT_NE(ptr, nullptr);
+  std::memset(ptr, 0xCD, 128);
+  iree_allocator_free(allocator_, ptr);
+}
+
+TEST_P(HugePageAllocatorTest, LargeAllocationIsZeroed) {
+  const iree_host_size_t length = 3 * IREE_HUGE_PAGE_SIZE + 17;
+  uint8_t* ptr = NULL;
+  IREE_ASSERT_OK(iree_allocator_malloc(allocator_, length, (void**)&ptr));
+  ASSERT_NE(ptr, nullptr);
+  if (GetParam() != IREE_HUGE_PAGE_MODE_NONE) {
+    // Mappings are aligned so that the system can back them with huge pages.
+    EXPECT_TRUE(
+        iree_host_size_has_alignment((uintptr_t)ptr, IREE_HUGE_PAGE_SIZE));
+  }
+  for (iree_host_size_t i = 0; i < length; i += 4096) EXPECT_EQ(ptr[i], 0);
+  EXPECT_EQ(ptr[length - 1], 0);
+  std::memset(ptr, 0xCD, length);
+  iree_allocator_free(allocator_, ptr);
+}
+
+TEST_P(HugePageAllocatorTest, ReallocPreservesContents) {
+  uint8_t* ptr = NULL;
+  IREE_ASSERT_OK(
+      iree_allocator_malloc(allocator_, IREE_HUGE_PAGE_SIZE, (void**)&ptr));
+  for (iree_host_size_t i = 0; i < IREE_HUGE_PAGE_SIZE; ++i) {
+    ptr[i] = (uint8_t)i;
+  }
+  IREE_ASSERT_OK(iree_allocator_realloc(allocator_, 4 * IREE_HUGE_PAGE_SIZE,
+                                        (void**)&ptr));
+  for (iree_host_size_t i = 0; i < IREE_HUGE_PAGE_SIZE; ++i) {
+    ASSERT_EQ(ptr[i], (uint8_t)i);
+  }
+  std::memset(ptr, 0xCD, 4 * IREE_HUGE_PAGE_SIZE);
+  iree_allocator_free(allocator_, ptr);
+}
+
+TEST_P(HugePageAllocatorTest, AlignedAllocations) {
+  void* ptr = NULL;
+  IREE_ASSERT_OK(iree_allocator_malloc_aligned(
+      allocator_, 2 * IREE_HUGE_PAGE_SIZE, 64, 0, &ptr));
+  EXPECT_TRUE(iree_host_size_has_alignment((uintptr_t)ptr, 64));
+  iree_allocator_free_aligned(allocator_, ptr);
+}
+
+INSTANTIATE_TEST_SUITE_P(AllModes, HugePageAllocatorTest,
+                         ::testing::Values(IREE_HUGE_PAGE_MODE_NONE,
+                                           IREE_HUGE_PAGE_MODE_TRANSPARENT,
+                                           IREE_HUGE_PAGE_MODE_EXPLICIT));
+
+TEST(HugePageModeTest, Parse) {
+  iree_huge_page_mode_t mode = IREE_HUGE_PAGE_MODE_EXPLICIT;
+  IREE_ASSERT_OK(iree_huge_page_mode_parse(IREE_SV("none"), &mode));
+  EXPECT_EQ(mode, IREE_HUGE_PAGE_MODE_NONE);
+  IREE_ASSERT_OK(iree_huge_page_mode_parse(IREE_SV("transparent"), &mode));
+  EXPECT_EQ(mode, IREE_HUGE_PAGE_MODE_TRANSPARENT);
+  IREE_ASSERT_OK(iree_huge_page_mode_parse(IREE_SV("explicit"), &mode));
+  EXPECT_EQ(mode, IREE_HUGE_PAGE_MODE_EXPLICIT);
+  EXPECT_THAT(iree_huge_page_mode_parse(IREE_SV("large"), &mode),
+              iree::testing::status::StatusIs(
+                  iree::StatusCode::kInvalidArgument));
+}
+
+}  // namespace
@@ -0,0 +1,97 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/base/internal/lz4.h"
+
+#include <string.h>
+
+// Minimum length of a match; match lengths are encoded relative to this.
+#define IREE_LZ4_MIN_MATCH 4
+
+// Reads an extended length that follows a saturated token nibble.
+// Each byte is added to the length and a byte of 255 indicates another byte
+// follows.
+static bool iree_lz4_read_length(const uint8_t** ip, const uint8_t* ip_end,
+                                 iree_host_size_t* length) {
+  uint8_t byte = 0;
+  do {
+    if (*ip >= ip_end) return false;
+    byte = *(*ip)++;
+    if (*length > IREE_HOST_SIZE_MAX - byte) return false;
+    *length += byte;
+  } while (byte == 255);
+  return true;
+}
+
+iree_status_t iree_lz4_decompress_block(iree_const_byte_span_t source,
+                                        iree_byte_span_t target,
+                                        iree_host_size_t* out_length) {
+  IREE_ASSERT_ARGUMENT(out_length);
+  *out_length = 0;
+
+  const uint8_t* ip = source.data;
+  const uint8_t* const ip_end = source.data + source.data_length;
+  uint8_t* op = target.data;
+  uint8_t* const op_end = target.data + target.data_length;
+
+  while (ip < ip_end) {
+    // Token: 4 bits of literal length and 4 bits of match length.
+    const uint8_t token = *ip++;
+
+    iree_host_size_t literal_length = token >> 4;
+    if (literal_length == 15 &&
+        !iree_lz4_read_length(&ip, ip_end, &literal_length)) {
+      return iree_make_status(IREE_STATUS_DATA_LOSS,
+                              "truncated literal length");
+    }
+    if (literal_length > (iree_host_size_t)(ip_end - ip)) {
+      return iree_make_status(IREE_STATUS_DATA_LOSS, "truncated literals");
+    } else if (literal_length > (iree_host_size_t)(op_end - op)) {
+      return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                              "target too small for decompressed data");
+    }
+    memcpy(op, ip, literal_length);
+    ip += literal_length;
+    op += literal_length;
+
+    // The last sequence contains only literals.
+    if (ip == ip_end) break;
+
+    if (ip_end - ip < 2) {
+      return iree_make_status(IREE_STATUS_DATA_LOSS, "truncated match offset");
+    }
+    const iree_host_size_t offset = (iree_host_size_t)ip[0] | (ip[1] << 8);
+    ip += 2;
+    if (offset == 0 || offset > (iree_host_size_t)(op - target.data)) {
+      return iree_make_status(IREE_STATUS_DATA_LOSS,
+                              "match offset out of range");
+    }
+
+    iree_host_size_t match_length = token & 0xF;
+    if (match_length == 15 &&
+        !iree_lz4_read_length(&ip, ip_end, &match_length)) {
+      return iree_make_status(IREE_STATUS_DATA_LOSS, "truncated match length");
+    }
+    match_length += IREE_LZ4_MIN_MATCH;
+    if (match_length > (iree_host_size_t)(op_end - op)) {
+      return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                              "target too small for decompressed data");
+    }
+
+    // Matches may overlap the bytes they produce (offset < length) to encode
+    // runs; those must be copied forward one byte at a time.
+    const uint8_t* match = op - offset;
+    if (offset >= match_length) {
+      memcpy(op, match, match_length);
+      op += match_length;
+    } else {
+      for (iree_host_size_t i = 0; i < match_length; ++i) *op++ = *match++;
+    }
+  }
+
+  *out_length = (iree_host_size_t)(op - target.data);
+  return iree_ok_status();
+}
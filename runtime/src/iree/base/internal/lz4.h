@@ -0,0 +1,35 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_BASE_INTERNAL_LZ4_H_
+#define IREE_BASE_INTERNAL_LZ4_H_
+
+#include "iree/base/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Decompresses a single block in the LZ4 block format into |target|.
+// See https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md.
+//
+// Only the block format is supported: frames (magic number, checksums, etc)
+// must be handled by the caller. Malformed input is detected and rejected
+// without reading or writing outside of |source| or |target|; the contents of
+// |target| are undefined on failure.
+//
+// Returns the number of bytes written to |target| in |out_length|.
+// Returns IREE_STATUS_RESOURCE_EXHAUSTED if |target| is too small to hold the
+// decompressed data and IREE_STATUS_DATA_LOSS if |source| is malformed.
+iree_status_t iree_lz4_decompress_block(iree_const_byte_span_t source,
+                                        iree_byte_span_t target,
+                                        iree_host_size_t* out_length);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_BASE_INTERNAL_LZ4_H_
@@ -0,0 +1,92 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/base/internal/lz4.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace {
+
+using iree::StatusCode;
+using iree::testing::status::StatusIs;
+
+iree_status_t Decompress(const std::vector<uint8_t>& source,
+                         std::vector<uint8_t>* target) {
+  iree_host_size_t length = 0;
+  iree_status_t status = iree_lz4_decompress_block(
+      iree_make_const_byte_span(source.data(), source.size()),
+      iree_make_byte_span(target->data(), target->size()), &length);
+  if (iree_status_is_ok(status)) target->resize(length);
+  return status;
+}
+
+TEST(LZ4Test, Empty) {
+  std::vector<uint8_t> target(4);
+  IREE_ASSERT_OK(Decompress({0x00}, &target));
+  EXPECT_TRUE(target.empty());
+}
+
+TEST(LZ4Test, LiteralsOnly) {
+  std::vector<uint8_t> target(16);
+  IREE_ASSERT_OK(Decompress({0x30, 'a', 'b', 'c'}, &target));
+  EXPECT_EQ(std::string(target.begin(), target.end()), "abc");
+}
+
+TEST(LZ4Test, ExtendedLiteralLength) {
+  // 15 + 5 = 20 literals.
+  std::vector<uint8_t> source = {0xF0, 5};
+  for (int i = 0; i < 20; ++i) source.push_back('a' + i);
+  std::vector<uint8_t> target(32);
+  IREE_ASSERT_OK(Decompress(source, &target));
+  EXPECT_EQ(std::string(target.begin(), target.end()),
+            "abcdefghijklmnopqrst");
+}
+
+TEST(LZ4Test, Match) {
+  // "abcd" then a match of 4 at offset 4 then literals "xyz".
+  std::vector<uint8_t> target(32);
+  IREE_ASSERT_OK(Decompress(
+      {0x40, 'a', 'b', 'c', 'd', 0x04, 0x00, 0x30, 'x', 'y', 'z'}, &target));
+  EXPECT_EQ(std::string(target.begin(), target.end()), "abcdabcdxyz");
+}
+
+TEST(LZ4Test, OverlappingMatchRun) {
+  // "a" followed by a match of 4 + 15 + 1 = 20 at offset 1 forming a run.
+  std::vector<uint8_t> target(64);
+  IREE_ASSERT_OK(Decompress({0x1F, 'a', 0x01, 0x00, 1, 0x00}, &target));
+  EXPECT_EQ(std::string(target.begin(), target.end()), std::string(21, 'a'));
+}
+
+TEST(LZ4Test, TargetTooSmall) {
+  std::vector<uint8_t> target(2);
+  EXPECT_THAT(iree::Status(Decompress({0x30, 'a', 'b', 'c'}, &target)),
+              StatusIs(StatusCode::kResourceExhausted));
+}
+
+TEST(LZ4Test, Truncated) {
+  std::vector<uint8_t> target(16);
+  EXPECT_THAT(iree::Status(Decompress({0x30, 'a', 'b'}, &target)),
+              StatusIs(StatusCode::kDataLoss));
+  EXPECT_THAT(iree::Status(Decompress({0x14, 'a', 0x01}, &target)),
+              StatusIs(StatusCode::kDataLoss));
+}
+
+TEST(LZ4Test, OffsetOutOfRange) {
+  std::vector<uint8_t> target(16);
+  EXPECT_THAT(
+      iree::Status(Decompress({0x10, 'a', 0x02, 0x00, 0x00}, &target)),
+      StatusIs(StatusCode::kDataLoss));
+  EXPECT_THAT(
+      iree::Status(Decompress({0x10, 'a', 0x00, 0x00, 0x00}, &target)),
+      StatusIs(StatusCode::kDataLoss));
+}
+
+}  // namespace
@@ -883,3 +883,122 @@ bool iree_notification_await(iree_notification_t* notification,
 
   return true;
 }
+
+//==============================================================================
+// iree_notification_set_t
+//==============================================================================
+
+void iree_notification_set_initialize(iree_notification_set_t* out_set) {
+  iree_notification_initialize(&out_set->notification);
+}
+
+void iree_notification_set_deinitialize(iree_notification_set_t* set) {
+  iree_notification_deinitialize(&set->notification);
+}
+
+iree_wait_token_t iree_notification_set_prepare_wait(
+    iree_notification_set_t* set) {
+  return iree_notification_prepare_wait(&set->notification);
+}
+
+void iree_notification_set_cancel_wait(iree_notification_set_t* set) {
+  iree_notification_cancel_wait(&set->notification);
+}
+
+#if !IREE_SYNCHRONIZATION_DISABLE_UNSAFE && \
+    defined(IREE_PLATFORM_HAS_FUTEX) &&      \
+    (defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_LINUX))
+
+// Folds a 64-bit index mask onto the 32 bits supported by futex bitsets.
+static inline uint32_t iree_notification_set_fold_mask(uint64_t index_mask) {
+  return (uint32_t)index_mask | (uint32_t)(index_mask >> 32);
+}
+
+void iree_notification_set_post(iree_notification_set_t* set,
+                                uint64_t index_mask) {
+  iree_notification_t* notification = &set->notification;
+  uint64_t previous_value = iree_atomic_fetch_add_int64(
+      &notification->value, IREE_NOTIFICATION_EPOCH_INC,
+      iree_memory_order_acq_rel);
+  // Only take the syscall if someone may be waiting; the kernel will then wake
+  // only those waiting on the indices in the mask.
+  if (IREE_UNLIKELY(previous_value & IREE_NOTIFICATION_WAITER_MASK)) {
+    syscall(SYS_futex, iree_notification_epoch_address(notification),
+            FUTEX_WAKE_BITSET | FUTEX_PRIVATE_FLAG, INT32_MAX, NULL, NULL,
+            iree_notification_set_fold_mask(index_mask));
+  }
+}
+
+bool iree_notification_set_commit_wait(iree_notification_set_t* set,
+                                       uint32_t index,
+                                       iree_wait_token_t wait_token,
+                                       iree_duration_t spin_ns,
+                                       iree_time_t deadline_ns) {
+  iree_notification_t* notification = &set->notification;
+  iree_notification_result_t result =
+      iree_notification_test_wait_condition(notification, wait_token);
+
+  if (result == IREE_NOTIFICATION_RESULT_UNRESOLVED &&
+      spin_ns != IREE_DURATION_ZERO) {
+    const iree_time_t spin_deadline_ns = iree_time_now() + spin_ns;
+    IREE_TRACE_ZONE_BEGIN_NAMED(z0, "iree_notification_set_commit_wait_spin");
+    do {
+      iree_processor_yield();
+      result = iree_notification_test_wait_condition(notification, wait_token);
+    } while (result == IREE_NOTIFICATION_RESULT_UNRESOLVED &&
+             iree_time_now() < spin_deadline_ns);
+    IREE_TRACE_ZONE_END(z0);
+  }
+
+  if (deadline_ns != IREE_TIME_INFINITE_PAST) {
+    // FUTEX_WAIT_BITSET takes an absolute timeout and with FUTEX_CLOCK_REALTIME
+    // it is in the same time base as iree_time_now.
+    struct timespec deadline = {
+        .tv_sec = (time_t)(deadline_ns / 1000000000ll),
+        .tv_nsec = (long)(deadline_ns % 1000000000ll),
+    };
+    const uint32_t bitset = 1u << (index % 32);
+    while (result == IREE_NOTIFICATION_RESULT_UNRESOLVED) {
+      int rc = syscall(
+          SYS_futex, iree_notification_epoch_address(notification),
+          FUTEX_WAIT_BITSET | FUTEX_PRIVATE_FLAG | FUTEX_CLOCK_REALTIME,
+          wait_token,
+          deadline_ns == IREE_TIME_INFINITE_FUTURE ? NULL : &deadline, NULL,
+          bitset);
+      if (rc != 0 && errno != EAGAIN && errno != EINTR) {
+        result = IREE_NOTIFICATION_RESULT_REJECTED;
+        break;
+      }
+      result = iree_notification_test_wait_condition(notification, wait_token);
+    }
+  }
+
+  uint64_t previous_value = iree_atomic_fetch_add_int64(
+      &notification->value, IREE_NOTIFICATION_WAITER_DEC,
+      iree_memory_order_acq_rel);
+  SYNC_ASSERT((previous_value & IREE_NOTIFICATION_WAITER_MASK) != 0);
+
+  return result == IREE_NOTIFICATION_RESULT_RESOLVED;
+}
+
+#else
+
+// No bitset wakes available: all waiters wake and recheck their conditions.
+
+void iree_notification_set_post(iree_notification_set_t* set,
+                                uint64_t index_mask) {
+  (void)index_mask;
+  iree_notification_post(&set->notification, IREE_ALL_WAITERS);
+}
+
+bool iree_notification_set_commit_wait(iree_notification_set_t* set,
+                                       uint32_t index,
+                                       iree_wait_token_t wait_token,
+                                       iree_duration_t spin_ns,
+                                       iree_time_t deadline_ns) {
+  (void)index;
+  return iree_notification_commit_wait(&set->notification, wait_token, spin_ns,
+                                       deadline_ns);
+}
+
+#endif  // IREE_PLATFORM_HAS_FUTEX && (ANDROID || LINUX)
@@ -448,6 +448,53 @@ bool iree_notification_await(iree_notification_t* notification,
                              iree_condition_fn_t condition_fn,
                              void* condition_arg, iree_timeout_t timeout);
 
+//==============================================================================
+// iree_notification_set_t
+//==============================================================================
+
+// A set of up to 64 notifications sharing a single wait address.
+// Each waiter waits on its own index in the set and posts can target any subset
+// of the indices at once. On Linux/Android this is a single FUTEX_WAKE_BITSET
+// syscall no matter how many waiters are woken (vs. one syscall per
+// iree_notification_t). The kernel supports 32 bitset bits and indices are
+// folded onto them such that index N and N+32 alias and may spuriously wake
+// each other. Other platforms fall back to waking all waiters on each post.
+//
+// Waiters must handle spurious wakes: a post to any index in the set made
+// between a prepare_wait and commit_wait will cause commit_wait to return.
+typedef struct iree_notification_set_t {
+  iree_notification_t notification;
+} iree_notification_set_t;
+
+// Initializes a notification set with no waiters.
+void iree_notification_set_initialize(iree_notification_set_t* out_set);
+
+// Deinitializes |set|. No threads may be waiting on the set.
+void iree_notification_set_deinitialize(iree_notification_set_t* set);
+
+// Notifies the waiters on the indices set in |index_mask| (bit N for index N).
+// Acts as (at least) a memory_order_release operation on the set.
+void iree_notification_set_post(iree_notification_set_t* set,
+                                uint64_t index_mask);
+
+// Prepares for a wait operation, returning a token that must be passed to
+// iree_notification_set_commit_wait to perform the actual wait.
+iree_wait_token_t iree_notification_set_prepare_wait(
+    iree_notification_set_t* set);
+
+// Commits a pending wait on |index| (0-63) of the set. Waiting will continue
+// until a post has been made to the index or |deadline_ns| is reached. Returns
+// false if the deadline is reached before a post is observed. See
+// iree_notification_commit_wait for the memory ordering guarantees.
+bool iree_notification_set_commit_wait(iree_notification_set_t* set,
+                                       uint32_t index,
+                                       iree_wait_token_t wait_token,
+                                       iree_duration_t spin_ns,
+                                       iree_time_t deadline_ns);
+
+// Cancels a pending wait operation without blocking.
+void iree_notification_set_cancel_wait(iree_notification_set_t* set);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
@@ -6,6 +6,7 @@
 
 #include "iree/base/internal/synchronization.h"
 
+#include <atomic>
 #include <thread>
 
 #include "iree/testing/gtest.h"
@@ -215,4 +216,77 @@ TEST(NotificationTest, Timeout) {
   iree_notification_deinitialize(&notification);
 }
 
+//==============================================================================
+// iree_notification_set_t
+//==============================================================================
+
+TEST(NotificationSetTest, Timeout) {
+  iree_notification_set_t set;
+  iree_notification_set_initialize(&set);
+
+  iree_time_t start_ns = iree_time_now();
+  iree_wait_token_t wait_token = iree_notification_set_prepare_wait(&set);
+  EXPECT_FALSE(iree_notification_set_commit_wait(
+      &set, /*index=*/3, wait_token, IREE_DURATION_ZERO,
+      iree_time_now() + 100 * 1000000ll));
+  iree_duration_t delta_ms = (iree_time_now() - start_ns) / 1000000;
+  EXPECT_GE(delta_ms, 50);  // slop
+
+  iree_notification_set_deinitialize(&set);
+}
+
+TEST(NotificationSetTest, PostBeforeCommit) {
+  iree_notification_set_t set;
+  iree_notification_set_initialize(&set);
+
+  // A post made between prepare and commit must not be lost.
+  iree_wait_token_t wait_token = iree_notification_set_prepare_wait(&set);
+  iree_notification_set_post(&set, 1ull << 5);
+  EXPECT_TRUE(iree_notification_set_commit_wait(&set, /*index=*/5, wait_token,
+                                                IREE_DURATION_ZERO,
+                                                IREE_TIME_INFINITE_FUTURE));
+
+  iree_notification_set_deinitialize(&set);
+}
+
+// Tests that posting a subset of indices wakes the waiters on those indices.
+TEST(NotificationSetTest, PostSubset) {
+  iree_notification_set_t set;
+  iree_notification_set_initialize(&set);
+
+  static constexpr int kWaiterCount = 4;
+  std::atomic<uint32_t> posted_mask = {0};
+  std::atomic<uint32_t> woken_mask = {0};
+  std::thread waiters[kWaiterCount];
+  for (int i = 0; i < kWaiterCount; ++i) {
+    waiters[i] = std::thread([&, i]() {
+      while (!(posted_mask.load() & (1u << i))) {
+        iree_wait_token_t wait_token = iree_notification_set_prepare_wait(&set);
+        if (posted_mask.load() & (1u << i)) {
+          iree_notification_set_cancel_wait(&set);
+          break;
+        }
+        iree_notification_set_commit_wait(&set, i, wait_token,
+                                          IREE_DURATION_ZERO,
+                                          IREE_TIME_INFINITE_FUTURE);
+      }
+      woken_mask.fetch_or(1u << i);
+    });
+  }
+
+  // Wake the even waiters and then the odd ones.
+  posted_mask.fetch_or(0x5u);
+  iree_notification_set_post(&set, 0x5u);
+  waiters[0].join();
+  waiters[2].join();
+  EXPECT_EQ(woken_mask.load() & 0x5u, 0x5u);
+  posted_mask.fetch_or(0xAu);
+  iree_notification_set_post(&set, 0xAu);
+  waiters[1].join();
+  waiters[3].join();
+  EXPECT_EQ(woken_mask.load(), 0xFu);
+
+  iree_notification_set_deinitialize(&set);
+}
+
 }  // namespace
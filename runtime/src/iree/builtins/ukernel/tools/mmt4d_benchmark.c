@@ -8,6 +8,7 @@
 
 #include "iree/base/api.h"
 #include "iree/base/internal/flags.h"
+#include "iree/base/internal/huge_page_allocator.h"
 #include "iree/builtins/ukernel/api.h"
 #include "iree/builtins/ukernel/mmt4d_internal.h"
 #include "iree/builtins/ukernel/tools/benchmark.h"
@@ -26,6 +27,22 @@ IREE_FLAG(
 IREE_FLAG(bool, accumulate, false,
           "Whether the kernel should accumulate into the existing accumulator "
           "tile values, or zero the accumulator tile.");
+IREE_FLAG(
+    string, huge_pages, "none",
+    "Backs the lhs/rhs/out buffers with huge pages: 'none', 'transparent', or "
+    "'explicit'. Use with large sizes (e.g. --m_size=64 --n_size=1024 "
+    "--k_size=1024) where the rhs no longer fits in the TLB reach of regular "
+    "pages and compare dTLB misses with `perf stat -e dTLB-load-misses`.");
+
+// Allocator for the benchmark buffers selected by --huge_pages.
+static iree_huge_page_allocator_t* iree_uk_benchmark_huge_page_allocator =
+    NULL;
+
+static iree_allocator_t iree_uk_benchmark_buffer_allocator(void) {
+  return iree_uk_benchmark_huge_page_allocator
+             ? iree_huge_page_allocator(iree_uk_benchmark_huge_page_allocator)
+             : iree_allocator_system();
+}
 
 static iree_status_t iree_uk_benchmark_mmt4d(
     const iree_benchmark_def_t* benchmark_def,
@@ -53,9 +70,25 @@ static iree_status_t iree_uk_benchmark_mmt4d(
       iree_uk_2d_buffer_length(rhs_type, params.N, params.rhs_stride0);
   iree_uk_index_t out_buffer_size =
       iree_uk_2d_buffer_length(out_type, params.M, params.out_stride0);
-  void* lhs_buffer = malloc(lhs_buffer_size);
-  void* rhs_buffer = malloc(rhs_buffer_size);
-  void* out_buffer = malloc(out_buffer_size);
+  iree_allocator_t buffer_allocator = iree_uk_benchmark_buffer_allocator();
+  void* lhs_buffer = NULL;
+  void* rhs_buffer = NULL;
+  void* out_buffer = NULL;
+  iree_status_t status = iree_allocator_malloc_uninitialized(
+      buffer_allocator, lhs_buffer_size, &lhs_buffer);
+  if (iree_status_is_ok(status)) {
+    status = iree_allocator_malloc_uninitialized(buffer_allocator,
+                                                 rhs_buffer_size, &rhs_buffer);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_allocator_malloc_uninitialized(buffer_allocator,
+                                                 out_buffer_size, &out_buffer);
+  }
+  if (!iree_status_is_ok(status)) {
+    iree_allocator_free(buffer_allocator, lhs_buffer);
+    iree_allocator_free(buffer_allocator, rhs_buffer);
+    return status;
+  }
   iree_uk_random_engine_t* engine = iree_uk_benchmark_random_engine(user_data);
   // It's just about plausible that on some platform, for some number type,
   // performance might be different on zero buffers vs random buffers. But it
@@ -79,9 +112,9 @@ static iree_status_t iree_uk_benchmark_mmt4d(
   iree_benchmark_set_items_processed(
       benchmark_state, total_iterations * 2 * params.M * params.N * params.K *
                            params.M0 * params.N0 * params.K0);
-  free(lhs_buffer);
-  free(rhs_buffer);
-  free(out_buffer);
+  iree_allocator_free(buffer_allocator, lhs_buffer);
+  iree_allocator_free(buffer_allocator, rhs_buffer);
+  iree_allocator_free(buffer_allocator, out_buffer);
   return iree_ok_status();
 }
 
@@ -122,6 +155,16 @@ int main(int argc, char** argv) {
   iree_flags_parse_checked(IREE_FLAGS_PARSE_MODE_UNDEFINED_OK, &argc, &argv);
   iree_uk_benchmark_initialize(&argc, argv);
 
+  iree_huge_page_allocator_options_t huge_page_options;
+  iree_huge_page_allocator_options_initialize(&huge_page_options);
+  IREE_CHECK_OK(iree_huge_page_mode_parse(
+      iree_make_cstring_view(FLAG_huge_pages), &huge_page_options.mode));
+  if (huge_page_options.mode != IREE_HUGE_PAGE_MODE_NONE) {
+    IREE_CHECK_OK(iree_huge_page_allocator_create(
+        huge_page_options, iree_allocator_system(),
+        &iree_uk_benchmark_huge_page_allocator));
+  }
+
 #if defined(IREE_ARCH_ARM_64)
   // On arm64, some code paths have inline asm and intrinsics variants. For them
   // we use iree_uk_benchmark_register_mmt4d_default_and_intrinsics to benchmark
@@ -155,4 +198,5 @@ int main(int argc, char** argv) {
 #endif  // defined(IREE_ARCH_ARM_64)
 
   iree_uk_benchmark_run_and_cleanup();
+  iree_huge_page_allocator_destroy(iree_uk_benchmark_huge_page_allocator);
 }
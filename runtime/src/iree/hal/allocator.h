@@ -530,6 +530,22 @@ IREE_API_EXPORT iree_status_t iree_hal_allocator_create_heap(
     iree_string_view_t identifier, iree_allocator_t data_allocator,
     iree_allocator_t host_allocator, iree_hal_allocator_t** out_allocator);
 
+// Creates a host-local heap allocator as with iree_hal_allocator_create_heap
+// that places buffer storage on the NUMA node of the queues it is allocated
+// for. |queue_node_ids| maps each of the |queue_count| queue ordinals (bits in
+// iree_hal_queue_affinity_t) to the NUMA node the queue executes on.
+//
+// Buffers requested with a queue affinity that selects queues on a single node
+// have their storage bound to that node with iree_allocator_bind. Buffers that
+// may be used on queues across multiple nodes are left to the default
+// first-touch placement of the system. Binding is best-effort: if
+// |data_allocator| or the platform does not support it buffers are allocated
+// as normal.
+IREE_API_EXPORT iree_status_t iree_hal_allocator_create_heap_numa(
+    iree_string_view_t identifier, iree_host_size_t queue_count,
+    const uint32_t* queue_node_ids, iree_allocator_t data_allocator,
+    iree_allocator_t host_allocator, iree_hal_allocator_t** out_allocator);
+
 //===----------------------------------------------------------------------===//
 // iree_hal_allocator_t implementation details
 //===----------------------------------------------------------------------===//
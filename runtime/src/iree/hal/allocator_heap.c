@@ -12,11 +12,22 @@
 #include "iree/hal/buffer_heap_impl.h"
 #include "iree/hal/resource.h"
 
+// Maximum number of queues that can be mapped to NUMA nodes; one per bit in
+// iree_hal_queue_affinity_t.
+#define IREE_HAL_HEAP_ALLOCATOR_MAX_QUEUE_COUNT \
+  (sizeof(iree_hal_queue_affinity_t) * 8)
+
 typedef struct iree_hal_heap_allocator_t {
   iree_hal_resource_t resource;
   iree_allocator_t host_allocator;
   iree_allocator_t data_allocator;
   iree_string_view_t identifier;
+
+  // Maps queue ordinals to the NUMA node storage should be bound to.
+  // Empty if buffers are not bound to any node.
+  iree_host_size_t queue_count;
+  uint32_t queue_node_ids[IREE_HAL_HEAP_ALLOCATOR_MAX_QUEUE_COUNT];
+
   IREE_STATISTICS(iree_hal_heap_allocator_statistics_t statistics;)
 } iree_hal_heap_allocator_t;
 
@@ -30,8 +41,25 @@ iree_hal_heap_allocator_t* iree_hal_heap_allocator_cast(
 IREE_API_EXPORT iree_status_t iree_hal_allocator_create_heap(
     iree_string_view_t identifier, iree_allocator_t data_allocator,
     iree_allocator_t host_allocator, iree_hal_allocator_t** out_allocator) {
+  return iree_hal_allocator_create_heap_numa(identifier, /*queue_count=*/0,
+                                             /*queue_node_ids=*/NULL,
+                                             data_allocator, host_allocator,
+                                             out_allocator);
+}
+
+IREE_API_EXPORT iree_status_t iree_hal_allocator_create_heap_numa(
+    iree_string_view_t identifier, iree_host_size_t queue_count,
+    const uint32_t* queue_node_ids, iree_allocator_t data_allocator,
+    iree_allocator_t host_allocator, iree_hal_allocator_t** out_allocator) {
+  IREE_ASSERT_ARGUMENT(!queue_count || queue_node_ids);
   IREE_ASSERT_ARGUMENT(out_allocator);
   *out_allocator = NULL;
+  if (queue_count > IREE_HAL_HEAP_ALLOCATOR_MAX_QUEUE_COUNT) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "queue count %" PRIhsz
+                            " exceeds the queue affinity bit count",
+                            queue_count);
+  }
   IREE_TRACE_ZONE_BEGIN(z0);
 
   iree_hal_heap_allocator_t* allocator = NULL;
@@ -44,6 +72,10 @@ IREE_API_EXPORT iree_status_t iree_hal_allocator_create_heap(
                                  &allocator->resource);
     allocator->host_allocator = host_allocator;
     allocator->data_allocator = data_allocator;
+    allocator->queue_count = queue_count;
+    for (iree_host_size_t i = 0; i < queue_count; ++i) {
+      allocator->queue_node_ids[i] = queue_node_ids[i];
+    }
     iree_string_view_append_to_buffer(
         identifier, &allocator->identifier,
         (char*)allocator + iree_sizeof_struct(*allocator));
@@ -173,6 +205,49 @@ iree_hal_heap_allocator_query_buffer_compatibility(
   return compatibility;
 }
 
+// Selects the NUMA node that buffers used on |queue_affinity| should be placed
+// on. Returns false if the queues span multiple nodes (or none are known).
+static bool iree_hal_heap_allocator_select_node(
+    iree_hal_heap_allocator_t* allocator,
+    iree_hal_queue_affinity_t queue_affinity, uint32_t* out_node_id) {
+  bool has_node = false;
+  for (iree_host_size_t i = 0; i < allocator->queue_count; ++i) {
+    if (!(queue_affinity & (1ull << i))) continue;
+    if (has_node && allocator->queue_node_ids[i] != *out_node_id) {
+      return false;  // spans nodes
+    }
+    *out_node_id = allocator->queue_node_ids[i];
+    has_node = true;
+  }
+  return has_node;
+}
+
+// Binds the storage of |buffer| to the NUMA node of |queue_affinity|, if any.
+// Binding is only a placement hint and failures are ignored.
+static void iree_hal_heap_allocator_bind_buffer(
+    iree_hal_heap_allocator_t* allocator,
+    iree_hal_queue_affinity_t queue_affinity, iree_hal_buffer_t* buffer) {
+  uint32_t node_id = 0;
+  if (!iree_hal_heap_allocator_select_node(allocator, queue_affinity,
+                                           &node_id)) {
+    return;
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, node_id);
+  iree_hal_buffer_mapping_t mapping;
+  iree_status_t status = iree_hal_buffer_map_range(
+      buffer, IREE_HAL_MAPPING_MODE_SCOPED, IREE_HAL_MEMORY_ACCESS_ANY, 0,
+      IREE_WHOLE_BUFFER, &mapping);
+  if (iree_status_is_ok(status)) {
+    status = iree_allocator_bind(allocator->data_allocator,
+                                 mapping.contents.data,
+                                 mapping.contents.data_length, node_id);
+    status = iree_status_join(status, iree_hal_buffer_unmap_range(&mapping));
+  }
+  iree_status_ignore(status);
+  IREE_TRACE_ZONE_END(z0);
+}
+
 static iree_status_t iree_hal_heap_allocator_allocate_buffer(
     iree_hal_allocator_t* IREE_RESTRICT base_allocator,
     const iree_hal_buffer_params_t* IREE_RESTRICT params,
@@ -199,6 +274,12 @@ static iree_status_t iree_hal_heap_allocator_allocate_buffer(
       base_allocator, statistics, &compat_params, allocation_size, initial_data,
       allocator->data_allocator, allocator->host_allocator, &buffer));
 
+  // Place the storage near the workers that will use it.
+  if (allocator->queue_count > 0) {
+    iree_hal_heap_allocator_bind_buffer(allocator, compat_params.queue_affinity,
+                                        buffer);
+  }
+
   *out_buffer = buffer;
   return iree_ok_status();
 }
@@ -0,0 +1,141 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <cstdint>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+using ::iree::testing::status::StatusIs;
+
+// Data allocator that forwards to the system allocator and records the NUMA
+// node of every bind request.
+struct RecordingAllocator {
+  std::vector<uint32_t> bound_node_ids;
+
+  iree_allocator_t allocator() { return {this, Ctl}; }
+
+  static iree_status_t Ctl(void* self, iree_allocator_command_t command,
+                           const void* params, void** inout_ptr) {
+    if (command != IREE_ALLOCATOR_COMMAND_BIND) {
+      return iree_allocator_system_ctl(NULL, command, params, inout_ptr);
+    }
+    const auto* bind_params =
+        reinterpret_cast<const iree_allocator_bind_params_t*>(params);
+    reinterpret_cast<RecordingAllocator*>(self)->bound_node_ids.push_back(
+        bind_params->node_id);
+    return iree_ok_status();
+  }
+};
+
+// Allocates and immediately releases a buffer for |queue_affinity|.
+static iree_status_t AllocateBuffer(iree_hal_allocator_t* allocator,
+                                    iree_hal_queue_affinity_t queue_affinity) {
+  iree_hal_buffer_params_t params = {0};
+  params.type = IREE_HAL_MEMORY_TYPE_HOST_LOCAL;
+  params.usage = IREE_HAL_BUFFER_USAGE_DEFAULT;
+  params.queue_affinity = queue_affinity;
+  iree_hal_buffer_t* buffer = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_allocator_allocate_buffer(
+      allocator, params, 64 * 1024, iree_const_byte_span_empty(), &buffer));
+  iree_hal_buffer_release(buffer);
+  return iree_ok_status();
+}
+
+// Returns the nodes bound while allocating a buffer for |queue_affinity|.
+static std::vector<uint32_t> AllocateAndCollectBinds(
+    iree_hal_allocator_t* allocator, RecordingAllocator* recorder,
+    iree_hal_queue_affinity_t queue_affinity) {
+  recorder->bound_node_ids.clear();
+  IREE_CHECK_OK(AllocateBuffer(allocator, queue_affinity));
+  return recorder->bound_node_ids;
+}
+
+TEST(HeapAllocatorTest, NonNumaNeverBinds) {
+  RecordingAllocator recorder;
+  iree_hal_allocator_t* allocator = NULL;
+  IREE_ASSERT_OK(iree_hal_allocator_create_heap(
+      iree_make_cstring_view("test"), recorder.allocator(),
+      iree_allocator_system(), &allocator));
+  IREE_ASSERT_OK(AllocateBuffer(allocator, 1ull << 0));
+  IREE_ASSERT_OK(AllocateBuffer(allocator, IREE_HAL_QUEUE_AFFINITY_ANY));
+  EXPECT_TRUE(recorder.bound_node_ids.empty());
+  iree_hal_allocator_release(allocator);
+}
+
+TEST(HeapAllocatorTest, NumaSelectsNodeOfQueues) {
+  // Queue 0 runs on node 0 and queues 1 and 2 run on node 1.
+  RecordingAllocator recorder;
+  const uint32_t queue_node_ids[3] = {0, 1, 1};
+  iree_hal_allocator_t* allocator = NULL;
+  IREE_ASSERT_OK(iree_hal_allocator_create_heap_numa(
+      iree_make_cstring_view("test"), IREE_ARRAYSIZE(queue_node_ids),
+      queue_node_ids, recorder.allocator(), iree_allocator_system(),
+      &allocator));
+
+  // Queues on a single node bind to it.
+  EXPECT_EQ(AllocateAndCollectBinds(allocator, &recorder, 1ull << 0),
+            std::vector<uint32_t>{0});
+  EXPECT_EQ(AllocateAndCollectBinds(allocator, &recorder, 1ull << 1),
+            std::vector<uint32_t>{1});
+  EXPECT_EQ(
+      AllocateAndCollectBinds(allocator, &recorder, (1ull << 1) | (1ull << 2)),
+      std::vector<uint32_t>{1});
+
+  // Queues spanning nodes are left to first-touch placement.
+  EXPECT_TRUE(
+      AllocateAndCollectBinds(allocator, &recorder, (1ull << 0) | (1ull << 1))
+          .empty());
+  EXPECT_TRUE(AllocateAndCollectBinds(allocator, &recorder,
+                                      IREE_HAL_QUEUE_AFFINITY_ANY)
+                  .empty());
+
+  // Queues without a known node are ignored.
+  EXPECT_TRUE(
+      AllocateAndCollectBinds(allocator, &recorder, 1ull << 5).empty());
+  EXPECT_EQ(
+      AllocateAndCollectBinds(allocator, &recorder, (1ull << 0) | (1ull << 5)),
+      std::vector<uint32_t>{0});
+
+  iree_hal_allocator_release(allocator);
+}
+
+TEST(HeapAllocatorTest, NumaBindFailuresAreIgnored) {
+  // The system allocator may not support binding (or the node may not exist);
+  // allocation must succeed either way.
+  const uint32_t queue_node_ids[2] = {0, 4000};
+  iree_hal_allocator_t* allocator = NULL;
+  IREE_ASSERT_OK(iree_hal_allocator_create_heap_numa(
+      iree_make_cstring_view("test"), IREE_ARRAYSIZE(queue_node_ids),
+      queue_node_ids, iree_allocator_system(), iree_allocator_system(),
+      &allocator));
+  IREE_EXPECT_OK(AllocateBuffer(allocator, 1ull << 0));
+  IREE_EXPECT_OK(AllocateBuffer(allocator, 1ull << 1));
+  iree_hal_allocator_release(allocator);
+}
+
+TEST(HeapAllocatorTest, NumaTooManyQueues) {
+  std::vector<uint32_t> queue_node_ids(sizeof(iree_hal_queue_affinity_t) * 8 +
+                                       1);
+  iree_hal_allocator_t* allocator = NULL;
+  EXPECT_THAT(Status(iree_hal_allocator_create_heap_numa(
+                  iree_make_cstring_view("test"), queue_node_ids.size(),
+                  queue_node_ids.data(), iree_allocator_system(),
+                  iree_allocator_system(), &allocator)),
+              StatusIs(StatusCode::kOutOfRange));
+  EXPECT_EQ(allocator, nullptr);
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
@@ -437,7 +437,7 @@ iree_status_t iree_hal_command_buffer_collective_validation(
               IREE_HAL_BUFFER_COMPATIBILITY_QUEUE_DISPATCH,
               IREE_HAL_BUFFER_USAGE_DISPATCH_STORAGE_READ));
     }
-  } else {
+  } else if (send_binding.buffer) {
     return iree_make_status(
         IREE_STATUS_INVALID_ARGUMENT,
         "collective operation does not use a send buffer binding");
@@ -455,7 +455,7 @@ iree_status_t iree_hal_command_buffer_collective_validation(
               IREE_HAL_BUFFER_COMPATIBILITY_QUEUE_DISPATCH,
               IREE_HAL_BUFFER_USAGE_DISPATCH_STORAGE_WRITE));
     }
-  } else {
+  } else if (recv_binding.buffer) {
     return iree_make_status(
         IREE_STATUS_INVALID_ARGUMENT,
         "collective operation does not use a recv buffer binding");
@@ -0,0 +1,455 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_CTS_COLLECTIVE_TEST_H_
+#define IREE_HAL_CTS_COLLECTIVE_TEST_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/hal/cts/cts_test_base.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace hal {
+namespace cts {
+
+using ::testing::ContainerEq;
+
+namespace {
+// Number of participants in each collective group. Each participant uses its
+// own device and thread.
+constexpr int32_t kRankCount = 3;
+// Not a multiple of the rank count or cache line size to exercise remainders.
+constexpr iree_device_size_t kElementCount = 1000;
+}  // namespace
+
+class collective_test : public CtsTestBase {
+ protected:
+  void SetUp() override {
+    CtsTestBase::SetUp();
+    if (IsSkipped() || HasFatalFailure()) return;
+
+    // Probe for collective support with a default channel.
+    iree_hal_channel_params_t params = {0};
+    params.rank = IREE_HAL_CHANNEL_RANK_DEFAULT;
+    params.count = IREE_HAL_CHANNEL_COUNT_DEFAULT;
+    iree_hal_channel_t* channel = NULL;
+    iree_status_t status = iree_hal_channel_create(
+        device_, IREE_HAL_QUEUE_AFFINITY_ANY, params, &channel);
+    if (iree_status_is_unimplemented(status) ||
+        iree_status_is_unavailable(status)) {
+      iree_status_free(status);
+      GTEST_SKIP() << "Skipping test as collectives are not supported";
+      return;
+    }
+    IREE_ASSERT_OK(status);
+    iree_hal_channel_release(channel);
+
+    // One device per rank so that ranks can execute concurrently.
+    for (int32_t i = 0; i < kRankCount; ++i) {
+      iree_hal_device_t* device = NULL;
+      IREE_ASSERT_OK(iree_hal_driver_create_default_device(
+          driver_, iree_allocator_system(), &device));
+      rank_devices_.push_back(device);
+    }
+  }
+
+  void TearDown() override {
+    for (iree_hal_device_t* device : rank_devices_) {
+      iree_hal_device_release(device);
+    }
+    rank_devices_.clear();
+    CtsTestBase::TearDown();
+  }
+
+  using RankFn = std::function<iree_status_t(
+      int32_t rank, iree_hal_device_t* device, iree_hal_channel_t* channel)>;
+
+  // Runs |fn| concurrently for each rank with a channel in group |group|.
+  void RunOnAllRanks(const char* group, RankFn fn) {
+    std::vector<iree_status_t> statuses(kRankCount, iree_ok_status());
+    std::vector<std::thread> threads;
+    for (int32_t rank = 0; rank < kRankCount; ++rank) {
+      threads.emplace_back([&, rank]() {
+        iree_hal_device_t* device = rank_devices_[rank];
+        iree_hal_channel_params_t params = {0};
+        params.group = iree_make_cstring_view(group);
+        params.rank = rank;
+        params.count = kRankCount;
+        iree_hal_channel_t* channel = NULL;
+        iree_status_t status = iree_hal_channel_create(
+            device, IREE_HAL_QUEUE_AFFINITY_ANY, params, &channel);
+        if (iree_status_is_ok(status)) {
+          status = fn(rank, device, channel);
+        }
+        iree_hal_channel_release(channel);
+        statuses[rank] = status;
+      });
+    }
+    for (auto& thread : threads) thread.join();
+    for (int32_t rank = 0; rank < kRankCount; ++rank) {
+      IREE_EXPECT_OK(statuses[rank]) << "rank " << rank;
+    }
+  }
+
+  // Allocates a host-visible buffer on |device| containing |data|.
+  static iree_status_t AllocateBuffer(iree_hal_device_t* device,
+                                      const std::vector<float>& data,
+                                      iree_hal_buffer_t** out_buffer) {
+    iree_hal_buffer_params_t params = {0};
+    params.type =
+        IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL | IREE_HAL_MEMORY_TYPE_HOST_VISIBLE;
+    params.usage = IREE_HAL_BUFFER_USAGE_DISPATCH_STORAGE |
+                   IREE_HAL_BUFFER_USAGE_TRANSFER |
+                   IREE_HAL_BUFFER_USAGE_MAPPING;
+    return iree_hal_allocator_allocate_buffer(
+        iree_hal_device_allocator(device), params, data.size() * sizeof(float),
+        iree_make_const_byte_span(data.data(), data.size() * sizeof(float)),
+        out_buffer);
+  }
+
+  // Executes a collective |op| on |device| and waits for it to complete.
+  // |send_data| or |recv_data| may be empty if the rank does not use them.
+  // |recv_data| is updated with the results.
+  static iree_status_t RunCollective(iree_hal_device_t* device,
+                                     iree_hal_channel_t* channel,
+                                     iree_hal_collective_op_t op,
+                                     uint32_t param,
+                                     const std::vector<float>& send_data,
+                                     std::vector<float>* recv_data,
+                                     iree_device_size_t element_count) {
+    iree_hal_buffer_t* send_buffer = NULL;
+    iree_hal_buffer_t* recv_buffer = NULL;
+    iree_hal_command_buffer_t* command_buffer = NULL;
+    iree_hal_semaphore_t* semaphore = NULL;
+    iree_status_t status = iree_ok_status();
+    if (!send_data.empty()) {
+      status = AllocateBuffer(device, send_data, &send_buffer);
+    }
+    if (iree_status_is_ok(status) && !recv_data->empty()) {
+      status = AllocateBuffer(device, *recv_data, &recv_buffer);
+    }
+    if (iree_status_is_ok(status)) {
+      status = iree_hal_command_buffer_create(
+          device, IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT,
+          IREE_HAL_COMMAND_CATEGORY_ANY, IREE_HAL_QUEUE_AFFINITY_ANY,
+          /*binding_capacity=*/0, &command_buffer);
+    }
+    if (iree_status_is_ok(status)) {
+      status = iree_hal_command_buffer_begin(command_buffer);
+    }
+    if (iree_status_is_ok(status)) {
+      iree_hal_buffer_binding_t send_binding = {send_buffer, 0,
+                                                IREE_WHOLE_BUFFER};
+      iree_hal_buffer_binding_t recv_binding = {recv_buffer, 0,
+                                                IREE_WHOLE_BUFFER};
+      status = iree_hal_command_buffer_collective(
+          command_buffer, channel, op, param, send_binding, recv_binding,
+          element_count);
+    }
+    if (iree_status_is_ok(status)) {
+      status = iree_hal_command_buffer_end(command_buffer);
+    }
+    if (iree_status_is_ok(status)) {
+      status = iree_hal_semaphore_create(device, 0ull, &semaphore);
+    }
+    if (iree_status_is_ok(status)) {
+      uint64_t signal_value = 1ull;
+      iree_hal_semaphore_list_t signal_semaphores = {
+          /*count=*/1,
+          /*semaphores=*/&semaphore,
+          /*payload_values=*/&signal_value,
+      };
+      status = iree_hal_device_queue_execute(
+          device, IREE_HAL_QUEUE_AFFINITY_ANY, iree_hal_semaphore_list_empty(),
+          signal_semaphores, 1, &command_buffer);
+      if (iree_status_is_ok(status)) {
+        status = iree_hal_semaphore_wait(semaphore, signal_value,
+                                         iree_infinite_timeout());
+      }
+    }
+    if (iree_status_is_ok(status) && recv_buffer) {
+      status = iree_hal_buffer_map_read(recv_buffer, 0, recv_data->data(),
+                                        recv_data->size() * sizeof(float));
+    }
+    iree_hal_semaphore_release(semaphore);
+    iree_hal_command_buffer_release(command_buffer);
+    iree_hal_buffer_release(recv_buffer);
+    iree_hal_buffer_release(send_buffer);
+    return status;
+  }
+
+  // Returns kElementCount values unique to |rank|.
+  static std::vector<float> MakeRankData(int32_t rank,
+                                         iree_device_size_t count) {
+    std::vector<float> data(count);
+    for (iree_device_size_t i = 0; i < count; ++i) {
+      data[i] = (float)((rank + 1) * 1000 + i % 1000);
+    }
+    return data;
+  }
+
+  static iree_hal_collective_op_t MakeOp(
+      iree_hal_collective_kind_t kind,
+      iree_hal_collective_reduction_t reduction) {
+    iree_hal_collective_op_t op = {0};
+    op.kind = kind;
+    op.reduction = reduction;
+    op.element_type = IREE_HAL_COLLECTIVE_ELEMENT_TYPE_FLOAT_32;
+    return op;
+  }
+
+  std::vector<iree_hal_device_t*> rank_devices_;
+};
+
+TEST_P(collective_test, DefaultChannelIsStandalone) {
+  iree_hal_channel_params_t params = {0};
+  params.rank = IREE_HAL_CHANNEL_RANK_DEFAULT;
+  params.count = IREE_HAL_CHANNEL_COUNT_DEFAULT;
+  iree_hal_channel_t* channel = NULL;
+  IREE_ASSERT_OK(iree_hal_channel_create(device_, IREE_HAL_QUEUE_AFFINITY_ANY,
+                                         params, &channel));
+  int32_t rank = -1;
+  int32_t count = -1;
+  iree_hal_channel_query_rank_and_count(channel, &rank, &count);
+  EXPECT_EQ(rank, 0);
+  EXPECT_EQ(count, 1);
+
+  // A single participant all-reduce is a copy.
+  std::vector<float> send_data = MakeRankData(0, kElementCount);
+  std::vector<float> recv_data(kElementCount, 0.0f);
+  IREE_ASSERT_OK(RunCollective(
+      device_, channel,
+      MakeOp(IREE_HAL_COLLECTIVE_KIND_ALL_REDUCE,
+             IREE_HAL_COLLECTIVE_REDUCTION_SUM),
+      /*param=*/0, send_data, &recv_data, kElementCount));
+  EXPECT_THAT(recv_data, ContainerEq(send_data));
+
+  iree_hal_channel_release(channel);
+}
+
+TEST_P(collective_test, AllReduceSum) {
+  std::vector<float> expected(kElementCount, 0.0f);
+  for (int32_t rank = 0; rank < kRankCount; ++rank) {
+    std::vector<float> data = MakeRankData(rank, kElementCount);
+    for (iree_device_size_t i = 0; i < kElementCount; ++i) {
+      expected[i] += data[i];
+    }
+  }
+  RunOnAllRanks("cts_all_reduce", [&](int32_t rank, iree_hal_device_t* device,
+                                      iree_hal_channel_t* channel) {
+    std::vector<float> recv_data(kElementCount, 0.0f);
+    IREE_RETURN_IF_ERROR(RunCollective(
+        device, channel,
+        MakeOp(IREE_HAL_COLLECTIVE_KIND_ALL_REDUCE,
+               IREE_HAL_COLLECTIVE_REDUCTION_SUM),
+        /*param=*/0, MakeRankData(rank, kElementCount), &recv_data,
+        kElementCount));
+    EXPECT_THAT(recv_data, ContainerEq(expected)) << "rank " << rank;
+    return iree_ok_status();
+  });
+}
+
+TEST_P(collective_test, AllGather) {
+  std::vector<float> expected;
+  for (int32_t rank = 0; rank < kRankCount; ++rank) {
+    std::vector<float> data = MakeRankData(rank, kElementCount);
+    expected.insert(expected.end(), data.begin(), data.end());
+  }
+  RunOnAllRanks("cts_all_gather", [&](int32_t rank, iree_hal_device_t* device,
+                                      iree_hal_channel_t* channel) {
+    std::vector<float> recv_data(kElementCount * kRankCount, 0.0f);
+    IREE_RETURN_IF_ERROR(RunCollective(
+        device, channel,
+        MakeOp(IREE_HAL_COLLECTIVE_KIND_ALL_GATHER,
+               IREE_HAL_COLLECTIVE_REDUCTION_NONE),
+        /*param=*/0, MakeRankData(rank, kElementCount), &recv_data,
+        kElementCount));
+    EXPECT_THAT(recv_data, ContainerEq(expected)) << "rank " << rank;
+    return iree_ok_status();
+  });
+}
+
+TEST_P(collective_test, ReduceScatterMax) {
+  // Each rank sends kRankCount blocks and receives the maximum of its block.
+  std::vector<std::vector<float>> send_data(kRankCount);
+  for (int32_t rank = 0; rank < kRankCount; ++rank) {
+    send_data[rank] = MakeRankData((rank * 7) % kRankCount,
+                                   kElementCount * kRankCount);
+  }
+  RunOnAllRanks("cts_reduce_scatter", [&](int32_t rank,
+                                          iree_hal_device_t* device,
+                                          iree_hal_channel_t* channel) {
+    std::vector<float> recv_data(kElementCount, 0.0f);
+    IREE_RETURN_IF_ERROR(RunCollective(
+        device, channel,
+        MakeOp(IREE_HAL_COLLECTIVE_KIND_REDUCE_SCATTER,
+               IREE_HAL_COLLECTIVE_REDUCTION_MAXIMUM),
+        /*param=*/0, send_data[rank], &recv_data, kElementCount));
+    std::vector<float> expected(kElementCount);
+    for (iree_device_size_t i = 0; i < kElementCount; ++i) {
+      float value = send_data[0][rank * kElementCount + i];
+      for (int32_t j = 1; j < kRankCount; ++j) {
+        value = std::max(value, send_data[j][rank * kElementCount + i]);
+      }
+      expected[i] = value;
+    }
+    EXPECT_THAT(recv_data, ContainerEq(expected)) << "rank " << rank;
+    return iree_ok_status();
+  });
+}
+
+TEST_P(collective_test, Broadcast) {
+  const int32_t root = kRankCount - 1;
+  std::vector<float> expected = MakeRankData(root, kElementCount);
+  RunOnAllRanks("cts_broadcast", [&](int32_t rank, iree_hal_device_t* device,
+                                     iree_hal_channel_t* channel) {
+    std::vector<float> recv_data(kElementCount, 0.0f);
+    IREE_RETURN_IF_ERROR(RunCollective(
+        device, channel,
+        MakeOp(IREE_HAL_COLLECTIVE_KIND_BROADCAST,
+               IREE_HAL_COLLECTIVE_REDUCTION_NONE),
+        /*param=*/root, MakeRankData(rank, kElementCount), &recv_data,
+        kElementCount));
+    EXPECT_THAT(recv_data, ContainerEq(expected)) << "rank " << rank;
+    return iree_ok_status();
+  });
+}
+
+TEST_P(collective_test, ReduceSum) {
+  const int32_t root = 1;
+  std::vector<float> expected(kElementCount, 0.0f);
+  for (int32_t rank = 0; rank < kRankCount; ++rank) {
+    std::vector<float> data = MakeRankData(rank, kElementCount);
+    for (iree_device_size_t i = 0; i < kElementCount; ++i) {
+      expected[i] += data[i];
+    }
+  }
+  RunOnAllRanks("cts_reduce", [&](int32_t rank, iree_hal_device_t* device,
+                                  iree_hal_channel_t* channel) {
+    std::vector<float> recv_data(kElementCount, 0.0f);
+    IREE_RETURN_IF_ERROR(RunCollective(
+        device, channel,
+        MakeOp(IREE_HAL_COLLECTIVE_KIND_REDUCE,
+               IREE_HAL_COLLECTIVE_REDUCTION_SUM),
+        /*param=*/root, MakeRankData(rank, kElementCount), &recv_data,
+        kElementCount));
+    if (rank == root) {
+      EXPECT_THAT(recv_data, ContainerEq(expected));
+    }
+    return iree_ok_status();
+  });
+}
+
+TEST_P(collective_test, AllToAll) {
+  const iree_device_size_t element_count = kElementCount / 10 * kRankCount;
+  const iree_device_size_t part_count = element_count / kRankCount;
+  RunOnAllRanks("cts_all_to_all", [&](int32_t rank, iree_hal_device_t* device,
+                                      iree_hal_channel_t* channel) {
+    std::vector<float> recv_data(element_count, 0.0f);
+    IREE_RETURN_IF_ERROR(RunCollective(
+        device, channel,
+        MakeOp(IREE_HAL_COLLECTIVE_KIND_ALL_TO_ALL,
+               IREE_HAL_COLLECTIVE_REDUCTION_NONE),
+        /*param=*/0, MakeRankData(rank, element_count), &recv_data,
+        element_count));
+    std::vector<float> expected;
+    for (int32_t i = 0; i < kRankCount; ++i) {
+      std::vector<float> data = MakeRankData(i, element_count);
+      expected.insert(expected.end(), data.begin() + rank * part_count,
+                      data.begin() + (rank + 1) * part_count);
+    }
+    EXPECT_THAT(recv_data, ContainerEq(expected)) << "rank " << rank;
+    return iree_ok_status();
+  });
+}
+
+TEST_P(collective_test, SendRecvRing) {
+  // Each rank sends to the next rank and receives from the previous one. The
+  // first rank receives nothing and gets zeros.
+  RunOnAllRanks("cts_send_recv", [&](int32_t rank, iree_hal_device_t* device,
+                                     iree_hal_channel_t* channel) {
+    const int16_t target = rank + 1 < kRankCount ? rank + 1 : -1;
+    const int16_t source = rank > 0 ? rank - 1 : -1;
+    const uint32_t param =
+        ((uint32_t)(uint16_t)source << 16) | (uint32_t)(uint16_t)target;
+    std::vector<float> recv_data(kElementCount, 1.0f);
+    IREE_RETURN_IF_ERROR(RunCollective(
+        device, channel,
+        MakeOp(IREE_HAL_COLLECTIVE_KIND_SEND_RECV,
+               IREE_HAL_COLLECTIVE_REDUCTION_NONE),
+        param, MakeRankData(rank, kElementCount), &recv_data, kElementCount));
+    std::vector<float> expected =
+        source == -1 ? std::vector<float>(kElementCount, 0.0f)
+                     : MakeRankData(source, kElementCount);
+    EXPECT_THAT(recv_data, ContainerEq(expected)) << "rank " << rank;
+    return iree_ok_status();
+  });
+}
+
+TEST_P(collective_test, SendThenRecv) {
+  RunOnAllRanks("cts_send", [&](int32_t rank, iree_hal_device_t* device,
+                                iree_hal_channel_t* channel) {
+    std::vector<float> recv_data;
+    if (rank == 0) {
+      return RunCollective(device, channel,
+                           MakeOp(IREE_HAL_COLLECTIVE_KIND_SEND,
+                                  IREE_HAL_COLLECTIVE_REDUCTION_NONE),
+                           /*param=*/kRankCount - 1,
+                           MakeRankData(rank, kElementCount), &recv_data,
+                           kElementCount);
+    } else if (rank == kRankCount - 1) {
+      recv_data.resize(kElementCount, 0.0f);
+      IREE_RETURN_IF_ERROR(RunCollective(
+          device, channel,
+          MakeOp(IREE_HAL_COLLECTIVE_KIND_RECV,
+                 IREE_HAL_COLLECTIVE_REDUCTION_NONE),
+          /*param=*/0, /*send_data=*/{}, &recv_data, kElementCount));
+      EXPECT_THAT(recv_data, ContainerEq(MakeRankData(0, kElementCount)));
+    }
+    return iree_ok_status();
+  });
+}
+
+TEST_P(collective_test, Split) {
+  // Splits ranks into even and odd groups with reversed order.
+  RunOnAllRanks("cts_split", [&](int32_t rank, iree_hal_device_t* device,
+                                 iree_hal_channel_t* channel) {
+    iree_hal_channel_t* split_channel = NULL;
+    IREE_RETURN_IF_ERROR(iree_hal_channel_split(
+        channel, /*color=*/rank % 2, /*key=*/-rank,
+        IREE_HAL_CHANNEL_FLAG_NONE, &split_channel));
+    int32_t expected_count = 0;
+    int32_t expected_rank = 0;
+    for (int32_t i = 0; i < kRankCount; ++i) {
+      if (i % 2 != rank % 2) continue;
+      ++expected_count;
+      if (i > rank) ++expected_rank;
+    }
+    int32_t split_rank = -1;
+    int32_t split_count = -1;
+    iree_hal_channel_query_rank_and_count(split_channel, &split_rank,
+                                          &split_count);
+    EXPECT_EQ(split_rank, expected_rank) << "rank " << rank;
+    EXPECT_EQ(split_count, expected_count) << "rank " << rank;
+    iree_hal_channel_release(split_channel);
+    return iree_ok_status();
+  });
+}
+
+}  // namespace cts
+}  // namespace hal
+}  // namespace iree
+
+#endif  // IREE_HAL_CTS_COLLECTIVE_TEST_H_
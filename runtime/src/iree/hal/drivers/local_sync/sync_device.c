@@ -15,6 +15,7 @@
 #include "iree/hal/drivers/local_sync/sync_event.h"
 #include "iree/hal/drivers/local_sync/sync_semaphore.h"
 #include "iree/hal/local/executable_environment.h"
+#include "iree/hal/local/local_channel.h"
 #include "iree/hal/local/inline_command_buffer.h"
 #include "iree/hal/local/local_executable_cache.h"
 #include "iree/hal/local/local_pipeline_layout.h"
@@ -214,8 +215,13 @@ static iree_status_t iree_hal_sync_device_query_i64(
 static iree_status_t iree_hal_sync_device_create_channel(
     iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity,
     iree_hal_channel_params_t params, iree_hal_channel_t** out_channel) {
-  return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
-                          "collectives not implemented");
+  iree_hal_sync_device_t* device = iree_hal_sync_device_cast(base_device);
+  // Collectives execute on the thread submitting them and the caller is
+  // responsible for submitting each rank from its own thread.
+  return iree_hal_local_channel_create(
+      device->channel_provider, params,
+      iree_hal_local_channel_executor_inline(), device->host_allocator,
+      out_channel);
 }
 
 static iree_status_t iree_hal_sync_device_create_command_buffer(
@@ -65,12 +65,27 @@ static iree_status_t iree_hal_local_task_driver_factory_try_create(
         host_allocator);
   }
 
+  // When running with multiple NUMA nodes each queue maps to the executor for
+  // that node and buffers allocated for a particular queue are placed on it.
+  uint32_t queue_node_ids[IREE_ARRAYSIZE(executor_storage)];
+  iree_host_size_t queue_node_count = 0;
+  if (executor_count > 1) {
+    queue_node_count = executor_count;
+    for (iree_host_size_t i = 0; i < executor_count; ++i) {
+      queue_node_ids[i] = iree_task_executor_node_id(executors[i]);
+      if (queue_node_ids[i] == IREE_TASK_TOPOLOGY_NODE_ID_ANY) {
+        queue_node_count = 0;  // unpinned; let the system place memory
+        break;
+      }
+    }
+  }
+
   // TODO(benvanik): allow this to be injected to share across drivers.
   iree_hal_allocator_t* device_allocator = NULL;
   if (iree_status_is_ok(status)) {
-    status = iree_hal_allocator_create_heap(iree_make_cstring_view("local"),
-                                            host_allocator, host_allocator,
-                                            &device_allocator);
+    status = iree_hal_allocator_create_heap_numa(
+        iree_make_cstring_view("local"), queue_node_count, queue_node_ids,
+        host_allocator, host_allocator, &device_allocator);
   }
 
   // Create a task driver that will use the given executors for scheduling work
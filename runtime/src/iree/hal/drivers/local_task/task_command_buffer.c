@@ -14,6 +14,7 @@
 #include "iree/base/api.h"
 #include "iree/hal/local/executable_environment.h"
 #include "iree/hal/local/executable_library.h"
+#include "iree/hal/local/local_channel.h"
 #include "iree/hal/local/local_executable.h"
 #include "iree/hal/local/local_pipeline_layout.h"
 #include "iree/hal/utils/resource_set.h"
@@ -699,31 +700,95 @@ static iree_status_t iree_hal_task_command_buffer_copy_buffer(
 // iree_hal_command_buffer_collective
 //===----------------------------------------------------------------------===//
 
+typedef struct iree_hal_cmd_collective_t {
+  iree_task_call_t task;
+  iree_hal_channel_t* channel;
+  iree_hal_collective_op_t op;
+  uint32_t param;
+  iree_const_byte_span_t send;
+  iree_byte_span_t recv;
+  iree_device_size_t element_count;
+} iree_hal_cmd_collective_t;
+
+static iree_status_t iree_hal_cmd_collective(
+    void* user_context, iree_task_t* task,
+    iree_task_submission_t* pending_submission) {
+  const iree_hal_cmd_collective_t* cmd =
+      (const iree_hal_cmd_collective_t*)user_context;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  // NOTE: this blocks the worker until all other ranks have arrived. Channel
+  // creation verified that the executor has a worker for every rank sharing
+  // it so this cannot starve the other ranks of the group.
+  iree_status_t status = iree_hal_local_channel_execute_collective(
+      cmd->channel, cmd->op, cmd->param, cmd->send, cmd->recv,
+      cmd->element_count);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Maps |binding| persistently for use during execution. Bindings without a
+// buffer are mapped to an empty span. Local buffers are host memory so the
+// mapping needs no unmap or flush and stays valid as long as the resource set
+// retains the buffer.
+static iree_status_t iree_hal_task_command_buffer_map_collective_binding(
+    iree_hal_task_command_buffer_t* command_buffer,
+    iree_hal_buffer_binding_t binding, iree_byte_span_t* out_span) {
+  *out_span = iree_make_byte_span(NULL, 0);
+  if (!binding.buffer) return iree_ok_status();
+  IREE_RETURN_IF_ERROR(iree_hal_resource_set_insert(
+      command_buffer->resource_set, 1, &binding.buffer));
+  iree_hal_buffer_mapping_t buffer_mapping = {{0}};
+  IREE_RETURN_IF_ERROR(iree_hal_buffer_map_range(
+      binding.buffer, IREE_HAL_MAPPING_MODE_PERSISTENT,
+      IREE_HAL_MEMORY_ACCESS_ANY, binding.offset, binding.length,
+      &buffer_mapping));
+  *out_span = buffer_mapping.contents;
+  return iree_ok_status();
+}
+
 static iree_status_t iree_hal_task_command_buffer_collective(
     iree_hal_command_buffer_t* base_command_buffer, iree_hal_channel_t* channel,
     iree_hal_collective_op_t op, uint32_t param,
     iree_hal_buffer_binding_t send_binding,
     iree_hal_buffer_binding_t recv_binding, iree_device_size_t element_count) {
-  // The channel can be used as a vtable if we want to inject collective APIs -
-  // the device creation function would set up the channel once and we'll
-  // receive it here each time. When interacting with the task system we want to
-  // get wait handles we can model with iree_task_wait_t.
-  //
-  // An example basic flow:
-  //   insert iree_task_call_t:
-  //     chains with prior commands and makes the collective API call
-  //   insert iree_task_wait_t with API wait handle or our event:
-  //     chains with call
-  //
-  // What we probably want to do, though, is group the commands based on
-  // execution barriers. When a new collective command comes in we should
-  // reserve an event from the event pool, create the call to issue the
-  // collective operation, and then track the event in the command buffer state.
-  // When another collective call comes in we'll do the same and append the
-  // event. At the next execution barrier (or non-collective command) we'd
-  // flush to a multi-wait on all of the pending events.
-  return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
-                          "collectives not yet implemented on the task system");
+  iree_hal_task_command_buffer_t* command_buffer =
+      iree_hal_task_command_buffer_cast(base_command_buffer);
+  if (!iree_hal_local_channel_isa(channel)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "collective channel was not created by a local "
+                            "device");
+  }
+
+  // Ranks executing on other devices may access the buffers directly so they
+  // must be host-mappable. Mapping once here avoids per-execution overhead.
+  iree_byte_span_t send = iree_make_byte_span(NULL, 0);
+  iree_byte_span_t recv = iree_make_byte_span(NULL, 0);
+  IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_map_collective_binding(
+      command_buffer, send_binding, &send));
+  IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_map_collective_binding(
+      command_buffer, recv_binding, &recv));
+  IREE_RETURN_IF_ERROR(iree_hal_local_channel_validate_collective(
+      channel, op, param, send.data_length, recv.data_length, element_count));
+  IREE_RETURN_IF_ERROR(iree_hal_resource_set_insert(
+      command_buffer->resource_set, 1, &channel));
+
+  iree_hal_cmd_collective_t* cmd = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_arena_allocate(&command_buffer->arena, sizeof(*cmd), (void**)&cmd));
+
+  iree_task_call_initialize(
+      command_buffer->scope,
+      iree_task_make_call_closure(iree_hal_cmd_collective, (void*)cmd),
+      &cmd->task);
+  cmd->channel = channel;
+  cmd->op = op;
+  cmd->param = param;
+  cmd->send = iree_make_const_byte_span(send.data, send.data_length);
+  cmd->recv = recv;
+  cmd->element_count = element_count;
+
+  return iree_hal_task_command_buffer_emit_execution_task(command_buffer,
+                                                          &cmd->task.header);
 }
 
 //===----------------------------------------------------------------------===//
@@ -784,8 +849,7 @@ static iree_status_t iree_hal_task_command_buffer_push_descriptor_set(
     IREE_RETURN_IF_ERROR(iree_hal_resource_set_insert(
         command_buffer->resource_set, 1, &bindings[i].buffer));
 
-    // TODO(benvanik): track mapping so we can properly map/unmap/flush/etc.
-    iree_hal_buffer_mapping_t buffer_mapping = {{0}};
+      iree_hal_buffer_mapping_t buffer_mapping = {{0}};
     if (bindings[i].buffer) {
       IREE_RETURN_IF_ERROR(iree_hal_buffer_map_range(
           bindings[i].buffer, IREE_HAL_MAPPING_MODE_PERSISTENT,
@@ -1003,7 +1067,6 @@ static iree_status_t iree_hal_task_command_buffer_dispatch_indirect(
   IREE_RETURN_IF_ERROR(
       iree_hal_resource_set_insert(command_buffer->resource_set, 2, resources));
 
-  // TODO(benvanik): track mapping so we can properly map/unmap/flush/etc.
   iree_hal_buffer_mapping_t buffer_mapping = {{0}};
   IREE_RETURN_IF_ERROR(iree_hal_buffer_map_range(
       workgroups_buffer, IREE_HAL_MAPPING_MODE_PERSISTENT,
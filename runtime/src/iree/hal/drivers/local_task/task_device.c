@@ -17,6 +17,7 @@
 #include "iree/hal/drivers/local_task/task_queue.h"
 #include "iree/hal/drivers/local_task/task_semaphore.h"
 #include "iree/hal/local/executable_environment.h"
+#include "iree/hal/local/local_channel.h"
 #include "iree/hal/local/local_executable_cache.h"
 #include "iree/hal/local/local_pipeline_layout.h"
 #include "iree/hal/utils/buffer_transfer.h"
@@ -41,6 +42,12 @@ typedef struct iree_hal_task_device_t {
   // Optional provider used for creating/configuring collective channels.
   iree_hal_channel_provider_t* channel_provider;
 
+  // Unique threadless executors used by the queues. Threads waiting on the
+  // device semaphores donate themselves to these as nothing else will run the
+  // work they are waiting on.
+  iree_host_size_t threadless_executor_count;
+  iree_task_executor_t** threadless_executors;
+
   iree_host_size_t queue_count;
   iree_hal_task_queue_t queues[];
 } iree_hal_task_device_t;
@@ -97,9 +104,10 @@ iree_status_t iree_hal_task_device_create(
       z0, iree_hal_task_device_check_params(params, queue_count));
 
   iree_hal_task_device_t* device = NULL;
-  iree_host_size_t struct_size = sizeof(*device) +
-                                 queue_count * sizeof(*device->queues) +
-                                 loader_count * sizeof(*device->loaders);
+  iree_host_size_t struct_size =
+      sizeof(*device) + queue_count * sizeof(*device->queues) +
+      loader_count * sizeof(*device->loaders) +
+      queue_count * sizeof(*device->threadless_executors);
   iree_host_size_t total_size = struct_size + identifier.size;
   iree_status_t status =
       iree_allocator_malloc(host_allocator, total_size, (void**)&device);
@@ -134,6 +142,27 @@ iree_status_t iree_hal_task_device_create(
                                      &device->small_block_pool,
                                      &device->queues[i]);
     }
+
+    // Queues may share executors so only track each threadless one once. The
+    // queues retain the executors for the lifetime of the device.
+    device->threadless_executors =
+        (iree_task_executor_t**)((uint8_t*)device->loaders +
+                                 loader_count * sizeof(*device->loaders));
+    for (iree_host_size_t i = 0; i < device->queue_count; ++i) {
+      iree_task_executor_t* executor = queue_executors[i];
+      if (!iree_all_bits_set(iree_task_executor_flags(executor),
+                             IREE_TASK_EXECUTOR_FLAG_THREADLESS)) {
+        continue;
+      }
+      bool is_unique = true;
+      for (iree_host_size_t j = 0; j < device->threadless_executor_count; ++j) {
+        if (device->threadless_executors[j] == executor) is_unique = false;
+      }
+      if (is_unique) {
+        device->threadless_executors[device->threadless_executor_count++] =
+            executor;
+      }
+    }
   }
 
   if (iree_status_is_ok(status)) {
@@ -272,8 +301,21 @@ static iree_host_size_t iree_hal_task_device_select_queue(
 static iree_status_t iree_hal_task_device_create_channel(
     iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity,
     iree_hal_channel_params_t params, iree_hal_channel_t** out_channel) {
-  return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
-                          "collectives not implemented");
+  iree_hal_task_device_t* device = iree_hal_task_device_cast(base_device);
+  // Collectives block a worker of the executor they are submitted to until all
+  // ranks arrive. Executors may be shared with other devices from the same
+  // driver (and with other ranks) so they are identified by pointer.
+  iree_task_executor_t* executor =
+      device->queues[iree_hal_task_device_select_queue(
+                         device, IREE_HAL_COMMAND_CATEGORY_ANY, queue_affinity)]
+          .executor;
+  iree_hal_local_channel_executor_t channel_executor = {
+      .key = executor,
+      .concurrency = iree_task_executor_worker_count(executor),
+  };
+  return iree_hal_local_channel_create(device->channel_provider, params,
+                                       channel_executor, device->host_allocator,
+                                       out_channel);
 }
 
 static iree_status_t iree_hal_task_device_create_command_buffer(
@@ -340,8 +382,9 @@ static iree_status_t iree_hal_task_device_create_semaphore(
     iree_hal_semaphore_t** out_semaphore) {
   iree_hal_task_device_t* device = iree_hal_task_device_cast(base_device);
   return iree_hal_task_semaphore_create(
-      iree_hal_task_device_shared_event_pool(device), initial_value,
-      device->host_allocator, out_semaphore);
+      iree_hal_task_device_shared_event_pool(device),
+      device->threadless_executor_count, device->threadless_executors,
+      initial_value, device->host_allocator, out_semaphore);
 }
 
 static iree_hal_semaphore_compatibility_t
@@ -417,7 +460,8 @@ static iree_status_t iree_hal_task_device_wait_semaphores(
     const iree_hal_semaphore_list_t semaphore_list, iree_timeout_t timeout) {
   iree_hal_task_device_t* device = iree_hal_task_device_cast(base_device);
   return iree_hal_task_semaphore_multi_wait(
-      wait_mode, semaphore_list, timeout,
+      wait_mode, semaphore_list, timeout, device->threadless_executor_count,
+      device->threadless_executors,
       iree_hal_task_device_shared_event_pool(device),
       &device->large_block_pool);
 }
@@ -7,10 +7,20 @@
 #include "iree/hal/drivers/local_task/task_driver.h"
 
 #include <stddef.h>
+#include <stdio.h>
 #include <string.h>
 
 #define IREE_HAL_TASK_DEVICE_ID_DEFAULT 0
 
+// Devices that only use a single queue (and executor) of the driver have IDs
+// starting at this value such that the device ID is the base plus the queue
+// ordinal. This allows for one device per NUMA node when the driver has been
+// created with one executor per node.
+#define IREE_HAL_TASK_DEVICE_ID_QUEUE_BASE 1
+
+// Maximum length of a single queue device path (`node123` or `queue123`).
+#define IREE_HAL_TASK_DEVICE_PATH_MAX_LENGTH 32
+
 typedef struct iree_hal_task_driver_t {
   iree_hal_resource_t resource;
   iree_allocator_t host_allocator;
@@ -116,21 +126,65 @@ static void iree_hal_task_driver_destroy(iree_hal_driver_t* base_driver) {
   IREE_TRACE_ZONE_END(z0);
 }
 
+// Returns the number of single-queue devices exposed by the driver. The default
+// device uses all queues and when there are multiple queues (such as one per
+// NUMA node) each is also exposed as its own device.
+static iree_host_size_t iree_hal_task_driver_queue_device_count(
+    iree_hal_task_driver_t* driver) {
+  return driver->queue_count > 1 ? driver->queue_count : 0;
+}
+
+// Formats the path of the device using only the queue |queue_ordinal|.
+// Queues with executors associated with a NUMA node are named by the node.
+static iree_string_view_t iree_hal_task_driver_format_queue_path(
+    iree_hal_task_driver_t* driver, iree_host_size_t queue_ordinal,
+    char buffer[IREE_HAL_TASK_DEVICE_PATH_MAX_LENGTH]) {
+  const iree_task_topology_node_id_t node_id =
+      iree_task_executor_node_id(driver->queue_executors[queue_ordinal]);
+  int length =
+      node_id == IREE_TASK_TOPOLOGY_NODE_ID_ANY
+          ? snprintf(buffer, IREE_HAL_TASK_DEVICE_PATH_MAX_LENGTH,
+                     "queue%" PRIhsz, queue_ordinal)
+          : snprintf(buffer, IREE_HAL_TASK_DEVICE_PATH_MAX_LENGTH, "node%u",
+                     node_id);
+  return iree_make_string_view(buffer, length > 0 ? length : 0);
+}
+
 static iree_status_t iree_hal_task_driver_query_available_devices(
     iree_hal_driver_t* base_driver, iree_allocator_t host_allocator,
     iree_host_size_t* out_device_info_count,
     iree_hal_device_info_t** out_device_infos) {
-  static const iree_hal_device_info_t device_infos[1] = {
-      {
-          .device_id = IREE_HAL_TASK_DEVICE_ID_DEFAULT,
-          .name = iree_string_view_literal("default"),
-      },
+  iree_hal_task_driver_t* driver = iree_hal_task_driver_cast(base_driver);
+
+  const iree_host_size_t queue_device_count =
+      iree_hal_task_driver_queue_device_count(driver);
+  const iree_host_size_t device_count = 1 + queue_device_count;
+
+  iree_hal_device_info_t* device_infos = NULL;
+  iree_host_size_t total_size =
+      device_count * sizeof(*device_infos) +
+      queue_device_count * IREE_HAL_TASK_DEVICE_PATH_MAX_LENGTH;
+  IREE_RETURN_IF_ERROR(
+      iree_allocator_malloc(host_allocator, total_size, (void**)&device_infos));
+  device_infos[0] = (iree_hal_device_info_t){
+      .device_id = IREE_HAL_TASK_DEVICE_ID_DEFAULT,
+      .name = iree_string_view_literal("default"),
   };
-  *out_device_info_count = IREE_ARRAYSIZE(device_infos);
-  return iree_allocator_clone(
-      host_allocator,
-      iree_make_const_byte_span(device_infos, sizeof(device_infos)),
-      (void**)out_device_infos);
+  char* string_buffer = (char*)(device_infos + device_count);
+  for (iree_host_size_t i = 0; i < queue_device_count; ++i) {
+    iree_string_view_t path =
+        iree_hal_task_driver_format_queue_path(driver, i, string_buffer);
+    string_buffer += IREE_HAL_TASK_DEVICE_PATH_MAX_LENGTH;
+    device_infos[1 + i] = (iree_hal_device_info_t){
+        .device_id = IREE_HAL_TASK_DEVICE_ID_QUEUE_BASE + i,
+        .path = path,
+        .name = path,
+    };
+  }
+
+  *out_device_info_count = device_count;
+  *out_device_infos = device_infos;
+  return iree_ok_status();
 }
 
 static iree_status_t iree_hal_task_driver_dump_device_info(
@@ -149,10 +203,45 @@ static iree_status_t iree_hal_task_driver_create_device_by_id(
     iree_host_size_t param_count, const iree_string_pair_t* params,
     iree_allocator_t host_allocator, iree_hal_device_t** out_device) {
   iree_hal_task_driver_t* driver = iree_hal_task_driver_cast(base_driver);
-  return iree_hal_task_device_create(
-      driver->identifier, &driver->default_params, driver->queue_count,
-      driver->queue_executors, driver->loader_count, driver->loaders,
-      driver->device_allocator, host_allocator, out_device);
+  if (device_id == IREE_HAL_TASK_DEVICE_ID_DEFAULT) {
+    return iree_hal_task_device_create(
+        driver->identifier, &driver->default_params, driver->queue_count,
+        driver->queue_executors, driver->loader_count, driver->loaders,
+        driver->device_allocator, host_allocator, out_device);
+  }
+
+  if (device_id < IREE_HAL_TASK_DEVICE_ID_QUEUE_BASE ||
+      device_id - IREE_HAL_TASK_DEVICE_ID_QUEUE_BASE >=
+          iree_hal_task_driver_queue_device_count(driver)) {
+    return iree_make_status(IREE_STATUS_NOT_FOUND,
+                            "device ID %" PRIu64 " not found",
+                            (uint64_t)device_id);
+  }
+  const iree_host_size_t queue_ordinal =
+      (iree_host_size_t)(device_id - IREE_HAL_TASK_DEVICE_ID_QUEUE_BASE);
+  iree_task_executor_t* executor = driver->queue_executors[queue_ordinal];
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, queue_ordinal);
+
+  // Single-queue devices get their own allocator as queue affinities are
+  // relative to the device and buffers should be placed on the node of the
+  // one executor used.
+  iree_hal_allocator_t* device_allocator = NULL;
+  const uint32_t node_id = iree_task_executor_node_id(executor);
+  iree_status_t status = iree_hal_allocator_create_heap_numa(
+      iree_make_cstring_view("local"),
+      node_id == IREE_TASK_TOPOLOGY_NODE_ID_ANY ? 0 : 1, &node_id,
+      driver->host_allocator, driver->host_allocator, &device_allocator);
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_task_device_create(
+        driver->identifier, &driver->default_params, /*queue_count=*/1,
+        &executor, driver->loader_count, driver->loaders, device_allocator,
+        host_allocator, out_device);
+  }
+  iree_hal_allocator_release(device_allocator);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
 }
 
 static iree_status_t iree_hal_task_driver_create_device_by_path(
@@ -160,13 +249,30 @@ static iree_status_t iree_hal_task_driver_create_device_by_path(
     iree_string_view_t device_path, iree_host_size_t param_count,
     const iree_string_pair_t* params, iree_allocator_t host_allocator,
     iree_hal_device_t** out_device) {
-  if (!iree_string_view_is_empty(device_path)) {
-    return iree_make_status(IREE_STATUS_NOT_FOUND,
-                            "device paths not yet implemented");
+  iree_hal_task_driver_t* driver = iree_hal_task_driver_cast(base_driver);
+  if (iree_string_view_is_empty(device_path)) {
+    return iree_hal_task_driver_create_device_by_id(
+        base_driver, IREE_HAL_DEVICE_ID_DEFAULT, param_count, params,
+        host_allocator, out_device);
+  }
+
+  // Match against the single-queue device paths (`node0`, `queue1`, etc).
+  const iree_host_size_t queue_device_count =
+      iree_hal_task_driver_queue_device_count(driver);
+  for (iree_host_size_t i = 0; i < queue_device_count; ++i) {
+    char path_buffer[IREE_HAL_TASK_DEVICE_PATH_MAX_LENGTH];
+    if (iree_string_view_equal(
+            device_path,
+            iree_hal_task_driver_format_queue_path(driver, i, path_buffer))) {
+      return iree_hal_task_driver_create_device_by_id(
+          base_driver, IREE_HAL_TASK_DEVICE_ID_QUEUE_BASE + i, param_count,
+          params, host_allocator, out_device);
+    }
   }
-  return iree_hal_task_driver_create_device_by_id(
-      base_driver, IREE_HAL_DEVICE_ID_DEFAULT, param_count, params,
-      host_allocator, out_device);
+  return iree_make_status(IREE_STATUS_NOT_FOUND,
+                          "no device '%.*s' found; expected one of the paths "
+                          "returned by device enumeration",
+                          (int)device_path.size, device_path.data);
 }
 
 static const iree_hal_driver_vtable_t iree_hal_task_driver_vtable = {
@@ -0,0 +1,311 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/drivers/local_task/task_driver.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/hal/drivers/local_task/task_device.h"
+#include "iree/task/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+using ::iree::testing::status::StatusIs;
+
+class TaskDriverTest : public ::testing::Test {
+ protected:
+  void TearDown() override {
+    iree_hal_driver_release(driver_);
+    for (iree_task_executor_t* executor : executors_) {
+      iree_task_executor_release(executor);
+    }
+  }
+
+  // Creates a driver with one queue per entry in |node_ids|. Each queue has
+  // its own single-worker executor associated with the given NUMA node.
+  void CreateDriver(std::vector<iree_task_topology_node_id_t> node_ids) {
+    for (iree_task_topology_node_id_t node_id : node_ids) {
+      iree_task_executor_options_t options;
+      iree_task_executor_options_initialize(&options);
+      options.node_id = node_id;
+      iree_task_topology_t topology;
+      iree_task_topology_initialize_from_group_count(1, &topology);
+      iree_task_executor_t* executor = NULL;
+      IREE_ASSERT_OK(iree_task_executor_create(
+          options, &topology, iree_allocator_system(), &executor));
+      iree_task_topology_deinitialize(&topology);
+      executors_.push_back(executor);
+    }
+
+    iree_hal_allocator_t* device_allocator = NULL;
+    IREE_ASSERT_OK(iree_hal_allocator_create_heap(
+        iree_make_cstring_view("local"), iree_allocator_system(),
+        iree_allocator_system(), &device_allocator));
+    iree_hal_task_device_params_t params;
+    iree_hal_task_device_params_initialize(&params);
+    iree_status_t status = iree_hal_task_driver_create(
+        iree_make_cstring_view("local-task"), &params, executors_.size(),
+        executors_.data(), /*loader_count=*/0, /*loaders=*/NULL,
+        device_allocator, iree_allocator_system(), &driver_);
+    iree_hal_allocator_release(device_allocator);
+    IREE_ASSERT_OK(status);
+  }
+
+  // Returns the paths of all available devices in enumeration order.
+  std::vector<std::string> QueryDevicePaths() {
+    iree_host_size_t device_info_count = 0;
+    iree_hal_device_info_t* device_infos = NULL;
+    IREE_CHECK_OK(iree_hal_driver_query_available_devices(
+        driver_, iree_allocator_system(), &device_info_count, &device_infos));
+    std::vector<std::string> paths;
+    for (iree_host_size_t i = 0; i < device_info_count; ++i) {
+      paths.emplace_back(device_infos[i].path.data, device_infos[i].path.size);
+    }
+    iree_allocator_free(iree_allocator_system(), device_infos);
+    return paths;
+  }
+
+  // Creates the device at |path|, allocates a buffer on it, and releases both.
+  iree_status_t CreateDeviceByPath(const char* path) {
+    iree_hal_device_t* device = NULL;
+    IREE_RETURN_IF_ERROR(iree_hal_driver_create_device_by_path(
+        driver_, iree_make_cstring_view("local-task"),
+        iree_make_cstring_view(path), 0, NULL, iree_allocator_system(),
+        &device));
+    iree_hal_buffer_params_t params = {0};
+    params.type = IREE_HAL_MEMORY_TYPE_HOST_LOCAL;
+    params.usage = IREE_HAL_BUFFER_USAGE_DEFAULT;
+    iree_hal_buffer_t* buffer = NULL;
+    iree_status_t status = iree_hal_allocator_allocate_buffer(
+        iree_hal_device_allocator(device), params, 64 * 1024,
+        iree_const_byte_span_empty(), &buffer);
+    iree_hal_buffer_release(buffer);
+    iree_hal_device_release(device);
+    return status;
+  }
+
+  std::vector<iree_task_executor_t*> executors_;
+  iree_hal_driver_t* driver_ = NULL;
+};
+
+TEST_F(TaskDriverTest, SingleQueueHasOnlyDefaultDevice) {
+  CreateDriver({0});
+  EXPECT_EQ(QueryDevicePaths(), std::vector<std::string>{""});
+  IREE_EXPECT_OK(CreateDeviceByPath(""));
+  EXPECT_THAT(Status(CreateDeviceByPath("node0")),
+              StatusIs(StatusCode::kNotFound));
+}
+
+TEST_F(TaskDriverTest, ListsDevicePerNode) {
+  CreateDriver({0, 1});
+  EXPECT_EQ(QueryDevicePaths(),
+            (std::vector<std::string>{"", "node0", "node1"}));
+}
+
+TEST_F(TaskDriverTest, ListsDevicePerUnpinnedQueue) {
+  CreateDriver(
+      {IREE_TASK_TOPOLOGY_NODE_ID_ANY, IREE_TASK_TOPOLOGY_NODE_ID_ANY});
+  EXPECT_EQ(QueryDevicePaths(),
+            (std::vector<std::string>{"", "queue0", "queue1"}));
+}
+
+TEST_F(TaskDriverTest, CreatesNodeDevicesByPath) {
+  CreateDriver({0, 1});
+  IREE_EXPECT_OK(CreateDeviceByPath(""));
+  // NOTE: binding to nodes that do not exist on the host is ignored so the
+  // node1 device is usable even on single-node systems.
+  IREE_EXPECT_OK(CreateDeviceByPath("node0"));
+  IREE_EXPECT_OK(CreateDeviceByPath("node1"));
+  EXPECT_THAT(Status(CreateDeviceByPath("node2")),
+              StatusIs(StatusCode::kNotFound));
+  EXPECT_THAT(Status(CreateDeviceByPath("queue0")),
+              StatusIs(StatusCode::kNotFound));
+}
+
+TEST_F(TaskDriverTest, CreatesNodeDevicesById) {
+  CreateDriver({0, 1});
+  iree_host_size_t device_info_count = 0;
+  iree_hal_device_info_t* device_infos = NULL;
+  IREE_ASSERT_OK(iree_hal_driver_query_available_devices(
+      driver_, iree_allocator_system(), &device_info_count, &device_infos));
+  for (iree_host_size_t i = 0; i < device_info_count; ++i) {
+    iree_hal_device_t* device = NULL;
+    IREE_EXPECT_OK(iree_hal_driver_create_device_by_id(
+        driver_, device_infos[i].device_id, 0, NULL, iree_allocator_system(),
+        &device));
+    iree_hal_device_release(device);
+  }
+  iree_allocator_free(iree_allocator_system(), device_infos);
+}
+
+// Devices using threadless executors only make progress while a thread waits on
+// them so every wait must donate the waiting thread to the executor.
+class ThreadlessDeviceTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    iree_task_executor_options_t options;
+    iree_task_executor_options_initialize(&options);
+    options.flags |= IREE_TASK_EXECUTOR_FLAG_THREADLESS;
+    iree_task_topology_t topology;
+    iree_task_topology_initialize_from_group_count(2, &topology);
+    IREE_ASSERT_OK(iree_task_executor_create(
+        options, &topology, iree_allocator_system(), &executor_));
+    iree_task_topology_deinitialize(&topology);
+
+    iree_hal_allocator_t* device_allocator = NULL;
+    IREE_ASSERT_OK(iree_hal_allocator_create_heap(
+        iree_make_cstring_view("local"), iree_allocator_system(),
+        iree_allocator_system(), &device_allocator));
+    iree_hal_task_device_params_t params;
+    iree_hal_task_device_params_initialize(&params);
+    iree_status_t status = iree_hal_task_device_create(
+        iree_make_cstring_view("local-task"), &params, /*queue_count=*/1,
+        &executor_, /*loader_count=*/0, /*loaders=*/NULL, device_allocator,
+        iree_allocator_system(), &device_);
+    iree_hal_allocator_release(device_allocator);
+    IREE_ASSERT_OK(status);
+  }
+
+  void TearDown() override {
+    iree_hal_device_release(device_);
+    iree_task_executor_release(executor_);
+  }
+
+  // Enqueues a fill of |buffer| with |pattern| that waits on |wait_semaphore|
+  // (if any) and signals |signal_semaphore| to 1.
+  void EnqueueFill(iree_hal_buffer_t* buffer, uint32_t pattern,
+                   iree_hal_semaphore_t* wait_semaphore,
+                   iree_hal_semaphore_t* signal_semaphore) {
+    iree_hal_command_buffer_t* command_buffer = NULL;
+    IREE_ASSERT_OK(iree_hal_command_buffer_create(
+        device_, IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT,
+        IREE_HAL_COMMAND_CATEGORY_TRANSFER, IREE_HAL_QUEUE_AFFINITY_ANY,
+        /*binding_capacity=*/0, &command_buffer));
+    IREE_ASSERT_OK(iree_hal_command_buffer_begin(command_buffer));
+    IREE_ASSERT_OK(iree_hal_command_buffer_fill_buffer(
+        command_buffer, buffer, 0, iree_hal_buffer_byte_length(buffer),
+        &pattern, sizeof(pattern)));
+    IREE_ASSERT_OK(iree_hal_command_buffer_end(command_buffer));
+    uint64_t wait_value = 1;
+    iree_hal_semaphore_list_t wait_list = {
+        wait_semaphore ? 1u : 0u,
+        &wait_semaphore,
+        &wait_value,
+    };
+    uint64_t signal_value = 1;
+    iree_hal_semaphore_list_t signal_list = {1, &signal_semaphore,
+                                             &signal_value};
+    IREE_ASSERT_OK(iree_hal_device_queue_execute(
+        device_, IREE_HAL_QUEUE_AFFINITY_ANY, wait_list, signal_list, 1,
+        &command_buffer));
+    iree_hal_command_buffer_release(command_buffer);
+  }
+
+  iree_hal_buffer_t* AllocateBuffer() {
+    iree_hal_buffer_params_t params = {0};
+    params.type =
+        IREE_HAL_MEMORY_TYPE_HOST_LOCAL | IREE_HAL_MEMORY_TYPE_DEVICE_VISIBLE;
+    params.usage = IREE_HAL_BUFFER_USAGE_DEFAULT;
+    iree_hal_buffer_t* buffer = NULL;
+    IREE_CHECK_OK(iree_hal_allocator_allocate_buffer(
+        iree_hal_device_allocator(device_), params, 64,
+        iree_const_byte_span_empty(), &buffer));
+    return buffer;
+  }
+
+  uint32_t ReadFirstWord(iree_hal_buffer_t* buffer) {
+    uint32_t value = 0;
+    IREE_CHECK_OK(
+        iree_hal_buffer_map_read(buffer, 0, &value, sizeof(value)));
+    return value;
+  }
+
+  iree_task_executor_t* executor_ = NULL;
+  iree_hal_device_t* device_ = NULL;
+};
+
+TEST_F(ThreadlessDeviceTest, SemaphoreWaitRunsWork) {
+  iree_hal_semaphore_t* semaphore = NULL;
+  IREE_ASSERT_OK(iree_hal_semaphore_create(device_, 0, &semaphore));
+  iree_hal_buffer_t* buffer = AllocateBuffer();
+  EnqueueFill(buffer, 0xCAFEF00Du, /*wait_semaphore=*/NULL, semaphore);
+  IREE_ASSERT_OK(
+      iree_hal_semaphore_wait(semaphore, 1, iree_infinite_timeout()));
+  EXPECT_EQ(ReadFirstWord(buffer), 0xCAFEF00Du);
+  iree_hal_buffer_release(buffer);
+  iree_hal_semaphore_release(semaphore);
+}
+
+TEST_F(ThreadlessDeviceTest, SemaphoreWaitTimesOut) {
+  iree_hal_semaphore_t* semaphore = NULL;
+  IREE_ASSERT_OK(iree_hal_semaphore_create(device_, 0, &semaphore));
+  EXPECT_THAT(Status(iree_hal_semaphore_wait(
+                  semaphore, 1, iree_make_timeout_ms(10))),
+              StatusIs(StatusCode::kDeadlineExceeded));
+  iree_hal_semaphore_release(semaphore);
+}
+
+TEST_F(ThreadlessDeviceTest, FenceWaitRunsChainedWork) {
+  iree_hal_semaphore_t* semaphores[2] = {NULL, NULL};
+  IREE_ASSERT_OK(iree_hal_semaphore_create(device_, 0, &semaphores[0]));
+  IREE_ASSERT_OK(iree_hal_semaphore_create(device_, 0, &semaphores[1]));
+  iree_hal_buffer_t* buffers[2] = {AllocateBuffer(), AllocateBuffer()};
+  EnqueueFill(buffers[0], 1u, /*wait_semaphore=*/NULL, semaphores[0]);
+  EnqueueFill(buffers[1], 2u, semaphores[0], semaphores[1]);
+
+  iree_hal_fence_t* fence = NULL;
+  IREE_ASSERT_OK(iree_hal_fence_create(2, iree_allocator_system(), &fence));
+  IREE_ASSERT_OK(iree_hal_fence_insert(fence, semaphores[0], 1));
+  IREE_ASSERT_OK(iree_hal_fence_insert(fence, semaphores[1], 1));
+  IREE_ASSERT_OK(iree_hal_fence_wait(fence, iree_infinite_timeout()));
+  EXPECT_EQ(ReadFirstWord(buffers[0]), 1u);
+  EXPECT_EQ(ReadFirstWord(buffers[1]), 2u);
+
+  iree_hal_fence_release(fence);
+  for (int i = 0; i < 2; ++i) {
+    iree_hal_buffer_release(buffers[i]);
+    iree_hal_semaphore_release(semaphores[i]);
+  }
+}
+
+TEST_F(ThreadlessDeviceTest, MultiWaitRunsWork) {
+  for (iree_hal_wait_mode_t wait_mode :
+       {IREE_HAL_WAIT_MODE_ALL, IREE_HAL_WAIT_MODE_ANY}) {
+    iree_hal_semaphore_t* semaphores[2] = {NULL, NULL};
+    IREE_ASSERT_OK(iree_hal_semaphore_create(device_, 0, &semaphores[0]));
+    IREE_ASSERT_OK(iree_hal_semaphore_create(device_, 0, &semaphores[1]));
+    iree_hal_buffer_t* buffer = AllocateBuffer();
+    EnqueueFill(buffer, 3u, /*wait_semaphore=*/NULL, semaphores[0]);
+    EnqueueFill(buffer, 4u, semaphores[0], semaphores[1]);
+
+    uint64_t payload_values[2] = {1, 1};
+    iree_hal_semaphore_list_t semaphore_list = {2, semaphores, payload_values};
+    IREE_ASSERT_OK(iree_hal_device_wait_semaphores(
+        device_, wait_mode, semaphore_list, iree_infinite_timeout()));
+    if (wait_mode == IREE_HAL_WAIT_MODE_ALL) {
+      EXPECT_EQ(ReadFirstWord(buffer), 4u);
+    }
+    // Drain any remaining work before releasing the resources it uses.
+    IREE_ASSERT_OK(
+        iree_hal_semaphore_wait(semaphores[1], 1, iree_infinite_timeout()));
+
+    iree_hal_buffer_release(buffer);
+    iree_hal_semaphore_release(semaphores[0]);
+    iree_hal_semaphore_release(semaphores[1]);
+  }
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
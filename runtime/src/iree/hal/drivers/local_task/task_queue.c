@@ -435,8 +435,11 @@ void iree_hal_task_queue_initialize(iree_string_view_t identifier,
 void iree_hal_task_queue_deinitialize(iree_hal_task_queue_t* queue) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
-  iree_status_ignore(
-      iree_task_scope_wait_idle(&queue->scope, IREE_TIME_INFINITE_FUTURE));
+  // Retire tasks may still be pending after the last signal; threadless
+  // executors only run them on donated threads.
+  iree_status_ignore(iree_task_executor_donate_caller(
+      queue->executor, iree_task_scope_await_idle(&queue->scope),
+      iree_infinite_timeout()));
 
   iree_hal_task_queue_state_deinitialize(&queue->state);
   iree_task_scope_deinitialize(&queue->scope);
@@ -549,8 +552,10 @@ iree_status_t iree_hal_task_queue_submit(
 iree_status_t iree_hal_task_queue_wait_idle(iree_hal_task_queue_t* queue,
                                             iree_timeout_t timeout) {
   IREE_TRACE_ZONE_BEGIN(z0);
-  iree_time_t deadline_ns = iree_timeout_as_deadline_ns(timeout);
-  iree_status_t status = iree_task_scope_wait_idle(&queue->scope, deadline_ns);
+  // Donating lets threadless executors make progress on the waiting thread;
+  // executors with workers will flush and wait as normal.
+  iree_status_t status = iree_task_executor_donate_caller(
+      queue->executor, iree_task_scope_await_idle(&queue->scope), timeout);
   IREE_TRACE_ZONE_END(z0);
   return status;
 }
@@ -14,6 +14,7 @@
 #include "iree/base/internal/synchronization.h"
 #include "iree/base/internal/wait_handle.h"
 #include "iree/hal/utils/semaphore_base.h"
+#include "iree/task/tuning.h"
 
 // Sentinel used the semaphore has failed and an error status is set.
 #define IREE_HAL_TASK_SEMAPHORE_FAILURE_VALUE UINT64_MAX
@@ -66,6 +67,10 @@ typedef struct iree_hal_task_semaphore_t {
 
   // OK or the status passed to iree_hal_semaphore_fail. Owned by the semaphore.
   iree_status_t failure_status;
+
+  // Threadless executors waiters donate themselves to. Retained.
+  iree_host_size_t executor_count;
+  iree_task_executor_t* executors[];
 } iree_hal_task_semaphore_t;
 
 static const iree_hal_semaphore_vtable_t iree_hal_task_semaphore_vtable;
@@ -77,21 +82,30 @@ static iree_hal_task_semaphore_t* iree_hal_task_semaphore_cast(
 }
 
 iree_status_t iree_hal_task_semaphore_create(
-    iree_event_pool_t* event_pool, uint64_t initial_value,
+    iree_event_pool_t* event_pool, iree_host_size_t executor_count,
+    iree_task_executor_t* const* executors, uint64_t initial_value,
     iree_allocator_t host_allocator, iree_hal_semaphore_t** out_semaphore) {
   IREE_ASSERT_ARGUMENT(event_pool);
+  IREE_ASSERT_ARGUMENT(!executor_count || executors);
   IREE_ASSERT_ARGUMENT(out_semaphore);
   *out_semaphore = NULL;
   IREE_TRACE_ZONE_BEGIN(z0);
 
   iree_hal_task_semaphore_t* semaphore = NULL;
   iree_status_t status = iree_allocator_malloc(
-      host_allocator, sizeof(*semaphore), (void**)&semaphore);
+      host_allocator,
+      sizeof(*semaphore) + executor_count * sizeof(semaphore->executors[0]),
+      (void**)&semaphore);
   if (iree_status_is_ok(status)) {
     iree_hal_semaphore_initialize(&iree_hal_task_semaphore_vtable,
                                   &semaphore->base);
     semaphore->host_allocator = host_allocator;
     semaphore->event_pool = event_pool;
+    semaphore->executor_count = executor_count;
+    for (iree_host_size_t i = 0; i < executor_count; ++i) {
+      semaphore->executors[i] = executors[i];
+      iree_task_executor_retain(executors[i]);
+    }
 
     iree_slim_mutex_initialize(&semaphore->mutex);
     semaphore->current_value = initial_value;
@@ -113,6 +127,9 @@ static void iree_hal_task_semaphore_destroy(
 
   iree_slim_mutex_deinitialize(&semaphore->mutex);
   iree_status_ignore(semaphore->failure_status);
+  for (iree_host_size_t i = 0; i < semaphore->executor_count; ++i) {
+    iree_task_executor_release(semaphore->executors[i]);
+  }
 
   iree_hal_semaphore_deinitialize(&semaphore->base);
   iree_allocator_free(host_allocator, semaphore);
@@ -280,6 +297,99 @@ iree_status_t iree_hal_task_semaphore_enqueue_timepoint(
   return status;
 }
 
+// Donates the calling thread to |executors| until |wait_source| resolves or
+// |timeout| elapses. With multiple executors the caller rotates between them
+// so that work scheduled on any of them makes progress.
+static iree_status_t iree_hal_task_semaphore_donate_wait(
+    iree_host_size_t executor_count, iree_task_executor_t* const* executors,
+    iree_wait_source_t wait_source, iree_timeout_t timeout) {
+  if (executor_count == 1) {
+    return iree_task_executor_donate_caller(executors[0], wait_source, timeout);
+  }
+  iree_time_t deadline_ns = iree_timeout_as_deadline_ns(timeout);
+  for (iree_host_size_t i = 0;; i = (i + 1) % executor_count) {
+    iree_time_t slice_deadline_ns = iree_min(
+        deadline_ns, iree_time_now() + IREE_TASK_EXECUTOR_DONATION_POLL_NS);
+    iree_status_t status = iree_task_executor_donate_caller(
+        executors[i], wait_source, iree_make_deadline(slice_deadline_ns));
+    if (!iree_status_is_deadline_exceeded(status) ||
+        slice_deadline_ns >= deadline_ns) {
+      return status;
+    }
+    iree_status_ignore(status);
+  }
+}
+
+// Blocks the calling thread until |semaphore| reaches |value| or |timeout|
+// elapses. Must be called with the semaphore lock held and releases it.
+static iree_status_t iree_hal_task_semaphore_wait_blocking(
+    iree_hal_task_semaphore_t* semaphore, uint64_t value,
+    iree_timeout_t timeout) {
+  iree_time_t deadline_ns = iree_timeout_as_deadline_ns(timeout);
+
+  // Slow path: acquire a timepoint while we hold the lock.
+  iree_hal_task_timepoint_t timepoint;
+  iree_status_t status = iree_hal_task_semaphore_acquire_timepoint(
+      semaphore, value, timeout, &timepoint);
+
+  iree_slim_mutex_unlock(&semaphore->mutex);
+  if (IREE_UNLIKELY(!iree_status_is_ok(status))) return status;
+
+  // Wait until the timepoint resolves.
+  // If satisfied the timepoint is automatically cleaned up and we are done. If
+  // the deadline is reached before satisfied then we have to clean it up.
+  status = iree_wait_one(&timepoint.event, deadline_ns);
+  if (!iree_status_is_ok(status)) {
+    iree_hal_semaphore_cancel_timepoint(&semaphore->base, &timepoint.base);
+  }
+  iree_event_pool_release(semaphore->event_pool, 1, &timepoint.event);
+
+  return status;
+}
+
+// Wait source that resolves when the semaphore in |wait_source.self| reaches
+// the payload value in |wait_source.data|. Used for donating waits; unlike
+// iree_hal_semaphore_await a WAIT_ONE blocks without donating again so that
+// callers unable to claim an executor worker can fall back to it.
+static iree_status_t iree_hal_task_semaphore_wait_source_ctl(
+    iree_wait_source_t wait_source, iree_wait_source_command_t command,
+    const void* params, void** inout_ptr) {
+  iree_hal_task_semaphore_t* semaphore =
+      (iree_hal_task_semaphore_t*)wait_source.self;
+  const uint64_t value = wait_source.data;
+  switch (command) {
+    case IREE_WAIT_SOURCE_COMMAND_QUERY: {
+      iree_status_code_t* out_wait_status_code = (iree_status_code_t*)inout_ptr;
+      iree_slim_mutex_lock(&semaphore->mutex);
+      if (!iree_status_is_ok(semaphore->failure_status)) {
+        *out_wait_status_code = IREE_STATUS_ABORTED;
+      } else if (semaphore->current_value >= value) {
+        *out_wait_status_code = IREE_STATUS_OK;
+      } else {
+        *out_wait_status_code = IREE_STATUS_DEFERRED;
+      }
+      iree_slim_mutex_unlock(&semaphore->mutex);
+      return iree_ok_status();
+    }
+    case IREE_WAIT_SOURCE_COMMAND_WAIT_ONE: {
+      const iree_timeout_t timeout =
+          ((const iree_wait_source_wait_params_t*)params)->timeout;
+      iree_slim_mutex_lock(&semaphore->mutex);
+      if (!iree_status_is_ok(semaphore->failure_status)) {
+        iree_slim_mutex_unlock(&semaphore->mutex);
+        return iree_status_from_code(IREE_STATUS_ABORTED);
+      } else if (semaphore->current_value >= value) {
+        iree_slim_mutex_unlock(&semaphore->mutex);
+        return iree_ok_status();
+      }
+      return iree_hal_task_semaphore_wait_blocking(semaphore, value, timeout);
+    }
+    default:
+      return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                              "unimplemented wait_source command");
+  }
+}
+
 static iree_status_t iree_hal_task_semaphore_wait(
     iree_hal_semaphore_t* base_semaphore, uint64_t value,
     iree_timeout_t timeout) {
@@ -300,42 +410,29 @@ static iree_status_t iree_hal_task_semaphore_wait(
     // Not satisfied but a poll, so can avoid the expensive wait handle work.
     iree_slim_mutex_unlock(&semaphore->mutex);
     return iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+  } else if (semaphore->executor_count == 0) {
+    // Slow path: block until another thread signals the semaphore.
+    return iree_hal_task_semaphore_wait_blocking(semaphore, value, timeout);
   }
-
-  iree_time_t deadline_ns = iree_timeout_as_deadline_ns(timeout);
-
-  // Slow path: acquire a timepoint while we hold the lock.
-  iree_hal_task_timepoint_t timepoint;
-  iree_status_t status = iree_hal_task_semaphore_acquire_timepoint(
-      semaphore, value, timeout, &timepoint);
-
   iree_slim_mutex_unlock(&semaphore->mutex);
-  if (IREE_UNLIKELY(!iree_status_is_ok(status))) return status;
-
-  // Wait until the timepoint resolves.
-  // If satisfied the timepoint is automatically cleaned up and we are done. If
-  // the deadline is reached before satisfied then we have to clean it up.
-  status = iree_wait_one(&timepoint.event, deadline_ns);
-  if (!iree_status_is_ok(status)) {
-    iree_hal_semaphore_cancel_timepoint(&semaphore->base, &timepoint.base);
-  }
-  iree_event_pool_release(semaphore->event_pool, 1, &timepoint.event);
 
-  return status;
+  // Slow path with threadless executors: nothing will signal the semaphore
+  // unless someone runs the tasks so we do that ourselves while waiting.
+  iree_wait_source_t wait_source = {
+      .self = semaphore,
+      .data = value,
+      .ctl = iree_hal_task_semaphore_wait_source_ctl,
+  };
+  return iree_hal_task_semaphore_donate_wait(
+      semaphore->executor_count, semaphore->executors, wait_source, timeout);
 }
 
-iree_status_t iree_hal_task_semaphore_multi_wait(
+// Blocks the calling thread until the |semaphore_list| is satisfied according
+// to |wait_mode| or |timeout| elapses.
+static iree_status_t iree_hal_task_semaphore_multi_wait_blocking(
     iree_hal_wait_mode_t wait_mode,
     const iree_hal_semaphore_list_t semaphore_list, iree_timeout_t timeout,
     iree_event_pool_t* event_pool, iree_arena_block_pool_t* block_pool) {
-  if (semaphore_list.count == 0) {
-    return iree_ok_status();
-  } else if (semaphore_list.count == 1) {
-    // Fast-path for a single semaphore.
-    return iree_hal_semaphore_wait(semaphore_list.semaphores[0],
-                                   semaphore_list.payload_values[0], timeout);
-  }
-
   IREE_TRACE_ZONE_BEGIN(z0);
 
   iree_time_t deadline_ns = iree_timeout_as_deadline_ns(timeout);
@@ -404,6 +501,93 @@ iree_status_t iree_hal_task_semaphore_multi_wait(
   return status;
 }
 
+// A multi-wait operation referenced by its wait source.
+typedef struct iree_hal_task_semaphore_multi_wait_t {
+  iree_hal_wait_mode_t wait_mode;
+  iree_hal_semaphore_list_t semaphore_list;
+  iree_event_pool_t* event_pool;
+  iree_arena_block_pool_t* block_pool;
+} iree_hal_task_semaphore_multi_wait_t;
+
+// Wait source that resolves when the iree_hal_task_semaphore_multi_wait_t in
+// |wait_source.self| is satisfied. As with
+// iree_hal_task_semaphore_wait_source_ctl a WAIT_ONE blocks without donating.
+static iree_status_t iree_hal_task_semaphore_multi_wait_source_ctl(
+    iree_wait_source_t wait_source, iree_wait_source_command_t command,
+    const void* params, void** inout_ptr) {
+  const iree_hal_task_semaphore_multi_wait_t* wait =
+      (const iree_hal_task_semaphore_multi_wait_t*)wait_source.self;
+  switch (command) {
+    case IREE_WAIT_SOURCE_COMMAND_QUERY: {
+      iree_status_code_t* out_wait_status_code = (iree_status_code_t*)inout_ptr;
+      iree_host_size_t satisfied_count = 0;
+      for (iree_host_size_t i = 0; i < wait->semaphore_list.count; ++i) {
+        uint64_t current_value = 0;
+        iree_status_t status = iree_hal_semaphore_query(
+            wait->semaphore_list.semaphores[i], &current_value);
+        if (!iree_status_is_ok(status)) {
+          iree_status_ignore(status);
+          *out_wait_status_code = IREE_STATUS_ABORTED;
+          return iree_ok_status();
+        }
+        if (current_value >= wait->semaphore_list.payload_values[i]) {
+          ++satisfied_count;
+        }
+      }
+      const bool is_satisfied =
+          wait->wait_mode == IREE_HAL_WAIT_MODE_ANY
+              ? satisfied_count > 0
+              : satisfied_count == wait->semaphore_list.count;
+      *out_wait_status_code =
+          is_satisfied ? IREE_STATUS_OK : IREE_STATUS_DEFERRED;
+      return iree_ok_status();
+    }
+    case IREE_WAIT_SOURCE_COMMAND_WAIT_ONE: {
+      const iree_timeout_t timeout =
+          ((const iree_wait_source_wait_params_t*)params)->timeout;
+      return iree_hal_task_semaphore_multi_wait_blocking(
+          wait->wait_mode, wait->semaphore_list, timeout, wait->event_pool,
+          wait->block_pool);
+    }
+    default:
+      return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                              "unimplemented wait_source command");
+  }
+}
+
+iree_status_t iree_hal_task_semaphore_multi_wait(
+    iree_hal_wait_mode_t wait_mode,
+    const iree_hal_semaphore_list_t semaphore_list, iree_timeout_t timeout,
+    iree_host_size_t executor_count, iree_task_executor_t* const* executors,
+    iree_event_pool_t* event_pool, iree_arena_block_pool_t* block_pool) {
+  if (semaphore_list.count == 0) {
+    return iree_ok_status();
+  } else if (semaphore_list.count == 1) {
+    // Fast-path for a single semaphore.
+    return iree_hal_semaphore_wait(semaphore_list.semaphores[0],
+                                   semaphore_list.payload_values[0], timeout);
+  } else if (executor_count == 0 || iree_timeout_is_immediate(timeout)) {
+    // Polls and waits on executors with worker threads can block.
+    return iree_hal_task_semaphore_multi_wait_blocking(
+        wait_mode, semaphore_list, timeout, event_pool, block_pool);
+  }
+
+  // Run tasks on threadless executors until the wait is satisfied.
+  iree_hal_task_semaphore_multi_wait_t wait = {
+      .wait_mode = wait_mode,
+      .semaphore_list = semaphore_list,
+      .event_pool = event_pool,
+      .block_pool = block_pool,
+  };
+  iree_wait_source_t wait_source = {
+      .self = &wait,
+      .data = 0,
+      .ctl = iree_hal_task_semaphore_multi_wait_source_ctl,
+  };
+  return iree_hal_task_semaphore_donate_wait(executor_count, executors,
+                                             wait_source, timeout);
+}
+
 static const iree_hal_semaphore_vtable_t iree_hal_task_semaphore_vtable = {
     .destroy = iree_hal_task_semaphore_destroy,
     .query = iree_hal_task_semaphore_query,
@@ -13,6 +13,7 @@
 #include "iree/base/internal/arena.h"
 #include "iree/base/internal/event_pool.h"
 #include "iree/hal/api.h"
+#include "iree/task/executor.h"
 #include "iree/task/submission.h"
 #include "iree/task/task.h"
 
@@ -22,8 +23,14 @@ extern "C" {
 
 // Creates a semaphore that integrates with the task system to allow for
 // pipelined wait and signal operations.
+//
+// |executors| are the threadless executors that work signaling the semaphore
+// may be scheduled on. Threads waiting on the semaphore donate themselves to
+// them so that the work makes progress. Executors with worker threads should
+// not be included as waiters can just block on them.
 iree_status_t iree_hal_task_semaphore_create(
-    iree_event_pool_t* event_pool, uint64_t initial_value,
+    iree_event_pool_t* event_pool, iree_host_size_t executor_count,
+    iree_task_executor_t* const* executors, uint64_t initial_value,
     iree_allocator_t host_allocator, iree_hal_semaphore_t** out_semaphore);
 
 // Returns true if |semaphore| is a task system semaphore.
@@ -41,10 +48,12 @@ iree_status_t iree_hal_task_semaphore_enqueue_timepoint(
 
 // Performs a multi-wait on one or more semaphores.
 // Returns IREE_STATUS_DEADLINE_EXCEEDED if the wait does not complete before
-// |deadline_ns| elapses.
+// |deadline_ns| elapses. The caller donates itself to the threadless
+// |executors| while waiting as with iree_hal_task_semaphore_create.
 iree_status_t iree_hal_task_semaphore_multi_wait(
     iree_hal_wait_mode_t wait_mode,
     const iree_hal_semaphore_list_t semaphore_list, iree_timeout_t timeout,
+    iree_host_size_t executor_count, iree_task_executor_t* const* executors,
     iree_event_pool_t* event_pool, iree_arena_block_pool_t* block_pool);
 
 #ifdef __cplusplus
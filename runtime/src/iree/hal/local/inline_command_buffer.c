@@ -15,6 +15,7 @@
 #include "iree/base/internal/fpu_state.h"
 #include "iree/base/internal/math.h"
 #include "iree/hal/local/executable_library.h"
+#include "iree/hal/local/local_channel.h"
 #include "iree/hal/local/local_executable.h"
 #include "iree/hal/local/local_pipeline_layout.h"
 
@@ -357,8 +358,45 @@ static iree_status_t iree_hal_inline_command_buffer_collective(
     iree_hal_collective_op_t op, uint32_t param,
     iree_hal_buffer_binding_t send_binding,
     iree_hal_buffer_binding_t recv_binding, iree_device_size_t element_count) {
-  return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
-                          "collectives not yet implemented on CPU");
+  if (!iree_hal_local_channel_isa(channel)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "collective channel was not created by a local "
+                            "device");
+  }
+
+  iree_hal_buffer_mapping_t send_mapping = {{0}};
+  if (send_binding.buffer) {
+    IREE_RETURN_IF_ERROR(iree_hal_buffer_map_range(
+        send_binding.buffer, IREE_HAL_MAPPING_MODE_SCOPED,
+        IREE_HAL_MEMORY_ACCESS_READ, send_binding.offset, send_binding.length,
+        &send_mapping));
+  }
+  iree_hal_buffer_mapping_t recv_mapping = {{0}};
+  iree_status_t status = iree_ok_status();
+  if (recv_binding.buffer) {
+    status = iree_hal_buffer_map_range(
+        recv_binding.buffer, IREE_HAL_MAPPING_MODE_SCOPED,
+        IREE_HAL_MEMORY_ACCESS_ANY, recv_binding.offset, recv_binding.length,
+        &recv_mapping);
+  }
+
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_local_channel_execute_collective(
+        channel, op, param,
+        iree_make_const_byte_span(send_mapping.contents.data,
+                                  send_mapping.contents.data_length),
+        recv_mapping.contents, element_count);
+  }
+
+  if (recv_binding.buffer) {
+    status =
+        iree_status_join(status, iree_hal_buffer_unmap_range(&recv_mapping));
+  }
+  if (send_binding.buffer) {
+    status =
+        iree_status_join(status, iree_hal_buffer_unmap_range(&send_mapping));
+  }
+  return status;
 }
 
 //===----------------------------------------------------------------------===//
@@ -0,0 +1,1103 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/local/local_channel.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/call_once.h"
+#include "iree/base/internal/math.h"
+#include "iree/base/internal/synchronization.h"
+
+//===----------------------------------------------------------------------===//
+// Element reductions
+//===----------------------------------------------------------------------===//
+
+// Reduces |count| elements of |source| into |target| (target = target op
+// source). IREE_HAL_COLLECTIVE_REDUCTION_AVERAGE is treated as a sum and the
+// division is performed by iree_hal_local_channel_finalize_fn_t.
+typedef void (*iree_hal_local_channel_reduce_fn_t)(
+    iree_hal_collective_reduction_t reduction, iree_host_size_t count,
+    const void* source, void* target);
+
+// Divides |count| elements of |target| by |divisor|.
+typedef void (*iree_hal_local_channel_finalize_fn_t)(iree_host_size_t count,
+                                                     int32_t divisor,
+                                                     void* target);
+
+// Sums and products of signed types are computed on their unsigned
+// counterparts (|UT|) so that overflow wraps instead of being undefined.
+#define IREE_HAL_LOCAL_CHANNEL_DEFINE_REDUCE(name, T, UT)                  \
+  static void iree_hal_local_channel_reduce_##name(                        \
+      iree_hal_collective_reduction_t reduction, iree_host_size_t count,   \
+      const void* source_ptr, void* target_ptr) {                          \
+    const T* IREE_RESTRICT source = (const T*)source_ptr;                  \
+    T* IREE_RESTRICT target = (T*)target_ptr;                              \
+    switch (reduction) {                                                   \
+      default:                                                             \
+      case IREE_HAL_COLLECTIVE_REDUCTION_SUM:                              \
+      case IREE_HAL_COLLECTIVE_REDUCTION_AVERAGE:                          \
+        for (iree_host_size_t i = 0; i < count; ++i) {                     \
+          target[i] = (T)((UT)target[i] + (UT)source[i]);                  \
+        }                                                                  \
+        break;                                                             \
+      case IREE_HAL_COLLECTIVE_REDUCTION_PRODUCT:                          \
+        for (iree_host_size_t i = 0; i < count; ++i) {                     \
+          target[i] = (T)((UT)target[i] * (UT)source[i]);                  \
+        }                                                                  \
+        break;                                                             \
+      case IREE_HAL_COLLECTIVE_REDUCTION_MINIMUM:                          \
+        for (iree_host_size_t i = 0; i < count; ++i) {                     \
+          target[i] = source[i] < target[i] ? source[i] : target[i];       \
+        }                                                                  \
+        break;                                                             \
+      case IREE_HAL_COLLECTIVE_REDUCTION_MAXIMUM:                          \
+        for (iree_host_size_t i = 0; i < count; ++i) {                     \
+          target[i] = source[i] > target[i] ? source[i] : target[i];       \
+        }                                                                  \
+        break;                                                             \
+    }                                                                      \
+  }                                                                        \
+  static void iree_hal_local_channel_finalize_##name(                      \
+      iree_host_size_t count, int32_t divisor, void* target_ptr) {         \
+    T* target = (T*)target_ptr;                                            \
+    for (iree_host_size_t i = 0; i < count; ++i) {                         \
+      target[i] = (T)(target[i] / (T)divisor);                             \
+    }                                                                      \
+  }
+
+IREE_HAL_LOCAL_CHANNEL_DEFINE_REDUCE(i8, int8_t, uint8_t)
+IREE_HAL_LOCAL_CHANNEL_DEFINE_REDUCE(u8, uint8_t, uint8_t)
+IREE_HAL_LOCAL_CHANNEL_DEFINE_REDUCE(i16, int16_t, uint16_t)
+IREE_HAL_LOCAL_CHANNEL_DEFINE_REDUCE(u16, uint16_t, uint16_t)
+IREE_HAL_LOCAL_CHANNEL_DEFINE_REDUCE(i32, int32_t, uint32_t)
+IREE_HAL_LOCAL_CHANNEL_DEFINE_REDUCE(u32, uint32_t, uint32_t)
+IREE_HAL_LOCAL_CHANNEL_DEFINE_REDUCE(i64, int64_t, uint64_t)
+IREE_HAL_LOCAL_CHANNEL_DEFINE_REDUCE(u64, uint64_t, uint64_t)
+IREE_HAL_LOCAL_CHANNEL_DEFINE_REDUCE(f32, float, float)
+IREE_HAL_LOCAL_CHANNEL_DEFINE_REDUCE(f64, double, double)
+
+static inline float iree_hal_local_channel_bf16_to_f32(uint16_t value) {
+  uint32_t bits = (uint32_t)value << 16;
+  float result;
+  memcpy(&result, &bits, sizeof(result));
+  return result;
+}
+
+static inline uint16_t iree_hal_local_channel_f32_to_bf16(float value) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  if ((bits & 0x7FFFFFFFu) > 0x7F800000u) {
+    // Keep NaNs quiet instead of rounding them into infinities.
+    return (uint16_t)((bits >> 16) | 0x0040u);
+  }
+  // Round to nearest even.
+  bits += 0x7FFFu + ((bits >> 16) & 1u);
+  return (uint16_t)(bits >> 16);
+}
+
+// Half-precision types are widened to f32 for the reduction and narrowed again
+// when stored.
+#define IREE_HAL_LOCAL_CHANNEL_DEFINE_REDUCE_HALF(name, TO_F32, FROM_F32)       \
+  static void iree_hal_local_channel_reduce_##name(                             \
+      iree_hal_collective_reduction_t reduction, iree_host_size_t count,        \
+      const void* source_ptr, void* target_ptr) {                               \
+    const uint16_t* IREE_RESTRICT source = (const uint16_t*)source_ptr;         \
+    uint16_t* IREE_RESTRICT target = (uint16_t*)target_ptr;                     \
+    for (iree_host_size_t i = 0; i < count; ++i) {                              \
+      const float lhs = TO_F32(target[i]);                                      \
+      const float rhs = TO_F32(source[i]);                                      \
+      float result;                                                             \
+      switch (reduction) {                                                      \
+        default:                                                                \
+        case IREE_HAL_COLLECTIVE_REDUCTION_SUM:                                 \
+        case IREE_HAL_COLLECTIVE_REDUCTION_AVERAGE:                             \
+          result = lhs + rhs;                                                   \
+          break;                                                                \
+        case IREE_HAL_COLLECTIVE_REDUCTION_PRODUCT:                             \
+          result = lhs * rhs;                                                   \
+          break;                                                                \
+        case IREE_HAL_COLLECTIVE_REDUCTION_MINIMUM:                             \
+          result = rhs < lhs ? rhs : lhs;                                       \
+          break;                                                                \
+        case IREE_HAL_COLLECTIVE_REDUCTION_MAXIMUM:                             \
+          result = rhs > lhs ? rhs : lhs;                                       \
+          break;                                                                \
+      }                                                                         \
+      target[i] = FROM_F32(result);                                             \
+    }                                                                           \
+  }                                                                             \
+  static void iree_hal_local_channel_finalize_##name(                           \
+      iree_host_size_t count, int32_t divisor, void* target_ptr) {              \
+    uint16_t* target = (uint16_t*)target_ptr;                                   \
+    for (iree_host_size_t i = 0; i < count; ++i) {                              \
+      target[i] = FROM_F32(TO_F32(target[i]) / (float)divisor);                 \
+    }                                                                           \
+  }
+
+IREE_HAL_LOCAL_CHANNEL_DEFINE_REDUCE_HALF(f16, iree_math_f16_to_f32,
+                                          iree_math_f32_to_f16)
+IREE_HAL_LOCAL_CHANNEL_DEFINE_REDUCE_HALF(bf16,
+                                          iree_hal_local_channel_bf16_to_f32,
+                                          iree_hal_local_channel_f32_to_bf16)
+
+static const struct {
+  iree_hal_local_channel_reduce_fn_t reduce;
+  iree_hal_local_channel_finalize_fn_t finalize;
+} iree_hal_local_channel_reduce_table[IREE_HAL_COLLECTIVE_ELEMENT_TYPE_MAX_VALUE +
+                                      1] = {
+    [IREE_HAL_COLLECTIVE_ELEMENT_TYPE_SINT_8] =
+        {iree_hal_local_channel_reduce_i8, iree_hal_local_channel_finalize_i8},
+    [IREE_HAL_COLLECTIVE_ELEMENT_TYPE_UINT_8] =
+        {iree_hal_local_channel_reduce_u8, iree_hal_local_channel_finalize_u8},
+    [IREE_HAL_COLLECTIVE_ELEMENT_TYPE_SINT_16] =
+        {iree_hal_local_channel_reduce_i16,
+         iree_hal_local_channel_finalize_i16},
+    [IREE_HAL_COLLECTIVE_ELEMENT_TYPE_UINT_16] =
+        {iree_hal_local_channel_reduce_u16,
+         iree_hal_local_channel_finalize_u16},
+    [IREE_HAL_COLLECTIVE_ELEMENT_TYPE_SINT_32] =
+        {iree_hal_local_channel_reduce_i32,
+         iree_hal_local_channel_finalize_i32},
+    [IREE_HAL_COLLECTIVE_ELEMENT_TYPE_UINT_32] =
+        {iree_hal_local_channel_reduce_u32,
+         iree_hal_local_channel_finalize_u32},
+    [IREE_HAL_COLLECTIVE_ELEMENT_TYPE_SINT_64] =
+        {iree_hal_local_channel_reduce_i64,
+         iree_hal_local_channel_finalize_i64},
+    [IREE_HAL_COLLECTIVE_ELEMENT_TYPE_UINT_64] =
+        {iree_hal_local_channel_reduce_u64,
+         iree_hal_local_channel_finalize_u64},
+    [IREE_HAL_COLLECTIVE_ELEMENT_TYPE_FLOAT_16] =
+        {iree_hal_local_channel_reduce_f16,
+         iree_hal_local_channel_finalize_f16},
+    [IREE_HAL_COLLECTIVE_ELEMENT_TYPE_FLOAT_32] =
+        {iree_hal_local_channel_reduce_f32,
+         iree_hal_local_channel_finalize_f32},
+    [IREE_HAL_COLLECTIVE_ELEMENT_TYPE_FLOAT_64] =
+        {iree_hal_local_channel_reduce_f64,
+         iree_hal_local_channel_finalize_f64},
+    [IREE_HAL_COLLECTIVE_ELEMENT_TYPE_BFLOAT_16] =
+        {iree_hal_local_channel_reduce_bf16,
+         iree_hal_local_channel_finalize_bf16},
+};
+
+//===----------------------------------------------------------------------===//
+// iree_hal_local_channel_group_t
+//===----------------------------------------------------------------------===//
+
+// Per-rank state published to all other ranks in the group.
+// Each slot is kept on its own cache line as ranks update their own slot
+// before every operation.
+typedef iree_alignas(iree_hardware_destructive_interference_size) struct {
+  // Base pointers of the send and receive ranges of the in-flight operation.
+  const uint8_t* send;
+  uint8_t* recv;
+  // Split request of the rank during iree_hal_channel_split.
+  int32_t split_color;
+  int32_t split_key;
+  // Group created by the split leader for all ranks sharing its color.
+  struct iree_hal_local_channel_group_t* split_group;
+  // True once a channel has been created for the rank.
+  bool joined;
+  // Executor key of the rank; see iree_hal_local_channel_executor_t.
+  const void* executor_key;
+} iree_hal_local_channel_slot_t;
+
+// Single-message point-to-point mailbox between a source and target rank.
+// Senders publish their send range and wait for the target to copy out of it
+// so there is no intermediate staging memory.
+typedef struct {
+  const uint8_t* data;
+  iree_host_size_t length;
+  // Sequence number of the last message posted by the source.
+  iree_atomic_int32_t posted;
+  // Sequence number of the last message consumed by the target.
+  iree_atomic_int32_t consumed;
+} iree_hal_local_channel_mailbox_t;
+
+// Shared state of all ranks in a collective group.
+typedef struct iree_hal_local_channel_group_t {
+  // Protected by the registry mutex.
+  int32_t ref_count;
+  iree_allocator_t host_allocator;
+
+  // Next pending group in the registry; groups are pending until all ranks
+  // have joined and only pending groups can be found by new channels.
+  struct iree_hal_local_channel_group_t* next_pending;
+  bool is_pending;
+  // Number of ranks that have joined so far. Protected by the registry mutex.
+  int32_t joined_count;
+
+  // Total number of participants.
+  int32_t count;
+
+  // Sense-reversing barrier: the last rank to arrive resets the arrival count
+  // and advances the generation to release all other ranks.
+  iree_atomic_int32_t barrier_arrived;
+  iree_atomic_int32_t barrier_generation;
+
+  // Posted whenever the barrier generation or any mailbox changes.
+  iree_notification_t notification;
+
+  // [count] slots aligned to cache lines.
+  iree_hal_local_channel_slot_t* slots;
+  // [count * count] mailboxes indexed by source * count + target.
+  iree_hal_local_channel_mailbox_t* mailboxes;
+
+  // Rendezvous key (id bytes followed by the group name).
+  iree_const_byte_span_t key;
+} iree_hal_local_channel_group_t;
+
+static iree_status_t iree_hal_local_channel_group_allocate(
+    iree_const_byte_span_t id, iree_string_view_t group_name, int32_t count,
+    int32_t ref_count, iree_allocator_t host_allocator,
+    iree_hal_local_channel_group_t** out_group) {
+  *out_group = NULL;
+  const iree_host_size_t mailbox_count = (iree_host_size_t)count * count;
+  const iree_host_size_t key_length = id.data_length + group_name.size;
+  iree_hal_local_channel_group_t* group = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      host_allocator,
+      sizeof(*group) + mailbox_count * sizeof(group->mailboxes[0]) + key_length,
+      (void**)&group));
+  iree_status_t status = iree_allocator_malloc_aligned(
+      host_allocator, count * sizeof(group->slots[0]),
+      iree_hardware_destructive_interference_size, 0, (void**)&group->slots);
+  if (!iree_status_is_ok(status)) {
+    iree_allocator_free(host_allocator, group);
+    return status;
+  }
+
+  group->ref_count = ref_count;
+  group->host_allocator = host_allocator;
+  group->count = count;
+  iree_atomic_store_int32(&group->barrier_arrived, 0,
+                          iree_memory_order_relaxed);
+  iree_atomic_store_int32(&group->barrier_generation, 0,
+                          iree_memory_order_relaxed);
+  iree_notification_initialize(&group->notification);
+  group->mailboxes = (iree_hal_local_channel_mailbox_t*)(group + 1);
+  uint8_t* key_data = (uint8_t*)(group->mailboxes + mailbox_count);
+  memcpy(key_data, id.data, id.data_length);
+  memcpy(key_data + id.data_length, group_name.data, group_name.size);
+  group->key = iree_make_const_byte_span(key_data, key_length);
+
+  *out_group = group;
+  return iree_ok_status();
+}
+
+static void iree_hal_local_channel_group_free(
+    iree_hal_local_channel_group_t* group) {
+  iree_allocator_t host_allocator = group->host_allocator;
+  iree_notification_deinitialize(&group->notification);
+  iree_allocator_free_aligned(host_allocator, group->slots);
+  iree_allocator_free(host_allocator, group);
+}
+
+//===----------------------------------------------------------------------===//
+// Group registry
+//===----------------------------------------------------------------------===//
+
+// Process-global registry used by ranks to find each other.
+static struct {
+  iree_slim_mutex_t mutex;
+  // Groups that still have ranks that have not yet joined.
+  iree_hal_local_channel_group_t* pending_head;
+  // Used to generate default ids that are unique within the process.
+  int64_t next_default_id;
+} iree_hal_local_channel_registry;
+static iree_once_flag iree_hal_local_channel_registry_flag =
+    IREE_ONCE_FLAG_INIT;
+
+static void iree_hal_local_channel_registry_initialize(void) {
+  iree_slim_mutex_initialize(&iree_hal_local_channel_registry.mutex);
+  iree_hal_local_channel_registry.pending_head = NULL;
+  iree_hal_local_channel_registry.next_default_id = 1;
+}
+
+static void iree_hal_local_channel_registry_lock(void) {
+  iree_call_once(&iree_hal_local_channel_registry_flag,
+                 iree_hal_local_channel_registry_initialize);
+  iree_slim_mutex_lock(&iree_hal_local_channel_registry.mutex);
+}
+
+static void iree_hal_local_channel_registry_unlock(void) {
+  iree_slim_mutex_unlock(&iree_hal_local_channel_registry.mutex);
+}
+
+// Unlinks |group| from the pending list. Must be called with the lock held.
+static void iree_hal_local_channel_registry_remove_pending(
+    iree_hal_local_channel_group_t* group) {
+  if (!group->is_pending) return;
+  iree_hal_local_channel_group_t** prev_next =
+      &iree_hal_local_channel_registry.pending_head;
+  while (*prev_next != group) prev_next = &(*prev_next)->next_pending;
+  *prev_next = group->next_pending;
+  group->next_pending = NULL;
+  group->is_pending = false;
+}
+
+// Returns the number of joined ranks in |group| executing on |executor_key|.
+// Must be called with the lock held.
+static iree_host_size_t iree_hal_local_channel_group_executor_rank_count(
+    iree_hal_local_channel_group_t* group, const void* executor_key) {
+  iree_host_size_t rank_count = 0;
+  for (int32_t i = 0; i < group->count; ++i) {
+    if (group->slots[i].joined &&
+        group->slots[i].executor_key == executor_key) {
+      ++rank_count;
+    }
+  }
+  return rank_count;
+}
+
+// Joins |rank| to the pending group matching |id| and |group_name|, creating
+// the group if this is the first rank to arrive. The returned group is
+// retained by the caller.
+static iree_status_t iree_hal_local_channel_registry_join(
+    iree_const_byte_span_t id, iree_string_view_t group_name, int32_t rank,
+    int32_t count, iree_hal_local_channel_executor_t executor,
+    iree_allocator_t host_allocator,
+    iree_hal_local_channel_group_t** out_group) {
+  *out_group = NULL;
+  iree_hal_local_channel_registry_lock();
+
+  iree_hal_local_channel_group_t* group =
+      iree_hal_local_channel_registry.pending_head;
+  for (; group; group = group->next_pending) {
+    if (group->key.data_length == id.data_length + group_name.size &&
+        memcmp(group->key.data, id.data, id.data_length) == 0 &&
+        memcmp(group->key.data + id.data_length, group_name.data,
+               group_name.size) == 0) {
+      break;
+    }
+  }
+
+  iree_status_t status = iree_ok_status();
+  if (group) {
+    if (group->count != count) {
+      status = iree_make_status(
+          IREE_STATUS_INVALID_ARGUMENT,
+          "channel group '%.*s' has %d participants but %d were requested",
+          (int)group_name.size, group_name.data, group->count, count);
+    } else if (group->slots[rank].joined) {
+      status = iree_make_status(
+          IREE_STATUS_ALREADY_EXISTS,
+          "rank %d has already joined channel group '%.*s'", rank,
+          (int)group_name.size, group_name.data);
+    } else if (executor.key &&
+               iree_hal_local_channel_group_executor_rank_count(
+                   group, executor.key) >= executor.concurrency) {
+      // Every rank blocks one thread of its executor until all ranks arrive
+      // so any rank beyond the executor concurrency would never be scheduled.
+      status = iree_make_status(
+          IREE_STATUS_FAILED_PRECONDITION,
+          "rank %d of channel group '%.*s' shares an executor that can only "
+          "block %" PRIhsz " threads in collectives with other ranks of the "
+          "group; collectives would deadlock (use one device per rank or an "
+          "executor with more workers)",
+          rank, (int)group_name.size, group_name.data, executor.concurrency);
+    } else {
+      ++group->ref_count;
+    }
+  } else {
+    status = iree_hal_local_channel_group_allocate(
+        id, group_name, count, /*ref_count=*/1, host_allocator, &group);
+    if (iree_status_is_ok(status)) {
+      group->is_pending = true;
+      group->next_pending = iree_hal_local_channel_registry.pending_head;
+      iree_hal_local_channel_registry.pending_head = group;
+    }
+  }
+
+  if (iree_status_is_ok(status)) {
+    group->slots[rank].joined = true;
+    group->slots[rank].executor_key = executor.key;
+    if (++group->joined_count == group->count) {
+      // All ranks have arrived and no one else may join the group. A new
+      // channel with the same key will create a new group.
+      iree_hal_local_channel_registry_remove_pending(group);
+    }
+    *out_group = group;
+  }
+
+  iree_hal_local_channel_registry_unlock();
+  return status;
+}
+
+static void iree_hal_local_channel_group_release(
+    iree_hal_local_channel_group_t* group) {
+  if (!group) return;
+  iree_hal_local_channel_registry_lock();
+  const bool is_last = --group->ref_count == 0;
+  if (is_last) iree_hal_local_channel_registry_remove_pending(group);
+  iree_hal_local_channel_registry_unlock();
+  if (is_last) iree_hal_local_channel_group_free(group);
+}
+
+//===----------------------------------------------------------------------===//
+// Synchronization
+//===----------------------------------------------------------------------===//
+
+typedef struct {
+  iree_atomic_int32_t* value;
+  int32_t expected;
+} iree_hal_local_channel_wait_t;
+
+static bool iree_hal_local_channel_value_changed(void* arg) {
+  iree_hal_local_channel_wait_t* wait = (iree_hal_local_channel_wait_t*)arg;
+  return iree_atomic_load_int32(wait->value, iree_memory_order_acquire) !=
+         wait->expected;
+}
+
+static bool iree_hal_local_channel_value_equal(void* arg) {
+  iree_hal_local_channel_wait_t* wait = (iree_hal_local_channel_wait_t*)arg;
+  return iree_atomic_load_int32(wait->value, iree_memory_order_acquire) ==
+         wait->expected;
+}
+
+// Blocks until all ranks in |group| have arrived at the barrier.
+// All memory writes made by any rank prior to arriving are visible to all
+// ranks after the barrier.
+static void iree_hal_local_channel_group_barrier(
+    iree_hal_local_channel_group_t* group) {
+  if (group->count == 1) return;
+  iree_hal_local_channel_wait_t wait = {
+      .value = &group->barrier_generation,
+      .expected = iree_atomic_load_int32(&group->barrier_generation,
+                                         iree_memory_order_acquire),
+  };
+  const int32_t arrived = iree_atomic_fetch_add_int32(
+      &group->barrier_arrived, 1, iree_memory_order_acq_rel);
+  if (arrived + 1 == group->count) {
+    // Last to arrive: reset for the next use and release all waiters. No rank
+    // can arrive again until it observes the generation change.
+    iree_atomic_store_int32(&group->barrier_arrived, 0,
+                            iree_memory_order_relaxed);
+    iree_atomic_store_int32(&group->barrier_generation, wait.expected + 1,
+                            iree_memory_order_release);
+    iree_notification_post(&group->notification, IREE_ALL_WAITERS);
+  } else {
+    iree_notification_await(&group->notification,
+                            iree_hal_local_channel_value_changed, &wait,
+                            iree_infinite_timeout());
+  }
+}
+
+// Posts |data| to the mailbox from |source| to |target| and returns the
+// sequence number of the message. The data must remain valid until
+// iree_hal_local_channel_group_await_consumed returns.
+static int32_t iree_hal_local_channel_group_post(
+    iree_hal_local_channel_group_t* group, int32_t source, int32_t target,
+    iree_const_byte_span_t data) {
+  iree_hal_local_channel_mailbox_t* mailbox =
+      &group->mailboxes[source * group->count + target];
+  const int32_t sequence =
+      iree_atomic_load_int32(&mailbox->posted, iree_memory_order_relaxed) + 1;
+  mailbox->data = data.data;
+  mailbox->length = data.data_length;
+  iree_atomic_store_int32(&mailbox->posted, sequence,
+                          iree_memory_order_release);
+  iree_notification_post(&group->notification, IREE_ALL_WAITERS);
+  return sequence;
+}
+
+// Blocks until the message |sequence| posted from |source| to |target| has
+// been consumed.
+static void iree_hal_local_channel_group_await_consumed(
+    iree_hal_local_channel_group_t* group, int32_t source, int32_t target,
+    int32_t sequence) {
+  iree_hal_local_channel_mailbox_t* mailbox =
+      &group->mailboxes[source * group->count + target];
+  iree_hal_local_channel_wait_t wait = {
+      .value = &mailbox->consumed,
+      .expected = sequence,
+  };
+  iree_notification_await(&group->notification,
+                          iree_hal_local_channel_value_equal, &wait,
+                          iree_infinite_timeout());
+}
+
+// Blocks until a message from |source| to |target| is available and copies it
+// into |data|.
+static iree_status_t iree_hal_local_channel_group_receive(
+    iree_hal_local_channel_group_t* group, int32_t source, int32_t target,
+    iree_byte_span_t data) {
+  iree_hal_local_channel_mailbox_t* mailbox =
+      &group->mailboxes[source * group->count + target];
+  iree_hal_local_channel_wait_t wait = {
+      .value = &mailbox->posted,
+      .expected =
+          iree_atomic_load_int32(&mailbox->consumed, iree_memory_order_relaxed),
+  };
+  iree_notification_await(&group->notification,
+                          iree_hal_local_channel_value_changed, &wait,
+                          iree_infinite_timeout());
+  iree_status_t status = iree_ok_status();
+  if (IREE_LIKELY(mailbox->length == data.data_length)) {
+    memcpy(data.data, mailbox->data, data.data_length);
+  } else {
+    status = iree_make_status(
+        IREE_STATUS_INVALID_ARGUMENT,
+        "rank %d sent %" PRIhsz " bytes to rank %d but %" PRIhsz
+        " bytes were expected",
+        source, mailbox->length, target, data.data_length);
+  }
+  // Always consume the message so that the sender does not hang.
+  iree_atomic_store_int32(&mailbox->consumed, wait.expected + 1,
+                          iree_memory_order_release);
+  iree_notification_post(&group->notification, IREE_ALL_WAITERS);
+  return status;
+}
+
+//===----------------------------------------------------------------------===//
+// iree_hal_local_channel_t
+//===----------------------------------------------------------------------===//
+
+typedef struct iree_hal_local_channel_t {
+  iree_hal_resource_t resource;
+  iree_allocator_t host_allocator;
+
+  // Shared group state; retained.
+  iree_hal_local_channel_group_t* group;
+
+  // This participant's rank in the group.
+  int32_t rank;
+  // Total number of participants in the group.
+  int32_t count;
+} iree_hal_local_channel_t;
+
+static const iree_hal_channel_vtable_t iree_hal_local_channel_vtable;
+
+static iree_hal_local_channel_t* iree_hal_local_channel_cast(
+    iree_hal_channel_t* base_value) {
+  IREE_HAL_ASSERT_TYPE(base_value, &iree_hal_local_channel_vtable);
+  return (iree_hal_local_channel_t*)base_value;
+}
+
+static const iree_hal_local_channel_t* iree_hal_local_channel_const_cast(
+    const iree_hal_channel_t* base_value) {
+  IREE_HAL_ASSERT_TYPE(base_value, &iree_hal_local_channel_vtable);
+  return (const iree_hal_local_channel_t*)base_value;
+}
+
+bool iree_hal_local_channel_isa(iree_hal_channel_t* channel) {
+  return iree_hal_resource_is(channel, &iree_hal_local_channel_vtable);
+}
+
+// Wraps a retained |group| reference in a new channel. The reference is
+// released on failure.
+static iree_status_t iree_hal_local_channel_wrap_group(
+    iree_hal_local_channel_group_t* group, int32_t rank,
+    iree_allocator_t host_allocator, iree_hal_channel_t** out_channel) {
+  iree_hal_local_channel_t* channel = NULL;
+  iree_status_t status =
+      iree_allocator_malloc(host_allocator, sizeof(*channel), (void**)&channel);
+  if (iree_status_is_ok(status)) {
+    iree_hal_resource_initialize(&iree_hal_local_channel_vtable,
+                                 &channel->resource);
+    channel->host_allocator = host_allocator;
+    channel->group = group;
+    channel->rank = rank;
+    channel->count = group->count;
+    *out_channel = (iree_hal_channel_t*)channel;
+  } else {
+    iree_hal_local_channel_group_release(group);
+  }
+  return status;
+}
+
+iree_status_t iree_hal_local_channel_create(
+    iree_hal_channel_provider_t* channel_provider,
+    iree_hal_channel_params_t params,
+    iree_hal_local_channel_executor_t executor, iree_allocator_t host_allocator,
+    iree_hal_channel_t** out_channel) {
+  IREE_ASSERT_ARGUMENT(out_channel);
+  *out_channel = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Ask the channel provider (if configured) for the default rank and count
+  // if the user did not set them.
+  if (channel_provider && (params.rank == IREE_HAL_CHANNEL_RANK_DEFAULT ||
+                           params.count == IREE_HAL_CHANNEL_COUNT_DEFAULT)) {
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0,
+        iree_hal_channel_provider_query_default_rank_and_count(
+            channel_provider, &params.rank, &params.count),
+        "querying default collective group rank and count");
+  }
+  if (params.rank == IREE_HAL_CHANNEL_RANK_DEFAULT &&
+      params.count == IREE_HAL_CHANNEL_COUNT_DEFAULT) {
+    // No environment to source from so the channel is standalone.
+    params.rank = 0;
+    params.count = 1;
+  }
+  if (params.count <= 0 || params.rank < 0 || params.rank >= params.count) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "invalid channel rank %d of %d participants",
+                            params.rank, params.count);
+  }
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, params.rank);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, params.count);
+
+  // With a provider and no explicit id the root picks an id unique to this
+  // process and shares it with all participants. Participants must all be in
+  // this process in order to rendezvous.
+  int64_t default_id = 0;
+  if (channel_provider && iree_const_byte_span_is_empty(params.id) &&
+      params.count > 1) {
+    if (params.rank == 0) {
+      iree_hal_local_channel_registry_lock();
+      default_id = iree_hal_local_channel_registry.next_default_id++;
+      iree_hal_local_channel_registry_unlock();
+    }
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0,
+        iree_hal_channel_provider_exchange_default_id(
+            channel_provider,
+            iree_make_byte_span((void*)&default_id, sizeof(default_id))),
+        "exchanging channel ID with other participants");
+    params.id = iree_make_const_byte_span(&default_id, sizeof(default_id));
+  }
+
+  iree_hal_local_channel_group_t* group = NULL;
+  iree_status_t status = iree_ok_status();
+  if (params.count == 1) {
+    // Nothing to rendezvous with.
+    status = iree_hal_local_channel_group_allocate(
+        iree_const_byte_span_empty(), iree_string_view_empty(), 1,
+        /*ref_count=*/1, host_allocator, &group);
+  } else {
+    status = iree_hal_local_channel_registry_join(
+        params.id, params.group, params.rank, params.count, executor,
+        host_allocator, &group);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_local_channel_wrap_group(group, params.rank,
+                                               host_allocator, out_channel);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static void iree_hal_local_channel_destroy(iree_hal_channel_t* base_channel) {
+  iree_hal_local_channel_t* channel = iree_hal_local_channel_cast(base_channel);
+  iree_allocator_t host_allocator = channel->host_allocator;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_local_channel_group_release(channel->group);
+  iree_allocator_free(host_allocator, channel);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+// Splits the group the same way as MPI_Comm_split: all ranks sharing a color
+// form a new group ordered by key and then by their rank in the parent group.
+// The lowest parent rank of each color allocates the new group on behalf of
+// the others.
+static iree_status_t iree_hal_local_channel_split(
+    iree_hal_channel_t* base_channel, int32_t color, int32_t key,
+    iree_hal_channel_flags_t flags, iree_hal_channel_t** out_split_channel) {
+  iree_hal_local_channel_t* channel = iree_hal_local_channel_cast(base_channel);
+  iree_hal_local_channel_group_t* group = channel->group;
+  iree_hal_local_channel_slot_t* slots = group->slots;
+  *out_split_channel = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  slots[channel->rank].split_color = color;
+  slots[channel->rank].split_key = key;
+  slots[channel->rank].split_group = NULL;
+  iree_hal_local_channel_group_barrier(group);
+
+  // Find our rank in the split group and its leader.
+  int32_t leader = -1;
+  int32_t split_rank = 0;
+  int32_t split_count = 0;
+  if (color != IREE_HAL_CHANNEL_NO_COLOR) {
+    for (int32_t i = 0; i < channel->count; ++i) {
+      if (slots[i].split_color != color) continue;
+      if (leader == -1) leader = i;
+      ++split_count;
+      if (slots[i].split_key < key ||
+          (slots[i].split_key == key && i < channel->rank)) {
+        ++split_rank;
+      }
+    }
+  }
+
+  // The leader allocates the group with one reference per participant. On
+  // failure the other participants observe a NULL group.
+  iree_status_t status = iree_ok_status();
+  if (leader == channel->rank) {
+    iree_hal_local_channel_group_t* split_group = NULL;
+    status = iree_hal_local_channel_group_allocate(
+        iree_const_byte_span_empty(), iree_string_view_empty(), split_count,
+        /*ref_count=*/split_count, channel->host_allocator, &split_group);
+    if (iree_status_is_ok(status)) {
+      split_group->joined_count = split_count;
+      for (int32_t i = 0; i < split_count; ++i) {
+        split_group->slots[i].joined = true;
+      }
+    }
+    slots[channel->rank].split_group = split_group;
+  }
+  iree_hal_local_channel_group_barrier(group);
+
+  iree_hal_local_channel_group_t* split_group =
+      leader >= 0 ? slots[leader].split_group : NULL;
+  if (iree_status_is_ok(status) && leader >= 0 && !split_group) {
+    status = iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                              "split group leader rank %d failed to allocate "
+                              "the group",
+                              leader);
+  }
+  if (iree_status_is_ok(status) && split_group) {
+    status = iree_hal_local_channel_wrap_group(
+        split_group, split_rank, channel->host_allocator, out_split_channel);
+  }
+
+  // Don't let the leader slot be reused until everyone has read it.
+  iree_hal_local_channel_group_barrier(group);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static void iree_hal_local_channel_query_rank_and_count(
+    const iree_hal_channel_t* base_channel, int32_t* out_rank,
+    int32_t* out_count) {
+  const iree_hal_local_channel_t* channel =
+      iree_hal_local_channel_const_cast(base_channel);
+  *out_rank = channel->rank;
+  *out_count = channel->count;
+}
+
+//===----------------------------------------------------------------------===//
+// Collective operations
+//===----------------------------------------------------------------------===//
+
+// Decodes the target and source ranks of IREE_HAL_COLLECTIVE_KIND_SEND_RECV.
+static void iree_hal_local_channel_decode_send_recv(uint32_t param,
+                                                    int32_t* out_target,
+                                                    int32_t* out_source) {
+  *out_target = (int16_t)(param & 0xFFFFu);
+  *out_source = (int16_t)(param >> 16);
+}
+
+iree_status_t iree_hal_local_channel_validate_collective(
+    iree_hal_channel_t* base_channel, iree_hal_collective_op_t op,
+    uint32_t param, iree_host_size_t send_length, iree_host_size_t recv_length,
+    iree_device_size_t element_count) {
+  iree_hal_local_channel_t* channel = iree_hal_local_channel_cast(base_channel);
+  const int32_t rank = channel->rank;
+  const int32_t count = channel->count;
+
+  if (op.element_type > IREE_HAL_COLLECTIVE_ELEMENT_TYPE_MAX_VALUE) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "unknown collective element type %u",
+                            op.element_type);
+  }
+  const bool is_reduction = op.kind == IREE_HAL_COLLECTIVE_KIND_ALL_REDUCE ||
+                            op.kind == IREE_HAL_COLLECTIVE_KIND_REDUCE ||
+                            op.kind == IREE_HAL_COLLECTIVE_KIND_REDUCE_SCATTER;
+  if (is_reduction &&
+      (op.reduction == IREE_HAL_COLLECTIVE_REDUCTION_NONE ||
+       op.reduction > IREE_HAL_COLLECTIVE_REDUCTION_MAX_VALUE)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "unsupported collective reduction %u",
+                            op.reduction);
+  }
+
+  const iree_device_size_t byte_length =
+      element_count * iree_hal_collective_element_byte_count(op.element_type);
+  iree_device_size_t required_send = 0;
+  iree_device_size_t required_recv = 0;
+  switch (op.kind) {
+    case IREE_HAL_COLLECTIVE_KIND_ALL_GATHER:
+      required_send = byte_length;
+      required_recv = byte_length * count;
+      break;
+    case IREE_HAL_COLLECTIVE_KIND_ALL_REDUCE:
+      required_send = byte_length;
+      required_recv = byte_length;
+      break;
+    case IREE_HAL_COLLECTIVE_KIND_ALL_TO_ALL:
+      if (element_count % count != 0) {
+        return iree_make_status(
+            IREE_STATUS_INVALID_ARGUMENT,
+            "all-to-all element count %" PRIdsz
+            " must be divisible by the participant count %d",
+            element_count, count);
+      }
+      required_send = byte_length;
+      required_recv = byte_length;
+      break;
+    case IREE_HAL_COLLECTIVE_KIND_BROADCAST:
+    case IREE_HAL_COLLECTIVE_KIND_REDUCE:
+      if (param >= (uint32_t)count) {
+        return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                "root rank %u out of range [0, %d)", param,
+                                count);
+      }
+      if (op.kind == IREE_HAL_COLLECTIVE_KIND_BROADCAST) {
+        required_send = param == (uint32_t)rank ? byte_length : 0;
+        required_recv = param == (uint32_t)rank ? 0 : byte_length;
+      } else {
+        required_send = byte_length;
+        required_recv = param == (uint32_t)rank ? byte_length : 0;
+      }
+      break;
+    case IREE_HAL_COLLECTIVE_KIND_REDUCE_SCATTER:
+      required_send = byte_length * count;
+      required_recv = byte_length;
+      break;
+    case IREE_HAL_COLLECTIVE_KIND_SEND:
+    case IREE_HAL_COLLECTIVE_KIND_RECV:
+      if (param >= (uint32_t)count || param == (uint32_t)rank) {
+        return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                "peer rank %u invalid for rank %d of %d", param,
+                                rank, count);
+      }
+      if (op.kind == IREE_HAL_COLLECTIVE_KIND_SEND) {
+        required_send = byte_length;
+      } else {
+        required_recv = byte_length;
+      }
+      break;
+    case IREE_HAL_COLLECTIVE_KIND_SEND_RECV: {
+      int32_t target = 0;
+      int32_t source = 0;
+      iree_hal_local_channel_decode_send_recv(param, &target, &source);
+      if (target < -1 || target >= count || source < -1 || source >= count) {
+        return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                "send/recv target %d or source %d out of "
+                                "range [-1, %d)",
+                                target, source, count);
+      }
+      required_send = target != -1 ? byte_length : 0;
+      required_recv = byte_length;
+      break;
+    }
+    default:
+      return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                              "unhandled collective kind %u", op.kind);
+  }
+
+  if (send_length < required_send || recv_length < required_recv) {
+    return iree_make_status(
+        IREE_STATUS_OUT_OF_RANGE,
+        "collective requires %" PRIdsz " send bytes and %" PRIdsz
+        " recv bytes but %" PRIhsz " and %" PRIhsz " were provided",
+        required_send, required_recv, send_length, recv_length);
+  }
+  return iree_ok_status();
+}
+
+// Returns the range of elements [begin, end) out of |element_count| that
+// |rank| reduces. Ranges are rounded up to whole cache lines so that no two
+// ranks write to the same line of the output.
+static void iree_hal_local_channel_chunk_range(
+    iree_host_size_t element_count, iree_host_size_t element_size,
+    int32_t count, int32_t rank, iree_host_size_t* out_begin,
+    iree_host_size_t* out_end) {
+  const iree_host_size_t elements_per_line = iree_max(
+      1, iree_hardware_destructive_interference_size / element_size);
+  const iree_host_size_t chunk_size = iree_host_align(
+      (element_count + count - 1) / count, elements_per_line);
+  *out_begin = iree_min(rank * chunk_size, element_count);
+  *out_end = iree_min(*out_begin + chunk_size, element_count);
+}
+
+// Reduces elements [begin, end) of all published send buffers (offset by
+// |send_offset| bytes) into |target|. |first_rank| is used to seed the result
+// so that an in-place |target| aliasing its send buffer is never read after
+// being written.
+static void iree_hal_local_channel_reduce_range(
+    iree_hal_local_channel_group_t* group, iree_hal_collective_op_t op,
+    iree_host_size_t element_size, int32_t first_rank,
+    iree_host_size_t send_offset, iree_host_size_t begin, iree_host_size_t end,
+    uint8_t* target) {
+  if (begin >= end) return;
+  const iree_host_size_t element_count = end - begin;
+  const iree_host_size_t offset = send_offset + begin * element_size;
+  uint8_t* target_ptr = target + begin * element_size;
+  const uint8_t* first_ptr = group->slots[first_rank].send + offset;
+  if (target_ptr != first_ptr) {
+    memmove(target_ptr, first_ptr, element_count * element_size);
+  }
+  iree_hal_local_channel_reduce_fn_t reduce =
+      iree_hal_local_channel_reduce_table[op.element_type].reduce;
+  for (int32_t i = 0; i < group->count; ++i) {
+    if (i == first_rank) continue;
+    reduce(op.reduction, element_count, group->slots[i].send + offset,
+           target_ptr);
+  }
+  if (op.reduction == IREE_HAL_COLLECTIVE_REDUCTION_AVERAGE) {
+    iree_hal_local_channel_reduce_table[op.element_type].finalize(
+        element_count, group->count, target_ptr);
+  }
+}
+
+iree_status_t iree_hal_local_channel_execute_collective(
+    iree_hal_channel_t* base_channel, iree_hal_collective_op_t op,
+    uint32_t param, iree_const_byte_span_t send, iree_byte_span_t recv,
+    iree_device_size_t element_count) {
+  iree_hal_local_channel_t* channel = iree_hal_local_channel_cast(base_channel);
+  iree_hal_local_channel_group_t* group = channel->group;
+  iree_hal_local_channel_slot_t* slots = group->slots;
+  const int32_t rank = channel->rank;
+  const int32_t count = channel->count;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, op.kind);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, element_count);
+
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_local_channel_validate_collective(
+              base_channel, op, param, send.data_length, recv.data_length,
+              element_count));
+
+  const iree_host_size_t element_size =
+      (iree_host_size_t)iree_hal_collective_element_byte_count(op.element_type);
+  const iree_host_size_t byte_length =
+      (iree_host_size_t)element_count * element_size;
+
+  // Point-to-point operations only synchronize the two ranks involved.
+  iree_status_t status = iree_ok_status();
+  switch (op.kind) {
+    case IREE_HAL_COLLECTIVE_KIND_SEND: {
+      const int32_t sequence = iree_hal_local_channel_group_post(
+          group, rank, (int32_t)param,
+          iree_make_const_byte_span(send.data, byte_length));
+      iree_hal_local_channel_group_await_consumed(group, rank, (int32_t)param,
+                                                  sequence);
+      IREE_TRACE_ZONE_END(z0);
+      return status;
+    }
+    case IREE_HAL_COLLECTIVE_KIND_RECV: {
+      status = iree_hal_local_channel_group_receive(
+          group, (int32_t)param, rank,
+          iree_make_byte_span(recv.data, byte_length));
+      IREE_TRACE_ZONE_END(z0);
+      return status;
+    }
+    case IREE_HAL_COLLECTIVE_KIND_SEND_RECV: {
+      int32_t target = 0;
+      int32_t source = 0;
+      iree_hal_local_channel_decode_send_recv(param, &target, &source);
+      // Post before receiving so that rings of exchanges don't deadlock.
+      int32_t sequence = 0;
+      if (target != -1) {
+        sequence = iree_hal_local_channel_group_post(
+            group, rank, target,
+            iree_make_const_byte_span(send.data, byte_length));
+      }
+      if (source != -1) {
+        status = iree_hal_local_channel_group_receive(
+            group, source, rank, iree_make_byte_span(recv.data, byte_length));
+      } else {
+        memset(recv.data, 0, byte_length);
+      }
+      if (target != -1) {
+        iree_hal_local_channel_group_await_consumed(group, rank, target,
+                                                    sequence);
+      }
+      IREE_TRACE_ZONE_END(z0);
+      return status;
+    }
+    default:
+      break;
+  }
+
+  // Publish our buffers so that peers can access them directly.
+  slots[rank].send = send.data;
+  slots[rank].recv = recv.data;
+  iree_hal_local_channel_group_barrier(group);
+
+  switch (op.kind) {
+    case IREE_HAL_COLLECTIVE_KIND_ALL_GATHER: {
+      for (int32_t i = 0; i < count; ++i) {
+        uint8_t* target_ptr = recv.data + i * byte_length;
+        if (target_ptr == slots[i].send) continue;  // in-place
+        memcpy(target_ptr, slots[i].send, byte_length);
+      }
+      break;
+    }
+    case IREE_HAL_COLLECTIVE_KIND_ALL_REDUCE: {
+      // Reduce-scatter: each rank reduces its own chunk of all ranks into its
+      // recv buffer and then gathers the chunks reduced by all other ranks.
+      iree_host_size_t begin = 0;
+      iree_host_size_t end = 0;
+      iree_hal_local_channel_chunk_range(element_count, element_size, count,
+                                         rank, &begin, &end);
+      iree_hal_local_channel_reduce_range(group, op, element_size, rank,
+                                          /*send_offset=*/0, begin, end,
+                                          recv.data);
+      iree_hal_local_channel_group_barrier(group);
+      for (int32_t i = 0; i < count; ++i) {
+        if (i == rank) continue;
+        iree_hal_local_channel_chunk_range(element_count, element_size, count,
+                                           i, &begin, &end);
+        if (begin >= end) continue;
+        memcpy(recv.data + begin * element_size,
+               slots[i].recv + begin * element_size,
+               (end - begin) * element_size);
+      }
+      break;
+    }
+    case IREE_HAL_COLLECTIVE_KIND_ALL_TO_ALL: {
+      const iree_host_size_t part_length = byte_length / count;
+      for (int32_t i = 0; i < count; ++i) {
+        memcpy(recv.data + i * part_length, slots[i].send + rank * part_length,
+               part_length);
+      }
+      break;
+    }
+    case IREE_HAL_COLLECTIVE_KIND_BROADCAST: {
+      const uint8_t* source_ptr = slots[param].send;
+      if (recv.data && recv.data != source_ptr) {
+        memcpy(recv.data, source_ptr, byte_length);
+      }
+      break;
+    }
+    case IREE_HAL_COLLECTIVE_KIND_REDUCE: {
+      // All ranks reduce a chunk directly into the root's recv buffer.
+      iree_host_size_t begin = 0;
+      iree_host_size_t end = 0;
+      iree_hal_local_channel_chunk_range(element_count, element_size, count,
+                                         rank, &begin, &end);
+      iree_hal_local_channel_reduce_range(group, op, element_size,
+                                          (int32_t)param, /*send_offset=*/0,
+                                          begin, end, slots[param].recv);
+      break;
+    }
+    case IREE_HAL_COLLECTIVE_KIND_REDUCE_SCATTER: {
+      iree_hal_local_channel_reduce_range(
+          group, op, element_size, rank, /*send_offset=*/rank * byte_length,
+          /*begin=*/0, /*end=*/element_count, recv.data);
+      break;
+    }
+    default:
+      break;
+  }
+
+  // Don't let any rank reuse its buffers until all peers are done with them.
+  iree_hal_local_channel_group_barrier(group);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static const iree_hal_channel_vtable_t iree_hal_local_channel_vtable = {
+    .destroy = iree_hal_local_channel_destroy,
+    .split = iree_hal_local_channel_split,
+    .query_rank_and_count = iree_hal_local_channel_query_rank_and_count,
+};
@@ -0,0 +1,88 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_LOCAL_LOCAL_CHANNEL_H_
+#define IREE_HAL_LOCAL_LOCAL_CHANNEL_H_
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// iree_hal_local_channel_t
+//===----------------------------------------------------------------------===//
+
+// Describes the threads that execute the collective operations of a rank.
+typedef struct iree_hal_local_channel_executor_t {
+  // Identifies the executor shared by all ranks executing on it or NULL if
+  // collectives run on the thread that issues them (such as with local-sync).
+  const void* key;
+  // Maximum number of threads of the executor that may block in collectives at
+  // the same time (usually its worker count). Ignored if |key| is NULL.
+  iree_host_size_t concurrency;
+} iree_hal_local_channel_executor_t;
+
+// Returns an executor description for collectives that run on the thread that
+// issues them.
+static inline iree_hal_local_channel_executor_t
+iree_hal_local_channel_executor_inline(void) {
+  iree_hal_local_channel_executor_t executor = {NULL, 0};
+  return executor;
+}
+
+// Creates a collective channel whose participants are all in the current
+// process and communicate through host memory.
+//
+// Ranks rendezvous with each other by the channel |params| id and group: all
+// channels created with the same id/group pair and count form one collective
+// group once every rank in `[0, count)` has been created. An empty id is valid
+// and allows ranks to rendezvous by group name alone. If |channel_provider| is
+// provided it is used to populate a default rank/count and to exchange a
+// default id as with other HAL implementations. When no rank/count is provided
+// and there is no provider the channel is rank 0 of a group of 1.
+//
+// Collective operations block the calling thread until all participating ranks
+// have arrived and as such each rank must be executed on its own thread.
+// |executor| describes the threads executing the rank's collectives and ranks
+// that would have to share a thread are rejected with
+// IREE_STATUS_FAILED_PRECONDITION instead of deadlocking on first use.
+// Operations on a group must be issued by all ranks in the same order.
+iree_status_t iree_hal_local_channel_create(
+    iree_hal_channel_provider_t* channel_provider,
+    iree_hal_channel_params_t params,
+    iree_hal_local_channel_executor_t executor, iree_allocator_t host_allocator,
+    iree_hal_channel_t** out_channel);
+
+// Returns true if |channel| is a local channel created with
+// iree_hal_local_channel_create.
+bool iree_hal_local_channel_isa(iree_hal_channel_t* channel);
+
+// Verifies that |op| is supported by local channels and that the provided
+// binding lengths are sufficient for the operation on |channel|.
+// Intended to be used while recording so that errors are reported early.
+iree_status_t iree_hal_local_channel_validate_collective(
+    iree_hal_channel_t* channel, iree_hal_collective_op_t op, uint32_t param,
+    iree_host_size_t send_length, iree_host_size_t recv_length,
+    iree_device_size_t element_count);
+
+// Executes the collective operation |op| on |channel| using the host memory
+// ranges |send| and |recv|. Blocks until all ranks participating in the
+// operation have completed their parts such that all memory is safe to reuse
+// upon return. See iree_hal_command_buffer_collective for the semantics of
+// each operation.
+iree_status_t iree_hal_local_channel_execute_collective(
+    iree_hal_channel_t* channel, iree_hal_collective_op_t op, uint32_t param,
+    iree_const_byte_span_t send, iree_byte_span_t recv,
+    iree_device_size_t element_count);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_LOCAL_LOCAL_CHANNEL_H_
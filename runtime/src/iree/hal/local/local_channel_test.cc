@@ -0,0 +1,89 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/local/local_channel.h"
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+using ::iree::testing::status::StatusIs;
+
+// Stand-ins for executors; only their addresses are used as keys.
+static int executor_a = 0;
+static int executor_b = 0;
+
+static iree_hal_local_channel_executor_t MakeExecutor(
+    const void* key, iree_host_size_t concurrency) {
+  iree_hal_local_channel_executor_t executor = {key, concurrency};
+  return executor;
+}
+
+static iree_status_t CreateChannel(const char* group, int32_t rank,
+                                   int32_t count,
+                                   iree_hal_local_channel_executor_t executor,
+                                   iree_hal_channel_t** out_channel) {
+  iree_hal_channel_params_t params = {0};
+  params.group = iree_make_cstring_view(group);
+  params.rank = rank;
+  params.count = count;
+  return iree_hal_local_channel_create(/*channel_provider=*/NULL, params,
+                                       executor, iree_allocator_system(),
+                                       out_channel);
+}
+
+TEST(LocalChannelTest, RanksWithinExecutorConcurrency) {
+  iree_hal_channel_t* channels[2] = {NULL};
+  for (int32_t rank = 0; rank < 2; ++rank) {
+    IREE_ASSERT_OK(CreateChannel("within", rank, 2,
+                                 MakeExecutor(&executor_a, 2),
+                                 &channels[rank]));
+  }
+  for (iree_hal_channel_t* channel : channels) {
+    iree_hal_channel_release(channel);
+  }
+}
+
+TEST(LocalChannelTest, RanksExceedingExecutorConcurrencyAreRejected) {
+  iree_hal_channel_t* channel0 = NULL;
+  IREE_ASSERT_OK(CreateChannel("exceeding", 0, 2, MakeExecutor(&executor_a, 1),
+                               &channel0));
+
+  // Both ranks would need to block the only worker of the executor.
+  iree_hal_channel_t* channel1 = NULL;
+  EXPECT_THAT(Status(CreateChannel("exceeding", 1, 2,
+                                   MakeExecutor(&executor_a, 1), &channel1)),
+              StatusIs(StatusCode::kFailedPrecondition));
+  EXPECT_EQ(channel1, nullptr);
+
+  // The rank can still join from an executor of its own.
+  IREE_ASSERT_OK(CreateChannel("exceeding", 1, 2, MakeExecutor(&executor_b, 1),
+                               &channel1));
+
+  iree_hal_channel_release(channel0);
+  iree_hal_channel_release(channel1);
+}
+
+TEST(LocalChannelTest, InlineRanksAreNotLimited) {
+  iree_hal_channel_t* channels[3] = {NULL};
+  for (int32_t rank = 0; rank < 3; ++rank) {
+    IREE_ASSERT_OK(CreateChannel("inline", rank, 3,
+                                 iree_hal_local_channel_executor_inline(),
+                                 &channels[rank]));
+  }
+  for (iree_hal_channel_t* channel : channels) {
+    iree_hal_channel_release(channel);
+  }
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
@@ -0,0 +1,563 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/runtime/batcher.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/synchronization.h"
+#include "iree/base/internal/threading.h"
+#include "iree/modules/hal/module.h"
+#include "iree/runtime/session.h"
+
+//===----------------------------------------------------------------------===//
+// iree_runtime_batcher_options_t
+//===----------------------------------------------------------------------===//
+
+IREE_API_EXPORT void iree_runtime_batcher_options_initialize(
+    iree_runtime_batcher_options_t* out_options) {
+  memset(out_options, 0, sizeof(*out_options));
+  out_options->max_batch_size = 32;
+  out_options->max_latency = 2 * 1000000ll;  // 2ms
+}
+
+//===----------------------------------------------------------------------===//
+// iree_runtime_batcher_request_t
+//===----------------------------------------------------------------------===//
+
+// A single enqueued call waiting to be batched.
+typedef struct iree_runtime_batcher_request_t {
+  struct iree_runtime_batcher_request_t* next;
+  // Caller-provided lists retained until the request completes.
+  iree_vm_list_t* inputs;
+  iree_vm_list_t* outputs;
+  // Signaled (or failed) once |outputs| has been populated.
+  iree_hal_fence_t* signal_fence;
+  // Leading dimension shared by all inputs.
+  iree_hal_dim_t batch_size;
+  // Time the request was enqueued used to bound its latency.
+  iree_time_t enqueue_time_ns;
+} iree_runtime_batcher_request_t;
+
+static void iree_runtime_batcher_request_free(
+    iree_allocator_t host_allocator, iree_runtime_batcher_request_t* request) {
+  iree_vm_list_release(request->inputs);
+  iree_vm_list_release(request->outputs);
+  iree_hal_fence_release(request->signal_fence);
+  iree_allocator_free(host_allocator, request);
+}
+
+// Returns the leading dimension shared by all buffer views in |inputs|.
+static iree_status_t iree_runtime_batcher_query_batch_size(
+    iree_vm_list_t* inputs, iree_hal_dim_t* out_batch_size) {
+  *out_batch_size = 0;
+  iree_host_size_t input_count = iree_vm_list_size(inputs);
+  if (!input_count) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "batched calls require at least one input");
+  }
+  iree_hal_dim_t batch_size = 0;
+  for (iree_host_size_t i = 0; i < input_count; ++i) {
+    iree_hal_buffer_view_t* view =
+        iree_vm_list_get_buffer_view_assign(inputs, i);
+    if (!view) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "batched input %" PRIhsz " is not a buffer view",
+                              i);
+    }
+    if (iree_hal_buffer_view_shape_rank(view) < 1) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "batched input %" PRIhsz
+                              " must have a leading batch dimension",
+                              i);
+    }
+    iree_hal_dim_t dim = iree_hal_buffer_view_shape_dim(view, 0);
+    if (i == 0) {
+      batch_size = dim;
+    } else if (dim != batch_size) {
+      return iree_make_status(
+          IREE_STATUS_INVALID_ARGUMENT,
+          "batched input %" PRIhsz " has batch size %" PRIdim
+          " but input 0 has batch size %" PRIdim,
+          i, dim, batch_size);
+    }
+  }
+  if (!batch_size) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "batched inputs must have a non-zero batch size");
+  }
+  *out_batch_size = batch_size;
+  return iree_ok_status();
+}
+
+// Returns true if the inputs of |a| and |b| can be concatenated along their
+// leading dimension.
+static bool iree_runtime_batcher_requests_compatible(
+    const iree_runtime_batcher_request_t* a,
+    const iree_runtime_batcher_request_t* b) {
+  iree_host_size_t input_count = iree_vm_list_size(a->inputs);
+  if (iree_vm_list_size(b->inputs) != input_count) return false;
+  for (iree_host_size_t i = 0; i < input_count; ++i) {
+    iree_hal_buffer_view_t* a_view =
+        iree_vm_list_get_buffer_view_assign(a->inputs, i);
+    iree_hal_buffer_view_t* b_view =
+        iree_vm_list_get_buffer_view_assign(b->inputs, i);
+    iree_host_size_t rank = iree_hal_buffer_view_shape_rank(a_view);
+    if (iree_hal_buffer_view_shape_rank(b_view) != rank ||
+        iree_hal_buffer_view_element_type(a_view) !=
+            iree_hal_buffer_view_element_type(b_view) ||
+        iree_hal_buffer_view_encoding_type(a_view) !=
+            iree_hal_buffer_view_encoding_type(b_view)) {
+      return false;
+    }
+    const iree_hal_dim_t* a_dims = iree_hal_buffer_view_shape_dims(a_view);
+    const iree_hal_dim_t* b_dims = iree_hal_buffer_view_shape_dims(b_view);
+    if (memcmp(a_dims + 1, b_dims + 1, (rank - 1) * sizeof(*a_dims)) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+//===----------------------------------------------------------------------===//
+// iree_runtime_batcher_t
+//===----------------------------------------------------------------------===//
+
+struct iree_runtime_batcher_t {
+  iree_atomic_ref_count_t ref_count;
+
+  // Allocator used to allocate the batcher and per-request bookkeeping.
+  iree_allocator_t host_allocator;
+
+  // Session the batched function is called in. Only used from the batcher
+  // thread.
+  iree_runtime_session_t* session;
+  iree_vm_function_t function;
+
+  iree_runtime_batcher_options_t options;
+
+  // Thread issuing batched calls.
+  iree_thread_t* thread;
+
+  // Posted when a batch may be ready or the batcher is exiting.
+  iree_notification_t notification;
+
+  // Guards the pending request queue and exit flag.
+  iree_slim_mutex_t mutex;
+
+  // FIFO of pending requests.
+  iree_runtime_batcher_request_t* head;
+  iree_runtime_batcher_request_t* tail;
+  // Sum of the batch size of all pending requests.
+  iree_host_size_t pending_size;
+
+  // Set when the batcher is being destroyed; the thread exits once all pending
+  // requests have been executed.
+  bool is_exiting;
+
+  // Set by the batcher thread once it has drained the queue and will no longer
+  // touch the batcher. Destruction waits on this as the thread handle is only
+  // joined on release if the thread has already started running.
+  iree_atomic_int32_t has_exited;
+
+  // Lists reused across batched calls. Only used from the batcher thread.
+  iree_vm_list_t* batch_inputs;
+  iree_vm_list_t* batch_outputs;
+};
+
+// Concatenates input |input_ordinal| of all requests in the |batch| list into a
+// new buffer view with a leading dimension of |batch_size|.
+static iree_status_t iree_runtime_batcher_gather_input(
+    iree_runtime_batcher_t* batcher, iree_runtime_batcher_request_t* batch,
+    iree_hal_dim_t batch_size, iree_host_size_t input_ordinal,
+    iree_hal_buffer_view_t** out_buffer_view) {
+  *out_buffer_view = NULL;
+  iree_hal_device_t* device = iree_runtime_session_device(batcher->session);
+  iree_hal_buffer_view_t* first_view =
+      iree_vm_list_get_buffer_view_assign(batch->inputs, input_ordinal);
+
+  // Shape of the batched input is the shape of any request with the leading
+  // dimension replaced.
+  iree_host_size_t rank = iree_hal_buffer_view_shape_rank(first_view);
+  iree_hal_dim_t* shape =
+      (iree_hal_dim_t*)iree_alloca(rank * sizeof(iree_hal_dim_t));
+  memcpy(shape, iree_hal_buffer_view_shape_dims(first_view),
+         rank * sizeof(iree_hal_dim_t));
+  shape[0] = batch_size;
+  iree_device_size_t row_length =
+      iree_hal_buffer_view_byte_length(first_view) / batch->batch_size;
+
+  const iree_hal_buffer_params_t params = {
+      .type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL,
+      .usage = IREE_HAL_BUFFER_USAGE_DEFAULT,
+  };
+  iree_hal_buffer_t* buffer = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_allocator_allocate_buffer(
+      iree_runtime_session_device_allocator(batcher->session), params,
+      row_length * batch_size, iree_const_byte_span_empty(), &buffer));
+
+  iree_status_t status = iree_ok_status();
+  iree_device_size_t offset = 0;
+  for (iree_runtime_batcher_request_t* request = batch;
+       request && iree_status_is_ok(status); request = request->next) {
+    iree_hal_buffer_view_t* view =
+        iree_vm_list_get_buffer_view_assign(request->inputs, input_ordinal);
+    iree_device_size_t length = iree_hal_buffer_view_byte_length(view);
+    status = iree_hal_device_transfer_d2d(
+        device, iree_hal_buffer_view_buffer(view), 0, buffer, offset, length,
+        IREE_HAL_TRANSFER_BUFFER_FLAG_DEFAULT, iree_infinite_timeout());
+    offset += length;
+  }
+
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_buffer_view_create(
+        buffer, rank, shape, iree_hal_buffer_view_element_type(first_view),
+        iree_hal_buffer_view_encoding_type(first_view), batcher->host_allocator,
+        out_buffer_view);
+  }
+  iree_hal_buffer_release(buffer);
+  return status;
+}
+
+// Slices |batched_view| along its leading dimension and appends each request's
+// portion to its outputs.
+static iree_status_t iree_runtime_batcher_scatter_output(
+    iree_runtime_batcher_t* batcher, iree_runtime_batcher_request_t* batch,
+    iree_hal_dim_t batch_size, iree_hal_buffer_view_t* batched_view) {
+  iree_host_size_t rank = iree_hal_buffer_view_shape_rank(batched_view);
+  if (rank < 1 || iree_hal_buffer_view_shape_dim(batched_view, 0) !=
+                      (iree_hal_dim_t)batch_size) {
+    return iree_make_status(
+        IREE_STATUS_FAILED_PRECONDITION,
+        "batched function results must have a leading batch dimension "
+        "matching the batch size %" PRIdim,
+        batch_size);
+  }
+  iree_hal_dim_t* shape =
+      (iree_hal_dim_t*)iree_alloca(rank * sizeof(iree_hal_dim_t));
+  memcpy(shape, iree_hal_buffer_view_shape_dims(batched_view),
+         rank * sizeof(iree_hal_dim_t));
+  iree_device_size_t row_length =
+      iree_hal_buffer_view_byte_length(batched_view) / batch_size;
+
+  iree_device_size_t offset = 0;
+  for (iree_runtime_batcher_request_t* request = batch; request;
+       request = request->next) {
+    // Each request gets a view into the batched result; this avoids copies
+    // but keeps the whole batched result live until all requests release
+    // their outputs.
+    iree_device_size_t length = row_length * request->batch_size;
+    iree_hal_buffer_t* buffer = NULL;
+    IREE_RETURN_IF_ERROR(iree_hal_buffer_subspan(
+        iree_hal_buffer_view_buffer(batched_view), offset, length, &buffer));
+    shape[0] = request->batch_size;
+    iree_hal_buffer_view_t* view = NULL;
+    iree_status_t status = iree_hal_buffer_view_create(
+        buffer, rank, shape, iree_hal_buffer_view_element_type(batched_view),
+        iree_hal_buffer_view_encoding_type(batched_view),
+        batcher->host_allocator, &view);
+    iree_hal_buffer_release(buffer);
+    IREE_RETURN_IF_ERROR(status);
+    iree_vm_ref_t value = iree_hal_buffer_view_move_ref(view);
+    IREE_RETURN_IF_ERROR(iree_vm_list_push_ref_move(request->outputs, &value));
+    offset += length;
+  }
+  return iree_ok_status();
+}
+
+// Executes the |batch| list of compatible requests with a combined leading
+// dimension of |batch_size| and completes each request.
+static void iree_runtime_batcher_execute(iree_runtime_batcher_t* batcher,
+                                         iree_runtime_batcher_request_t* batch,
+                                         iree_hal_dim_t batch_size) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)batch_size);
+
+  iree_status_t status = iree_ok_status();
+  if (!batch->next) {
+    // Single request; call directly without gathering/scattering.
+    status = iree_runtime_session_call(batcher->session, &batcher->function,
+                                       batch->inputs, batch->outputs);
+  } else {
+    iree_vm_list_clear(batcher->batch_inputs);
+    iree_vm_list_clear(batcher->batch_outputs);
+    iree_host_size_t input_count = iree_vm_list_size(batch->inputs);
+    for (iree_host_size_t i = 0; i < input_count && iree_status_is_ok(status);
+         ++i) {
+      iree_hal_buffer_view_t* view = NULL;
+      status = iree_runtime_batcher_gather_input(batcher, batch, batch_size, i,
+                                                 &view);
+      if (iree_status_is_ok(status)) {
+        iree_vm_ref_t value = iree_hal_buffer_view_move_ref(view);
+        status = iree_vm_list_push_ref_move(batcher->batch_inputs, &value);
+      }
+    }
+    if (iree_status_is_ok(status)) {
+      status = iree_runtime_session_call(batcher->session, &batcher->function,
+                                         batcher->batch_inputs,
+                                         batcher->batch_outputs);
+    }
+    iree_host_size_t output_count = iree_vm_list_size(batcher->batch_outputs);
+    for (iree_host_size_t i = 0; i < output_count && iree_status_is_ok(status);
+         ++i) {
+      iree_hal_buffer_view_t* view =
+          iree_vm_list_get_buffer_view_assign(batcher->batch_outputs, i);
+      if (!view) {
+        status = iree_make_status(
+            IREE_STATUS_FAILED_PRECONDITION,
+            "batched function result %" PRIhsz " is not a buffer view", i);
+        break;
+      }
+      status =
+          iree_runtime_batcher_scatter_output(batcher, batch, batch_size, view);
+    }
+    iree_vm_list_clear(batcher->batch_inputs);
+    iree_vm_list_clear(batcher->batch_outputs);
+  }
+
+  // Complete all requests in the batch.
+  iree_runtime_batcher_request_t* request = batch;
+  while (request) {
+    iree_runtime_batcher_request_t* next = request->next;
+    if (iree_status_is_ok(status)) {
+      iree_status_t signal_status =
+          iree_hal_fence_signal(request->signal_fence);
+      if (!iree_status_is_ok(signal_status)) {
+        iree_hal_fence_fail(request->signal_fence, signal_status);
+      }
+    } else {
+      iree_hal_fence_fail(request->signal_fence, iree_status_clone(status));
+    }
+    iree_runtime_batcher_request_free(batcher->host_allocator, request);
+    request = next;
+  }
+  iree_status_ignore(status);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+// Pops the next batch of compatible requests from the pending queue.
+// Must be called with the batcher mutex held and a non-empty queue.
+static iree_runtime_batcher_request_t* iree_runtime_batcher_pop_batch(
+    iree_runtime_batcher_t* batcher, iree_hal_dim_t* out_batch_size) {
+  iree_runtime_batcher_request_t* batch = batcher->head;
+  iree_runtime_batcher_request_t* last = batch;
+  iree_hal_dim_t batch_size = batch->batch_size;
+  while (last->next &&
+         batch_size + last->next->batch_size <=
+             (iree_hal_dim_t)batcher->options.max_batch_size &&
+         iree_runtime_batcher_requests_compatible(batch, last->next)) {
+    last = last->next;
+    batch_size += last->batch_size;
+  }
+  batcher->head = last->next;
+  if (!batcher->head) batcher->tail = NULL;
+  last->next = NULL;
+  batcher->pending_size -= batch_size;
+  *out_batch_size = batch_size;
+  return batch;
+}
+
+static int iree_runtime_batcher_main(iree_runtime_batcher_t* batcher) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  for (;;) {
+    iree_slim_mutex_lock(&batcher->mutex);
+    if (!batcher->head) {
+      if (batcher->is_exiting) {
+        iree_slim_mutex_unlock(&batcher->mutex);
+        break;
+      }
+    } else {
+      // Issue the batch once it is full, its oldest request has waited long
+      // enough, or we are draining the queue on exit.
+      iree_time_t deadline_ns =
+          batcher->head->enqueue_time_ns + batcher->options.max_latency;
+      if (batcher->is_exiting ||
+          batcher->pending_size >= batcher->options.max_batch_size ||
+          iree_time_now() >= deadline_ns) {
+        iree_hal_dim_t batch_size = 0;
+        iree_runtime_batcher_request_t* batch =
+            iree_runtime_batcher_pop_batch(batcher, &batch_size);
+        iree_slim_mutex_unlock(&batcher->mutex);
+        iree_runtime_batcher_execute(batcher, batch, batch_size);
+        continue;
+      }
+    }
+
+    // Wait for more requests or the oldest request deadline. The wait is
+    // prepared while holding the lock so that no posts are missed.
+    iree_time_t deadline_ns =
+        batcher->head
+            ? batcher->head->enqueue_time_ns + batcher->options.max_latency
+            : IREE_TIME_INFINITE_FUTURE;
+    iree_wait_token_t wait_token =
+        iree_notification_prepare_wait(&batcher->notification);
+    iree_slim_mutex_unlock(&batcher->mutex);
+    iree_notification_commit_wait(&batcher->notification, wait_token,
+                                  IREE_DURATION_ZERO, deadline_ns);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  iree_atomic_store_int32(&batcher->has_exited, 1, iree_memory_order_release);
+  iree_notification_post(&batcher->notification, IREE_ALL_WAITERS);
+  return 0;
+}
+
+static bool iree_runtime_batcher_has_exited(iree_runtime_batcher_t* batcher) {
+  return iree_atomic_load_int32(&batcher->has_exited,
+                                iree_memory_order_acquire) == 1;
+}
+
+IREE_API_EXPORT iree_status_t iree_runtime_batcher_create(
+    iree_runtime_session_t* session, iree_vm_function_t function,
+    const iree_runtime_batcher_options_t* options,
+    iree_allocator_t host_allocator, iree_runtime_batcher_t** out_batcher) {
+  IREE_ASSERT_ARGUMENT(session);
+  IREE_ASSERT_ARGUMENT(options);
+  IREE_ASSERT_ARGUMENT(out_batcher);
+  *out_batcher = NULL;
+  if (!options->max_batch_size) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "max batch size must be non-zero");
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_runtime_batcher_t* batcher = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, sizeof(*batcher),
+                                (void**)&batcher));
+  iree_atomic_ref_count_init(&batcher->ref_count);
+  batcher->host_allocator = host_allocator;
+  batcher->session = session;
+  iree_runtime_session_retain(batcher->session);
+  batcher->function = function;
+  batcher->options = *options;
+  iree_notification_initialize(&batcher->notification);
+  iree_slim_mutex_initialize(&batcher->mutex);
+  iree_atomic_store_int32(&batcher->has_exited, 0, iree_memory_order_relaxed);
+
+  iree_status_t status =
+      iree_vm_list_create(iree_vm_make_undefined_type_def(), 8, host_allocator,
+                          &batcher->batch_inputs);
+  if (iree_status_is_ok(status)) {
+    status = iree_vm_list_create(iree_vm_make_undefined_type_def(), 8,
+                                 host_allocator, &batcher->batch_outputs);
+  }
+
+  if (iree_status_is_ok(status)) {
+    iree_thread_create_params_t thread_params;
+    memset(&thread_params, 0, sizeof(thread_params));
+    thread_params.name = iree_make_cstring_view("iree-batcher");
+    thread_params.priority_class = IREE_THREAD_PRIORITY_CLASS_NORMAL;
+    status = iree_thread_create((iree_thread_entry_t)iree_runtime_batcher_main,
+                                batcher, thread_params, host_allocator,
+                                &batcher->thread);
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_batcher = batcher;
+  } else {
+    iree_runtime_batcher_release(batcher);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static void iree_runtime_batcher_destroy(iree_runtime_batcher_t* batcher) {
+  IREE_ASSERT_ARGUMENT(batcher);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Request the thread exit and join it; it will drain pending requests first.
+  // Releasing the thread only joins it once it has started so we wait for it to
+  // exit first.
+  if (batcher->thread) {
+    iree_slim_mutex_lock(&batcher->mutex);
+    batcher->is_exiting = true;
+    iree_slim_mutex_unlock(&batcher->mutex);
+    iree_notification_post(&batcher->notification, IREE_ALL_WAITERS);
+    iree_notification_await(
+        &batcher->notification,
+        (iree_condition_fn_t)iree_runtime_batcher_has_exited, batcher,
+        iree_infinite_timeout());
+    iree_thread_release(batcher->thread);
+  }
+
+  iree_vm_list_release(batcher->batch_inputs);
+  iree_vm_list_release(batcher->batch_outputs);
+  iree_slim_mutex_deinitialize(&batcher->mutex);
+  iree_notification_deinitialize(&batcher->notification);
+  iree_runtime_session_release(batcher->session);
+
+  iree_allocator_free(batcher->host_allocator, batcher);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+IREE_API_EXPORT void iree_runtime_batcher_retain(
+    iree_runtime_batcher_t* batcher) {
+  if (batcher) {
+    iree_atomic_ref_count_inc(&batcher->ref_count);
+  }
+}
+
+IREE_API_EXPORT void iree_runtime_batcher_release(
+    iree_runtime_batcher_t* batcher) {
+  if (batcher && iree_atomic_ref_count_dec(&batcher->ref_count) == 1) {
+    iree_runtime_batcher_destroy(batcher);
+  }
+}
+
+IREE_API_EXPORT iree_status_t iree_runtime_batcher_call(
+    iree_runtime_batcher_t* batcher, iree_vm_list_t* inputs,
+    iree_vm_list_t* outputs, iree_hal_fence_t* signal_fence) {
+  IREE_ASSERT_ARGUMENT(batcher);
+  IREE_ASSERT_ARGUMENT(inputs);
+  IREE_ASSERT_ARGUMENT(outputs);
+  IREE_ASSERT_ARGUMENT(signal_fence);
+
+  iree_hal_dim_t batch_size = 0;
+  IREE_RETURN_IF_ERROR(
+      iree_runtime_batcher_query_batch_size(inputs, &batch_size));
+  if (batch_size > (iree_hal_dim_t)batcher->options.max_batch_size) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "request batch size %" PRIdim
+                            " exceeds the maximum batch size %" PRIhsz,
+                            batch_size, batcher->options.max_batch_size);
+  }
+
+  iree_runtime_batcher_request_t* request = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      batcher->host_allocator, sizeof(*request), (void**)&request));
+  request->next = NULL;
+  request->inputs = inputs;
+  iree_vm_list_retain(request->inputs);
+  request->outputs = outputs;
+  iree_vm_list_retain(request->outputs);
+  request->signal_fence = signal_fence;
+  iree_hal_fence_retain(request->signal_fence);
+  request->batch_size = batch_size;
+  request->enqueue_time_ns = iree_time_now();
+
+  // Only wake the batcher thread when it has something new to do: a deadline
+  // to track for a new batch or a batch that has filled up.
+  iree_slim_mutex_lock(&batcher->mutex);
+  bool was_empty = batcher->head == NULL;
+  if (batcher->tail) {
+    batcher->tail->next = request;
+  } else {
+    batcher->head = request;
+  }
+  batcher->tail = request;
+  batcher->pending_size += batch_size;
+  bool is_full = batcher->pending_size >= batcher->options.max_batch_size;
+  iree_slim_mutex_unlock(&batcher->mutex);
+  if (was_empty || is_full) {
+    iree_notification_post(&batcher->notification, IREE_ALL_WAITERS);
+  }
+
+  return iree_ok_status();
+}
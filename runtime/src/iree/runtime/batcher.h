@@ -0,0 +1,101 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_RUNTIME_BATCHER_H_
+#define IREE_RUNTIME_BATCHER_H_
+
+#include <stdint.h>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/vm/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+typedef struct iree_runtime_session_t iree_runtime_session_t;
+
+//===----------------------------------------------------------------------===//
+// iree_runtime_batcher_options_t
+//===----------------------------------------------------------------------===//
+
+// Options controlling how requests are coalesced into batches.
+typedef struct iree_runtime_batcher_options_t {
+  // Maximum batch size of a single batched call, measured as the sum of the
+  // leading dimension of the inputs of all coalesced requests. Requests larger
+  // than this are rejected.
+  iree_host_size_t max_batch_size;
+
+  // Maximum duration a request may wait for other requests to join its batch.
+  // A batch is issued as soon as it is full or once its oldest request has
+  // waited this long. A zero latency disables coalescing of requests that do
+  // not arrive while a prior batch is executing.
+  iree_duration_t max_latency;
+} iree_runtime_batcher_options_t;
+
+// Initializes |out_options| to its default values.
+IREE_API_EXPORT void iree_runtime_batcher_options_initialize(
+    iree_runtime_batcher_options_t* out_options);
+
+//===----------------------------------------------------------------------===//
+// iree_runtime_batcher_t
+//===----------------------------------------------------------------------===//
+
+// Coalesces independent calls to a dynamically batched function.
+//
+// The batched function must take and return only buffer views with a dynamic
+// leading batch dimension. Requests are issued with inputs that have the same
+// rank and trailing dimensions as the function expects and a leading dimension
+// holding the number of items in the request (usually 1). Pending requests are
+// concatenated along the leading dimension into a single call and the results
+// are scattered back to each request as views of the batched results.
+//
+// Batches are executed in order on a dedicated thread that owns the session.
+// Requests only join a batch with the requests immediately before them that
+// have compatible input shapes and element types; incompatible requests start
+// a new batch.
+//
+// Thread-safe; requests may be issued concurrently from any number of threads.
+typedef struct iree_runtime_batcher_t iree_runtime_batcher_t;
+
+// Creates a new batcher that issues calls to |function| in |session|.
+// The session is retained by the batcher and must not be used by the caller to
+// execute calls for the lifetime of the batcher.
+//
+// |host_allocator| will be used to allocate the batcher and per-request
+// bookkeeping. |out_batcher| must be released by the caller.
+IREE_API_EXPORT iree_status_t iree_runtime_batcher_create(
+    iree_runtime_session_t* session, iree_vm_function_t function,
+    const iree_runtime_batcher_options_t* options,
+    iree_allocator_t host_allocator, iree_runtime_batcher_t** out_batcher);
+
+// Retains the given |batcher| for the caller.
+IREE_API_EXPORT void iree_runtime_batcher_retain(
+    iree_runtime_batcher_t* batcher);
+
+// Releases the given |batcher| from the caller.
+// Pending requests are executed before the batcher is destroyed.
+IREE_API_EXPORT void iree_runtime_batcher_release(
+    iree_runtime_batcher_t* batcher);
+
+// Enqueues a call with the buffer views in |inputs| that will be batched with
+// other pending calls. All inputs must have the same leading dimension.
+//
+// Once the batch completes |outputs| is populated with one buffer view per
+// function result sliced to this request's portion of the batch and then
+// |signal_fence| is signaled. If the batch fails |signal_fence| is failed with
+// the error instead. Both lists are retained until the request completes and
+// must not be modified by the caller until then.
+IREE_API_EXPORT iree_status_t iree_runtime_batcher_call(
+    iree_runtime_batcher_t* batcher, iree_vm_list_t* inputs,
+    iree_vm_list_t* outputs, iree_hal_fence_t* signal_fence);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_RUNTIME_BATCHER_H_
@@ -0,0 +1,452 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/runtime/batcher.h"
+
+#include <cstring>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/hal/drivers/local_sync/sync_device.h"
+#include "iree/modules/hal/types.h"
+#include "iree/runtime/instance.h"
+#include "iree/runtime/session.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+#include "iree/vm/api.h"
+
+namespace iree {
+namespace {
+
+using ::iree::testing::status::StatusIs;
+using ::testing::ElementsAre;
+using ::testing::Pair;
+
+//===----------------------------------------------------------------------===//
+// batch_module
+//===----------------------------------------------------------------------===//
+// A native module exporting a batched function that doubles each i32 element
+// of a [batch, N] input. The shape of every call is recorded so that tests can
+// check how requests were coalesced. Negative inputs fail the call.
+
+typedef struct batch_module_t {
+  iree_allocator_t allocator;
+  iree_hal_device_t* device;
+  // (batch size, row length) of each call in the order they were issued.
+  std::mutex mutex;
+  std::vector<std::pair<iree_hal_dim_t, iree_hal_dim_t>> calls;
+} batch_module_t;
+
+static void IREE_API_PTR batch_module_destroy(void* self) {
+  batch_module_t* module = (batch_module_t*)self;
+  iree_allocator_t allocator = module->allocator;
+  module->~batch_module_t();
+  iree_allocator_free(allocator, module);
+}
+
+typedef iree_status_t (*call_r_r_t)(iree_vm_stack_t* stack, void* module_ptr,
+                                   void* module_state, iree_vm_ref_t* arg0,
+                                   iree_vm_ref_t* out_ret0);
+
+static iree_status_t call_shim_r_r(iree_vm_stack_t* stack,
+                                   iree_vm_native_function_flags_t flags,
+                                   iree_byte_span_t args_storage,
+                                   iree_byte_span_t rets_storage,
+                                   call_r_r_t target_fn, void* module,
+                                   void* module_state) {
+  iree_vm_ref_t* args = (iree_vm_ref_t*)args_storage.data;
+  iree_vm_ref_t* results = (iree_vm_ref_t*)rets_storage.data;
+  iree_status_t status =
+      target_fn(stack, module, module_state, &args[0], &results[0]);
+  // Arguments are consumed by the callee.
+  iree_vm_ref_release(&args[0]);
+  return status;
+}
+
+// vm.export @double(%input : !hal.buffer_view) -> !hal.buffer_view
+static iree_status_t batch_module_double(iree_vm_stack_t* stack,
+                                         batch_module_t* module,
+                                         void* module_state,
+                                         iree_vm_ref_t* arg0,
+                                         iree_vm_ref_t* out_ret0) {
+  iree_hal_buffer_view_t* input = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_buffer_view_check_deref(*arg0, &input));
+  if (iree_hal_buffer_view_shape_rank(input) != 2 ||
+      iree_hal_buffer_view_element_type(input) !=
+          IREE_HAL_ELEMENT_TYPE_INT_32) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "expected a 2D i32 input");
+  }
+  iree_hal_dim_t batch_size = iree_hal_buffer_view_shape_dim(input, 0);
+  iree_hal_dim_t row_length = iree_hal_buffer_view_shape_dim(input, 1);
+  {
+    std::lock_guard<std::mutex> lock(module->mutex);
+    module->calls.emplace_back(batch_size, row_length);
+  }
+
+  std::vector<int32_t> values(batch_size * row_length);
+  IREE_RETURN_IF_ERROR(iree_hal_device_transfer_d2h(
+      module->device, iree_hal_buffer_view_buffer(input), 0, values.data(),
+      values.size() * sizeof(int32_t), IREE_HAL_TRANSFER_BUFFER_FLAG_DEFAULT,
+      iree_infinite_timeout()));
+  for (auto& value : values) {
+    if (value < 0) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "negative input %d", value);
+    }
+    value *= 2;
+  }
+
+  iree_hal_buffer_params_t params;
+  memset(&params, 0, sizeof(params));
+  params.type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL;
+  params.usage = IREE_HAL_BUFFER_USAGE_DEFAULT;
+  iree_hal_buffer_view_t* output = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_buffer_view_allocate_buffer(
+      iree_hal_device_allocator(module->device),
+      iree_hal_buffer_view_shape_rank(input),
+      iree_hal_buffer_view_shape_dims(input), IREE_HAL_ELEMENT_TYPE_INT_32,
+      IREE_HAL_ENCODING_TYPE_DENSE_ROW_MAJOR, params,
+      iree_make_const_byte_span(values.data(),
+                                values.size() * sizeof(int32_t)),
+      &output));
+  *out_ret0 = iree_hal_buffer_view_move_ref(output);
+  return iree_ok_status();
+}
+
+static const iree_vm_native_function_ptr_t batch_module_funcs_[] = {
+    {(iree_vm_native_function_shim_t)call_shim_r_r,
+     (iree_vm_native_function_target_t)batch_module_double},
+};
+static const iree_vm_native_export_descriptor_t batch_module_exports_[] = {
+    {iree_make_cstring_view("double"), iree_make_cstring_view("0r_r"), 0,
+     NULL},
+};
+static_assert(IREE_ARRAYSIZE(batch_module_funcs_) ==
+                  IREE_ARRAYSIZE(batch_module_exports_),
+              "function pointer table must be 1:1 with exports");
+static const iree_vm_native_module_descriptor_t batch_module_descriptor_ = {
+    /*name=*/iree_make_cstring_view("batch"),
+    /*version=*/0,
+    /*attr_count=*/0,
+    /*attrs=*/NULL,
+    /*dependency_count=*/0,
+    /*dependencies=*/NULL,
+    /*import_count=*/0,
+    /*imports=*/NULL,
+    /*export_count=*/IREE_ARRAYSIZE(batch_module_exports_),
+    /*exports=*/batch_module_exports_,
+    /*function_count=*/IREE_ARRAYSIZE(batch_module_funcs_),
+    /*functions=*/batch_module_funcs_,
+};
+
+static iree_status_t batch_module_create(iree_vm_instance_t* instance,
+                                         iree_hal_device_t* device,
+                                         iree_allocator_t allocator,
+                                         iree_vm_module_t** out_module,
+                                         batch_module_t** out_self) {
+  batch_module_t* module = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_allocator_malloc(allocator, sizeof(*module), (void**)&module));
+  new (module) batch_module_t();
+  module->allocator = allocator;
+  module->device = device;
+
+  iree_vm_module_t interface;
+  iree_status_t status = iree_vm_module_initialize(&interface, module);
+  if (!iree_status_is_ok(status)) {
+    batch_module_destroy(module);
+    return status;
+  }
+  interface.destroy = batch_module_destroy;
+  *out_self = module;
+  return iree_vm_native_module_create(&interface, &batch_module_descriptor_,
+                                      instance, allocator, out_module);
+}
+
+//===----------------------------------------------------------------------===//
+// iree_runtime_batcher_t
+//===----------------------------------------------------------------------===//
+
+// Latency long enough that batches are only issued when full or when the
+// batcher is released.
+static const iree_duration_t kNeverFlush = 3600 * 1000000000ll;
+
+// A single batcher call and the state needed to check its completion.
+struct Request {
+  vm::ref<iree_vm_list_t> inputs;
+  vm::ref<iree_vm_list_t> outputs;
+  vm::ref<iree_hal_semaphore_t> semaphore;
+  vm::ref<iree_hal_fence_t> fence;
+};
+
+class BatcherTest : public ::testing::Test {
+ protected:
+  virtual void SetUp() {
+    iree_allocator_t host_allocator = iree_allocator_system();
+
+    iree_runtime_instance_options_t instance_options;
+    iree_runtime_instance_options_initialize(&instance_options);
+    IREE_CHECK_OK(iree_runtime_instance_create(&instance_options,
+                                               host_allocator, &instance_));
+
+    iree_hal_allocator_t* device_allocator = nullptr;
+    IREE_CHECK_OK(iree_hal_allocator_create_heap(
+        iree_make_cstring_view("local"), host_allocator, host_allocator,
+        &device_allocator));
+    iree_hal_sync_device_params_t device_params;
+    iree_hal_sync_device_params_initialize(&device_params);
+    IREE_CHECK_OK(iree_hal_sync_device_create(
+        iree_make_cstring_view("local-sync"), &device_params,
+        /*loader_count=*/0, /*loaders=*/nullptr, device_allocator,
+        host_allocator, &device_));
+    iree_hal_allocator_release(device_allocator);
+
+    iree_runtime_session_options_t session_options;
+    iree_runtime_session_options_initialize(&session_options);
+    IREE_CHECK_OK(iree_runtime_session_create_with_device(
+        instance_, &session_options, device_, host_allocator, &session_));
+
+    iree_vm_module_t* module = nullptr;
+    IREE_CHECK_OK(batch_module_create(
+        iree_runtime_instance_vm_instance(instance_), device_, host_allocator,
+        &module, &batch_module_));
+    IREE_CHECK_OK(iree_runtime_session_append_module(session_, module));
+    iree_vm_module_release(module);
+    IREE_CHECK_OK(iree_runtime_session_lookup_function(
+        session_, iree_make_cstring_view("batch.double"), &function_));
+  }
+
+  virtual void TearDown() {
+    iree_runtime_session_release(session_);
+    iree_hal_device_release(device_);
+    iree_runtime_instance_release(instance_);
+  }
+
+  iree_runtime_batcher_t* CreateBatcher(iree_host_size_t max_batch_size,
+                                        iree_duration_t max_latency) {
+    iree_runtime_batcher_options_t options;
+    iree_runtime_batcher_options_initialize(&options);
+    options.max_batch_size = max_batch_size;
+    options.max_latency = max_latency;
+    iree_runtime_batcher_t* batcher = nullptr;
+    IREE_CHECK_OK(iree_runtime_batcher_create(
+        session_, function_, &options, iree_allocator_system(), &batcher));
+    return batcher;
+  }
+
+  // Issues a call with a [rows.size(), row length] input holding |rows|.
+  Request Call(iree_runtime_batcher_t* batcher,
+               std::vector<std::vector<int32_t>> rows) {
+    Request request;
+    iree_hal_dim_t shape[2] = {(iree_hal_dim_t)rows.size(),
+                               (iree_hal_dim_t)rows[0].size()};
+    std::vector<int32_t> values;
+    for (auto& row : rows) values.insert(values.end(), row.begin(), row.end());
+    iree_hal_buffer_params_t params;
+    memset(&params, 0, sizeof(params));
+    params.type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL;
+    params.usage = IREE_HAL_BUFFER_USAGE_DEFAULT;
+    iree_hal_buffer_view_t* input = nullptr;
+    IREE_CHECK_OK(iree_hal_buffer_view_allocate_buffer(
+        iree_hal_device_allocator(device_), IREE_ARRAYSIZE(shape), shape,
+        IREE_HAL_ELEMENT_TYPE_INT_32, IREE_HAL_ENCODING_TYPE_DENSE_ROW_MAJOR,
+        params,
+        iree_make_const_byte_span(values.data(),
+                                  values.size() * sizeof(int32_t)),
+        &input));
+
+    IREE_CHECK_OK(iree_vm_list_create(iree_vm_make_undefined_type_def(), 1,
+                                      iree_allocator_system(),
+                                      &request.inputs));
+    iree_vm_ref_t input_ref = iree_hal_buffer_view_move_ref(input);
+    IREE_CHECK_OK(iree_vm_list_push_ref_move(request.inputs.get(), &input_ref));
+    IREE_CHECK_OK(iree_vm_list_create(iree_vm_make_undefined_type_def(), 1,
+                                      iree_allocator_system(),
+                                      &request.outputs));
+    IREE_CHECK_OK(iree_hal_semaphore_create(device_, 0, &request.semaphore));
+    IREE_CHECK_OK(iree_hal_fence_create_at(request.semaphore.get(), 1,
+                                           iree_allocator_system(),
+                                           &request.fence));
+    IREE_CHECK_OK(iree_runtime_batcher_call(batcher, request.inputs.get(),
+                                            request.outputs.get(),
+                                            request.fence.get()));
+    return request;
+  }
+
+  // Waits for |request| to complete and returns its status.
+  Status Wait(Request& request) {
+    iree_status_ignore(
+        iree_hal_fence_wait(request.fence.get(), iree_infinite_timeout()));
+    return iree_hal_fence_query(request.fence.get());
+  }
+
+  // Returns the rows of the completed |request| output.
+  StatusOr<std::vector<std::vector<int32_t>>> ReadOutput(Request& request) {
+    iree_hal_buffer_view_t* output =
+        iree_vm_list_get_buffer_view_assign(request.outputs.get(), 0);
+    if (!output || iree_hal_buffer_view_shape_rank(output) != 2) {
+      return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                              "expected a 2D output");
+    }
+    iree_hal_dim_t row_count = iree_hal_buffer_view_shape_dim(output, 0);
+    iree_hal_dim_t row_length = iree_hal_buffer_view_shape_dim(output, 1);
+    std::vector<int32_t> values(row_count * row_length);
+    IREE_RETURN_IF_ERROR(iree_hal_device_transfer_d2h(
+        device_, iree_hal_buffer_view_buffer(output), 0, values.data(),
+        values.size() * sizeof(int32_t), IREE_HAL_TRANSFER_BUFFER_FLAG_DEFAULT,
+        iree_infinite_timeout()));
+    std::vector<std::vector<int32_t>> rows;
+    for (iree_hal_dim_t i = 0; i < row_count; ++i) {
+      rows.emplace_back(values.begin() + i * row_length,
+                        values.begin() + (i + 1) * row_length);
+    }
+    return rows;
+  }
+
+  std::vector<std::pair<iree_hal_dim_t, iree_hal_dim_t>> calls() {
+    std::lock_guard<std::mutex> lock(batch_module_->mutex);
+    return batch_module_->calls;
+  }
+
+  iree_runtime_instance_t* instance_ = nullptr;
+  iree_hal_device_t* device_ = nullptr;
+  iree_runtime_session_t* session_ = nullptr;
+  batch_module_t* batch_module_ = nullptr;
+  iree_vm_function_t function_;
+};
+
+// Requests that fill a batch are coalesced into a single call and each gets
+// its own slice of the results.
+TEST_F(BatcherTest, CoalescesRequests) {
+  iree_runtime_batcher_t* batcher = CreateBatcher(4, kNeverFlush);
+  std::vector<Request> requests;
+  requests.push_back(Call(batcher, {{1, 2}}));
+  requests.push_back(Call(batcher, {{3, 4}, {5, 6}}));
+  requests.push_back(Call(batcher, {{7, 8}}));
+  for (auto& request : requests) IREE_ASSERT_OK(Wait(request));
+  EXPECT_THAT(calls(), ElementsAre(Pair(4, 2)));
+
+  IREE_ASSERT_OK_AND_ASSIGN(auto output0, ReadOutput(requests[0]));
+  EXPECT_EQ(output0, (std::vector<std::vector<int32_t>>{{2, 4}}));
+  IREE_ASSERT_OK_AND_ASSIGN(auto output1, ReadOutput(requests[1]));
+  EXPECT_EQ(output1, (std::vector<std::vector<int32_t>>{{6, 8}, {10, 12}}));
+  IREE_ASSERT_OK_AND_ASSIGN(auto output2, ReadOutput(requests[2]));
+  EXPECT_EQ(output2, (std::vector<std::vector<int32_t>>{{14, 16}}));
+
+  iree_runtime_batcher_release(batcher);
+}
+
+// Only adjacent requests with matching trailing shapes share a batch.
+TEST_F(BatcherTest, SplitsMismatchedShapes) {
+  iree_runtime_batcher_t* batcher = CreateBatcher(32, kNeverFlush);
+  std::vector<Request> requests;
+  requests.push_back(Call(batcher, {{1, 2}}));
+  requests.push_back(Call(batcher, {{3, 4}}));
+  requests.push_back(Call(batcher, {{5, 6, 7}}));
+  requests.push_back(Call(batcher, {{8, 9}}));
+
+  // Releasing flushes the pending requests in order.
+  iree_runtime_batcher_release(batcher);
+  for (auto& request : requests) IREE_ASSERT_OK(Wait(request));
+  EXPECT_THAT(calls(), ElementsAre(Pair(2, 2), Pair(1, 3), Pair(1, 2)));
+
+  IREE_ASSERT_OK_AND_ASSIGN(auto output1, ReadOutput(requests[1]));
+  EXPECT_EQ(output1, (std::vector<std::vector<int32_t>>{{6, 8}}));
+  IREE_ASSERT_OK_AND_ASSIGN(auto output2, ReadOutput(requests[2]));
+  EXPECT_EQ(output2, (std::vector<std::vector<int32_t>>{{10, 12, 14}}));
+  IREE_ASSERT_OK_AND_ASSIGN(auto output3, ReadOutput(requests[3]));
+  EXPECT_EQ(output3, (std::vector<std::vector<int32_t>>{{16, 18}}));
+}
+
+// Requests that do not fill a batch are issued once the oldest has waited for
+// the maximum latency.
+TEST_F(BatcherTest, FlushesOnDeadline) {
+  const iree_duration_t max_latency = 20 * 1000000ll;  // 20ms
+  iree_runtime_batcher_t* batcher = CreateBatcher(32, max_latency);
+  iree_time_t start_ns = iree_time_now();
+  Request request0 = Call(batcher, {{1}});
+  Request request1 = Call(batcher, {{2}});
+  IREE_ASSERT_OK(Wait(request0));
+  IREE_ASSERT_OK(Wait(request1));
+  EXPECT_GE(iree_time_now() - start_ns, max_latency);
+
+  IREE_ASSERT_OK_AND_ASSIGN(auto output0, ReadOutput(request0));
+  EXPECT_EQ(output0, (std::vector<std::vector<int32_t>>{{2}}));
+  IREE_ASSERT_OK_AND_ASSIGN(auto output1, ReadOutput(request1));
+  EXPECT_EQ(output1, (std::vector<std::vector<int32_t>>{{4}}));
+
+  iree_runtime_batcher_release(batcher);
+}
+
+// A failing batch fails the fence of every request in it while other batches
+// are unaffected.
+TEST_F(BatcherTest, PropagatesErrors) {
+  iree_runtime_batcher_t* batcher = CreateBatcher(3, kNeverFlush);
+  std::vector<Request> requests;
+  requests.push_back(Call(batcher, {{1}}));
+  requests.push_back(Call(batcher, {{-1}}));
+  requests.push_back(Call(batcher, {{2}}));
+  for (auto& request : requests) {
+    EXPECT_THAT(Wait(request), StatusIs(StatusCode::kInvalidArgument));
+  }
+
+  // Single requests are called directly and fail the same way.
+  Request failing_request = Call(batcher, {{-2}});
+  Request request = Call(batcher, {{3, 4}});
+  iree_runtime_batcher_release(batcher);
+  EXPECT_THAT(Wait(failing_request), StatusIs(StatusCode::kInvalidArgument));
+  IREE_ASSERT_OK(Wait(request));
+  IREE_ASSERT_OK_AND_ASSIGN(auto output, ReadOutput(request));
+  EXPECT_EQ(output, (std::vector<std::vector<int32_t>>{{6, 8}}));
+}
+
+// Malformed requests are rejected when issued and never reach the function.
+TEST_F(BatcherTest, RejectsInvalidRequests) {
+  iree_runtime_batcher_t* batcher = CreateBatcher(2, kNeverFlush);
+  Request request;
+  IREE_ASSERT_OK(iree_vm_list_create(iree_vm_make_undefined_type_def(), 1,
+                                     iree_allocator_system(),
+                                     &request.inputs));
+  IREE_ASSERT_OK(iree_vm_list_create(iree_vm_make_undefined_type_def(), 1,
+                                     iree_allocator_system(),
+                                     &request.outputs));
+  IREE_ASSERT_OK(iree_hal_semaphore_create(device_, 0, &request.semaphore));
+  IREE_ASSERT_OK(iree_hal_fence_create_at(request.semaphore.get(), 1,
+                                          iree_allocator_system(),
+                                          &request.fence));
+  EXPECT_THAT(Status(iree_runtime_batcher_call(batcher, request.inputs.get(),
+                                               request.outputs.get(),
+                                               request.fence.get())),
+              StatusIs(StatusCode::kInvalidArgument));
+
+  // Larger than the maximum batch size.
+  iree_hal_dim_t shape[2] = {3, 1};
+  iree_hal_buffer_params_t params;
+  memset(&params, 0, sizeof(params));
+  params.type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL;
+  params.usage = IREE_HAL_BUFFER_USAGE_DEFAULT;
+  iree_hal_buffer_view_t* input = nullptr;
+  IREE_ASSERT_OK(iree_hal_buffer_view_allocate_buffer(
+      iree_hal_device_allocator(device_), IREE_ARRAYSIZE(shape), shape,
+      IREE_HAL_ELEMENT_TYPE_INT_32, IREE_HAL_ENCODING_TYPE_DENSE_ROW_MAJOR,
+      params, iree_const_byte_span_empty(), &input));
+  iree_vm_ref_t input_ref = iree_hal_buffer_view_move_ref(input);
+  IREE_ASSERT_OK(iree_vm_list_push_ref_move(request.inputs.get(), &input_ref));
+  EXPECT_THAT(Status(iree_runtime_batcher_call(batcher, request.inputs.get(),
+                                               request.outputs.get(),
+                                               request.fence.get())),
+              StatusIs(StatusCode::kOutOfRange));
+
+  iree_runtime_batcher_release(batcher);
+  EXPECT_TRUE(calls().empty());
+}
+
+}  // namespace
+}  // namespace iree
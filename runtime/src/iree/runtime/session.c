@@ -11,6 +11,7 @@
 
 #include "iree/base/internal/atomics.h"
 #include "iree/base/internal/file_io.h"
+#include "iree/base/internal/synchronization.h"
 #include "iree/hal/api.h"
 #include "iree/modules/hal/module.h"
 #include "iree/runtime/instance.h"
@@ -116,6 +117,47 @@ IREE_API_EXPORT iree_status_t iree_runtime_session_create_with_device(
   return status;
 }
 
+IREE_API_EXPORT iree_status_t iree_runtime_session_fork(
+    iree_runtime_session_t* session, iree_allocator_t host_allocator,
+    iree_runtime_session_t** out_session) {
+  IREE_ASSERT_ARGUMENT(session);
+  IREE_ASSERT_ARGUMENT(out_session);
+  *out_session = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Allocate the session state.
+  iree_runtime_session_t* forked_session = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, sizeof(*forked_session),
+                                (void**)&forked_session));
+  forked_session->host_allocator = host_allocator;
+  iree_atomic_ref_count_init(&forked_session->ref_count);
+
+  forked_session->instance = session->instance;
+  iree_runtime_instance_retain(forked_session->instance);
+
+  // Fork the context; this shares the resources loaded by the modules in the
+  // parent session (executables, constants, etc) without reinitializing them.
+  iree_status_t status = iree_vm_context_fork(session->context, host_allocator,
+                                              &forked_session->context);
+
+  // The HAL module is always the first module registered with the session.
+  if (iree_status_is_ok(status)) {
+    status = iree_vm_context_resolve_module_state(
+        forked_session->context,
+        iree_vm_context_module_at(forked_session->context, 0),
+        &forked_session->hal_module_state);
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_session = forked_session;
+  } else {
+    iree_runtime_session_release(forked_session);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 static void iree_runtime_session_destroy(iree_runtime_session_t* session) {
   IREE_ASSERT_ARGUMENT(session);
   IREE_TRACE_ZONE_BEGIN(z0);
@@ -336,3 +378,155 @@ IREE_API_EXPORT iree_status_t iree_runtime_session_call_direct(
   IREE_TRACE_ZONE_END(z0);
   return status;
 }
+
+//===----------------------------------------------------------------------===//
+// iree_runtime_session_pool_t
+//===----------------------------------------------------------------------===//
+
+struct iree_runtime_session_pool_t {
+  iree_atomic_ref_count_t ref_count;
+
+  // Allocator used to allocate the pool and all sessions forked from it.
+  iree_allocator_t host_allocator;
+
+  // Fully initialized session all pooled sessions are forked from. Never used
+  // to execute calls so that every fork starts from the same state.
+  iree_runtime_session_t* template_session;
+
+  // Maximum number of warm sessions kept in the pool.
+  iree_host_size_t capacity;
+
+  // Guards the warm session list. Forking happens outside of the lock so that
+  // refilling does not block acquisition.
+  iree_slim_mutex_t mutex;
+
+  // Warm sessions available for acquisition, used as a stack.
+  iree_host_size_t count;
+  iree_runtime_session_t** sessions;
+};
+
+IREE_API_EXPORT iree_status_t iree_runtime_session_pool_create(
+    iree_runtime_session_t* template_session, iree_host_size_t capacity,
+    iree_allocator_t host_allocator, iree_runtime_session_pool_t** out_pool) {
+  IREE_ASSERT_ARGUMENT(template_session);
+  IREE_ASSERT_ARGUMENT(out_pool);
+  *out_pool = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)capacity);
+
+  // Allocate the pool with the session list stored inline.
+  iree_runtime_session_pool_t* pool = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(
+              host_allocator,
+              sizeof(*pool) + capacity * sizeof(iree_runtime_session_t*),
+              (void**)&pool));
+  iree_atomic_ref_count_init(&pool->ref_count);
+  pool->host_allocator = host_allocator;
+  pool->template_session = template_session;
+  iree_runtime_session_retain(pool->template_session);
+  pool->capacity = capacity;
+  iree_slim_mutex_initialize(&pool->mutex);
+  pool->count = 0;
+  pool->sessions = (iree_runtime_session_t**)((uint8_t*)pool + sizeof(*pool));
+
+  iree_status_t status = iree_runtime_session_pool_refill(pool);
+
+  if (iree_status_is_ok(status)) {
+    *out_pool = pool;
+  } else {
+    iree_runtime_session_pool_release(pool);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static void iree_runtime_session_pool_destroy(
+    iree_runtime_session_pool_t* pool) {
+  IREE_ASSERT_ARGUMENT(pool);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  for (iree_host_size_t i = 0; i < pool->count; ++i) {
+    iree_runtime_session_release(pool->sessions[i]);
+  }
+  iree_slim_mutex_deinitialize(&pool->mutex);
+  iree_runtime_session_release(pool->template_session);
+
+  iree_allocator_free(pool->host_allocator, pool);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+IREE_API_EXPORT void iree_runtime_session_pool_retain(
+    iree_runtime_session_pool_t* pool) {
+  if (pool) {
+    iree_atomic_ref_count_inc(&pool->ref_count);
+  }
+}
+
+IREE_API_EXPORT void iree_runtime_session_pool_release(
+    iree_runtime_session_pool_t* pool) {
+  if (pool && iree_atomic_ref_count_dec(&pool->ref_count) == 1) {
+    iree_runtime_session_pool_destroy(pool);
+  }
+}
+
+IREE_API_EXPORT iree_status_t iree_runtime_session_pool_acquire(
+    iree_runtime_session_pool_t* pool, iree_runtime_session_t** out_session) {
+  IREE_ASSERT_ARGUMENT(pool);
+  IREE_ASSERT_ARGUMENT(out_session);
+  *out_session = NULL;
+
+  // Fast path: pop a warm session.
+  iree_runtime_session_t* session = NULL;
+  iree_slim_mutex_lock(&pool->mutex);
+  if (pool->count > 0) {
+    session = pool->sessions[--pool->count];
+    pool->sessions[pool->count] = NULL;
+  }
+  iree_slim_mutex_unlock(&pool->mutex);
+  if (session) {
+    *out_session = session;
+    return iree_ok_status();
+  }
+
+  // Slow path: pool is exhausted and we need to fork a new session.
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_status_t status = iree_runtime_session_fork(
+      pool->template_session, pool->host_allocator, out_session);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+IREE_API_EXPORT iree_status_t
+iree_runtime_session_pool_refill(iree_runtime_session_pool_t* pool) {
+  IREE_ASSERT_ARGUMENT(pool);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_status_t status = iree_ok_status();
+  while (iree_status_is_ok(status)) {
+    iree_slim_mutex_lock(&pool->mutex);
+    bool is_full = pool->count >= pool->capacity;
+    iree_slim_mutex_unlock(&pool->mutex);
+    if (is_full) break;
+
+    // Fork outside of the lock so that concurrent acquisitions are not blocked.
+    iree_runtime_session_t* session = NULL;
+    status = iree_runtime_session_fork(pool->template_session,
+                                       pool->host_allocator, &session);
+    if (!iree_status_is_ok(status)) break;
+
+    iree_slim_mutex_lock(&pool->mutex);
+    if (pool->count < pool->capacity) {
+      pool->sessions[pool->count++] = session;
+      session = NULL;
+    }
+    iree_slim_mutex_unlock(&pool->mutex);
+
+    // Another thread filled the pool while we were forking.
+    iree_runtime_session_release(session);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
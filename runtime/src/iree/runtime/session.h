@@ -88,6 +88,23 @@ IREE_API_EXPORT iree_status_t iree_runtime_session_create_with_device(
     const iree_runtime_session_options_t* options, iree_hal_device_t* device,
     iree_allocator_t host_allocator, iree_runtime_session_t** out_session);
 
+// Creates a new session by forking |session| and all of its loaded modules.
+// The new session shares the instance and device of |session| and starts with
+// the module state it had at the time of the fork (see iree_vm_context_fork).
+// Resources created during module initialization (executables, constants,
+// etc) are shared with |session| while globals are independent. This is
+// significantly faster than creating a new session and loading the same
+// modules into it. No additional modules can be appended to the new session.
+// Fails with IREE_STATUS_FAILED_PRECONDITION if a module holds state that
+// cannot be shared, such as a mutable ref global set after initialization.
+//
+// |session| must not be executing calls while being forked.
+// |host_allocator| will be used to allocate the session and any associated
+// resources. |out_session| must be released by the caller.
+IREE_API_EXPORT iree_status_t iree_runtime_session_fork(
+    iree_runtime_session_t* session, iree_allocator_t host_allocator,
+    iree_runtime_session_t** out_session);
+
 // Retains the given |session| for the caller.
 IREE_API_EXPORT void iree_runtime_session_retain(
     iree_runtime_session_t* session);
@@ -228,6 +245,55 @@ IREE_API_EXPORT iree_status_t iree_runtime_session_call_by_name(
 IREE_API_EXPORT iree_status_t iree_runtime_session_call_direct(
     iree_runtime_session_t* session, const iree_vm_function_call_t call);
 
+//===----------------------------------------------------------------------===//
+// iree_runtime_session_pool_t
+//===----------------------------------------------------------------------===//
+
+// A pool of warm sessions forked from a fully initialized template session.
+// Useful when serving many independent users of the same program: the
+// template session is created and has its modules loaded once and each user
+// is handed their own session with isolated state without paying for module
+// initialization.
+//
+// Sessions acquired from the pool are owned by the caller and are not returned
+// to the pool as their state diverges from the template once used. The pool
+// keeps up to its capacity of sessions forked ahead of time so that acquiring
+// a session is only a list pop; iree_runtime_session_pool_refill can be used to
+// fork replacements off the critical path.
+//
+// Thread-safe; sessions may be acquired and the pool refilled concurrently
+// from multiple threads.
+typedef struct iree_runtime_session_pool_t iree_runtime_session_pool_t;
+
+// Creates a new session pool forking sessions from |template_session|.
+// The template is retained by the pool and must not be used to execute calls
+// for the lifetime of the pool. Up to |capacity| warm sessions are kept in the
+// pool and the pool is filled before returning. Fails if |template_session|
+// cannot be forked (see iree_runtime_session_fork).
+//
+// |host_allocator| will be used to allocate the pool and all sessions forked
+// from it. |out_pool| must be released by the caller.
+IREE_API_EXPORT iree_status_t iree_runtime_session_pool_create(
+    iree_runtime_session_t* template_session, iree_host_size_t capacity,
+    iree_allocator_t host_allocator, iree_runtime_session_pool_t** out_pool);
+
+// Retains the given |pool| for the caller.
+IREE_API_EXPORT void iree_runtime_session_pool_retain(
+    iree_runtime_session_pool_t* pool);
+
+// Releases the given |pool| from the caller.
+IREE_API_EXPORT void iree_runtime_session_pool_release(
+    iree_runtime_session_pool_t* pool);
+
+// Acquires a session from |pool|, forking a new one from the template if the
+// pool is empty. |out_session| must be released by the caller.
+IREE_API_EXPORT iree_status_t iree_runtime_session_pool_acquire(
+    iree_runtime_session_pool_t* pool, iree_runtime_session_t** out_session);
+
+// Forks new sessions into |pool| until it is at capacity.
+IREE_API_EXPORT iree_status_t
+iree_runtime_session_pool_refill(iree_runtime_session_pool_t* pool);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
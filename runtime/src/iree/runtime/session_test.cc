@@ -0,0 +1,362 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/runtime/session.h"
+
+#include <cstring>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/hal/drivers/local_sync/sync_device.h"
+#include "iree/runtime/instance.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+#include "iree/vm/api.h"
+
+namespace iree {
+namespace {
+
+//===----------------------------------------------------------------------===//
+// counter_module
+//===----------------------------------------------------------------------===//
+// A native module holding a per-context counter that can be forked. The shared
+// module counts how many times its state has been forked so that tests can
+// tell warm sessions popped from a pool apart from ones forked on demand.
+
+typedef struct counter_module_t {
+  iree_allocator_t allocator;
+  int fork_count;
+} counter_module_t;
+
+typedef struct counter_module_state_t {
+  iree_allocator_t allocator;
+  int32_t counter;
+} counter_module_state_t;
+
+static void IREE_API_PTR counter_module_destroy(void* self) {
+  counter_module_t* module = (counter_module_t*)self;
+  iree_allocator_free(module->allocator, module);
+}
+
+static iree_status_t IREE_API_PTR
+counter_module_alloc_state(void* self, iree_allocator_t allocator,
+                           iree_vm_module_state_t** out_module_state) {
+  counter_module_state_t* state = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_allocator_malloc(allocator, sizeof(*state), (void**)&state));
+  memset(state, 0, sizeof(*state));
+  state->allocator = allocator;
+  *out_module_state = (iree_vm_module_state_t*)state;
+  return iree_ok_status();
+}
+
+static void IREE_API_PTR
+counter_module_free_state(void* self, iree_vm_module_state_t* module_state) {
+  counter_module_state_t* state = (counter_module_state_t*)module_state;
+  iree_allocator_free(state->allocator, state);
+}
+
+static iree_status_t IREE_API_PTR
+counter_module_fork_state(void* self, iree_vm_module_state_t* parent_state,
+                          iree_allocator_t allocator,
+                          iree_vm_module_state_t** out_child_state) {
+  counter_module_t* module = (counter_module_t*)self;
+  counter_module_state_t* state = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_allocator_malloc(allocator, sizeof(*state), (void**)&state));
+  memcpy(state, parent_state, sizeof(*state));
+  state->allocator = allocator;
+  ++module->fork_count;
+  *out_child_state = (iree_vm_module_state_t*)state;
+  return iree_ok_status();
+}
+
+typedef iree_status_t (*call_i32_i32_t)(iree_vm_stack_t* stack,
+                                        void* module_ptr, void* module_state,
+                                        int32_t arg0, int32_t* out_ret0);
+
+static iree_status_t call_shim_i32_i32(iree_vm_stack_t* stack,
+                                       iree_vm_native_function_flags_t flags,
+                                       iree_byte_span_t args_storage,
+                                       iree_byte_span_t rets_storage,
+                                       call_i32_i32_t target_fn, void* module,
+                                       void* module_state) {
+  const int32_t* args = (const int32_t*)args_storage.data;
+  int32_t* results = (int32_t*)rets_storage.data;
+  return target_fn(stack, module, module_state, args[0], &results[0]);
+}
+
+// vm.export @add(%arg0 : i32) -> i32
+static iree_status_t counter_module_add(iree_vm_stack_t* stack,
+                                        counter_module_t* module,
+                                        counter_module_state_t* module_state,
+                                        int32_t arg0, int32_t* out_ret0) {
+  module_state->counter += arg0;
+  *out_ret0 = module_state->counter;
+  return iree_ok_status();
+}
+
+static const iree_vm_native_function_ptr_t counter_module_funcs_[] = {
+    {(iree_vm_native_function_shim_t)call_shim_i32_i32,
+     (iree_vm_native_function_target_t)counter_module_add},
+};
+static const iree_vm_native_export_descriptor_t counter_module_exports_[] = {
+    {iree_make_cstring_view("add"), iree_make_cstring_view("0i_i"), 0, NULL},
+};
+static_assert(IREE_ARRAYSIZE(counter_module_funcs_) ==
+                  IREE_ARRAYSIZE(counter_module_exports_),
+              "function pointer table must be 1:1 with exports");
+static const iree_vm_native_module_descriptor_t counter_module_descriptor_ = {
+    /*name=*/iree_make_cstring_view("counter"),
+    /*version=*/0,
+    /*attr_count=*/0,
+    /*attrs=*/NULL,
+    /*dependency_count=*/0,
+    /*dependencies=*/NULL,
+    /*import_count=*/0,
+    /*imports=*/NULL,
+    /*export_count=*/IREE_ARRAYSIZE(counter_module_exports_),
+    /*exports=*/counter_module_exports_,
+    /*function_count=*/IREE_ARRAYSIZE(counter_module_funcs_),
+    /*functions=*/counter_module_funcs_,
+};
+
+static iree_status_t counter_module_create(iree_vm_instance_t* instance,
+                                           iree_allocator_t allocator,
+                                           iree_vm_module_t** out_module,
+                                           counter_module_t** out_self) {
+  counter_module_t* module = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_allocator_malloc(allocator, sizeof(*module), (void**)&module));
+  memset(module, 0, sizeof(*module));
+  module->allocator = allocator;
+
+  iree_vm_module_t interface;
+  iree_status_t status = iree_vm_module_initialize(&interface, module);
+  if (!iree_status_is_ok(status)) {
+    iree_allocator_free(allocator, module);
+    return status;
+  }
+  interface.destroy = counter_module_destroy;
+  interface.alloc_state = counter_module_alloc_state;
+  interface.free_state = counter_module_free_state;
+  interface.fork_state = counter_module_fork_state;
+  *out_self = module;
+  return iree_vm_native_module_create(&interface, &counter_module_descriptor_,
+                                      instance, allocator, out_module);
+}
+
+//===----------------------------------------------------------------------===//
+// iree_runtime_session_pool_t
+//===----------------------------------------------------------------------===//
+
+// Creates a template session on a synchronous CPU device with the counter
+// module loaded and its counter advanced so that forks can be told apart from
+// freshly initialized sessions.
+class SessionPoolTest : public ::testing::Test {
+ protected:
+  virtual void SetUp() {
+    iree_allocator_t host_allocator = iree_allocator_system();
+
+    iree_runtime_instance_options_t instance_options;
+    iree_runtime_instance_options_initialize(&instance_options);
+    IREE_CHECK_OK(iree_runtime_instance_create(&instance_options,
+                                               host_allocator, &instance_));
+
+    iree_hal_allocator_t* device_allocator = nullptr;
+    IREE_CHECK_OK(iree_hal_allocator_create_heap(
+        iree_make_cstring_view("local"), host_allocator, host_allocator,
+        &device_allocator));
+    iree_hal_sync_device_params_t device_params;
+    iree_hal_sync_device_params_initialize(&device_params);
+    iree_hal_device_t* device = nullptr;
+    IREE_CHECK_OK(iree_hal_sync_device_create(
+        iree_make_cstring_view("local-sync"), &device_params,
+        /*loader_count=*/0, /*loaders=*/nullptr, device_allocator,
+        host_allocator, &device));
+    iree_hal_allocator_release(device_allocator);
+
+    iree_runtime_session_options_t session_options;
+    iree_runtime_session_options_initialize(&session_options);
+    IREE_CHECK_OK(iree_runtime_session_create_with_device(
+        instance_, &session_options, device, host_allocator,
+        &template_session_));
+    iree_hal_device_release(device);
+
+    iree_vm_module_t* module = nullptr;
+    IREE_CHECK_OK(counter_module_create(
+        iree_runtime_instance_vm_instance(instance_), host_allocator, &module,
+        &counter_module_));
+    IREE_CHECK_OK(iree_runtime_session_append_module(template_session_,
+                                                     module));
+    iree_vm_module_release(module);
+
+    IREE_CHECK_OK(Add(template_session_, 3).status());
+  }
+
+  virtual void TearDown() {
+    iree_runtime_session_release(template_session_);
+    iree_runtime_instance_release(instance_);
+  }
+
+  // Adds |value| to the session counter and returns the new value.
+  StatusOr<int32_t> Add(iree_runtime_session_t* session, int32_t value) {
+    vm::ref<iree_vm_list_t> input_list;
+    IREE_RETURN_IF_ERROR(iree_vm_list_create(iree_vm_make_undefined_type_def(),
+                                             1, iree_allocator_system(),
+                                             &input_list));
+    iree_vm_value_t arg0 = iree_vm_value_make_i32(value);
+    IREE_RETURN_IF_ERROR(iree_vm_list_push_value(input_list.get(), &arg0));
+    vm::ref<iree_vm_list_t> output_list;
+    IREE_RETURN_IF_ERROR(iree_vm_list_create(iree_vm_make_undefined_type_def(),
+                                             1, iree_allocator_system(),
+                                             &output_list));
+    IREE_RETURN_IF_ERROR(iree_runtime_session_call_by_name(
+        session, iree_make_cstring_view("counter.add"), input_list.get(),
+        output_list.get()));
+    iree_vm_value_t ret0;
+    IREE_RETURN_IF_ERROR(iree_vm_list_get_value(output_list.get(), 0, &ret0));
+    return ret0.i32;
+  }
+
+  iree_runtime_instance_t* instance_ = nullptr;
+  iree_runtime_session_t* template_session_ = nullptr;
+  counter_module_t* counter_module_ = nullptr;
+};
+
+// Sessions acquired from a filled pool are the warm forks made on creation and
+// start from the template state independently of each other.
+TEST_F(SessionPoolTest, AcquireWarm) {
+  iree_runtime_session_pool_t* pool = nullptr;
+  IREE_ASSERT_OK(iree_runtime_session_pool_create(
+      template_session_, /*capacity=*/2, iree_allocator_system(), &pool));
+  EXPECT_EQ(counter_module_->fork_count, 2);
+
+  iree_runtime_session_t* session0 = nullptr;
+  IREE_ASSERT_OK(iree_runtime_session_pool_acquire(pool, &session0));
+  iree_runtime_session_t* session1 = nullptr;
+  IREE_ASSERT_OK(iree_runtime_session_pool_acquire(pool, &session1));
+  EXPECT_NE(session0, session1);
+  EXPECT_NE(session0, template_session_);
+  EXPECT_EQ(counter_module_->fork_count, 2);
+
+  IREE_ASSERT_OK_AND_ASSIGN(int32_t v0, Add(session0, 1));
+  EXPECT_EQ(v0, 4);
+  IREE_ASSERT_OK_AND_ASSIGN(int32_t v1, Add(session1, 0));
+  EXPECT_EQ(v1, 3);
+
+  iree_runtime_session_release(session0);
+  iree_runtime_session_release(session1);
+  iree_runtime_session_pool_release(pool);
+
+  // The template is left untouched by the pool.
+  IREE_ASSERT_OK_AND_ASSIGN(int32_t v2, Add(template_session_, 0));
+  EXPECT_EQ(v2, 3);
+}
+
+// Acquiring from an empty pool forks a new session from the template.
+TEST_F(SessionPoolTest, ForkOnEmpty) {
+  iree_runtime_session_pool_t* pool = nullptr;
+  IREE_ASSERT_OK(iree_runtime_session_pool_create(
+      template_session_, /*capacity=*/1, iree_allocator_system(), &pool));
+  EXPECT_EQ(counter_module_->fork_count, 1);
+
+  iree_runtime_session_t* session0 = nullptr;
+  IREE_ASSERT_OK(iree_runtime_session_pool_acquire(pool, &session0));
+  EXPECT_EQ(counter_module_->fork_count, 1);
+  iree_runtime_session_t* session1 = nullptr;
+  IREE_ASSERT_OK(iree_runtime_session_pool_acquire(pool, &session1));
+  EXPECT_EQ(counter_module_->fork_count, 2);
+
+  IREE_ASSERT_OK_AND_ASSIGN(int32_t v0, Add(session0, 2));
+  EXPECT_EQ(v0, 5);
+  IREE_ASSERT_OK_AND_ASSIGN(int32_t v1, Add(session1, 0));
+  EXPECT_EQ(v1, 3);
+
+  iree_runtime_session_release(session0);
+  iree_runtime_session_release(session1);
+  iree_runtime_session_pool_release(pool);
+}
+
+// A pool with no capacity forks every session on demand.
+TEST_F(SessionPoolTest, ZeroCapacity) {
+  iree_runtime_session_pool_t* pool = nullptr;
+  IREE_ASSERT_OK(iree_runtime_session_pool_create(
+      template_session_, /*capacity=*/0, iree_allocator_system(), &pool));
+  EXPECT_EQ(counter_module_->fork_count, 0);
+
+  iree_runtime_session_t* session = nullptr;
+  IREE_ASSERT_OK(iree_runtime_session_pool_acquire(pool, &session));
+  EXPECT_EQ(counter_module_->fork_count, 1);
+  IREE_ASSERT_OK(iree_runtime_session_pool_refill(pool));
+  EXPECT_EQ(counter_module_->fork_count, 1);
+
+  iree_runtime_session_release(session);
+  iree_runtime_session_pool_release(pool);
+}
+
+// Refilling forks only the sessions needed to get back to capacity and the
+// refilled sessions are handed out without forking again.
+TEST_F(SessionPoolTest, Refill) {
+  iree_runtime_session_pool_t* pool = nullptr;
+  IREE_ASSERT_OK(iree_runtime_session_pool_create(
+      template_session_, /*capacity=*/2, iree_allocator_system(), &pool));
+  EXPECT_EQ(counter_module_->fork_count, 2);
+
+  // Refilling a full pool is a no-op.
+  IREE_ASSERT_OK(iree_runtime_session_pool_refill(pool));
+  EXPECT_EQ(counter_module_->fork_count, 2);
+
+  iree_runtime_session_t* session0 = nullptr;
+  IREE_ASSERT_OK(iree_runtime_session_pool_acquire(pool, &session0));
+  IREE_ASSERT_OK(iree_runtime_session_pool_refill(pool));
+  EXPECT_EQ(counter_module_->fork_count, 3);
+
+  iree_runtime_session_t* sessions[3] = {nullptr};
+  for (auto*& session : sessions) {
+    IREE_ASSERT_OK(iree_runtime_session_pool_acquire(pool, &session));
+  }
+  EXPECT_EQ(counter_module_->fork_count, 4);
+  IREE_ASSERT_OK(iree_runtime_session_pool_refill(pool));
+  EXPECT_EQ(counter_module_->fork_count, 6);
+
+  // Refilled sessions start from the template and not from any session that
+  // was acquired and used before the refill.
+  IREE_ASSERT_OK_AND_ASSIGN(int32_t v0, Add(session0, 10));
+  EXPECT_EQ(v0, 13);
+  iree_runtime_session_release(session0);
+  IREE_ASSERT_OK(iree_runtime_session_pool_acquire(pool, &session0));
+  EXPECT_EQ(counter_module_->fork_count, 6);
+  IREE_ASSERT_OK_AND_ASSIGN(int32_t v1, Add(session0, 0));
+  EXPECT_EQ(v1, 3);
+
+  iree_runtime_session_release(session0);
+  for (auto* session : sessions) {
+    iree_runtime_session_release(session);
+  }
+  iree_runtime_session_pool_release(pool);
+}
+
+// Acquired sessions are owned by the caller and outlive the pool while warm
+// sessions still in the pool are released with it.
+TEST_F(SessionPoolTest, Release) {
+  iree_runtime_session_pool_t* pool = nullptr;
+  IREE_ASSERT_OK(iree_runtime_session_pool_create(
+      template_session_, /*capacity=*/2, iree_allocator_system(), &pool));
+  iree_runtime_session_t* session = nullptr;
+  IREE_ASSERT_OK(iree_runtime_session_pool_acquire(pool, &session));
+
+  iree_runtime_session_pool_retain(pool);
+  iree_runtime_session_pool_release(pool);
+  iree_runtime_session_pool_release(pool);
+
+  IREE_ASSERT_OK_AND_ASSIGN(int32_t v0, Add(session, 1));
+  EXPECT_EQ(v0, 4);
+  iree_runtime_session_release(session);
+}
+
+}  // namespace
+}  // namespace iree
@@ -82,6 +82,14 @@ static inline iree_task_affinity_set_t iree_atomic_task_affinity_set_fetch_or(
   return iree_atomic_fetch_or_int64(set, value, order);
 }
 
+static inline bool iree_atomic_task_affinity_set_compare_exchange_weak(
+    iree_atomic_task_affinity_set_t* set, iree_task_affinity_set_t* expected,
+    iree_task_affinity_set_t desired, iree_memory_order_t order_succ,
+    iree_memory_order_t order_fail) {
+  return iree_atomic_compare_exchange_weak_int64(
+      set, (int64_t*)expected, (int64_t)desired, order_succ, order_fail);
+}
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
@@ -10,6 +10,9 @@
 #include <string.h>
 
 #include "iree/base/internal/flags.h"
+#include "iree/task/scope.h"
+#include "iree/task/submission.h"
+#include "iree/task/task.h"
 #include "iree/task/topology.h"
 
 //===----------------------------------------------------------------------===//
@@ -44,6 +47,13 @@ IREE_FLAG(
     "only use a specific maximum amount of local memory and the runtime must\n"
     "be configured to make at least that amount of local memory available.");
 
+IREE_FLAG(
+    bool, task_threadless, false,
+    "Creates executors without worker threads. Tasks only run on threads\n"
+    "waiting on the executor, such as those waiting on local-task device\n"
+    "semaphores, and the topology defines how many waiting threads may\n"
+    "cooperatively run tasks at a time.");
+
 iree_status_t iree_task_executor_options_initialize_from_flags(
     iree_task_executor_options_t* out_options) {
   IREE_ASSERT_ARGUMENT(out_options);
@@ -54,6 +64,9 @@ iree_status_t iree_task_executor_options_initialize_from_flags(
       (iree_host_size_t)FLAG_task_worker_stack_size;
   out_options->worker_local_memory_size =
       (iree_host_size_t)FLAG_task_worker_local_memory;
+  if (FLAG_task_threadless) {
+    out_options->flags |= IREE_TASK_EXECUTOR_FLAG_THREADLESS;
+  }
   return iree_ok_status();
 }
 
@@ -66,7 +79,8 @@ IREE_FLAG(
     "Comma-separated list of NUMA nodes that topologies will be defined for.\n"
     "Each node specified will be configured based on the other topology\n"
     "flags. 'all' can be used to indicate all available NUMA nodes and\n"
-    "'current' will inherit the node of the calling thread.");
+    "'current' will inherit the node of the calling thread. Drivers create\n"
+    "one queue per node and may expose each node as its own device.");
 
 IREE_FLAG(
     string, task_topology_mode, "physical_cores",
@@ -179,6 +193,28 @@ static void iree_task_flags_print_action_flag(iree_string_view_t flag_name,
   fprintf(file, "# --%.*s\n", (int)flag_name.size, flag_name.data);
 }
 
+// Prints a topology group |mask| as a list of group indices.
+static void iree_task_flags_print_group_mask(
+    const char* label, iree_task_topology_group_mask_t mask) {
+  fprintf(stdout, "%s", label);
+  if (mask == 0) {
+    fprintf(stdout, "(none)\n");
+  } else if (mask == IREE_TASK_TOPOLOGY_GROUP_MASK_ALL) {
+    fprintf(stdout, "(all/undefined)\n");
+  } else {
+    fprintf(stdout, "%d group(s): ", iree_math_count_ones_u64(mask));
+    for (iree_host_size_t ic = 0, jc = 0;
+         ic < IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT; ++ic) {
+      if ((mask >> ic) & 1) {
+        if (jc > 0) fprintf(stdout, ", ");
+        fprintf(stdout, "%" PRIhsz, ic);
+        ++jc;
+      }
+    }
+    fprintf(stdout, "\n");
+  }
+}
+
 static iree_status_t iree_task_flags_dump_task_topologies(
     iree_string_view_t flag_name, void* storage, iree_string_view_t value) {
   // Select which nodes in the machine we will be creating topologies for.
@@ -225,25 +261,12 @@ static iree_status_t iree_task_flags_dump_task_topologies(
         fprintf(stdout, "(unspecified)");
       }
       fprintf(stdout, "\n");
-      fprintf(stdout, "#  cache sharing: ");
-      if (group->constructive_sharing_mask == 0) {
-        fprintf(stdout, "(none)\n");
-      } else if (group->constructive_sharing_mask ==
-                 IREE_TASK_TOPOLOGY_GROUP_MASK_ALL) {
-        fprintf(stdout, "(all/undefined)\n");
-      } else {
-        fprintf(stdout, "%d group(s): ",
-                iree_math_count_ones_u64(group->constructive_sharing_mask));
-        for (iree_host_size_t ic = 0, jc = 0;
-             ic < IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT; ++ic) {
-          if ((group->constructive_sharing_mask >> ic) & 1) {
-            if (jc > 0) fprintf(stdout, ", ");
-            fprintf(stdout, "%" PRIhsz, ic);
-            ++jc;
-          }
-        }
-        fprintf(stdout, "\n");
-      }
+      iree_task_flags_print_group_mask("#  cache sharing: ",
+                                       group->constructive_sharing_mask);
+      iree_task_flags_print_group_mask("#    LLC sharing: ",
+                                       group->llc_sharing_mask);
+      iree_task_flags_print_group_mask("#   node sharing: ",
+                                       group->node_sharing_mask);
       fprintf(stdout, "#\n");
     }
   }
@@ -331,8 +354,14 @@ iree_status_t iree_task_executors_create_from_flags(
     // the executor creation will fail with 0 groups so the program won't get in
     // a weird state but it's probably not what a user would expect.
 
+    // Executors with pinned topologies are associated with their node so that
+    // users can place memory near the workers. Unpinned workers may run
+    // anywhere and get no node.
+    iree_task_executor_options_t node_options = options;
+    if (FLAG_task_topology_group_count == 0) node_options.node_id = node_id;
+
     // Create executor with the given topology.
-    status = iree_task_executor_create(options, &topology, host_allocator,
+    status = iree_task_executor_create(node_options, &topology, host_allocator,
                                        &executors[i]);
 
     // Executor has consumed the topology and it can be dropped now.
@@ -350,3 +379,78 @@ iree_status_t iree_task_executors_create_from_flags(
   }
   return status;
 }
+
+//===----------------------------------------------------------------------===//
+// Task system simple invocation utilities
+//===----------------------------------------------------------------------===//
+
+typedef struct iree_task_parallel_for_state_t {
+  iree_task_parallel_for_fn_t fn;
+  void* user_data;
+} iree_task_parallel_for_state_t;
+
+static iree_status_t iree_task_parallel_for_tile(
+    void* user_context, const iree_task_tile_context_t* tile_context,
+    iree_task_submission_t* pending_submission) {
+  iree_task_parallel_for_state_t* state =
+      (iree_task_parallel_for_state_t*)user_context;
+  return state->fn(state->user_data, tile_context->workgroup_xyz[0]);
+}
+
+iree_status_t iree_task_executor_parallel_for(iree_task_executor_t* executor,
+                                              iree_host_size_t count,
+                                              iree_task_parallel_for_fn_t fn,
+                                              void* user_data) {
+  IREE_ASSERT_ARGUMENT(executor);
+  IREE_ASSERT_ARGUMENT(fn);
+  if (count == 0) return iree_ok_status();
+  if (count > UINT32_MAX) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "parallel-for count %" PRIhsz
+                            " exceeds the maximum workgroup count",
+                            count);
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, count);
+
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("parallel_for"), &scope);
+
+  // One workgroup per index; workers steal tiles from each other so uneven
+  // invocation durations balance out.
+  iree_task_parallel_for_state_t state = {
+      .fn = fn,
+      .user_data = user_data,
+  };
+  const uint32_t workgroup_size[3] = {1, 1, 1};
+  const uint32_t workgroup_count[3] = {(uint32_t)count, 1, 1};
+  iree_task_dispatch_t dispatch;
+  iree_task_dispatch_initialize(
+      &scope,
+      iree_task_make_dispatch_closure(iree_task_parallel_for_tile, &state),
+      workgroup_size, workgroup_count, &dispatch);
+
+  // The fence retires when the dispatch completes and lets us wait on the
+  // scope becoming idle.
+  iree_task_fence_t* fence = NULL;
+  iree_status_t status =
+      iree_task_executor_acquire_fence(executor, &scope, &fence);
+  if (iree_status_is_ok(status)) {
+    iree_task_set_completion_task(&dispatch.header, &fence->header);
+    iree_task_submission_t submission;
+    iree_task_submission_initialize(&submission);
+    iree_task_submission_enqueue(&submission, &dispatch.header);
+    iree_task_executor_submit(executor, &submission);
+    // Donating lets threadless executors run the tiles on this thread;
+    // executors with workers will flush and wait as normal.
+    status = iree_task_executor_donate_caller(
+        executor, iree_task_scope_await_idle(&scope), iree_infinite_timeout());
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_task_scope_consume_status(&scope);
+  }
+
+  iree_task_scope_deinitialize(&scope);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
@@ -59,7 +59,25 @@ iree_status_t iree_task_executors_create_from_flags(
 
 // TODO(benvanik): simple IO completion event callback.
 // TODO(benvanik): simple async function call dispatch.
-// TODO(benvanik): simple parallel-for grid-style function call dispatch.
+
+// Function invoked for each index of a parallel-for.
+typedef iree_status_t(IREE_API_PTR* iree_task_parallel_for_fn_t)(
+    void* user_data, iree_host_size_t index);
+
+// Invokes |fn| once for each index in [0, |count|) on |executor| and blocks
+// the caller until all invocations have completed. Invocations may run
+// concurrently and in any order. If any invocation fails the remaining
+// invocations may be skipped and the failure is returned. The caller is
+// donated to the executor while waiting and threadless executors run the
+// invocations on the calling thread.
+//
+// This is intended for coarse-grained work such as loading or transforming
+// large data where each invocation takes at least tens of microseconds; finer
+// grained work should be batched by the caller.
+iree_status_t iree_task_executor_parallel_for(iree_task_executor_t* executor,
+                                              iree_host_size_t count,
+                                              iree_task_parallel_for_fn_t fn,
+                                              void* user_data);
 
 #ifdef __cplusplus
 }  // extern "C"
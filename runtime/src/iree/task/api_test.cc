@@ -0,0 +1,83 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/task/api.h"
+
+#include <atomic>
+#include <memory>
+
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace {
+
+using iree::Status;
+using iree::StatusCode;
+using iree::testing::status::StatusIs;
+
+// Parameterized on whether the executor is threadless. Threadless executors
+// only make progress while parallel_for donates the calling thread.
+class ParallelForTest : public ::testing::TestWithParam<bool> {
+ protected:
+  void SetUp() override {
+    iree_task_executor_options_t options;
+    iree_task_executor_options_initialize(&options);
+    if (GetParam()) options.flags |= IREE_TASK_EXECUTOR_FLAG_THREADLESS;
+    iree_task_topology_t topology;
+    iree_task_topology_initialize_from_group_count(4, &topology);
+    IREE_ASSERT_OK(iree_task_executor_create(
+        options, &topology, iree_allocator_system(), &executor_));
+    iree_task_topology_deinitialize(&topology);
+  }
+
+  void TearDown() override { iree_task_executor_release(executor_); }
+
+  iree_task_executor_t* executor_ = NULL;
+};
+
+TEST_P(ParallelForTest, Empty) {
+  IREE_ASSERT_OK(iree_task_executor_parallel_for(
+      executor_, 0,
+      +[](void* user_data, iree_host_size_t index) {
+        return iree_make_status(IREE_STATUS_INTERNAL, "unexpected call");
+      },
+      NULL));
+}
+
+TEST_P(ParallelForTest, VisitsEachIndexOnce) {
+  static constexpr iree_host_size_t kCount = 100;
+  std::unique_ptr<std::atomic<int>[]> visits(new std::atomic<int>[kCount]);
+  for (iree_host_size_t i = 0; i < kCount; ++i) visits[i] = 0;
+  IREE_ASSERT_OK(iree_task_executor_parallel_for(
+      executor_, kCount,
+      +[](void* user_data, iree_host_size_t index) {
+        auto* visits = reinterpret_cast<std::atomic<int>*>(user_data);
+        ++visits[index];
+        return iree_ok_status();
+      },
+      visits.get()));
+  for (iree_host_size_t i = 0; i < kCount; ++i) {
+    EXPECT_EQ(visits[i], 1) << "index " << i;
+  }
+}
+
+TEST_P(ParallelForTest, PropagatesFailure) {
+  EXPECT_THAT(Status(iree_task_executor_parallel_for(
+                  executor_, 16,
+                  +[](void* user_data, iree_host_size_t index) {
+                    return index == 7 ? iree_make_status(IREE_STATUS_DATA_LOSS)
+                                      : iree_ok_status();
+                  },
+                  NULL)),
+              StatusIs(StatusCode::kDataLoss));
+}
+
+INSTANTIATE_TEST_SUITE_P(ParallelForTests, ParallelForTest, ::testing::Bool(),
+                         [](const ::testing::TestParamInfo<bool>& info) {
+                           return info.param ? "Threadless" : "Threaded";
+                         });
+
+}  // namespace
@@ -27,6 +27,7 @@ static void iree_task_executor_destroy(iree_task_executor_t* executor);
 void iree_task_executor_options_initialize(
     iree_task_executor_options_t* out_options) {
   memset(out_options, 0, sizeof(*out_options));
+  out_options->node_id = IREE_TASK_TOPOLOGY_NODE_ID_ANY;
 }
 
 iree_status_t iree_task_executor_create(iree_task_executor_options_t options,
@@ -41,12 +42,28 @@ iree_status_t iree_task_executor_create(iree_task_executor_options_t options,
                             worker_count, IREE_TASK_EXECUTOR_MAX_WORKER_COUNT);
   }
 
-  // TODO(benvanik): support a threadless mode where we have one dummy worker
-  // that just holds the lists but is pumped from donate_caller.
+  // An empty topology has no threads to run tasks on and becomes a threadless
+  // executor with a single worker that holds the lists pumped by donate_caller.
+  iree_task_topology_group_t threadless_group;
   if (worker_count == 0) {
-    return iree_make_status(
-        IREE_STATUS_UNIMPLEMENTED,
-        "threadless donate-only executor mode not yet implemented");
+    options.flags |= IREE_TASK_EXECUTOR_FLAG_THREADLESS;
+    worker_count = 1;
+    iree_task_topology_group_initialize(/*group_index=*/0, &threadless_group);
+  }
+
+  if (!iree_task_thread_pool_is_null(&options.thread_pool)) {
+    if (!options.thread_pool.join || !options.thread_pool.park ||
+        !options.thread_pool.unpark) {
+      return iree_make_status(
+          IREE_STATUS_INVALID_ARGUMENT,
+          "external thread pools must implement spawn, join, park, and "
+          "unpark");
+    } else if (iree_all_bits_set(options.flags,
+                                 IREE_TASK_EXECUTOR_FLAG_THREADLESS)) {
+      return iree_make_status(
+          IREE_STATUS_INVALID_ARGUMENT,
+          "threadless executors cannot use an external thread pool");
+    }
   }
 
   IREE_TRACE_ZONE_BEGIN(z0);
@@ -77,10 +94,14 @@ iree_status_t iree_task_executor_create(iree_task_executor_options_t options,
   memset(executor, 0, executor_size);
   iree_atomic_ref_count_init(&executor->ref_count);
   executor->allocator = allocator;
+  executor->flags = options.flags;
+  executor->thread_pool = options.thread_pool;
   executor->scheduling_mode = options.scheduling_mode;
+  executor->node_id = options.node_id;
   executor->worker_spin_ns = options.worker_spin_ns;
   iree_atomic_task_slist_initialize(&executor->incoming_ready_slist);
   iree_slim_mutex_initialize(&executor->coordinator_mutex);
+  iree_notification_set_initialize(&executor->worker_wake_set);
 
   IREE_TRACE({
     static iree_atomic_int32_t executor_id = IREE_ATOMIC_VAR_INIT(0);
@@ -148,6 +169,7 @@ iree_status_t iree_task_executor_create(iree_task_executor_options_t options,
   if (iree_status_is_ok(status)) {
     executor->worker_base_index = options.worker_base_index;
     executor->worker_count = worker_count;
+    executor->worker_target_count = worker_count;
     executor->workers =
         (iree_task_worker_t*)((uint8_t*)executor + executor_base_size);
     uint8_t* worker_local_memory =
@@ -158,8 +180,12 @@ iree_status_t iree_task_executor_create(iree_task_executor_options_t options,
 
     for (iree_host_size_t i = 0; i < worker_count; ++i) {
       iree_task_worker_t* worker = &executor->workers[i];
+      const iree_task_topology_group_t* topology_group =
+          iree_task_topology_group_count(topology) > 0
+              ? iree_task_topology_get_group(topology, i)
+              : &threadless_group;
       status = iree_task_worker_initialize(
-          executor, i, iree_task_topology_get_group(topology, i),
+          executor, i, topology_group,
           options.worker_stack_size,
           iree_make_byte_span(worker_local_memory,
                               options.worker_local_memory_size),
@@ -168,6 +194,11 @@ iree_status_t iree_task_executor_create(iree_task_executor_options_t options,
       if (!iree_status_is_ok(status)) break;
     }
 
+    // Threadless workers only become live while claimed by a donating caller.
+    if (iree_all_bits_set(executor->flags,
+                          IREE_TASK_EXECUTOR_FLAG_THREADLESS)) {
+      worker_mask = 0;
+    }
     iree_atomic_task_affinity_set_store(&executor->worker_idle_mask,
                                         worker_mask, iree_memory_order_release);
     iree_atomic_task_affinity_set_store(&executor->worker_live_mask,
@@ -222,6 +253,7 @@ static void iree_task_executor_destroy(iree_task_executor_t* executor) {
 
   iree_event_pool_free(executor->event_pool);
   iree_slim_mutex_deinitialize(&executor->coordinator_mutex);
+  iree_notification_set_deinitialize(&executor->worker_wake_set);
   iree_atomic_task_slist_deinitialize(&executor->incoming_ready_slist);
   iree_task_pool_deinitialize(&executor->transient_task_pool);
   iree_allocator_free(executor->allocator, executor);
@@ -250,6 +282,16 @@ void iree_task_executor_trim(iree_task_executor_t* executor) {
   // iree_task_pool_trim(&executor->transient_task_pool);
 }
 
+iree_task_topology_node_id_t iree_task_executor_node_id(
+    iree_task_executor_t* executor) {
+  return executor->node_id;
+}
+
+iree_task_executor_flags_t iree_task_executor_flags(
+    iree_task_executor_t* executor) {
+  return executor->flags;
+}
+
 iree_host_size_t iree_task_executor_worker_count(
     iree_task_executor_t* executor) {
   return executor->worker_count;
@@ -288,6 +330,36 @@ static void iree_task_executor_relay_to_worker(
   iree_task_post_batch_enqueue(post_batch, worker_index, task);
 }
 
+// Updates the number of workers future dispatches are sharded across based on
+// how well |dispatch_task| made use of the workers it was issued to.
+// Must be called by the coordinator prior to retiring the dispatch.
+static void iree_task_executor_adapt_worker_target(
+    iree_task_executor_t* executor, iree_task_dispatch_t* dispatch_task) {
+#if IREE_TASK_EXECUTOR_ADAPTIVE_WORKER_COUNT
+  iree_host_size_t target_count = executor->worker_target_count;
+  iree_host_size_t idle_shard_count = (iree_host_size_t)iree_atomic_load_int32(
+      &dispatch_task->idle_shard_count, iree_memory_order_relaxed);
+  if (idle_shard_count > 0) {
+    // Some of the woken workers had nothing to do: the dispatch was narrower
+    // (in time) than the number of workers. Back off gradually so that a
+    // single outlier does not collapse the target.
+    iree_host_size_t shrink_count = iree_max(1, idle_shard_count / 2);
+    target_count =
+        target_count > shrink_count ? target_count - shrink_count : 1;
+  } else if (dispatch_task->shard_count == target_count &&
+             dispatch_task->tile_count > target_count) {
+    // Every shard found work and there were more tiles than shards; more
+    // workers may have helped. Grow quickly to recover from narrow phases.
+    target_count = iree_min(executor->worker_count, target_count * 2);
+  }
+  if (target_count != executor->worker_target_count) {
+    executor->worker_target_count = target_count;
+    IREE_TRACE_PLOT_VALUE_I64("iree_task_executor_worker_target_count",
+                              (int64_t)target_count);
+  }
+#endif  // IREE_TASK_EXECUTOR_ADAPTIVE_WORKER_COUNT
+}
+
 // Schedules all ready tasks in the |pending_submission| list.
 // Task may enqueue zero or more new tasks (or newly-ready/waiting tasks) to
 // |pending_submission| or queue work for posting to workers via the
@@ -322,8 +394,11 @@ void iree_task_executor_schedule_ready_tasks(
         // Doesn't do anything; just retire and continue on to any dependents.
         iree_task_nop_retire((iree_task_nop_t*)task, pending_submission);
         break;
-      case IREE_TASK_TYPE_CALL: {
+      case IREE_TASK_TYPE_CALL:
+      case IREE_TASK_TYPE_DISPATCH_SHARD: {
         // Generic routing to workers for tasks that should always run there.
+        // Shards only arrive here when resuming after parking on a suspended
+        // tile and may be resumed by any worker.
         iree_task_executor_relay_to_worker(executor, post_batch, task);
         break;
       }
@@ -356,6 +431,8 @@ void iree_task_executor_schedule_ready_tasks(
         // Dispatches may need to be issued (fanning out the tiles to workers)
         // or retired (after all tiles have completed).
         if (task->flags & IREE_TASK_FLAG_DISPATCH_RETIRE) {
+          iree_task_executor_adapt_worker_target(executor,
+                                                 (iree_task_dispatch_t*)task);
           iree_task_dispatch_retire((iree_task_dispatch_t*)task,
                                     pending_submission);
         } else {
@@ -546,10 +623,14 @@ static iree_task_t* iree_task_executor_try_steal_task_from_affinity_set(
 // Returns a task that is available (has not yet begun processing at all).
 // May steal multiple tasks and add them to the |local_task_queue|.
 //
-// We do a scan through ideal victims indicated by the
-// |constructive_sharing_mask|; these are the workers most likely to have some
-// cache benefits to taking their work as they share some level of the cache
-// hierarchy and should be better to steal from than any random worker.
+// We do a scan through ideal victims indicated by each of the |sharing_masks|
+// in order; these are the workers most likely to have some cache benefits to
+// taking their work as they share some level of the cache hierarchy and should
+// be better to steal from than any random worker. Typically the levels are the
+// L2 cache, the last-level cache (L3 or chiplet/CCX), and the NUMA node. Only
+// after all levels are exhausted do we try remote workers: on CPUs with many
+// L3 domains stealing across domains pulls large working sets through the
+// interconnect and is a last resort.
 //
 // To prevent biasing any particular victim we use a fast prng function to
 // select where in the set of potential victims defined by the topology
@@ -558,8 +639,9 @@ static iree_task_t* iree_task_executor_try_steal_task_from_affinity_set(
 // our search and then go in-order.
 iree_task_t* iree_task_executor_try_steal_task(
     iree_task_executor_t* executor,
-    iree_task_affinity_set_t constructive_sharing_mask,
-    uint32_t max_theft_attempts, iree_prng_minilcg128_state_t* theft_prng,
+    const iree_task_affinity_set_t* sharing_masks,
+    iree_host_size_t sharing_mask_count, uint32_t max_theft_attempts,
+    iree_prng_minilcg128_state_t* theft_prng,
     iree_task_queue_t* local_task_queue) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
@@ -582,21 +664,29 @@ iree_task_t* iree_task_executor_try_steal_task(
   int rotation_offset = iree_prng_minilcg128_next_uint8(theft_prng) &
                         (8 * sizeof(iree_task_affinity_set_t) - 1);
 
-  // Try first with the workers we may have some caches shared with. This
-  // helps to prevent cache invalidations/availability updates as it's likely
-  // that we won't need to go back to main memory (or higher cache tiers) in the
-  // event that the thief and victim are running close to each other in time.
-  iree_task_t* task = iree_task_executor_try_steal_task_from_affinity_set(
-      executor, victim_mask & constructive_sharing_mask, max_theft_attempts,
-      rotation_offset, local_task_queue);
-  if (task) {
-    IREE_TRACE_ZONE_APPEND_TEXT(z0, "local");
-  } else {
+  // Try first with the workers we may have some caches shared with, widening
+  // the set one level of the hierarchy at a time. This helps to prevent cache
+  // invalidations/availability updates as it's likely that we won't need to go
+  // back to main memory (or higher cache tiers) in the event that the thief
+  // and victim are running close to each other in time. Workers already tried
+  // at a nearer level are excluded from the farther ones.
+  iree_task_t* task = NULL;
+  iree_task_affinity_set_t tried_mask = 0;
+  for (iree_host_size_t i = 0; i < sharing_mask_count && !task; ++i) {
+    task = iree_task_executor_try_steal_task_from_affinity_set(
+        executor, victim_mask & sharing_masks[i] & ~tried_mask,
+        max_theft_attempts, rotation_offset, local_task_queue);
+    tried_mask |= sharing_masks[i];
+    IREE_TRACE({
+      if (task) IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, i);
+    });
+  }
+  if (!task) {
     task = iree_task_executor_try_steal_task_from_affinity_set(
-        executor, victim_mask & ~constructive_sharing_mask, max_theft_attempts,
+        executor, victim_mask & ~tried_mask, max_theft_attempts,
         rotation_offset, local_task_queue);
     if (task) {
-      IREE_TRACE_ZONE_APPEND_TEXT(z0, "non-local");
+      IREE_TRACE_ZONE_APPEND_TEXT(z0, "remote");
     }
   }
 
@@ -604,11 +694,66 @@ iree_task_t* iree_task_executor_try_steal_task(
   return task;
 }
 
+// Claims an unclaimed worker of a threadless executor for the calling thread.
+// Returns NULL if all workers are already claimed by other callers.
+static iree_task_worker_t* iree_task_executor_claim_worker(
+    iree_task_executor_t* executor) {
+  iree_task_affinity_set_t all_mask =
+      iree_task_affinity_set_ones(executor->worker_count);
+  iree_task_affinity_set_t claim_mask = iree_atomic_task_affinity_set_load(
+      &executor->worker_claim_mask, iree_memory_order_relaxed);
+  while (true) {
+    iree_task_affinity_set_t free_mask = all_mask & ~claim_mask;
+    if (!free_mask) return NULL;
+    int worker_index = iree_task_affinity_set_count_trailing_zeros(free_mask);
+    iree_task_affinity_set_t worker_bit =
+        iree_task_affinity_for_worker(worker_index);
+    if (iree_atomic_task_affinity_set_compare_exchange_weak(
+            &executor->worker_claim_mask, &claim_mask, claim_mask | worker_bit,
+            iree_memory_order_acquire, iree_memory_order_relaxed)) {
+      iree_atomic_task_affinity_set_fetch_or(&executor->worker_live_mask,
+                                             worker_bit,
+                                             iree_memory_order_relaxed);
+      return &executor->workers[worker_index];
+    }
+  }
+}
+
+// Releases a |worker| claimed with iree_task_executor_claim_worker.
+// Any tasks remaining on the worker will be adopted by the next caller to pump.
+static void iree_task_executor_release_worker(iree_task_executor_t* executor,
+                                              iree_task_worker_t* worker) {
+  iree_atomic_task_affinity_set_fetch_and(&executor->worker_live_mask,
+                                          ~worker->worker_bit,
+                                          iree_memory_order_relaxed);
+  iree_atomic_task_affinity_set_fetch_and(&executor->worker_idle_mask,
+                                          ~worker->worker_bit,
+                                          iree_memory_order_relaxed);
+  iree_atomic_task_affinity_set_fetch_and(&executor->worker_claim_mask,
+                                          ~worker->worker_bit,
+                                          iree_memory_order_release);
+}
+
 iree_status_t iree_task_executor_donate_caller(iree_task_executor_t* executor,
                                                iree_wait_source_t wait_source,
                                                iree_timeout_t timeout) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  // Threadless executors rely on callers to make progress: claim a worker and
+  // pump tasks on it until the wait source resolves.
+  if (iree_all_bits_set(executor->flags, IREE_TASK_EXECUTOR_FLAG_THREADLESS)) {
+    iree_task_worker_t* worker = iree_task_executor_claim_worker(executor);
+    if (worker) {
+      iree_status_t status =
+          iree_task_worker_pump_until(worker, wait_source, timeout);
+      iree_task_executor_release_worker(executor, worker);
+      IREE_TRACE_ZONE_END(z0);
+      return status;
+    }
+    // All workers are claimed by other callers who will make progress on our
+    // behalf; fall through to a normal wait.
+  }
+
   // Perform an immediate flush/coordination (in case the caller queued).
   iree_task_executor_flush(executor);
 
@@ -7,11 +7,13 @@
 #ifndef IREE_TASK_EXECUTOR_H_
 #define IREE_TASK_EXECUTOR_H_
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #include "iree/base/api.h"
 #include "iree/base/internal/atomics.h"
 #include "iree/base/internal/event_pool.h"
+#include "iree/base/internal/threading.h"
 #include "iree/task/scope.h"
 #include "iree/task/submission.h"
 #include "iree/task/task.h"
@@ -268,8 +270,80 @@ enum iree_task_scheduling_mode_bits_t {
 };
 typedef uint32_t iree_task_scheduling_mode_t;
 
+// A bitfield specifying executor behavior.
+enum iree_task_executor_flag_bits_t {
+  IREE_TASK_EXECUTOR_FLAG_NONE = 0u,
+
+  // Workers are created without threads of their own and tasks only execute
+  // on threads that donate themselves to the executor with
+  // iree_task_executor_donate_caller. Each donating caller claims one of the
+  // workers defined by the topology for the duration of the donation and
+  // multiple callers may cooperatively pump the same executor up to the worker
+  // count. No threads are woken on submission and nothing runs when no callers
+  // are donating; callers must donate until the work they submitted completes.
+  //
+  // Executors created with an empty topology are always threadless with a
+  // single worker.
+  IREE_TASK_EXECUTOR_FLAG_THREADLESS = 1u << 0,
+};
+typedef uint32_t iree_task_executor_flags_t;
+
+// Parameters describing a worker thread spawned on an external thread pool.
+// All values are hints that the pool may use when selecting or configuring the
+// thread the worker runs on.
+typedef struct iree_task_thread_spawn_params_t {
+  // Name of the worker (matching the topology group name).
+  iree_string_view_t name;
+  // Globally unique worker index (worker_base_index + local worker index).
+  iree_host_size_t worker_index;
+  // Ideal processor affinity for the worker as defined by the topology.
+  iree_thread_affinity_t ideal_affinity;
+  // Minimum size in bytes of the stack the worker expects.
+  iree_host_size_t stack_size;
+} iree_task_thread_spawn_params_t;
+
+// An externally-managed thread pool that executor workers run on instead of
+// threads owned by the executor. This allows hosting applications with their
+// own thread pools (OpenMP, TBB, custom pools, etc) to share cores with IREE
+// instead of oversubscribing them.
+//
+// Each worker occupies one pool thread for the lifetime of the executor and
+// parks on that thread while it has no work. Parking uses permit semantics:
+// an unpark of a thread that is not parked makes its next park return
+// immediately, ensuring that wakes racing with a worker going idle are never
+// lost. Pools may use park to lend the thread to other work so long as the
+// worker resumes once unparked.
+typedef struct iree_task_thread_pool_t {
+  // User-defined pool state passed to all functions.
+  void* self;
+  // Runs |entry| with |entry_arg| on a pool thread and returns an opaque
+  // handle to that thread in |out_thread|. The entry function returns once the
+  // executor is shutting down and the thread may be reused by the pool after
+  // join.
+  iree_status_t(IREE_API_PTR* spawn)(
+      void* self, const iree_task_thread_spawn_params_t* params,
+      iree_thread_entry_t entry, void* entry_arg, void** out_thread);
+  // Blocks until the entry function running on |thread| has returned and
+  // releases the thread back to the pool.
+  void(IREE_API_PTR* join)(void* self, void* thread);
+  // Parks the calling pool thread until it is unparked. May return spuriously.
+  void(IREE_API_PTR* park)(void* self);
+  // Unparks |thread| or, if it is not parked, makes its next park return
+  // immediately. May be called from any thread.
+  void(IREE_API_PTR* unpark)(void* self, void* thread);
+} iree_task_thread_pool_t;
+
+// Returns true if |thread_pool| is not set and executor-owned threads are used.
+static inline bool iree_task_thread_pool_is_null(
+    const iree_task_thread_pool_t* thread_pool) {
+  return thread_pool->spawn == NULL;
+}
+
 // Options controlling task executor behavior.
 typedef struct iree_task_executor_options_t {
+  // Flags controlling executor behavior.
+  iree_task_executor_flags_t flags;
+
   // Specifies the schedule mode used for worker and workload balancing.
   iree_task_scheduling_mode_t scheduling_mode;
 
@@ -288,6 +362,12 @@ typedef struct iree_task_executor_options_t {
   // scheduling, and the environment).
   iree_duration_t worker_spin_ns;
 
+  // Optional external thread pool that workers are spawned on. When not set
+  // (the default) the executor creates and owns its worker threads. Not
+  // supported with IREE_TASK_EXECUTOR_FLAG_THREADLESS. Pool threads park
+  // without spinning regardless of worker_spin_ns.
+  iree_task_thread_pool_t thread_pool;
+
   // Minimum size in bytes of each worker thread stack.
   // The underlying platform may allocate more stack space but _should_
   // guarantee that the available stack space is near this amount. Note that the
@@ -302,6 +382,12 @@ typedef struct iree_task_executor_options_t {
   // for their invocations and no more. May be 0 if no worker local memory is
   // required.
   iree_host_size_t worker_local_memory_size;
+
+  // NUMA node the executor workers are scheduled on or
+  // IREE_TASK_TOPOLOGY_NODE_ID_ANY if unspecified. The executor itself does not
+  // pin to the node (that is up to the topology) but users can query it with
+  // iree_task_executor_node_id in order to place memory near the workers.
+  iree_task_topology_node_id_t node_id;
 } iree_task_executor_options_t;
 
 // Initializes |out_options| to default values.
@@ -330,8 +416,18 @@ void iree_task_executor_release(iree_task_executor_t* executor);
 // Trims pools and caches used by the executor and its workers.
 void iree_task_executor_trim(iree_task_executor_t* executor);
 
+// Returns the NUMA node the executor workers are scheduled on or
+// IREE_TASK_TOPOLOGY_NODE_ID_ANY if the executor is not associated with a node.
+iree_task_topology_node_id_t iree_task_executor_node_id(
+    iree_task_executor_t* executor);
+
+// Returns the flags the executor was created with.
+iree_task_executor_flags_t iree_task_executor_flags(
+    iree_task_executor_t* executor);
+
 // Returns the number of live workers usable by the executor.
 // The actual number used for any particular operation is dynamic.
+// For threadless executors this is the maximum number of cooperating callers.
 iree_host_size_t iree_task_executor_worker_count(
     iree_task_executor_t* executor);
 
@@ -401,6 +497,13 @@ void iree_task_executor_flush(iree_task_executor_t* executor);
 // Especially in large applications it's almost certainly better to do something
 // useful with the calling thread (even if that's go to sleep).
 //
+// Executors created with IREE_TASK_EXECUTOR_FLAG_THREADLESS have no threads of
+// their own and donation is the only way tasks make progress. The caller claims
+// a worker and pumps tasks (including stealing from and adopting tasks
+// stranded on unclaimed workers) until |wait_source| resolves and only blocks
+// when no tasks are ready. If all workers are already claimed by other callers
+// this behaves as a normal wait.
+//
 // Safe to call from any thread (though bad to reentrantly call from workers).
 iree_status_t iree_task_executor_donate_caller(iree_task_executor_t* executor,
                                                iree_wait_source_t wait_source,
@@ -34,10 +34,19 @@ struct iree_task_executor_t {
   // process and can be used for IREE_TRACE plotting/allocation calls.
   IREE_TRACE(const char* trace_name;)
 
+  // Flags controlling executor behavior.
+  iree_task_executor_flags_t flags;
+
   // Defines how work is selected across queues.
   // TODO(benvanik): make mutable; currently always the same reserved value.
   iree_task_scheduling_mode_t scheduling_mode;
 
+  // NUMA node the workers are scheduled on, if any.
+  iree_task_topology_node_id_t node_id;
+
+  // External thread pool the workers run on, if any.
+  iree_task_thread_pool_t thread_pool;
+
   // Time each worker should spin before parking itself to wait for more work.
   // IREE_DURATION_ZERO is used to disable spinning.
   iree_duration_t worker_spin_ns;
@@ -116,6 +125,17 @@ struct iree_task_executor_t {
   // comment on worker_live_mask.
   iree_atomic_task_affinity_set_t worker_idle_mask;
 
+  // A bitset indicating which workers of a threadless executor are currently
+  // claimed by donating callers. Unlike the hint masks above this is
+  // authoritative: a worker may only be pumped by the caller that set its bit.
+  // Always zero for executors with worker threads.
+  iree_atomic_task_affinity_set_t worker_claim_mask;
+
+  // Notification set that idle workers wait on using their executor-local
+  // worker index. Posting a worker bitmask wakes exactly those workers with a
+  // single operation where the platform supports it.
+  iree_notification_set_t worker_wake_set;
+
   // Base value added to each executor-local worker index.
   // This allows workers to uniquely identify themselves in multi-executor
   // configurations.
@@ -126,6 +146,14 @@ struct iree_task_executor_t {
   // live join/leave behavior we could change this to a registration mechanism.
   iree_host_size_t worker_count;
   iree_task_worker_t* workers;  // [worker_count]
+
+  // Number of workers wide dispatches are currently sharded across. Shrinks
+  // when dispatches retire with shards that found no tiles left to execute (so
+  // narrow work wakes a minimal set of workers and the rest stay parked) and
+  // grows when dispatches were limited by the target and fully used it.
+  // Always in [1, worker_count].
+  // Must only be accessed by the coordinator (under coordinator_mutex).
+  iree_host_size_t worker_target_count;
 };
 
 // Merges a submission into the primary FIFO queues.
@@ -157,10 +185,14 @@ void iree_task_executor_coordinate(iree_task_executor_t* executor,
 // Tries to steal an entire task from a sibling worker (based on topology).
 // Returns a task that is available (has not yet begun processing at all).
 // May steal multiple tasks and add them to the |local_task_queue|.
+//
+// |sharing_masks| are tried in order (nearest cache level first) before any
+// other worker is considered.
 iree_task_t* iree_task_executor_try_steal_task(
     iree_task_executor_t* executor,
-    iree_task_affinity_set_t constructive_sharing_mask,
-    uint32_t max_theft_attempts, iree_prng_minilcg128_state_t* theft_prng,
+    const iree_task_affinity_set_t* sharing_masks,
+    iree_host_size_t sharing_mask_count, uint32_t max_theft_attempts,
+    iree_prng_minilcg128_state_t* theft_prng,
     iree_task_queue_t* local_task_queue);
 
 #ifdef __cplusplus
@@ -6,7 +6,15 @@
 
 #include "iree/task/executor.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstddef>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
 
 #include "iree/testing/gtest.h"
 #include "iree/testing/status_matchers.h"
@@ -133,4 +141,404 @@ TEST(ExecutorTest, SubmissionStress) {
   iree_task_topology_deinitialize(&topology);
 }
 
+// Tests that dispatches on topologies with multiple last-level cache domains
+// execute every tile exactly once as the grid is partitioned across domains.
+TEST(ExecutorTest, CacheDomainPartitionedDispatch) {
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(/*group_count=*/6, &topology);
+  // Three domains of two workers each: {0, 1}, {2, 3}, {4, 5}.
+  for (iree_host_size_t i = 0; i < topology.group_count; ++i) {
+    iree_task_topology_group_t* group = &topology.groups[i];
+    iree_task_topology_group_mask_t domain_mask = 0x3ull << (i & ~1);
+    group->constructive_sharing_mask = 0;
+    group->llc_sharing_mask = domain_mask & ~(1ull << i);
+    group->node_sharing_mask = 0x3Full & ~(1ull << i);
+  }
+  iree_task_executor_t* executor = NULL;
+  IREE_ASSERT_OK(iree_task_executor_create(options, &topology,
+                                           iree_allocator_system(), &executor));
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("scope"), &scope);
+
+  static constexpr uint32_t kTileCount = 37 * 5 * 3;
+  static std::atomic<uint32_t> tile_hits[kTileCount];
+  for (int i = 0; i < 100; ++i) {
+    for (auto& tile_hit : tile_hits) tile_hit = 0;
+    const uint32_t workgroup_size[3] = {1, 1, 1};
+    const uint32_t workgroup_count[3] = {37, 5, 3};
+    iree_task_dispatch_t dispatch;
+    iree_task_dispatch_initialize(
+        &scope,
+        iree_task_make_dispatch_closure(
+            [](void* user_context, const iree_task_tile_context_t* tile_context,
+               iree_task_submission_t* pending_submission) {
+              const uint32_t* xyz = tile_context->workgroup_xyz;
+              ++tile_hits[(xyz[2] * 5 + xyz[1]) * 37 + xyz[0]];
+              return iree_ok_status();
+            },
+            NULL),
+        workgroup_size, workgroup_count, &dispatch);
+
+    iree_task_fence_t* fence = NULL;
+    IREE_ASSERT_OK(iree_task_executor_acquire_fence(executor, &scope, &fence));
+    iree_task_set_completion_task(&dispatch.header, &fence->header);
+
+    iree_task_submission_t submission;
+    iree_task_submission_initialize(&submission);
+    iree_task_submission_enqueue(&submission, &dispatch.header);
+    iree_task_executor_submit(executor, &submission);
+    iree_task_executor_flush(executor);
+    IREE_ASSERT_OK(
+        iree_task_scope_wait_idle(&scope, IREE_TIME_INFINITE_FUTURE));
+
+    for (uint32_t j = 0; j < kTileCount; ++j) {
+      ASSERT_EQ(tile_hits[j], 1) << "tile " << j << " in iteration " << i;
+    }
+  }
+
+  iree_task_scope_deinitialize(&scope);
+  iree_task_executor_release(executor);
+  iree_task_topology_deinitialize(&topology);
+}
+
+// Tests that an executor with an empty topology runs tasks on the donating
+// caller thread.
+TEST(ExecutorTest, ThreadlessCall) {
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  iree_task_topology_t topology;
+  iree_task_topology_initialize(&topology);
+  iree_task_executor_t* executor = NULL;
+  IREE_ASSERT_OK(iree_task_executor_create(options, &topology,
+                                           iree_allocator_system(), &executor));
+  EXPECT_TRUE(iree_all_bits_set(iree_task_executor_flags(executor),
+                                IREE_TASK_EXECUTOR_FLAG_THREADLESS));
+  EXPECT_EQ(iree_task_executor_worker_count(executor), 1);
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("scope"), &scope);
+
+  std::thread::id caller_id = std::this_thread::get_id();
+  static std::thread::id received_id;
+  iree_task_call_t call;
+  iree_task_call_initialize(
+      &scope,
+      iree_task_make_call_closure(
+          [](void* user_context, iree_task_t* task,
+             iree_task_submission_t* pending_submission) {
+            received_id = std::this_thread::get_id();
+            return iree_ok_status();
+          },
+          NULL),
+      &call);
+
+  iree_task_fence_t* fence = NULL;
+  IREE_ASSERT_OK(iree_task_executor_acquire_fence(executor, &scope, &fence));
+  iree_task_set_completion_task(&call.header, &fence->header);
+
+  iree_task_submission_t submission;
+  iree_task_submission_initialize(&submission);
+  iree_task_submission_enqueue(&submission, &call.header);
+  iree_task_executor_submit(executor, &submission);
+  iree_task_executor_flush(executor);
+
+  // Nothing runs until the caller donates itself.
+  EXPECT_FALSE(iree_task_scope_is_idle(&scope));
+  IREE_ASSERT_OK(iree_task_executor_donate_caller(
+      executor, iree_task_scope_await_idle(&scope), iree_infinite_timeout()));
+  EXPECT_TRUE(iree_task_scope_is_idle(&scope));
+  EXPECT_EQ(received_id, caller_id);
+
+  iree_task_scope_deinitialize(&scope);
+  iree_task_executor_release(executor);
+  iree_task_topology_deinitialize(&topology);
+}
+
+// Tests that multiple callers can cooperatively pump a threadless executor and
+// that dispatch shards posted to unclaimed workers still execute.
+TEST(ExecutorTest, ThreadlessCooperativeDispatch) {
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  options.flags |= IREE_TASK_EXECUTOR_FLAG_THREADLESS;
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(/*group_count=*/4, &topology);
+  iree_task_executor_t* executor = NULL;
+  IREE_ASSERT_OK(iree_task_executor_create(options, &topology,
+                                           iree_allocator_system(), &executor));
+  EXPECT_EQ(iree_task_executor_worker_count(executor), 4);
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("scope"), &scope);
+
+  for (int i = 0; i < 100; ++i) {
+    static std::atomic<uint32_t> tile_count = {0};
+    tile_count = 0;
+    const uint32_t workgroup_size[3] = {1, 1, 1};
+    const uint32_t workgroup_count[3] = {64, 4, 1};
+    iree_task_dispatch_t dispatch;
+    iree_task_dispatch_initialize(
+        &scope,
+        iree_task_make_dispatch_closure(
+            [](void* user_context, const iree_task_tile_context_t* tile_context,
+               iree_task_submission_t* pending_submission) {
+              ++tile_count;
+              return iree_ok_status();
+            },
+            NULL),
+        workgroup_size, workgroup_count, &dispatch);
+
+    iree_task_fence_t* fence = NULL;
+    IREE_ASSERT_OK(iree_task_executor_acquire_fence(executor, &scope, &fence));
+    iree_task_set_completion_task(&dispatch.header, &fence->header);
+
+    iree_task_submission_t submission;
+    iree_task_submission_initialize(&submission);
+    iree_task_submission_enqueue(&submission, &dispatch.header);
+    iree_task_executor_submit(executor, &submission);
+    iree_task_executor_flush(executor);
+
+    std::thread helper([&]() {
+      IREE_EXPECT_OK(iree_task_executor_donate_caller(
+          executor, iree_task_scope_await_idle(&scope),
+          iree_infinite_timeout()));
+    });
+    IREE_ASSERT_OK(iree_task_executor_donate_caller(
+        executor, iree_task_scope_await_idle(&scope), iree_infinite_timeout()));
+    helper.join();
+    EXPECT_EQ(tile_count, 64 * 4);
+  }
+
+  iree_task_scope_deinitialize(&scope);
+  iree_task_executor_release(executor);
+  iree_task_topology_deinitialize(&topology);
+}
+
+// Issues a 64x1x1 dispatch on |executor| and donates |donor_count| callers
+// until it completes. Each tile waits (bounded) until as many donors as there
+// are shards have started a tile so that with enough donors no shard is idle.
+// Returns the number of shards the dispatch was split into.
+static uint32_t DispatchWithDonors(iree_task_executor_t* executor,
+                                   iree_task_scope_t* scope,
+                                   int donor_count) {
+  struct State {
+    iree_task_dispatch_t dispatch;
+    size_t donor_count;
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::set<std::thread::id> shard_threads;
+  } state;
+  const uint32_t workgroup_size[3] = {1, 1, 1};
+  const uint32_t workgroup_count[3] = {64, 1, 1};
+  iree_task_dispatch_initialize(
+      scope,
+      iree_task_make_dispatch_closure(
+          [](void* user_context, const iree_task_tile_context_t* tile_context,
+             iree_task_submission_t* pending_submission) {
+            auto* state = reinterpret_cast<State*>(user_context);
+            std::unique_lock<std::mutex> lock(state->mutex);
+            state->shard_threads.insert(std::this_thread::get_id());
+            state->cond.notify_all();
+            state->cond.wait_for(lock, std::chrono::seconds(5), [state]() {
+              return state->shard_threads.size() >=
+                     std::min<size_t>(state->donor_count,
+                                      state->dispatch.shard_count);
+            });
+            return iree_ok_status();
+          },
+          &state),
+      workgroup_size, workgroup_count, &state.dispatch);
+  state.donor_count = donor_count;
+
+  iree_task_fence_t* fence = NULL;
+  IREE_CHECK_OK(iree_task_executor_acquire_fence(executor, scope, &fence));
+  iree_task_set_completion_task(&state.dispatch.header, &fence->header);
+  iree_task_submission_t submission;
+  iree_task_submission_initialize(&submission);
+  iree_task_submission_enqueue(&submission, &state.dispatch.header);
+  iree_task_executor_submit(executor, &submission);
+  iree_task_executor_flush(executor);
+
+  std::vector<std::thread> donors;
+  for (int i = 0; i < donor_count; ++i) {
+    donors.emplace_back([&]() {
+      IREE_EXPECT_OK(iree_task_executor_donate_caller(
+          executor, iree_task_scope_await_idle(scope),
+          iree_infinite_timeout()));
+    });
+  }
+  for (auto& donor : donors) donor.join();
+  return state.dispatch.shard_count;
+}
+
+#if IREE_TASK_EXECUTOR_ADAPTIVE_WORKER_COUNT
+
+// Tests that the number of workers dispatches are sharded across shrinks when
+// shards find no work and grows again once every shard is kept busy.
+TEST(ExecutorTest, AdaptiveWorkerTarget) {
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  options.flags |= IREE_TASK_EXECUTOR_FLAG_THREADLESS;
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(/*group_count=*/4, &topology);
+  iree_task_executor_t* executor = NULL;
+  IREE_ASSERT_OK(iree_task_executor_create(options, &topology,
+                                           iree_allocator_system(), &executor));
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("scope"), &scope);
+
+  // A single donor runs the shards one after another: the first executes every
+  // tile and the rest are idle, so the target backs off one worker at a time.
+  EXPECT_EQ(DispatchWithDonors(executor, &scope, /*donor_count=*/1), 4);
+  EXPECT_EQ(DispatchWithDonors(executor, &scope, /*donor_count=*/1), 3);
+  EXPECT_EQ(DispatchWithDonors(executor, &scope, /*donor_count=*/1), 2);
+  EXPECT_EQ(DispatchWithDonors(executor, &scope, /*donor_count=*/1), 1);
+
+  // With a donor per worker every shard executes tiles and the target doubles
+  // until all workers are used again.
+  EXPECT_EQ(DispatchWithDonors(executor, &scope, /*donor_count=*/4), 2);
+  EXPECT_EQ(DispatchWithDonors(executor, &scope, /*donor_count=*/4), 4);
+  EXPECT_EQ(DispatchWithDonors(executor, &scope, /*donor_count=*/4), 4);
+
+  iree_task_scope_deinitialize(&scope);
+  iree_task_executor_release(executor);
+  iree_task_topology_deinitialize(&topology);
+}
+
+#endif  // IREE_TASK_EXECUTOR_ADAPTIVE_WORKER_COUNT
+
+// Minimal external thread pool that runs each spawned entry on a std::thread
+// and implements park/unpark with a per-thread permit.
+class TestThreadPool {
+ public:
+  iree_task_thread_pool_t pool() {
+    iree_task_thread_pool_t pool;
+    pool.self = this;
+    pool.spawn = Spawn;
+    pool.join = Join;
+    pool.park = Park;
+    pool.unpark = Unpark;
+    return pool;
+  }
+
+  int spawn_count() const { return spawn_count_; }
+  // Delays returning the thread handle from spawn after the entry has started.
+  void set_spawn_delay(std::chrono::milliseconds delay) {
+    spawn_delay_ = delay;
+  }
+  static bool IsPoolThread() { return current_ != nullptr; }
+
+ private:
+  struct Thread {
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable cond;
+    bool permit = false;
+  };
+
+  static iree_status_t Spawn(void* self,
+                             const iree_task_thread_spawn_params_t* params,
+                             iree_thread_entry_t entry, void* entry_arg,
+                             void** out_thread) {
+    auto* pool = reinterpret_cast<TestThreadPool*>(self);
+    ++pool->spawn_count_;
+    auto* thread = new Thread();
+    thread->thread = std::thread([thread, entry, entry_arg]() {
+      current_ = thread;
+      entry(entry_arg);
+      current_ = nullptr;
+    });
+    std::this_thread::sleep_for(pool->spawn_delay_);
+    *out_thread = thread;
+    return iree_ok_status();
+  }
+
+  static void Join(void* self, void* thread_ptr) {
+    auto* thread = reinterpret_cast<Thread*>(thread_ptr);
+    thread->thread.join();
+    delete thread;
+  }
+
+  static void Park(void* self) {
+    Thread* thread = current_;
+    std::unique_lock<std::mutex> lock(thread->mutex);
+    thread->cond.wait(lock, [thread]() { return thread->permit; });
+    thread->permit = false;
+  }
+
+  static void Unpark(void* self, void* thread_ptr) {
+    auto* thread = reinterpret_cast<Thread*>(thread_ptr);
+    std::lock_guard<std::mutex> lock(thread->mutex);
+    thread->permit = true;
+    thread->cond.notify_one();
+  }
+
+  static thread_local Thread* current_;
+  std::atomic<int> spawn_count_ = {0};
+  std::chrono::milliseconds spawn_delay_ = std::chrono::milliseconds(0);
+};
+thread_local TestThreadPool::Thread* TestThreadPool::current_ = nullptr;
+
+// Runs calls on an executor hosted on |thread_pool| and checks that they ran
+// on pool threads.
+static void RunOnThreadPool(TestThreadPool& thread_pool) {
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  options.thread_pool = thread_pool.pool();
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(/*group_count=*/4, &topology);
+  iree_task_executor_t* executor = NULL;
+  IREE_ASSERT_OK(iree_task_executor_create(options, &topology,
+                                           iree_allocator_system(), &executor));
+  EXPECT_EQ(thread_pool.spawn_count(), 4);
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("scope"), &scope);
+
+  for (int i = 0; i < 100; ++i) {
+    static std::atomic<bool> ran_on_pool = {false};
+    ran_on_pool = false;
+    iree_task_call_t call;
+    iree_task_call_initialize(
+        &scope,
+        iree_task_make_call_closure(
+            [](void* user_context, iree_task_t* task,
+               iree_task_submission_t* pending_submission) {
+              ran_on_pool = TestThreadPool::IsPoolThread();
+              return iree_ok_status();
+            },
+            NULL),
+        &call);
+
+    iree_task_fence_t* fence = NULL;
+    IREE_ASSERT_OK(iree_task_executor_acquire_fence(executor, &scope, &fence));
+    iree_task_set_completion_task(&call.header, &fence->header);
+
+    iree_task_submission_t submission;
+    iree_task_submission_initialize(&submission);
+    iree_task_submission_enqueue(&submission, &call.header);
+    iree_task_executor_submit(executor, &submission);
+    iree_task_executor_flush(executor);
+    IREE_ASSERT_OK(
+        iree_task_scope_wait_idle(&scope, IREE_TIME_INFINITE_FUTURE));
+    EXPECT_TRUE(ran_on_pool);
+  }
+
+  iree_task_scope_deinitialize(&scope);
+  iree_task_executor_release(executor);
+  iree_task_topology_deinitialize(&topology);
+}
+
+// Tests that workers run on an external thread pool when one is provided.
+TEST(ExecutorTest, ExternalThreadPool) {
+  TestThreadPool thread_pool;
+  RunOnThreadPool(thread_pool);
+}
+
+// Tests that workers that start running before the pool has returned their
+// thread handle from spawn can still be woken.
+TEST(ExecutorTest, ExternalThreadPoolLateThreadHandle) {
+  TestThreadPool thread_pool;
+  thread_pool.set_spawn_delay(std::chrono::milliseconds(10));
+  RunOnThreadPool(thread_pool);
+}
+
 }  // namespace
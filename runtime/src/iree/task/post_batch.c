@@ -31,6 +31,20 @@ iree_host_size_t iree_task_post_batch_worker_count(
   return post_batch->executor->worker_count;
 }
 
+iree_host_size_t iree_task_post_batch_target_worker_count(
+    const iree_task_post_batch_t* post_batch) {
+  return post_batch->executor->worker_target_count;
+}
+
+iree_host_size_t iree_task_post_batch_worker_cache_domain(
+    const iree_task_post_batch_t* post_batch, iree_host_size_t worker_index) {
+  const iree_task_worker_t* worker =
+      &post_batch->executor->workers[worker_index];
+  return iree_task_affinity_set_count_trailing_zeros(
+      worker->sharing_masks[IREE_TASK_WORKER_SHARING_LEVEL_LLC] |
+      worker->worker_bit);
+}
+
 static iree_host_size_t iree_task_post_batch_select_random_worker(
     iree_task_post_batch_t* post_batch, iree_task_affinity_set_t affinity_set) {
   // The masks are accessed with 'relaxed' order because they are just hints.
@@ -99,15 +113,20 @@ static void iree_task_post_batch_wake_workers(
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, iree_math_count_ones_u64(wake_mask));
 
-  // TODO(#4016): use a FUTEX_WAKE_BITSET here to wake all of the workers that
-  // have pending work in a single syscall (vs. popcnt(worker_pending_mask)
-  // syscalls). This will reduce wake latency for workers later in the set;
-  // for example today worker[31] will wait until workers[0-30] have had their
-  // syscalls performed before it's even requested to wake. This also loses
-  // information the kernel could use to avoid core migration as it knows when N
-  // threads will be needed simultaneously and can hopefully perform any needed
-  // migrations prior to beginning execution.
   iree_task_executor_t* executor = post_batch->executor;
+  if (iree_task_thread_pool_is_null(&executor->thread_pool)) {
+    // All idle workers wait on the same notification set and we can wake all
+    // of the workers that have pending work with a single post (and at most a
+    // single FUTEX_WAKE_BITSET syscall) vs. popcnt(wake_mask) syscalls. This
+    // avoids later workers in the set waiting on the syscalls of the earlier
+    // ones and gives the kernel the full set of threads that will be needed
+    // simultaneously. If no worker is waiting this is just an atomic add.
+    iree_notification_set_post(&executor->worker_wake_set, wake_mask);
+    IREE_TRACE_ZONE_END(z0);
+    return;
+  }
+
+  // Workers on an external thread pool are unparked individually.
   int wake_count = iree_task_affinity_set_count_ones(wake_mask);
   int worker_index = 0;
   for (int i = 0; i < wake_count; ++i) {
@@ -115,13 +134,7 @@ static void iree_task_post_batch_wake_workers(
     int wake_index = worker_index + offset;
     worker_index += offset + 1;
     wake_mask = iree_shr(wake_mask, offset + 1);
-
-    // Wake workers if they are waiting - workers are the only thing that can
-    // wait on this notification so this should almost always be either free (an
-    // atomic load) if a particular worker isn't waiting or it's required to
-    // actually wake it and we can't avoid it.
-    iree_task_worker_t* worker = &executor->workers[wake_index];
-    iree_notification_post(&worker->wake_notification, 1);
+    iree_task_worker_wake(&executor->workers[wake_index]);
   }
 
   IREE_TRACE_ZONE_END(z0);
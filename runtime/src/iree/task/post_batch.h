@@ -51,6 +51,17 @@ void iree_task_post_batch_initialize(iree_task_executor_t* executor,
 iree_host_size_t iree_task_post_batch_worker_count(
     const iree_task_post_batch_t* post_batch);
 
+// Returns the number of workers the executor currently prefers wide work be
+// distributed across. Always at least 1 and at most the total worker count.
+iree_host_size_t iree_task_post_batch_target_worker_count(
+    const iree_task_post_batch_t* post_batch);
+
+// Returns an identifier of the last-level cache domain of the worker with the
+// given |worker_index|. Workers with the same identifier share a last-level
+// cache. Identifiers are the lowest worker index within each domain.
+iree_host_size_t iree_task_post_batch_worker_cache_domain(
+    const iree_task_post_batch_t* post_batch, iree_host_size_t worker_index);
+
 // Selects a random worker from the given affinity set.
 iree_host_size_t iree_task_post_batch_select_worker(
     iree_task_post_batch_t* post_batch, iree_task_affinity_set_t affinity_set);
@@ -155,6 +155,12 @@ bool iree_task_scope_is_idle(iree_task_scope_t* scope);
 iree_status_t iree_task_scope_wait_idle(iree_task_scope_t* scope,
                                         iree_time_t deadline_ns);
 
+// Returns a wait source that resolves when the scope becomes idle.
+// This allows callers to donate themselves to an executor with
+// iree_task_executor_donate_caller until the scope completes. The scope must
+// remain valid for the lifetime of the wait source.
+iree_wait_source_t iree_task_scope_await_idle(iree_task_scope_t* scope);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
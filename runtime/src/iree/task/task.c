@@ -530,6 +530,8 @@ static void iree_task_dispatch_initialize_base(
   memcpy(out_task->workgroup_size, workgroup_size,
          sizeof(out_task->workgroup_size));
   out_task->local_memory_size = 0;
+  out_task->tile_storage = NULL;
+  out_task->tile_storage_count = 0;
   iree_atomic_store_intptr(&out_task->status, 0, iree_memory_order_release);
   memset(&out_task->statistics, 0, sizeof(out_task->statistics));
 
@@ -559,6 +561,14 @@ void iree_task_dispatch_initialize_indirect(
   out_task->workgroup_count.ptr = workgroup_count_ptr;
 }
 
+void iree_task_dispatch_set_tile_storage(iree_task_dispatch_t* task,
+                                         iree_task_tile_storage_t* tile_storage,
+                                         uint32_t tile_storage_count) {
+  IREE_ASSERT_LE(tile_storage_count, IREE_TASK_DISPATCH_MAX_TILE_STORAGE_COUNT);
+  task->tile_storage = tile_storage_count ? tile_storage : NULL;
+  task->tile_storage_count = tile_storage_count;
+}
+
 void iree_task_dispatch_issue(iree_task_dispatch_t* dispatch_task,
                               iree_task_pool_t* shard_task_pool,
                               iree_task_submission_t* pending_submission,
@@ -597,23 +607,30 @@ void iree_task_dispatch_issue(iree_task_dispatch_t* dispatch_task,
 #endif  // IREE_HAL_VERBOSE_TRACING_ENABLE
 
   // Setup the iteration space for shards to pull work from the complete grid.
-  iree_atomic_store_int32(&dispatch_task->tile_index, 0,
-                          iree_memory_order_relaxed);
   dispatch_task->tile_count =
       workgroup_count[0] * workgroup_count[1] * workgroup_count[2];
 
-  // Compute shard count - almost always worker_count unless we are a very small
-  // dispatch (1x1x1, etc).
+  // Compute shard count - almost always the executor's current target worker
+  // count unless we are a very small dispatch (1x1x1, etc). The target adapts
+  // to how much work recent dispatches had for each woken worker.
   iree_host_size_t worker_count = iree_task_post_batch_worker_count(post_batch);
   iree_host_size_t shard_count =
-      iree_min(dispatch_task->tile_count, worker_count);
+      iree_min(dispatch_task->tile_count,
+               iree_task_post_batch_target_worker_count(post_batch));
+  dispatch_task->shard_count = (uint32_t)shard_count;
+  iree_atomic_store_int32(&dispatch_task->idle_shard_count, 0,
+                          iree_memory_order_relaxed);
 
   // Compute how many tiles we want each shard to reserve at a time from the
   // larger grid. A higher number reduces overhead and improves locality while
   // a lower number reduces maximum worst-case latency (coarser work stealing).
-  if (dispatch_task->tile_count <
-      worker_count * IREE_TASK_DISPATCH_MAX_TILES_PER_SHARD_RESERVATION) {
+  if (dispatch_task->tile_storage ||
+      dispatch_task->tile_count <
+          shard_count * IREE_TASK_DISPATCH_MAX_TILES_PER_SHARD_RESERVATION) {
     // Grid is small - allow it to be eagerly sliced up.
+    // Suspendable tiles each need a storage slot before they begin and are
+    // always reserved individually so that a shard out of slots holds no
+    // reserved tiles it cannot start.
     dispatch_task->tiles_per_reservation = 1;
   } else {
     dispatch_task->tiles_per_reservation =
@@ -623,17 +640,71 @@ void iree_task_dispatch_issue(iree_task_dispatch_t* dispatch_task,
   // Randomize starting worker.
   iree_host_size_t worker_offset = iree_task_post_batch_select_worker(
       post_batch, dispatch_task->header.affinity_set);
-  iree_host_size_t worker_index = worker_offset;
+
+  // Shards are placed on consecutive workers and topologies assign adjacent
+  // worker indices to cores sharing caches. Group the shards by the last-level
+  // cache domain of their worker and give each group a contiguous range of the
+  // grid sized proportionally to its shard count so that adjacent workgroups
+  // execute within the same cache domain.
+  iree_host_size_t partition_domains[IREE_TASK_DISPATCH_MAX_PARTITION_COUNT];
+  uint32_t partition_shard_counts[IREE_TASK_DISPATCH_MAX_PARTITION_COUNT];
+  uint8_t shard_partitions[IREE_TASK_EXECUTOR_MAX_WORKER_COUNT];
+  uint32_t partition_count = 0;
+  for (iree_host_size_t i = 0; i < shard_count; ++i) {
+    iree_host_size_t domain = iree_task_post_batch_worker_cache_domain(
+        post_batch, (worker_offset + i) % worker_count);
+    uint32_t partition_index = 0;
+    while (partition_index < partition_count &&
+           partition_domains[partition_index] != domain) {
+      ++partition_index;
+    }
+    if (partition_index == partition_count) {
+      if (partition_count < IREE_TASK_DISPATCH_MAX_PARTITION_COUNT) {
+        partition_domains[partition_count] = domain;
+        partition_shard_counts[partition_count] = 0;
+        ++partition_count;
+      } else {
+        // Out of partitions; share the last one.
+        partition_index = partition_count - 1;
+      }
+    }
+    ++partition_shard_counts[partition_index];
+    shard_partitions[i] = (uint8_t)partition_index;
+  }
+  dispatch_task->partition_count = partition_count;
+
+  // All tile storage slots start unoccupied.
+  if (dispatch_task->tile_storage) {
+    iree_atomic_store_int64(
+        &dispatch_task->tile_storage_free_mask,
+        (int64_t)(dispatch_task->tile_storage_count == 64
+                      ? UINT64_MAX
+                      : (1ull << dispatch_task->tile_storage_count) - 1),
+        iree_memory_order_relaxed);
+    iree_atomic_store_int64(&dispatch_task->tile_storage_suspended_mask, 0,
+                            iree_memory_order_relaxed);
+  }
+  uint32_t partition_shard_base = 0;
+  for (uint32_t i = 0; i < partition_count; ++i) {
+    iree_task_dispatch_partition_t* partition = &dispatch_task->partitions[i];
+    uint32_t tile_base = (uint32_t)((uint64_t)dispatch_task->tile_count *
+                                    partition_shard_base / shard_count);
+    partition_shard_base += partition_shard_counts[i];
+    iree_atomic_store_int32(&partition->tile_index, tile_base,
+                            iree_memory_order_relaxed);
+    partition->tile_end = (uint32_t)((uint64_t)dispatch_task->tile_count *
+                                     partition_shard_base / shard_count);
+  }
 
   for (iree_host_size_t i = 0; i < shard_count; ++i) {
     // Allocate and initialize the shard.
     iree_task_dispatch_shard_t* shard_task =
         iree_task_dispatch_shard_allocate(dispatch_task, shard_task_pool);
+    shard_task->partition_index = shard_partitions[i];
 
     // Enqueue on the worker selected for the task.
-    iree_task_post_batch_enqueue(post_batch, worker_index % worker_count,
+    iree_task_post_batch_enqueue(post_batch, (worker_offset + i) % worker_count,
                                  &shard_task->header);
-    ++worker_index;
   }
 
   // NOTE: the dispatch is not retired until all shards complete. Upon the last
@@ -693,6 +764,9 @@ void iree_task_dispatch_shard_initialize(iree_task_dispatch_t* dispatch_task,
   iree_task_initialize(IREE_TASK_TYPE_DISPATCH_SHARD,
                        dispatch_task->header.scope, &out_task->header);
   iree_task_set_completion_task(&out_task->header, &dispatch_task->header);
+  out_task->partition_index = 0;
+  out_task->parked_slot = -1;
+  memset(&out_task->statistics, 0, sizeof(out_task->statistics));
 }
 
 iree_task_dispatch_shard_t* iree_task_dispatch_shard_allocate(
@@ -709,6 +783,272 @@ iree_task_dispatch_shard_t* iree_task_dispatch_shard_allocate(
   return shard_task;
 }
 
+// Executes the tile described by |tile_context| and returns its result.
+static iree_status_t iree_task_dispatch_shard_execute_tile(
+    iree_task_dispatch_t* dispatch_task,
+    const iree_task_tile_context_t* tile_context,
+    iree_task_submission_t* pending_submission) {
+  IREE_TRACE_ZONE_BEGIN_NAMED(z_tile, "iree_task_dispatch_shard_execute_tile");
+  IREE_TRACE_ZONE_SET_COLOR(z_tile, iree_task_tile_to_color(tile_context));
+
+#ifndef NDEBUG
+  // NOTE: these are useful for debugging but dramatically increase our
+  // cost here; only enable if needed for tracking work distribution:
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z_tile, tile_context->workgroup_xyz[0]);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z_tile, tile_context->workgroup_xyz[1]);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z_tile, tile_context->workgroup_xyz[2]);
+  // IREE_TRACE_ZONE_APPEND_VALUE_I64(z_tile, (uint64_t)task->closure.fn);
+#endif  // !NDEBUG
+
+  iree_status_t status = dispatch_task->closure.fn(
+      dispatch_task->closure.user_context, tile_context, pending_submission);
+
+  IREE_TRACE_ZONE_END(z_tile);
+  return status;
+}
+
+// Converts a linear |tile_index| into the workgroup ID in |out_xyz|.
+static void iree_task_dispatch_tile_index_to_xyz(
+    const iree_task_dispatch_t* dispatch_task, uint32_t tile_index,
+    uint32_t out_xyz[3]) {
+  // TODO(benvanik): faster math here, especially knowing we pull off N
+  // sequential indices per reservation.
+  const uint32_t workgroup_count_x = dispatch_task->workgroup_count.value[0];
+  const uint32_t workgroup_count_y = dispatch_task->workgroup_count.value[1];
+  out_xyz[0] = tile_index % workgroup_count_x;
+  tile_index /= workgroup_count_x;
+  out_xyz[1] = tile_index % workgroup_count_y;
+  tile_index /= workgroup_count_y;
+  out_xyz[2] = tile_index;
+}
+
+// Reserves the next slice of tiles for |task| into [|out_tile_base|,
+// |out_tile_end|). Shards start with the partition assigned to their cache
+// domain and then help with the following partitions once theirs is exhausted;
+// |inout_partition_offset| tracks which partition the shard is on. Returns
+// false when all partitions have been exhausted.
+static bool iree_task_dispatch_shard_reserve_tiles(
+    iree_task_dispatch_shard_t* task, iree_task_dispatch_t* dispatch_task,
+    uint32_t* inout_partition_offset, uint32_t* out_tile_base,
+    uint32_t* out_tile_end) {
+  const uint32_t tiles_per_reservation = dispatch_task->tiles_per_reservation;
+  const uint32_t partition_count = dispatch_task->partition_count;
+  for (; *inout_partition_offset < partition_count;
+       ++*inout_partition_offset) {
+    iree_task_dispatch_partition_t* partition =
+        &dispatch_task->partitions[(task->partition_index +
+                                    *inout_partition_offset) %
+                                   partition_count];
+    // relaxed order because we only care about atomic increments, not about
+    // ordering of tile_index accesses w.r.t. other memory accesses.
+    uint32_t tile_base = iree_atomic_fetch_add_int32(
+        &partition->tile_index, tiles_per_reservation,
+        iree_memory_order_relaxed);
+    if (tile_base < partition->tile_end) {
+      *out_tile_base = tile_base;
+      *out_tile_end =
+          iree_min(tile_base + tiles_per_reservation, partition->tile_end);
+      return true;
+    }
+  }
+  return false;
+}
+
+// Claims any set bit in |mask| and returns its index or -1 if none are set.
+static int iree_task_dispatch_claim_any_slot(iree_atomic_int64_t* mask) {
+  int64_t value = iree_atomic_load_int64(mask, iree_memory_order_acquire);
+  while (value) {
+    int slot = iree_math_count_trailing_zeros_u64((uint64_t)value);
+    if (iree_atomic_compare_exchange_weak_int64(
+            mask, &value, value & ~(int64_t)(1ull << slot),
+            iree_memory_order_acq_rel, iree_memory_order_acquire)) {
+      return slot;
+    }
+  }
+  return -1;
+}
+
+// Tries to claim |slot| in |mask| and returns true if it was set.
+static bool iree_task_dispatch_claim_slot(iree_atomic_int64_t* mask, int slot) {
+  int64_t bit = (int64_t)(1ull << slot);
+  return (iree_atomic_fetch_and_int64(mask, ~bit, iree_memory_order_acq_rel) &
+          bit) != 0;
+}
+
+// Releases |slot| back into |mask|.
+static void iree_task_dispatch_release_slot(iree_atomic_int64_t* mask,
+                                            int slot) {
+  iree_atomic_fetch_or_int64(mask, (int64_t)(1ull << slot),
+                             iree_memory_order_acq_rel);
+}
+
+// Runs the tile occupying storage |slot| and handles the result: suspended
+// tiles keep their slot and are made available for resumption while completed
+// tiles free it. Returns false if the tile failed and the shard should abort.
+static bool iree_task_dispatch_shard_run_suspendable_tile(
+    iree_task_dispatch_t* dispatch_task, int slot,
+    iree_task_tile_context_t* tile_context,
+    iree_task_submission_t* pending_submission) {
+  iree_task_tile_storage_t* storage = &dispatch_task->tile_storage[slot];
+  memcpy(tile_context->workgroup_xyz, storage->workgroup_xyz,
+         sizeof(tile_context->workgroup_xyz));
+  tile_context->storage = storage;
+  iree_status_t status = iree_task_dispatch_shard_execute_tile(
+      dispatch_task, tile_context, pending_submission);
+  tile_context->storage = NULL;
+  if (iree_status_is_deferred(status)) {
+    iree_task_dispatch_release_slot(&dispatch_task->tile_storage_suspended_mask,
+                                    slot);
+    return true;
+  }
+  iree_task_dispatch_release_slot(&dispatch_task->tile_storage_free_mask, slot);
+  if (!iree_status_is_ok(status)) {
+    iree_task_try_set_status(&dispatch_task->status, status);
+    return false;
+  }
+  return true;
+}
+
+// Parks |task| on the wait source of a suspended tile of |dispatch_task| by
+// claiming its slot and enqueuing a wait task that readies the shard once the
+// wait resolves. The poller owns the wait from then on and the shard must not
+// be touched by the caller. Returns false if there were no suspended tiles
+// left to claim.
+static bool iree_task_dispatch_shard_park(
+    iree_task_dispatch_shard_t* task, iree_task_dispatch_t* dispatch_task,
+    iree_task_submission_t* pending_submission) {
+  uint64_t suspended_mask = (uint64_t)iree_atomic_load_int64(
+      &dispatch_task->tile_storage_suspended_mask, iree_memory_order_acquire);
+  for (; suspended_mask; suspended_mask &= suspended_mask - 1) {
+    int slot = iree_math_count_trailing_zeros_u64(suspended_mask);
+    if (!iree_task_dispatch_claim_slot(
+            &dispatch_task->tile_storage_suspended_mask, slot)) {
+      continue;  // claimed by another shard
+    }
+    task->parked_slot = slot;
+    iree_task_wait_initialize(task->header.scope,
+                              dispatch_task->tile_storage[slot].wait_source,
+                              IREE_TIME_INFINITE_FUTURE, &task->park_wait);
+    iree_task_set_completion_task(&task->park_wait.header, &task->header);
+    iree_task_submission_enqueue(pending_submission, &task->park_wait.header);
+    return true;
+  }
+  return false;
+}
+
+// Executes tiles of a dispatch with tile storage, resuming suspended tiles
+// (from any shard) whose waits have resolved and starting new tiles while
+// storage slots are available.
+//
+// Returns false if the shard could make no progress while tiles remain and was
+// parked on the wait source of a suspended tile: the shard will be rescheduled
+// on any worker once the wait resolves and must not be retired. Returns true
+// once there are no more tiles this shard can start or resume or a tile has
+// failed. Occupied slots not in the suspended set are held by other shards
+// (running or parked) that will continue the remaining work.
+static bool iree_task_dispatch_shard_execute_suspendable(
+    iree_task_dispatch_shard_t* task, iree_task_dispatch_t* dispatch_task,
+    iree_task_tile_context_t* tile_context,
+    iree_task_submission_t* pending_submission, bool* out_any_tiles_executed) {
+  uint32_t partition_offset = 0;
+  bool tiles_remaining = true;
+
+  // Return the slot the shard was parked on (if any) to the suspended set so
+  // that it is resumed below along with any others that have resolved.
+  if (task->parked_slot >= 0) {
+    iree_task_dispatch_release_slot(&dispatch_task->tile_storage_suspended_mask,
+                                    task->parked_slot);
+    task->parked_slot = -1;
+  }
+
+  while (true) {
+    bool made_progress = false;
+
+    // Resume suspended tiles whose waits have resolved. Doing this before
+    // starting new tiles frees up storage and releases tiles waiting on them.
+    uint64_t suspended_mask = (uint64_t)iree_atomic_load_int64(
+        &dispatch_task->tile_storage_suspended_mask,
+        iree_memory_order_acquire);
+    for (; suspended_mask; suspended_mask &= suspended_mask - 1) {
+      int slot = iree_math_count_trailing_zeros_u64(suspended_mask);
+      if (!iree_task_dispatch_claim_slot(
+              &dispatch_task->tile_storage_suspended_mask, slot)) {
+        continue;  // resumed by another shard
+      }
+      iree_task_tile_storage_t* storage = &dispatch_task->tile_storage[slot];
+      iree_status_code_t wait_status_code = IREE_STATUS_OK;
+      iree_status_t status =
+          iree_wait_source_query(storage->wait_source, &wait_status_code);
+      if (iree_status_is_ok(status) &&
+          wait_status_code == IREE_STATUS_DEFERRED) {
+        // Still waiting; leave it for later.
+        iree_task_dispatch_release_slot(
+            &dispatch_task->tile_storage_suspended_mask, slot);
+        continue;
+      } else if (iree_status_is_ok(status) &&
+                 wait_status_code != IREE_STATUS_OK) {
+        status = iree_status_from_code(wait_status_code);
+      }
+      if (!iree_status_is_ok(status)) {
+        // The wait failed and the tile cannot be resumed.
+        iree_task_dispatch_release_slot(&dispatch_task->tile_storage_free_mask,
+                                        slot);
+        iree_task_try_set_status(&dispatch_task->status, status);
+        return true;
+      }
+      storage->wait_source = iree_wait_source_immediate();
+      made_progress = true;
+      *out_any_tiles_executed = true;
+      if (!iree_task_dispatch_shard_run_suspendable_tile(
+              dispatch_task, slot, tile_context, pending_submission)) {
+        return true;
+      }
+    }
+
+    // Start new tiles while there is storage for them.
+    while (tiles_remaining) {
+      int slot = iree_task_dispatch_claim_any_slot(
+          &dispatch_task->tile_storage_free_mask);
+      if (slot < 0) break;  // all storage occupied by suspended tiles
+      uint32_t tile_base = 0;
+      uint32_t tile_end = 0;
+      if (!iree_task_dispatch_shard_reserve_tiles(
+              task, dispatch_task, &partition_offset, &tile_base, &tile_end)) {
+        iree_task_dispatch_release_slot(&dispatch_task->tile_storage_free_mask,
+                                        slot);
+        tiles_remaining = false;
+        break;
+      }
+      iree_task_tile_storage_t* storage = &dispatch_task->tile_storage[slot];
+      storage->resume_point = 0;
+      storage->wait_source = iree_wait_source_immediate();
+      iree_task_dispatch_tile_index_to_xyz(dispatch_task, tile_base,
+                                           storage->workgroup_xyz);
+      made_progress = true;
+      *out_any_tiles_executed = true;
+      if (!iree_task_dispatch_shard_run_suspendable_tile(
+              dispatch_task, slot, tile_context, pending_submission)) {
+        return true;
+      }
+    }
+
+    // Once no new tiles remain the shard is done when no suspended tiles are
+    // left. Tiles that are currently being resumed by other shards are handled
+    // by those shards: they will not complete until the suspended set is empty.
+    if (!tiles_remaining &&
+        iree_atomic_load_int64(&dispatch_task->tile_storage_suspended_mask,
+                               iree_memory_order_acquire) == 0) {
+      return true;
+    }
+    if (!made_progress) {
+      // Nothing could be resumed or started: wait on a suspended tile instead
+      // of spinning through the executor until something resolves.
+      return !iree_task_dispatch_shard_park(task, dispatch_task,
+                                            pending_submission);
+    }
+  }
+}
+
 void iree_task_dispatch_shard_execute(
     iree_task_dispatch_shard_t* task, iree_cpu_processor_id_t processor_id,
     uint32_t worker_id, iree_byte_span_t worker_local_memory,
@@ -745,61 +1085,46 @@ void iree_task_dispatch_shard_execute(
          sizeof(tile_context.workgroup_size));
   memcpy(&tile_context.workgroup_count, dispatch_task->workgroup_count.value,
          sizeof(tile_context.workgroup_count));
-  uint32_t workgroup_count_x = tile_context.workgroup_count[0];
-  uint32_t workgroup_count_y = tile_context.workgroup_count[1];
   tile_context.worker_id = worker_id;
   tile_context.local_memory = local_memory;
+  tile_context.storage = NULL;
 
-  // We perform all our shard statistics work locally here and only push back to
-  // the dispatch at the end; this avoids contention from each shard trying to
-  // update the statistics together.
-  iree_task_dispatch_statistics_t shard_statistics;
-  memset(&shard_statistics, 0, sizeof(shard_statistics));
-  tile_context.statistics = &shard_statistics;
+  // We perform all our shard statistics work on the shard and only push back to
+  // the dispatch once it completes; this avoids contention from each shard
+  // trying to update the statistics together.
+  tile_context.statistics = &task->statistics;
 
   // Hint as to which processor we are running on.
   tile_context.processor_id = processor_id;
 
+  bool any_tiles_executed = false;
+  if (dispatch_task->tile_storage) {
+    // Tiles may suspend and we may need to come back to them later.
+    if (!iree_task_dispatch_shard_execute_suspendable(
+            task, dispatch_task, &tile_context, pending_submission,
+            &any_tiles_executed)) {
+      // Parked on a suspended tile; the shard will be rescheduled on any
+      // worker once the wait resolves and continue where it left off.
+      IREE_TRACE_ZONE_APPEND_TEXT(z0, "park");
+      IREE_TRACE_ZONE_END(z0);
+      return;
+    }
+    goto end_shard;
+  }
+
   // Loop over all tiles until they are all processed.
-  const uint32_t tile_count = dispatch_task->tile_count;
-  const uint32_t tiles_per_reservation = dispatch_task->tiles_per_reservation;
-  // relaxed order because we only care about atomic increments, not about
-  // ordering of tile_index accesses w.r.t. other memory accesses.
-  uint32_t tile_base = iree_atomic_fetch_add_int32(&dispatch_task->tile_index,
-                                                   tiles_per_reservation,
-                                                   iree_memory_order_relaxed);
-  while (tile_base < tile_count) {
-    const uint32_t tile_range =
-        iree_min(tile_base + tiles_per_reservation, tile_count);
-    for (uint32_t tile_index = tile_base; tile_index < tile_range;
+  uint32_t partition_offset = 0;
+  uint32_t tile_base = 0;
+  uint32_t tile_end = 0;
+  while (iree_task_dispatch_shard_reserve_tiles(
+      task, dispatch_task, &partition_offset, &tile_base, &tile_end)) {
+    any_tiles_executed = true;
+    for (uint32_t tile_index = tile_base; tile_index < tile_end;
          ++tile_index) {
-      // TODO(benvanik): faster math here, especially knowing we pull off N
-      // sequential indices per reservation.
-      uint32_t tile_i = tile_index;
-      tile_context.workgroup_xyz[0] = tile_i % workgroup_count_x;
-      tile_i /= workgroup_count_x;
-      tile_context.workgroup_xyz[1] = tile_i % workgroup_count_y;
-      tile_i /= workgroup_count_y;
-      tile_context.workgroup_xyz[2] = tile_i;
-
-      IREE_TRACE_ZONE_BEGIN_NAMED(z_tile,
-                                  "iree_task_dispatch_shard_execute_tile");
-      IREE_TRACE_ZONE_SET_COLOR(z_tile, iree_task_tile_to_color(&tile_context));
-
-#ifndef NDEBUG
-      // NOTE: these are useful for debugging but dramatically increase our
-      // cost here; only enable if needed for tracking work distribution:
-      IREE_TRACE_ZONE_APPEND_VALUE_I64(z_tile, tile_context.workgroup_xyz[0]);
-      IREE_TRACE_ZONE_APPEND_VALUE_I64(z_tile, tile_context.workgroup_xyz[1]);
-      IREE_TRACE_ZONE_APPEND_VALUE_I64(z_tile, tile_context.workgroup_xyz[2]);
-      // IREE_TRACE_ZONE_APPEND_VALUE_I64(z_tile, (uint64_t)task->closure.fn);
-#endif  // !NDEBUG
-
-      iree_status_t status =
-          dispatch_task->closure.fn(dispatch_task->closure.user_context,
-                                    &tile_context, pending_submission);
-
-      IREE_TRACE_ZONE_END(z_tile);
+      iree_task_dispatch_tile_index_to_xyz(dispatch_task, tile_index,
+                                           tile_context.workgroup_xyz);
+      iree_status_t status = iree_task_dispatch_shard_execute_tile(
+          dispatch_task, &tile_context, pending_submission);
 
       // If any tile fails we bail early from the loop. This doesn't match
       // what an accelerator would do but saves some unneeded work.
@@ -810,21 +1135,24 @@ void iree_task_dispatch_shard_execute(
       if (!iree_status_is_ok(status)) {
         // Propagate failures to the dispatch task.
         iree_task_try_set_status(&dispatch_task->status, status);
-        goto abort_shard;  // out of the while-for nest
+        goto end_shard;  // out of the while-for nest
       }
     }
+  }
 
-    // Try to grab the next slice of tiles.
-    tile_base = iree_atomic_fetch_add_int32(&dispatch_task->tile_index,
-                                            tiles_per_reservation,
-                                            iree_memory_order_relaxed);
+end_shard:
+  if (!any_tiles_executed) {
+    // Other shards finished the whole grid before we got here; waking this
+    // worker was wasted. Retirement order makes this visible to the executor
+    // when it retires the dispatch.
+    iree_atomic_fetch_add_int32(&dispatch_task->idle_shard_count, 1,
+                                iree_memory_order_relaxed);
   }
-abort_shard:
 
   // Push aggregate statistics up to the dispatch.
   // Note that we may have partial information here if we errored out of the
   // loop but that's still useful to know.
-  iree_task_dispatch_statistics_merge(&shard_statistics,
+  iree_task_dispatch_statistics_merge(&task->statistics,
                                       &dispatch_task->statistics);
 
   // NOTE: even if an error was hit we retire OK - the error has already been
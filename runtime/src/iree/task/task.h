@@ -17,6 +17,7 @@
 #include "iree/base/internal/cpu.h"
 #include "iree/base/internal/synchronization.h"
 #include "iree/task/affinity_set.h"
+#include "iree/task/tuning.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -505,13 +506,31 @@ void iree_task_dispatch_statistics_merge(
     const iree_task_dispatch_statistics_t* source,
     iree_task_dispatch_statistics_t* target);
 
+// Storage for a tile that may suspend and later be resumed.
+//
+// Dispatches that opt into suspendable tiles via
+// iree_task_dispatch_set_tile_storage provide a fixed number of storage slots.
+// Each tile that begins executing occupies a slot until it completes. A tile
+// that suspends (see iree_task_tile_suspend) keeps its slot and may be resumed
+// by any worker once its wait source resolves; the dispatch function is called
+// again with the same storage and is expected to continue from |resume_point|.
 typedef struct iree_task_tile_storage_t {
-  // TODO(benvanik): coroutine storage.
-  // Ideally we'll be able to have a fixed coroutine storage size per dispatch
-  // (via @llvm.coro.size) such that we can preallocate all of the storage for
-  // a dispatch in one shot. If we need to do dynamic allocation we will need a
-  // ringbuffer or other kind of pool to allocate from on-demand.
-  uint32_t reserved;
+  // Coroutine frame of the tile preserved across suspensions.
+  // Ideally this is a fixed size per dispatch function (via @llvm.coro.size)
+  // such that all storage for a dispatch can be preallocated in one shot by the
+  // owner of the dispatch. Contents are undefined upon first entry.
+  iree_byte_span_t frame;
+
+  // Opaque resume point recorded by the tile when it suspends.
+  // 0 upon first entry into the tile.
+  uint32_t resume_point;
+
+  // Workgroup ID of the tile occupying the storage.
+  uint32_t workgroup_xyz[3];
+
+  // Wait source that must resolve before the suspended tile is resumed.
+  // Immediate if the tile only yielded to allow other tiles to make progress.
+  iree_wait_source_t wait_source;
 } iree_task_tile_storage_t;
 
 // Per-tile context provided to each dispatch function invocation in the grid.
@@ -546,8 +565,34 @@ typedef iree_alignas(iree_max_align_t) struct {
 
   // Shared statistics counters for the dispatch shard.
   iree_task_dispatch_statistics_t* statistics;
+
+  // Storage of the tile if the dispatch supports suspending tiles or NULL.
+  // Worker local memory is not preserved across suspensions and any state that
+  // must survive needs to be kept in the storage frame.
+  iree_task_tile_storage_t* storage;
 } iree_task_tile_context_t;
 
+// Suspends the tile described by |tile_context| until |wait_source| resolves.
+// The tile must return the result of this call from the dispatch function and
+// will be invoked again with the same storage and |resume_point| once resumed,
+// possibly on another worker. Passing an immediate wait source yields the tile
+// to allow other tiles (such as those it is waiting on at a workgroup barrier)
+// to make progress.
+//
+// Only valid when the dispatch has tile storage; otherwise fails with
+// IREE_STATUS_FAILED_PRECONDITION.
+static inline iree_status_t iree_task_tile_suspend(
+    const iree_task_tile_context_t* tile_context, uint32_t resume_point,
+    iree_wait_source_t wait_source) {
+  if (IREE_UNLIKELY(!tile_context->storage)) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "dispatch does not support suspending tiles");
+  }
+  tile_context->storage->resume_point = resume_point;
+  tile_context->storage->wait_source = wait_source;
+  return iree_status_from_code(IREE_STATUS_DEFERRED);
+}
+
 typedef struct iree_task_dispatch_t iree_task_dispatch_t;
 
 //==============================================================================
@@ -601,6 +646,22 @@ static inline iree_task_dispatch_closure_t iree_task_make_dispatch_closure(
 //     -> dispatch_shard for core 1, processes [2-3, 1, 1]
 //     -> dispatch_shard for core 2, processes [4-5, 1, 1]
 //   completion_task run after all shards complete
+//
+// A contiguous range of the dispatch tile grid that shards placed on workers
+// sharing a last-level cache reserve tiles from before moving on to others.
+typedef struct iree_task_dispatch_partition_t {
+  // The tail tile index; the next reservation will start from here.
+  // This is used by shards to slice off the work to perform in their inner
+  // loop.
+  iree_atomic_int32_t tile_index;
+  // Exclusive end of the tile range of the partition.
+  uint32_t tile_end;
+  // Padding to ensure shards in different cache domains reserving tiles from
+  // their own partitions do not contend on the same cache line.
+  uint8_t reserved[iree_hardware_destructive_interference_size -
+                   sizeof(iree_atomic_int32_t) - sizeof(uint32_t)];
+} iree_task_dispatch_partition_t;
+
 typedef iree_alignas(iree_max_align_t) struct iree_task_dispatch_t {
   // Task header: implementation detail, do not use.
   iree_task_t header;
@@ -638,20 +699,45 @@ typedef iree_alignas(iree_max_align_t) struct iree_task_dispatch_t {
   // Statistics storage used for aggregating counters across all shards.
   iree_task_dispatch_statistics_t statistics;
 
-  // The total number of tiles in the dispatch bounding tile_index.
+  // The total number of tiles in the dispatch across all partitions.
   uint32_t tile_count;
 
+  // Number of shards the dispatch was issued as.
+  uint32_t shard_count;
+
+  // Number of shards that found no tiles left to execute as all had already
+  // been reserved by other shards. Used by the executor to scale down the
+  // number of workers woken for dispatches of similar width.
+  iree_atomic_int32_t idle_shard_count;
+
   // Maximum number of tiles to fetch per tile reservation from the grid.
   // Bounded by IREE_TASK_DISPATCH_MAX_TILES_PER_SHARD_RESERVATION and a
   // reasonable number chosen based on the tile and shard counts.
   uint32_t tiles_per_reservation;
 
-  // The tail tile index; the next reservation will start from here.
-  // This is used by shards to slice off the work to perform in their inner
-  // loop. Ideally we'd have no destructive interference with other shared data
-  // in this structure but the shared parts (status/statistics) are updated once
-  // per shard instead of once per slice and are less of a concern.
-  iree_atomic_int32_t tile_index;
+  // Number of valid entries in |partitions|.
+  uint32_t partition_count;
+
+  // Partitions of the tile grid in ascending tile order. Each shard starts
+  // reserving from the partition of its cache domain and then proceeds to the
+  // following partitions (wrapping) until all tiles are reserved. Ideally we'd
+  // have no destructive interference with other shared data in this structure
+  // but the shared parts (status/statistics) are updated once per shard
+  // instead of once per slice and are less of a concern.
+  iree_task_dispatch_partition_t
+      partitions[IREE_TASK_DISPATCH_MAX_PARTITION_COUNT];
+
+  // Optional storage slots for suspendable tiles; see
+  // iree_task_dispatch_set_tile_storage.
+  iree_task_tile_storage_t* tile_storage;
+  uint32_t tile_storage_count;
+
+  // Bitmask of |tile_storage| slots not occupied by any tile.
+  iree_atomic_int64_t tile_storage_free_mask;
+
+  // Bitmask of |tile_storage| slots occupied by suspended tiles that are not
+  // currently being resumed by any shard.
+  iree_atomic_int64_t tile_storage_suspended_mask;
 
   // Incrementing process-lifetime dispatch identifier.
   IREE_TRACE(int64_t dispatch_id;)
@@ -668,6 +754,19 @@ void iree_task_dispatch_initialize_indirect(
     const uint32_t workgroup_size[3], const uint32_t* workgroup_count_ptr,
     iree_task_dispatch_t* out_task);
 
+// Allows tiles of the dispatch |task| to suspend by providing
+// |tile_storage_count| storage slots in |tile_storage| (at most
+// IREE_TASK_DISPATCH_MAX_TILE_STORAGE_COUNT). Callers must initialize the
+// frame of each slot. Storage must remain valid until the dispatch retires.
+//
+// At most |tile_storage_count| tiles may be in flight at a time: once all
+// slots are occupied by suspended tiles no new tiles will begin until one
+// completes. Tiles that suspend waiting on each other (such as at workgroup
+// barriers) must fit within the provided slots.
+void iree_task_dispatch_set_tile_storage(iree_task_dispatch_t* task,
+                                         iree_task_tile_storage_t* tile_storage,
+                                         uint32_t tile_storage_count);
+
 //==============================================================================
 // IREE_TASK_TYPE_DISPATCH_SHARD
 //==============================================================================
@@ -676,6 +775,26 @@ typedef iree_alignas(iree_max_align_t) struct {
   // Task header: implementation detail, do not use.
   iree_task_t header;
 
+  // Index of the partition in the parent dispatch the shard starts reserving
+  // tiles from.
+  uint32_t partition_index;
+
+  // Tile storage slot of the parent dispatch the shard is parked on or -1.
+  // When a shard of a dispatch with suspendable tiles can make no progress it
+  // claims an unresolved suspended tile and waits on its wait source via
+  // |park_wait| instead of being rescheduled immediately. The slot is claimed
+  // so that no other shard resumes or parks on it while parked.
+  int32_t parked_slot;
+
+  // Statistics accumulated across all executions of the shard. Shards of
+  // dispatches with suspendable tiles may execute multiple times and only
+  // merge into the dispatch once when they complete.
+  iree_task_dispatch_statistics_t statistics;
+
+  // Wait task on the wait source of |parked_slot| with the shard as its
+  // completion task. Only initialized while the shard is parked.
+  iree_task_wait_t park_wait;
+
   // NOTE: the parent dispatch task this shard is applied to is in the
   // header.completion_task field.
 } iree_task_dispatch_shard_t;
@@ -4,9 +4,14 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+#include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <cstdio>
+#include <cstring>
 #include <memory>
+#include <thread>
+#include <vector>
 
 #include "iree/base/api.h"
 #include "iree/task/submission.h"
@@ -214,4 +219,222 @@ TEST_F(TaskDispatchTest, IssueFailureChained) {
               StatusIs(StatusCode::kDataLoss));
 }
 
+// Initializes |slots| with frames of |frame_size| bytes each allocated from
+// |frames|.
+static void InitializeTileStorage(std::vector<iree_task_tile_storage_t>& slots,
+                                  std::vector<uint8_t>& frames,
+                                  iree_host_size_t frame_size) {
+  frames.resize(slots.size() * frame_size);
+  for (iree_host_size_t i = 0; i < slots.size(); ++i) {
+    std::memset(&slots[i], 0, sizeof(slots[i]));
+    slots[i].frame = iree_make_byte_span(&frames[i * frame_size], frame_size);
+  }
+}
+
+// Tests tiles that synchronize at a workgroup barrier by suspending until all
+// tiles in the dispatch have arrived.
+TEST_F(TaskDispatchTest, SuspendAtBarrier) {
+  IREE_TRACE_SCOPE();
+
+  static const uint32_t kWorkgroupSize[3] = {1, 1, 1};
+  static const uint32_t kWorkgroupCount[3] = {8, 4, 1};
+  static const int32_t kTileCount = 8 * 4;
+
+  struct Barrier {
+    iree_atomic_int32_t arrived_count;
+    iree_atomic_int32_t early_departures;
+    GridCoverage* coverage;
+  };
+  GridCoverage coverage(kWorkgroupCount);
+  Barrier barrier;
+  barrier.arrived_count = IREE_ATOMIC_VAR_INIT(0);
+  barrier.early_departures = IREE_ATOMIC_VAR_INIT(0);
+  barrier.coverage = &coverage;
+
+  auto tile = [](void* user_context,
+                 const iree_task_tile_context_t* tile_context,
+                 iree_task_submission_t* pending_submission) -> iree_status_t {
+    Barrier* barrier = (Barrier*)user_context;
+    iree_task_tile_storage_t* storage = tile_context->storage;
+    uint32_t* frame = (uint32_t*)storage->frame.data;
+    uint32_t linear_id =
+        tile_context->workgroup_xyz[1] * tile_context->workgroup_count[0] +
+        tile_context->workgroup_xyz[0];
+    switch (storage->resume_point) {
+      case 0:
+        // Stash some state in the frame to verify it is preserved.
+        *frame = linear_id;
+        iree_atomic_fetch_add_int32(&barrier->arrived_count, 1,
+                                    iree_memory_order_acq_rel);
+        return iree_task_tile_suspend(tile_context, /*resume_point=*/1,
+                                      iree_wait_source_immediate());
+      case 1:
+        if (iree_atomic_load_int32(&barrier->arrived_count,
+                                   iree_memory_order_acquire) < kTileCount) {
+          return iree_task_tile_suspend(tile_context, /*resume_point=*/1,
+                                        iree_wait_source_immediate());
+        }
+        if (*frame != linear_id) {
+          iree_atomic_fetch_add_int32(&barrier->early_departures, 1,
+                                      iree_memory_order_relaxed);
+        }
+        return GridCoverage::Tile(barrier->coverage, tile_context,
+                                  pending_submission);
+      default:
+        return iree_make_status(IREE_STATUS_INTERNAL, "bad resume point");
+    }
+  };
+
+  std::vector<iree_task_tile_storage_t> slots(kTileCount);
+  std::vector<uint8_t> frames;
+  InitializeTileStorage(slots, frames, sizeof(uint32_t));
+
+  iree_task_dispatch_t task;
+  iree_task_dispatch_initialize(&scope_,
+                                iree_task_make_dispatch_closure(tile, &barrier),
+                                kWorkgroupSize, kWorkgroupCount, &task);
+  iree_task_dispatch_set_tile_storage(&task, slots.data(),
+                                      (uint32_t)slots.size());
+  IREE_ASSERT_OK(SubmitTasksAndWaitIdle(&task.header, &task.header));
+  IREE_EXPECT_OK(iree_task_scope_consume_status(&scope_));
+  EXPECT_EQ(0, iree_atomic_load_int32(&barrier.early_departures,
+                                      iree_memory_order_relaxed));
+  EXPECT_TRUE(coverage.Verify());
+}
+
+// Tests tiles suspending on waits with fewer storage slots than tiles.
+TEST_F(TaskDispatchTest, SuspendOnWait) {
+  IREE_TRACE_SCOPE();
+
+  static const uint32_t kWorkgroupSize[3] = {1, 1, 1};
+  static const uint32_t kWorkgroupCount[3] = {5, 3, 2};
+
+  GridCoverage coverage(kWorkgroupCount);
+  auto tile = [](void* user_context,
+                 const iree_task_tile_context_t* tile_context,
+                 iree_task_submission_t* pending_submission) -> iree_status_t {
+    if (tile_context->storage->resume_point == 0) {
+      return iree_task_tile_suspend(
+          tile_context, /*resume_point=*/1,
+          iree_wait_source_delay(iree_time_now() + 100000 /*100us*/));
+    }
+    return GridCoverage::Tile(user_context, tile_context, pending_submission);
+  };
+
+  std::vector<iree_task_tile_storage_t> slots(4);
+  std::vector<uint8_t> frames;
+  InitializeTileStorage(slots, frames, 0);
+
+  iree_task_dispatch_t task;
+  iree_task_dispatch_initialize(
+      &scope_, iree_task_make_dispatch_closure(tile, (void*)&coverage),
+      kWorkgroupSize, kWorkgroupCount, &task);
+  iree_task_dispatch_set_tile_storage(&task, slots.data(),
+                                      (uint32_t)slots.size());
+  IREE_ASSERT_OK(SubmitTasksAndWaitIdle(&task.header, &task.header));
+  IREE_EXPECT_OK(iree_task_scope_consume_status(&scope_));
+  EXPECT_TRUE(coverage.Verify());
+}
+
+// Wait source wrapping an event that counts how many times it is queried.
+struct CountingEventSource {
+  iree_event_t event;
+  std::atomic<int> query_count = {0};
+
+  iree_wait_source_t Await() {
+    iree_wait_source_t wait_source;
+    wait_source.self = this;
+    wait_source.data = 0;
+    wait_source.ctl = Ctl;
+    return wait_source;
+  }
+
+  static iree_status_t Ctl(iree_wait_source_t wait_source,
+                           iree_wait_source_command_t command,
+                           const void* params, void** inout_ptr) {
+    auto* source = reinterpret_cast<CountingEventSource*>(wait_source.self);
+    if (command == IREE_WAIT_SOURCE_COMMAND_QUERY) ++source->query_count;
+    iree_wait_source_t event_source = iree_event_await(&source->event);
+    return event_source.ctl(event_source, command, params, inout_ptr);
+  }
+};
+
+// Tests that shards with no runnable tiles park on the wait of a suspended tile
+// instead of repeatedly polling it until it resolves.
+TEST_F(TaskDispatchTest, SuspendParksOnWait) {
+  IREE_TRACE_SCOPE();
+
+  static const uint32_t kWorkgroupSize[3] = {1, 1, 1};
+  static const uint32_t kWorkgroupCount[3] = {4, 1, 1};
+
+  struct State {
+    CountingEventSource source;
+    GridCoverage* coverage;
+  };
+  GridCoverage coverage(kWorkgroupCount);
+  State state;
+  state.coverage = &coverage;
+  IREE_ASSERT_OK(iree_event_initialize(/*initial_state=*/false,
+                                       &state.source.event));
+
+  auto tile = [](void* user_context,
+                 const iree_task_tile_context_t* tile_context,
+                 iree_task_submission_t* pending_submission) -> iree_status_t {
+    State* state = (State*)user_context;
+    if (tile_context->storage->resume_point == 0) {
+      return iree_task_tile_suspend(tile_context, /*resume_point=*/1,
+                                    state->source.Await());
+    }
+    return GridCoverage::Tile(state->coverage, tile_context,
+                              pending_submission);
+  };
+
+  std::vector<iree_task_tile_storage_t> slots(4);
+  std::vector<uint8_t> frames;
+  InitializeTileStorage(slots, frames, 0);
+
+  iree_task_dispatch_t task;
+  iree_task_dispatch_initialize(&scope_,
+                                iree_task_make_dispatch_closure(tile, &state),
+                                kWorkgroupSize, kWorkgroupCount, &task);
+  iree_task_dispatch_set_tile_storage(&task, slots.data(),
+                                      (uint32_t)slots.size());
+  std::thread signaler([&]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    iree_event_set(&state.source.event);
+  });
+  IREE_ASSERT_OK(SubmitTasksAndWaitIdle(&task.header, &task.header));
+  signaler.join();
+  IREE_EXPECT_OK(iree_task_scope_consume_status(&scope_));
+  EXPECT_TRUE(coverage.Verify());
+
+  // Each tile is queried a bounded number of times by the shards and poller
+  // regardless of how long the wait takes; polling would query continuously.
+  EXPECT_LT(state.source.query_count, 100);
+  iree_event_deinitialize(&state.source.event);
+}
+
+// Tests that suspending a tile of a dispatch without tile storage fails.
+TEST_F(TaskDispatchTest, SuspendWithoutStorage) {
+  IREE_TRACE_SCOPE();
+
+  const uint32_t kWorkgroupSize[3] = {1, 1, 1};
+  const uint32_t kWorkgroupCount[3] = {4, 1, 1};
+
+  auto tile = [](void* user_context,
+                 const iree_task_tile_context_t* tile_context,
+                 iree_task_submission_t* pending_submission) -> iree_status_t {
+    return iree_task_tile_suspend(tile_context, /*resume_point=*/1,
+                                  iree_wait_source_immediate());
+  };
+
+  iree_task_dispatch_t task;
+  iree_task_dispatch_initialize(&scope_,
+                                iree_task_make_dispatch_closure(tile, NULL),
+                                kWorkgroupSize, kWorkgroupCount, &task);
+  IREE_ASSERT_OK(SubmitTasksAndWaitIdle(&task.header, &task.header));
+  EXPECT_THAT(Status(iree_task_scope_consume_status(&scope_)),
+              StatusIs(StatusCode::kFailedPrecondition));
+}
+
 }  // namespace
@@ -19,6 +19,8 @@ void iree_task_topology_group_initialize(
            group_index);
   iree_thread_affinity_set_any(&out_group->ideal_thread_affinity);
   out_group->constructive_sharing_mask = IREE_TASK_TOPOLOGY_GROUP_MASK_ALL;
+  out_group->llc_sharing_mask = IREE_TASK_TOPOLOGY_GROUP_MASK_ALL;
+  out_group->node_sharing_mask = IREE_TASK_TOPOLOGY_GROUP_MASK_ALL;
 }
 
 void iree_task_topology_initialize(iree_task_topology_t* out_topology) {
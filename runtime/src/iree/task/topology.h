@@ -74,6 +74,15 @@ typedef struct iree_task_topology_group_t {
   // workers in a group all share an L2 cache then the groups indicated here may
   // all share the same L3 cache.
   iree_task_topology_group_mask_t constructive_sharing_mask;
+
+  // A bitmask of other group indices that share the last-level cache with this
+  // group (L3, or the L3 of a single chiplet/CCX on CPUs with many L3 domains).
+  // Always a superset of constructive_sharing_mask.
+  iree_task_topology_group_mask_t llc_sharing_mask;
+
+  // A bitmask of other group indices that are on the same NUMA node as this
+  // group. Always a superset of llc_sharing_mask.
+  iree_task_topology_group_mask_t node_sharing_mask;
 } iree_task_topology_group_t;
 
 // Initializes |out_group| with a |group_index| derived name.
@@ -147,16 +147,41 @@ static uint64_t iree_task_topology_calculate_cache_bits(
 }
 
 // Constructs a constructive sharing mask for all *processors* that share the
-// same cache as the specified |processor|.
+// same L1/L2 cache as the specified |processor|.
 static uint64_t iree_task_topology_calculate_constructive_sharing_mask(
     const struct cpuinfo_processor* processor) {
   uint64_t mask = 0;
   mask |= iree_task_topology_calculate_cache_bits(processor->cache.l1i);
   mask |= iree_task_topology_calculate_cache_bits(processor->cache.l1d);
   mask |= iree_task_topology_calculate_cache_bits(processor->cache.l2);
-  // TODO(benvanik): include L3 here too (for systems that have it)? Or use L3
-  // info purely for distribution and focus the group mask on lower-latency
-  // caches?
+  return mask;
+}
+
+// Constructs a sharing mask for all *processors* that share the last-level
+// cache with the specified |processor|. On chiplet CPUs cpuinfo reports one L3
+// per CCX so this naturally separates the CCXs.
+static uint64_t iree_task_topology_calculate_llc_sharing_mask(
+    const struct cpuinfo_processor* processor) {
+  uint64_t mask =
+      iree_task_topology_calculate_constructive_sharing_mask(processor);
+  mask |= iree_task_topology_calculate_cache_bits(processor->cache.l3);
+  mask |= iree_task_topology_calculate_cache_bits(processor->cache.l4);
+  return mask;
+}
+
+// Constructs a sharing mask for all *processors* in the same node (cpuinfo
+// cluster) as the specified |processor|.
+static uint64_t iree_task_topology_calculate_node_sharing_mask(
+    const struct cpuinfo_processor* processor) {
+  uint64_t mask = iree_task_topology_calculate_llc_sharing_mask(processor);
+  const struct cpuinfo_cluster* cluster = processor->cluster;
+  for (uint32_t processor_i = 0; processor_i < cluster->processor_count;
+       ++processor_i) {
+    uint32_t i = cluster->processor_start + processor_i;
+    if (i < IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT) {
+      mask |= 1ull << i;
+    }
+  }
   return mask;
 }
 
@@ -178,33 +203,48 @@ static void iree_task_topology_group_initialize_from_core(
       processor, &out_group->ideal_thread_affinity);
 }
 
-// Fixes constructive_sharing_mask values such that they represent other chosen
-// topology groups instead of processor indices. We do this so that code using
-// the topology groups doesn't need to know anything about which physical
-// processor IDs a particular group is mapped to.
+// Returns a mask of the groups in |topology| other than |group_index| that are
+// assigned to processors in |processor_mask|.
+static iree_task_topology_group_mask_t
+iree_task_topology_calculate_group_mask_from_processors(
+    const iree_task_topology_t* topology, iree_host_size_t group_index,
+    uint64_t processor_mask) {
+  iree_task_topology_group_mask_t group_mask = 0;
+  for (iree_host_size_t j = 0; j < topology->group_count; ++j) {
+    if (group_index == j) continue;
+    const iree_task_topology_group_t* other_group = &topology->groups[j];
+    uint64_t group_processor_bits =
+        iree_math_rotl_u64(1ull, other_group->processor_index);
+    if (processor_mask & group_processor_bits) {
+      group_mask |= iree_math_rotl_u64(1ull, other_group->group_index);
+    }
+  }
+  return group_mask;
+}
+
+// Fixes the sharing mask values such that they represent other chosen topology
+// groups instead of processor indices. We do this so that code using the
+// topology groups doesn't need to know anything about which physical processor
+// IDs a particular group is mapped to.
 static void iree_task_topology_fixup_constructive_sharing_masks(
     iree_task_topology_t* topology) {
   // O(n^2), but n is always <= 64 (and often <= 8).
   for (iree_host_size_t i = 0; i < topology->group_count; ++i) {
     iree_task_topology_group_t* group = &topology->groups[i];
-
-    // Compute the processors that we can constructively share with.
-    uint64_t constructive_sharing_mask =
-        iree_task_topology_calculate_constructive_sharing_mask(
-            cpuinfo_get_processor(group->processor_index));
-
-    iree_task_topology_group_mask_t group_mask = 0;
-    for (iree_host_size_t j = 0; j < topology->group_count; ++j) {
-      if (i == j) continue;
-      const iree_task_topology_group_t* other_group = &topology->groups[j];
-      uint64_t group_processor_bits =
-          iree_math_rotl_u64(1ull, other_group->processor_index);
-      if (constructive_sharing_mask & group_processor_bits) {
-        group_mask |= iree_math_rotl_u64(1ull, other_group->group_index);
-      }
-    }
-
-    group->constructive_sharing_mask = group_mask;
+    const struct cpuinfo_processor* processor =
+        cpuinfo_get_processor(group->processor_index);
+    group->constructive_sharing_mask =
+        iree_task_topology_calculate_group_mask_from_processors(
+            topology, i,
+            iree_task_topology_calculate_constructive_sharing_mask(processor));
+    group->llc_sharing_mask =
+        iree_task_topology_calculate_group_mask_from_processors(
+            topology, i,
+            iree_task_topology_calculate_llc_sharing_mask(processor));
+    group->node_sharing_mask =
+        iree_task_topology_calculate_group_mask_from_processors(
+            topology, i,
+            iree_task_topology_calculate_node_sharing_mask(processor));
   }
 }
 
@@ -254,6 +294,10 @@ static void iree_task_topology_initialize_from_physical_cores_with_filter(
   iree_task_topology_initialize(out_topology);
 
   // Build each core up to the max allowed.
+  // Cores are walked in cpuinfo order so that groups sharing a cache are
+  // assigned adjacent group indices; the executor relies on this when placing
+  // the shards of a dispatch so that adjacent tiles land on workers sharing a
+  // last-level cache.
   // TODO(benvanik): if our group_count <= core_count/2 then distribute better;
   // for now we just do a straight-line through (cores 0-N) when instead we may
   // want to take advantage of L3 cache info (half of groups on one L3 cache,
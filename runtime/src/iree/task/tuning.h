@@ -53,6 +53,20 @@ extern "C" {
 // 1ms may result in 10-15ms.
 #define IREE_TASK_EXECUTOR_DELAY_SLOP_NS (1 /*ms*/ * 1000000)
 
+// Maximum duration a caller donated to a threadless executor will sleep before
+// polling its wait source again when no tasks are ready. Callers are woken
+// immediately when tasks are posted to them and this only bounds the latency of
+// observing wait sources resolved on other threads (other donating callers or
+// work outside of the executor).
+#define IREE_TASK_EXECUTOR_DONATION_POLL_NS (1 /*ms*/ * 1000000)
+
+// Enables adapting the number of workers dispatches are sharded across based on
+// how many of the woken workers found tiles to execute in recent dispatches.
+// When disabled all dispatches are sharded across all workers.
+#if !defined(IREE_TASK_EXECUTOR_ADAPTIVE_WORKER_COUNT)
+#define IREE_TASK_EXECUTOR_ADAPTIVE_WORKER_COUNT 1
+#endif  // !IREE_TASK_EXECUTOR_ADAPTIVE_WORKER_COUNT
+
 // Allows for dividing the total number of attempts that a worker will make to
 // steal tasks from other workers. By default all other workers will be
 // attempted while setting this to 2, for example, will try for only half of
@@ -94,6 +108,18 @@ extern "C" {
 // memory).
 #define IREE_TASK_DISPATCH_MAX_TILES_PER_SHARD_RESERVATION (8)
 
+// Maximum number of partitions the tile grid of a dispatch is split into.
+// Each partition is a contiguous range of tiles assigned to the shards placed
+// on workers sharing a last-level cache such that adjacent workgroups (which
+// usually touch adjacent memory) execute within the same cache domain. Shards
+// only reserve tiles from other partitions once their own is exhausted.
+// Topologies with more cache domains than this share partitions.
+#define IREE_TASK_DISPATCH_MAX_PARTITION_COUNT (8)
+
+// Maximum number of storage slots for suspendable tiles in a single dispatch.
+// Bounded by the bits in the 64-bit masks used to track slot state.
+#define IREE_TASK_DISPATCH_MAX_TILE_STORAGE_COUNT (64)
+
 // Whether to enable per-tile colors for each tile tracing zone based on the
 // tile grid xyz. Not cheap and can be disabled to reduce tracing overhead.
 // TODO(#4017): make per-tile color tracing fast enough to always have on.
@@ -20,6 +20,14 @@
 #define IREE_TASK_WORKER_MIN_STACK_SIZE (32 * 1024)
 
 static int iree_task_worker_main(iree_task_worker_t* worker);
+static int iree_task_worker_pool_main(iree_task_worker_t* worker);
+
+// Returns the opaque pool thread handle of |worker| or NULL if it is not
+// hosted on an external thread pool (or has not yet been published).
+static void* iree_task_worker_pool_thread(iree_task_worker_t* worker) {
+  return (void*)iree_atomic_load_intptr(&worker->pool_thread,
+                                        iree_memory_order_acquire);
+}
 
 iree_status_t iree_task_worker_initialize(
     iree_task_executor_t* executor, iree_host_size_t worker_index,
@@ -32,8 +40,14 @@ iree_status_t iree_task_worker_initialize(
   out_worker->worker_index = executor->worker_base_index + worker_index;
   out_worker->worker_bit = iree_task_affinity_for_worker(worker_index);
   out_worker->ideal_thread_affinity = topology_group->ideal_thread_affinity;
-  out_worker->constructive_sharing_mask =
+  out_worker->sharing_masks[IREE_TASK_WORKER_SHARING_LEVEL_CACHE] =
       topology_group->constructive_sharing_mask;
+  out_worker->sharing_masks[IREE_TASK_WORKER_SHARING_LEVEL_LLC] =
+      topology_group->constructive_sharing_mask |
+      topology_group->llc_sharing_mask;
+  out_worker->sharing_masks[IREE_TASK_WORKER_SHARING_LEVEL_NODE] =
+      out_worker->sharing_masks[IREE_TASK_WORKER_SHARING_LEVEL_LLC] |
+      topology_group->node_sharing_mask;
   out_worker->max_theft_attempts =
       executor->worker_count / IREE_TASK_EXECUTOR_MAX_THEFT_ATTEMPTS_DIVISOR;
   iree_prng_minilcg128_initialize(iree_prng_splitmix64_next(seed_prng),
@@ -42,15 +56,50 @@ iree_status_t iree_task_worker_initialize(
   out_worker->processor_id = 0;
   out_worker->processor_tag = 0;
 
-  iree_notification_initialize(&out_worker->wake_notification);
   iree_notification_initialize(&out_worker->state_notification);
   iree_atomic_task_slist_initialize(&out_worker->mailbox_slist);
   iree_task_queue_initialize(&out_worker->local_task_queue);
 
+  iree_atomic_store_intptr(&out_worker->pool_thread, 0,
+                           iree_memory_order_relaxed);
+
   iree_task_worker_state_t initial_state = IREE_TASK_WORKER_STATE_RUNNING;
   iree_atomic_store_int32(&out_worker->state, initial_state,
                           iree_memory_order_release);
 
+  // Threadless workers are pumped by donating callers instead.
+  if (iree_all_bits_set(executor->flags, IREE_TASK_EXECUTOR_FLAG_THREADLESS)) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_ok_status();
+  }
+
+  // Hosted workers run on a thread borrowed from the external pool for the
+  // lifetime of the executor.
+  if (!iree_task_thread_pool_is_null(&executor->thread_pool)) {
+    iree_task_thread_spawn_params_t spawn_params;
+    memset(&spawn_params, 0, sizeof(spawn_params));
+    spawn_params.name = iree_make_cstring_view(topology_group->name);
+    spawn_params.worker_index = out_worker->worker_index;
+    spawn_params.ideal_affinity = out_worker->ideal_thread_affinity;
+    spawn_params.stack_size =
+        iree_max(IREE_TASK_WORKER_MIN_STACK_SIZE, stack_size);
+    // The pool may run the entry before spawn returns so the handle is only
+    // published afterward; iree_task_worker_pool_main waits for it.
+    void* pool_thread = NULL;
+    iree_status_t status = executor->thread_pool.spawn(
+        executor->thread_pool.self, &spawn_params,
+        (iree_thread_entry_t)iree_task_worker_pool_main, out_worker,
+        &pool_thread);
+    if (iree_status_is_ok(status)) {
+      iree_atomic_store_intptr(&out_worker->pool_thread, (intptr_t)pool_thread,
+                               iree_memory_order_release);
+      iree_notification_post(&out_worker->state_notification,
+                             IREE_ALL_WAITERS);
+    }
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+
   iree_thread_create_params_t thread_params;
   memset(&thread_params, 0, sizeof(thread_params));
   thread_params.name = iree_make_cstring_view(topology_group->name);
@@ -71,8 +120,14 @@ iree_status_t iree_task_worker_initialize(
   return status;
 }
 
+// Returns true if the worker has a thread (owned or from a thread pool) that
+// must be exited and joined.
+static bool iree_task_worker_has_thread(iree_task_worker_t* worker) {
+  return worker->thread || iree_task_worker_pool_thread(worker);
+}
+
 void iree_task_worker_request_exit(iree_task_worker_t* worker) {
-  if (!worker->thread) return;
+  if (!iree_task_worker_has_thread(worker)) return;
   IREE_TRACE_ZONE_BEGIN(z0);
 
   // If the thread is already in the exiting/zombie state we don't need to do
@@ -93,7 +148,7 @@ void iree_task_worker_request_exit(iree_task_worker_t* worker) {
   }
 
   // Kick the worker in case it is waiting for work.
-  iree_notification_post(&worker->wake_notification, 1);
+  iree_task_worker_wake(worker);
 
   IREE_TRACE_ZONE_END(z0);
 }
@@ -106,7 +161,7 @@ static bool iree_task_worker_is_zombie(iree_task_worker_t* worker) {
 }
 
 void iree_task_worker_await_exit(iree_task_worker_t* worker) {
-  if (!worker->thread) return;
+  if (!iree_task_worker_has_thread(worker)) return;
   IREE_TRACE_ZONE_BEGIN(z0);
 
   iree_task_worker_request_exit(worker);
@@ -120,11 +175,19 @@ void iree_task_worker_await_exit(iree_task_worker_t* worker) {
 void iree_task_worker_deinitialize(iree_task_worker_t* worker) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
-  // Must have called request_exit/await_exit.
-  IREE_ASSERT_TRUE(iree_task_worker_is_zombie(worker));
+  // Must have called request_exit/await_exit if the worker has a thread.
+  IREE_ASSERT_TRUE(!iree_task_worker_has_thread(worker) ||
+                   iree_task_worker_is_zombie(worker));
 
   iree_thread_release(worker->thread);
   worker->thread = NULL;
+  void* pool_thread = iree_task_worker_pool_thread(worker);
+  if (pool_thread) {
+    worker->executor->thread_pool.join(worker->executor->thread_pool.self,
+                                       pool_thread);
+    iree_atomic_store_intptr(&worker->pool_thread, 0,
+                             iree_memory_order_relaxed);
+  }
 
   // Release unfinished tasks by flushing the mailbox (which if we're here can't
   // get anything more posted to it) and then discarding everything we still
@@ -132,7 +195,6 @@ void iree_task_worker_deinitialize(iree_task_worker_t* worker) {
   iree_atomic_task_slist_discard(&worker->mailbox_slist);
   iree_task_list_discard(&worker->local_task_queue.list);
 
-  iree_notification_deinitialize(&worker->wake_notification);
   iree_notification_deinitialize(&worker->state_notification);
   iree_atomic_task_slist_deinitialize(&worker->mailbox_slist);
   iree_task_queue_deinitialize(&worker->local_task_queue);
@@ -148,6 +210,43 @@ void iree_task_worker_post_tasks(iree_task_worker_t* worker,
   memset(list, 0, sizeof(*list));
 }
 
+// Workers wait on their own index in the executor worker_wake_set so that
+// coordinators can wake any subset of them with a single post.
+static iree_wait_token_t iree_task_worker_prepare_wait(
+    iree_task_worker_t* worker) {
+  return iree_notification_set_prepare_wait(&worker->executor->worker_wake_set);
+}
+
+static void iree_task_worker_cancel_wait(iree_task_worker_t* worker) {
+  iree_notification_set_cancel_wait(&worker->executor->worker_wake_set);
+}
+
+static bool iree_task_worker_commit_wait(iree_task_worker_t* worker,
+                                         iree_wait_token_t wait_token,
+                                         iree_duration_t spin_ns,
+                                         iree_time_t deadline_ns) {
+  return iree_notification_set_commit_wait(
+      &worker->executor->worker_wake_set,
+      (uint32_t)iree_task_affinity_set_count_trailing_zeros(worker->worker_bit),
+      wait_token, spin_ns, deadline_ns);
+}
+
+void iree_task_worker_wake(iree_task_worker_t* worker) {
+  if (!iree_task_thread_pool_is_null(&worker->executor->thread_pool)) {
+    // Permits make this safe to call even if the worker is not parked. If the
+    // handle has not been published yet the worker has not parked either and
+    // will find the work on its first pump.
+    void* pool_thread = iree_task_worker_pool_thread(worker);
+    if (pool_thread) {
+      worker->executor->thread_pool.unpark(worker->executor->thread_pool.self,
+                                           pool_thread);
+    }
+  } else {
+    iree_notification_set_post(&worker->executor->worker_wake_set,
+                               worker->worker_bit);
+  }
+}
+
 iree_task_t* iree_task_worker_try_steal_task(iree_task_worker_t* worker,
                                              iree_task_queue_t* target_queue,
                                              iree_host_size_t max_tasks) {
@@ -177,7 +276,9 @@ static void iree_task_worker_execute(
   // TODO(benvanik): think a bit more about this timing; this ensures we have
   // BFS behavior at the cost of the additional merge overhead - it's probably
   // worth it?
-  // TODO(benvanik): handle partial tasks and re-queuing.
+  // NOTE: dispatch shards with suspended tiles re-queue themselves on the
+  // |pending_submission| instead of retiring so that they can be resumed later
+  // by any worker.
   switch (task->type) {
     case IREE_TASK_TYPE_CALL: {
       iree_task_call_execute((iree_task_call_t*)task, pending_submission);
@@ -226,14 +327,14 @@ static bool iree_task_worker_pump_once(
 
 #if IREE_TASK_EXECUTOR_MAX_THEFT_ATTEMPTS_DIVISOR > 0
   // If we ran out of work assigned to this specific worker try to steal some
-  // from other workers that we hopefully share some of the cache hierarchy
-  // with. Their tasks will be moved from their local queue into ours and the
-  // the first task in the queue is popped off and returned.
+  // from other workers, starting with those that share the nearest level of the
+  // cache hierarchy with us. Their tasks will be moved from their local queue
+  // into ours and the the first task in the queue is popped off and returned.
   if (!task) {
     task = iree_task_executor_try_steal_task(
-        worker->executor, worker->constructive_sharing_mask,
-        worker->max_theft_attempts, &worker->theft_prng,
-        &worker->local_task_queue);
+        worker->executor, worker->sharing_masks,
+        IREE_ARRAYSIZE(worker->sharing_masks), worker->max_theft_attempts,
+        &worker->theft_prng, &worker->local_task_queue);
   }
 #endif  // IREE_TASK_EXECUTOR_MAX_THEFT_ATTEMPTS_DIVISOR > 0
 
@@ -272,8 +373,7 @@ static void iree_task_worker_pump_until_exit(iree_task_worker_t* worker) {
     // checked a particular source we use an interruptable wait token that
     // will prevent the wait from happening if anyone touches the data
     // structures we use.
-    iree_wait_token_t wait_token =
-        iree_notification_prepare_wait(&worker->wake_notification);
+    iree_wait_token_t wait_token = iree_task_worker_prepare_wait(worker);
     // The masks are accessed with 'relaxed' order because they are just hints.
     iree_task_affinity_set_t old_idle_mask =
         iree_atomic_task_affinity_set_fetch_and(
@@ -290,7 +390,7 @@ static void iree_task_worker_pump_until_exit(iree_task_worker_t* worker) {
     if (iree_atomic_load_int32(&worker->state, iree_memory_order_acquire) ==
         IREE_TASK_WORKER_STATE_EXITING) {
       // Thread exit requested - cancel pumping.
-      iree_notification_cancel_wait(&worker->wake_notification);
+      iree_task_worker_cancel_wait(worker);
       // TODO(benvanik): complete tasks before exiting?
       break;
     }
@@ -341,16 +441,23 @@ static void iree_task_worker_pump_until_exit(iree_task_worker_t* worker) {
     if (schedule_dirty ||
         !iree_task_queue_is_empty(&worker->local_task_queue)) {
       // Have more work to do; loop around to try another pump.
-      iree_notification_cancel_wait(&worker->wake_notification);
+      iree_task_worker_cancel_wait(worker);
     } else {
       // Spin/wait in the kernel. We don't care if the condition fails as we're
       // just using it as a pulse.
       IREE_TRACE_ZONE_BEGIN_NAMED(z_wait,
                                   "iree_task_worker_main_pump_wake_wait");
-      iree_notification_commit_wait(
-          &worker->wake_notification, wait_token,
-          /*spin_ns=*/worker->executor->worker_spin_ns,
-          /*deadline_ns=*/IREE_TIME_INFINITE_FUTURE);
+      if (!iree_task_thread_pool_is_null(&worker->executor->thread_pool)) {
+        // Park on the pool instead; any wake since we marked ourselves idle
+        // will have left a permit that makes the park return immediately.
+        iree_task_worker_cancel_wait(worker);
+        worker->executor->thread_pool.park(worker->executor->thread_pool.self);
+      } else {
+        iree_task_worker_commit_wait(
+            worker, wait_token,
+            /*spin_ns=*/worker->executor->worker_spin_ns,
+            /*deadline_ns=*/IREE_TIME_INFINITE_FUTURE);
+      }
       IREE_TRACE_ZONE_END(z_wait);
 
       // Woke from a wait - query the processor ID in case we migrated during
@@ -364,6 +471,114 @@ static void iree_task_worker_pump_until_exit(iree_task_worker_t* worker) {
   }
 }
 
+// Moves tasks stranded on workers of a threadless executor that are not
+// claimed by any caller into the local queue of |worker|. Tasks are posted to
+// unclaimed workers when no caller was donating at the time of coordination or
+// when a caller stopped donating with tasks still in its queue.
+// Returns true if any tasks were adopted.
+static bool iree_task_worker_adopt_unclaimed_tasks(iree_task_worker_t* worker) {
+  iree_task_executor_t* executor = worker->executor;
+  iree_task_affinity_set_t unclaimed_mask =
+      iree_task_affinity_set_ones(executor->worker_count) &
+      ~iree_atomic_task_affinity_set_load(&executor->worker_claim_mask,
+                                          iree_memory_order_acquire);
+  bool did_adopt = false;
+  while (unclaimed_mask) {
+    int victim_index = iree_task_affinity_set_count_trailing_zeros(
+        unclaimed_mask);
+    unclaimed_mask &= ~iree_task_affinity_for_worker(victim_index);
+    iree_task_worker_t* victim_worker = &executor->workers[victim_index];
+    iree_task_t* task = NULL;
+    while ((task = iree_task_worker_try_steal_task(
+                victim_worker, &worker->local_task_queue,
+                /*max_tasks=*/IREE_TASK_EXECUTOR_MAX_THEFT_TASK_COUNT))) {
+      iree_task_queue_push_front(&worker->local_task_queue, task);
+      did_adopt = true;
+    }
+  }
+  return did_adopt;
+}
+
+iree_status_t iree_task_worker_pump_until(iree_task_worker_t* worker,
+                                          iree_wait_source_t wait_source,
+                                          iree_timeout_t timeout) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_task_executor_t* executor = worker->executor;
+  const iree_time_t deadline_ns = iree_timeout_as_deadline_ns(timeout);
+
+  // We don't know what the caller thread has configured so be explicit about
+  // what tasks expect and restore the caller state when we return.
+  iree_fpu_state_t fpu_state =
+      iree_fpu_state_push(IREE_FPU_STATE_FLAG_FLUSH_DENORMALS_TO_ZERO);
+  iree_task_worker_update_processor_id(worker);
+
+  iree_status_t status = iree_ok_status();
+  while (true) {
+    // Stop as soon as the wait source resolves. This is checked first so that
+    // already-resolved waits don't end up executing unrelated tasks.
+    iree_status_code_t wait_status_code = IREE_STATUS_OK;
+    status = iree_wait_source_query(wait_source, &wait_status_code);
+    if (!iree_status_is_ok(status)) break;
+    if (wait_status_code != IREE_STATUS_DEFERRED) {
+      status = iree_status_from_code(wait_status_code);
+      break;
+    }
+
+    // Same protocol as iree_task_worker_pump_until_exit: anyone posting to us
+    // after this point will interrupt the wait below.
+    iree_wait_token_t wait_token = iree_task_worker_prepare_wait(worker);
+    iree_atomic_task_affinity_set_fetch_and(&executor->worker_idle_mask,
+                                            ~worker->worker_bit,
+                                            iree_memory_order_relaxed);
+
+    // Flush anything submitted by the caller (or others) to the workers.
+    iree_task_executor_coordinate(executor, worker);
+
+    iree_task_submission_t pending_submission;
+    iree_task_submission_initialize(&pending_submission);
+    while (iree_task_worker_pump_once(worker, &pending_submission)) {
+      // All work done ^, which will return false when the worker should wait.
+    }
+
+    bool schedule_dirty = false;
+    if (!iree_task_submission_is_empty(&pending_submission)) {
+      iree_task_executor_merge_submission(executor, &pending_submission);
+      schedule_dirty = true;
+    }
+
+    iree_atomic_task_affinity_set_fetch_or(&executor->worker_idle_mask,
+                                           worker->worker_bit,
+                                           iree_memory_order_relaxed);
+
+    if (schedule_dirty || iree_task_worker_adopt_unclaimed_tasks(worker)) {
+      // Have more work to do; loop around to try another pump.
+      iree_task_worker_cancel_wait(worker);
+      continue;
+    }
+
+    // Nothing to run; sleep until tasks are posted to us, the deadline is
+    // reached, or it's time to poll the wait source again.
+    iree_time_t now_ns = iree_time_now();
+    if (now_ns >= deadline_ns) {
+      iree_task_worker_cancel_wait(worker);
+      status = iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+      break;
+    }
+    IREE_TRACE_ZONE_BEGIN_NAMED(z_wait, "iree_task_worker_pump_until_wait");
+    iree_task_worker_commit_wait(
+        worker, wait_token,
+        /*spin_ns=*/executor->worker_spin_ns,
+        /*deadline_ns=*/iree_min(deadline_ns,
+                                 now_ns + IREE_TASK_EXECUTOR_DONATION_POLL_NS));
+    IREE_TRACE_ZONE_END(z_wait);
+    iree_task_worker_update_processor_id(worker);
+  }
+
+  iree_fpu_state_pop(fpu_state);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 // Thread entry point for each worker.
 static int iree_task_worker_main(iree_task_worker_t* worker) {
   IREE_TRACE_ZONE_BEGIN(thread_zone);
@@ -372,9 +587,12 @@ static int iree_task_worker_main(iree_task_worker_t* worker) {
   // Be explicit here on what we need.
   iree_fpu_state_push(IREE_FPU_STATE_FLAG_FLUSH_DENORMALS_TO_ZERO);
 
-  // Reset affinity (as it can change over time).
+  // Reset affinity (as it can change over time). Threads from an external pool
+  // are placed by the pool.
   // TODO(benvanik): call this after waking in case CPU hotplugging happens.
-  iree_thread_request_affinity(worker->thread, worker->ideal_thread_affinity);
+  if (worker->thread) {
+    iree_thread_request_affinity(worker->thread, worker->ideal_thread_affinity);
+  }
 
   // Enter the running state immediately. Note that we could have been requested
   // to exit while suspended/still starting up, so check that here before we
@@ -394,3 +612,18 @@ static int iree_task_worker_main(iree_task_worker_t* worker) {
   iree_notification_post(&worker->state_notification, IREE_ALL_WAITERS);
   return 0;
 }
+
+// Returns true if the pool thread handle of |worker| has been published.
+static bool iree_task_worker_has_pool_thread(iree_task_worker_t* worker) {
+  return iree_task_worker_pool_thread(worker) != NULL;
+}
+
+// Entry point for workers hosted on an external thread pool.
+// Waits until the spawning thread has published the pool thread handle so that
+// the worker never parks before it can be unparked.
+static int iree_task_worker_pool_main(iree_task_worker_t* worker) {
+  iree_notification_await(&worker->state_notification,
+                          (iree_condition_fn_t)iree_task_worker_has_pool_thread,
+                          worker, iree_infinite_timeout());
+  return iree_task_worker_main(worker);
+}
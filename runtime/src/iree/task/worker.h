@@ -47,6 +47,18 @@ typedef enum iree_task_worker_state_e {
   IREE_TASK_WORKER_STATE_ZOMBIE = 2,
 } iree_task_worker_state_t;
 
+// Levels of the cache/memory hierarchy a worker may share with other workers,
+// ordered from nearest to farthest.
+typedef enum iree_task_worker_sharing_level_e {
+  // Workers sharing an L1/L2 cache.
+  IREE_TASK_WORKER_SHARING_LEVEL_CACHE = 0,
+  // Workers sharing a last-level cache (L3, or a single chiplet/CCX L3).
+  IREE_TASK_WORKER_SHARING_LEVEL_LLC,
+  // Workers on the same NUMA node.
+  IREE_TASK_WORKER_SHARING_LEVEL_NODE,
+  IREE_TASK_WORKER_SHARING_LEVEL_COUNT,
+} iree_task_worker_sharing_level_t;
+
 // A worker within the executor pool.
 //
 // NOTE: fields in here are touched from multiple threads with lock-free
@@ -64,16 +76,12 @@ typedef struct iree_task_worker_t {
   iree_atomic_task_slist_t mailbox_slist;
 
   // Current state of the worker (iree_task_worker_state_t).
-  // LAYOUT: frequent access; next to wake_notification as they are always
-  //         accessed together.
+  // Idle workers wait for wakes on their index in the executor
+  // worker_wake_set so that coordinators can wake many in a single operation.
+  // LAYOUT: frequent access; next to mailbox_slist as posting threads will
+  //         touch the mailbox and then check the state when waking.
   iree_atomic_int32_t state;
 
-  // Notification signaled when the worker should wake (if it is idle).
-  // LAYOUT: next to state for similar access patterns; when posting other
-  //         threads will touch mailbox_slist and then send a wake
-  //         notification.
-  iree_notification_t wake_notification;
-
   // Notification signaled when the worker changes any state.
   iree_notification_t state_notification;
 
@@ -91,12 +99,10 @@ typedef struct iree_task_worker_t {
   // Ideal thread affinity for the worker thread.
   iree_thread_affinity_t ideal_thread_affinity;
 
-  // A bitmask of other group indices that share some level of the cache
-  // hierarchy. Workers of this group are more likely to constructively share
-  // some cache levels higher up with these other groups. For example, if the
-  // workers in a group all share an L2 cache then the groups indicated here may
-  // all share the same L3 cache.
-  iree_task_affinity_set_t constructive_sharing_mask;
+  // Bitmasks of other workers sharing each level of the cache/memory hierarchy
+  // with this worker indexed by iree_task_worker_sharing_level_t. Thefts try
+  // each level in order before falling back to any remote worker.
+  iree_task_affinity_set_t sharing_masks[IREE_TASK_WORKER_SHARING_LEVEL_COUNT];
 
   // Maximum number of attempts to make when trying to steal tasks from other
   // workers. This could be 64 (try stealing from all workers) or just a handful
@@ -111,6 +117,13 @@ typedef struct iree_task_worker_t {
   // remain valid so that the executor can query its state.
   iree_thread_t* thread;
 
+  // Opaque handle (void*) of the thread running the worker when the executor
+  // uses an external iree_task_thread_pool_t (in which case |thread| is NULL).
+  // The pool may start running the worker before spawn returns the handle so
+  // it is published with a release store once known and must be read with an
+  // acquire load; the worker does not park until it has observed it.
+  iree_atomic_intptr_t pool_thread;
+
   // Guess at the current processor ID.
   // This is updated infrequently as it can be semi-expensive to determine
   // (on some platforms at least 1 syscall involved). We always update it upon
@@ -156,6 +169,10 @@ static_assert(offsetof(iree_task_worker_t, local_task_queue) >=
 // tasks. Where supported the worker will be created in a suspended state so
 // that we aren't creating a thundering herd on startup:
 // https://en.wikipedia.org/wiki/Thundering_herd_problem
+//
+// Workers of threadless executors are created without a thread and only run
+// tasks when pumped by a caller with iree_task_worker_pump_until. Executors
+// with an external thread pool spawn their workers on pool threads instead.
 iree_status_t iree_task_worker_initialize(
     iree_task_executor_t* executor, iree_host_size_t worker_index,
     const iree_task_topology_group_t* topology_group,
@@ -175,7 +192,8 @@ void iree_task_worker_request_exit(iree_task_worker_t* worker);
 void iree_task_worker_await_exit(iree_task_worker_t* worker);
 
 // Deinitializes a worker that has successfully exited.
-// The worker must be in the IREE_TASK_WORKER_STATE_ZOMBIE state.
+// The worker must be in the IREE_TASK_WORKER_STATE_ZOMBIE state or have no
+// thread.
 //
 // Expected shutdown sequence:
 //  - request_exit on all workers
@@ -190,6 +208,27 @@ void iree_task_worker_deinitialize(iree_task_worker_t* worker);
 void iree_task_worker_post_tasks(iree_task_worker_t* worker,
                                  iree_task_list_t* list);
 
+// Pumps tasks on a threadless |worker| from the calling thread until
+// |wait_source| resolves or |timeout| elapses. The caller must have exclusive
+// ownership of the worker for the duration of the call.
+//
+// Tasks posted to the worker, stolen from other claimed workers, or stranded
+// on unclaimed workers are executed in the calling thread. The caller only
+// blocks when there are no tasks ready to run and will be woken when new tasks
+// are posted to the worker. Wait sources resolved on other threads are polled
+// at IREE_TASK_EXECUTOR_DONATION_POLL_NS intervals while idle.
+//
+// Returns IREE_STATUS_DEADLINE_EXCEEDED if |timeout| elapses before the
+// |wait_source| resolves or the failure status of the wait source.
+iree_status_t iree_task_worker_pump_until(iree_task_worker_t* worker,
+                                          iree_wait_source_t wait_source,
+                                          iree_timeout_t timeout);
+
+// Wakes the worker if it is idle waiting for tasks to be posted.
+//
+// May be called from any thread (including the worker thread).
+void iree_task_worker_wake(iree_task_worker_t* worker);
+
 // Tries to steal up to |max_tasks| from the back of the queue.
 // Returns NULL if no tasks are available and otherwise up to |max_tasks| tasks
 // that were at the tail of the worker FIFO will be moved to the |target_queue|
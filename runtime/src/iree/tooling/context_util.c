@@ -10,9 +10,12 @@
 #include <stdio.h>
 #include <string.h>
 
+#include "iree/base/internal/call_once.h"
 #include "iree/base/internal/file_io.h"
 #include "iree/base/internal/flags.h"
+#include "iree/base/internal/huge_page_allocator.h"
 #include "iree/base/internal/path.h"
+#include "iree/base/internal/synchronization.h"
 #include "iree/hal/local/loaders/registration/init.h"
 #include "iree/hal/local/plugins/registration/init.h"
 #include "iree/modules/hal/inline/module.h"
@@ -35,6 +38,33 @@ IREE_FLAG_LIST(
     "for a module needing to have been registered prior to the dependent\n"
     "module. HAL modules are added automatically when required.");
 
+IREE_FLAG(
+    string, parameter_dir, "",
+    "Directory containing parameters externalized from bytecode modules by\n"
+    "the compiler with `--iree-vm-bytecode-module-parameter-dir=`. Each\n"
+    "parameter is stored as `<key>.bin` and is mapped into memory when\n"
+    "modules referencing it are loaded.");
+
+// Resolves parameters by mapping `<parameter_dir>/<key>.bin`.
+static iree_status_t iree_tooling_resolve_parameter(
+    void* self, iree_string_view_t key, iree_const_byte_span_t* out_contents,
+    iree_allocator_t* out_deallocator) {
+  iree_allocator_t host_allocator = *(iree_allocator_t*)self;
+  char path_str[2048] = {0};
+  int path_length = snprintf(path_str, sizeof(path_str), "%s/%.*s.bin",
+                             FLAG_parameter_dir, (int)key.size, key.data);
+  if (path_length < 0 || (size_t)path_length >= sizeof(path_str)) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "parameter path too long");
+  }
+  iree_file_contents_t* file_contents = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_file_map_contents(path_str, host_allocator, &file_contents));
+  *out_contents = file_contents->const_buffer;
+  *out_deallocator = iree_file_contents_deallocator(file_contents);
+  return iree_ok_status();
+}
+
 static iree_status_t iree_tooling_load_bytecode_module(
     iree_vm_instance_t* instance, iree_string_view_t path,
     iree_allocator_t host_allocator, iree_vm_module_t** out_module) {
@@ -58,10 +88,21 @@ static iree_status_t iree_tooling_load_bytecode_module(
   // Try to load the module as bytecode (all we have today that we can use).
   // We could sniff the file ID and switch off to other module types.
   // The module takes ownership of the file contents (when successful).
+  // Parameters are only available when a directory has been specified.
+  iree_vm_bytecode_parameter_provider_t parameter_provider = {
+      .self = &host_allocator,
+      .resolve = iree_tooling_resolve_parameter,
+  };
+  iree_vm_bytecode_module_options_t options;
+  memset(&options, 0, sizeof(options));
+  if (strlen(FLAG_parameter_dir)) {
+    options.parameter_provider = &parameter_provider;
+  }
   iree_vm_module_t* module = NULL;
-  iree_status_t status = iree_vm_bytecode_module_create(
+  iree_status_t status = iree_vm_bytecode_module_create_with_options(
       instance, file_contents->const_buffer,
-      iree_file_contents_deallocator(file_contents), host_allocator, &module);
+      iree_file_contents_deallocator(file_contents), &options, host_allocator,
+      &module);
 
   if (iree_status_is_ok(status)) {
     *out_module = module;
@@ -148,6 +189,109 @@ iree_status_t iree_tooling_load_modules_from_flags(
   return iree_ok_status();
 }
 
+//===----------------------------------------------------------------------===//
+// Device memory allocator selection
+//===----------------------------------------------------------------------===//
+
+IREE_FLAG(
+    string, device_allocator_huge_pages, "none",
+    "Backs large host allocations made by local devices (buffers, arena\n"
+    "blocks, worker local memory) with huge pages to reduce TLB misses:\n"
+    "  'none': use the host allocator for all allocations.\n"
+    "  'transparent': advise the system to use transparent huge pages.\n"
+    "  'explicit': map from the reserved huge page pool and fall back to\n"
+    "              transparent huge pages when it is exhausted.");
+IREE_FLAG(int64_t, device_allocator_huge_page_threshold, 2 * 1024 * 1024,
+          "Minimum size in bytes of allocations that will be backed by huge\n"
+          "pages when --device_allocator_huge_pages= is set. Smaller\n"
+          "allocations are made from the host allocator.");
+
+// Process-wide huge page allocator shared by all devices created by the
+// tooling. Devices and the buffers allocated from them are not tracked and may
+// outlive any particular context so the allocator lives for the lifetime of the
+// process once created.
+static struct {
+  // Guards all fields below.
+  iree_slim_mutex_t mutex;
+  // Options and fallback allocator |allocator| was created with.
+  iree_huge_page_allocator_options_t options;
+  iree_allocator_t fallback_allocator;
+  iree_huge_page_allocator_t* allocator;
+} iree_tooling_huge_page_allocator_state;
+static iree_once_flag iree_tooling_huge_page_allocator_flag =
+    IREE_ONCE_FLAG_INIT;
+
+static void iree_tooling_huge_page_allocator_state_initialize(void) {
+  iree_slim_mutex_initialize(&iree_tooling_huge_page_allocator_state.mutex);
+}
+
+// Returns the process-wide huge page allocator, creating it with |options| and
+// |fallback_allocator| on first use. Fails if it was already created with
+// different options or a different fallback allocator as all devices would
+// otherwise silently share the first configuration.
+static iree_status_t iree_tooling_acquire_huge_page_allocator(
+    iree_huge_page_allocator_options_t options,
+    iree_allocator_t fallback_allocator, iree_allocator_t* out_allocator) {
+  iree_call_once(&iree_tooling_huge_page_allocator_flag,
+                 iree_tooling_huge_page_allocator_state_initialize);
+  iree_slim_mutex_lock(&iree_tooling_huge_page_allocator_state.mutex);
+  iree_status_t status = iree_ok_status();
+  if (!iree_tooling_huge_page_allocator_state.allocator) {
+    status = iree_huge_page_allocator_create(
+        options, fallback_allocator,
+        &iree_tooling_huge_page_allocator_state.allocator);
+    if (iree_status_is_ok(status)) {
+      iree_tooling_huge_page_allocator_state.options = options;
+      iree_tooling_huge_page_allocator_state.fallback_allocator =
+          fallback_allocator;
+    }
+  } else if (iree_tooling_huge_page_allocator_state.options.mode !=
+                 options.mode ||
+             iree_tooling_huge_page_allocator_state.options
+                     .min_allocation_size != options.min_allocation_size) {
+    status = iree_make_status(
+        IREE_STATUS_FAILED_PRECONDITION,
+        "huge page allocator already created with different options; "
+        "--device_allocator_huge_pages= and "
+        "--device_allocator_huge_page_threshold= must not change within a "
+        "process");
+  } else if (memcmp(&iree_tooling_huge_page_allocator_state.fallback_allocator,
+                    &fallback_allocator, sizeof(fallback_allocator)) != 0) {
+    status = iree_make_status(
+        IREE_STATUS_FAILED_PRECONDITION,
+        "huge page allocator already created with a different host allocator");
+  }
+  if (iree_status_is_ok(status)) {
+    *out_allocator = iree_huge_page_allocator(
+        iree_tooling_huge_page_allocator_state.allocator);
+  }
+  iree_slim_mutex_unlock(&iree_tooling_huge_page_allocator_state.mutex);
+  return status;
+}
+
+// Selects the allocator used for host memory allocated by devices based on
+// flags. Returns |host_allocator| if no special allocator was requested.
+static iree_status_t iree_tooling_select_device_host_allocator(
+    iree_allocator_t host_allocator, iree_allocator_t* out_allocator) {
+  *out_allocator = host_allocator;
+
+  iree_huge_page_allocator_options_t options;
+  iree_huge_page_allocator_options_initialize(&options);
+  IREE_RETURN_IF_ERROR(iree_huge_page_mode_parse(
+      iree_make_cstring_view(FLAG_device_allocator_huge_pages),
+      &options.mode));
+  if (options.mode == IREE_HUGE_PAGE_MODE_NONE) return iree_ok_status();
+  if (FLAG_device_allocator_huge_page_threshold < 0) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "huge page threshold must be >= 0");
+  }
+  options.min_allocation_size =
+      (iree_host_size_t)FLAG_device_allocator_huge_page_threshold;
+
+  return iree_tooling_acquire_huge_page_allocator(options, host_allocator,
+                                                  out_allocator);
+}
+
 //===----------------------------------------------------------------------===//
 // HAL execution model management
 //===----------------------------------------------------------------------===//
@@ -180,11 +324,15 @@ static iree_status_t iree_tooling_load_hal_async_module(
   if (iree_string_view_is_empty(default_device_uri)) {
     default_device_uri = iree_hal_default_device_uri();
   }
+  iree_allocator_t device_host_allocator = host_allocator;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_tooling_select_device_host_allocator(host_allocator,
+                                                    &device_host_allocator));
   iree_hal_device_t* device = NULL;
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
       z0, iree_hal_create_device_from_flags(
               iree_hal_available_driver_registry(), default_device_uri,
-              host_allocator, &device));
+              device_host_allocator, &device));
 
   // Fetch the allocator from the device to pass back to the caller.
   iree_hal_allocator_t* device_allocator = iree_hal_device_allocator(device);
@@ -215,8 +363,12 @@ static iree_status_t iree_tooling_create_inline_device_allocator_from_flags(
     iree_allocator_t host_allocator,
     iree_hal_allocator_t** out_device_allocator) {
   IREE_TRACE_ZONE_BEGIN(z0);
+  iree_allocator_t data_allocator = host_allocator;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0,
+      iree_tooling_select_device_host_allocator(host_allocator, &data_allocator));
   iree_status_t status = iree_hal_allocator_create_heap(
-      IREE_SV("heap"), host_allocator, host_allocator, out_device_allocator);
+      IREE_SV("heap"), data_allocator, host_allocator, out_device_allocator);
   IREE_TRACE_ZONE_END(z0);
   return status;
 }
@@ -0,0 +1,71 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/vm/bytecode/elf_native_loader.h"
+
+#include <string.h>
+
+#include "iree/hal/local/elf/elf_module.h"
+
+static iree_status_t IREE_API_PTR iree_vm_bytecode_elf_native_loader_load(
+    void* self, iree_const_byte_span_t object_data, void** out_library) {
+  iree_vm_bytecode_elf_native_loader_t* loader =
+      (iree_vm_bytecode_elf_native_loader_t*)self;
+  *out_library = NULL;
+  iree_elf_module_t* module = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      loader->host_allocator, sizeof(*module), (void**)&module));
+  iree_status_t status = iree_elf_module_initialize_from_memory(
+      object_data, /*import_table=*/NULL, loader->host_allocator, module);
+  if (iree_status_is_ok(status)) {
+    *out_library = module;
+  } else {
+    iree_allocator_free(loader->host_allocator, module);
+  }
+  return status;
+}
+
+static const void* IREE_API_PTR iree_vm_bytecode_elf_native_loader_lookup(
+    void* self, void* library, const char* name) {
+  void* entry_point = NULL;
+  iree_status_t status = iree_elf_module_lookup_export(
+      (iree_elf_module_t*)library, name, &entry_point);
+  if (!iree_status_is_ok(status)) {
+    // Not all exports have a native version.
+    iree_status_ignore(status);
+    return NULL;
+  }
+  return entry_point;
+}
+
+static int IREE_API_PTR iree_vm_bytecode_elf_native_loader_call(
+    void* self, const void* entry_point, const void* arguments,
+    void* results) {
+  return iree_elf_call_i_ppp(entry_point, (void*)arguments, results,
+                             /*reserved=*/NULL);
+}
+
+static void IREE_API_PTR iree_vm_bytecode_elf_native_loader_unload(
+    void* self, void* library) {
+  iree_vm_bytecode_elf_native_loader_t* loader =
+      (iree_vm_bytecode_elf_native_loader_t*)self;
+  iree_elf_module_t* module = (iree_elf_module_t*)library;
+  iree_elf_module_deinitialize(module);
+  iree_allocator_free(loader->host_allocator, module);
+}
+
+void iree_vm_bytecode_elf_native_loader_initialize(
+    iree_allocator_t host_allocator,
+    iree_vm_bytecode_elf_native_loader_t* out_loader) {
+  IREE_ASSERT_ARGUMENT(out_loader);
+  memset(out_loader, 0, sizeof(*out_loader));
+  out_loader->interface.self = out_loader;
+  out_loader->interface.load = iree_vm_bytecode_elf_native_loader_load;
+  out_loader->interface.lookup = iree_vm_bytecode_elf_native_loader_lookup;
+  out_loader->interface.call = iree_vm_bytecode_elf_native_loader_call;
+  out_loader->interface.unload = iree_vm_bytecode_elf_native_loader_unload;
+  out_loader->host_allocator = host_allocator;
+}
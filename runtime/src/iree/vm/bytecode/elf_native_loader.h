@@ -0,0 +1,36 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_VM_BYTECODE_ELF_NATIVE_LOADER_H_
+#define IREE_VM_BYTECODE_ELF_NATIVE_LOADER_H_
+
+#include "iree/base/api.h"
+#include "iree/vm/bytecode/module.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Loads native functions embedded in bytecode modules as ELF shared objects or
+// FatELFs using the same platform-independent loader as HAL executables.
+typedef struct iree_vm_bytecode_elf_native_loader_t {
+  // Interface passed as iree_vm_bytecode_module_options_t::native_loader.
+  iree_vm_bytecode_native_loader_t interface;
+  // Allocator used for loaded libraries.
+  iree_allocator_t host_allocator;
+} iree_vm_bytecode_elf_native_loader_t;
+
+// Initializes an ELF native |out_loader| allocating from |host_allocator|.
+// The loader must remain valid for the lifetime of all modules created with it.
+void iree_vm_bytecode_elf_native_loader_initialize(
+    iree_allocator_t host_allocator,
+    iree_vm_bytecode_elf_native_loader_t* out_loader);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_VM_BYTECODE_ELF_NATIVE_LOADER_H_
@@ -10,6 +10,7 @@
 #include <stdint.h>
 #include <string.h>
 
+#include "iree/base/internal/lz4.h"
 #include "iree/vm/bytecode/archive.h"
 #include "iree/vm/bytecode/module_impl.h"
 #include "iree/vm/bytecode/verifier.h"
@@ -142,16 +143,39 @@ static iree_status_t iree_vm_bytecode_map_internal_ordinal(
   return iree_ok_status();
 }
 
+// Deinitializes all rodata references in |module| and frees any storage owned
+// by them. Decompressed segments are allocated aligned by the module and are
+// freed here as the buffers cannot free aligned allocations themselves.
+static void iree_vm_bytecode_module_release_rodata(
+    iree_vm_bytecode_module_t* module) {
+  iree_vm_RodataSegmentDef_vec_t rodata_segments =
+      iree_vm_BytecodeModuleDef_rodata_segments(module->def);
+  for (int i = 0; i < module->rodata_ref_count; ++i) {
+    iree_vm_buffer_t* ref = &module->rodata_ref_table[i];
+    iree_vm_buffer_deinitialize(ref);
+    iree_vm_RodataSegmentDef_table_t segment =
+        iree_vm_RodataSegmentDef_vec_at(rodata_segments, i);
+    if (iree_vm_RodataSegmentDef_compression_type_type(segment) ==
+        iree_vm_CompressionTypeDef_LZ4ChunkedDataDef) {
+      iree_allocator_free_aligned(module->allocator, ref->data.data);
+    }
+  }
+}
+
 static void iree_vm_bytecode_module_destroy(void* self) {
   iree_vm_bytecode_module_t* module = (iree_vm_bytecode_module_t*)self;
   IREE_TRACE_ZONE_BEGIN(z0);
 
-  // Ensure all rodata references are unused and deinitialized.
-  for (int i = 0; i < module->rodata_ref_count; ++i) {
-    iree_vm_buffer_t* ref = &module->rodata_ref_table[i];
-    iree_vm_buffer_deinitialize(ref);
+  // Unload native code before the rodata containing its object is released.
+  if (module->native_library) {
+    module->native_loader.unload(module->native_loader.self,
+                                 module->native_library);
+    module->native_library = NULL;
   }
 
+  // Ensure all rodata references are unused and deinitialized.
+  iree_vm_bytecode_module_release_rodata(module);
+
   module->def = NULL;
   iree_allocator_free(module->archive_allocator,
                       (void*)module->archive_contents.data);
@@ -685,6 +709,92 @@ static void iree_vm_bytecode_module_free_state(
   IREE_TRACE_ZONE_END(z0);
 }
 
+// Returns an error if any mutable ref global in |state| holds an object.
+// Modules compiled without mutability information have all ref globals treated
+// as mutable.
+static iree_status_t iree_vm_bytecode_module_verify_forkable_state(
+    iree_vm_BytecodeModuleDef_table_t module_def,
+    iree_vm_bytecode_module_state_t* state) {
+  if (state->global_ref_count == 0) return iree_ok_status();
+  iree_vm_ModuleStateDef_table_t module_state_def =
+      iree_vm_BytecodeModuleDef_module_state(module_def);
+  if (!iree_vm_ModuleStateDef_mutable_global_refs_is_present(
+          module_state_def)) {
+    for (iree_host_size_t i = 0; i < state->global_ref_count; ++i) {
+      if (!iree_vm_ref_is_null(&state->global_ref_table[i])) {
+        return iree_make_status(
+            IREE_STATUS_FAILED_PRECONDITION,
+            "module has no ref global mutability information and ref global "
+            "%" PRIhsz " holds an object; recompile the module to fork it",
+            i);
+      }
+    }
+    return iree_ok_status();
+  }
+  flatbuffers_int32_vec_t mutable_global_refs =
+      iree_vm_ModuleStateDef_mutable_global_refs(module_state_def);
+  for (size_t i = 0; i < flatbuffers_int32_vec_len(mutable_global_refs); ++i) {
+    int32_t ordinal = flatbuffers_int32_vec_at(mutable_global_refs, i);
+    if (!iree_vm_ref_is_null(&state->global_ref_table[ordinal])) {
+      return iree_make_status(
+          IREE_STATUS_FAILED_PRECONDITION,
+          "mutable ref global %d holds an object that would be shared with "
+          "the fork",
+          ordinal);
+    }
+  }
+  return iree_ok_status();
+}
+
+static iree_status_t iree_vm_bytecode_module_fork_state(
+    void* self, iree_vm_module_state_t* parent_state,
+    iree_allocator_t allocator, iree_vm_module_state_t** out_child_state) {
+  IREE_ASSERT_ARGUMENT(parent_state);
+  IREE_ASSERT_ARGUMENT(out_child_state);
+  *out_child_state = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_vm_bytecode_module_t* module = (iree_vm_bytecode_module_t*)self;
+  iree_vm_BytecodeModuleDef_table_t module_def = module->def;
+  iree_vm_bytecode_module_state_t* parent =
+      (iree_vm_bytecode_module_state_t*)parent_state;
+
+  // Ref globals are shared with the fork and only those stored by the
+  // initializer are known to never change. A mutable ref global that holds an
+  // object (a cache, a list, etc) would leak state across the fork.
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_vm_bytecode_module_verify_forkable_state(module_def, parent));
+
+  // The state and all of its nested tables are a single allocation so we can
+  // clone the parent with a single copy. The layout is then redone to point the
+  // table pointers at the child storage.
+  iree_host_size_t total_state_struct_size =
+      iree_vm_bytecode_module_layout_state(module_def, NULL);
+  iree_vm_bytecode_module_state_t* state = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc_uninitialized(
+              allocator, total_state_struct_size, (void**)&state));
+  memcpy(state, parent, total_state_struct_size);
+  iree_vm_bytecode_module_layout_state(module_def, state);
+  state->allocator = allocator;
+
+  // Primitive globals were copied with the rwdata storage above. Ref globals
+  // are shared with the parent: the child gets its own slots that can be
+  // reassigned independently but the referenced objects (executables, constant
+  // buffers, etc) are retained and not cloned. Only ref globals set by the
+  // initializer can hold objects here (checked above).
+  for (iree_host_size_t i = 0; i < state->global_ref_count; ++i) {
+    iree_vm_ref_retain_inplace(&state->global_ref_table[i]);
+  }
+
+  // The import table only references the modules in the context and is copied
+  // verbatim as the child context contains the same modules.
+
+  *out_child_state = (iree_vm_module_state_t*)state;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
 static iree_status_t iree_vm_bytecode_module_resolve_import(
     void* self, iree_vm_module_state_t* module_state, iree_host_size_t ordinal,
     const iree_vm_function_t* function,
@@ -739,46 +849,47 @@ static iree_status_t iree_vm_bytecode_module_begin_call(
     void* self, iree_vm_stack_t* stack, iree_vm_function_call_t call) {
   // NOTE: any work here adds directly to the invocation time. Avoid doing too
   // much work or touching too many unlikely-to-be-cached structures (such as
-  // walking the FlatBuffer, which may cause page faults).
-
-  // Map the (potentially) export ordinal into the internal function ordinal in
-  // the function descriptor table.
+  // walking the FlatBuffer, which may cause page faults). Everything needed is
+  // precomputed in the export table when the module is created.
   iree_vm_bytecode_module_t* module = (iree_vm_bytecode_module_t*)self;
-  uint16_t internal_ordinal = 0;
-  iree_vm_FunctionSignatureDef_table_t signature_def = NULL;
-  IREE_RETURN_IF_ERROR(iree_vm_bytecode_map_internal_ordinal(
-      module, call.function, &internal_ordinal, &signature_def));
+  if (IREE_UNLIKELY(call.function.linkage !=
+                    IREE_VM_FUNCTION_LINKAGE_EXPORT)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "cannot map imported/internal functions; no entry "
+                            "in the function table");
+  } else if (IREE_UNLIKELY(call.function.ordinal >= module->export_count)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "export ordinal out of range (0 < %u < %" PRIhsz
+                            ")",
+                            call.function.ordinal, module->export_count);
+  }
+  const iree_vm_bytecode_export_t* export_entry =
+      &module->export_table[call.function.ordinal];
+
+  // Native functions only take and return primitives and run to completion
+  // without entering a stack frame.
+  if (export_entry->native_entry_point) {
+    int result = module->native_loader.call(
+        module->native_loader.self, export_entry->native_entry_point,
+        call.arguments.data, call.results.data);
+    if (IREE_UNLIKELY(result != 0)) {
+      return iree_make_status((iree_status_code_t)result,
+                              "native function %u failed",
+                              call.function.ordinal);
+    }
+    return iree_ok_status();
+  }
 
+  // Map the export ordinal into the internal function ordinal in the function
+  // descriptor table.
   call.function.linkage = IREE_VM_FUNCTION_LINKAGE_INTERNAL;
-  call.function.ordinal = internal_ordinal;
-
-  // Grab calling convention string. This is not great as we are guaranteed to
-  // have a bunch of cache misses, but without putting it on the descriptor
-  // (which would duplicate data and slow down normal intra-module calls)
-  // there's not a good way around it. In the grand scheme of things users
-  // should be keeping their calls across this boundary relatively fat (compared
-  // to the real work they do), so this only needs to be fast enough to blend
-  // into the noise. Similar to JNI, P/Invoke, etc you don't want to have
-  // imports that cost less to execute than the marshaling overhead (dozens to
-  // hundreds of instructions).
-  flatbuffers_string_t calling_convention =
-      signature_def
-          ? iree_vm_FunctionSignatureDef_calling_convention(signature_def)
-          : 0;
-  iree_vm_function_signature_t signature;
-  memset(&signature, 0, sizeof(signature));
-  signature.calling_convention.data = calling_convention;
-  signature.calling_convention.size =
-      flatbuffers_string_len(calling_convention);
-  iree_string_view_t cconv_arguments = iree_string_view_empty();
-  iree_string_view_t cconv_results = iree_string_view_empty();
-  IREE_RETURN_IF_ERROR(iree_vm_function_call_get_cconv_fragments(
-      &signature, &cconv_arguments, &cconv_results));
+  call.function.ordinal = export_entry->internal_ordinal;
 
   // Jump into the dispatch routine to execute bytecode until the function
   // either returns (synchronous) or yields (asynchronous).
-  return iree_vm_bytecode_dispatch_begin(stack, module, call, cconv_arguments,
-                                         cconv_results);  // tail
+  return iree_vm_bytecode_dispatch_begin(stack, module, call,
+                                         export_entry->arguments,
+                                         export_entry->results);  // tail
 }
 
 static iree_status_t iree_vm_bytecode_module_resume_call(
@@ -788,11 +899,325 @@ static iree_status_t iree_vm_bytecode_module_resume_call(
   return iree_vm_bytecode_dispatch_resume(stack, module, call_results);  // tail
 }
 
+// Populates the |module| export table with the internal ordinal and calling
+// convention fragments of each exported function.
+static iree_status_t iree_vm_bytecode_module_build_export_table(
+    iree_vm_bytecode_module_t* module) {
+  iree_vm_ExportFunctionDef_vec_t exported_functions =
+      iree_vm_BytecodeModuleDef_exported_functions(module->def);
+  iree_vm_FunctionSignatureDef_vec_t function_signatures =
+      iree_vm_BytecodeModuleDef_function_signatures(module->def);
+  for (iree_host_size_t i = 0; i < module->export_count; ++i) {
+    iree_vm_ExportFunctionDef_table_t export_def =
+        iree_vm_ExportFunctionDef_vec_at(exported_functions, i);
+    uint16_t internal_ordinal =
+        iree_vm_ExportFunctionDef_internal_ordinal(export_def);
+    if (internal_ordinal >= module->function_descriptor_count) {
+      return iree_make_status(
+          IREE_STATUS_INVALID_ARGUMENT,
+          "function ordinal out of range (0 < %u < %" PRIhsz ")",
+          internal_ordinal, module->function_descriptor_count);
+    }
+    iree_vm_FunctionSignatureDef_table_t signature_def =
+        iree_vm_FunctionSignatureDef_vec_at(function_signatures,
+                                            internal_ordinal);
+    flatbuffers_string_t calling_convention =
+        signature_def
+            ? iree_vm_FunctionSignatureDef_calling_convention(signature_def)
+            : 0;
+    iree_vm_function_signature_t signature;
+    memset(&signature, 0, sizeof(signature));
+    signature.calling_convention.data = calling_convention;
+    signature.calling_convention.size =
+        flatbuffers_string_len(calling_convention);
+    iree_vm_bytecode_export_t* export_entry = &module->export_table[i];
+    export_entry->internal_ordinal = internal_ordinal;
+    IREE_RETURN_IF_ERROR(iree_vm_function_call_get_cconv_fragments(
+        &signature, &export_entry->arguments, &export_entry->results));
+  }
+  return iree_ok_status();
+}
+
+// Returns true if all values in the calling convention |fragment| are
+// primitives that native code can access without the VM.
+static bool iree_vm_bytecode_cconv_fragment_is_primitive(
+    iree_string_view_t fragment) {
+  for (iree_host_size_t i = 0; i < fragment.size; ++i) {
+    switch (fragment.data[i]) {
+      case IREE_VM_CCONV_TYPE_VOID:
+      case IREE_VM_CCONV_TYPE_I32:
+      case IREE_VM_CCONV_TYPE_I64:
+      case IREE_VM_CCONV_TYPE_F32:
+      case IREE_VM_CCONV_TYPE_F64:
+        break;
+      default:
+        return false;
+    }
+  }
+  return true;
+}
+
+// Loads the native object embedded in the module with |native_loader|, if any,
+// and points each export with a native version at its entry point. Exports are
+// interpreted if there is no loader or the object cannot be loaded on the host.
+static void iree_vm_bytecode_module_load_native_functions(
+    iree_vm_bytecode_module_t* module,
+    const iree_vm_bytecode_native_loader_t* native_loader) {
+  iree_vm_NativeFunctionsDef_table_t native_functions_def =
+      iree_vm_BytecodeModuleDef_native_functions(module->def);
+  if (!native_loader || !native_functions_def) return;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Range checked by the verifier.
+  const iree_vm_buffer_t* object_ref =
+      &module->rodata_ref_table[iree_vm_NativeFunctionsDef_rodata_segment(
+          native_functions_def)];
+  iree_const_byte_span_t object_data = iree_make_const_byte_span(
+      object_ref->data.data, object_ref->data.data_length);
+  void* library = NULL;
+  iree_status_t status =
+      native_loader->load(native_loader->self, object_data, &library);
+  if (!iree_status_is_ok(status)) {
+    // Most likely built for another architecture; interpret instead.
+    iree_status_ignore(status);
+    IREE_TRACE_ZONE_END(z0);
+    return;
+  }
+  module->native_loader = *native_loader;
+  module->native_library = library;
+
+  iree_vm_ExportFunctionDef_vec_t exported_functions =
+      iree_vm_BytecodeModuleDef_exported_functions(module->def);
+  for (iree_host_size_t i = 0; i < module->export_count; ++i) {
+    iree_vm_bytecode_export_t* export_entry = &module->export_table[i];
+    if (!iree_vm_bytecode_cconv_fragment_is_primitive(
+            export_entry->arguments) ||
+        !iree_vm_bytecode_cconv_fragment_is_primitive(export_entry->results)) {
+      continue;
+    }
+    flatbuffers_string_t local_name = iree_vm_ExportFunctionDef_local_name(
+        iree_vm_ExportFunctionDef_vec_at(exported_functions, i));
+    export_entry->native_entry_point =
+        native_loader->lookup(native_loader->self, library, local_name);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+// Resolves the externalized parameter referenced by |segment| using
+// |parameter_provider| and initializes |ref| to point at its contents.
+static iree_status_t iree_vm_bytecode_module_resolve_parameter(
+    const iree_vm_bytecode_parameter_provider_t* parameter_provider,
+    iree_vm_RodataSegmentDef_table_t segment, iree_vm_buffer_t* ref) {
+  flatbuffers_string_t key_str = iree_vm_RodataSegmentDef_external_key(segment);
+  iree_string_view_t key =
+      iree_make_string_view(key_str, flatbuffers_string_len(key_str));
+  if (!parameter_provider) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "module references parameter '%.*s' but no "
+                            "parameter provider was specified",
+                            (int)key.size, key.data);
+  }
+  iree_const_byte_span_t contents = iree_const_byte_span_empty();
+  iree_allocator_t deallocator = iree_allocator_null();
+  IREE_RETURN_IF_ERROR(
+      parameter_provider->resolve(parameter_provider->self, key, &contents,
+                                  &deallocator),
+      "resolving parameter '%.*s'", (int)key.size, key.data);
+  uint64_t expected_length =
+      iree_vm_RodataSegmentDef_external_data_length(segment);
+  if (contents.data_length != expected_length) {
+    iree_allocator_free(deallocator, (void*)contents.data);
+    return iree_make_status(IREE_STATUS_DATA_LOSS,
+                            "parameter '%.*s' length mismatch; expected "
+                            "%" PRIu64 " bytes but resolved %" PRIhsz,
+                            (int)key.size, key.data, expected_length,
+                            contents.data_length);
+  }
+  // Parameters are read-only and the buffer is never written as it has a
+  // module origin.
+  iree_vm_buffer_initialize(
+      IREE_VM_BUFFER_ACCESS_ORIGIN_MODULE,
+      iree_make_byte_span((uint8_t*)contents.data, contents.data_length),
+      deallocator, ref);
+  return iree_ok_status();
+}
+
+// Returns the stored contents of the rodata |segment|, which may be compressed.
+static iree_const_byte_span_t iree_vm_bytecode_module_rodata_contents(
+    iree_vm_bytecode_module_t* module, iree_vm_RodataSegmentDef_table_t segment,
+    iree_host_size_t archive_rodata_offset) {
+  if (iree_vm_RodataSegmentDef_embedded_data_is_present(segment)) {
+    // Data is embedded in the FlatBuffer.
+    flatbuffers_uint8_vec_t embedded_data =
+        iree_vm_RodataSegmentDef_embedded_data(segment);
+    return iree_make_const_byte_span(embedded_data,
+                                     flatbuffers_uint8_vec_len(embedded_data));
+  }
+  // Data is concatenated with the FlatBuffer at some relative offset.
+  // Note that we've already verified the referenced range is in bounds.
+  return iree_make_const_byte_span(
+      module->archive_contents.data + archive_rodata_offset +
+          iree_vm_RodataSegmentDef_external_data_offset(segment),
+      iree_vm_RodataSegmentDef_external_data_length(segment));
+}
+
+// A single independently compressed chunk of a rodata segment.
+typedef struct iree_vm_bytecode_rodata_chunk_t {
+  iree_const_byte_span_t source;
+  iree_byte_span_t target;
+} iree_vm_bytecode_rodata_chunk_t;
+
+static iree_status_t iree_vm_bytecode_module_decompress_chunk(
+    void* user_data, iree_host_size_t index) {
+  const iree_vm_bytecode_rodata_chunk_t* chunk =
+      (const iree_vm_bytecode_rodata_chunk_t*)user_data + index;
+  iree_host_size_t length = 0;
+  IREE_RETURN_IF_ERROR(
+      iree_lz4_decompress_block(chunk->source, chunk->target, &length));
+  if (length != chunk->target.data_length) {
+    return iree_make_status(IREE_STATUS_DATA_LOSS,
+                            "rodata chunk decompressed to %" PRIhsz
+                            " bytes but expected %" PRIhsz,
+                            length, chunk->target.data_length);
+  }
+  return iree_ok_status();
+}
+
+// Decompresses all compressed rodata segments in |module| into aligned buffers
+// allocated from the module allocator. Chunks of all segments are decompressed
+// concurrently using |executor| when provided.
+static iree_status_t iree_vm_bytecode_module_decompress_rodata(
+    iree_vm_bytecode_module_t* module, iree_host_size_t archive_rodata_offset,
+    const iree_vm_bytecode_loader_executor_t* executor) {
+  iree_vm_RodataSegmentDef_vec_t rodata_segments =
+      iree_vm_BytecodeModuleDef_rodata_segments(module->def);
+
+  // Count the chunks across all segments so that we can issue them at once.
+  // The chunk tables have been verified to be consistent.
+  iree_host_size_t chunk_count = 0;
+  for (iree_host_size_t i = 0; i < module->rodata_ref_count; ++i) {
+    iree_vm_RodataSegmentDef_table_t segment =
+        iree_vm_RodataSegmentDef_vec_at(rodata_segments, i);
+    if (iree_vm_RodataSegmentDef_compression_type_type(segment) !=
+        iree_vm_CompressionTypeDef_LZ4ChunkedDataDef) {
+      continue;
+    }
+    iree_vm_LZ4ChunkedDataDef_table_t compression_def =
+        (iree_vm_LZ4ChunkedDataDef_table_t)
+            iree_vm_RodataSegmentDef_compression_type(segment);
+    flatbuffers_uint64_vec_t chunk_offsets =
+        iree_vm_LZ4ChunkedDataDef_chunk_offsets(compression_def);
+    chunk_count += flatbuffers_uint64_vec_len(chunk_offsets) - 1;
+  }
+  if (chunk_count == 0) return iree_ok_status();
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, chunk_count);
+
+  iree_vm_bytecode_rodata_chunk_t* chunks = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(module->allocator,
+                                chunk_count * sizeof(*chunks),
+                                (void**)&chunks));
+
+  // Allocate the decompressed storage of each segment and partition it across
+  // the chunks. Buffers own their storage and are freed with the module.
+  iree_status_t status = iree_ok_status();
+  iree_host_size_t chunk_base = 0;
+  for (iree_host_size_t i = 0; i < module->rodata_ref_count; ++i) {
+    iree_vm_RodataSegmentDef_table_t segment =
+        iree_vm_RodataSegmentDef_vec_at(rodata_segments, i);
+    if (iree_vm_RodataSegmentDef_compression_type_type(segment) !=
+        iree_vm_CompressionTypeDef_LZ4ChunkedDataDef) {
+      continue;
+    }
+    iree_vm_LZ4ChunkedDataDef_table_t compression_def =
+        (iree_vm_LZ4ChunkedDataDef_table_t)
+            iree_vm_RodataSegmentDef_compression_type(segment);
+    iree_host_size_t decompressed_length =
+        (iree_host_size_t)iree_vm_LZ4ChunkedDataDef_decompressed_length(
+            compression_def);
+    iree_host_size_t chunk_length =
+        (iree_host_size_t)iree_vm_LZ4ChunkedDataDef_chunk_length(
+            compression_def);
+    flatbuffers_uint64_vec_t chunk_offsets =
+        iree_vm_LZ4ChunkedDataDef_chunk_offsets(compression_def);
+
+    // Decompressed data must be at least as aligned as the uncompressed
+    // segment would have been in the archive. We also align to what heap
+    // buffers require so that the data can be imported in-place by HAL
+    // devices.
+    iree_host_size_t alignment = iree_max(
+        (iree_host_size_t)iree_vm_LZ4ChunkedDataDef_alignment(compression_def),
+        (iree_host_size_t)IREE_HAL_HEAP_BUFFER_ALIGNMENT);
+    uint8_t* target_data = NULL;
+    if (decompressed_length > 0) {
+      status = iree_allocator_malloc_aligned(
+          module->allocator, decompressed_length, alignment, /*offset=*/0,
+          (void**)&target_data);
+      if (!iree_status_is_ok(status)) break;
+    }
+    iree_vm_buffer_initialize(
+        IREE_VM_BUFFER_ACCESS_ORIGIN_MODULE,
+        iree_make_byte_span(target_data, decompressed_length),
+        iree_allocator_null(), &module->rodata_ref_table[i]);
+
+    iree_const_byte_span_t contents = iree_vm_bytecode_module_rodata_contents(
+        module, segment, archive_rodata_offset);
+    iree_host_size_t segment_chunk_count =
+        flatbuffers_uint64_vec_len(chunk_offsets) - 1;
+    for (iree_host_size_t j = 0; j < segment_chunk_count; ++j) {
+      iree_host_size_t source_offset =
+          (iree_host_size_t)flatbuffers_uint64_vec_at(chunk_offsets, j);
+      iree_host_size_t source_end =
+          (iree_host_size_t)flatbuffers_uint64_vec_at(chunk_offsets, j + 1);
+      iree_host_size_t target_offset = j * chunk_length;
+      iree_vm_bytecode_rodata_chunk_t* chunk = &chunks[chunk_base + j];
+      chunk->source = iree_make_const_byte_span(
+          contents.data + source_offset, source_end - source_offset);
+      chunk->target = iree_make_byte_span(
+          target_data + target_offset,
+          iree_min(chunk_length, decompressed_length - target_offset));
+    }
+    chunk_base += segment_chunk_count;
+  }
+
+  if (iree_status_is_ok(status)) {
+    if (executor) {
+      status = executor->parallel_for(executor->self, chunk_count,
+                                      iree_vm_bytecode_module_decompress_chunk,
+                                      chunks);
+    } else {
+      for (iree_host_size_t i = 0; i < chunk_count; ++i) {
+        status = iree_vm_bytecode_module_decompress_chunk(chunks, i);
+        if (!iree_status_is_ok(status)) break;
+      }
+    }
+  }
+
+  iree_allocator_free(module->allocator, chunks);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create(
     iree_vm_instance_t* instance, iree_const_byte_span_t archive_contents,
     iree_allocator_t archive_allocator, iree_allocator_t allocator,
     iree_vm_module_t** out_module) {
+  iree_vm_bytecode_module_options_t options;
+  memset(&options, 0, sizeof(options));
+  return iree_vm_bytecode_module_create_with_options(
+      instance, archive_contents, archive_allocator, &options, allocator,
+      out_module);
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create_with_options(
+    iree_vm_instance_t* instance, iree_const_byte_span_t archive_contents,
+    iree_allocator_t archive_allocator,
+    const iree_vm_bytecode_module_options_t* options,
+    iree_allocator_t allocator, iree_vm_module_t** out_module) {
   IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_ASSERT_ARGUMENT(options);
   IREE_ASSERT_ARGUMENT(out_module);
   *out_module = NULL;
 
@@ -832,12 +1257,17 @@ IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create(
   size_t rodata_ref_table_size =
       iree_host_align(rodata_ref_count * sizeof(iree_vm_buffer_t), 16);
 
+  iree_host_size_t export_count = iree_vm_ExportFunctionDef_vec_len(
+      iree_vm_BytecodeModuleDef_exported_functions(module_def));
+  size_t export_table_size =
+      iree_host_align(export_count * sizeof(iree_vm_bytecode_export_t), 16);
+
   iree_vm_bytecode_module_t* module = NULL;
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0,
-      iree_allocator_malloc(
-          allocator, sizeof(*module) + type_table_size + rodata_ref_table_size,
-          (void**)&module));
+      z0, iree_allocator_malloc(allocator,
+                                sizeof(*module) + type_table_size +
+                                    rodata_ref_table_size + export_table_size,
+                                (void**)&module));
   module->allocator = allocator;
 
   iree_vm_FunctionDescriptor_vec_t function_descriptors =
@@ -885,6 +1315,7 @@ IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create(
   module->interface.notify = iree_vm_bytecode_module_notify;
   module->interface.begin_call = iree_vm_bytecode_module_begin_call;
   module->interface.resume_call = iree_vm_bytecode_module_resume_call;
+  module->interface.fork_state = iree_vm_bytecode_module_fork_state;
 
   // Setup rodata segments to point directly at the FlatBuffer memory.
   module->rodata_ref_count = rodata_ref_count;
@@ -892,43 +1323,63 @@ IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create(
       (iree_vm_buffer_t*)((uint8_t*)module + sizeof(*module) + type_table_size);
   iree_vm_RodataSegmentDef_vec_t rodata_segments =
       iree_vm_BytecodeModuleDef_rodata_segments(module_def);
+  iree_status_t rodata_status = iree_ok_status();
   for (int i = 0; i < module->rodata_ref_count; ++i) {
     iree_vm_RodataSegmentDef_table_t segment =
         iree_vm_RodataSegmentDef_vec_at(rodata_segments, i);
-    iree_byte_span_t byte_span = iree_byte_span_empty();
-    if (iree_vm_RodataSegmentDef_embedded_data_is_present(segment)) {
-      // Data is embedded in the FlatBuffer.
-      byte_span = iree_make_byte_span(
-          (uint8_t*)iree_vm_RodataSegmentDef_embedded_data(segment),
-          flatbuffers_uint8_vec_len(
-              iree_vm_RodataSegmentDef_embedded_data(segment)));
-    } else {
-      // Data is concatenated with the FlatBuffer at some relative offset.
-      // Note that we've already verified the referenced range is in bounds.
-      byte_span = iree_make_byte_span(
-          (uint8_t*)module->archive_contents.data + archive_rodata_offset +
-              iree_vm_RodataSegmentDef_external_data_offset(segment),
-          iree_vm_RodataSegmentDef_external_data_length(segment));
+    if (iree_vm_RodataSegmentDef_external_key_is_present(segment)) {
+      // Data is stored outside of the module and owned by the provider.
+      rodata_status = iree_vm_bytecode_module_resolve_parameter(
+          options->parameter_provider, segment, &module->rodata_ref_table[i]);
+      if (!iree_status_is_ok(rodata_status)) break;
+      continue;
     }
+    if (iree_vm_RodataSegmentDef_compression_type_type(segment) ==
+        iree_vm_CompressionTypeDef_LZ4ChunkedDataDef) {
+      continue;  // initialized when decompressed below
+    }
+    iree_const_byte_span_t contents = iree_vm_bytecode_module_rodata_contents(
+        module, segment, archive_rodata_offset);
     iree_vm_buffer_t* ref = &module->rodata_ref_table[i];
-    iree_vm_buffer_initialize(IREE_VM_BUFFER_ACCESS_ORIGIN_MODULE, byte_span,
-                              iree_allocator_null(), ref);
+    iree_vm_buffer_initialize(
+        IREE_VM_BUFFER_ACCESS_ORIGIN_MODULE,
+        iree_make_byte_span((uint8_t*)contents.data, contents.data_length),
+        iree_allocator_null(), ref);
+  }
+  if (iree_status_is_ok(rodata_status)) {
+    rodata_status = iree_vm_bytecode_module_decompress_rodata(
+        module, archive_rodata_offset, options->executor);
+  }
+
+  // Precompute the export table used when calling into the module.
+  module->export_count = export_count;
+  module->export_table =
+      (iree_vm_bytecode_export_t*)((uint8_t*)module + sizeof(*module) +
+                                   type_table_size + rodata_ref_table_size);
+  iree_status_t verify_status = rodata_status;
+  if (iree_status_is_ok(verify_status)) {
+    verify_status = iree_vm_bytecode_module_build_export_table(module);
   }
 
   // Verify functions in the module now that we've verified the metadata that we
   // need to do so.
-  iree_status_t verify_status = iree_ok_status();
 #if IREE_VM_BYTECODE_VERIFICATION_ENABLE
-  for (uint16_t i = 0; i < module->function_descriptor_count; ++i) {
+  for (uint16_t i = 0; iree_status_is_ok(verify_status) &&
+                       i < module->function_descriptor_count;
+       ++i) {
     IREE_TRACE_ZONE_BEGIN_NAMED(z1, "iree_vm_bytecode_function_verify");
     verify_status = iree_vm_bytecode_function_verify(module, i, allocator);
     IREE_TRACE_ZONE_END(z1);
-    if (!iree_status_is_ok(verify_status)) break;
   }
 #endif  // IREE_VM_BYTECODE_VERIFICATION_ENABLE
   if (iree_status_is_ok(verify_status)) {
+    iree_vm_bytecode_module_load_native_functions(module,
+                                                  options->native_loader);
     *out_module = &module->interface;
   } else {
+    // Release any parameters resolved or segments decompressed prior to the
+    // failure. Unresolved refs are zeroed and have nothing to release.
+    iree_vm_bytecode_module_release_rodata(module);
     iree_allocator_free(allocator, module);
   }
 
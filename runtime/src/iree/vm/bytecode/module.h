@@ -23,6 +23,99 @@ IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create(
     iree_allocator_t archive_allocator, iree_allocator_t allocator,
     iree_vm_module_t** out_module);
 
+// Resolves parameters stored outside of bytecode modules by key.
+//
+// Modules compiled with externalized parameters reference large constants by
+// the content hash of their data instead of embedding them in the archive. The
+// provider is queried once per parameter when the module is created and the
+// returned contents must remain valid until |out_deallocator| is used to free
+// them when the module is destroyed. Providers backed by files should map the
+// contents so that only the pages used are made resident and so that multiple
+// modules sharing a parameter share its memory.
+typedef struct iree_vm_bytecode_parameter_provider_t {
+  // User-defined pointer passed to all functions.
+  void* self;
+  // Resolves the parameter with the given |key| to its contents.
+  // |out_deallocator| is used to free |out_contents| when no longer required
+  // and may be iree_allocator_null() if the contents are owned elsewhere.
+  iree_status_t(IREE_API_PTR* resolve)(void* self, iree_string_view_t key,
+                                       iree_const_byte_span_t* out_contents,
+                                       iree_allocator_t* out_deallocator);
+} iree_vm_bytecode_parameter_provider_t;
+
+// Function invoked by the loader for each index of a parallel-for.
+typedef iree_status_t(IREE_API_PTR* iree_vm_bytecode_loader_work_fn_t)(
+    void* user_data, iree_host_size_t index);
+
+// Executes loader work concurrently, such as decompressing rodata segments.
+// Compatible with iree_task_executor_parallel_for.
+typedef struct iree_vm_bytecode_loader_executor_t {
+  // User-defined pointer passed to all functions.
+  void* self;
+  // Invokes |fn| once for each index in [0, |count|), potentially concurrently,
+  // and returns once all invocations have completed. Returns the failure of
+  // any invocation that failed.
+  iree_status_t(IREE_API_PTR* parallel_for)(
+      void* self, iree_host_size_t count, iree_vm_bytecode_loader_work_fn_t fn,
+      void* user_data);
+} iree_vm_bytecode_loader_executor_t;
+
+// Loads native code compiled ahead of time for exported functions.
+//
+// Modules may embed an object (such as an ELF or FatELF) containing a native
+// version of some of their exports. Each native function has the signature:
+//   int fn(const void* arguments, void* results, void* reserved);
+// where |arguments| and |results| are packed per the export calling convention
+// as with iree_vm_function_call_t. Functions return 0 on success and otherwise
+// an iree_status_code_t. Only exports taking and returning primitive values may
+// be native and native code has no access to module state or imports.
+typedef struct iree_vm_bytecode_native_loader_t {
+  // User-defined pointer passed to all functions.
+  void* self;
+  // Loads the native object |object_data| and returns it in |out_library|.
+  // |object_data| remains valid until the library is unloaded. Failure is not
+  // fatal and causes all functions in the module to be interpreted.
+  iree_status_t(IREE_API_PTR* load)(void* self,
+                                    iree_const_byte_span_t object_data,
+                                    void** out_library);
+  // Returns the entry point of the function |name| in |library| or NULL if the
+  // library does not contain it.
+  const void*(IREE_API_PTR* lookup)(void* self, void* library,
+                                    const char* name);
+  // Calls the native function |entry_point| with packed |arguments| and
+  // |results| and returns its result.
+  int(IREE_API_PTR* call)(void* self, const void* entry_point,
+                          const void* arguments, void* results);
+  // Unloads a |library| returned from load.
+  void(IREE_API_PTR* unload)(void* self, void* library);
+} iree_vm_bytecode_native_loader_t;
+
+// Options controlling how bytecode modules are loaded.
+typedef struct iree_vm_bytecode_module_options_t {
+  // Provider used to resolve externalized parameters. Loading fails if the
+  // module references any parameters and no provider is specified, if any are
+  // unavailable, or if their length does not match what the module expects.
+  const iree_vm_bytecode_parameter_provider_t* parameter_provider;
+  // Executor used to decompress compressed rodata segments concurrently.
+  // When omitted segments are decompressed serially on the calling thread.
+  const iree_vm_bytecode_loader_executor_t* executor;
+  // Loader used for native code embedded in the module. When omitted or when
+  // the embedded object cannot be loaded on the host all functions are
+  // interpreted from bytecode.
+  const iree_vm_bytecode_native_loader_t* native_loader;
+} iree_vm_bytecode_module_options_t;
+
+// Creates a VM module from an in-memory ModuleDef FlatBuffer archive as with
+// iree_vm_bytecode_module_create using the given load |options|.
+// Compressed rodata segments are decompressed into memory allocated from
+// |allocator| during creation. Ownership of |archive_contents| follows
+// iree_vm_bytecode_module_create.
+IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create_with_options(
+    iree_vm_instance_t* instance, iree_const_byte_span_t archive_contents,
+    iree_allocator_t archive_allocator,
+    const iree_vm_bytecode_module_options_t* options,
+    iree_allocator_t allocator, iree_vm_module_t** out_module);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
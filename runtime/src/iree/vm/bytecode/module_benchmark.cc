@@ -71,10 +71,14 @@ static iree_status_t native_import_module_create(
 }
 
 // Benchmarks the given exported function, optionally passing in arguments.
+// If |lookup_signature| is set the function signature is queried and its
+// calling convention parsed on each call, which is the per-call work begin_call
+// did before the module precomputed its export table.
 static iree_status_t RunFunction(benchmark::State& state,
                                  iree_string_view_t function_name,
                                  std::vector<int32_t> i32_args,
-                                 int result_count, int64_t batch_size = 1) {
+                                 int result_count, int64_t batch_size = 1,
+                                 bool lookup_signature = false) {
   iree_vm_instance_t* instance = NULL;
   IREE_CHECK_OK(iree_vm_instance_create(IREE_VM_TYPE_CAPACITY_DEFAULT,
                                         iree_allocator_system(), &instance));
@@ -120,6 +124,16 @@ static iree_status_t RunFunction(benchmark::State& state,
     for (iree_host_size_t i = 0; i < i32_args.size(); ++i) {
       reinterpret_cast<int32_t*>(call.arguments.data)[i] = i32_args[i];
     }
+    if (lookup_signature) {
+      iree_vm_function_signature_t signature =
+          iree_vm_function_signature(&call.function);
+      iree_string_view_t cconv_arguments = iree_string_view_empty();
+      iree_string_view_t cconv_results = iree_string_view_empty();
+      IREE_CHECK_OK(iree_vm_function_call_get_cconv_fragments(
+          &signature, &cconv_arguments, &cconv_results));
+      benchmark::DoNotOptimize(cconv_arguments);
+      benchmark::DoNotOptimize(cconv_results);
+    }
     IREE_CHECK_OK(
         bytecode_module->begin_call(bytecode_module->self, stack, call));
   }
@@ -241,6 +255,15 @@ static void BM_EmptyFuncBytecode(benchmark::State& state) {
 }
 BENCHMARK(BM_EmptyFuncBytecode);
 
+// Same as BM_EmptyFuncBytecode but walks the function metadata on each call;
+// the difference between the two is the saving of the export table.
+static void BM_EmptyFuncBytecodeSignatureLookup(benchmark::State& state) {
+  IREE_CHECK_OK(RunFunction(
+      state, iree_make_cstring_view("bytecode_module_benchmark.empty_func"), {},
+      /*result_count=*/0, /*batch_size=*/1, /*lookup_signature=*/true));
+}
+BENCHMARK(BM_EmptyFuncBytecodeSignatureLookup);
+
 IREE_ATTRIBUTE_NOINLINE static int add_fn(int value) {
   benchmark::DoNotOptimize(value += value);
   return value;
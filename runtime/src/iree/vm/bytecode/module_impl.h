@@ -12,12 +12,34 @@
 
 #include "iree/base/api.h"
 #include "iree/vm/api.h"
+#include "iree/vm/bytecode/module.h"
 #include "iree/vm/bytecode/utils/isa.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif  // __cplusplus
 
+// A precomputed exported function in the module export table.
+//
+// Calls into the module from outside (iree_vm_invoke, other modules, etc) are
+// mapped through this table instead of walking the FlatBuffer each call. Doing
+// so avoids cache misses (or page faults) on metadata that is otherwise unused
+// while executing, which can dominate the per-call overhead of small functions.
+typedef struct iree_vm_bytecode_export_t {
+  // Internal function ordinal in the function descriptor table.
+  uint16_t internal_ordinal;
+
+  // Pre-parsed argument/result calling convention string fragments pointing
+  // into the FlatBuffer. For example, 0ii.r will be split to arguments=ii and
+  // results=r.
+  iree_string_view_t arguments;
+  iree_string_view_t results;
+
+  // Entry point of the native version of the function or NULL if the function
+  // is interpreted from bytecode.
+  const void* native_entry_point;
+} iree_vm_bytecode_export_t;
+
 // A loaded bytecode module.
 typedef struct iree_vm_bytecode_module_t {
   // Interface routing to the bytecode module functions.
@@ -48,6 +70,15 @@ typedef struct iree_vm_bytecode_module_t {
   iree_host_size_t rodata_ref_count;
   iree_vm_buffer_t* rodata_ref_table;
 
+  // Precomputed exported function information indexed by export ordinal.
+  iree_host_size_t export_count;
+  iree_vm_bytecode_export_t* export_table;
+
+  // Loader and library providing native versions of exported functions.
+  // |native_library| is NULL when all functions are interpreted.
+  iree_vm_bytecode_native_loader_t native_loader;
+  void* native_library;
+
   // Type table mapping module type IDs to registered VM types.
   iree_host_size_t type_count;
   iree_vm_type_def_t type_table[];
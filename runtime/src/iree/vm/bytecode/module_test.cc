@@ -10,7 +10,10 @@
 
 #include "iree/vm/bytecode/module.h"
 
+#include <cstring>
 #include <memory>
+#include <string>
+#include <utility>
 #include <vector>
 
 #include "iree/base/api.h"
@@ -100,12 +103,15 @@ static std::vector<iree_vm_ref_t> MakeNullRefList(size_t count) {
 
 namespace {
 
+using iree::Status;
 using iree::StatusCode;
 using iree::StatusOr;
 using iree::testing::status::IsOkAndHolds;
 using iree::testing::status::StatusIs;
 using iree::vm::ref;
+using testing::Contains;
 using testing::Eq;
+using testing::Not;
 
 class VMBytecodeModuleTest : public ::testing::Test {
  protected:
@@ -135,6 +141,12 @@ class VMBytecodeModuleTest : public ::testing::Test {
 
   StatusOr<std::vector<iree_vm_value_t>> RunFunction(
       const char* function_name, std::vector<iree_vm_value_t> inputs) {
+    return RunFunction(context_, function_name, std::move(inputs));
+  }
+
+  StatusOr<std::vector<iree_vm_value_t>> RunFunction(
+      iree_vm_context_t* context, const char* function_name,
+      std::vector<iree_vm_value_t> inputs) {
     ref<iree_vm_list_t> input_list;
     IREE_RETURN_IF_ERROR(
         iree_vm_list_create(iree_vm_make_undefined_type_def(), inputs.size(),
@@ -155,7 +167,7 @@ class VMBytecodeModuleTest : public ::testing::Test {
         bytecode_module_, IREE_VM_FUNCTION_LINKAGE_EXPORT,
         iree_make_cstring_view(function_name), &function));
     IREE_RETURN_IF_ERROR(
-        iree_vm_invoke(context_, function, IREE_VM_INVOCATION_FLAG_NONE,
+        iree_vm_invoke(context, function, IREE_VM_INVOCATION_FLAG_NONE,
                        /*policy=*/nullptr, input_list.get(), output_list.get(),
                        iree_allocator_system()));
 
@@ -170,6 +182,12 @@ class VMBytecodeModuleTest : public ::testing::Test {
 
   StatusOr<std::vector<iree_vm_ref_t>> RunFunction(
       const char* function_name, std::vector<iree_vm_ref_t> inputs) {
+    return RunFunction(context_, function_name, std::move(inputs));
+  }
+
+  StatusOr<std::vector<iree_vm_ref_t>> RunFunction(
+      iree_vm_context_t* context, const char* function_name,
+      std::vector<iree_vm_ref_t> inputs) {
     ref<iree_vm_list_t> input_list;
     IREE_RETURN_IF_ERROR(
         iree_vm_list_create(iree_vm_make_undefined_type_def(), inputs.size(),
@@ -190,7 +208,7 @@ class VMBytecodeModuleTest : public ::testing::Test {
         bytecode_module_, IREE_VM_FUNCTION_LINKAGE_EXPORT,
         iree_make_cstring_view(function_name), &function));
     IREE_RETURN_IF_ERROR(
-        iree_vm_invoke(context_, function, IREE_VM_INVOCATION_FLAG_NONE,
+        iree_vm_invoke(context, function, IREE_VM_INVOCATION_FLAG_NONE,
                        /*policy=*/nullptr, input_list.get(), output_list.get(),
                        iree_allocator_system()));
 
@@ -228,4 +246,283 @@ TEST_F(VMBytecodeModuleTest, FuncIO600) {
               IsOkAndHolds(Eq(MakeNullRefList(600))));
 }
 
+// Calls into the module from outside are mapped through the export table built
+// when the module is created. Calling directly with the export ordinal must
+// land in the right function with the right calling convention.
+TEST_F(VMBytecodeModuleTest, BeginCallByExportOrdinal) {
+  iree_vm_function_t function;
+  IREE_ASSERT_OK(iree_vm_module_lookup_function_by_name(
+      bytecode_module_, IREE_VM_FUNCTION_LINKAGE_EXPORT,
+      iree_make_cstring_view("FuncIO1"), &function));
+  ASSERT_EQ(function.linkage, IREE_VM_FUNCTION_LINKAGE_EXPORT);
+
+  int32_t argument = 42;
+  int32_t result = 0;
+  iree_vm_function_call_t call;
+  memset(&call, 0, sizeof(call));
+  call.function = function;
+  call.arguments = iree_make_byte_span(&argument, sizeof(argument));
+  call.results = iree_make_byte_span(&result, sizeof(result));
+
+  IREE_VM_INLINE_STACK_INITIALIZE(stack, IREE_VM_INVOCATION_FLAG_NONE,
+                                  iree_vm_context_state_resolver(context_),
+                                  iree_allocator_system());
+  IREE_EXPECT_OK(
+      bytecode_module_->begin_call(bytecode_module_->self, stack, call));
+  iree_vm_stack_deinitialize(stack);
+  EXPECT_EQ(result, 42);
+}
+
+// Only exports have entries in the export table; anything else is rejected
+// before any bytecode is executed.
+TEST_F(VMBytecodeModuleTest, BeginCallInvalidFunction) {
+  iree_vm_module_signature_t signature =
+      iree_vm_module_signature(bytecode_module_);
+  iree_vm_function_call_t call;
+  memset(&call, 0, sizeof(call));
+  call.function.module = bytecode_module_;
+
+  IREE_VM_INLINE_STACK_INITIALIZE(stack, IREE_VM_INVOCATION_FLAG_NONE,
+                                  iree_vm_context_state_resolver(context_),
+                                  iree_allocator_system());
+
+  call.function.linkage = IREE_VM_FUNCTION_LINKAGE_EXPORT;
+  call.function.ordinal =
+      static_cast<uint16_t>(signature.export_function_count);
+  EXPECT_THAT(
+      Status(bytecode_module_->begin_call(bytecode_module_->self, stack, call)),
+      StatusIs(StatusCode::kInvalidArgument));
+
+  call.function.linkage = IREE_VM_FUNCTION_LINKAGE_INTERNAL;
+  call.function.ordinal = 0;
+  EXPECT_THAT(
+      Status(bytecode_module_->begin_call(bytecode_module_->self, stack, call)),
+      StatusIs(StatusCode::kInvalidArgument));
+
+  iree_vm_stack_deinitialize(stack);
+}
+
+// Forked contexts get their own copy of primitive globals while sharing the
+// objects referenced by ref globals set by the initializer with the parent;
+// __init is not run again.
+TEST_F(VMBytecodeModuleTest, Fork) {
+  // __init ran once when the context was created.
+  EXPECT_THAT(RunFunction("ForkAddCounter", MakeValuesList({0})),
+              IsOkAndHolds(Eq(MakeValuesList({1}))));
+  EXPECT_THAT(RunFunction("ForkAddCounter", MakeValuesList({4})),
+              IsOkAndHolds(Eq(MakeValuesList({5}))));
+
+  iree_vm_context_t* forked_context = nullptr;
+  IREE_ASSERT_OK(
+      iree_vm_context_fork(context_, iree_allocator_system(), &forked_context));
+
+  // rwdata was copied from the parent and then diverges.
+  EXPECT_THAT(
+      RunFunction(forked_context, "ForkAddCounter", MakeValuesList({0})),
+      IsOkAndHolds(Eq(MakeValuesList({5}))));
+  EXPECT_THAT(
+      RunFunction(forked_context, "ForkAddCounter", MakeValuesList({2})),
+      IsOkAndHolds(Eq(MakeValuesList({7}))));
+  EXPECT_THAT(RunFunction("ForkAddCounter", MakeValuesList({1})),
+              IsOkAndHolds(Eq(MakeValuesList({6}))));
+
+  // The buffer allocated by __init is the same object in both contexts.
+  IREE_ASSERT_OK_AND_ASSIGN(
+      auto parent_buffers,
+      RunFunction("ForkGetBuffer", std::vector<iree_vm_ref_t>()));
+  IREE_ASSERT_OK_AND_ASSIGN(
+      auto forked_buffers,
+      RunFunction(forked_context, "ForkGetBuffer",
+                  std::vector<iree_vm_ref_t>()));
+  ASSERT_EQ(parent_buffers.size(), 1);
+  ASSERT_EQ(forked_buffers.size(), 1);
+  EXPECT_FALSE(iree_vm_ref_is_null(&parent_buffers[0]));
+  EXPECT_EQ(parent_buffers[0], forked_buffers[0]);
+  iree_vm_ref_release(&forked_buffers[0]);
+
+  // The fork retains the ref globals and outlives the parent.
+  iree_vm_context_release(context_);
+  context_ = nullptr;
+  IREE_ASSERT_OK_AND_ASSIGN(
+      forked_buffers, RunFunction(forked_context, "ForkGetBuffer",
+                                  std::vector<iree_vm_ref_t>()));
+  ASSERT_EQ(forked_buffers.size(), 1);
+  EXPECT_EQ(parent_buffers[0], forked_buffers[0]);
+  iree_vm_ref_release(&forked_buffers[0]);
+  iree_vm_ref_release(&parent_buffers[0]);
+
+  iree_vm_context_release(forked_context);
+}
+
+// Objects referenced by mutable ref globals would be shared with the fork and
+// forking is refused until they are cleared.
+TEST_F(VMBytecodeModuleTest, ForkMutableRefGlobal) {
+  IREE_ASSERT_OK_AND_ASSIGN(
+      auto cache_buffers,
+      RunFunction("ForkSetCache", std::vector<iree_vm_ref_t>()));
+  ASSERT_EQ(cache_buffers.size(), 1);
+  iree_vm_ref_release(&cache_buffers[0]);
+
+  iree_vm_context_t* forked_context = nullptr;
+  EXPECT_THAT(Status(iree_vm_context_fork(context_, iree_allocator_system(),
+                                          &forked_context)),
+              StatusIs(StatusCode::kFailedPrecondition));
+  EXPECT_EQ(forked_context, nullptr);
+}
+
+// Native functions as called by the loader:
+// int fn(const void* arguments, void* results, void* reserved).
+typedef int (*NativeFunction)(const void* arguments, void* results,
+                              void* reserved);
+
+// Native version of NativeSub taking (i32, i32) and returning i32.
+static int NativeSub(const void* arguments, void* results, void* reserved) {
+  int32_t args[2];
+  memcpy(args, arguments, sizeof(args));
+  int32_t result = args[0] - args[1];
+  memcpy(results, &result, sizeof(result));
+  return 0;
+}
+
+// Loader standing in for a platform loader that records how it is used.
+// The embedded object is a placeholder and NativeSub is the only function
+// present in it.
+class FakeNativeLoader {
+ public:
+  FakeNativeLoader() {
+    interface_.self = this;
+    interface_.load = Load;
+    interface_.lookup = Lookup;
+    interface_.call = Call;
+    interface_.unload = Unload;
+  }
+
+  const iree_vm_bytecode_native_loader_t* interface() const {
+    return &interface_;
+  }
+
+  bool fail_load = false;
+  bool loaded = false;
+  bool unloaded = false;
+  std::vector<std::string> lookups;
+  int call_count = 0;
+
+ private:
+  static iree_status_t Load(void* self, iree_const_byte_span_t object_data,
+                            void** out_library) {
+    auto* loader = reinterpret_cast<FakeNativeLoader*>(self);
+    static const uint8_t kExpectedData[] = {1, 2, 3, 4};
+    if (object_data.data_length != sizeof(kExpectedData) ||
+        memcmp(object_data.data, kExpectedData, sizeof(kExpectedData)) != 0) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "unexpected object data");
+    }
+    if (loader->fail_load) {
+      return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                              "object built for another architecture");
+    }
+    loader->loaded = true;
+    *out_library = loader;
+    return iree_ok_status();
+  }
+
+  static const void* Lookup(void* self, void* library, const char* name) {
+    auto* loader = reinterpret_cast<FakeNativeLoader*>(self);
+    loader->lookups.push_back(name);
+    if (strcmp(name, "NativeSub") == 0) {
+      return reinterpret_cast<const void*>(NativeSub);
+    }
+    return nullptr;
+  }
+
+  static int Call(void* self, const void* entry_point, const void* arguments,
+                  void* results) {
+    auto* loader = reinterpret_cast<FakeNativeLoader*>(self);
+    ++loader->call_count;
+    auto fn = reinterpret_cast<NativeFunction>(entry_point);
+    return fn(arguments, results, /*reserved=*/nullptr);
+  }
+
+  static void Unload(void* self, void* library) {
+    auto* loader = reinterpret_cast<FakeNativeLoader*>(self);
+    loader->unloaded = true;
+  }
+
+  iree_vm_bytecode_native_loader_t interface_;
+};
+
+// Recreates the test module with a native loader. The loader is a member so
+// that it outlives the module released in TearDown.
+class VMBytecodeModuleNativeTest : public VMBytecodeModuleTest {
+ protected:
+  iree_status_t RecreateModule() {
+    iree_vm_context_release(context_);
+    context_ = nullptr;
+    iree_vm_module_release(bytecode_module_);
+    bytecode_module_ = nullptr;
+
+    const auto* module_file_toc = iree_vm_bytecode_module_test_module_create();
+    iree_vm_bytecode_module_options_t options;
+    memset(&options, 0, sizeof(options));
+    options.native_loader = native_loader_.interface();
+    IREE_RETURN_IF_ERROR(iree_vm_bytecode_module_create_with_options(
+        instance_,
+        iree_const_byte_span_t{
+            reinterpret_cast<const uint8_t*>(module_file_toc->data),
+            static_cast<iree_host_size_t>(module_file_toc->size)},
+        iree_allocator_null(), &options, iree_allocator_system(),
+        &bytecode_module_));
+
+    std::vector<iree_vm_module_t*> modules = {bytecode_module_};
+    return iree_vm_context_create_with_modules(
+        instance_, IREE_VM_CONTEXT_FLAG_NONE, modules.size(), modules.data(),
+        iree_allocator_system(), &context_);
+  }
+
+  FakeNativeLoader native_loader_;
+};
+
+// Without a loader everything is interpreted.
+TEST_F(VMBytecodeModuleTest, NativeFunctionInterpreted) {
+  EXPECT_THAT(RunFunction("NativeSub", MakeValuesList({7, 3})),
+              IsOkAndHolds(Eq(MakeValuesList({4}))));
+}
+
+// Exports taking and returning only primitives are looked up in the loaded
+// object and those present are called natively; the rest are interpreted.
+TEST_F(VMBytecodeModuleNativeTest, NativeFunctionCalled) {
+  IREE_ASSERT_OK(RecreateModule());
+  EXPECT_TRUE(native_loader_.loaded);
+  EXPECT_THAT(native_loader_.lookups, Contains("NativeSub"));
+  EXPECT_THAT(native_loader_.lookups, Contains("FuncIO1"));
+  EXPECT_THAT(native_loader_.lookups, Not(Contains("FuncIO600")));
+  EXPECT_THAT(native_loader_.lookups, Not(Contains("ForkGetBuffer")));
+
+  EXPECT_THAT(RunFunction("NativeSub", MakeValuesList({7, 3})),
+              IsOkAndHolds(Eq(MakeValuesList({4}))));
+  EXPECT_EQ(native_loader_.call_count, 1);
+  EXPECT_THAT(RunFunction("FuncIO1", MakeValuesList({1})),
+              IsOkAndHolds(Eq(MakeValuesList({1}))));
+  EXPECT_EQ(native_loader_.call_count, 1);
+
+  iree_vm_context_release(context_);
+  context_ = nullptr;
+  iree_vm_module_release(bytecode_module_);
+  bytecode_module_ = nullptr;
+  EXPECT_TRUE(native_loader_.unloaded);
+}
+
+// Objects that fail to load (such as those for another architecture) are not
+// fatal and all functions are interpreted.
+TEST_F(VMBytecodeModuleNativeTest, NativeFunctionLoadFailure) {
+  native_loader_.fail_load = true;
+  IREE_ASSERT_OK(RecreateModule());
+  EXPECT_FALSE(native_loader_.loaded);
+  EXPECT_TRUE(native_loader_.lookups.empty());
+
+  EXPECT_THAT(RunFunction("NativeSub", MakeValuesList({7, 3})),
+              IsOkAndHolds(Eq(MakeValuesList({4}))));
+  EXPECT_EQ(native_loader_.call_count, 0);
+}
+
 }  // namespace
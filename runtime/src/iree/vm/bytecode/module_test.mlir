@@ -1,4 +1,6 @@
-vm.module @bytecode_module_test {
+vm.module @bytecode_module_test attributes {
+  vm.native_functions = @native_functions
+} {
   // Tests no arguments or results.
   vm.export @FuncIOEmpty
   vm.func @FuncIOEmpty() {
@@ -25,4 +27,59 @@ vm.module @bytecode_module_test {
   vm.func @FuncIO600(%0: !vm.ref<?>, %1: !vm.ref<?>, %2: !vm.ref<?>, %3: !vm.ref<?>, %4: !vm.ref<?>, %5: !vm.ref<?>, %6: !vm.ref<?>, %7: !vm.ref<?>, %8: !vm.ref<?>, %9: !vm.ref<?>, %10: !vm.ref<?>, %11: !vm.ref<?>, %12: !vm.ref<?>, %13: !vm.ref<?>, %14: !vm.ref<?>, %15: !vm.ref<?>, %16: !vm.ref<?>, %17: !vm.ref<?>, %18: !vm.ref<?>, %19: !vm.ref<?>, %20: !vm.ref<?>, %21: !vm.ref<?>, %22: !vm.ref<?>, %23: !vm.ref<?>, %24: !vm.ref<?>, %25: !vm.ref<?>, %26: !vm.ref<?>, %27: !vm.ref<?>, %28: !vm.ref<?>, %29: !vm.ref<?>, %30: !vm.ref<?>, %31: !vm.ref<?>, %32: !vm.ref<?>, %33: !vm.ref<?>, %34: !vm.ref<?>, %35: !vm.ref<?>, %36: !vm.ref<?>, %37: !vm.ref<?>, %38: !vm.ref<?>, %39: !vm.ref<?>, %40: !vm.ref<?>, %41: !vm.ref<?>, %42: !vm.ref<?>, %43: !vm.ref<?>, %44: !vm.ref<?>, %45: !vm.ref<?>, %46: !vm.ref<?>, %47: !vm.ref<?>, %48: !vm.ref<?>, %49: !vm.ref<?>, %50: !vm.ref<?>, %51: !vm.ref<?>, %52: !vm.ref<?>, %53: !vm.ref<?>, %54: !vm.ref<?>, %55: !vm.ref<?>, %56: !vm.ref<?>, %57: !vm.ref<?>, %58: !vm.ref<?>, %59: !vm.ref<?>, %60: !vm.ref<?>, %61: !vm.ref<?>, %62: !vm.ref<?>, %63: !vm.ref<?>, %64: !vm.ref<?>, %65: !vm.ref<?>, %66: !vm.ref<?>, %67: !vm.ref<?>, %68: !vm.ref<?>, %69: !vm.ref<?>, %70: !vm.ref<?>, %71: !vm.ref<?>, %72: !vm.ref<?>, %73: !vm.ref<?>, %74: !vm.ref<?>, %75: !vm.ref<?>, %76: !vm.ref<?>, %77: !vm.ref<?>, %78: !vm.ref<?>, %79: !vm.ref<?>, %80: !vm.ref<?>, %81: !vm.ref<?>, %82: !vm.ref<?>, %83: !vm.ref<?>, %84: !vm.ref<?>, %85: !vm.ref<?>, %86: !vm.ref<?>, %87: !vm.ref<?>, %88: !vm.ref<?>, %89: !vm.ref<?>, %90: !vm.ref<?>, %91: !vm.ref<?>, %92: !vm.ref<?>, %93: !vm.ref<?>, %94: !vm.ref<?>, %95: !vm.ref<?>, %96: !vm.ref<?>, %97: !vm.ref<?>, %98: !vm.ref<?>, %99: !vm.ref<?>, %100: !vm.ref<?>, %101: !vm.ref<?>, %102: !vm.ref<?>, %103: !vm.ref<?>, %104: !vm.ref<?>, %105: !vm.ref<?>, %106: !vm.ref<?>, %107: !vm.ref<?>, %108: !vm.ref<?>, %109: !vm.ref<?>, %110: !vm.ref<?>, %111: !vm.ref<?>, %112: !vm.ref<?>, %113: !vm.ref<?>, %114: !vm.ref<?>, %115: !vm.ref<?>, %116: !vm.ref<?>, %117: !vm.ref<?>, %118: !vm.ref<?>, %119: !vm.ref<?>, %120: !vm.ref<?>, %121: !vm.ref<?>, %122: !vm.ref<?>, %123: !vm.ref<?>, %124: !vm.ref<?>, %125: !vm.ref<?>, %126: !vm.ref<?>, %127: !vm.ref<?>, %128: !vm.ref<?>, %129: !vm.ref<?>, %130: !vm.ref<?>, %131: !vm.ref<?>, %132: !vm.ref<?>, %133: !vm.ref<?>, %134: !vm.ref<?>, %135: !vm.ref<?>, %136: !vm.ref<?>, %137: !vm.ref<?>, %138: !vm.ref<?>, %139: !vm.ref<?>, %140: !vm.ref<?>, %141: !vm.ref<?>, %142: !vm.ref<?>, %143: !vm.ref<?>, %144: !vm.ref<?>, %145: !vm.ref<?>, %146: !vm.ref<?>, %147: !vm.ref<?>, %148: !vm.ref<?>, %149: !vm.ref<?>, %150: !vm.ref<?>, %151: !vm.ref<?>, %152: !vm.ref<?>, %153: !vm.ref<?>, %154: !vm.ref<?>, %155: !vm.ref<?>, %156: !vm.ref<?>, %157: !vm.ref<?>, %158: !vm.ref<?>, %159: !vm.ref<?>, %160: !vm.ref<?>, %161: !vm.ref<?>, %162: !vm.ref<?>, %163: !vm.ref<?>, %164: !vm.ref<?>, %165: !vm.ref<?>, %166: !vm.ref<?>, %167: !vm.ref<?>, %168: !vm.ref<?>, %169: !vm.ref<?>, %170: !vm.ref<?>, %171: !vm.ref<?>, %172: !vm.ref<?>, %173: !vm.ref<?>, %174: !vm.ref<?>, %175: !vm.ref<?>, %176: !vm.ref<?>, %177: !vm.ref<?>, %178: !vm.ref<?>, %179: !vm.ref<?>, %180: !vm.ref<?>, %181: !vm.ref<?>, %182: !vm.ref<?>, %183: !vm.ref<?>, %184: !vm.ref<?>, %185: !vm.ref<?>, %186: !vm.ref<?>, %187: !vm.ref<?>, %188: !vm.ref<?>, %189: !vm.ref<?>, %190: !vm.ref<?>, %191: !vm.ref<?>, %192: !vm.ref<?>, %193: !vm.ref<?>, %194: !vm.ref<?>, %195: !vm.ref<?>, %196: !vm.ref<?>, %197: !vm.ref<?>, %198: !vm.ref<?>, %199: !vm.ref<?>, %200: !vm.ref<?>, %201: !vm.ref<?>, %202: !vm.ref<?>, %203: !vm.ref<?>, %204: !vm.ref<?>, %205: !vm.ref<?>, %206: !vm.ref<?>, %207: !vm.ref<?>, %208: !vm.ref<?>, %209: !vm.ref<?>, %210: !vm.ref<?>, %211: !vm.ref<?>, %212: !vm.ref<?>, %213: !vm.ref<?>, %214: !vm.ref<?>, %215: !vm.ref<?>, %216: !vm.ref<?>, %217: !vm.ref<?>, %218: !vm.ref<?>, %219: !vm.ref<?>, %220: !vm.ref<?>, %221: !vm.ref<?>, %222: !vm.ref<?>, %223: !vm.ref<?>, %224: !vm.ref<?>, %225: !vm.ref<?>, %226: !vm.ref<?>, %227: !vm.ref<?>, %228: !vm.ref<?>, %229: !vm.ref<?>, %230: !vm.ref<?>, %231: !vm.ref<?>, %232: !vm.ref<?>, %233: !vm.ref<?>, %234: !vm.ref<?>, %235: !vm.ref<?>, %236: !vm.ref<?>, %237: !vm.ref<?>, %238: !vm.ref<?>, %239: !vm.ref<?>, %240: !vm.ref<?>, %241: !vm.ref<?>, %242: !vm.ref<?>, %243: !vm.ref<?>, %244: !vm.ref<?>, %245: !vm.ref<?>, %246: !vm.ref<?>, %247: !vm.ref<?>, %248: !vm.ref<?>, %249: !vm.ref<?>, %250: !vm.ref<?>, %251: !vm.ref<?>, %252: !vm.ref<?>, %253: !vm.ref<?>, %254: !vm.ref<?>, %255: !vm.ref<?>, %256: !vm.ref<?>, %257: !vm.ref<?>, %258: !vm.ref<?>, %259: !vm.ref<?>, %260: !vm.ref<?>, %261: !vm.ref<?>, %262: !vm.ref<?>, %263: !vm.ref<?>, %264: !vm.ref<?>, %265: !vm.ref<?>, %266: !vm.ref<?>, %267: !vm.ref<?>, %268: !vm.ref<?>, %269: !vm.ref<?>, %270: !vm.ref<?>, %271: !vm.ref<?>, %272: !vm.ref<?>, %273: !vm.ref<?>, %274: !vm.ref<?>, %275: !vm.ref<?>, %276: !vm.ref<?>, %277: !vm.ref<?>, %278: !vm.ref<?>, %279: !vm.ref<?>, %280: !vm.ref<?>, %281: !vm.ref<?>, %282: !vm.ref<?>, %283: !vm.ref<?>, %284: !vm.ref<?>, %285: !vm.ref<?>, %286: !vm.ref<?>, %287: !vm.ref<?>, %288: !vm.ref<?>, %289: !vm.ref<?>, %290: !vm.ref<?>, %291: !vm.ref<?>, %292: !vm.ref<?>, %293: !vm.ref<?>, %294: !vm.ref<?>, %295: !vm.ref<?>, %296: !vm.ref<?>, %297: !vm.ref<?>, %298: !vm.ref<?>, %299: !vm.ref<?>, %300: !vm.ref<?>, %301: !vm.ref<?>, %302: !vm.ref<?>, %303: !vm.ref<?>, %304: !vm.ref<?>, %305: !vm.ref<?>, %306: !vm.ref<?>, %307: !vm.ref<?>, %308: !vm.ref<?>, %309: !vm.ref<?>, %310: !vm.ref<?>, %311: !vm.ref<?>, %312: !vm.ref<?>, %313: !vm.ref<?>, %314: !vm.ref<?>, %315: !vm.ref<?>, %316: !vm.ref<?>, %317: !vm.ref<?>, %318: !vm.ref<?>, %319: !vm.ref<?>, %320: !vm.ref<?>, %321: !vm.ref<?>, %322: !vm.ref<?>, %323: !vm.ref<?>, %324: !vm.ref<?>, %325: !vm.ref<?>, %326: !vm.ref<?>, %327: !vm.ref<?>, %328: !vm.ref<?>, %329: !vm.ref<?>, %330: !vm.ref<?>, %331: !vm.ref<?>, %332: !vm.ref<?>, %333: !vm.ref<?>, %334: !vm.ref<?>, %335: !vm.ref<?>, %336: !vm.ref<?>, %337: !vm.ref<?>, %338: !vm.ref<?>, %339: !vm.ref<?>, %340: !vm.ref<?>, %341: !vm.ref<?>, %342: !vm.ref<?>, %343: !vm.ref<?>, %344: !vm.ref<?>, %345: !vm.ref<?>, %346: !vm.ref<?>, %347: !vm.ref<?>, %348: !vm.ref<?>, %349: !vm.ref<?>, %350: !vm.ref<?>, %351: !vm.ref<?>, %352: !vm.ref<?>, %353: !vm.ref<?>, %354: !vm.ref<?>, %355: !vm.ref<?>, %356: !vm.ref<?>, %357: !vm.ref<?>, %358: !vm.ref<?>, %359: !vm.ref<?>, %360: !vm.ref<?>, %361: !vm.ref<?>, %362: !vm.ref<?>, %363: !vm.ref<?>, %364: !vm.ref<?>, %365: !vm.ref<?>, %366: !vm.ref<?>, %367: !vm.ref<?>, %368: !vm.ref<?>, %369: !vm.ref<?>, %370: !vm.ref<?>, %371: !vm.ref<?>, %372: !vm.ref<?>, %373: !vm.ref<?>, %374: !vm.ref<?>, %375: !vm.ref<?>, %376: !vm.ref<?>, %377: !vm.ref<?>, %378: !vm.ref<?>, %379: !vm.ref<?>, %380: !vm.ref<?>, %381: !vm.ref<?>, %382: !vm.ref<?>, %383: !vm.ref<?>, %384: !vm.ref<?>, %385: !vm.ref<?>, %386: !vm.ref<?>, %387: !vm.ref<?>, %388: !vm.ref<?>, %389: !vm.ref<?>, %390: !vm.ref<?>, %391: !vm.ref<?>, %392: !vm.ref<?>, %393: !vm.ref<?>, %394: !vm.ref<?>, %395: !vm.ref<?>, %396: !vm.ref<?>, %397: !vm.ref<?>, %398: !vm.ref<?>, %399: !vm.ref<?>, %400: !vm.ref<?>, %401: !vm.ref<?>, %402: !vm.ref<?>, %403: !vm.ref<?>, %404: !vm.ref<?>, %405: !vm.ref<?>, %406: !vm.ref<?>, %407: !vm.ref<?>, %408: !vm.ref<?>, %409: !vm.ref<?>, %410: !vm.ref<?>, %411: !vm.ref<?>, %412: !vm.ref<?>, %413: !vm.ref<?>, %414: !vm.ref<?>, %415: !vm.ref<?>, %416: !vm.ref<?>, %417: !vm.ref<?>, %418: !vm.ref<?>, %419: !vm.ref<?>, %420: !vm.ref<?>, %421: !vm.ref<?>, %422: !vm.ref<?>, %423: !vm.ref<?>, %424: !vm.ref<?>, %425: !vm.ref<?>, %426: !vm.ref<?>, %427: !vm.ref<?>, %428: !vm.ref<?>, %429: !vm.ref<?>, %430: !vm.ref<?>, %431: !vm.ref<?>, %432: !vm.ref<?>, %433: !vm.ref<?>, %434: !vm.ref<?>, %435: !vm.ref<?>, %436: !vm.ref<?>, %437: !vm.ref<?>, %438: !vm.ref<?>, %439: !vm.ref<?>, %440: !vm.ref<?>, %441: !vm.ref<?>, %442: !vm.ref<?>, %443: !vm.ref<?>, %444: !vm.ref<?>, %445: !vm.ref<?>, %446: !vm.ref<?>, %447: !vm.ref<?>, %448: !vm.ref<?>, %449: !vm.ref<?>, %450: !vm.ref<?>, %451: !vm.ref<?>, %452: !vm.ref<?>, %453: !vm.ref<?>, %454: !vm.ref<?>, %455: !vm.ref<?>, %456: !vm.ref<?>, %457: !vm.ref<?>, %458: !vm.ref<?>, %459: !vm.ref<?>, %460: !vm.ref<?>, %461: !vm.ref<?>, %462: !vm.ref<?>, %463: !vm.ref<?>, %464: !vm.ref<?>, %465: !vm.ref<?>, %466: !vm.ref<?>, %467: !vm.ref<?>, %468: !vm.ref<?>, %469: !vm.ref<?>, %470: !vm.ref<?>, %471: !vm.ref<?>, %472: !vm.ref<?>, %473: !vm.ref<?>, %474: !vm.ref<?>, %475: !vm.ref<?>, %476: !vm.ref<?>, %477: !vm.ref<?>, %478: !vm.ref<?>, %479: !vm.ref<?>, %480: !vm.ref<?>, %481: !vm.ref<?>, %482: !vm.ref<?>, %483: !vm.ref<?>, %484: !vm.ref<?>, %485: !vm.ref<?>, %486: !vm.ref<?>, %487: !vm.ref<?>, %488: !vm.ref<?>, %489: !vm.ref<?>, %490: !vm.ref<?>, %491: !vm.ref<?>, %492: !vm.ref<?>, %493: !vm.ref<?>, %494: !vm.ref<?>, %495: !vm.ref<?>, %496: !vm.ref<?>, %497: !vm.ref<?>, %498: !vm.ref<?>, %499: !vm.ref<?>, %500: !vm.ref<?>, %501: !vm.ref<?>, %502: !vm.ref<?>, %503: !vm.ref<?>, %504: !vm.ref<?>, %505: !vm.ref<?>, %506: !vm.ref<?>, %507: !vm.ref<?>, %508: !vm.ref<?>, %509: !vm.ref<?>, %510: !vm.ref<?>, %511: !vm.ref<?>, %512: !vm.ref<?>, %513: !vm.ref<?>, %514: !vm.ref<?>, %515: !vm.ref<?>, %516: !vm.ref<?>, %517: !vm.ref<?>, %518: !vm.ref<?>, %519: !vm.ref<?>, %520: !vm.ref<?>, %521: !vm.ref<?>, %522: !vm.ref<?>, %523: !vm.ref<?>, %524: !vm.ref<?>, %525: !vm.ref<?>, %526: !vm.ref<?>, %527: !vm.ref<?>, %528: !vm.ref<?>, %529: !vm.ref<?>, %530: !vm.ref<?>, %531: !vm.ref<?>, %532: !vm.ref<?>, %533: !vm.ref<?>, %534: !vm.ref<?>, %535: !vm.ref<?>, %536: !vm.ref<?>, %537: !vm.ref<?>, %538: !vm.ref<?>, %539: !vm.ref<?>, %540: !vm.ref<?>, %541: !vm.ref<?>, %542: !vm.ref<?>, %543: !vm.ref<?>, %544: !vm.ref<?>, %545: !vm.ref<?>, %546: !vm.ref<?>, %547: !vm.ref<?>, %548: !vm.ref<?>, %549: !vm.ref<?>, %550: !vm.ref<?>, %551: !vm.ref<?>, %552: !vm.ref<?>, %553: !vm.ref<?>, %554: !vm.ref<?>, %555: !vm.ref<?>, %556: !vm.ref<?>, %557: !vm.ref<?>, %558: !vm.ref<?>, %559: !vm.ref<?>, %560: !vm.ref<?>, %561: !vm.ref<?>, %562: !vm.ref<?>, %563: !vm.ref<?>, %564: !vm.ref<?>, %565: !vm.ref<?>, %566: !vm.ref<?>, %567: !vm.ref<?>, %568: !vm.ref<?>, %569: !vm.ref<?>, %570: !vm.ref<?>, %571: !vm.ref<?>, %572: !vm.ref<?>, %573: !vm.ref<?>, %574: !vm.ref<?>, %575: !vm.ref<?>, %576: !vm.ref<?>, %577: !vm.ref<?>, %578: !vm.ref<?>, %579: !vm.ref<?>, %580: !vm.ref<?>, %581: !vm.ref<?>, %582: !vm.ref<?>, %583: !vm.ref<?>, %584: !vm.ref<?>, %585: !vm.ref<?>, %586: !vm.ref<?>, %587: !vm.ref<?>, %588: !vm.ref<?>, %589: !vm.ref<?>, %590: !vm.ref<?>, %591: !vm.ref<?>, %592: !vm.ref<?>, %593: !vm.ref<?>, %594: !vm.ref<?>, %595: !vm.ref<?>, %596: !vm.ref<?>, %597: !vm.ref<?>, %598: !vm.ref<?>, %599: !vm.ref<?>) -> (!vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>) {
     vm.return %0, %1, %2, %3, %4, %5, %6, %7, %8, %9, %10, %11, %12, %13, %14, %15, %16, %17, %18, %19, %20, %21, %22, %23, %24, %25, %26, %27, %28, %29, %30, %31, %32, %33, %34, %35, %36, %37, %38, %39, %40, %41, %42, %43, %44, %45, %46, %47, %48, %49, %50, %51, %52, %53, %54, %55, %56, %57, %58, %59, %60, %61, %62, %63, %64, %65, %66, %67, %68, %69, %70, %71, %72, %73, %74, %75, %76, %77, %78, %79, %80, %81, %82, %83, %84, %85, %86, %87, %88, %89, %90, %91, %92, %93, %94, %95, %96, %97, %98, %99, %100, %101, %102, %103, %104, %105, %106, %107, %108, %109, %110, %111, %112, %113, %114, %115, %116, %117, %118, %119, %120, %121, %122, %123, %124, %125, %126, %127, %128, %129, %130, %131, %132, %133, %134, %135, %136, %137, %138, %139, %140, %141, %142, %143, %144, %145, %146, %147, %148, %149, %150, %151, %152, %153, %154, %155, %156, %157, %158, %159, %160, %161, %162, %163, %164, %165, %166, %167, %168, %169, %170, %171, %172, %173, %174, %175, %176, %177, %178, %179, %180, %181, %182, %183, %184, %185, %186, %187, %188, %189, %190, %191, %192, %193, %194, %195, %196, %197, %198, %199, %200, %201, %202, %203, %204, %205, %206, %207, %208, %209, %210, %211, %212, %213, %214, %215, %216, %217, %218, %219, %220, %221, %222, %223, %224, %225, %226, %227, %228, %229, %230, %231, %232, %233, %234, %235, %236, %237, %238, %239, %240, %241, %242, %243, %244, %245, %246, %247, %248, %249, %250, %251, %252, %253, %254, %255, %256, %257, %258, %259, %260, %261, %262, %263, %264, %265, %266, %267, %268, %269, %270, %271, %272, %273, %274, %275, %276, %277, %278, %279, %280, %281, %282, %283, %284, %285, %286, %287, %288, %289, %290, %291, %292, %293, %294, %295, %296, %297, %298, %299, %300, %301, %302, %303, %304, %305, %306, %307, %308, %309, %310, %311, %312, %313, %314, %315, %316, %317, %318, %319, %320, %321, %322, %323, %324, %325, %326, %327, %328, %329, %330, %331, %332, %333, %334, %335, %336, %337, %338, %339, %340, %341, %342, %343, %344, %345, %346, %347, %348, %349, %350, %351, %352, %353, %354, %355, %356, %357, %358, %359, %360, %361, %362, %363, %364, %365, %366, %367, %368, %369, %370, %371, %372, %373, %374, %375, %376, %377, %378, %379, %380, %381, %382, %383, %384, %385, %386, %387, %388, %389, %390, %391, %392, %393, %394, %395, %396, %397, %398, %399, %400, %401, %402, %403, %404, %405, %406, %407, %408, %409, %410, %411, %412, %413, %414, %415, %416, %417, %418, %419, %420, %421, %422, %423, %424, %425, %426, %427, %428, %429, %430, %431, %432, %433, %434, %435, %436, %437, %438, %439, %440, %441, %442, %443, %444, %445, %446, %447, %448, %449, %450, %451, %452, %453, %454, %455, %456, %457, %458, %459, %460, %461, %462, %463, %464, %465, %466, %467, %468, %469, %470, %471, %472, %473, %474, %475, %476, %477, %478, %479, %480, %481, %482, %483, %484, %485, %486, %487, %488, %489, %490, %491, %492, %493, %494, %495, %496, %497, %498, %499, %500, %501, %502, %503, %504, %505, %506, %507, %508, %509, %510, %511, %512, %513, %514, %515, %516, %517, %518, %519, %520, %521, %522, %523, %524, %525, %526, %527, %528, %529, %530, %531, %532, %533, %534, %535, %536, %537, %538, %539, %540, %541, %542, %543, %544, %545, %546, %547, %548, %549, %550, %551, %552, %553, %554, %555, %556, %557, %558, %559, %560, %561, %562, %563, %564, %565, %566, %567, %568, %569, %570, %571, %572, %573, %574, %575, %576, %577, %578, %579, %580, %581, %582, %583, %584, %585, %586, %587, %588, %589, %590, %591, %592, %593, %594, %595, %596, %597, %598, %599 : !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>, !vm.ref<?>
   }
+
+  // Tests state carried over when forking a context: a primitive global
+  // copied with rwdata and a ref global set once by the initializer.
+  vm.global.i32 private mutable @fork_counter : i32
+  vm.global.ref private @fork_buffer : !vm.buffer
+  vm.initializer {
+    %counter = vm.global.load.i32 @fork_counter : i32
+    %c1 = vm.const.i32 1
+    %counter_1 = vm.add.i32 %counter, %c1 : i32
+    vm.global.store.i32 %counter_1, @fork_counter : i32
+    %c16 = vm.const.i64 16
+    %alignment = vm.const.i32 16
+    %buffer = vm.buffer.alloc %c16, %alignment : !vm.buffer
+    vm.global.store.ref %buffer, @fork_buffer : !vm.buffer
+    vm.return
+  }
+
+  vm.export @ForkAddCounter
+  vm.func @ForkAddCounter(%delta: i32) -> i32 {
+    %counter = vm.global.load.i32 @fork_counter : i32
+    %counter_1 = vm.add.i32 %counter, %delta : i32
+    vm.global.store.i32 %counter_1, @fork_counter : i32
+    vm.return %counter_1 : i32
+  }
+
+  vm.export @ForkGetBuffer
+  vm.func @ForkGetBuffer() -> !vm.buffer {
+    %buffer = vm.global.load.ref @fork_buffer : !vm.buffer
+    vm.return %buffer : !vm.buffer
+  }
+
+  // A ref global that may be set after initialization. Contexts can only be
+  // forked while it is null as the object it references would be shared.
+  vm.global.ref private mutable @fork_cache : !vm.buffer
+
+  vm.export @ForkSetCache
+  vm.func @ForkSetCache() -> !vm.buffer {
+    %c16 = vm.const.i64 16
+    %alignment = vm.const.i32 16
+    %buffer = vm.buffer.alloc %c16, %alignment : !vm.buffer
+    vm.global.store.ref %buffer, @fork_cache : !vm.buffer
+    %cache = vm.global.load.ref @fork_cache : !vm.buffer
+    vm.return %cache : !vm.buffer
+  }
+
+  // Stand-in for a native object; tests provide a loader that checks these
+  // bytes and returns their own native function for NativeSub.
+  vm.rodata private @native_functions dense<[1, 2, 3, 4]> : tensor<4xi8>
+
+  // Interpreted unless a native loader provides a version of it.
+  vm.export @NativeSub
+  vm.func @NativeSub(%lhs: i32, %rhs: i32) -> i32 {
+    %0 = vm.sub.i32 %lhs, %rhs : i32
+    vm.return %0 : i32
+  }
 }
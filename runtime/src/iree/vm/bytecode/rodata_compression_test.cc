@@ -0,0 +1,133 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// Tests for loading modules with compressed rodata segments.
+// The test module is compiled with LZ4 rodata compression.
+
+#include <cstdint>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+#include "iree/vm/api.h"
+#include "iree/vm/bytecode/module.h"
+#include "iree/vm/bytecode/rodata_compression_test_module_c.h"
+
+namespace iree {
+namespace {
+
+using iree::vm::ref;
+
+class RodataCompressionTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    IREE_ASSERT_OK(iree_vm_instance_create(
+        IREE_VM_TYPE_CAPACITY_DEFAULT, iree_allocator_system(), &instance_));
+    const auto* module_file_toc =
+        iree_vm_bytecode_rodata_compression_test_module_create();
+    IREE_ASSERT_OK(iree_vm_bytecode_module_create(
+        instance_,
+        iree_const_byte_span_t{
+            reinterpret_cast<const uint8_t*>(module_file_toc->data),
+            static_cast<iree_host_size_t>(module_file_toc->size)},
+        iree_allocator_null(), iree_allocator_system(), &module_));
+    IREE_ASSERT_OK(iree_vm_context_create_with_modules(
+        instance_, IREE_VM_CONTEXT_FLAG_NONE, 1, &module_,
+        iree_allocator_system(), &context_));
+  }
+
+  void TearDown() override {
+    iree_vm_context_release(context_);
+    iree_vm_module_release(module_);
+    iree_vm_instance_release(instance_);
+  }
+
+  // Returns the buffer holding the decompressed @weights rodata.
+  StatusOr<ref<iree_vm_buffer_t>> GetWeights() {
+    iree_vm_function_t function;
+    IREE_RETURN_IF_ERROR(iree_vm_module_lookup_function_by_name(
+        module_, IREE_VM_FUNCTION_LINKAGE_EXPORT, IREE_SV("GetWeights"),
+        &function));
+    ref<iree_vm_list_t> outputs;
+    IREE_RETURN_IF_ERROR(iree_vm_list_create(iree_vm_make_undefined_type_def(),
+                                             1, iree_allocator_system(),
+                                             &outputs));
+    IREE_RETURN_IF_ERROR(iree_vm_invoke(
+        context_, function, IREE_VM_INVOCATION_FLAG_NONE, /*policy=*/nullptr,
+        /*inputs=*/nullptr, outputs.get(), iree_allocator_system()));
+    iree_vm_ref_t buffer_ref = iree_vm_ref_null();
+    IREE_RETURN_IF_ERROR(
+        iree_vm_list_get_ref_assign(outputs.get(), 0, &buffer_ref));
+    iree_vm_buffer_t* buffer = nullptr;
+    IREE_RETURN_IF_ERROR(iree_vm_buffer_check_deref(buffer_ref, &buffer));
+    return vm::retain_ref(buffer);
+  }
+
+  iree_vm_instance_t* instance_ = nullptr;
+  iree_vm_module_t* module_ = nullptr;
+  iree_vm_context_t* context_ = nullptr;
+};
+
+// Decompressed rodata has the contents and alignment of the original segment.
+TEST_F(RodataCompressionTest, Decompressed) {
+  IREE_ASSERT_OK_AND_ASSIGN(auto weights, GetWeights());
+  iree_const_byte_span_t span = iree_const_byte_span_empty();
+  IREE_ASSERT_OK(iree_vm_buffer_map_ro(weights.get(), 0,
+                                       iree_vm_buffer_length(weights.get()),
+                                       sizeof(int32_t), &span));
+  ASSERT_EQ(span.data_length, 4096 * sizeof(int32_t));
+  EXPECT_TRUE(iree_host_size_has_alignment((uintptr_t)span.data, 128));
+  const int32_t* values = reinterpret_cast<const int32_t*>(span.data);
+  for (iree_host_size_t i = 0; i < 4096; ++i) {
+    ASSERT_EQ(values[i], 7) << "at index " << i;
+  }
+}
+
+// Decompressed rodata can be imported in-place by heap buffers as done by
+// hal.allocator.import.
+TEST_F(RodataCompressionTest, ImportInPlace) {
+  IREE_ASSERT_OK_AND_ASSIGN(auto weights, GetWeights());
+  iree_const_byte_span_t span = iree_const_byte_span_empty();
+  IREE_ASSERT_OK(iree_vm_buffer_map_ro(weights.get(), 0,
+                                       iree_vm_buffer_length(weights.get()),
+                                       1, &span));
+
+  iree_hal_allocator_t* device_allocator = nullptr;
+  IREE_ASSERT_OK(iree_hal_allocator_create_heap(
+      IREE_SV("heap"), iree_allocator_system(), iree_allocator_system(),
+      &device_allocator));
+  iree_hal_buffer_params_t params = {0};
+  params.type =
+      IREE_HAL_MEMORY_TYPE_HOST_LOCAL | IREE_HAL_MEMORY_TYPE_DEVICE_VISIBLE;
+  params.access = IREE_HAL_MEMORY_ACCESS_READ;
+  params.usage = IREE_HAL_BUFFER_USAGE_DISPATCH_STORAGE |
+                 IREE_HAL_BUFFER_USAGE_TRANSFER | IREE_HAL_BUFFER_USAGE_MAPPING;
+  iree_hal_external_buffer_t external_buffer;
+  memset(&external_buffer, 0, sizeof(external_buffer));
+  external_buffer.type = IREE_HAL_EXTERNAL_BUFFER_TYPE_HOST_ALLOCATION;
+  external_buffer.flags = IREE_HAL_EXTERNAL_BUFFER_FLAG_NONE;
+  external_buffer.size = span.data_length;
+  external_buffer.handle.host_allocation.ptr = (void*)span.data;
+  iree_hal_buffer_t* buffer = nullptr;
+  IREE_ASSERT_OK(iree_hal_allocator_import_buffer(
+      device_allocator, params, &external_buffer,
+      iree_hal_buffer_release_callback_null(), &buffer));
+
+  // The buffer aliases the rodata instead of copying it.
+  iree_hal_buffer_mapping_t mapping;
+  IREE_ASSERT_OK(iree_hal_buffer_map_range(
+      buffer, IREE_HAL_MAPPING_MODE_SCOPED, IREE_HAL_MEMORY_ACCESS_READ, 0,
+      IREE_WHOLE_BUFFER, &mapping));
+  EXPECT_EQ(mapping.contents.data, span.data);
+  IREE_ASSERT_OK(iree_hal_buffer_unmap_range(&mapping));
+
+  iree_hal_buffer_release(buffer);
+  iree_hal_allocator_release(device_allocator);
+}
+
+}  // namespace
+}  // namespace iree
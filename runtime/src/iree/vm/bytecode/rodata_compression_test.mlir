@@ -0,0 +1,12 @@
+vm.module @rodata_compression_test {
+  // Large enough to be stored as a file in the module archive, which is where
+  // rodata is compressed. Requests more alignment than heap buffers need.
+  vm.rodata private @weights {alignment = 128 : i64} dense<7> : tensor<4096xi32>
+
+  // Returns the decompressed rodata segment.
+  vm.export @GetWeights
+  vm.func @GetWeights() -> !vm.buffer {
+    %weights = vm.const.ref.rodata @weights : !vm.buffer
+    vm.return %weights : !vm.buffer
+  }
+}
@@ -14,6 +14,64 @@
 // Module metadata verification
 //===----------------------------------------------------------------------===//
 
+// Verifies that the chunk table of a compressed rodata segment covers the
+// |source_length| bytes of stored data and the full decompressed length.
+static iree_status_t iree_vm_bytecode_verify_lz4_chunked_data(
+    size_t segment_ordinal, iree_vm_LZ4ChunkedDataDef_table_t compression_def,
+    uint64_t source_length) {
+  if (!compression_def) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "rodata[%zu] missing compression parameters",
+                            segment_ordinal);
+  }
+  uint64_t decompressed_length =
+      iree_vm_LZ4ChunkedDataDef_decompressed_length(compression_def);
+  uint64_t chunk_length =
+      iree_vm_LZ4ChunkedDataDef_chunk_length(compression_def);
+  flatbuffers_uint64_vec_t chunk_offsets =
+      iree_vm_LZ4ChunkedDataDef_chunk_offsets(compression_def);
+  if (decompressed_length > IREE_HOST_SIZE_MAX) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "rodata[%zu] decompressed length exceeds the host "
+                            "address range",
+                            segment_ordinal);
+  }
+  if (chunk_length == 0) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "rodata[%zu] has a zero chunk length",
+                            segment_ordinal);
+  }
+  uint64_t alignment = iree_vm_LZ4ChunkedDataDef_alignment(compression_def);
+  if (alignment != 0 &&
+      (alignment > IREE_HOST_SIZE_MAX ||
+       !iree_host_size_is_power_of_two((iree_host_size_t)alignment))) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "rodata[%zu] alignment %" PRIu64
+                            " is not a power of two",
+                            segment_ordinal, alignment);
+  }
+  uint64_t chunk_count = decompressed_length / chunk_length +
+                         (decompressed_length % chunk_length ? 1 : 0);
+  size_t offset_count = flatbuffers_uint64_vec_len(chunk_offsets);
+  if (offset_count == 0 || offset_count - 1 != chunk_count) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "rodata[%zu] has %zu chunk offsets but requires "
+                            "%" PRIu64,
+                            segment_ordinal, offset_count, chunk_count + 1);
+  }
+  uint64_t previous_offset = 0;
+  for (size_t i = 0; i < offset_count; ++i) {
+    uint64_t offset = flatbuffers_uint64_vec_at(chunk_offsets, i);
+    if (offset < previous_offset || offset > source_length) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "rodata[%zu] chunk offset %zu out of range",
+                              segment_ordinal, i);
+    }
+    previous_offset = offset;
+  }
+  return iree_ok_status();
+}
+
 iree_status_t iree_vm_bytecode_module_flatbuffer_verify(
     iree_const_byte_span_t archive_contents,
     iree_const_byte_span_t flatbuffer_contents,
@@ -65,9 +123,46 @@ iree_status_t iree_vm_bytecode_module_flatbuffer_verify(
        ++i) {
     iree_vm_RodataSegmentDef_table_t segment =
         iree_vm_RodataSegmentDef_vec_at(rodata_segments, i);
+    switch (iree_vm_RodataSegmentDef_compression_type_type(segment)) {
+      case iree_vm_CompressionTypeDef_NONE:
+      case iree_vm_CompressionTypeDef_UncompressedDataDef:
+        break;
+      case iree_vm_CompressionTypeDef_LZ4ChunkedDataDef: {
+        if (iree_vm_RodataSegmentDef_external_key_is_present(segment)) {
+          return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                  "rodata[%zu] parameters cannot be compressed",
+                                  i);
+        }
+        uint64_t source_length =
+            iree_vm_RodataSegmentDef_embedded_data_is_present(segment)
+                ? flatbuffers_uint8_vec_len(
+                      iree_vm_RodataSegmentDef_embedded_data(segment))
+                : iree_vm_RodataSegmentDef_external_data_length(segment);
+        IREE_RETURN_IF_ERROR(iree_vm_bytecode_verify_lz4_chunked_data(
+            i,
+            (iree_vm_LZ4ChunkedDataDef_table_t)
+                iree_vm_RodataSegmentDef_compression_type(segment),
+            source_length));
+        break;
+      }
+      default:
+        return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                                "rodata[%zu] has an unsupported compression "
+                                "type",
+                                i);
+    }
     if (iree_vm_RodataSegmentDef_embedded_data_is_present(segment)) {
       continue;  // embedded data is verified by FlatBuffers
     }
+    if (iree_vm_RodataSegmentDef_external_key_is_present(segment)) {
+      // Parameters are resolved by the loader and checked against the length.
+      if (flatbuffers_string_len(
+              iree_vm_RodataSegmentDef_external_key(segment)) == 0) {
+        return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                "rodata[%zu] parameter key is empty", i);
+      }
+      continue;
+    }
     uint64_t segment_offset =
         iree_vm_RodataSegmentDef_external_data_offset(segment);
     uint64_t segment_length =
@@ -80,6 +175,41 @@ iree_status_t iree_vm_bytecode_module_flatbuffer_verify(
     }
   }
 
+  iree_vm_ModuleStateDef_table_t module_state_def =
+      iree_vm_BytecodeModuleDef_module_state(module_def);
+  if (module_state_def) {
+    int32_t global_ref_count =
+        iree_vm_ModuleStateDef_global_ref_count(module_state_def);
+    flatbuffers_int32_vec_t mutable_global_refs =
+        iree_vm_ModuleStateDef_mutable_global_refs(module_state_def);
+    for (size_t i = 0; i < flatbuffers_int32_vec_len(mutable_global_refs);
+         ++i) {
+      int32_t ordinal = flatbuffers_int32_vec_at(mutable_global_refs, i);
+      if (ordinal < 0 || ordinal >= global_ref_count) {
+        return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                "mutable_global_refs[%zu] ordinal %d out of "
+                                "range (%d ref globals)",
+                                i, ordinal, global_ref_count);
+      }
+    }
+  }
+
+  iree_vm_NativeFunctionsDef_table_t native_functions_def =
+      iree_vm_BytecodeModuleDef_native_functions(module_def);
+  if (native_functions_def) {
+    int32_t rodata_segment =
+        iree_vm_NativeFunctionsDef_rodata_segment(native_functions_def);
+    size_t rodata_segment_count =
+        iree_vm_RodataSegmentDef_vec_len(rodata_segments);
+    if (rodata_segment < 0 ||
+        (size_t)rodata_segment >= rodata_segment_count) {
+      return iree_make_status(
+          IREE_STATUS_INVALID_ARGUMENT,
+          "native_functions rodata segment %d out of range (%zu segments)",
+          rodata_segment, rodata_segment_count);
+    }
+  }
+
   iree_vm_ModuleDependencyDef_vec_t dependencies =
       iree_vm_BytecodeModuleDef_dependencies(module_def);
   for (size_t i = 0; i < iree_vm_ModuleDependencyDef_vec_len(dependencies);
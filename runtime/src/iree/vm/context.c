@@ -299,21 +299,18 @@ IREE_API_EXPORT iree_status_t iree_vm_context_create(
       out_context);
 }
 
-IREE_API_EXPORT iree_status_t iree_vm_context_create_with_modules(
+// Allocates an empty context with static storage for |module_count| modules.
+static iree_status_t iree_vm_context_allocate(
     iree_vm_instance_t* instance, iree_vm_context_flags_t flags,
-    iree_host_size_t module_count, iree_vm_module_t** modules,
-    iree_allocator_t allocator, iree_vm_context_t** out_context) {
-  IREE_TRACE_ZONE_BEGIN(z0);
-  IREE_ASSERT_ARGUMENT(out_context);
-  *out_context = NULL;
-
+    iree_host_size_t module_count, iree_allocator_t allocator,
+    iree_vm_context_t** out_context) {
   iree_host_size_t context_size =
       sizeof(iree_vm_context_t) + sizeof(iree_vm_module_t*) * module_count +
       sizeof(iree_vm_module_state_t*) * module_count;
 
   iree_vm_context_t* context = NULL;
-  IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0, iree_allocator_malloc(allocator, context_size, (void**)&context));
+  IREE_RETURN_IF_ERROR(
+      iree_allocator_malloc(allocator, context_size, (void**)&context));
   iree_atomic_ref_count_init(&context->ref_count);
   context->instance = instance;
   iree_vm_instance_retain(context->instance);
@@ -334,6 +331,23 @@ IREE_API_EXPORT iree_status_t iree_vm_context_create_with_modules(
   context->list.count = 0;
   context->list.capacity = module_count;
 
+  *out_context = context;
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_context_create_with_modules(
+    iree_vm_instance_t* instance, iree_vm_context_flags_t flags,
+    iree_host_size_t module_count, iree_vm_module_t** modules,
+    iree_allocator_t allocator, iree_vm_context_t** out_context) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_ASSERT_ARGUMENT(out_context);
+  *out_context = NULL;
+
+  iree_vm_context_t* context = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_vm_context_allocate(instance, flags, module_count, allocator,
+                                   &context));
+
   iree_status_t register_status =
       iree_vm_context_register_modules(context, module_count, modules);
   if (!iree_status_is_ok(register_status)) {
@@ -347,6 +361,80 @@ IREE_API_EXPORT iree_status_t iree_vm_context_create_with_modules(
   return iree_ok_status();
 }
 
+IREE_API_EXPORT iree_status_t iree_vm_context_fork(
+    iree_vm_context_t* parent, iree_allocator_t allocator,
+    iree_vm_context_t** out_context) {
+  IREE_ASSERT_ARGUMENT(parent);
+  IREE_ASSERT_ARGUMENT(out_context);
+  *out_context = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_vm_context_t* context = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_vm_context_allocate(parent->instance, parent->flags,
+                                   parent->list.count, allocator, &context));
+
+  // VM stack used to call into module __init methods of modules that cannot
+  // be forked.
+  IREE_VM_INLINE_STACK_INITIALIZE(
+      stack,
+      context->flags & IREE_VM_CONTEXT_FLAG_TRACE_EXECUTION
+          ? IREE_VM_INVOCATION_FLAG_TRACE_EXECUTION
+          : IREE_VM_INVOCATION_FLAG_NONE,
+      iree_vm_context_state_resolver(context), context->allocator);
+
+  // Fork modules in registration order so that any module that needs to be
+  // initialized can call into the modules it imports.
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0; i < parent->list.count; ++i) {
+    iree_vm_module_t* module = parent->list.modules[i];
+    context->list.modules[i] = module;
+    context->list.module_states[i] = NULL;
+    iree_vm_module_retain(module);
+    ++context->list.count;
+
+    iree_vm_module_state_t* module_state = NULL;
+    if (module->fork_state) {
+      // Forked state carries over the resolved imports and initialized
+      // globals from the parent.
+      status = module->fork_state(module->self, parent->list.module_states[i],
+                                  context->allocator, &module_state);
+      context->list.module_states[i] = module_state;
+    } else {
+      // Module doesn't support forking so allocate fresh state and initialize
+      // it as if it were being registered.
+      status =
+          module->alloc_state(module->self, context->allocator, &module_state);
+      context->list.module_states[i] = module_state;
+      if (iree_status_is_ok(status)) {
+        status = iree_vm_context_resolve_module_imports(context, module,
+                                                        module_state);
+      }
+      if (iree_status_is_ok(status)) {
+        status = iree_vm_context_run_function(
+            context, stack, module, iree_make_cstring_view("__init"));
+      }
+    }
+    if (!iree_status_is_ok(status)) {
+      iree_string_view_t module_name = iree_vm_module_name(module);
+      (void)module_name;
+      status = iree_status_annotate_f(status, "forking module '%.*s'",
+                                      (int)module_name.size, module_name.data);
+      break;
+    }
+  }
+
+  iree_vm_stack_deinitialize(stack);
+
+  if (iree_status_is_ok(status)) {
+    *out_context = context;
+  } else {
+    iree_vm_context_destroy(context);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 static void iree_vm_context_destroy(iree_vm_context_t* context) {
   if (!context) return;
 
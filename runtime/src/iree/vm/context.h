@@ -69,6 +69,27 @@ IREE_API_EXPORT iree_status_t iree_vm_context_create_with_modules(
     iree_host_size_t module_count, iree_vm_module_t** modules,
     iree_allocator_t allocator, iree_vm_context_t** out_context);
 
+// Creates a new context by forking the module state of |parent|.
+// The forked context contains the same modules as |parent| and starts with
+// each module in the state it had at the time of the fork. Modules supporting
+// forking (such as bytecode modules) share the resources they reference
+// (executables, constant buffers, etc) with the parent and do not rerun their
+// initializers; other modules are given fresh state initialized as with
+// iree_vm_context_create_with_modules. Modules may refuse to be forked with
+// IREE_STATUS_FAILED_PRECONDITION if their state references objects that
+// cannot be shared, such as bytecode modules with mutable ref globals that are
+// not null.
+//
+// Forking is much cheaper than creating and initializing a new context and
+// can be used to quickly stamp out independent contexts from a fully
+// initialized template. Multiple forks of |parent| may be made concurrently
+// but |parent| must not be executing calls while being forked. Forked
+// contexts cannot have additional modules registered after creation.
+// |out_context| must be released by the caller.
+IREE_API_EXPORT iree_status_t iree_vm_context_fork(
+    iree_vm_context_t* parent, iree_allocator_t allocator,
+    iree_vm_context_t** out_context);
+
 // Retains the given |context| for the caller.
 IREE_API_EXPORT void iree_vm_context_retain(iree_vm_context_t* context);
 
@@ -618,6 +618,129 @@ static void iree_vm_list_convert_value_type(
   }
 }
 
+// Verifies that the element range [|offset|, |offset| + |length|) is within
+// the bounds of |list|.
+static iree_status_t iree_vm_list_verify_range(const iree_vm_list_t* list,
+                                               iree_host_size_t offset,
+                                               iree_host_size_t length) {
+  if (offset > list->count || length > list->count - offset) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "range offset %" PRIhsz " length %" PRIhsz
+                            " out of bounds (%" PRIhsz ")",
+                            offset, length, list->count);
+  }
+  return iree_ok_status();
+}
+
+// Converts |count| densely packed values of |source_type| at |source_ptr| to
+// densely packed values of |target_type| at |target_ptr|. Values of matching
+// types are copied in bulk. All value type union members start at byte 0 of
+// the iree_vm_value_t storage and are loaded/stored with memcpy so this works
+// regardless of host endianness.
+static void iree_vm_list_convert_values(iree_vm_value_type_t source_type,
+                                        const uint8_t* source_ptr,
+                                        iree_vm_value_type_t target_type,
+                                        uint8_t* target_ptr,
+                                        iree_host_size_t count) {
+  const iree_host_size_t source_size =
+      iree_vm_value_type_size(iree_vm_make_value_type_def(source_type));
+  if (source_type == target_type) {
+    memcpy(target_ptr, source_ptr, count * source_size);
+    return;
+  }
+  const iree_host_size_t target_size =
+      iree_vm_value_type_size(iree_vm_make_value_type_def(target_type));
+  for (iree_host_size_t i = 0; i < count; ++i) {
+    iree_vm_value_t source_value;
+    source_value.type = source_type;
+    source_value.i64 = 0;
+    memcpy(source_value.value_storage, source_ptr + i * source_size,
+           source_size);
+    iree_vm_value_t target_value;
+    iree_vm_list_convert_value_type(&source_value, target_type, &target_value);
+    memcpy(target_ptr + i * target_size, target_value.value_storage,
+           target_size);
+  }
+}
+
+// Loads |length| elements of |list| starting at |offset| converted to
+// |value_type| into the densely packed |out_values|. The range must have been
+// verified by the caller.
+static iree_status_t iree_vm_list_load_values(const iree_vm_list_t* list,
+                                              iree_host_size_t offset,
+                                              iree_host_size_t length,
+                                              iree_vm_value_type_t value_type,
+                                              uint8_t* out_values) {
+  switch (list->storage_mode) {
+    case IREE_VM_LIST_STORAGE_MODE_VALUE: {
+      iree_vm_list_convert_values(
+          iree_vm_type_def_as_value(list->element_type),
+          (const uint8_t*)list->storage + offset * list->element_size,
+          value_type, out_values, length);
+      break;
+    }
+    case IREE_VM_LIST_STORAGE_MODE_VARIANT: {
+      const iree_host_size_t value_size =
+          iree_vm_value_type_size(iree_vm_make_value_type_def(value_type));
+      const iree_vm_variant_t* variants =
+          (const iree_vm_variant_t*)list->storage + offset;
+      for (iree_host_size_t i = 0; i < length; ++i) {
+        if (!iree_vm_variant_is_value(variants[i])) {
+          return iree_make_status(
+              IREE_STATUS_FAILED_PRECONDITION,
+              "variant at index %" PRIhsz " is not a value type", offset + i);
+        }
+        iree_vm_list_convert_values(iree_vm_type_def_as_value(variants[i].type),
+                                    variants[i].value_storage, value_type,
+                                    out_values + i * value_size, 1);
+      }
+      break;
+    }
+    default:
+      return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                              "list does not store values");
+  }
+  return iree_ok_status();
+}
+
+// Stores |length| densely packed |values| of |value_type| into |list| starting
+// at |offset|. Values are converted to the list element type if required and
+// variants take on |value_type|. The range must have been verified by the
+// caller.
+static iree_status_t iree_vm_list_store_values(iree_vm_list_t* list,
+                                               iree_host_size_t offset,
+                                               iree_host_size_t length,
+                                               iree_vm_value_type_t value_type,
+                                               const uint8_t* values) {
+  switch (list->storage_mode) {
+    case IREE_VM_LIST_STORAGE_MODE_VALUE: {
+      iree_vm_list_convert_values(
+          value_type, values, iree_vm_type_def_as_value(list->element_type),
+          (uint8_t*)list->storage + offset * list->element_size, length);
+      break;
+    }
+    case IREE_VM_LIST_STORAGE_MODE_VARIANT: {
+      const iree_host_size_t value_size =
+          iree_vm_value_type_size(iree_vm_make_value_type_def(value_type));
+      iree_vm_variant_t* variants = (iree_vm_variant_t*)list->storage + offset;
+      for (iree_host_size_t i = 0; i < length; ++i) {
+        iree_vm_variant_t* variant = &variants[i];
+        if (iree_vm_variant_is_ref(*variant)) {
+          iree_vm_ref_release(&variant->ref);
+        }
+        variant->type = iree_vm_make_value_type_def(value_type);
+        memset(variant->value_storage, 0, sizeof(variant->value_storage));
+        memcpy(variant->value_storage, values + i * value_size, value_size);
+      }
+      break;
+    }
+    default:
+      return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                              "list cannot store values");
+  }
+  return iree_ok_status();
+}
+
 IREE_API_EXPORT iree_status_t
 iree_vm_list_get_value(const iree_vm_list_t* list, iree_host_size_t i,
                        iree_vm_value_t* out_value) {
@@ -626,44 +749,28 @@ iree_vm_list_get_value(const iree_vm_list_t* list, iree_host_size_t i,
                             "index %" PRIhsz " out of bounds (%" PRIhsz ")", i,
                             list->count);
   }
-  uintptr_t element_ptr = (uintptr_t)list->storage + i * list->element_size;
   memset(out_value, 0, sizeof(*out_value));
   switch (list->storage_mode) {
     case IREE_VM_LIST_STORAGE_MODE_VALUE: {
       out_value->type = iree_vm_type_def_as_value(list->element_type);
-      // TODO(benvanik): #ifdef on LITTLE/BIG_ENDIAN and just memcpy.
-      switch (list->element_size) {
-        case 1:
-          out_value->i8 = *(int8_t*)element_ptr;
-          break;
-        case 2:
-          out_value->i16 = *(int16_t*)element_ptr;
-          break;
-        case 4:
-          out_value->i32 = *(int32_t*)element_ptr;
-          break;
-        case 8:
-          out_value->i64 = *(int64_t*)element_ptr;
-          break;
-      }
       break;
     }
     case IREE_VM_LIST_STORAGE_MODE_VARIANT: {
-      iree_vm_variant_t* variant = (iree_vm_variant_t*)element_ptr;
+      const iree_vm_variant_t* variant =
+          (const iree_vm_variant_t*)list->storage + i;
       if (!iree_vm_type_def_is_value(variant->type)) {
         return iree_make_status(
             IREE_STATUS_FAILED_PRECONDITION,
             "variant at index %" PRIhsz " is not a value type", i);
       }
       out_value->type = iree_vm_type_def_as_value(variant->type);
-      memcpy(out_value->value_storage, variant->value_storage,
-             sizeof(out_value->value_storage));
       break;
     }
     default:
       return iree_make_status(IREE_STATUS_FAILED_PRECONDITION);
   }
-  return iree_ok_status();
+  return iree_vm_list_load_values(list, i, 1, out_value->type,
+                                  out_value->value_storage);
 }
 
 IREE_API_EXPORT iree_status_t iree_vm_list_get_value_as(
@@ -674,47 +781,10 @@ IREE_API_EXPORT iree_status_t iree_vm_list_get_value_as(
                             "index %" PRIhsz " out of bounds (%" PRIhsz ")", i,
                             list->count);
   }
-  uintptr_t element_ptr = (uintptr_t)list->storage + i * list->element_size;
-  iree_vm_value_t value;
-  value.i64 = 0;
-  switch (list->storage_mode) {
-    case IREE_VM_LIST_STORAGE_MODE_VALUE: {
-      value.type = iree_vm_type_def_as_value(list->element_type);
-      // TODO(benvanik): #ifdef on LITTLE/BIG_ENDIAN and just memcpy.
-      switch (list->element_size) {
-        case 1:
-          value.i8 = *(int8_t*)element_ptr;
-          break;
-        case 2:
-          value.i16 = *(int16_t*)element_ptr;
-          break;
-        case 4:
-          value.i32 = *(int32_t*)element_ptr;
-          break;
-        case 8:
-          value.i64 = *(int64_t*)element_ptr;
-          break;
-      }
-      break;
-    }
-    case IREE_VM_LIST_STORAGE_MODE_VARIANT: {
-      iree_vm_variant_t* variant = (iree_vm_variant_t*)element_ptr;
-      if (!iree_vm_variant_is_value(*variant)) {
-        return iree_make_status(
-            IREE_STATUS_FAILED_PRECONDITION,
-            "variant at index %" PRIhsz " is not a value type", i);
-      }
-      value.type = iree_vm_type_def_as_value(variant->type);
-      memcpy(value.value_storage, variant->value_storage,
-             sizeof(value.value_storage));
-      break;
-    }
-    default:
-      return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
-                              "list does not store values");
-  }
-  iree_vm_list_convert_value_type(&value, value_type, out_value);
-  return iree_ok_status();
+  memset(out_value, 0, sizeof(*out_value));
+  out_value->type = value_type;
+  return iree_vm_list_load_values(list, i, 1, value_type,
+                                  out_value->value_storage);
 }
 
 IREE_API_EXPORT iree_status_t iree_vm_list_set_value(
@@ -724,57 +794,8 @@ IREE_API_EXPORT iree_status_t iree_vm_list_set_value(
                             "index %" PRIhsz " out of bounds (%" PRIhsz ")", i,
                             list->count);
   }
-  iree_vm_value_type_t target_type;
-  switch (list->storage_mode) {
-    case IREE_VM_LIST_STORAGE_MODE_VALUE: {
-      target_type = iree_vm_type_def_as_value(list->element_type);
-      break;
-    }
-    case IREE_VM_LIST_STORAGE_MODE_VARIANT: {
-      target_type = value->type;
-      break;
-    }
-    default:
-      return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
-                              "list cannot store values");
-  }
-  iree_vm_value_t converted_value;
-  iree_vm_list_convert_value_type(value, target_type, &converted_value);
-  uintptr_t element_ptr = (uintptr_t)list->storage + i * list->element_size;
-  switch (list->storage_mode) {
-    case IREE_VM_LIST_STORAGE_MODE_VALUE: {
-      // TODO(benvanik): #ifdef on LITTLE/BIG_ENDIAN and just memcpy.
-      switch (list->element_size) {
-        case 1:
-          *(int8_t*)element_ptr = converted_value.i8;
-          break;
-        case 2:
-          *(int16_t*)element_ptr = converted_value.i16;
-          break;
-        case 4:
-          *(int32_t*)element_ptr = converted_value.i32;
-          break;
-        case 8:
-          *(int64_t*)element_ptr = converted_value.i64;
-          break;
-      }
-      break;
-    }
-    case IREE_VM_LIST_STORAGE_MODE_VARIANT: {
-      iree_vm_variant_t* variant = (iree_vm_variant_t*)element_ptr;
-      if (iree_vm_variant_is_ref(*variant)) {
-        iree_vm_ref_release(&variant->ref);
-      }
-      variant->type = iree_vm_make_value_type_def(target_type);
-      memcpy(variant->value_storage, converted_value.value_storage,
-             sizeof(variant->value_storage));
-      break;
-    }
-    default:
-      return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
-                              "list cannot store values");
-  }
-  return iree_ok_status();
+  return iree_vm_list_store_values(list, i, 1, value->type,
+                                   value->value_storage);
 }
 
 IREE_API_EXPORT iree_status_t
@@ -784,6 +805,64 @@ iree_vm_list_push_value(iree_vm_list_t* list, const iree_vm_value_t* value) {
   return iree_vm_list_set_value(list, i, value);
 }
 
+IREE_API_EXPORT iree_status_t iree_vm_list_map_values(
+    iree_vm_list_t* list, iree_host_size_t offset, iree_host_size_t length,
+    iree_vm_value_type_t value_type, iree_byte_span_t* out_span) {
+  *out_span = iree_byte_span_empty();
+  IREE_RETURN_IF_ERROR(iree_vm_list_verify_range(list, offset, length));
+  if (list->storage_mode != IREE_VM_LIST_STORAGE_MODE_VALUE ||
+      iree_vm_type_def_as_value(list->element_type) != value_type) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "list storage cannot be mapped as value type %d",
+                            (int)value_type);
+  }
+  *out_span = iree_make_byte_span(
+      (uint8_t*)list->storage + offset * list->element_size,
+      length * list->element_size);
+  return iree_ok_status();
+}
+
+// Verifies that a densely packed buffer of |buffer_length| bytes can hold
+// |length| values of |value_type|.
+static iree_status_t iree_vm_list_verify_value_buffer(
+    iree_vm_value_type_t value_type, iree_host_size_t length,
+    iree_host_size_t buffer_length) {
+  const iree_host_size_t value_size =
+      iree_vm_value_type_size(iree_vm_make_value_type_def(value_type));
+  if (value_size == 0) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "value type %d has no storage", (int)value_type);
+  }
+  if (buffer_length < length * value_size) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "value buffer too small; %" PRIhsz
+                            " bytes required but %" PRIhsz " provided",
+                            length * value_size, buffer_length);
+  }
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_list_get_values_as(
+    const iree_vm_list_t* list, iree_host_size_t offset,
+    iree_host_size_t length, iree_vm_value_type_t value_type,
+    iree_byte_span_t out_values) {
+  IREE_RETURN_IF_ERROR(iree_vm_list_verify_range(list, offset, length));
+  IREE_RETURN_IF_ERROR(iree_vm_list_verify_value_buffer(
+      value_type, length, out_values.data_length));
+  return iree_vm_list_load_values(list, offset, length, value_type,
+                                  out_values.data);
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_list_set_values_as(
+    iree_vm_list_t* list, iree_host_size_t offset, iree_host_size_t length,
+    iree_vm_value_type_t value_type, iree_const_byte_span_t values) {
+  IREE_RETURN_IF_ERROR(iree_vm_list_verify_range(list, offset, length));
+  IREE_RETURN_IF_ERROR(
+      iree_vm_list_verify_value_buffer(value_type, length, values.data_length));
+  return iree_vm_list_store_values(list, offset, length, value_type,
+                                   values.data);
+}
+
 IREE_API_EXPORT void* iree_vm_list_get_ref_deref(const iree_vm_list_t* list,
                                                  iree_host_size_t i,
                                                  iree_vm_ref_type_t type) {
@@ -799,33 +878,37 @@ IREE_API_EXPORT void* iree_vm_list_get_ref_deref(const iree_vm_list_t* list,
   return value.ptr;
 }
 
-// Gets a ref type |list| element at |i| and stores it into |out_value|.
-// If |is_retain|=true then the reference count is incremented and otherwise
-// the ref type is assigned directly (as with iree_vm_ref_assign).
-static iree_status_t iree_vm_list_get_ref_assign_or_retain(
-    const iree_vm_list_t* list, iree_host_size_t i, bool is_retain,
-    iree_vm_ref_t* out_value) {
-  if (i >= list->count) {
-    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
-                            "index %" PRIhsz " out of bounds (%" PRIhsz ")", i,
-                            list->count);
-  }
-  uintptr_t element_ptr = (uintptr_t)list->storage + i * list->element_size;
+// Gets |length| ref type |list| elements starting at |offset| and stores them
+// into |out_values|. If |is_retain|=true then the reference counts are
+// incremented and otherwise the refs are assigned directly (as with
+// iree_vm_ref_assign). The range must have been verified by the caller and no
+// refs are stored on failure.
+static iree_status_t iree_vm_list_get_refs_assign_or_retain(
+    const iree_vm_list_t* list, iree_host_size_t offset,
+    iree_host_size_t length, bool is_retain, iree_vm_ref_t* out_values) {
   switch (list->storage_mode) {
     case IREE_VM_LIST_STORAGE_MODE_REF: {
-      iree_vm_ref_t* element_ref = (iree_vm_ref_t*)element_ptr;
-      is_retain ? iree_vm_ref_retain(element_ref, out_value)
-                : iree_vm_ref_assign(element_ref, out_value);
+      iree_vm_ref_t* element_refs = (iree_vm_ref_t*)list->storage + offset;
+      for (iree_host_size_t i = 0; i < length; ++i) {
+        is_retain ? iree_vm_ref_retain(&element_refs[i], &out_values[i])
+                  : iree_vm_ref_assign(&element_refs[i], &out_values[i]);
+      }
       break;
     }
     case IREE_VM_LIST_STORAGE_MODE_VARIANT: {
-      iree_vm_variant_t* variant = (iree_vm_variant_t*)element_ptr;
-      if (!iree_vm_variant_is_empty(*variant) &&
-          !iree_vm_type_def_is_ref(variant->type)) {
-        return iree_make_status(IREE_STATUS_FAILED_PRECONDITION);
+      iree_vm_variant_t* variants = (iree_vm_variant_t*)list->storage + offset;
+      for (iree_host_size_t i = 0; i < length; ++i) {
+        if (!iree_vm_variant_is_empty(variants[i]) &&
+            !iree_vm_type_def_is_ref(variants[i].type)) {
+          return iree_make_status(
+              IREE_STATUS_FAILED_PRECONDITION,
+              "variant at index %" PRIhsz " is not a ref type", offset + i);
+        }
+      }
+      for (iree_host_size_t i = 0; i < length; ++i) {
+        is_retain ? iree_vm_ref_retain(&variants[i].ref, &out_values[i])
+                  : iree_vm_ref_assign(&variants[i].ref, &out_values[i]);
       }
-      is_retain ? iree_vm_ref_retain(&variant->ref, out_value)
-                : iree_vm_ref_assign(&variant->ref, out_value);
       break;
     }
     default:
@@ -835,6 +918,21 @@ static iree_status_t iree_vm_list_get_ref_assign_or_retain(
   return iree_ok_status();
 }
 
+// Gets a ref type |list| element at |i| and stores it into |out_value|.
+// If |is_retain|=true then the reference count is incremented and otherwise
+// the ref type is assigned directly (as with iree_vm_ref_assign).
+static iree_status_t iree_vm_list_get_ref_assign_or_retain(
+    const iree_vm_list_t* list, iree_host_size_t i, bool is_retain,
+    iree_vm_ref_t* out_value) {
+  if (i >= list->count) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "index %" PRIhsz " out of bounds (%" PRIhsz ")", i,
+                            list->count);
+  }
+  return iree_vm_list_get_refs_assign_or_retain(list, i, 1, is_retain,
+                                                out_value);
+}
+
 IREE_API_EXPORT iree_status_t iree_vm_list_get_ref_assign(
     const iree_vm_list_t* list, iree_host_size_t i, iree_vm_ref_t* out_value) {
   return iree_vm_list_get_ref_assign_or_retain(list, i, /*is_retain=*/false,
@@ -847,30 +945,44 @@ IREE_API_EXPORT iree_status_t iree_vm_list_get_ref_retain(
                                                out_value);
 }
 
-static iree_status_t iree_vm_list_set_ref(iree_vm_list_t* list,
-                                          iree_host_size_t i, bool is_move,
-                                          iree_vm_ref_t* value) {
-  if (i >= list->count) {
-    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
-                            "index %" PRIhsz " out of bounds (%" PRIhsz ")", i,
-                            list->count);
-  }
-  uintptr_t element_ptr = (uintptr_t)list->storage + i * list->element_size;
+// Sets |length| ref type |list| elements starting at |offset| from |values|,
+// either moving or retaining them based on |is_move|. The range must have been
+// verified by the caller. All ref types are checked prior to modifying the
+// list such that the list is unchanged on failure.
+static iree_status_t iree_vm_list_set_refs(iree_vm_list_t* list,
+                                           iree_host_size_t offset,
+                                           iree_host_size_t length,
+                                           bool is_move,
+                                           iree_vm_ref_t* values) {
   switch (list->storage_mode) {
     case IREE_VM_LIST_STORAGE_MODE_REF: {
-      iree_vm_ref_t* element_ref = (iree_vm_ref_t*)element_ptr;
-      IREE_RETURN_IF_ERROR(iree_vm_ref_retain_or_move_checked(
-          is_move, value, iree_vm_type_def_as_ref(list->element_type),
-          element_ref));
+      const iree_vm_ref_type_t element_type =
+          iree_vm_type_def_as_ref(list->element_type);
+      for (iree_host_size_t i = 0; i < length; ++i) {
+        if (values[i].type != IREE_VM_REF_TYPE_NULL &&
+            values[i].type != element_type &&
+            element_type != IREE_VM_REF_TYPE_ANY) {
+          return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                  "source ref type mismatch at index %" PRIhsz,
+                                  offset + i);
+        }
+      }
+      iree_vm_ref_t* element_refs = (iree_vm_ref_t*)list->storage + offset;
+      for (iree_host_size_t i = 0; i < length; ++i) {
+        iree_vm_ref_retain_or_move(is_move, &values[i], &element_refs[i]);
+      }
       break;
     }
     case IREE_VM_LIST_STORAGE_MODE_VARIANT: {
-      iree_vm_variant_t* variant = (iree_vm_variant_t*)element_ptr;
-      if (iree_vm_variant_is_value(*variant)) {
-        memset(&variant->ref, 0, sizeof(variant->ref));
+      iree_vm_variant_t* variants = (iree_vm_variant_t*)list->storage + offset;
+      for (iree_host_size_t i = 0; i < length; ++i) {
+        iree_vm_variant_t* variant = &variants[i];
+        if (iree_vm_variant_is_value(*variant)) {
+          memset(&variant->ref, 0, sizeof(variant->ref));
+        }
+        variant->type = iree_vm_make_ref_type_def(values[i].type);
+        iree_vm_ref_retain_or_move(is_move, &values[i], &variant->ref);
       }
-      variant->type = iree_vm_make_ref_type_def(value->type);
-      iree_vm_ref_retain_or_move(is_move, value, &variant->ref);
       break;
     }
     default:
@@ -880,6 +992,17 @@ static iree_status_t iree_vm_list_set_ref(iree_vm_list_t* list,
   return iree_ok_status();
 }
 
+static iree_status_t iree_vm_list_set_ref(iree_vm_list_t* list,
+                                          iree_host_size_t i, bool is_move,
+                                          iree_vm_ref_t* value) {
+  if (i >= list->count) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "index %" PRIhsz " out of bounds (%" PRIhsz ")", i,
+                            list->count);
+  }
+  return iree_vm_list_set_refs(list, i, 1, is_move, value);
+}
+
 IREE_API_EXPORT iree_status_t iree_vm_list_set_ref_retain(
     iree_vm_list_t* list, iree_host_size_t i, const iree_vm_ref_t* value) {
   return iree_vm_list_set_ref(list, i, /*is_move=*/false,
@@ -922,6 +1045,29 @@ IREE_API_EXPORT iree_status_t iree_vm_list_pop_front_ref_move(
   return iree_ok_status();
 }
 
+IREE_API_EXPORT iree_status_t iree_vm_list_get_refs_retain(
+    const iree_vm_list_t* list, iree_host_size_t offset,
+    iree_host_size_t length, iree_vm_ref_t* out_values) {
+  IREE_RETURN_IF_ERROR(iree_vm_list_verify_range(list, offset, length));
+  return iree_vm_list_get_refs_assign_or_retain(
+      list, offset, length, /*is_retain=*/true, out_values);
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_list_set_refs_retain(
+    iree_vm_list_t* list, iree_host_size_t offset, iree_host_size_t length,
+    const iree_vm_ref_t* values) {
+  IREE_RETURN_IF_ERROR(iree_vm_list_verify_range(list, offset, length));
+  return iree_vm_list_set_refs(list, offset, length, /*is_move=*/false,
+                               (iree_vm_ref_t*)values);
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_list_set_refs_move(
+    iree_vm_list_t* list, iree_host_size_t offset, iree_host_size_t length,
+    iree_vm_ref_t* values) {
+  IREE_RETURN_IF_ERROR(iree_vm_list_verify_range(list, offset, length));
+  return iree_vm_list_set_refs(list, offset, length, /*is_move=*/true, values);
+}
+
 typedef enum {
   IREE_VM_LIST_REF_ASSIGN = 0,
   IREE_VM_LIST_REF_RETAIN,
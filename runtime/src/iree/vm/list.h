@@ -157,6 +157,33 @@ IREE_API_EXPORT iree_status_t iree_vm_list_set_value(
 IREE_API_EXPORT iree_status_t
 iree_vm_list_push_value(iree_vm_list_t* list, const iree_vm_value_t* value);
 
+// Maps |length| elements starting at |offset| as a span directly referencing
+// the list storage. Only lists with primitive value storage of |value_type| can
+// be mapped and reads/writes through the span are performed without
+// conversion. The span is invalidated by any operation that changes the list
+// capacity or storage (resize, reserve, push, swap, etc).
+IREE_API_EXPORT iree_status_t iree_vm_list_map_values(
+    iree_vm_list_t* list, iree_host_size_t offset, iree_host_size_t length,
+    iree_vm_value_type_t value_type, iree_byte_span_t* out_span);
+
+// Copies |length| element values starting at |offset| into |out_values| as a
+// densely packed array of |value_type|. If the specified |value_type| differs
+// from the list storage type the values will be converted using the value
+// type semantics (such as sign/zero extend, etc). Matching types are copied in
+// bulk.
+IREE_API_EXPORT iree_status_t iree_vm_list_get_values_as(
+    const iree_vm_list_t* list, iree_host_size_t offset,
+    iree_host_size_t length, iree_vm_value_type_t value_type,
+    iree_byte_span_t out_values);
+
+// Sets |length| element values starting at |offset| from |values| as a densely
+// packed array of |value_type|. If the specified |value_type| differs from the
+// list storage type the values will be converted using the value type
+// semantics (such as sign/zero extend, etc). Matching types are copied in bulk.
+IREE_API_EXPORT iree_status_t iree_vm_list_set_values_as(
+    iree_vm_list_t* list, iree_host_size_t offset, iree_host_size_t length,
+    iree_vm_value_type_t value_type, iree_const_byte_span_t values);
+
 // Returns a dereferenced pointer to the given type if the element at the
 // given index |i| matches the |type|. Returns NULL on error.
 IREE_API_EXPORT void* iree_vm_list_get_ref_deref(const iree_vm_list_t* list,
@@ -199,6 +226,27 @@ IREE_API_EXPORT iree_status_t iree_vm_list_push_ref_move(iree_vm_list_t* list,
 IREE_API_EXPORT iree_status_t
 iree_vm_list_pop_front_ref_move(iree_vm_list_t* list, iree_vm_ref_t* out_value);
 
+// Returns the ref values of |length| elements starting at |offset| in
+// |out_values|. The refs will be retained and must be released by the caller.
+// No refs are returned if any element is not a ref.
+IREE_API_EXPORT iree_status_t iree_vm_list_get_refs_retain(
+    const iree_vm_list_t* list, iree_host_size_t offset,
+    iree_host_size_t length, iree_vm_ref_t* out_values);
+
+// Sets the ref values of |length| elements starting at |offset| from |values|,
+// retaining references in the list until the elements are cleared or the list
+// is disposed. The list is unchanged if any ref type does not match.
+IREE_API_EXPORT iree_status_t iree_vm_list_set_refs_retain(
+    iree_vm_list_t* list, iree_host_size_t offset, iree_host_size_t length,
+    const iree_vm_ref_t* values);
+
+// Sets the ref values of |length| elements starting at |offset| from |values|,
+// moving ownership of the |values| references to the list. The list and
+// |values| are unchanged if any ref type does not match.
+IREE_API_EXPORT iree_status_t iree_vm_list_set_refs_move(
+    iree_vm_list_t* list, iree_host_size_t offset, iree_host_size_t length,
+    iree_vm_ref_t* values);
+
 // Returns the value of the element at the given index. If the element contains
 // a ref it will *not* be retained and the caller must retain it to extend its
 // lifetime.
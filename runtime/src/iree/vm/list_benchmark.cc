@@ -0,0 +1,123 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <cstdint>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "iree/base/api.h"
+#include "iree/vm/instance.h"
+#include "iree/vm/list.h"
+
+namespace {
+
+// Lists require their type to be registered with an instance.
+static iree_vm_instance_t* GetInstance() {
+  static iree_vm_instance_t* instance = [] {
+    iree_vm_instance_t* instance = NULL;
+    IREE_CHECK_OK(iree_vm_instance_create(IREE_VM_TYPE_CAPACITY_DEFAULT,
+                                          iree_allocator_system(), &instance));
+    return instance;
+  }();
+  return instance;
+}
+
+static iree_vm_list_t* CreateValueList(iree_vm_value_type_t value_type,
+                                       iree_host_size_t count) {
+  GetInstance();
+  iree_vm_list_t* list = NULL;
+  IREE_CHECK_OK(iree_vm_list_create(iree_vm_make_value_type_def(value_type),
+                                    count, iree_allocator_system(), &list));
+  IREE_CHECK_OK(iree_vm_list_resize(list, count));
+  return list;
+}
+
+// Reads all elements one at a time with iree_vm_list_get_value_as.
+void BM_GetValueAsI32(benchmark::State& state) {
+  const iree_host_size_t count = (iree_host_size_t)state.range(0);
+  iree_vm_list_t* list = CreateValueList(IREE_VM_VALUE_TYPE_I32, count);
+  std::vector<int32_t> values(count);
+  for (auto _ : state) {
+    for (iree_host_size_t i = 0; i < count; ++i) {
+      iree_vm_value_t value;
+      IREE_CHECK_OK(
+          iree_vm_list_get_value_as(list, i, IREE_VM_VALUE_TYPE_I32, &value));
+      values[i] = value.i32;
+    }
+    benchmark::DoNotOptimize(values.data());
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+  iree_vm_list_release(list);
+}
+BENCHMARK(BM_GetValueAsI32)->Range(8, 8 << 10);
+
+// Reads all elements with a single iree_vm_list_get_values_as.
+void BM_GetValuesAsI32(benchmark::State& state) {
+  const iree_host_size_t count = (iree_host_size_t)state.range(0);
+  iree_vm_list_t* list = CreateValueList(IREE_VM_VALUE_TYPE_I32, count);
+  std::vector<int32_t> values(count);
+  for (auto _ : state) {
+    IREE_CHECK_OK(iree_vm_list_get_values_as(
+        list, 0, count, IREE_VM_VALUE_TYPE_I32,
+        iree_make_byte_span(values.data(), count * sizeof(int32_t))));
+    benchmark::DoNotOptimize(values.data());
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+  iree_vm_list_release(list);
+}
+BENCHMARK(BM_GetValuesAsI32)->Range(8, 8 << 10);
+
+// Reads all elements with a single iree_vm_list_get_values_as that widens
+// each element.
+void BM_GetValuesAsI32ToI64(benchmark::State& state) {
+  const iree_host_size_t count = (iree_host_size_t)state.range(0);
+  iree_vm_list_t* list = CreateValueList(IREE_VM_VALUE_TYPE_I32, count);
+  std::vector<int64_t> values(count);
+  for (auto _ : state) {
+    IREE_CHECK_OK(iree_vm_list_get_values_as(
+        list, 0, count, IREE_VM_VALUE_TYPE_I64,
+        iree_make_byte_span(values.data(), count * sizeof(int64_t))));
+    benchmark::DoNotOptimize(values.data());
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+  iree_vm_list_release(list);
+}
+BENCHMARK(BM_GetValuesAsI32ToI64)->Range(8, 8 << 10);
+
+// Writes all elements one at a time with iree_vm_list_set_value.
+void BM_SetValueI32(benchmark::State& state) {
+  const iree_host_size_t count = (iree_host_size_t)state.range(0);
+  iree_vm_list_t* list = CreateValueList(IREE_VM_VALUE_TYPE_I32, count);
+  for (auto _ : state) {
+    for (iree_host_size_t i = 0; i < count; ++i) {
+      iree_vm_value_t value = iree_vm_value_make_i32((int32_t)i);
+      IREE_CHECK_OK(iree_vm_list_set_value(list, i, &value));
+    }
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+  iree_vm_list_release(list);
+}
+BENCHMARK(BM_SetValueI32)->Range(8, 8 << 10);
+
+// Writes all elements through a span mapped with iree_vm_list_map_values.
+void BM_MapValuesI32(benchmark::State& state) {
+  const iree_host_size_t count = (iree_host_size_t)state.range(0);
+  iree_vm_list_t* list = CreateValueList(IREE_VM_VALUE_TYPE_I32, count);
+  for (auto _ : state) {
+    iree_byte_span_t span = iree_byte_span_empty();
+    IREE_CHECK_OK(iree_vm_list_map_values(list, 0, count,
+                                          IREE_VM_VALUE_TYPE_I32, &span));
+    int32_t* values = (int32_t*)span.data;
+    for (iree_host_size_t i = 0; i < count; ++i) values[i] = (int32_t)i;
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+  iree_vm_list_release(list);
+}
+BENCHMARK(BM_MapValuesI32)->Range(8, 8 << 10);
+
+}  // namespace
@@ -1251,6 +1251,166 @@ TEST_F(VMListTest, PushPopRef) {
   iree_vm_list_release(list);
 }
 
+// Tests mapping primitive value list storage directly.
+TEST_F(VMListTest, MapValues) {
+  iree_vm_type_def_t element_type =
+      iree_vm_make_value_type_def(IREE_VM_VALUE_TYPE_I32);
+  iree_vm_list_t* list = nullptr;
+  IREE_ASSERT_OK(
+      iree_vm_list_create(element_type, 8, iree_allocator_system(), &list));
+  IREE_ASSERT_OK(iree_vm_list_resize(list, 8));
+
+  // Writes through the span are visible to the per-element accessors.
+  iree_byte_span_t span = iree_byte_span_empty();
+  IREE_ASSERT_OK(
+      iree_vm_list_map_values(list, 2, 4, IREE_VM_VALUE_TYPE_I32, &span));
+  ASSERT_EQ(4 * sizeof(int32_t), span.data_length);
+  int32_t* values = (int32_t*)span.data;
+  for (int32_t i = 0; i < 4; ++i) values[i] = 100 + i;
+  EXPECT_THAT(GetValuesList(list),
+              Eq(MakeValuesList({0, 0, 100, 101, 102, 103, 0, 0})));
+
+  // Ranges must be in bounds and types must match exactly.
+  EXPECT_THAT(Status(iree_vm_list_map_values(list, 6, 3,
+                                             IREE_VM_VALUE_TYPE_I32, &span)),
+              StatusIs(StatusCode::kOutOfRange));
+  EXPECT_THAT(Status(iree_vm_list_map_values(list, 0, 1,
+                                             IREE_VM_VALUE_TYPE_I64, &span)),
+              StatusIs(StatusCode::kFailedPrecondition));
+  EXPECT_EQ(0, span.data_length);
+
+  iree_vm_list_release(list);
+}
+
+// Tests bulk value get/set with and without conversion.
+TEST_F(VMListTest, GetSetValuesAs) {
+  iree_vm_type_def_t element_type =
+      iree_vm_make_value_type_def(IREE_VM_VALUE_TYPE_I32);
+  iree_vm_list_t* list = nullptr;
+  IREE_ASSERT_OK(
+      iree_vm_list_create(element_type, 6, iree_allocator_system(), &list));
+  IREE_ASSERT_OK(iree_vm_list_resize(list, 6));
+
+  const int32_t i32_values[4] = {-1, 2, -3, 4};
+  IREE_ASSERT_OK(iree_vm_list_set_values_as(
+      list, 1, 4, IREE_VM_VALUE_TYPE_I32,
+      iree_make_const_byte_span(i32_values, sizeof(i32_values))));
+  EXPECT_THAT(GetValuesList(list), Eq(MakeValuesList({0, -1, 2, -3, 4, 0})));
+
+  // Narrower values are sign extended into the list.
+  const int8_t i8_values[2] = {-5, 6};
+  IREE_ASSERT_OK(iree_vm_list_set_values_as(
+      list, 4, 2, IREE_VM_VALUE_TYPE_I8,
+      iree_make_const_byte_span(i8_values, sizeof(i8_values))));
+  EXPECT_THAT(GetValuesList(list), Eq(MakeValuesList({0, -1, 2, -3, -5, 6})));
+
+  int32_t i32_results[6] = {0};
+  IREE_ASSERT_OK(iree_vm_list_get_values_as(
+      list, 0, 6, IREE_VM_VALUE_TYPE_I32,
+      iree_make_byte_span(i32_results, sizeof(i32_results))));
+  const int32_t expected_i32[6] = {0, -1, 2, -3, -5, 6};
+  EXPECT_EQ(0, memcmp(expected_i32, i32_results, sizeof(expected_i32)));
+
+  int64_t i64_results[3] = {0};
+  IREE_ASSERT_OK(iree_vm_list_get_values_as(
+      list, 1, 3, IREE_VM_VALUE_TYPE_I64,
+      iree_make_byte_span(i64_results, sizeof(i64_results))));
+  EXPECT_EQ(-1, i64_results[0]);
+  EXPECT_EQ(2, i64_results[1]);
+  EXPECT_EQ(-3, i64_results[2]);
+
+  // Out of bounds ranges and undersized buffers fail.
+  EXPECT_THAT(Status(iree_vm_list_get_values_as(
+                  list, 4, 3, IREE_VM_VALUE_TYPE_I32,
+                  iree_make_byte_span(i32_results, sizeof(i32_results)))),
+              StatusIs(StatusCode::kOutOfRange));
+  EXPECT_THAT(Status(iree_vm_list_get_values_as(
+                  list, 0, 4, IREE_VM_VALUE_TYPE_I64,
+                  iree_make_byte_span(i64_results, sizeof(i64_results)))),
+              StatusIs(StatusCode::kInvalidArgument));
+
+  iree_vm_list_release(list);
+}
+
+// Tests bulk value get/set on variant lists.
+TEST_F(VMListTest, GetSetValuesAsVariant) {
+  iree_vm_type_def_t element_type = iree_vm_make_undefined_type_def();
+  iree_vm_list_t* list = nullptr;
+  IREE_ASSERT_OK(
+      iree_vm_list_create(element_type, 4, iree_allocator_system(), &list));
+  IREE_ASSERT_OK(iree_vm_list_resize(list, 4));
+
+  // Replaces a ref element; the ref must be released.
+  iree_vm_ref_t ref_a = MakeRef<A>(1.0f);
+  IREE_ASSERT_OK(iree_vm_list_set_ref_move(list, 3, &ref_a));
+
+  const float f32_values[4] = {0.5f, 1.5f, 2.5f, 3.5f};
+  IREE_ASSERT_OK(iree_vm_list_set_values_as(
+      list, 0, 4, IREE_VM_VALUE_TYPE_F32,
+      iree_make_const_byte_span(f32_values, sizeof(f32_values))));
+  EXPECT_THAT(GetValuesList(list),
+              Eq(MakeValuesList({0.5f, 1.5f, 2.5f, 3.5f})));
+
+  float f32_results[2] = {0};
+  IREE_ASSERT_OK(iree_vm_list_get_values_as(
+      list, 2, 2, IREE_VM_VALUE_TYPE_F32,
+      iree_make_byte_span(f32_results, sizeof(f32_results))));
+  EXPECT_EQ(2.5f, f32_results[0]);
+  EXPECT_EQ(3.5f, f32_results[1]);
+
+  // Variant lists cannot be mapped.
+  iree_byte_span_t span = iree_byte_span_empty();
+  EXPECT_THAT(Status(iree_vm_list_map_values(list, 0, 1,
+                                             IREE_VM_VALUE_TYPE_F32, &span)),
+              StatusIs(StatusCode::kFailedPrecondition));
+
+  iree_vm_list_release(list);
+}
+
+// Tests bulk ref get/set with retain and move semantics.
+TEST_F(VMListTest, GetSetRefs) {
+  iree_vm_type_def_t element_type = iree_vm_make_ref_type_def(test_a_type());
+  iree_vm_list_t* list = nullptr;
+  IREE_ASSERT_OK(
+      iree_vm_list_create(element_type, 4, iree_allocator_system(), &list));
+  IREE_ASSERT_OK(iree_vm_list_resize(list, 4));
+
+  iree_vm_ref_t refs[3] = {
+      MakeRef<A>(0.0f),
+      MakeRef<A>(1.0f),
+      MakeRef<A>(2.0f),
+  };
+  IREE_ASSERT_OK(iree_vm_list_set_refs_retain(list, 0, 3, refs));
+  IREE_ASSERT_OK(iree_vm_list_set_refs_move(list, 1, 3, refs));
+  for (iree_host_size_t i = 0; i < 3; ++i) {
+    EXPECT_TRUE(iree_vm_ref_is_null(&refs[i]));
+  }
+  EXPECT_THAT(GetValuesList(list),
+              Eq(MakeValuesList({0.0f, 0.0f, 1.0f, 2.0f})));
+
+  // Type mismatches leave both the list and the source refs unchanged.
+  iree_vm_ref_t mixed_refs[2] = {MakeRef<A>(4.0f), MakeRef<B>(5)};
+  EXPECT_THAT(Status(iree_vm_list_set_refs_move(list, 0, 2, mixed_refs)),
+              StatusIs(StatusCode::kInvalidArgument));
+  EXPECT_FALSE(iree_vm_ref_is_null(&mixed_refs[0]));
+  EXPECT_THAT(GetValuesList(list),
+              Eq(MakeValuesList({0.0f, 0.0f, 1.0f, 2.0f})));
+  iree_vm_ref_release(&mixed_refs[0]);
+  iree_vm_ref_release(&mixed_refs[1]);
+
+  iree_vm_ref_t results[4] = {{0}};
+  IREE_ASSERT_OK(iree_vm_list_get_refs_retain(list, 0, 4, results));
+  EXPECT_TRUE(results[0] == results[1]);
+  for (iree_host_size_t i = 1; i < 4; ++i) {
+    ASSERT_TRUE(test_a_isa(results[i]));
+    EXPECT_EQ(i - 1, test_a_deref(results[i])->data());
+  }
+  iree_vm_list_release(list);
+  // The retained refs outlive the list.
+  EXPECT_EQ(2.0f, test_a_deref(results[3])->data());
+  for (iree_host_size_t i = 0; i < 4; ++i) iree_vm_ref_release(&results[i]);
+}
+
 // TODO(benvanik): test primitive variant get/set.
 
 // TODO(benvanik): test ref variant get/set.
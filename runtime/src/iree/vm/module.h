@@ -451,6 +451,23 @@ typedef struct iree_vm_module_t {
   // without first completing prior ones.
   iree_status_t(IREE_API_PTR* resume_call)(void* self, iree_vm_stack_t* stack,
                                            iree_byte_span_t call_results);
+
+  // Allocates module state data by forking |parent_state| (optional).
+  // The child state must behave as if it had been allocated, had its imports
+  // resolved, and been initialized identically to |parent_state| at the time
+  // of the fork. Values stored directly in the state (such as globals) must be
+  // independent such that updates made with either state are not observable by
+  // the other while referenced objects (executables, buffers, etc) may be
+  // shared. Imports resolved in |parent_state| remain valid in the child as it
+  // is placed in a context with the same modules. Objects that may be mutated
+  // after initialization must not be shared; implementations that cannot
+  // clone them must fail with IREE_STATUS_FAILED_PRECONDITION.
+  //
+  // Modules that do not implement forking leave this NULL and are given fresh
+  // state (and have their initializers run) when their context is forked.
+  iree_status_t(IREE_API_PTR* fork_state)(
+      void* self, iree_vm_module_state_t* parent_state,
+      iree_allocator_t allocator, iree_vm_module_state_t** out_child_state);
 } iree_vm_module_t;
 
 // Initializes the interface of a module handle.
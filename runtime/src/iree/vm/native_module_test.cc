@@ -21,6 +21,118 @@
 namespace iree {
 namespace {
 
+//===----------------------------------------------------------------------===//
+// module_c
+//===----------------------------------------------------------------------===//
+// A stateful module that does not implement fork_state. Forked contexts have
+// to allocate fresh state for it, resolve its imports, and run its __init.
+
+typedef struct module_c_state_t {
+  iree_allocator_t allocator;
+  iree_vm_function_t imports[1];
+  // Starts at 0 and is bumped to 1 by __init through module_a.add_1.
+  int32_t counter;
+} module_c_state_t;
+
+static iree_status_t IREE_API_PTR
+module_c_alloc_state(void* self, iree_allocator_t allocator,
+                     iree_vm_module_state_t** out_module_state) {
+  module_c_state_t* state = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_allocator_malloc(allocator, sizeof(*state), (void**)&state));
+  memset(state, 0, sizeof(*state));
+  state->allocator = allocator;
+  *out_module_state = (iree_vm_module_state_t*)state;
+  return iree_ok_status();
+}
+
+static void IREE_API_PTR
+module_c_free_state(void* self, iree_vm_module_state_t* module_state) {
+  module_c_state_t* state = (module_c_state_t*)module_state;
+  iree_allocator_free(state->allocator, state);
+}
+
+static iree_status_t IREE_API_PTR module_c_resolve_import(
+    void* self, iree_vm_module_state_t* module_state, iree_host_size_t ordinal,
+    const iree_vm_function_t* function,
+    const iree_vm_function_signature_t* signature) {
+  module_c_state_t* state = (module_c_state_t*)module_state;
+  state->imports[ordinal] = *function;
+  return iree_ok_status();
+}
+
+typedef iree_status_t (*call_v_v_t)(iree_vm_stack_t* stack, void* module_ptr,
+                                    void* module_state);
+
+static iree_status_t call_shim_v_v(iree_vm_stack_t* stack,
+                                   iree_vm_native_function_flags_t flags,
+                                   iree_byte_span_t args_storage,
+                                   iree_byte_span_t rets_storage,
+                                   call_v_v_t target_fn, void* module,
+                                   void* module_state) {
+  return target_fn(stack, module, module_state);
+}
+
+// vm.export @__init()
+static iree_status_t module_c_init(iree_vm_stack_t* stack, void* module,
+                                   module_c_state_t* module_state) {
+  return call_import_i32_i32(stack, &module_state->imports[0],
+                             module_state->counter, &module_state->counter);
+}
+
+// vm.export @entry(%arg0 : i32) -> i32
+static iree_status_t module_c_entry(iree_vm_stack_t* stack, void* module,
+                                    module_c_state_t* module_state,
+                                    int32_t arg0, int32_t* out_ret0) {
+  module_state->counter += arg0;
+  *out_ret0 = module_state->counter;
+  return iree_ok_status();
+}
+
+static const iree_vm_native_function_ptr_t module_c_funcs_[] = {
+    {(iree_vm_native_function_shim_t)call_shim_v_v,
+     (iree_vm_native_function_target_t)module_c_init},
+    {(iree_vm_native_function_shim_t)call_shim_i32_i32,
+     (iree_vm_native_function_target_t)module_c_entry},
+};
+static const iree_vm_native_import_descriptor_t module_c_imports_[] = {
+    {IREE_VM_NATIVE_IMPORT_REQUIRED, iree_make_cstring_view("module_a.add_1")},
+};
+static const iree_vm_native_export_descriptor_t module_c_exports_[] = {
+    {iree_make_cstring_view("__init"), iree_make_cstring_view("0v_v"), 0,
+     NULL},
+    {iree_make_cstring_view("entry"), iree_make_cstring_view("0i_i"), 0, NULL},
+};
+static_assert(IREE_ARRAYSIZE(module_c_funcs_) ==
+                  IREE_ARRAYSIZE(module_c_exports_),
+              "function pointer table must be 1:1 with exports");
+static const iree_vm_native_module_descriptor_t module_c_descriptor_ = {
+    /*name=*/iree_make_cstring_view("module_c"),
+    /*version=*/0,
+    /*attr_count=*/0,
+    /*attrs=*/NULL,
+    /*dependency_count=*/0,
+    /*dependencies=*/NULL,
+    /*import_count=*/IREE_ARRAYSIZE(module_c_imports_),
+    /*imports=*/module_c_imports_,
+    /*export_count=*/IREE_ARRAYSIZE(module_c_exports_),
+    /*exports=*/module_c_exports_,
+    /*function_count=*/IREE_ARRAYSIZE(module_c_funcs_),
+    /*functions=*/module_c_funcs_,
+};
+
+static iree_status_t module_c_create(iree_vm_instance_t* instance,
+                                     iree_allocator_t allocator,
+                                     iree_vm_module_t** out_module) {
+  iree_vm_module_t interface;
+  IREE_RETURN_IF_ERROR(iree_vm_module_initialize(&interface, NULL));
+  interface.alloc_state = module_c_alloc_state;
+  interface.free_state = module_c_free_state;
+  interface.resolve_import = module_c_resolve_import;
+  return iree_vm_native_module_create(&interface, &module_c_descriptor_,
+                                      instance, allocator, out_module);
+}
+
 // Test suite that uses module_a and module_b defined in native_module_test.h.
 // Both modules are put in a context and the module_b.entry function can be
 // executed with RunFunction.
@@ -59,12 +171,18 @@ class VMNativeModuleTest : public ::testing::Test {
 
   StatusOr<int32_t> RunFunction(iree_string_view_t function_name,
                                 int32_t arg0) {
+    return RunFunction(context_, function_name, arg0);
+  }
+
+  StatusOr<int32_t> RunFunction(iree_vm_context_t* context,
+                                iree_string_view_t function_name,
+                                int32_t arg0) {
     // Lookup the entry function. This can be cached in an application if
     // multiple calls will be made.
     iree_vm_function_t function;
     IREE_RETURN_IF_ERROR(
         iree_vm_context_resolve_function(
-            context_, iree_make_cstring_view("module_b.entry"), &function),
+            context, function_name, &function),
         "unable to resolve entry point");
 
     // Setup I/O lists and pass in the argument. The result list will be
@@ -83,7 +201,7 @@ class VMNativeModuleTest : public ::testing::Test {
 
     // Invoke the entry function to do our work. Runs synchronously.
     IREE_RETURN_IF_ERROR(
-        iree_vm_invoke(context_, function, IREE_VM_INVOCATION_FLAG_NONE,
+        iree_vm_invoke(context, function, IREE_VM_INVOCATION_FLAG_NONE,
                        /*policy=*/nullptr, input_list.get(), output_list.get(),
                        iree_allocator_system()));
 
@@ -94,7 +212,7 @@ class VMNativeModuleTest : public ::testing::Test {
     return ret0_value.i32;
   }
 
- private:
+ protected:
   iree_vm_instance_t* instance_ = nullptr;
   iree_vm_context_t* context_ = nullptr;
 };
@@ -111,5 +229,104 @@ TEST_F(VMNativeModuleTest, Example) {
   ASSERT_EQ(v2, 8);
 }
 
+// Forked contexts start from the parent state and then diverge.
+TEST_F(VMNativeModuleTest, Fork) {
+  IREE_ASSERT_OK_AND_ASSIGN(
+      int32_t v0, RunFunction(iree_make_cstring_view("module_b.entry"), 1));
+  ASSERT_EQ(v0, 1);
+
+  iree_vm_context_t* forked_context = nullptr;
+  IREE_ASSERT_OK(
+      iree_vm_context_fork(context_, iree_allocator_system(), &forked_context));
+  EXPECT_EQ(iree_vm_context_module_count(forked_context),
+            iree_vm_context_module_count(context_));
+  EXPECT_NE(iree_vm_context_id(forked_context), iree_vm_context_id(context_));
+
+  // Both contexts continue from the counter at the time of the fork.
+  IREE_ASSERT_OK_AND_ASSIGN(
+      int32_t v1, RunFunction(forked_context,
+                              iree_make_cstring_view("module_b.entry"), 2));
+  ASSERT_EQ(v1, 4);
+  IREE_ASSERT_OK_AND_ASSIGN(
+      int32_t v2, RunFunction(forked_context,
+                              iree_make_cstring_view("module_b.entry"), 3));
+  ASSERT_EQ(v2, 8);
+  IREE_ASSERT_OK_AND_ASSIGN(
+      int32_t v3, RunFunction(iree_make_cstring_view("module_b.entry"), 2));
+  ASSERT_EQ(v3, 4);
+
+  // The fork outlives the parent.
+  iree_vm_context_release(context_);
+  context_ = nullptr;
+  IREE_ASSERT_OK_AND_ASSIGN(
+      int32_t v4, RunFunction(forked_context,
+                              iree_make_cstring_view("module_b.entry"), 1));
+  ASSERT_EQ(v4, 10);
+  iree_vm_context_release(forked_context);
+}
+
+// Modules without fork_state get fresh state in the fork with imports resolved
+// and __init run while modules that can fork keep their parent state.
+TEST_F(VMNativeModuleTest, ForkWithoutForkState) {
+  iree_vm_module_t* module_a = nullptr;
+  IREE_ASSERT_OK(
+      module_a_create(instance_, iree_allocator_system(), &module_a));
+  iree_vm_module_t* module_b = nullptr;
+  IREE_ASSERT_OK(
+      module_b_create(instance_, iree_allocator_system(), &module_b));
+  iree_vm_module_t* module_c = nullptr;
+  IREE_ASSERT_OK(
+      module_c_create(instance_, iree_allocator_system(), &module_c));
+  ASSERT_EQ(module_c->fork_state, nullptr);
+  std::vector<iree_vm_module_t*> modules = {module_a, module_b, module_c};
+  iree_vm_context_t* context = nullptr;
+  IREE_ASSERT_OK(iree_vm_context_create_with_modules(
+      instance_, IREE_VM_CONTEXT_FLAG_NONE, modules.size(), modules.data(),
+      iree_allocator_system(), &context));
+  iree_vm_module_release(module_a);
+  iree_vm_module_release(module_b);
+  iree_vm_module_release(module_c);
+
+  // __init ran on registration and the state diverges with use.
+  IREE_ASSERT_OK_AND_ASSIGN(
+      int32_t v0,
+      RunFunction(context, iree_make_cstring_view("module_c.entry"), 0));
+  ASSERT_EQ(v0, 1);
+  IREE_ASSERT_OK_AND_ASSIGN(
+      int32_t v1,
+      RunFunction(context, iree_make_cstring_view("module_c.entry"), 5));
+  ASSERT_EQ(v1, 6);
+  IREE_ASSERT_OK_AND_ASSIGN(
+      int32_t v2,
+      RunFunction(context, iree_make_cstring_view("module_b.entry"), 1));
+  ASSERT_EQ(v2, 1);
+
+  iree_vm_context_t* forked_context = nullptr;
+  IREE_ASSERT_OK(
+      iree_vm_context_fork(context, iree_allocator_system(), &forked_context));
+
+  // module_c starts over: its __init ran once in the fork through the
+  // module_a.add_1 import resolved against the forked context.
+  IREE_ASSERT_OK_AND_ASSIGN(
+      int32_t v3, RunFunction(forked_context,
+                              iree_make_cstring_view("module_c.entry"), 0));
+  EXPECT_EQ(v3, 1);
+
+  // module_b still carries over the parent counter.
+  IREE_ASSERT_OK_AND_ASSIGN(
+      int32_t v4, RunFunction(forked_context,
+                              iree_make_cstring_view("module_b.entry"), 2));
+  EXPECT_EQ(v4, 4);
+
+  // The parent is unaffected by the fork.
+  IREE_ASSERT_OK_AND_ASSIGN(
+      int32_t v5,
+      RunFunction(context, iree_make_cstring_view("module_c.entry"), 0));
+  EXPECT_EQ(v5, 6);
+
+  iree_vm_context_release(forked_context);
+  iree_vm_context_release(context);
+}
+
 }  // namespace
 }  // namespace iree
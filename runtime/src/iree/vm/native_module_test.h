@@ -196,6 +196,21 @@ module_b_free_state(void* self, iree_vm_module_state_t* module_state) {
   iree_allocator_free(state->allocator, state);
 }
 
+// Allocates per-context state for a forked context by copying the parent
+// state, including its resolved imports and user data.
+static iree_status_t IREE_API_PTR
+module_b_fork_state(void* self, iree_vm_module_state_t* parent_state,
+                    iree_allocator_t allocator,
+                    iree_vm_module_state_t** out_child_state) {
+  module_b_state_t* state = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_allocator_malloc(allocator, sizeof(*state), (void**)&state));
+  memcpy(state, parent_state, sizeof(*state));
+  state->allocator = allocator;
+  *out_child_state = (iree_vm_module_state_t*)state;
+  return iree_ok_status();
+}
+
 // Called once per import function so the module can store the function ref.
 static iree_status_t IREE_API_PTR module_b_resolve_import(
     void* self, iree_vm_module_state_t* module_state, iree_host_size_t ordinal,
@@ -311,6 +326,7 @@ static iree_status_t module_b_create(iree_vm_instance_t* instance,
   interface.alloc_state = module_b_alloc_state;
   interface.free_state = module_b_free_state;
   interface.resolve_import = module_b_resolve_import;
+  interface.fork_state = module_b_fork_state;
   return iree_vm_native_module_create(&interface, &module_b_descriptor_,
                                       instance, allocator, out_module);
 }
@@ -0,0 +1,42 @@
+func.func @attention_uniform() {
+  %init = tensor.empty() : tensor<2x64x16xf32>
+  %query = util.unfoldable_constant dense<1.0> : tensor<2x64x16xf32>
+  %key = util.unfoldable_constant dense<0.5> : tensor<2x256x16xf32>
+  %value = util.unfoldable_constant dense<2.0> : tensor<2x256x16xf32>
+  %1 = iree_linalg_ext.attention
+       ins(%query, %key, %value : tensor<2x64x16xf32>, tensor<2x256x16xf32>, tensor<2x256x16xf32>)
+       outs(%init : tensor<2x64x16xf32>) -> tensor<2x64x16xf32>
+  check.expect_almost_eq_const(
+      %1,
+      dense<2.0> : tensor<2x64x16xf32>
+  ) : tensor<2x64x16xf32>
+  return
+}
+
+func.func @attention_mean_of_values() {
+  %init = tensor.empty() : tensor<2x64x16xf32>
+  %query = util.unfoldable_constant dense<0.25> : tensor<2x64x16xf32>
+  %key = util.unfoldable_constant dense<1.0> : tensor<2x256x16xf32>
+  // value[b, l, d] = l % 2, so every output row is the mean 0.5.
+  %empty = tensor.empty() : tensor<2x256x16xf32>
+  %value = linalg.generic {
+      indexing_maps = [affine_map<(d0, d1, d2) -> (d0, d1, d2)>],
+      iterator_types = ["parallel", "parallel", "parallel"]}
+      outs(%empty : tensor<2x256x16xf32>) {
+    ^bb0(%out: f32):
+      %c2 = arith.constant 2 : index
+      %row = linalg.index 1 : index
+      %parity = arith.remui %row, %c2 : index
+      %parity_i32 = arith.index_cast %parity : index to i32
+      %parity_f32 = arith.uitofp %parity_i32 : i32 to f32
+      linalg.yield %parity_f32 : f32
+  } -> tensor<2x256x16xf32>
+  %1 = iree_linalg_ext.attention
+       ins(%query, %key, %value : tensor<2x64x16xf32>, tensor<2x256x16xf32>, tensor<2x256x16xf32>)
+       outs(%init : tensor<2x64x16xf32>) -> tensor<2x64x16xf32>
+  check.expect_almost_eq_const(
+      %1,
+      dense<0.5> : tensor<2x64x16xf32>
+  ) : tensor<2x64x16xf32>
+  return
+}
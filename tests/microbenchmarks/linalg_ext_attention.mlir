@@ -0,0 +1,21 @@
+//===----------------------------------------------------------------------===//
+// LinalgExt attention ops.
+//===----------------------------------------------------------------------===//
+
+func.func @attention_12x384x64() -> tensor<12x384x64xf32> {
+    %query = util.unfoldable_constant dense<1.0> : tensor<12x384x64xf32>
+    %key = util.unfoldable_constant dense<0.5> : tensor<12x384x64xf32>
+    %value = util.unfoldable_constant dense<2.0> : tensor<12x384x64xf32>
+    %init = tensor.empty() : tensor<12x384x64xf32>
+    %0 = iree_linalg_ext.attention ins(%query, %key, %value : tensor<12x384x64xf32>, tensor<12x384x64xf32>, tensor<12x384x64xf32>) outs(%init : tensor<12x384x64xf32>) -> tensor<12x384x64xf32>
+    return %0 : tensor<12x384x64xf32>
+}
+
+func.func @attention_16x4096x64() -> tensor<16x4096x64xf32> {
+    %query = util.unfoldable_constant dense<1.0> : tensor<16x4096x64xf32>
+    %key = util.unfoldable_constant dense<0.5> : tensor<16x4096x64xf32>
+    %value = util.unfoldable_constant dense<2.0> : tensor<16x4096x64xf32>
+    %init = tensor.empty() : tensor<16x4096x64xf32>
+    %0 = iree_linalg_ext.attention ins(%query, %key, %value : tensor<16x4096x64xf32>, tensor<16x4096x64xf32>, tensor<16x4096x64xf32>) outs(%init : tensor<16x4096x64xf32>) -> tensor<16x4096x64xf32>
+    return %0 : tensor<16x4096x64xf32>
+}
@@ -5,9 +5,13 @@
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "iree/base/api.h"
 #include "iree/base/internal/file_io.h"
+#include "iree/base/internal/flags.h"
+#include "iree/base/internal/math.h"
 #include "iree/schemas/instruments/dispatch.h"
 
 // NOTE: include order matters:
@@ -19,6 +23,17 @@ typedef struct {
   iree_instruments_DispatchSiteDef_vec_t dispatch_sites_def;
 } iree_dispatch_metadata_t;
 
+static void iree_tooling_parse_dispatch_metadata(
+    const uint8_t* flatbuffer_ptr, iree_host_size_t flatbuffer_size,
+    iree_dispatch_metadata_t* out_metadata) {
+  iree_instruments_DispatchInstrumentDef_table_t instr_def =
+      iree_instruments_DispatchInstrumentDef_as_root(flatbuffer_ptr);
+  out_metadata->functions_def =
+      iree_instruments_DispatchInstrumentDef_functions(instr_def);
+  out_metadata->dispatch_sites_def =
+      iree_instruments_DispatchInstrumentDef_sites(instr_def);
+}
+
 static iree_status_t iree_tooling_dump_dispatch_metadata(
     const uint8_t* flatbuffer_ptr, iree_host_size_t flatbuffer_size,
     iree_dispatch_metadata_t* out_metadata, FILE* stream) {
@@ -221,6 +236,667 @@ static iree_status_t iree_tooling_dump_dispatch_ringbuffer(
   return iree_ok_status();
 }
 
+//===----------------------------------------------------------------------===//
+// --output=csv|json working-set analysis
+//===----------------------------------------------------------------------===//
+
+IREE_FLAG(int32_t, cache_line_size, 64,
+          "Cache line size in bytes used when analyzing memory accesses.");
+
+// Number of reuse distance histogram bins. Bin 0 counts accesses to the line
+// that was most recently accessed, bin N counts distances in [2^(N-1), 2^N),
+// and the last bin is open-ended.
+#define IREE_TOOLING_REUSE_HISTOGRAM_BIN_COUNT 20
+
+// Open-addressing hash map from uint64_t keys to non-zero uint64_t values.
+// A value of 0 indicates an empty slot.
+typedef struct iree_tooling_u64_map_t {
+  iree_allocator_t host_allocator;
+  iree_host_size_t capacity;  // power of two
+  iree_host_size_t count;
+  uint64_t* keys;
+  uint64_t* values;
+} iree_tooling_u64_map_t;
+
+static void iree_tooling_u64_map_initialize(iree_allocator_t host_allocator,
+                                            iree_tooling_u64_map_t* out_map) {
+  memset(out_map, 0, sizeof(*out_map));
+  out_map->host_allocator = host_allocator;
+}
+
+static void iree_tooling_u64_map_deinitialize(iree_tooling_u64_map_t* map) {
+  iree_allocator_free(map->host_allocator, map->keys);
+  iree_allocator_free(map->host_allocator, map->values);
+  memset(map, 0, sizeof(*map));
+}
+
+// Removes all entries from |map| while retaining its storage.
+static void iree_tooling_u64_map_reset(iree_tooling_u64_map_t* map) {
+  if (map->values) memset(map->values, 0, map->capacity * sizeof(uint64_t));
+  map->count = 0;
+}
+
+static inline iree_host_size_t iree_tooling_u64_map_hash(
+    uint64_t key, iree_host_size_t capacity) {
+  return (iree_host_size_t)((key * 0x9E3779B97F4A7C15ull) >> 17) &
+         (capacity - 1);
+}
+
+// Returns the slot in |keys|/|values| holding |key| or the empty slot where it
+// would be inserted.
+static iree_host_size_t iree_tooling_u64_map_find_slot(
+    const uint64_t* keys, const uint64_t* values, iree_host_size_t capacity,
+    uint64_t key) {
+  iree_host_size_t slot = iree_tooling_u64_map_hash(key, capacity);
+  while (values[slot] != 0 && keys[slot] != key) {
+    slot = (slot + 1) & (capacity - 1);
+  }
+  return slot;
+}
+
+static iree_status_t iree_tooling_u64_map_grow(iree_tooling_u64_map_t* map) {
+  iree_host_size_t new_capacity = map->capacity ? map->capacity * 2 : 1024;
+  uint64_t* new_keys = NULL;
+  uint64_t* new_values = NULL;
+  iree_status_t status = iree_allocator_malloc(
+      map->host_allocator, new_capacity * sizeof(uint64_t), (void**)&new_keys);
+  if (iree_status_is_ok(status)) {
+    status =
+        iree_allocator_malloc(map->host_allocator,
+                              new_capacity * sizeof(uint64_t),
+                              (void**)&new_values);
+  }
+  if (!iree_status_is_ok(status)) {
+    iree_allocator_free(map->host_allocator, new_keys);
+    return status;
+  }
+  for (iree_host_size_t i = 0; i < map->capacity; ++i) {
+    if (!map->values[i]) continue;
+    iree_host_size_t slot = iree_tooling_u64_map_find_slot(
+        new_keys, new_values, new_capacity, map->keys[i]);
+    new_keys[slot] = map->keys[i];
+    new_values[slot] = map->values[i];
+  }
+  iree_allocator_free(map->host_allocator, map->keys);
+  iree_allocator_free(map->host_allocator, map->values);
+  map->capacity = new_capacity;
+  map->keys = new_keys;
+  map->values = new_values;
+  return iree_ok_status();
+}
+
+// Returns a pointer to the value of |key|, inserting it with a value of 0 if
+// not present. The caller must set a non-zero value on insertion.
+static iree_status_t iree_tooling_u64_map_lookup_or_insert(
+    iree_tooling_u64_map_t* map, uint64_t key, uint64_t** out_value) {
+  if ((map->count + 1) * 2 > map->capacity) {
+    IREE_RETURN_IF_ERROR(iree_tooling_u64_map_grow(map));
+  }
+  iree_host_size_t slot = iree_tooling_u64_map_find_slot(
+      map->keys, map->values, map->capacity, key);
+  if (!map->values[slot]) {
+    map->keys[slot] = key;
+    ++map->count;
+  }
+  *out_value = &map->values[slot];
+  return iree_ok_status();
+}
+
+// Returns the value of |key| or 0 if not present.
+static uint64_t iree_tooling_u64_map_lookup(const iree_tooling_u64_map_t* map,
+                                            uint64_t key) {
+  if (!map->capacity) return 0;
+  return map->values[iree_tooling_u64_map_find_slot(map->keys, map->values,
+                                                    map->capacity, key)];
+}
+
+// Memory access statistics for a single workgroup or an entire dispatch site.
+typedef struct iree_tooling_access_stats_t {
+  uint64_t workgroup_count;
+  uint64_t load_count;
+  uint64_t store_count;
+  uint64_t load_bytes;
+  uint64_t store_bytes;
+  // Number of unique cache lines touched by any access.
+  uint64_t unique_lines;
+  // Address deltas between consecutive loads/stores in program order:
+  // zero: same address as the prior access.
+  // unit: immediately following the prior access (contiguous).
+  // constant: same nonzero delta as between the prior two accesses.
+  // irregular: anything else.
+  uint64_t stride_zero;
+  uint64_t stride_unit;
+  uint64_t stride_constant;
+  uint64_t stride_irregular;
+  // Reuse distances in unique cache lines touched between two accesses to the
+  // same line. The first access to a line is counted as cold.
+  uint64_t reuse_cold;
+  uint64_t reuse_histogram[IREE_TOOLING_REUSE_HISTOGRAM_BIN_COUNT];
+} iree_tooling_access_stats_t;
+
+static void iree_tooling_access_stats_accumulate(
+    const iree_tooling_access_stats_t* source,
+    iree_tooling_access_stats_t* target) {
+  target->workgroup_count += source->workgroup_count;
+  target->load_count += source->load_count;
+  target->store_count += source->store_count;
+  target->load_bytes += source->load_bytes;
+  target->store_bytes += source->store_bytes;
+  target->stride_zero += source->stride_zero;
+  target->stride_unit += source->stride_unit;
+  target->stride_constant += source->stride_constant;
+  target->stride_irregular += source->stride_irregular;
+  target->reuse_cold += source->reuse_cold;
+  for (iree_host_size_t i = 0; i < IREE_TOOLING_REUSE_HISTOGRAM_BIN_COUNT;
+       ++i) {
+    target->reuse_histogram[i] += source->reuse_histogram[i];
+  }
+}
+
+// Tracks the stride pattern of one kind of access (loads or stores).
+typedef struct iree_tooling_stride_state_t {
+  bool has_prior;
+  uint64_t prior_address;
+  uint64_t prior_length;
+  int64_t prior_delta;
+} iree_tooling_stride_state_t;
+
+static void iree_tooling_stride_state_record(
+    iree_tooling_stride_state_t* state, uint64_t address, uint64_t length,
+    iree_tooling_access_stats_t* stats) {
+  if (state->has_prior) {
+    int64_t delta = (int64_t)(address - state->prior_address);
+    if (delta == 0) {
+      ++stats->stride_zero;
+    } else if (delta == (int64_t)state->prior_length) {
+      ++stats->stride_unit;
+    } else if (delta == state->prior_delta) {
+      ++stats->stride_constant;
+    } else {
+      ++stats->stride_irregular;
+    }
+    state->prior_delta = delta;
+  }
+  state->has_prior = true;
+  state->prior_address = address;
+  state->prior_length = length;
+}
+
+// Scratch storage reused across workgroups during analysis.
+typedef struct iree_tooling_analysis_scratch_t {
+  iree_allocator_t host_allocator;
+  // Cache line -> 1 + time of last access within the current workgroup.
+  iree_tooling_u64_map_t line_map;
+  // Cache lines touched by any workgroup in the current dispatch site.
+  iree_tooling_u64_map_t site_line_set;
+  // Fenwick tree over access times counting lines whose most recent access
+  // happened at that time.
+  iree_host_size_t fenwick_capacity;
+  int32_t* fenwick_tree;
+} iree_tooling_analysis_scratch_t;
+
+static void iree_tooling_fenwick_add(int32_t* tree, iree_host_size_t count,
+                                     iree_host_size_t index, int32_t value) {
+  for (++index; index <= count; index += index & (~index + 1)) {
+    tree[index - 1] += value;
+  }
+}
+
+// Returns the sum of entries [0, index).
+static int64_t iree_tooling_fenwick_prefix_sum(const int32_t* tree,
+                                               iree_host_size_t index) {
+  int64_t sum = 0;
+  for (; index > 0; index -= index & (~index + 1)) {
+    sum += tree[index - 1];
+  }
+  return sum;
+}
+
+static int iree_tooling_reuse_histogram_bin(uint64_t distance) {
+  if (distance == 0) return 0;
+  int bin = 64 - iree_math_count_leading_zeros_u64(distance);
+  return iree_min(bin, IREE_TOOLING_REUSE_HISTOGRAM_BIN_COUNT - 1);
+}
+
+// Analyzes the memory accesses |ops| of a single workgroup in program order.
+static iree_status_t iree_tooling_analyze_workgroup(
+    const iree_instrument_dispatch_memory_op_t* const* ops,
+    iree_host_size_t op_count, uint64_t line_size,
+    iree_tooling_analysis_scratch_t* scratch,
+    iree_tooling_access_stats_t* out_stats) {
+  memset(out_stats, 0, sizeof(*out_stats));
+  out_stats->workgroup_count = 1;
+
+  // Each access is split into one reference per cache line it touches.
+  iree_host_size_t reference_count = 0;
+  for (iree_host_size_t i = 0; i < op_count; ++i) {
+    uint64_t first_line = ops[i]->address / line_size;
+    uint64_t last_line =
+        (ops[i]->address + iree_max(ops[i]->length, 1) - 1) / line_size;
+    reference_count += (iree_host_size_t)(last_line - first_line + 1);
+  }
+  if (reference_count > scratch->fenwick_capacity) {
+    iree_allocator_free(scratch->host_allocator, scratch->fenwick_tree);
+    scratch->fenwick_tree = NULL;
+    scratch->fenwick_capacity = 0;
+    IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+        scratch->host_allocator, reference_count * sizeof(int32_t),
+        (void**)&scratch->fenwick_tree));
+    scratch->fenwick_capacity = reference_count;
+  } else if (reference_count) {
+    memset(scratch->fenwick_tree, 0, reference_count * sizeof(int32_t));
+  }
+  iree_tooling_u64_map_reset(&scratch->line_map);
+
+  iree_tooling_stride_state_t load_stride = {0};
+  iree_tooling_stride_state_t store_stride = {0};
+  iree_host_size_t time = 0;
+  for (iree_host_size_t i = 0; i < op_count; ++i) {
+    const iree_instrument_dispatch_memory_op_t* op = ops[i];
+    if (op->tag == IREE_INSTRUMENT_DISPATCH_TYPE_MEMORY_LOAD) {
+      ++out_stats->load_count;
+      out_stats->load_bytes += op->length;
+      iree_tooling_stride_state_record(&load_stride, op->address, op->length,
+                                       out_stats);
+    } else {
+      ++out_stats->store_count;
+      out_stats->store_bytes += op->length;
+      iree_tooling_stride_state_record(&store_stride, op->address, op->length,
+                                       out_stats);
+    }
+
+    uint64_t first_line = op->address / line_size;
+    uint64_t last_line =
+        (op->address + iree_max(op->length, 1) - 1) / line_size;
+    for (uint64_t line = first_line; line <= last_line; ++line, ++time) {
+      uint64_t* last_access = NULL;
+      IREE_RETURN_IF_ERROR(iree_tooling_u64_map_lookup_or_insert(
+          &scratch->line_map, line, &last_access));
+      if (*last_access == 0) {
+        ++out_stats->reuse_cold;
+        ++out_stats->unique_lines;
+      } else {
+        // The distance is the number of unique lines whose most recent access
+        // happened after the prior access to this line.
+        iree_host_size_t prior_time = (iree_host_size_t)(*last_access - 1);
+        int64_t distance =
+            iree_tooling_fenwick_prefix_sum(scratch->fenwick_tree, time) -
+            iree_tooling_fenwick_prefix_sum(scratch->fenwick_tree,
+                                            prior_time + 1);
+        ++out_stats
+              ->reuse_histogram[iree_tooling_reuse_histogram_bin(distance)];
+        iree_tooling_fenwick_add(scratch->fenwick_tree, reference_count,
+                                 prior_time, -1);
+      }
+      iree_tooling_fenwick_add(scratch->fenwick_tree, reference_count, time,
+                               1);
+      *last_access = time + 1;
+
+      uint64_t* site_entry = NULL;
+      IREE_RETURN_IF_ERROR(iree_tooling_u64_map_lookup_or_insert(
+          &scratch->site_line_set, line, &site_entry));
+      *site_entry = 1;
+    }
+  }
+
+  return iree_ok_status();
+}
+
+typedef enum iree_tooling_analysis_format_e {
+  IREE_TOOLING_ANALYSIS_FORMAT_CSV = 0,
+  IREE_TOOLING_ANALYSIS_FORMAT_JSON,
+} iree_tooling_analysis_format_t;
+
+static void iree_tooling_print_analysis_header(
+    iree_tooling_analysis_format_t format, FILE* stream) {
+  if (format == IREE_TOOLING_ANALYSIS_FORMAT_JSON) {
+    fprintf(stream, "[\n");
+    return;
+  }
+  fprintf(stream,
+          "scope,site,function,workgroup_x,workgroup_y,workgroup_z,"
+          "workgroups,loads,stores,load_bytes,store_bytes,unique_lines,"
+          "footprint_bytes,access_intensity,stride_zero,stride_unit,"
+          "stride_constant,stride_irregular,reuse_cold");
+  for (int i = 0; i < IREE_TOOLING_REUSE_HISTOGRAM_BIN_COUNT; ++i) {
+    fprintf(stream, ",reuse_%" PRIu64, i ? (uint64_t)1 << (i - 1) : 0);
+  }
+  fprintf(stream, "\n");
+}
+
+// Prints |value| as a JSON string literal, escaping quotes, backslashes and
+// control characters.
+static void iree_tooling_print_json_string(const char* value, FILE* stream) {
+  fputc('"', stream);
+  for (const char* p = value; p && *p; ++p) {
+    unsigned char c = (unsigned char)*p;
+    switch (c) {
+      case '"':
+        fputs("\\\"", stream);
+        break;
+      case '\\':
+        fputs("\\\\", stream);
+        break;
+      case '\n':
+        fputs("\\n", stream);
+        break;
+      case '\r':
+        fputs("\\r", stream);
+        break;
+      case '\t':
+        fputs("\\t", stream);
+        break;
+      default:
+        if (c < 0x20) {
+          fprintf(stream, "\\u%04x", c);
+        } else {
+          fputc(c, stream);
+        }
+        break;
+    }
+  }
+  fputc('"', stream);
+}
+
+// Prints |value| as a CSV field. Fields containing separators, quotes or line
+// breaks are quoted with embedded quotes doubled.
+static void iree_tooling_print_csv_string(const char* value, FILE* stream) {
+  if (!value) return;
+  if (!strpbrk(value, ",\"\r\n")) {
+    fputs(value, stream);
+    return;
+  }
+  fputc('"', stream);
+  for (const char* p = value; *p; ++p) {
+    if (*p == '"') fputc('"', stream);
+    fputc(*p, stream);
+  }
+  fputc('"', stream);
+}
+
+// Prints one analysis record. |workgroup| is NULL for dispatch site summaries.
+static void iree_tooling_print_analysis_record(
+    iree_tooling_analysis_format_t format, uint32_t site_id,
+    flatbuffers_string_t function_name,
+    const iree_instrument_dispatch_workgroup_t* workgroup,
+    const iree_tooling_access_stats_t* stats, uint64_t line_size,
+    bool is_first_record, FILE* stream) {
+  const uint64_t footprint_bytes = stats->unique_lines * line_size;
+  const double access_intensity =
+      footprint_bytes
+          ? (double)(stats->load_bytes + stats->store_bytes) / footprint_bytes
+          : 0.0;
+  const char* scope = workgroup ? "workgroup" : "site";
+  if (format == IREE_TOOLING_ANALYSIS_FORMAT_CSV) {
+    fprintf(stream, "%s,%u,", scope, site_id);
+    iree_tooling_print_csv_string(function_name, stream);
+    fprintf(stream, ",");
+    if (workgroup) {
+      fprintf(stream, "%u,%u,%u,", workgroup->workgroup_id_x,
+              workgroup->workgroup_id_y, workgroup->workgroup_id_z);
+    } else {
+      fprintf(stream, ",,,");
+    }
+    fprintf(stream,
+            "%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64
+            ",%" PRIu64 ",%" PRIu64 ",%.3f,%" PRIu64 ",%" PRIu64 ",%" PRIu64
+            ",%" PRIu64 ",%" PRIu64,
+            stats->workgroup_count, stats->load_count, stats->store_count,
+            stats->load_bytes, stats->store_bytes, stats->unique_lines,
+            footprint_bytes, access_intensity, stats->stride_zero,
+            stats->stride_unit, stats->stride_constant,
+            stats->stride_irregular, stats->reuse_cold);
+    for (int i = 0; i < IREE_TOOLING_REUSE_HISTOGRAM_BIN_COUNT; ++i) {
+      fprintf(stream, ",%" PRIu64, stats->reuse_histogram[i]);
+    }
+    fprintf(stream, "\n");
+    return;
+  }
+
+  fprintf(stream, "%s  {\"scope\": \"%s\", \"site\": %u, \"function\": ",
+          is_first_record ? "" : ",\n", scope, site_id);
+  iree_tooling_print_json_string(function_name, stream);
+  if (workgroup) {
+    fprintf(stream, ", \"workgroup\": [%u, %u, %u]",
+            workgroup->workgroup_id_x, workgroup->workgroup_id_y,
+            workgroup->workgroup_id_z);
+  }
+  fprintf(stream,
+          ", \"workgroups\": %" PRIu64 ", \"loads\": %" PRIu64
+          ", \"stores\": %" PRIu64 ", \"load_bytes\": %" PRIu64
+          ", \"store_bytes\": %" PRIu64 ", \"unique_lines\": %" PRIu64
+          ", \"footprint_bytes\": %" PRIu64 ", \"access_intensity\": %.3f"
+          ", \"stride\": {\"zero\": %" PRIu64 ", \"unit\": %" PRIu64
+          ", \"constant\": %" PRIu64 ", \"irregular\": %" PRIu64
+          "}, \"reuse_cold\": %" PRIu64 ", \"reuse_histogram\": [",
+          stats->workgroup_count, stats->load_count, stats->store_count,
+          stats->load_bytes, stats->store_bytes, stats->unique_lines,
+          footprint_bytes, access_intensity, stats->stride_zero,
+          stats->stride_unit, stats->stride_constant, stats->stride_irregular,
+          stats->reuse_cold);
+  for (int i = 0; i < IREE_TOOLING_REUSE_HISTOGRAM_BIN_COUNT; ++i) {
+    fprintf(stream, "%s%" PRIu64, i ? ", " : "", stats->reuse_histogram[i]);
+  }
+  fprintf(stream, "]}");
+}
+
+// Returns the size in bytes of the ringbuffer record starting at |header|.
+static iree_status_t iree_tooling_dispatch_record_size(
+    const iree_instrument_dispatch_header_t* header,
+    iree_host_size_t* out_size) {
+  switch (header->tag) {
+    case IREE_INSTRUMENT_DISPATCH_TYPE_WORKGROUP:
+      *out_size = sizeof(iree_instrument_dispatch_workgroup_t);
+      return iree_ok_status();
+    case IREE_INSTRUMENT_DISPATCH_TYPE_PRINT:
+      *out_size = iree_host_align(
+          sizeof(iree_instrument_dispatch_print_t) +
+              ((const iree_instrument_dispatch_print_t*)header)->length,
+          16);
+      return iree_ok_status();
+    case IREE_INSTRUMENT_DISPATCH_TYPE_VALUE:
+      *out_size = sizeof(iree_instrument_dispatch_value_t);
+      return iree_ok_status();
+    case IREE_INSTRUMENT_DISPATCH_TYPE_MEMORY_LOAD:
+    case IREE_INSTRUMENT_DISPATCH_TYPE_MEMORY_STORE:
+      *out_size = sizeof(iree_instrument_dispatch_memory_op_t);
+      return iree_ok_status();
+    default:
+      return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                              "unimplemented dispatch instr type: %u",
+                              (uint32_t)header->tag);
+  }
+}
+
+// A workgroup record in the ringbuffer and the range of its memory accesses in
+// the gathered access list.
+typedef struct iree_tooling_workgroup_entry_t {
+  const iree_instrument_dispatch_workgroup_t* record;
+  iree_host_size_t op_offset;
+  iree_host_size_t op_count;
+} iree_tooling_workgroup_entry_t;
+
+static int iree_tooling_compare_workgroup_entries(const void* a_ptr,
+                                                  const void* b_ptr) {
+  const iree_tooling_workgroup_entry_t* a =
+      (const iree_tooling_workgroup_entry_t*)a_ptr;
+  const iree_tooling_workgroup_entry_t* b =
+      (const iree_tooling_workgroup_entry_t*)b_ptr;
+  if (a->record->dispatch_id != b->record->dispatch_id) {
+    return a->record->dispatch_id < b->record->dispatch_id ? -1 : 1;
+  }
+  // Records are in ringbuffer order so the addresses give a stable sort.
+  return a->record < b->record ? -1 : (a->record > b->record ? 1 : 0);
+}
+
+static iree_status_t iree_tooling_analyze_dispatch_ringbuffer(
+    const uint8_t* data_ptr, iree_host_size_t data_size,
+    const iree_dispatch_metadata_t* metadata,
+    iree_tooling_analysis_format_t format, iree_allocator_t host_allocator,
+    bool* inout_is_first_record, FILE* stream) {
+  if (FLAG_cache_line_size <= 0) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "--cache_line_size must be positive");
+  }
+  const uint64_t line_size = (uint64_t)FLAG_cache_line_size;
+  const uint64_t ring_size = data_size - IREE_INSTRUMENT_DISPATCH_PADDING;
+  const uint8_t* ring_data = data_ptr;
+  const uint64_t ring_head = *(const uint64_t*)(ring_data + data_size - 8);
+  const uint64_t ring_range = iree_min(ring_head, ring_size);
+
+  // Count the workgroups so we can size the tables.
+  iree_host_size_t workgroup_count = 0;
+  for (iree_host_size_t i = 0; i < ring_range;) {
+    const iree_instrument_dispatch_header_t* header =
+        (const iree_instrument_dispatch_header_t*)(ring_data + i);
+    if (header->tag == IREE_INSTRUMENT_DISPATCH_TYPE_WORKGROUP) {
+      ++workgroup_count;
+    }
+    iree_host_size_t record_size = 0;
+    IREE_RETURN_IF_ERROR(
+        iree_tooling_dispatch_record_size(header, &record_size));
+    i += record_size;
+  }
+
+  iree_tooling_workgroup_entry_t* workgroups = NULL;
+  const iree_instrument_dispatch_memory_op_t** ops = NULL;
+  iree_tooling_u64_map_t workgroup_map;  // ring offset -> 1 + entry index
+  iree_tooling_u64_map_initialize(host_allocator, &workgroup_map);
+  iree_tooling_analysis_scratch_t scratch;
+  memset(&scratch, 0, sizeof(scratch));
+  scratch.host_allocator = host_allocator;
+  iree_tooling_u64_map_initialize(host_allocator, &scratch.line_map);
+  iree_tooling_u64_map_initialize(host_allocator, &scratch.site_line_set);
+
+  iree_status_t status = iree_allocator_malloc(
+      host_allocator, iree_max(workgroup_count, 1) * sizeof(*workgroups),
+      (void**)&workgroups);
+
+  // Index the workgroups by their ringbuffer offset and count the memory
+  // accesses made by each. Accesses from workgroups whose record was
+  // overwritten when the ringbuffer wrapped are ignored.
+  iree_host_size_t op_count = 0;
+  iree_host_size_t workgroup_index = 0;
+  for (iree_host_size_t i = 0; iree_status_is_ok(status) && i < ring_range;) {
+    const iree_instrument_dispatch_header_t* header =
+        (const iree_instrument_dispatch_header_t*)(ring_data + i);
+    if (header->tag == IREE_INSTRUMENT_DISPATCH_TYPE_WORKGROUP) {
+      workgroups[workgroup_index].record =
+          (const iree_instrument_dispatch_workgroup_t*)header;
+      uint64_t* entry = NULL;
+      status =
+          iree_tooling_u64_map_lookup_or_insert(&workgroup_map, i, &entry);
+      if (iree_status_is_ok(status)) *entry = ++workgroup_index;
+    } else if (header->tag == IREE_INSTRUMENT_DISPATCH_TYPE_MEMORY_LOAD ||
+               header->tag == IREE_INSTRUMENT_DISPATCH_TYPE_MEMORY_STORE) {
+      const iree_instrument_dispatch_memory_op_t* op =
+          (const iree_instrument_dispatch_memory_op_t*)header;
+      uint64_t entry =
+          iree_tooling_u64_map_lookup(&workgroup_map, op->workgroup_offset);
+      if (entry) {
+        ++workgroups[entry - 1].op_count;
+        ++op_count;
+      }
+    }
+    iree_host_size_t record_size = 0;
+    if (iree_status_is_ok(status)) {
+      status = iree_tooling_dispatch_record_size(header, &record_size);
+    }
+    i += record_size;
+  }
+
+  // Gather the accesses of each workgroup into a contiguous range.
+  if (iree_status_is_ok(status)) {
+    status = iree_allocator_malloc(host_allocator,
+                                   iree_max(op_count, 1) * sizeof(*ops),
+                                   (void**)&ops);
+  }
+  if (iree_status_is_ok(status)) {
+    iree_host_size_t op_offset = 0;
+    for (iree_host_size_t i = 0; i < workgroup_count; ++i) {
+      workgroups[i].op_offset = op_offset;
+      op_offset += workgroups[i].op_count;
+      workgroups[i].op_count = 0;
+    }
+    for (iree_host_size_t i = 0; i < ring_range;) {
+      const iree_instrument_dispatch_header_t* header =
+          (const iree_instrument_dispatch_header_t*)(ring_data + i);
+      if (header->tag == IREE_INSTRUMENT_DISPATCH_TYPE_MEMORY_LOAD ||
+          header->tag == IREE_INSTRUMENT_DISPATCH_TYPE_MEMORY_STORE) {
+        const iree_instrument_dispatch_memory_op_t* op =
+            (const iree_instrument_dispatch_memory_op_t*)header;
+        uint64_t entry =
+            iree_tooling_u64_map_lookup(&workgroup_map, op->workgroup_offset);
+        if (entry) {
+          iree_tooling_workgroup_entry_t* workgroup = &workgroups[entry - 1];
+          ops[workgroup->op_offset + workgroup->op_count++] = op;
+        }
+      }
+      iree_host_size_t record_size = 0;
+      iree_status_ignore(
+          iree_tooling_dispatch_record_size(header, &record_size));
+      i += record_size;
+    }
+    qsort(workgroups, workgroup_count, sizeof(*workgroups),
+          iree_tooling_compare_workgroup_entries);
+  }
+
+  // Analyze each workgroup and summarize each dispatch site.
+  for (iree_host_size_t i = 0;
+       iree_status_is_ok(status) && i < workgroup_count;) {
+    const uint32_t site_id = workgroups[i].record->dispatch_id;
+    flatbuffers_string_t function_name = NULL;
+    if (site_id < iree_instruments_DispatchSiteDef_vec_len(
+                      metadata->dispatch_sites_def)) {
+      iree_instruments_DispatchSiteDef_table_t dispatch_site_def =
+          iree_instruments_DispatchSiteDef_vec_at(metadata->dispatch_sites_def,
+                                                  site_id);
+      iree_instruments_DispatchFunctionDef_table_t function_def =
+          iree_instruments_DispatchFunctionDef_vec_at(
+              metadata->functions_def,
+              iree_instruments_DispatchSiteDef_function(dispatch_site_def));
+      function_name = iree_instruments_DispatchFunctionDef_name(function_def);
+    }
+
+    iree_tooling_u64_map_reset(&scratch.site_line_set);
+    iree_tooling_access_stats_t site_stats;
+    memset(&site_stats, 0, sizeof(site_stats));
+    for (; iree_status_is_ok(status) && i < workgroup_count &&
+           workgroups[i].record->dispatch_id == site_id;
+         ++i) {
+      iree_tooling_access_stats_t workgroup_stats;
+      status = iree_tooling_analyze_workgroup(
+          ops + workgroups[i].op_offset, workgroups[i].op_count, line_size,
+          &scratch, &workgroup_stats);
+      if (!iree_status_is_ok(status)) break;
+      iree_tooling_print_analysis_record(
+          format, site_id, function_name, workgroups[i].record,
+          &workgroup_stats, line_size, *inout_is_first_record, stream);
+      *inout_is_first_record = false;
+      iree_tooling_access_stats_accumulate(&workgroup_stats, &site_stats);
+    }
+    if (!iree_status_is_ok(status)) break;
+    site_stats.unique_lines = scratch.site_line_set.count;
+    iree_tooling_print_analysis_record(format, site_id, function_name,
+                                       /*workgroup=*/NULL, &site_stats,
+                                       line_size, *inout_is_first_record,
+                                       stream);
+    *inout_is_first_record = false;
+  }
+
+  iree_allocator_free(host_allocator, scratch.fenwick_tree);
+  iree_tooling_u64_map_deinitialize(&scratch.site_line_set);
+  iree_tooling_u64_map_deinitialize(&scratch.line_map);
+  iree_tooling_u64_map_deinitialize(&workgroup_map);
+  iree_allocator_free(host_allocator, ops);
+  iree_allocator_free(host_allocator, workgroups);
+  return status;
+}
+
+//===----------------------------------------------------------------------===//
+// main
+//===----------------------------------------------------------------------===//
+
 static iree_status_t iree_tooling_dump_instrument_file(
     iree_const_byte_span_t file_contents, FILE* stream) {
   const uint8_t* file_ptr = file_contents.data;
@@ -254,10 +930,65 @@ static iree_status_t iree_tooling_dump_instrument_file(
   return iree_ok_status();
 }
 
+static iree_status_t iree_tooling_analyze_instrument_file(
+    iree_const_byte_span_t file_contents,
+    iree_tooling_analysis_format_t format, iree_allocator_t host_allocator,
+    FILE* stream) {
+  const uint8_t* file_ptr = file_contents.data;
+  iree_host_size_t file_size = file_contents.data_length;
+
+  iree_tooling_print_analysis_header(format, stream);
+  bool is_first_record = true;
+  iree_dispatch_metadata_t dispatch_metadata = {0};
+  for (iree_host_size_t file_offset = 0; file_offset < file_size;) {
+    const iree_idbts_chunk_header_t* header =
+        (const iree_idbts_chunk_header_t*)(file_ptr + file_offset);
+    const uint8_t* payload = file_ptr + file_offset + sizeof(*header);
+    switch (header->type) {
+      case IREE_IDBTS_CHUNK_TYPE_DISPATCH_METADATA: {
+        iree_tooling_parse_dispatch_metadata(payload, header->content_length,
+                                             &dispatch_metadata);
+        break;
+      }
+      case IREE_IDBTS_CHUNK_TYPE_DISPATCH_RINGBUFFER: {
+        IREE_RETURN_IF_ERROR(iree_tooling_analyze_dispatch_ringbuffer(
+            payload, header->content_length, &dispatch_metadata, format,
+            host_allocator, &is_first_record, stream));
+        break;
+      }
+      default:
+        return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                                "unimplemented chunk type: %u",
+                                (uint32_t)header->type);
+    }
+    file_offset +=
+        sizeof(*header) + iree_host_align(header->content_length, 16);
+  }
+  if (format == IREE_TOOLING_ANALYSIS_FORMAT_JSON) {
+    fprintf(stream, "\n]\n");
+  }
+
+  return iree_ok_status();
+}
+
+IREE_FLAG(string, output, "text",
+          "Output mode:\n"
+          "  'text': metadata and a pretty-printed ringbuffer.\n"
+          "  'csv': per workgroup and dispatch site memory access analysis.\n"
+          "  'json': same as 'csv' as a JSON array of records.\n");
+
 int main(int argc, char** argv) {
+  iree_allocator_t host_allocator = iree_allocator_system();
+
+  // Parse command line flags.
+  iree_flags_set_usage("iree-dump-instruments",
+                       "Dumps or analyzes IREE instrument files.\n");
+  iree_flags_parse_checked(IREE_FLAGS_PARSE_MODE_DEFAULT, &argc, &argv);
+
   if (argc < 2) {
     fprintf(stderr,
-            "Syntax: iree-dump-instruments instruments.bin > instruments.txt\n"
+            "Syntax: iree-dump-instruments [--output=text|csv|json] "
+            "instruments.bin > instruments.txt\n"
             "Example usage:\n"
             "  $ iree-compile \\n"
             "        --iree-hal-target-backends=llvm-cpu \\n"
@@ -273,16 +1004,36 @@ int main(int argc, char** argv) {
             "        --input=4xf32=4 \\n"
             "        --instrument_file=instrument.bin\n"
             "  $ iree-dump-instruments instrument.bin\n"
+            "\n"
+            "Memory access analysis requires compiling with\n"
+            "--iree-llvmcpu-instrument-memory-accesses=true and produces\n"
+            "per workgroup and dispatch site bytes touched, unique cache\n"
+            "lines, stride patterns, and reuse distance histograms:\n"
+            "  $ iree-dump-instruments --output=csv instrument.bin\n"
             "\n");
     return 1;
   }
 
   iree_file_contents_t* file_contents = NULL;
   iree_status_t status =
-      iree_file_read_contents(argv[1], iree_allocator_system(), &file_contents);
+      iree_file_read_contents(argv[1], host_allocator, &file_contents);
   if (iree_status_is_ok(status)) {
-    status =
-        iree_tooling_dump_instrument_file(file_contents->const_buffer, stdout);
+    if (strcmp(FLAG_output, "text") == 0) {
+      status = iree_tooling_dump_instrument_file(file_contents->const_buffer,
+                                                 stdout);
+    } else if (strcmp(FLAG_output, "csv") == 0) {
+      status = iree_tooling_analyze_instrument_file(
+          file_contents->const_buffer, IREE_TOOLING_ANALYSIS_FORMAT_CSV,
+          host_allocator, stdout);
+    } else if (strcmp(FLAG_output, "json") == 0) {
+      status = iree_tooling_analyze_instrument_file(
+          file_contents->const_buffer, IREE_TOOLING_ANALYSIS_FORMAT_JSON,
+          host_allocator, stdout);
+    } else {
+      status = iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                "unrecognized --output= flag value '%s'",
+                                FLAG_output);
+    }
   }
   iree_file_contents_free(file_contents);
 
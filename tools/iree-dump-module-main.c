@@ -263,7 +263,8 @@ static size_t iree_tooling_calculate_external_rodata_size(
   for (size_t i = 0; i < iree_vm_RodataSegmentDef_vec_len(segment_defs); ++i) {
     iree_vm_RodataSegmentDef_table_t segment_def =
         iree_vm_RodataSegmentDef_vec_at(segment_defs, i);
-    if (!iree_vm_RodataSegmentDef_embedded_data_is_present(segment_def)) {
+    if (!iree_vm_RodataSegmentDef_embedded_data_is_present(segment_def) &&
+        !iree_vm_RodataSegmentDef_external_key_is_present(segment_def)) {
       total_size += iree_vm_RodataSegmentDef_external_data_length(segment_def);
     }
   }
@@ -299,6 +300,14 @@ static void iree_tooling_print_rodata_segment_defs(
       case iree_vm_CompressionTypeDef_UncompressedDataDef:
         fprintf(stdout, "uncompressed ");
         break;
+      case iree_vm_CompressionTypeDef_LZ4ChunkedDataDef: {
+        iree_vm_LZ4ChunkedDataDef_table_t lz4_def =
+            (iree_vm_LZ4ChunkedDataDef_table_t)
+                iree_vm_RodataSegmentDef_compression_type(segment_def);
+        fprintf(stdout, "lz4 %8" PRIu64 " bytes ",
+                iree_vm_LZ4ChunkedDataDef_decompressed_length(lz4_def));
+        break;
+      }
       default:
         break;
     }
@@ -313,6 +322,10 @@ static void iree_tooling_print_rodata_segment_defs(
                 (const char*)data);
         if (string_length >= MAX_LENGTH) fprintf(stdout, "...");
       }
+    } else if (iree_vm_RodataSegmentDef_external_key_is_present(segment_def)) {
+      fprintf(stdout, "parameter %8" PRIu64 " bytes `%s`",
+              iree_vm_RodataSegmentDef_external_data_length(segment_def),
+              iree_vm_RodataSegmentDef_external_key(segment_def));
     } else {
       fprintf(stdout,
               "external %8" PRIu64 " bytes (offset %" PRIu64 " / %" PRIX64
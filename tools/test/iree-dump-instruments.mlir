@@ -0,0 +1,36 @@
+// RUN: iree-compile --iree-hal-target-backends=llvm-cpu \
+// RUN:     --iree-hal-instrument-dispatches=16mib \
+// RUN:     --iree-llvmcpu-instrument-memory-accesses=true \
+// RUN:     %s -o=%t.vmfb && \
+// RUN: iree-run-module --device=local-task --module=%t.vmfb \
+// RUN:     --function='mul"quoted\name' \
+// RUN:     --input=4xf32=2 --input=4xf32=4 \
+// RUN:     --instrument_file=%t.bin && \
+// RUN: iree-dump-instruments %t.bin | FileCheck %s --check-prefix=TEXT && \
+// RUN: iree-dump-instruments --output=csv %t.bin | \
+// RUN:     FileCheck %s --check-prefix=CSV && \
+// RUN: iree-dump-instruments --output=json %t.bin | \
+// RUN:     FileCheck %s --check-prefix=JSON && \
+// RUN: iree-dump-instruments --output=json %t.bin | \
+// RUN:     %PYTHON -c "import json, sys; json.load(sys.stdin)"
+
+// The function name is chosen to contain characters that must be quoted in
+// CSV and escaped in JSON; dispatch names are derived from it.
+
+// TEXT: // dispatch site 0: mul"quoted\name_dispatch_0
+// TEXT: LOAD
+// TEXT: STORE
+
+// CSV: scope,site,function,workgroup_x,workgroup_y,workgroup_z,workgroups,loads,stores,load_bytes,store_bytes,unique_lines,footprint_bytes,access_intensity,stride_zero,stride_unit,stride_constant,stride_irregular,reuse_cold,reuse_0,reuse_1,reuse_2
+// CSV: workgroup,0,"mul""quoted\name_dispatch_0{{[^,]*}}",0,0,0,1,{{[0-9]+}},{{[0-9]+}},32,16,
+// CSV: site,0,"mul""quoted\name_dispatch_0{{[^,]*}}",,,,1,{{[0-9]+}},{{[0-9]+}},32,16,
+
+// JSON: [
+// JSON: {"scope": "workgroup", "site": 0, "function": "mul\"quoted\\name_dispatch_0{{[^"]*}}", "workgroup": [0, 0, 0], "workgroups": 1, {{.*}}, "load_bytes": 32, "store_bytes": 16, {{.*}}"reuse_histogram": [
+// JSON: {"scope": "site", "site": 0, "function": "mul\"quoted\\name_dispatch_0{{[^"]*}}", "workgroups": 1, {{.*}}, "load_bytes": 32, "store_bytes": 16, {{.*}}"reuse_histogram": [
+// JSON: ]
+
+func.func @"mul\"quoted\\name"(%lhs: tensor<4xf32>, %rhs: tensor<4xf32>) -> tensor<4xf32> {
+  %0 = arith.mulf %lhs, %rhs : tensor<4xf32>
+  return %0 : tensor<4xf32>
+}